@@ -324,6 +324,8 @@ usage(void)
 	fprintf(stderr, "usage:\n");
 	fprintf(stderr, "   %s <option> <lcore#>\n", g_exe_name);
 	fprintf(stderr, "                 '-c' to display single lcore history\n");
+	fprintf(stderr, "                      (%d+n for the n-th non-reactor thread)\n",
+		SPDK_TRACE_THREAD_HISTORY_ID(0));
 	fprintf(stderr, "                 '-t' to display TSC offset for each event\n");
 	fprintf(stderr, "                 '-s' to specify spdk_trace shm name for a\n");
 	fprintf(stderr, "                      currently running process\n");
@@ -331,9 +333,15 @@ usage(void)
 	fprintf(stderr, "                 '-p' to specify the trace PID\n");
 	fprintf(stderr, "                      (If -s is specified, then one of\n");
 	fprintf(stderr, "                       -i or -p must be specified)\n");
-	fprintf(stderr, "                 '-f' to specify a tracepoint file name\n");
+	fprintf(stderr, "                 '-f' to specify a tracepoint file name, either\n");
+	fprintf(stderr, "                      recorded by spdk_trace_record or streamed with -z\n");
 	fprintf(stderr, "                      (-s and -f are mutually exclusive)\n");
 	fprintf(stderr, "                 '-j' to use JSON to format the output\n");
+	fprintf(stderr, "                 '-a' to report the latency decomposition of requests\n");
+	fprintf(stderr, "                      instead of displaying each event\n");
+	fprintf(stderr, "                 '-A' to also report latency histograms (implies -a)\n");
+	fprintf(stderr, "                 '-n' to specify the number of slowest request timelines\n");
+	fprintf(stderr, "                      reported by -a (default 10)\n");
 }
 
 int
@@ -341,24 +349,45 @@ main(int argc, char **argv)
 {
 	struct spdk_trace_parser_opts	opts;
 	struct spdk_trace_parser_entry	entry;
+	struct spdk_trace_analysis_opts	analysis_opts = {};
+	struct spdk_trace_analysis	*analysis = NULL;
 	int				lcore = SPDK_TRACE_MAX_LCORE;
-	uint64_t			tsc_offset, entry_count;
+	uint64_t			tsc_offset, entry_count, dropped_count;
 	const char			*app_name = NULL;
 	const char			*file_name = NULL;
 	int				op, i;
+	long				top_n;
 	char				shm_name[64];
 	int				shm_id = -1, shm_pid = -1;
 	bool				json = false;
+	bool				analyze = false;
 
 	g_exe_name = argv[0];
-	while ((op = getopt(argc, argv, "c:f:i:jp:s:t")) != -1) {
+	analysis_opts.top_n = 10;
+	while ((op = getopt(argc, argv, "aAc:f:i:jn:p:s:t")) != -1) {
 		switch (op) {
+		case 'a':
+			analyze = true;
+			break;
+		case 'A':
+			analyze = true;
+			analysis_opts.histograms = true;
+			break;
+		case 'n':
+			top_n = spdk_strtol(optarg, 10);
+			if (top_n <= 0 || top_n > UINT32_MAX) {
+				fprintf(stderr, "Invalid number of slowest requests: %s\n", optarg);
+				usage();
+				exit(1);
+			}
+			analysis_opts.top_n = top_n;
+			break;
 		case 'c':
 			lcore = atoi(optarg);
-			if (lcore > SPDK_TRACE_MAX_LCORE) {
+			if (lcore >= SPDK_TRACE_MAX_HISTORIES) {
 				fprintf(stderr, "Selected lcore: %d "
 					"exceeds maximum %d\n", lcore,
-					SPDK_TRACE_MAX_LCORE);
+					SPDK_TRACE_MAX_HISTORIES - 1);
 				exit(1);
 			}
 			break;
@@ -398,6 +427,12 @@ main(int argc, char **argv)
 		exit(1);
 	}
 
+	if (json && analyze) {
+		fprintf(stderr, "-j and -a are mutually exclusive\n");
+		usage();
+		exit(1);
+	}
+
 	if (json) {
 		g_json = spdk_json_write_begin(print_json, NULL, 0);
 		if (g_json == NULL) {
@@ -433,23 +468,55 @@ main(int argc, char **argv)
 		spdk_json_write_named_array_begin(g_json, "entries");
 	}
 
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; ++i) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; ++i) {
 		if (lcore == SPDK_TRACE_MAX_LCORE || i == lcore) {
 			entry_count = spdk_trace_parser_get_entry_count(g_parser, i);
-			if (entry_count > 0) {
+			if (entry_count == 0) {
+				continue;
+			}
+			if (i < SPDK_TRACE_MAX_LCORE) {
 				printf("Trace Size of lcore (%d): %ju\n", i, entry_count);
+			} else {
+				printf("Trace Size of thread (%d): %ju\n", i, entry_count);
+			}
+			dropped_count = spdk_trace_parser_get_dropped_count(g_parser, i);
+			if (dropped_count > 0) {
+				printf("Dropped entries of (%d): %ju\n", i, dropped_count);
 			}
 		}
 	}
 
+	if (analyze) {
+		analysis = spdk_trace_analysis_create(g_parser, &analysis_opts);
+		if (analysis == NULL) {
+			fprintf(stderr, "Failed to initialize trace analysis\n");
+			spdk_trace_parser_cleanup(g_parser);
+			exit(1);
+		}
+	}
+
 	tsc_offset = spdk_trace_parser_get_tsc_offset(g_parser);
 	while (spdk_trace_parser_next_entry(g_parser, &entry)) {
 		if (entry.entry->tsc < tsc_offset) {
 			continue;
 		}
+		if (analysis != NULL) {
+			if (spdk_trace_analysis_add_entry(analysis, &entry) != 0) {
+				fprintf(stderr, "Failed to analyze trace entries\n");
+				break;
+			}
+			continue;
+		}
 		process_event(&entry, g_flags->tsc_rate, tsc_offset);
 	}
 
+	if (analysis != NULL) {
+		if (spdk_trace_analysis_report(analysis, stdout) != 0) {
+			fprintf(stderr, "Failed to report trace analysis\n");
+		}
+		spdk_trace_analysis_free(analysis);
+	}
+
 	if (g_json != NULL) {
 		spdk_json_write_array_end(g_json);
 		spdk_json_write_object_end(g_json);
@@ -5,14 +5,24 @@
 
 #include "spdk/stdinc.h"
 
+#include "spdk/config.h"
 #include "spdk/env.h"
 #include "spdk/string.h"
 #include "spdk/trace.h"
 #include "spdk/util.h"
 #include "spdk/barrier.h"
+#include "spdk_internal/trace_stream.h"
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/igzip_lib.h"
+#endif
 
 #define TRACE_FILE_COPY_SIZE	(32 * 1024)
 #define TRACE_PATH_MAX		2048
+/* Time to wait in streaming mode when there were no new entries on any lcore */
+#define TRACE_STREAM_IDLE_US	100
+/* Longest time entries are kept in a partially filled block in streaming mode */
+#define TRACE_STREAM_FLUSH_US	(1000 * 1000)
 
 static char *g_exe_name;
 static int g_verbose = 1;
@@ -37,16 +47,42 @@ struct lcore_trace_record_ctx {
 
 	/* Total number of entries in lcore trace file */
 	uint64_t num_entries;
+
+	/* Number of entries overwritten in shm before they could be recorded */
+	uint64_t num_dropped;
+
+	/* Entries waiting to be written as a block in streaming mode */
+	struct spdk_trace_entry *stream_entries;
+	uint32_t num_stream_entries;
+
+	/* Time by which the partially filled block is written even if it isn't full */
+	uint64_t stream_flush_us;
 };
 
 struct aggr_trace_record_ctx {
 	const char *out_file;
 	int out_fd;
 	int shm_fd;
-	struct lcore_trace_record_ctx lcore_ports[SPDK_TRACE_MAX_LCORE];
+	struct lcore_trace_record_ctx lcore_ports[SPDK_TRACE_MAX_HISTORIES];
 	struct spdk_trace_histories *trace_histories;
 };
 
+struct trace_stream_ctx {
+	bool enabled;
+	int fd;
+	uint64_t offset;
+	void *block_buf;
+	struct spdk_trace_stream_index_entry *index;
+	uint64_t num_blocks;
+	uint64_t max_blocks;
+#ifdef SPDK_CONFIG_ISAL
+	struct isal_zstream zstream;
+	uint8_t *level_buf;
+#endif
+};
+
+static struct trace_stream_ctx g_stream = { .fd = -1 };
+
 static int
 input_trace_file_mmap(struct aggr_trace_record_ctx *ctx, const char *shm_name)
 {
@@ -70,6 +106,14 @@ input_trace_file_mmap(struct aggr_trace_record_ctx *ctx, const char *shm_name)
 
 	ctx->trace_histories = (struct spdk_trace_histories *)history_ptr;
 
+	if (ctx->trace_histories->flags.version != SPDK_TRACE_VERSION) {
+		fprintf(stderr, "Trace shm %s has version %ju, expected %d.\n", shm_name,
+			ctx->trace_histories->flags.version, SPDK_TRACE_VERSION);
+		munmap(history_ptr, sizeof(struct spdk_trace_histories));
+		close(ctx->shm_fd);
+		return -1;
+	}
+
 	g_tsc_rate = ctx->trace_histories->flags.tsc_rate;
 	g_utsc_rate = g_tsc_rate / 1000;
 	if (g_tsc_rate == 0) {
@@ -94,7 +138,7 @@ input_trace_file_mmap(struct aggr_trace_record_ctx *ctx, const char *shm_name)
 	}
 
 	ctx->trace_histories = (struct spdk_trace_histories *)history_ptr;
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		struct spdk_trace_history *history;
 
 		history = spdk_get_per_lcore_history(ctx->trace_histories, i);
@@ -110,17 +154,96 @@ input_trace_file_mmap(struct aggr_trace_record_ctx *ctx, const char *shm_name)
 	return 0;
 }
 
+static int
+lcore_trace_file_open(struct lcore_trace_record_ctx *port_ctx, int lcore)
+{
+	if (g_stream.enabled) {
+		port_ctx->stream_entries = calloc(SPDK_TRACE_STREAM_BLOCK_ENTRIES,
+						  sizeof(struct spdk_trace_entry));
+		if (port_ctx->stream_entries == NULL) {
+			fprintf(stderr, "Failed to allocate memory for stream entries.\n");
+			return -1;
+		}
+	} else {
+		port_ctx->fd = open(port_ctx->lcore_file, O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (port_ctx->fd < 0) {
+			fprintf(stderr, "Could not open lcore file %s.\n", port_ctx->lcore_file);
+			return -1;
+		}
+
+		if (g_verbose) {
+			printf("Create tmp lcore trace file %s for lcore %d\n", port_ctx->lcore_file, lcore);
+		}
+	}
+
+	port_ctx->out_history = calloc(1, sizeof(struct spdk_trace_history));
+	if (port_ctx->out_history == NULL) {
+		fprintf(stderr, "Failed to allocate memory for out_history.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Threads that aren't running on an lcore register their trace histories at runtime, growing
+ * the shm file.  Remap it and start recording the new histories.
+ */
+static int
+input_trace_file_remap(struct aggr_trace_record_ctx *ctx)
+{
+	struct spdk_trace_history *history;
+	uint64_t histories_size;
+	void *history_ptr;
+	int i, rc;
+
+	histories_size = spdk_get_trace_histories_size(ctx->trace_histories);
+	if (histories_size == g_histories_size) {
+		return 0;
+	}
+
+	history_ptr = mmap(NULL, histories_size, PROT_READ, MAP_SHARED, ctx->shm_fd, 0);
+	if (history_ptr == MAP_FAILED) {
+		fprintf(stderr, "Could not remmap shm.\n");
+		return -1;
+	}
+
+	munmap(ctx->trace_histories, g_histories_size);
+	ctx->trace_histories = (struct spdk_trace_histories *)history_ptr;
+	g_histories_size = histories_size;
+
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		history = spdk_get_per_lcore_history(ctx->trace_histories, i);
+		ctx->lcore_ports[i].in_history = history;
+		if (history == NULL || ctx->lcore_ports[i].valid) {
+			continue;
+		}
+
+		if (g_verbose) {
+			printf("Number of trace entries for thread (%d): %ju\n", i,
+			       history->num_entries);
+		}
+
+		rc = lcore_trace_file_open(&ctx->lcore_ports[i], i);
+		if (rc) {
+			return rc;
+		}
+		ctx->lcore_ports[i].valid = true;
+	}
+
+	return 0;
+}
+
 static int
 output_trace_files_prepare(struct aggr_trace_record_ctx *ctx, const char *aggr_path)
 {
-	int flags = O_CREAT | O_EXCL | O_RDWR;
 	struct lcore_trace_record_ctx *port_ctx;
 	int name_len;
 	int i, rc;
 
 	/* Assign file names for related trace files */
 	ctx->out_file = aggr_path;
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		port_ctx = &ctx->lcore_ports[i];
 
 		/* Get the length of trace file name for each lcore with format "%s-%d" */
@@ -139,7 +262,7 @@ output_trace_files_prepare(struct aggr_trace_record_ctx *ctx, const char *aggr_p
 			goto err;
 		}
 
-		for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+		for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 			port_ctx = &ctx->lcore_ports[i];
 			if (access(port_ctx->lcore_file, F_OK) == 0) {
 				rc = unlink(port_ctx->lcore_file);
@@ -151,26 +274,15 @@ output_trace_files_prepare(struct aggr_trace_record_ctx *ctx, const char *aggr_p
 
 	}
 
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		port_ctx = &ctx->lcore_ports[i];
 
 		if (!port_ctx->valid) {
 			continue;
 		}
 
-		port_ctx->fd = open(port_ctx->lcore_file, flags, 0600);
-		if (port_ctx->fd < 0) {
-			fprintf(stderr, "Could not open lcore file %s.\n", port_ctx->lcore_file);
-			goto err;
-		}
-
-		if (g_verbose) {
-			printf("Create tmp lcore trace file %s for lcore %d\n", port_ctx->lcore_file, i);
-		}
-
-		port_ctx->out_history = calloc(1, sizeof(struct spdk_trace_history));
-		if (port_ctx->out_history == NULL) {
-			fprintf(stderr, "Failed to allocate memory for out_history.\n");
+		rc = lcore_trace_file_open(port_ctx, i);
+		if (rc) {
 			goto err;
 		}
 	}
@@ -178,7 +290,7 @@ output_trace_files_prepare(struct aggr_trace_record_ctx *ctx, const char *aggr_p
 	return 0;
 
 err:
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		port_ctx = &ctx->lcore_ports[i];
 		free(port_ctx->out_history);
 
@@ -196,7 +308,7 @@ output_trace_files_finish(struct aggr_trace_record_ctx *ctx)
 	struct lcore_trace_record_ctx *port_ctx;
 	int i;
 
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		port_ctx = &ctx->lcore_ports[i];
 
 		free(port_ctx->out_history);
@@ -226,6 +338,7 @@ cont_write(int fildes, const void *buf, size_t nbyte)
 		}
 
 		_nbyte -= rc;
+		buf = (const uint8_t *)buf + rc;
 	}
 
 	return nbyte;
@@ -250,11 +363,167 @@ cont_read(int fildes, void *buf, size_t nbyte)
 		}
 
 		_nbyte -= rc;
+		buf = (uint8_t *)buf + rc;
 	}
 
 	return nbyte;
 }
 
+static int
+trace_stream_write_block(struct lcore_trace_record_ctx *lcore_port)
+{
+	struct spdk_trace_stream_block block = {};
+	struct spdk_trace_stream_index_entry *index;
+	uint32_t num_entries = lcore_port->num_stream_entries;
+	const void *data = lcore_port->stream_entries;
+	int rc;
+
+	if (num_entries == 0) {
+		return 0;
+	}
+
+	block.magic = SPDK_TRACE_STREAM_BLOCK_MAGIC;
+	block.lcore = lcore_port->in_history->lcore;
+	block.encoding = SPDK_TRACE_STREAM_ENCODING_RAW;
+	block.num_entries = num_entries;
+	block.data_size = num_entries * sizeof(struct spdk_trace_entry);
+	block.first_tsc = lcore_port->stream_entries[0].tsc;
+	block.last_tsc = lcore_port->stream_entries[num_entries - 1].tsc;
+
+#ifdef SPDK_CONFIG_ISAL
+	isal_deflate_stateless_init(&g_stream.zstream);
+	g_stream.zstream.level = 1;
+	g_stream.zstream.level_buf = g_stream.level_buf;
+	g_stream.zstream.level_buf_size = ISAL_DEF_LVL1_DEFAULT;
+	g_stream.zstream.end_of_stream = 1;
+	g_stream.zstream.flush = NO_FLUSH;
+	g_stream.zstream.next_in = (uint8_t *)lcore_port->stream_entries;
+	g_stream.zstream.avail_in = block.data_size;
+	/* Only keep the compressed data if it's smaller, otherwise the block is stored raw */
+	g_stream.zstream.next_out = g_stream.block_buf;
+	g_stream.zstream.avail_out = block.data_size;
+
+	if (isal_deflate_stateless(&g_stream.zstream) == COMP_OK) {
+		block.encoding = SPDK_TRACE_STREAM_ENCODING_DEFLATE;
+		block.data_size = g_stream.zstream.total_out;
+		data = g_stream.block_buf;
+	}
+#endif
+
+	if (g_stream.num_blocks == g_stream.max_blocks) {
+		index = realloc(g_stream.index, sizeof(*index) * spdk_max(g_stream.max_blocks * 2, 64));
+		if (index == NULL) {
+			fprintf(stderr, "Failed to allocate memory for trace stream index.\n");
+			return -1;
+		}
+		g_stream.index = index;
+		g_stream.max_blocks = spdk_max(g_stream.max_blocks * 2, 64);
+	}
+
+	rc = cont_write(g_stream.fd, &block, sizeof(block));
+	if (rc < 0) {
+		fprintf(stderr, "Failed to write trace block header into trace file\n");
+		return rc;
+	}
+
+	rc = cont_write(g_stream.fd, data, block.data_size);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to write trace block into trace file\n");
+		return rc;
+	}
+
+	index = &g_stream.index[g_stream.num_blocks++];
+	index->offset = g_stream.offset;
+	index->first_tsc = block.first_tsc;
+	index->last_tsc = block.last_tsc;
+	index->num_entries = block.num_entries;
+	index->lcore = block.lcore;
+
+	g_stream.offset += sizeof(block) + block.data_size;
+	lcore_port->num_stream_entries = 0;
+
+	return 0;
+}
+
+static uint64_t
+trace_stream_get_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * SPDK_SEC_TO_USEC + ts.tv_nsec / 1000;
+}
+
+static int
+trace_stream_append(struct lcore_trace_record_ctx *lcore_port, struct spdk_trace_entry *entries,
+		    uint64_t count)
+{
+	uint64_t num_entries;
+	int rc;
+
+	while (count > 0) {
+		if (lcore_port->num_stream_entries == 0) {
+			lcore_port->stream_flush_us = trace_stream_get_time_us() + TRACE_STREAM_FLUSH_US;
+		}
+
+		num_entries = spdk_min(count, SPDK_TRACE_STREAM_BLOCK_ENTRIES -
+				       lcore_port->num_stream_entries);
+		memcpy(&lcore_port->stream_entries[lcore_port->num_stream_entries], entries,
+		       num_entries * sizeof(*entries));
+		lcore_port->num_stream_entries += num_entries;
+		entries += num_entries;
+		count -= num_entries;
+
+		if (lcore_port->num_stream_entries == SPDK_TRACE_STREAM_BLOCK_ENTRIES) {
+			rc = trace_stream_write_block(lcore_port);
+			if (rc) {
+				return rc;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Write out the blocks which have been partially filled for too long, so that the file doesn't
+ *  lag behind when there are few entries and so that they aren't lost if the recorder is killed.
+ */
+static int
+trace_stream_flush(struct aggr_trace_record_ctx *ctx)
+{
+	struct lcore_trace_record_ctx *lcore_port;
+	uint64_t now = trace_stream_get_time_us();
+	int i, rc;
+
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		lcore_port = &ctx->lcore_ports[i];
+		if (!lcore_port->valid || lcore_port->num_stream_entries == 0 ||
+		    now < lcore_port->stream_flush_us) {
+			continue;
+		}
+
+		rc = trace_stream_write_block(lcore_port);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static int
+lcore_trace_write(struct lcore_trace_record_ctx *lcore_port, struct spdk_trace_entry *entries,
+		  uint64_t count)
+{
+	if (g_stream.enabled) {
+		return trace_stream_append(lcore_port, entries, count);
+	}
+
+	return cont_write(lcore_port->fd, entries, sizeof(struct spdk_trace_entry) * count);
+}
+
 static int
 lcore_trace_last_entry_idx(struct spdk_trace_history *in_history, int cir_next_idx)
 {
@@ -270,8 +539,8 @@ lcore_trace_last_entry_idx(struct spdk_trace_history *in_history, int cir_next_i
 }
 
 static int
-circular_buffer_padding_backward(int fd, struct spdk_trace_history *in_history,
-				 int cir_start, int cir_end)
+circular_buffer_padding_backward(struct lcore_trace_record_ctx *lcore_port,
+				 struct spdk_trace_history *in_history, int cir_start, int cir_end)
 {
 	int rc;
 
@@ -280,8 +549,7 @@ circular_buffer_padding_backward(int fd, struct spdk_trace_history *in_history,
 		return -1;
 	}
 
-	rc = cont_write(fd, &in_history->entries[cir_start],
-			sizeof(struct spdk_trace_entry) * (cir_end - cir_start));
+	rc = lcore_trace_write(lcore_port, &in_history->entries[cir_start], cir_end - cir_start);
 	if (rc < 0) {
 		fprintf(stderr, "Failed to append entries into lcore file\n");
 		return rc;
@@ -291,8 +559,8 @@ circular_buffer_padding_backward(int fd, struct spdk_trace_history *in_history,
 }
 
 static int
-circular_buffer_padding_across(int fd, struct spdk_trace_history *in_history,
-			       int cir_start, int cir_end)
+circular_buffer_padding_across(struct lcore_trace_record_ctx *lcore_port,
+			       struct spdk_trace_history *in_history, int cir_start, int cir_end)
 {
 	int rc;
 	int num_entries = in_history->num_entries;
@@ -302,8 +570,7 @@ circular_buffer_padding_across(int fd, struct spdk_trace_history *in_history,
 		return -1;
 	}
 
-	rc = cont_write(fd, &in_history->entries[cir_start],
-			sizeof(struct spdk_trace_entry) * (num_entries - cir_start));
+	rc = lcore_trace_write(lcore_port, &in_history->entries[cir_start], num_entries - cir_start);
 	if (rc < 0) {
 		fprintf(stderr, "Failed to append entries into lcore file backward\n");
 		return rc;
@@ -313,7 +580,7 @@ circular_buffer_padding_across(int fd, struct spdk_trace_history *in_history,
 		return 0;
 	}
 
-	rc = cont_write(fd, &in_history->entries[0], sizeof(struct spdk_trace_entry) * cir_end);
+	rc = lcore_trace_write(lcore_port, &in_history->entries[0], cir_end);
 	if (rc < 0) {
 		fprintf(stderr, "Failed to append entries into lcore file forward\n");
 		return rc;
@@ -323,10 +590,10 @@ circular_buffer_padding_across(int fd, struct spdk_trace_history *in_history,
 }
 
 static int
-circular_buffer_padding_all(int fd, struct spdk_trace_history *in_history,
-			    int cir_end)
+circular_buffer_padding_all(struct lcore_trace_record_ctx *lcore_port,
+			    struct spdk_trace_history *in_history, int cir_end)
 {
-	return circular_buffer_padding_across(fd, in_history, cir_end, cir_end);
+	return circular_buffer_padding_across(lcore_port, in_history, cir_end, cir_end);
 }
 
 static int
@@ -335,7 +602,6 @@ lcore_trace_record(struct lcore_trace_record_ctx *lcore_port)
 	struct spdk_trace_history	*in_history = lcore_port->in_history;
 	uint64_t			rec_next_entry = lcore_port->rec_next_entry;
 	uint64_t			rec_num_entries = lcore_port->num_entries;
-	int				fd = lcore_port->fd;
 	uint64_t			shm_next_entry;
 	uint64_t			num_cir_entries;
 	uint64_t			shm_cir_next;
@@ -371,7 +637,7 @@ lcore_trace_record(struct lcore_trace_record_ctx *lcore_port)
 			lcore_port->first_entry_tsc = in_history->entries[0].tsc;
 
 			lcore_port->num_entries += shm_cir_next;
-			rc = circular_buffer_padding_backward(fd, in_history, 0, shm_cir_next);
+			rc = circular_buffer_padding_backward(lcore_port, in_history, 0, shm_cir_next);
 		} else {
 			/* Updates have already been across circular buffer.
 			 * The eldest entry in shared memory is pointed by shm_cir_next.
@@ -379,7 +645,7 @@ lcore_trace_record(struct lcore_trace_record_ctx *lcore_port)
 			lcore_port->first_entry_tsc = in_history->entries[shm_cir_next].tsc;
 
 			lcore_port->num_entries += num_cir_entries;
-			rc = circular_buffer_padding_all(fd, in_history, shm_cir_next);
+			rc = circular_buffer_padding_all(lcore_port, in_history, shm_cir_next);
 		}
 
 		goto out;
@@ -389,13 +655,14 @@ lcore_trace_record(struct lcore_trace_record_ctx *lcore_port)
 		/* There must be missed updates */
 		fprintf(stderr, "Trace-record missed %ju trace entries\n",
 			shm_next_entry - rec_next_entry - num_cir_entries);
+		lcore_port->num_dropped += shm_next_entry - rec_next_entry - num_cir_entries;
 
 		lcore_port->num_entries += num_cir_entries;
-		rc = circular_buffer_padding_all(fd, in_history, shm_cir_next);
+		rc = circular_buffer_padding_all(lcore_port, in_history, shm_cir_next);
 	} else if (shm_next_entry - rec_next_entry == num_cir_entries) {
 		/* All circular buffer is updated */
 		lcore_port->num_entries += num_cir_entries;
-		rc = circular_buffer_padding_all(fd, in_history, shm_cir_next);
+		rc = circular_buffer_padding_all(lcore_port, in_history, shm_cir_next);
 	} else {
 		/* Part of circular buffer is updated */
 		rec_cir_next = rec_next_entry & (num_cir_entries - 1);
@@ -403,11 +670,11 @@ lcore_trace_record(struct lcore_trace_record_ctx *lcore_port)
 		if (shm_cir_next > rec_cir_next) {
 			/* Updates are not across circular buffer */
 			lcore_port->num_entries += shm_cir_next - rec_cir_next;
-			rc = circular_buffer_padding_backward(fd, in_history, rec_cir_next, shm_cir_next);
+			rc = circular_buffer_padding_backward(lcore_port, in_history, rec_cir_next, shm_cir_next);
 		} else {
 			/* Updates are across circular buffer */
 			lcore_port->num_entries += num_cir_entries - rec_cir_next + shm_cir_next;
-			rc = circular_buffer_padding_across(fd, in_history, rec_cir_next, shm_cir_next);
+			rc = circular_buffer_padding_across(lcore_port, in_history, rec_cir_next, shm_cir_next);
 		}
 	}
 
@@ -438,7 +705,7 @@ trace_files_aggregate(struct aggr_trace_record_ctx *ctx)
 	int flags = O_CREAT | O_EXCL | O_RDWR;
 	struct lcore_trace_record_ctx *lcore_port;
 	char copy_buff[TRACE_FILE_COPY_SIZE];
-	uint64_t lcore_offsets[SPDK_TRACE_MAX_LCORE + 1];
+	uint64_t lcore_offsets[SPDK_TRACE_MAX_HISTORIES + 1];
 	int rc, i;
 	ssize_t len = 0;
 	uint64_t current_offset;
@@ -464,7 +731,7 @@ trace_files_aggregate(struct aggr_trace_record_ctx *ctx)
 
 	/* Update and append lcore offsets converged trace file */
 	current_offset = sizeof(struct spdk_trace_flags);
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		lcore_port = &ctx->lcore_ports[i];
 		if (lcore_port->valid) {
 			lcore_offsets[i] = current_offset;
@@ -473,7 +740,7 @@ trace_files_aggregate(struct aggr_trace_record_ctx *ctx)
 			lcore_offsets[i] = 0;
 		}
 	}
-	lcore_offsets[SPDK_TRACE_MAX_LCORE] = current_offset;
+	lcore_offsets[SPDK_TRACE_MAX_HISTORIES] = current_offset;
 
 	rc = cont_write(ctx->out_fd, lcore_offsets, sizeof(lcore_offsets));
 	if (rc < 0) {
@@ -482,7 +749,7 @@ trace_files_aggregate(struct aggr_trace_record_ctx *ctx)
 	}
 
 	/* Append each lcore trace file into converged trace file */
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		lcore_port = &ctx->lcore_ports[i];
 
 		if (!lcore_port->valid) {
@@ -529,6 +796,123 @@ out:
 	return rc;
 }
 
+static int
+trace_stream_prepare(struct aggr_trace_record_ctx *ctx, const char *path)
+{
+	struct spdk_trace_stream_header header = {};
+	int i, rc;
+
+	ctx->out_file = path;
+	if (access(ctx->out_file, F_OK) == 0 && unlink(ctx->out_file) != 0) {
+		fprintf(stderr, "Could not remove existing trace file %s.\n", ctx->out_file);
+		return -1;
+	}
+
+	g_stream.fd = open(ctx->out_file, O_CREAT | O_EXCL | O_WRONLY, 0600);
+	if (g_stream.fd < 0) {
+		fprintf(stderr, "Could not open trace file %s.\n", ctx->out_file);
+		return -1;
+	}
+
+	g_stream.block_buf = malloc(SPDK_TRACE_STREAM_BLOCK_ENTRIES * sizeof(struct spdk_trace_entry));
+	if (g_stream.block_buf == NULL) {
+		fprintf(stderr, "Failed to allocate memory for trace stream.\n");
+		return -1;
+	}
+
+#ifdef SPDK_CONFIG_ISAL
+	g_stream.level_buf = calloc(1, ISAL_DEF_LVL1_DEFAULT);
+	if (g_stream.level_buf == NULL) {
+		fprintf(stderr, "Failed to allocate memory for trace stream compression.\n");
+		return -1;
+	}
+#endif
+
+	memcpy(header.magic, SPDK_TRACE_STREAM_MAGIC, sizeof(header.magic));
+	header.version = SPDK_TRACE_STREAM_VERSION;
+	memcpy(&header.flags, &ctx->trace_histories->flags, sizeof(header.flags));
+
+	rc = cont_write(g_stream.fd, &header, sizeof(header));
+	if (rc < 0) {
+		fprintf(stderr, "Failed to write trace header into trace file\n");
+		return rc;
+	}
+	g_stream.offset = sizeof(header);
+
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		if (!ctx->lcore_ports[i].valid) {
+			continue;
+		}
+
+		rc = lcore_trace_file_open(&ctx->lcore_ports[i], i);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	if (g_verbose) {
+		printf("Stream trace entries into %s\n", ctx->out_file);
+	}
+
+	return 0;
+}
+
+static int
+trace_stream_finish(struct aggr_trace_record_ctx *ctx)
+{
+	struct spdk_trace_stream_footer footer = {};
+	struct lcore_trace_record_ctx *lcore_port;
+	int i, rc = 0;
+
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		lcore_port = &ctx->lcore_ports[i];
+		if (!lcore_port->valid) {
+			continue;
+		}
+
+		rc = trace_stream_write_block(lcore_port);
+		if (rc) {
+			goto out;
+		}
+
+		footer.num_entries[i] = lcore_port->num_entries;
+		footer.num_dropped[i] = lcore_port->num_dropped;
+	}
+
+	footer.index_offset = g_stream.offset;
+	footer.num_blocks = g_stream.num_blocks;
+	memcpy(footer.magic, SPDK_TRACE_STREAM_MAGIC, sizeof(footer.magic));
+
+	rc = cont_write(g_stream.fd, g_stream.index, sizeof(*g_stream.index) * g_stream.num_blocks);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to write trace stream index into trace file\n");
+		goto out;
+	}
+
+	rc = cont_write(g_stream.fd, &footer, sizeof(footer));
+	if (rc < 0) {
+		fprintf(stderr, "Failed to write trace stream footer into trace file\n");
+		goto out;
+	}
+
+	rc = 0;
+	printf("All lcores trace entries are streamed into trace file %s (%ju blocks, %ju bytes)\n",
+	       ctx->out_file, g_stream.num_blocks, g_stream.offset);
+out:
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		free(ctx->lcore_ports[i].stream_entries);
+		free(ctx->lcore_ports[i].out_history);
+	}
+	free(g_stream.index);
+	free(g_stream.block_buf);
+#ifdef SPDK_CONFIG_ISAL
+	free(g_stream.level_buf);
+#endif
+	close(g_stream.fd);
+
+	return rc;
+}
+
 static void
 __shutdown_signal(int signo)
 {
@@ -575,6 +959,8 @@ usage(void)
 	printf("                 '-p' to specify the trace PID\n");
 	printf("                      (one of -i or -p must be specified)\n");
 	printf("                 '-f' to specify output trace file name\n");
+	printf("                 '-z' to stream the entries into the output file as they are\n");
+	printf("                      recorded, in compressed blocks\n");
 	printf("                 '-h' to print usage information\n");
 }
 
@@ -590,9 +976,11 @@ main(int argc, char **argv)
 	int				i;
 	struct aggr_trace_record_ctx	ctx = {};
 	struct lcore_trace_record_ctx	*lcore_port;
+	uint64_t			num_entries;
+	bool				idle;
 
 	g_exe_name = argv[0];
-	while ((op = getopt(argc, argv, "f:i:p:qs:h")) != -1) {
+	while ((op = getopt(argc, argv, "f:i:p:qs:hz")) != -1) {
 		switch (op) {
 		case 'i':
 			shm_id = spdk_strtol(optarg, 10);
@@ -609,6 +997,9 @@ main(int argc, char **argv)
 		case 'f':
 			file_name = optarg;
 			break;
+		case 'z':
+			g_stream.enabled = true;
+			break;
 		case 'h':
 			usage();
 			exit(EXIT_SUCCESS);
@@ -652,23 +1043,42 @@ main(int argc, char **argv)
 		exit(1);
 	}
 
-	rc = output_trace_files_prepare(&ctx, file_name);
+	if (g_stream.enabled) {
+		rc = trace_stream_prepare(&ctx, file_name);
+	} else {
+		rc = output_trace_files_prepare(&ctx, file_name);
+	}
 	if (rc) {
 		exit(1);
 	}
 
 	printf("Start to poll trace shm file %s\n", shm_name);
 	while (!g_shutdown && rc == 0) {
-		for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+		rc = input_trace_file_remap(&ctx);
+		if (rc) {
+			break;
+		}
+
+		idle = true;
+		for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 			lcore_port = &ctx.lcore_ports[i];
 
 			if (!lcore_port->valid) {
 				continue;
 			}
+			num_entries = lcore_port->num_entries;
 			rc = lcore_trace_record(lcore_port);
 			if (rc) {
 				break;
 			}
+			idle = idle && lcore_port->num_entries == num_entries;
+		}
+
+		if (g_stream.enabled && rc == 0) {
+			rc = trace_stream_flush(&ctx);
+			if (idle) {
+				usleep(TRACE_STREAM_IDLE_US);
+			}
 		}
 	}
 
@@ -676,15 +1086,19 @@ main(int argc, char **argv)
 		exit(1);
 	}
 
-	printf("Start to aggregate lcore trace files\n");
-	rc = trace_files_aggregate(&ctx);
+	if (g_stream.enabled) {
+		rc = trace_stream_finish(&ctx);
+	} else {
+		printf("Start to aggregate lcore trace files\n");
+		rc = trace_files_aggregate(&ctx);
+	}
 	if (rc) {
 		exit(1);
 	}
 
 	/* Summary report */
 	printf("TSC Rate: %ju\n", g_tsc_rate);
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		lcore_port = &ctx.lcore_ports[i];
 
 		if (lcore_port->num_entries == 0) {
@@ -694,13 +1108,17 @@ main(int argc, char **argv)
 		printf("Port %ju trace entries for lcore (%d) in %ju usec\n",
 		       lcore_port->num_entries, i,
 		       (lcore_port->last_entry_tsc - lcore_port->first_entry_tsc) / g_utsc_rate);
-
+		if (lcore_port->num_dropped > 0) {
+			printf("Dropped %ju trace entries for lcore (%d)\n", lcore_port->num_dropped, i);
+		}
 	}
 
 	munmap(ctx.trace_histories, g_histories_size);
 	close(ctx.shm_fd);
 
-	output_trace_files_finish(&ctx);
+	if (!g_stream.enabled) {
+		output_trace_files_finish(&ctx);
+	}
 
 	return 0;
 }
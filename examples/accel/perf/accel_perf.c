@@ -11,12 +11,23 @@
 #include "spdk/string.h"
 #include "spdk/accel.h"
 #include "spdk/crc32.h"
+#include "spdk/histogram_data.h"
 #include "spdk/util.h"
 #include "spdk/xor.h"
 
 #define DATA_PATTERN 0x5a
 #define ALIGN_4K 0x1000
 #define COMP_BUF_PAD_PERCENTAGE 1.1L
+#define MAX_WORKLOADS 8
+#define MAX_XFER_SIZES 8
+#define MAX_SEQUENCE_LEN 8
+#define CRYPTO_BLOCK_SIZE 512
+#define CRYPTO_KEY_NAME "accel_perf_key"
+
+struct ap_workload {
+	enum spdk_accel_opcode	opcode;
+	const char		*name;
+};
 
 static uint64_t	g_tsc_rate;
 static uint64_t g_tsc_end;
@@ -37,6 +48,24 @@ static uint32_t g_xor_src_count = 2;
 static bool g_verify = false;
 static const char *g_workload_type = NULL;
 static enum spdk_accel_opcode g_workload_selection;
+/* Opcodes of a mixed workload (-w op1:weight,op2:weight), or a single one */
+static struct ap_workload g_workloads[MAX_WORKLOADS];
+static uint32_t g_workload_weights[MAX_WORKLOADS];
+static uint32_t g_num_workloads = 0;
+static uint32_t g_workloads_weight = 0;
+/* Transfer size distribution (-o size1:weight,size2:weight), g_xfer_size_bytes is the largest */
+static const char *g_xfer_size_str = NULL;
+static uint32_t g_xfer_sizes[MAX_XFER_SIZES];
+static uint32_t g_xfer_size_weights[MAX_XFER_SIZES];
+static uint32_t g_num_xfer_sizes = 0;
+static uint32_t g_xfer_sizes_weight = 0;
+/* Operations executed as a single accel sequence (-S op1,op2,...) */
+static enum spdk_accel_opcode g_sequence[MAX_SEQUENCE_LEN];
+static uint32_t g_sequence_len = 0;
+static const char *g_sequence_str = NULL;
+static struct spdk_accel_crypto_key *g_crypto_key;
+/* Expected contents of the buffers of a sequence not counting the crypto operations */
+static uint8_t *g_seq_ref_buf;
 static struct worker_thread *g_workers = NULL;
 static int g_num_workers = 0;
 static char *g_cd_file_in_name = NULL;
@@ -69,6 +98,11 @@ struct display_info {
 };
 
 struct ap_task {
+	enum spdk_accel_opcode	op_code;
+	/* index of the workload (or 0 for sequences) this task is accounted to */
+	uint32_t		workload_idx;
+	uint32_t		nbytes;
+	uint64_t		submit_tsc;
 	void			*src;
 	struct iovec		*src_iovs;
 	uint32_t		src_iovcnt;
@@ -82,9 +116,24 @@ struct ap_task {
 	struct ap_compress_seg *cur_seg;
 	struct worker_thread	*worker;
 	int			expected_status; /* used for the compare operation */
+	/* buffers of the sequence, each step writing data uses the next one */
+	void			*seq_bufs[MAX_SEQUENCE_LEN + 1];
+	struct iovec		seq_src_iovs[MAX_SEQUENCE_LEN];
+	struct iovec		seq_dst_iovs[MAX_SEQUENCE_LEN];
+	uint32_t		seq_crcs[MAX_SEQUENCE_LEN];
 	TAILQ_ENTRY(ap_task)	link;
 };
 
+struct ap_workload_stats {
+	uint64_t			executed;
+	uint64_t			num_bytes;
+	/* TSC spent submitting the operations, includes execution of synchronous modules */
+	uint64_t			submit_tsc;
+	uint64_t			latency_tsc;
+	uint64_t			max_latency_tsc;
+	struct spdk_histogram_data	*latency;
+};
+
 struct worker_thread {
 	struct spdk_io_channel		*ch;
 	struct spdk_accel_opcode_stats	stats;
@@ -101,12 +150,240 @@ struct worker_thread {
 	void				*task_base;
 	struct display_info		display;
 	enum spdk_accel_opcode		workload;
+	struct ap_workload_stats	workload_stats[MAX_WORKLOADS];
+	uint64_t			busy_tsc;
+};
+
+static const struct ap_workload g_opcode_names[] = {
+	{ SPDK_ACCEL_OPC_COPY, "copy" },
+	{ SPDK_ACCEL_OPC_FILL, "fill" },
+	{ SPDK_ACCEL_OPC_CRC32C, "crc32c" },
+	{ SPDK_ACCEL_OPC_COPY_CRC32C, "copy_crc32c" },
+	{ SPDK_ACCEL_OPC_COMPARE, "compare" },
+	{ SPDK_ACCEL_OPC_DUALCAST, "dualcast" },
+	{ SPDK_ACCEL_OPC_COMPRESS, "compress" },
+	{ SPDK_ACCEL_OPC_DECOMPRESS, "decompress" },
+	{ SPDK_ACCEL_OPC_XOR, "xor" },
+	{ SPDK_ACCEL_OPC_ENCRYPT, "encrypt" },
+	{ SPDK_ACCEL_OPC_DECRYPT, "decrypt" },
 };
 
+static const char *
+opcode_name(enum spdk_accel_opcode opcode)
+{
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_opcode_names); i++) {
+		if (g_opcode_names[i].opcode == opcode) {
+			return g_opcode_names[i].name;
+		}
+	}
+
+	return "unknown";
+}
+
+static int
+parse_opcode(const char *name, enum spdk_accel_opcode *opcode)
+{
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_opcode_names); i++) {
+		if (strcmp(g_opcode_names[i].name, name) == 0) {
+			*opcode = g_opcode_names[i].opcode;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+/* Parse a comma separated list of "value[:weight]" elements */
+static int
+parse_weighted_list(const char *str, uint32_t max, int (*parse_fn)(const char *value, uint32_t idx),
+		    uint32_t *weights, uint32_t *count, uint32_t *total_weight)
+{
+	char *list, *tok, *saveptr = NULL, *weight;
+	long val;
+	int rc = 0;
+
+	list = strdup(str);
+	if (list == NULL) {
+		return -ENOMEM;
+	}
+
+	*count = 0;
+	*total_weight = 0;
+	for (tok = strtok_r(list, ",", &saveptr); tok != NULL; tok = strtok_r(NULL, ",", &saveptr)) {
+		if (*count == max) {
+			fprintf(stderr, "At most %u elements can be specified in %s\n", max, str);
+			rc = -EINVAL;
+			break;
+		}
+
+		weight = strchr(tok, ':');
+		if (weight != NULL) {
+			*weight++ = '\0';
+			val = spdk_strtol(weight, 10);
+			if (val <= 0) {
+				fprintf(stderr, "Invalid weight: %s\n", weight);
+				rc = -EINVAL;
+				break;
+			}
+		} else {
+			val = 1;
+		}
+
+		rc = parse_fn(tok, *count);
+		if (rc != 0) {
+			break;
+		}
+
+		weights[*count] = val;
+		*total_weight += val;
+		(*count)++;
+	}
+
+	free(list);
+
+	return rc != 0 ? rc : (*count > 0 ? 0 : -EINVAL);
+}
+
+static uint32_t
+pick_weighted(const uint32_t *weights, uint32_t count, uint32_t total_weight)
+{
+	uint32_t i, r;
+
+	if (count <= 1) {
+		return 0;
+	}
+
+	r = rand() % total_weight;
+	for (i = 0; i < count - 1; i++) {
+		if (r < weights[i]) {
+			break;
+		}
+		r -= weights[i];
+	}
+
+	return i;
+}
+
+static int
+parse_workload(const char *value, uint32_t idx)
+{
+	if (parse_opcode(value, &g_workloads[idx].opcode) != 0 ||
+	    g_workloads[idx].opcode == SPDK_ACCEL_OPC_ENCRYPT ||
+	    g_workloads[idx].opcode == SPDK_ACCEL_OPC_DECRYPT) {
+		fprintf(stderr, "Unsupported workload type: %s\n", value);
+		return -EINVAL;
+	}
+	g_workloads[idx].name = opcode_name(g_workloads[idx].opcode);
+
+	return 0;
+}
+
+static int
+parse_xfer_size(const char *value, uint32_t idx)
+{
+	long val;
+
+	val = spdk_strtol(value, 10);
+	if (val < 0) {
+		fprintf(stderr, "Invalid transfer size: %s\n", value);
+		return -EINVAL;
+	}
+	g_xfer_sizes[idx] = val;
+	if (idx == 0 || (uint32_t)val > (uint32_t)g_xfer_size_bytes) {
+		g_xfer_size_bytes = val;
+	}
+
+	return 0;
+}
+
+static int
+parse_sequence(const char *str)
+{
+	char *list, *tok, *saveptr = NULL;
+	int rc = 0;
+
+	list = strdup(str);
+	if (list == NULL) {
+		return -ENOMEM;
+	}
+
+	g_sequence_len = 0;
+	for (tok = strtok_r(list, ",", &saveptr); tok != NULL; tok = strtok_r(NULL, ",", &saveptr)) {
+		if (g_sequence_len == MAX_SEQUENCE_LEN) {
+			fprintf(stderr, "A sequence can have at most %u operations\n", MAX_SEQUENCE_LEN);
+			rc = -EINVAL;
+			break;
+		}
+		rc = parse_opcode(tok, &g_sequence[g_sequence_len]);
+		if (rc != 0) {
+			fprintf(stderr, "Unknown operation: %s\n", tok);
+			break;
+		}
+
+		switch (g_sequence[g_sequence_len]) {
+		case SPDK_ACCEL_OPC_FILL:
+			if (g_sequence_len != 0) {
+				fprintf(stderr, "fill can only be the first operation of a sequence\n");
+				rc = -EINVAL;
+			}
+			break;
+		case SPDK_ACCEL_OPC_COPY:
+		case SPDK_ACCEL_OPC_CRC32C:
+		case SPDK_ACCEL_OPC_ENCRYPT:
+		case SPDK_ACCEL_OPC_DECRYPT:
+			break;
+		default:
+			fprintf(stderr, "Operation %s is not supported in a sequence\n", tok);
+			rc = -EINVAL;
+			break;
+		}
+		if (rc != 0) {
+			break;
+		}
+		g_sequence_len++;
+	}
+
+	free(list);
+
+	return rc != 0 ? rc : (g_sequence_len > 0 ? 0 : -EINVAL);
+}
+
+/* Mixed workloads, size distributions and sequences are accounted by accel_perf itself */
+static bool
+is_mixed_workload(void)
+{
+	return g_num_workloads > 1 || g_num_xfer_sizes > 1 || g_sequence_len > 0;
+}
+
+static bool
+workload_has(enum spdk_accel_opcode opcode)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_num_workloads; i++) {
+		if (g_workloads[i].opcode == opcode) {
+			return true;
+		}
+	}
+
+	for (i = 0; i < g_sequence_len; i++) {
+		if (g_sequence[i] == opcode) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static void
 dump_user_config(void)
 {
 	const char *module_name = NULL;
+	uint32_t i;
 	int rc;
 
 	rc = spdk_accel_get_opc_module_name(g_workload_selection, &module_name);
@@ -117,25 +394,59 @@ dump_user_config(void)
 	printf("\nSPDK Configuration:\n");
 	printf("Core mask:      %s\n\n", g_opts.reactor_mask);
 	printf("Accel Perf Configuration:\n");
-	printf("Workload Type:  %s\n", g_workload_type);
-	if (g_workload_selection == SPDK_ACCEL_OPC_CRC32C ||
-	    g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
+	if (g_sequence_len > 0) {
+		printf("Sequence:      ");
+		for (i = 0; i < g_sequence_len; i++) {
+			spdk_accel_get_opc_module_name(g_sequence[i], &module_name);
+			printf(" %s(%s)", opcode_name(g_sequence[i]), module_name);
+		}
+		printf("\n");
+		if (g_num_xfer_sizes > 1) {
+			printf("Transfer sizes: %s\n", g_xfer_size_str);
+		} else {
+			printf("Transfer size:  %u bytes\n", g_xfer_size_bytes);
+		}
+		printf("Queue depth:    %u\n", g_queue_depth);
+		printf("# threads/core: %u\n", g_threads_per_core);
+		printf("Run time:       %u seconds\n", g_time_in_sec);
+		printf("Verify:         %s\n\n", g_verify ? "Yes" : "No");
+		return;
+	}
+
+	if (g_num_workloads > 1) {
+		printf("Workload Type: ");
+		for (i = 0; i < g_num_workloads; i++) {
+			spdk_accel_get_opc_module_name(g_workloads[i].opcode, &module_name);
+			printf(" %s(%s):%u", g_workloads[i].name, module_name, g_workload_weights[i]);
+		}
+		printf("\n");
+	} else {
+		printf("Workload Type:  %s\n", g_workload_type);
+	}
+	if (workload_has(SPDK_ACCEL_OPC_CRC32C) || workload_has(SPDK_ACCEL_OPC_COPY_CRC32C)) {
 		printf("CRC-32C seed:   %u\n", g_crc32c_seed);
-	} else if (g_workload_selection == SPDK_ACCEL_OPC_FILL) {
+	}
+	if (workload_has(SPDK_ACCEL_OPC_FILL)) {
 		printf("Fill pattern:   0x%x\n", g_fill_pattern);
-	} else if ((g_workload_selection == SPDK_ACCEL_OPC_COMPARE) && g_fail_percent_goal > 0) {
+	}
+	if (workload_has(SPDK_ACCEL_OPC_COMPARE) && g_fail_percent_goal > 0) {
 		printf("Failure inject: %u percent\n", g_fail_percent_goal);
-	} else if (g_workload_selection == SPDK_ACCEL_OPC_XOR) {
+	}
+	if (workload_has(SPDK_ACCEL_OPC_XOR)) {
 		printf("Source buffers: %u\n", g_xor_src_count);
 	}
-	if (g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
+	if (g_num_xfer_sizes > 1) {
+		printf("Transfer sizes: %s\n", g_xfer_size_str);
+	} else if (g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
 		printf("Vector size:    %u bytes\n", g_xfer_size_bytes);
 		printf("Transfer size:  %u bytes\n", g_xfer_size_bytes * g_chained_count);
 	} else {
 		printf("Transfer size:  %u bytes\n", g_xfer_size_bytes);
 	}
 	printf("vector count    %u\n", g_chained_count);
-	printf("Module:         %s\n", module_name);
+	if (g_num_workloads == 1) {
+		printf("Module:         %s\n", module_name);
+	}
 	if (g_workload_selection == SPDK_ACCEL_OPC_COMPRESS ||
 	    g_workload_selection == SPDK_ACCEL_OPC_DECOMPRESS) {
 		printf("File Name:      %s\n", g_cd_file_in_name);
@@ -157,8 +468,11 @@ usage(void)
 	printf("\t[-T number of threads per core\n");
 	printf("\t[-n number of channels]\n");
 	printf("\t[-o transfer size in bytes (default: 4KiB. For compress/decompress, 0 means the input file size)]\n");
+	printf("\t\tA distribution of sizes can be given as size:weight,size:weight,...\n");
 	printf("\t[-t time in seconds]\n");
 	printf("\t[-w workload type must be one of these: copy, fill, crc32c, copy_crc32c, compare, compress, decompress, dualcast, xor\n");
+	printf("\t\tA mix of workloads can be given as type:weight,type:weight,... (except compress, decompress and compare)\n");
+	printf("\t[-S execute a sequence of operations, e.g. decrypt,copy,crc32c. Supported: fill (first only), copy, crc32c, encrypt, decrypt]\n");
 	printf("\t[-l for compress/decompress workloads, name of uncompressed input file\n");
 	printf("\t[-s for crc32c workload, use this seed value (default 0)\n");
 	printf("\t[-P for compare workload, percentage of operations that should miscompare (percent, default 0)\n");
@@ -179,7 +493,6 @@ parse_args(int argc, char *argv)
 	case 'C':
 	case 'f':
 	case 'T':
-	case 'o':
 	case 'P':
 	case 'q':
 	case 's':
@@ -213,7 +526,19 @@ parse_args(int argc, char *argv)
 		g_threads_per_core = argval;
 		break;
 	case 'o':
-		g_xfer_size_bytes = argval;
+		g_xfer_size_str = optarg;
+		if (parse_weighted_list(optarg, MAX_XFER_SIZES, parse_xfer_size, g_xfer_size_weights,
+					&g_num_xfer_sizes, &g_xfer_sizes_weight) != 0) {
+			usage();
+			return 1;
+		}
+		break;
+	case 'S':
+		g_sequence_str = optarg;
+		if (parse_sequence(optarg) != 0) {
+			usage();
+			return 1;
+		}
 		break;
 	case 'P':
 		g_fail_percent_goal = argval;
@@ -235,28 +560,12 @@ parse_args(int argc, char *argv)
 		break;
 	case 'w':
 		g_workload_type = optarg;
-		if (!strcmp(g_workload_type, "copy")) {
-			g_workload_selection = SPDK_ACCEL_OPC_COPY;
-		} else if (!strcmp(g_workload_type, "fill")) {
-			g_workload_selection = SPDK_ACCEL_OPC_FILL;
-		} else if (!strcmp(g_workload_type, "crc32c")) {
-			g_workload_selection = SPDK_ACCEL_OPC_CRC32C;
-		} else if (!strcmp(g_workload_type, "copy_crc32c")) {
-			g_workload_selection = SPDK_ACCEL_OPC_COPY_CRC32C;
-		} else if (!strcmp(g_workload_type, "compare")) {
-			g_workload_selection = SPDK_ACCEL_OPC_COMPARE;
-		} else if (!strcmp(g_workload_type, "dualcast")) {
-			g_workload_selection = SPDK_ACCEL_OPC_DUALCAST;
-		} else if (!strcmp(g_workload_type, "compress")) {
-			g_workload_selection = SPDK_ACCEL_OPC_COMPRESS;
-		} else if (!strcmp(g_workload_type, "decompress")) {
-			g_workload_selection = SPDK_ACCEL_OPC_DECOMPRESS;
-		} else if (!strcmp(g_workload_type, "xor")) {
-			g_workload_selection = SPDK_ACCEL_OPC_XOR;
-		} else {
+		if (parse_weighted_list(optarg, MAX_WORKLOADS, parse_workload, g_workload_weights,
+					&g_num_workloads, &g_workloads_weight) != 0) {
 			usage();
 			return 1;
 		}
+		g_workload_selection = g_workloads[0].opcode;
 		break;
 	default:
 		usage();
@@ -271,9 +580,23 @@ static void
 unregister_worker(void *arg1)
 {
 	struct worker_thread *worker = arg1;
+	struct spdk_thread_stats thread_stats;
+	uint32_t i;
 
 	spdk_accel_get_opcode_stats(worker->ch, worker->workload,
 				    &worker->stats, sizeof(worker->stats));
+	if (is_mixed_workload()) {
+		/* The framework counts each opcode separately, use our own accounting instead */
+		worker->stats.executed = 0;
+		worker->stats.num_bytes = 0;
+		for (i = 0; i < MAX_WORKLOADS; i++) {
+			worker->stats.executed += worker->workload_stats[i].executed;
+			worker->stats.num_bytes += worker->workload_stats[i].num_bytes;
+		}
+	}
+	if (spdk_thread_get_stats(&thread_stats) == 0) {
+		worker->busy_tsc = thread_stats.busy_tsc - worker->busy_tsc;
+	}
 	free(worker->task_base);
 	spdk_put_io_channel(worker->ch);
 	spdk_thread_exit(spdk_get_thread());
@@ -282,6 +605,10 @@ unregister_worker(void *arg1)
 	if (--g_num_workers == 0) {
 		pthread_mutex_unlock(&g_workers_lock);
 		g_rc = dump_result();
+		if (g_crypto_key != NULL) {
+			spdk_accel_crypto_key_destroy(g_crypto_key);
+			g_crypto_key = NULL;
+		}
 		spdk_app_stop(0);
 	} else {
 		pthread_mutex_unlock(&g_workers_lock);
@@ -311,6 +638,30 @@ accel_perf_construct_iovs(void *buf, uint64_t sz, struct iovec *iovs, uint32_t i
 	assert(sz == 0);
 }
 
+static int
+_get_sequence_data_bufs(struct ap_task *task)
+{
+	uint32_t i, num_bufs = 1;
+
+	/* Every step producing data writes it to a new buffer, so that each one can be checked */
+	for (i = 0; i < g_sequence_len; i++) {
+		if (g_sequence[i] != SPDK_ACCEL_OPC_FILL && g_sequence[i] != SPDK_ACCEL_OPC_CRC32C) {
+			num_bufs++;
+		}
+	}
+
+	for (i = 0; i < num_bufs; i++) {
+		task->seq_bufs[i] = spdk_dma_zmalloc(g_xfer_size_bytes, ALIGN_4K, NULL);
+		if (task->seq_bufs[i] == NULL) {
+			fprintf(stderr, "Unable to alloc sequence buffer\n");
+			return -ENOMEM;
+		}
+		memset(task->seq_bufs[i], i == 0 ? DATA_PATTERN : ~DATA_PATTERN, g_xfer_size_bytes);
+	}
+
+	return 0;
+}
+
 static int
 _get_task_data_bufs(struct ap_task *task)
 {
@@ -318,10 +669,14 @@ _get_task_data_bufs(struct ap_task *task)
 	uint32_t i = 0;
 	int dst_buff_len = g_xfer_size_bytes;
 
+	if (g_sequence_len > 0) {
+		return _get_sequence_data_bufs(task);
+	}
+
 	/* For dualcast, the DSA HW requires 4K alignment on destination addresses but
 	 * we do this for all modules to keep it simple.
 	 */
-	if (g_workload_selection == SPDK_ACCEL_OPC_DUALCAST) {
+	if (workload_has(SPDK_ACCEL_OPC_DUALCAST)) {
 		align = ALIGN_4K;
 	}
 
@@ -350,8 +705,8 @@ _get_task_data_bufs(struct ap_task *task)
 		return 0;
 	}
 
-	if (g_workload_selection == SPDK_ACCEL_OPC_CRC32C ||
-	    g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
+	/* A mixed workload gets the buffers of all of its operations */
+	if (workload_has(SPDK_ACCEL_OPC_CRC32C) || workload_has(SPDK_ACCEL_OPC_COPY_CRC32C)) {
 		assert(g_chained_count > 0);
 		task->src_iovcnt = g_chained_count;
 		task->src_iovs = calloc(task->src_iovcnt, sizeof(struct iovec));
@@ -360,7 +715,7 @@ _get_task_data_bufs(struct ap_task *task)
 			return -ENOMEM;
 		}
 
-		if (g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
+		if (workload_has(SPDK_ACCEL_OPC_COPY_CRC32C)) {
 			dst_buff_len = g_xfer_size_bytes * g_chained_count;
 		}
 
@@ -372,7 +727,9 @@ _get_task_data_bufs(struct ap_task *task)
 			memset(task->src_iovs[i].iov_base, DATA_PATTERN, g_xfer_size_bytes);
 			task->src_iovs[i].iov_len = g_xfer_size_bytes;
 		}
-	} else if (g_workload_selection == SPDK_ACCEL_OPC_XOR) {
+	}
+
+	if (workload_has(SPDK_ACCEL_OPC_XOR)) {
 		assert(g_xor_src_count > 1);
 		task->sources = calloc(g_xor_src_count, sizeof(*task->sources));
 		if (!task->sources) {
@@ -386,7 +743,10 @@ _get_task_data_bufs(struct ap_task *task)
 			}
 			memset(task->sources[i], DATA_PATTERN, g_xfer_size_bytes);
 		}
-	} else {
+	}
+
+	if (workload_has(SPDK_ACCEL_OPC_COPY) || workload_has(SPDK_ACCEL_OPC_FILL) ||
+	    workload_has(SPDK_ACCEL_OPC_COMPARE) || workload_has(SPDK_ACCEL_OPC_DUALCAST)) {
 		task->src = spdk_dma_zmalloc(g_xfer_size_bytes, 0, NULL);
 		if (task->src == NULL) {
 			fprintf(stderr, "Unable to alloc src buffer\n");
@@ -394,14 +754,14 @@ _get_task_data_bufs(struct ap_task *task)
 		}
 
 		/* For fill, set the entire src buffer so we can check if verify is enabled. */
-		if (g_workload_selection == SPDK_ACCEL_OPC_FILL) {
+		if (workload_has(SPDK_ACCEL_OPC_FILL)) {
 			memset(task->src, g_fill_pattern, g_xfer_size_bytes);
 		} else {
 			memset(task->src, DATA_PATTERN, g_xfer_size_bytes);
 		}
 	}
 
-	if (g_workload_selection != SPDK_ACCEL_OPC_CRC32C) {
+	if (g_num_workloads > 1 || g_workload_selection != SPDK_ACCEL_OPC_CRC32C) {
 		task->dst = spdk_dma_zmalloc(dst_buff_len, align, NULL);
 		if (task->dst == NULL) {
 			fprintf(stderr, "Unable to alloc dst buffer\n");
@@ -417,8 +777,8 @@ _get_task_data_bufs(struct ap_task *task)
 	}
 
 	/* For dualcast 2 buffers are needed for the operation.  */
-	if (g_workload_selection == SPDK_ACCEL_OPC_DUALCAST ||
-	    (g_workload_selection == SPDK_ACCEL_OPC_XOR && g_verify)) {
+	if (workload_has(SPDK_ACCEL_OPC_DUALCAST) ||
+	    (workload_has(SPDK_ACCEL_OPC_XOR) && g_verify)) {
 		task->dst2 = spdk_dma_zmalloc(g_xfer_size_bytes, align, NULL);
 		if (task->dst2 == NULL) {
 			fprintf(stderr, "Unable to alloc dst buffer\n");
@@ -446,25 +806,107 @@ _get_task(struct worker_thread *worker)
 	return task;
 }
 
+static int
+_submit_sequence(struct worker_thread *worker, struct ap_task *task)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	struct iovec *src_iov, *dst_iov;
+	uint32_t i, cur = 0;
+	int rc = 0;
+
+	for (i = 0; i < g_sequence_len && rc == 0; i++) {
+		src_iov = &task->seq_src_iovs[i];
+		dst_iov = &task->seq_dst_iovs[i];
+		src_iov->iov_base = task->seq_bufs[cur];
+		src_iov->iov_len = task->nbytes;
+		dst_iov->iov_base = task->seq_bufs[cur + 1];
+		dst_iov->iov_len = task->nbytes;
+
+		switch (g_sequence[i]) {
+		case SPDK_ACCEL_OPC_FILL:
+			rc = spdk_accel_append_fill(&seq, worker->ch, task->seq_bufs[cur], task->nbytes,
+						    NULL, NULL, g_fill_pattern, 0, NULL, NULL);
+			break;
+		case SPDK_ACCEL_OPC_CRC32C:
+			rc = spdk_accel_append_crc32c(&seq, worker->ch, &task->seq_crcs[i], src_iov, 1,
+						      NULL, NULL, g_crc32c_seed, NULL, NULL);
+			break;
+		case SPDK_ACCEL_OPC_COPY:
+			rc = spdk_accel_append_copy(&seq, worker->ch, dst_iov, 1, NULL, NULL,
+						    src_iov, 1, NULL, NULL, 0, NULL, NULL);
+			cur++;
+			break;
+		case SPDK_ACCEL_OPC_ENCRYPT:
+			rc = spdk_accel_append_encrypt(&seq, worker->ch, g_crypto_key, dst_iov, 1, NULL, NULL,
+						       src_iov, 1, NULL, NULL, 0, CRYPTO_BLOCK_SIZE, 0,
+						       NULL, NULL);
+			cur++;
+			break;
+		case SPDK_ACCEL_OPC_DECRYPT:
+			rc = spdk_accel_append_decrypt(&seq, worker->ch, g_crypto_key, dst_iov, 1, NULL, NULL,
+						       src_iov, 1, NULL, NULL, 0, CRYPTO_BLOCK_SIZE, 0,
+						       NULL, NULL);
+			cur++;
+			break;
+		default:
+			assert(false);
+			rc = -EINVAL;
+			break;
+		}
+	}
+
+	if (rc != 0) {
+		if (seq != NULL) {
+			spdk_accel_sequence_abort(seq);
+		}
+		return rc;
+	}
+
+	spdk_accel_sequence_finish(seq, accel_done, task);
+
+	return 0;
+}
+
 /* Submit one operation using the same ap task that just completed. */
 static void
 _submit_single(struct worker_thread *worker, struct ap_task *task)
 {
+	struct ap_workload_stats *stats;
+	uint64_t submit_tsc;
 	int random_num;
 	int rc = 0;
 	int flags = 0;
 
 	assert(worker);
 
-	switch (worker->workload) {
+	task->workload_idx = pick_weighted(g_workload_weights, g_num_workloads, g_workloads_weight);
+	task->op_code = g_sequence_len > 0 ? g_sequence[0] : g_workloads[task->workload_idx].opcode;
+	task->nbytes = g_xfer_sizes[pick_weighted(g_xfer_size_weights, g_num_xfer_sizes,
+				    g_xfer_sizes_weight)];
+	if (g_num_xfer_sizes > 1 && (task->op_code == SPDK_ACCEL_OPC_CRC32C ||
+				     task->op_code == SPDK_ACCEL_OPC_COPY_CRC32C)) {
+		/* Size distributions require a single vector */
+		task->src_iovs[0].iov_len = task->nbytes;
+	}
+
+	stats = &worker->workload_stats[task->workload_idx];
+	submit_tsc = spdk_get_ticks();
+	task->submit_tsc = submit_tsc;
+
+	if (g_sequence_len > 0) {
+		rc = _submit_sequence(worker, task);
+		goto submitted;
+	}
+
+	switch (task->op_code) {
 	case SPDK_ACCEL_OPC_COPY:
 		rc = spdk_accel_submit_copy(worker->ch, task->dst, task->src,
-					    g_xfer_size_bytes, flags, accel_done, task);
+					    task->nbytes, flags, accel_done, task);
 		break;
 	case SPDK_ACCEL_OPC_FILL:
 		/* For fill use the first byte of the task->dst buffer */
 		rc = spdk_accel_submit_fill(worker->ch, task->dst, *(uint8_t *)task->src,
-					    g_xfer_size_bytes, flags, accel_done, task);
+					    task->nbytes, flags, accel_done, task);
 		break;
 	case SPDK_ACCEL_OPC_CRC32C:
 		rc = spdk_accel_submit_crc32cv(worker->ch, &task->crc_dst,
@@ -485,11 +927,11 @@ _submit_single(struct worker_thread *worker, struct ap_task *task)
 			*(uint8_t *)task->dst = DATA_PATTERN;
 		}
 		rc = spdk_accel_submit_compare(worker->ch, task->dst, task->src,
-					       g_xfer_size_bytes, accel_done, task);
+					       task->nbytes, accel_done, task);
 		break;
 	case SPDK_ACCEL_OPC_DUALCAST:
 		rc = spdk_accel_submit_dualcast(worker->ch, task->dst, task->dst2,
-						task->src, g_xfer_size_bytes, flags, accel_done, task);
+						task->src, task->nbytes, flags, accel_done, task);
 		break;
 	case SPDK_ACCEL_OPC_COMPRESS:
 		task->src_iovs = task->cur_seg->uncompressed_iovs;
@@ -506,7 +948,7 @@ _submit_single(struct worker_thread *worker, struct ap_task *task)
 		break;
 	case SPDK_ACCEL_OPC_XOR:
 		rc = spdk_accel_submit_xor(worker->ch, task->dst, task->sources, g_xor_src_count,
-					   g_xfer_size_bytes, accel_done, task);
+					   task->nbytes, accel_done, task);
 		break;
 	default:
 		assert(false);
@@ -514,6 +956,10 @@ _submit_single(struct worker_thread *worker, struct ap_task *task)
 
 	}
 
+submitted:
+	/* Cycles spent in the submission, which include the execution by synchronous modules */
+	stats->submit_tsc += spdk_get_ticks() - submit_tsc;
+
 	worker->current_queue_depth++;
 	if (rc) {
 		accel_done(task, rc);
@@ -527,36 +973,35 @@ _free_task_buffers(struct ap_task *task)
 
 	if (g_workload_selection == SPDK_ACCEL_OPC_DECOMPRESS ||
 	    g_workload_selection == SPDK_ACCEL_OPC_COMPRESS) {
+		/* src_iovs point to the segments, which are freed separately */
 		free(task->dst_iovs);
-	} else if (g_workload_selection == SPDK_ACCEL_OPC_CRC32C ||
-		   g_workload_selection == SPDK_ACCEL_OPC_COPY_CRC32C) {
-		if (task->src_iovs) {
-			for (i = 0; i < task->src_iovcnt; i++) {
-				if (task->src_iovs[i].iov_base) {
-					spdk_dma_free(task->src_iovs[i].iov_base);
-				}
+	} else if (task->src_iovs) {
+		for (i = 0; i < task->src_iovcnt; i++) {
+			if (task->src_iovs[i].iov_base) {
+				spdk_dma_free(task->src_iovs[i].iov_base);
 			}
-			free(task->src_iovs);
 		}
-	} else if (g_workload_selection == SPDK_ACCEL_OPC_XOR) {
-		if (task->sources) {
-			for (i = 0; i < g_xor_src_count; i++) {
-				spdk_dma_free(task->sources[i]);
-			}
-			free(task->sources);
+		free(task->src_iovs);
+	}
+
+	if (task->sources) {
+		for (i = 0; i < g_xor_src_count; i++) {
+			spdk_dma_free(task->sources[i]);
 		}
-	} else {
-		spdk_dma_free(task->src);
+		free(task->sources);
 	}
 
-	spdk_dma_free(task->dst);
-	if (g_workload_selection == SPDK_ACCEL_OPC_DUALCAST || g_workload_selection == SPDK_ACCEL_OPC_XOR) {
-		spdk_dma_free(task->dst2);
+	for (i = 0; i < SPDK_COUNTOF(task->seq_bufs); i++) {
+		spdk_dma_free(task->seq_bufs[i]);
 	}
+
+	spdk_dma_free(task->src);
+	spdk_dma_free(task->dst);
+	spdk_dma_free(task->dst2);
 }
 
 static int
-_vector_memcmp(void *_dst, struct iovec *src_src_iovs, uint32_t iovcnt)
+_vector_memcmp(void *_dst, struct iovec *src_src_iovs, uint32_t iovcnt, uint32_t nbytes)
 {
 	uint32_t i;
 	uint32_t ttl_len = 0;
@@ -570,13 +1015,64 @@ _vector_memcmp(void *_dst, struct iovec *src_src_iovs, uint32_t iovcnt)
 		ttl_len += src_src_iovs[i].iov_len;
 	}
 
-	if (ttl_len != iovcnt * g_xfer_size_bytes) {
+	if (ttl_len != nbytes) {
 		return -1;
 	}
 
 	return 0;
 }
 
+/* Encrypt and decrypt use the same key and IV, so the data is in the clear whenever as
+ * many of them have been executed.  Only plaintext is checked.
+ */
+static void
+_verify_sequence(struct worker_thread *worker, struct ap_task *task)
+{
+	uint8_t pattern = g_sequence[0] == SPDK_ACCEL_OPC_FILL ? g_fill_pattern : DATA_PATTERN;
+	uint8_t *buf;
+	uint32_t i, sw_crc32c, cur = 0;
+	int crypto = 0;
+
+	sw_crc32c = spdk_crc32c_update(g_seq_ref_buf, task->nbytes, ~g_crc32c_seed);
+	for (i = 0; i < g_sequence_len; i++) {
+		switch (g_sequence[i]) {
+		case SPDK_ACCEL_OPC_CRC32C:
+			if (crypto == 0 && task->seq_crcs[i] != sw_crc32c) {
+				SPDK_NOTICELOG("CRC-32C miscompare at step %u\n", i);
+				worker->xfer_failed++;
+			}
+			break;
+		case SPDK_ACCEL_OPC_ENCRYPT:
+			crypto++;
+			cur++;
+			break;
+		case SPDK_ACCEL_OPC_DECRYPT:
+			crypto--;
+			cur++;
+			break;
+		case SPDK_ACCEL_OPC_COPY:
+			cur++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* Intermediate buffers may be skipped by the accel framework, but the last one is always
+	 * written.
+	 */
+	buf = task->seq_bufs[cur];
+	if (crypto == 0 && (cur > 0 || g_sequence[0] == SPDK_ACCEL_OPC_FILL)) {
+		for (i = 0; i < task->nbytes; i++) {
+			if (buf[i] != pattern) {
+				SPDK_NOTICELOG("Data miscompare\n");
+				worker->xfer_failed++;
+				break;
+			}
+		}
+	}
+}
+
 static int _worker_stop(void *arg);
 
 static void
@@ -584,20 +1080,42 @@ accel_done(void *arg1, int status)
 {
 	struct ap_task *task = arg1;
 	struct worker_thread *worker = task->worker;
+	struct ap_workload_stats *stats;
+	uint64_t latency_tsc;
 	uint32_t sw_crc32c;
 
 	assert(worker);
 	assert(worker->current_queue_depth > 0);
 
-	if (g_verify && status == 0) {
-		switch (worker->workload) {
+	stats = &worker->workload_stats[task->workload_idx];
+	latency_tsc = spdk_get_ticks() - task->submit_tsc;
+	spdk_histogram_data_tally(stats->latency, latency_tsc);
+	stats->latency_tsc += latency_tsc;
+	stats->max_latency_tsc = spdk_max(stats->max_latency_tsc, latency_tsc);
+	if (status == 0 || task->expected_status == -EILSEQ) {
+		stats->executed++;
+		if (task->op_code == SPDK_ACCEL_OPC_COMPRESS || task->op_code == SPDK_ACCEL_OPC_DECOMPRESS) {
+			stats->num_bytes += task->cur_seg->uncompressed_len;
+		} else if (task->op_code == SPDK_ACCEL_OPC_CRC32C ||
+			   task->op_code == SPDK_ACCEL_OPC_COPY_CRC32C) {
+			stats->num_bytes += task->nbytes * g_chained_count;
+		} else {
+			stats->num_bytes += task->nbytes;
+		}
+	}
+
+	if (g_verify && status == 0 && g_sequence_len > 0) {
+		_verify_sequence(worker, task);
+	} else if (g_verify && status == 0) {
+		switch (task->op_code) {
 		case SPDK_ACCEL_OPC_COPY_CRC32C:
 			sw_crc32c = spdk_crc32c_iov_update(task->src_iovs, task->src_iovcnt, ~g_crc32c_seed);
 			if (task->crc_dst != sw_crc32c) {
 				SPDK_NOTICELOG("CRC-32C miscompare\n");
 				worker->xfer_failed++;
 			}
-			if (_vector_memcmp(task->dst, task->src_iovs, task->src_iovcnt)) {
+			if (_vector_memcmp(task->dst, task->src_iovs, task->src_iovcnt,
+					   task->nbytes * g_chained_count)) {
 				SPDK_NOTICELOG("Data miscompare\n");
 				worker->xfer_failed++;
 			}
@@ -610,23 +1128,23 @@ accel_done(void *arg1, int status)
 			}
 			break;
 		case SPDK_ACCEL_OPC_COPY:
-			if (memcmp(task->src, task->dst, g_xfer_size_bytes)) {
+			if (memcmp(task->src, task->dst, task->nbytes)) {
 				SPDK_NOTICELOG("Data miscompare\n");
 				worker->xfer_failed++;
 			}
 			break;
 		case SPDK_ACCEL_OPC_DUALCAST:
-			if (memcmp(task->src, task->dst, g_xfer_size_bytes)) {
+			if (memcmp(task->src, task->dst, task->nbytes)) {
 				SPDK_NOTICELOG("Data miscompare, first destination\n");
 				worker->xfer_failed++;
 			}
-			if (memcmp(task->src, task->dst2, g_xfer_size_bytes)) {
+			if (memcmp(task->src, task->dst2, task->nbytes)) {
 				SPDK_NOTICELOG("Data miscompare, second destination\n");
 				worker->xfer_failed++;
 			}
 			break;
 		case SPDK_ACCEL_OPC_FILL:
-			if (memcmp(task->dst, task->src, g_xfer_size_bytes)) {
+			if (memcmp(task->dst, task->src, task->nbytes)) {
 				SPDK_NOTICELOG("Data miscompare\n");
 				worker->xfer_failed++;
 			}
@@ -643,9 +1161,9 @@ accel_done(void *arg1, int status)
 			break;
 		case SPDK_ACCEL_OPC_XOR:
 			if (spdk_xor_gen(task->dst2, task->sources, g_xor_src_count,
-					 g_xfer_size_bytes) != 0) {
+					 task->nbytes) != 0) {
 				SPDK_ERRLOG("Failed to generate xor for verification\n");
-			} else if (memcmp(task->dst, task->dst2, g_xfer_size_bytes)) {
+			} else if (memcmp(task->dst, task->dst2, task->nbytes)) {
 				SPDK_NOTICELOG("Data miscompare\n");
 				worker->xfer_failed++;
 			}
@@ -656,8 +1174,8 @@ accel_done(void *arg1, int status)
 		}
 	}
 
-	if (worker->workload == SPDK_ACCEL_OPC_COMPRESS ||
-	    g_workload_selection == SPDK_ACCEL_OPC_DECOMPRESS) {
+	if (task->op_code == SPDK_ACCEL_OPC_COMPRESS ||
+	    task->op_code == SPDK_ACCEL_OPC_DECOMPRESS) {
 		/* Advance the task to the next segment */
 		task->cur_seg = STAILQ_NEXT(task->cur_seg, link);
 		if (task->cur_seg == NULL) {
@@ -685,12 +1203,110 @@ accel_done(void *arg1, int status)
 	}
 }
 
+static const double g_latency_cutoffs[] = { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+
+struct ap_latency_cutoffs {
+	uint32_t	idx;
+	uint64_t	tsc[SPDK_COUNTOF(g_latency_cutoffs)];
+};
+
+static void
+check_cutoff(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+	     uint64_t total, uint64_t so_far)
+{
+	struct ap_latency_cutoffs *cutoffs = ctx;
+
+	if (count == 0) {
+		return;
+	}
+
+	while (cutoffs->idx < SPDK_COUNTOF(g_latency_cutoffs) &&
+	       (double)so_far / total >= g_latency_cutoffs[cutoffs->idx]) {
+		cutoffs->tsc[cutoffs->idx++] = end;
+	}
+}
+
+static void
+dump_latency(void)
+{
+	struct spdk_histogram_data *histogram;
+	struct ap_latency_cutoffs cutoffs;
+	struct ap_workload_stats *stats;
+	struct worker_thread *worker;
+	uint64_t executed, num_bytes, submit_tsc, latency_tsc, max_latency_tsc;
+	uint64_t total_bytes = 0, busy_tsc = 0;
+	uint32_t i, j, num_workloads;
+	const char *name, *module_name;
+	double tsc_to_us = (double)SPDK_SEC_TO_USEC / g_tsc_rate;
+
+	histogram = spdk_histogram_data_alloc();
+	if (histogram == NULL) {
+		return;
+	}
+
+	num_workloads = g_sequence_len > 0 ? 1 : g_num_workloads;
+
+	printf("Operation    Module          Ops/s     MiB/s   Avg(us)   p50(us)   p90(us)   p99(us)"
+	       " p99.9(us) p99.99(us)   Max(us)  Submit cycles/B\n");
+	printf("---------------------------------------------------------------------------------------"
+	       "-------------------------------------------\n");
+	for (i = 0; i < num_workloads; i++) {
+		spdk_histogram_data_reset(histogram);
+		executed = num_bytes = submit_tsc = latency_tsc = max_latency_tsc = 0;
+		for (worker = g_workers; worker != NULL; worker = worker->next) {
+			stats = &worker->workload_stats[i];
+			if (stats->latency != NULL) {
+				spdk_histogram_data_merge(histogram, stats->latency);
+			}
+			executed += stats->executed;
+			num_bytes += stats->num_bytes;
+			submit_tsc += stats->submit_tsc;
+			latency_tsc += stats->latency_tsc;
+			max_latency_tsc = spdk_max(max_latency_tsc, stats->max_latency_tsc);
+		}
+
+		memset(&cutoffs, 0, sizeof(cutoffs));
+		spdk_histogram_data_iterate(histogram, check_cutoff, &cutoffs);
+
+		if (g_sequence_len > 0) {
+			name = "sequence";
+			module_name = "-";
+		} else {
+			name = g_workloads[i].name;
+			if (spdk_accel_get_opc_module_name(g_workloads[i].opcode, &module_name) != 0) {
+				module_name = "-";
+			}
+		}
+
+		printf("%-12s %-12s %9" PRIu64 " %9" PRIu64, name, module_name,
+		       executed / g_time_in_sec, num_bytes / (g_time_in_sec * 1024 * 1024));
+		printf(" %9.2f", executed ? (double)latency_tsc / executed * tsc_to_us : 0.0);
+		for (j = 0; j < SPDK_COUNTOF(g_latency_cutoffs); j++) {
+			printf(" %9.2f", cutoffs.tsc[j] * tsc_to_us);
+		}
+		printf(" %9.2f %16.3f\n", max_latency_tsc * tsc_to_us,
+		       num_bytes ? (double)submit_tsc / num_bytes : 0.0);
+	}
+
+	for (worker = g_workers; worker != NULL; worker = worker->next) {
+		busy_tsc += worker->busy_tsc;
+		for (i = 0; i < num_workloads; i++) {
+			total_bytes += worker->workload_stats[i].num_bytes;
+		}
+	}
+	printf("\nThread busy cycles per byte: %.3f\n\n",
+	       total_bytes ? (double)busy_tsc / total_bytes : 0.0);
+
+	spdk_histogram_data_free(histogram);
+}
+
 static int
 dump_result(void)
 {
 	uint64_t total_completed = 0;
 	uint64_t total_failed = 0;
 	uint64_t total_miscompared = 0;
+	uint64_t total_bytes = 0;
 	uint64_t total_xfer_per_sec, total_bw_in_MiBps;
 	struct worker_thread *worker = g_workers;
 
@@ -703,6 +1319,7 @@ dump_result(void)
 				       (g_time_in_sec * 1024 * 1024);
 
 		total_completed += worker->stats.executed;
+		total_bytes += worker->stats.num_bytes;
 		total_failed += worker->xfer_failed;
 		total_miscompared += worker->injected_miscompares;
 
@@ -716,13 +1333,19 @@ dump_result(void)
 	}
 
 	total_xfer_per_sec = total_completed / g_time_in_sec;
-	total_bw_in_MiBps = (total_completed * g_xfer_size_bytes) /
-			    (g_time_in_sec * 1024 * 1024);
+	if (is_mixed_workload()) {
+		total_bw_in_MiBps = total_bytes / (g_time_in_sec * 1024 * 1024);
+	} else {
+		total_bw_in_MiBps = (total_completed * g_xfer_size_bytes) /
+				    (g_time_in_sec * 1024 * 1024);
+	}
 
 	printf("=========================================================================\n");
 	printf("Total:%15" PRIu64 "/s%9" PRIu64 " MiB/s%6" PRIu64 " %11" PRIu64"\n\n",
 	       total_xfer_per_sec, total_bw_in_MiBps, total_failed, total_miscompared);
 
+	dump_latency();
+
 	return total_failed ? 1 : 0;
 }
 
@@ -775,6 +1398,7 @@ _init_thread(void *arg1)
 {
 	struct worker_thread *worker;
 	struct ap_task *task;
+	struct spdk_thread_stats thread_stats;
 	int i, num_tasks = g_allocate_depth;
 	struct display_info *display = arg1;
 
@@ -804,6 +1428,14 @@ _init_thread(void *arg1)
 
 	TAILQ_INIT(&worker->tasks_pool);
 
+	for (i = 0; i < MAX_WORKLOADS; i++) {
+		worker->workload_stats[i].latency = spdk_histogram_data_alloc();
+		if (worker->workload_stats[i].latency == NULL) {
+			fprintf(stderr, "Could not allocate latency histogram.\n");
+			goto error;
+		}
+	}
+
 	worker->task_base = calloc(num_tasks, sizeof(struct ap_task));
 	if (worker->task_base == NULL) {
 		fprintf(stderr, "Could not allocate task base.\n");
@@ -825,6 +1457,10 @@ _init_thread(void *arg1)
 	worker->stop_poller = SPDK_POLLER_REGISTER(_worker_stop, worker,
 			      g_time_in_sec * 1000000ULL);
 
+	if (spdk_thread_get_stats(&thread_stats) == 0) {
+		worker->busy_tsc = thread_stats.busy_tsc;
+	}
+
 	/* Load up queue depth worth of operations. */
 	for (i = 0; i < g_queue_depth; i++) {
 		task = _get_task(worker);
@@ -1054,12 +1690,42 @@ error:
 	spdk_app_stop(rc);
 }
 
+static int
+accel_perf_create_crypto_key(void)
+{
+	struct spdk_accel_crypto_key_create_param param = {
+		.cipher = "AES_XTS",
+		.hex_key = "00112233445566778899aabbccddeeff",
+		.hex_key2 = "ffeeddccbbaa99887766554433221100",
+		.key_name = CRYPTO_KEY_NAME,
+	};
+	int rc;
+
+	rc = spdk_accel_crypto_key_create(&param);
+	if (rc != 0) {
+		fprintf(stderr, "Unable to create a crypto key: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	g_crypto_key = spdk_accel_crypto_key_get(CRYPTO_KEY_NAME);
+	assert(g_crypto_key != NULL);
+
+	return 0;
+}
+
 static void
 accel_perf_prep(void *arg1)
 {
 	struct accel_perf_prep_ctx *ctx;
 	int rc = 0;
 
+	if (workload_has(SPDK_ACCEL_OPC_ENCRYPT) || workload_has(SPDK_ACCEL_OPC_DECRYPT)) {
+		rc = accel_perf_create_crypto_key();
+		if (rc != 0) {
+			goto error_end;
+		}
+	}
+
 	if (g_workload_selection != SPDK_ACCEL_OPC_COMPRESS &&
 	    g_workload_selection != SPDK_ACCEL_OPC_DECOMPRESS) {
 		accel_perf_start(arg1);
@@ -1143,18 +1809,42 @@ int
 main(int argc, char **argv)
 {
 	struct worker_thread *worker, *tmp;
+	uint32_t i;
 
 	pthread_mutex_init(&g_workers_lock, NULL);
 	spdk_app_opts_init(&g_opts, sizeof(g_opts));
 	g_opts.name = "accel_perf";
 	g_opts.reactor_mask = "0x1";
 	g_opts.shutdown_cb = shutdown_cb;
-	if (spdk_app_parse_args(argc, argv, &g_opts, "a:C:o:q:t:yw:P:f:T:l:x:", NULL, parse_args,
+	if (spdk_app_parse_args(argc, argv, &g_opts, "a:C:o:q:t:yw:P:f:T:l:x:S:", NULL, parse_args,
 				usage) != SPDK_APP_PARSE_ARGS_SUCCESS) {
 		g_rc = -1;
 		goto cleanup;
 	}
 
+	if (g_sequence_len > 0 && g_num_workloads > 0) {
+		fprintf(stdout, "-S and -w are mutually exclusive\n");
+		usage();
+		g_rc = -1;
+		goto cleanup;
+	}
+
+	if (g_sequence_len == 0 && g_num_workloads == 0) {
+		/* Keep the historical default of a copy workload */
+		g_workloads[0].opcode = g_workload_selection;
+		g_workloads[0].name = opcode_name(g_workload_selection);
+		g_workload_weights[0] = 1;
+		g_workloads_weight = 1;
+		g_num_workloads = 1;
+	}
+
+	if (g_num_xfer_sizes == 0) {
+		g_xfer_sizes[0] = g_xfer_size_bytes;
+		g_xfer_size_weights[0] = 1;
+		g_xfer_sizes_weight = 1;
+		g_num_xfer_sizes = 1;
+	}
+
 	if ((g_workload_selection != SPDK_ACCEL_OPC_COPY) &&
 	    (g_workload_selection != SPDK_ACCEL_OPC_FILL) &&
 	    (g_workload_selection != SPDK_ACCEL_OPC_CRC32C) &&
@@ -1169,6 +1859,45 @@ main(int argc, char **argv)
 		goto cleanup;
 	}
 
+	if (g_num_workloads > 1 && (workload_has(SPDK_ACCEL_OPC_COMPRESS) ||
+				    workload_has(SPDK_ACCEL_OPC_DECOMPRESS) ||
+				    workload_has(SPDK_ACCEL_OPC_COMPARE))) {
+		fprintf(stdout, "compress, decompress and compare cannot be mixed with other workloads\n");
+		usage();
+		g_rc = -1;
+		goto cleanup;
+	}
+
+	if (g_num_xfer_sizes > 1 && (g_chained_count != 1 ||
+				     workload_has(SPDK_ACCEL_OPC_COMPRESS) ||
+				     workload_has(SPDK_ACCEL_OPC_DECOMPRESS))) {
+		fprintf(stdout, "A transfer size distribution requires -C 1 and no compress/decompress\n");
+		usage();
+		g_rc = -1;
+		goto cleanup;
+	}
+
+	if (g_xfer_size_bytes == 0 && (is_mixed_workload() ||
+				       (g_workload_selection != SPDK_ACCEL_OPC_COMPRESS &&
+					g_workload_selection != SPDK_ACCEL_OPC_DECOMPRESS))) {
+		fprintf(stdout, "A transfer size of 0 is only valid for compress/decompress\n");
+		usage();
+		g_rc = -1;
+		goto cleanup;
+	}
+
+	if (workload_has(SPDK_ACCEL_OPC_ENCRYPT) || workload_has(SPDK_ACCEL_OPC_DECRYPT)) {
+		for (i = 0; i < g_num_xfer_sizes; i++) {
+			if (g_xfer_sizes[i] % CRYPTO_BLOCK_SIZE != 0) {
+				fprintf(stdout, "Transfer sizes of crypto operations must be a multiple of %u\n",
+					CRYPTO_BLOCK_SIZE);
+				usage();
+				g_rc = -1;
+				goto cleanup;
+			}
+		}
+	}
+
 	if (g_allocate_depth > 0 && g_queue_depth > g_allocate_depth) {
 		fprintf(stdout, "allocate depth must be at least as big as queue depth\n");
 		usage();
@@ -1194,6 +1923,16 @@ main(int argc, char **argv)
 		goto cleanup;
 	}
 
+	if (g_sequence_len > 0 && g_verify) {
+		g_seq_ref_buf = malloc(g_xfer_size_bytes);
+		if (g_seq_ref_buf == NULL) {
+			g_rc = -ENOMEM;
+			goto cleanup;
+		}
+		memset(g_seq_ref_buf, g_sequence[0] == SPDK_ACCEL_OPC_FILL ? g_fill_pattern : DATA_PATTERN,
+		       g_xfer_size_bytes);
+	}
+
 	g_rc = spdk_app_start(&g_opts, accel_perf_prep, NULL);
 	if (g_rc) {
 		SPDK_ERRLOG("ERROR starting application\n");
@@ -1204,10 +1943,14 @@ main(int argc, char **argv)
 	worker = g_workers;
 	while (worker) {
 		tmp = worker->next;
+		for (i = 0; i < MAX_WORKLOADS; i++) {
+			spdk_histogram_data_free(worker->workload_stats[i].latency);
+		}
 		free(worker);
 		worker = tmp;
 	}
 cleanup:
+	free(g_seq_ref_buf);
 	accel_perf_free_compress_segs();
 	spdk_app_fini();
 	return g_rc;
@@ -0,0 +1,275 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+/*
+ * Single core throughput of DIF/DIX generation and verification.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/dif.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+enum workload {
+	WORKLOAD_DIF_GENERATE,
+	WORKLOAD_DIF_VERIFY,
+	WORKLOAD_DIF_GENERATE_COPY,
+	WORKLOAD_DIF_VERIFY_COPY,
+	WORKLOAD_DIX_GENERATE,
+	WORKLOAD_DIX_VERIFY,
+	WORKLOAD_COUNT,
+};
+
+static const char *g_workload_names[] = {
+	[WORKLOAD_DIF_GENERATE] = "dif_generate",
+	[WORKLOAD_DIF_VERIFY] = "dif_verify",
+	[WORKLOAD_DIF_GENERATE_COPY] = "dif_generate_copy",
+	[WORKLOAD_DIF_VERIFY_COPY] = "dif_verify_copy",
+	[WORKLOAD_DIX_GENERATE] = "dix_generate",
+	[WORKLOAD_DIX_VERIFY] = "dix_verify",
+};
+
+static uint32_t g_data_block_size = 4096;
+static uint32_t g_md_size = 8;
+static uint32_t g_num_blocks = 32;
+static uint32_t g_time_sec = 2;
+static enum spdk_dif_pi_format g_pi_format = SPDK_DIF_PI_FORMAT_16;
+static int g_workload = -1;
+
+struct perf_bufs {
+	struct iovec	dif_iov;
+	struct iovec	data_iov;
+	struct iovec	md_iov;
+};
+
+static void
+usage(const char *prog)
+{
+	int i;
+
+	printf("usage: %s [options]\n", prog);
+	printf("\t-b <bytes>  data block size (default %u)\n", g_data_block_size);
+	printf("\t-m <bytes>  metadata size (default 8, 16 for 32 and 64 bit guards)\n");
+	printf("\t-f <bits>   guard size, 16, 32 or 64 (default 16)\n");
+	printf("\t-n <count>  number of blocks per call (default %u)\n", g_num_blocks);
+	printf("\t-t <sec>    time to run each workload (default %u)\n", g_time_sec);
+	printf("\t-w <name>   run a single workload, one of:");
+	for (i = 0; i < WORKLOAD_COUNT; i++) {
+		printf(" %s", g_workload_names[i]);
+	}
+	printf("\n");
+}
+
+static int
+parse_args(int argc, char **argv)
+{
+	bool md_size_set = false;
+	long val;
+	int op, i;
+
+	while ((op = getopt(argc, argv, "b:m:f:n:t:w:h")) != -1) {
+		if (op == 'w') {
+			for (i = 0; i < WORKLOAD_COUNT; i++) {
+				if (strcmp(optarg, g_workload_names[i]) == 0) {
+					g_workload = i;
+					break;
+				}
+			}
+			if (g_workload < 0) {
+				fprintf(stderr, "Unknown workload %s\n", optarg);
+				return -EINVAL;
+			}
+			continue;
+		}
+
+		if (op == 'h' || op == '?') {
+			return -EINVAL;
+		}
+
+		val = spdk_strtol(optarg, 10);
+		if (val <= 0) {
+			fprintf(stderr, "Invalid value %s for -%c\n", optarg, op);
+			return -EINVAL;
+		}
+
+		switch (op) {
+		case 'b':
+			g_data_block_size = val;
+			break;
+		case 'm':
+			g_md_size = val;
+			md_size_set = true;
+			break;
+		case 'f':
+			if (val == 16) {
+				g_pi_format = SPDK_DIF_PI_FORMAT_16;
+			} else if (val == 32) {
+				g_pi_format = SPDK_DIF_PI_FORMAT_32;
+			} else if (val == 64) {
+				g_pi_format = SPDK_DIF_PI_FORMAT_64;
+			} else {
+				fprintf(stderr, "Invalid guard size %ld\n", val);
+				return -EINVAL;
+			}
+			break;
+		case 'n':
+			g_num_blocks = val;
+			break;
+		case 't':
+			g_time_sec = val;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	if (!md_size_set && g_pi_format != SPDK_DIF_PI_FORMAT_16) {
+		g_md_size = 16;
+	}
+
+	return 0;
+}
+
+static uint64_t
+get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * SPDK_SEC_TO_NSEC + ts.tv_nsec;
+}
+
+static int
+run_workload(enum workload workload, struct perf_bufs *bufs)
+{
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	struct spdk_dif_ctx ctx;
+	struct spdk_dif_error err_blk;
+	uint32_t dif_flags = SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+			     SPDK_DIF_FLAGS_REFTAG_CHECK;
+	uint64_t start, now, end, iterations = 0;
+	bool dix = workload == WORKLOAD_DIX_GENERATE || workload == WORKLOAD_DIX_VERIFY;
+	double sec;
+	int rc;
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = g_pi_format;
+	rc = spdk_dif_ctx_init(&ctx, dix ? g_data_block_size : g_data_block_size + g_md_size,
+			       g_md_size, !dix, false, SPDK_DIF_TYPE1, dif_flags, 0, 0xFFFF, 0x88,
+			       0, 0, &dif_opts);
+	if (rc != 0) {
+		fprintf(stderr, "Failed to initialize DIF context: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	/* Verification needs valid protection information */
+	if (workload == WORKLOAD_DIF_VERIFY || workload == WORKLOAD_DIF_VERIFY_COPY) {
+		rc = spdk_dif_generate(&bufs->dif_iov, 1, g_num_blocks, &ctx);
+	} else if (workload == WORKLOAD_DIX_VERIFY) {
+		rc = spdk_dix_generate(&bufs->data_iov, 1, &bufs->md_iov, g_num_blocks, &ctx);
+	}
+	if (rc != 0) {
+		return rc;
+	}
+
+	start = now = get_time_ns();
+	end = start + g_time_sec * SPDK_SEC_TO_NSEC;
+
+	while (now < end) {
+		switch (workload) {
+		case WORKLOAD_DIF_GENERATE:
+			rc = spdk_dif_generate(&bufs->dif_iov, 1, g_num_blocks, &ctx);
+			break;
+		case WORKLOAD_DIF_VERIFY:
+			rc = spdk_dif_verify(&bufs->dif_iov, 1, g_num_blocks, &ctx, &err_blk);
+			break;
+		case WORKLOAD_DIF_GENERATE_COPY:
+			rc = spdk_dif_generate_copy(&bufs->data_iov, 1, &bufs->dif_iov, 1, g_num_blocks, &ctx);
+			break;
+		case WORKLOAD_DIF_VERIFY_COPY:
+			rc = spdk_dif_verify_copy(&bufs->data_iov, 1, &bufs->dif_iov, 1, g_num_blocks, &ctx,
+						  &err_blk);
+			break;
+		case WORKLOAD_DIX_GENERATE:
+			rc = spdk_dix_generate(&bufs->data_iov, 1, &bufs->md_iov, g_num_blocks, &ctx);
+			break;
+		case WORKLOAD_DIX_VERIFY:
+			rc = spdk_dix_verify(&bufs->data_iov, 1, &bufs->md_iov, g_num_blocks, &ctx, &err_blk);
+			break;
+		default:
+			assert(false);
+			rc = -EINVAL;
+			break;
+		}
+
+		if (rc != 0) {
+			fprintf(stderr, "%s failed: %d\n", g_workload_names[workload], rc);
+			return rc;
+		}
+
+		iterations++;
+		/* Reading the clock is cheap compared to a call, but don't do it every time */
+		if ((iterations & 0xF) == 0) {
+			now = get_time_ns();
+		}
+	}
+
+	sec = (double)(get_time_ns() - start) / SPDK_SEC_TO_NSEC;
+	printf("%-20s %12.2f %12.2f\n", g_workload_names[workload],
+	       iterations * g_num_blocks / sec / 1000000,
+	       (double)iterations * g_num_blocks * g_data_block_size / sec / (1024 * 1024 * 1024));
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct perf_bufs bufs = {};
+	uint32_t i;
+	int rc;
+
+	if (parse_args(argc, argv) != 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	bufs.dif_iov.iov_len = (size_t)(g_data_block_size + g_md_size) * g_num_blocks;
+	bufs.data_iov.iov_len = (size_t)g_data_block_size * g_num_blocks;
+	bufs.md_iov.iov_len = (size_t)g_md_size * g_num_blocks;
+	bufs.dif_iov.iov_base = aligned_alloc(64, SPDK_ALIGN_CEIL(bufs.dif_iov.iov_len, 64));
+	bufs.data_iov.iov_base = aligned_alloc(64, SPDK_ALIGN_CEIL(bufs.data_iov.iov_len, 64));
+	bufs.md_iov.iov_base = aligned_alloc(64, SPDK_ALIGN_CEIL(bufs.md_iov.iov_len, 64));
+	if (!bufs.dif_iov.iov_base || !bufs.data_iov.iov_base || !bufs.md_iov.iov_base) {
+		fprintf(stderr, "Failed to allocate buffers\n");
+		rc = -ENOMEM;
+		goto exit;
+	}
+
+	memset(bufs.dif_iov.iov_base, 0x5a, bufs.dif_iov.iov_len);
+	memset(bufs.data_iov.iov_base, 0xa5, bufs.data_iov.iov_len);
+	memset(bufs.md_iov.iov_base, 0, bufs.md_iov.iov_len);
+
+	printf("data block size %u, metadata size %u, guard %s, %u blocks per call\n",
+	       g_data_block_size, g_md_size,
+	       g_pi_format == SPDK_DIF_PI_FORMAT_16 ? "CRC16" :
+	       g_pi_format == SPDK_DIF_PI_FORMAT_32 ? "CRC32C" : "CRC64", g_num_blocks);
+	printf("%-20s %12s %12s\n", "workload", "Mblocks/s", "GiB/s");
+
+	rc = 0;
+	for (i = 0; i < WORKLOAD_COUNT && rc == 0; i++) {
+		if (g_workload < 0 || (uint32_t)g_workload == i) {
+			rc = run_workload(i, &bufs);
+		}
+	}
+
+exit:
+	free(bufs.dif_iov.iov_base);
+	free(bufs.data_iov.iov_base);
+	free(bufs.md_iov.iov_base);
+
+	return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+/*
+ * Single core throughput of spdk_xor_gen() compared to a plain 64-bit loop and,
+ * if SPDK is built with ISA-L, to ISA-L's xor_gen().
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/xor.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/raid.h"
+#endif
+
+#define MAX_SOURCES 32
+
+static uint32_t g_num_sources = 4;
+static uint32_t g_time_sec = 1;
+static uint32_t g_sizes[] = { 4096, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024 };
+static uint32_t g_size;
+
+typedef int (*xor_fn)(void *dest, void **sources, uint32_t n, uint32_t len);
+
+static int
+xor_gen_plain(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	uint64_t w;
+	uint32_t i, j;
+
+	for (i = 0; i < len / sizeof(uint64_t); i++) {
+		w = 0;
+		for (j = 0; j < n; j++) {
+			w ^= ((uint64_t *)sources[j])[i];
+		}
+		((uint64_t *)dest)[i] = w;
+	}
+
+	return 0;
+}
+
+#ifdef SPDK_CONFIG_ISAL
+static int
+xor_gen_isal(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	void *buffers[MAX_SOURCES + 1];
+
+	memcpy(buffers, sources, n * sizeof(buffers[0]));
+	buffers[n] = dest;
+
+	return xor_gen(n + 1, len, buffers);
+}
+#endif
+
+static void
+usage(const char *prog)
+{
+	printf("usage: %s [options]\n", prog);
+	printf("\t-n <count>  number of source buffers, at most %u (default %u)\n", MAX_SOURCES,
+	       g_num_sources);
+	printf("\t-s <bytes>  buffer size (default: 4KiB, 64KiB, 1MiB and 8MiB)\n");
+	printf("\t-t <sec>    time to run each test (default %u)\n", g_time_sec);
+}
+
+static uint64_t
+get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * SPDK_SEC_TO_NSEC + ts.tv_nsec;
+}
+
+static double
+run(xor_fn fn, void *dest, void **sources, uint32_t size)
+{
+	uint64_t start, now, end, iterations = 0;
+
+	start = now = get_time_ns();
+	end = start + g_time_sec * SPDK_SEC_TO_NSEC;
+
+	while (now < end) {
+		if (fn(dest, sources, g_num_sources, size) != 0) {
+			return -1;
+		}
+		iterations++;
+		now = get_time_ns();
+	}
+
+	/* Throughput of source data */
+	return (double)iterations * size * g_num_sources / ((double)(now - start) / SPDK_SEC_TO_NSEC) /
+	       (1024 * 1024 * 1024);
+}
+
+int
+main(int argc, char **argv)
+{
+	void *bufs[MAX_SOURCES + 1], *sources[MAX_SOURCES];
+	uint32_t max_size = 0, i, s;
+	size_t alignment;
+	long val;
+	int op, rc = 1;
+
+	while ((op = getopt(argc, argv, "n:s:t:h")) != -1) {
+		if (op == 'h' || op == '?') {
+			usage(argv[0]);
+			return 1;
+		}
+
+		val = spdk_strtol(optarg, 10);
+		if (val <= 0) {
+			fprintf(stderr, "Invalid value %s for -%c\n", optarg, op);
+			usage(argv[0]);
+			return 1;
+		}
+
+		switch (op) {
+		case 'n':
+			if (val < 2 || val > MAX_SOURCES) {
+				fprintf(stderr, "Invalid number of sources %ld\n", val);
+				return 1;
+			}
+			g_num_sources = val;
+			break;
+		case 's':
+			g_size = val;
+			break;
+		case 't':
+			g_time_sec = val;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	for (s = 0; s < SPDK_COUNTOF(g_sizes); s++) {
+		if (g_size != 0) {
+			g_sizes[s] = g_size;
+		}
+		max_size = spdk_max(max_size, g_sizes[s]);
+	}
+
+	alignment = spdk_max(spdk_xor_get_optimal_alignment(), 64);
+	memset(bufs, 0, sizeof(bufs));
+	for (i = 0; i <= g_num_sources; i++) {
+		/* Room for the misaligned variant */
+		bufs[i] = aligned_alloc(alignment, SPDK_ALIGN_CEIL(max_size + alignment, alignment));
+		if (bufs[i] == NULL) {
+			fprintf(stderr, "Failed to allocate buffers\n");
+			goto exit;
+		}
+		memset(bufs[i], i, max_size + alignment);
+	}
+
+	printf("%u sources, GiB/s of source data per core\n", g_num_sources);
+	printf("%10s %12s %12s %12s", "size", "plain", "spdk", "spdk_unalgn");
+#ifdef SPDK_CONFIG_ISAL
+	printf(" %12s", "isal");
+#endif
+	printf("\n");
+
+	for (s = 0; s < SPDK_COUNTOF(g_sizes); s++) {
+		if (g_size != 0 && s > 0) {
+			break;
+		}
+
+		printf("%10u", g_sizes[s]);
+
+		memcpy(sources, bufs, g_num_sources * sizeof(sources[0]));
+		printf(" %12.2f", run(xor_gen_plain, bufs[g_num_sources], sources, g_sizes[s]));
+		printf(" %12.2f", run(spdk_xor_gen, bufs[g_num_sources], sources, g_sizes[s]));
+
+		for (i = 0; i < g_num_sources; i++) {
+			sources[i] = (uint8_t *)bufs[i] + i + 1;
+		}
+		printf(" %12.2f", run(spdk_xor_gen, bufs[g_num_sources], sources, g_sizes[s]));
+
+#ifdef SPDK_CONFIG_ISAL
+		memcpy(sources, bufs, g_num_sources * sizeof(sources[0]));
+		printf(" %12.2f", run(xor_gen_isal, bufs[g_num_sources], sources, g_sizes[s]));
+#endif
+		printf("\n");
+	}
+
+	rc = 0;
+exit:
+	for (i = 0; i <= g_num_sources; i++) {
+		free(bufs[i]);
+	}
+
+	return rc;
+}
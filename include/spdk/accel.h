@@ -13,6 +13,7 @@
 
 #include "spdk/stdinc.h"
 #include "spdk/dma.h"
+#include "spdk/dif.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,7 +45,12 @@ enum spdk_accel_opcode {
 	SPDK_ACCEL_OPC_ENCRYPT		= 8,
 	SPDK_ACCEL_OPC_DECRYPT		= 9,
 	SPDK_ACCEL_OPC_XOR		= 10,
-	SPDK_ACCEL_OPC_LAST		= 11,
+	SPDK_ACCEL_OPC_PQ_GEN		= 11,
+	SPDK_ACCEL_OPC_DIF_VERIFY	= 12,
+	SPDK_ACCEL_OPC_DIF_GENERATE	= 13,
+	SPDK_ACCEL_OPC_DIF_GENERATE_COPY	= 14,
+	SPDK_ACCEL_OPC_DIF_VERIFY_COPY	= 15,
+	SPDK_ACCEL_OPC_LAST		= 16,
 };
 
 enum spdk_accel_cipher {
@@ -321,6 +327,105 @@ int spdk_accel_submit_decompress(struct spdk_io_channel *ch, struct iovec *dst_i
 int spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uint32_t nsrcs,
 			  uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg);
 
+/**
+ * Submit a P and Q syndrome generation request, as used by RAID6. P is the XOR of the sources and
+ * Q is their Reed-Solomon syndrome in GF(2^8), see spdk_gf_pq_gen().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param p Destination to write the P syndrome to.
+ * \param q Destination to write the Q syndrome to.
+ * \param sources Array of source buffers.
+ * \param nsrcs Number of source buffers in the array.
+ * \param nbytes Length in bytes.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_pq_gen(struct spdk_io_channel *ch, void *p, void *q, void **sources,
+			     uint32_t nsrcs, uint64_t nbytes, spdk_accel_completion_cb cb_fn,
+			     void *cb_arg);
+
+/**
+ * Submit a DIF verify request for an extended LBA payload, see spdk_dif_verify().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param iovs I/O vector array describing the extended LBA payload.
+ * \param iovcnt Size of the `iovs` array.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the operation completes.
+ * \param err Error information of the block in which a DIF error is found.
+ * \param cb_fn Called when this operation completes. The status is -EIO if a DIF error is found.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_dif_verify(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+				 uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				 struct spdk_dif_error *err, spdk_accel_completion_cb cb_fn,
+				 void *cb_arg);
+
+/**
+ * Submit a DIF generate request for an extended LBA payload, see spdk_dif_generate().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param iovs I/O vector array describing the extended LBA payload.
+ * \param iovcnt Size of the `iovs` array.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the operation completes.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_dif_generate(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+				   uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				   spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a request to copy an LBA payload to an extended LBA payload and insert DIF into it, see
+ * spdk_dif_generate_copy().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dst_iovs I/O vector array describing the extended LBA payload.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param src_iovs I/O vector array describing the LBA payload.
+ * \param src_iovcnt Size of the `src_iovs` array.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the operation completes.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_dif_generate_copy(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+					size_t dst_iovcnt, struct iovec *src_iovs, size_t src_iovcnt,
+					uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+					spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a request to verify DIF of an extended LBA payload and copy the data without the
+ * metadata to an LBA payload, see spdk_dif_verify_copy().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dst_iovs I/O vector array describing the LBA payload.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param src_iovs I/O vector array describing the extended LBA payload.
+ * \param src_iovcnt Size of the `src_iovs` array.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the operation completes.
+ * \param err Error information of the block in which a DIF error is found.
+ * \param cb_fn Called when this operation completes. The status is -EIO if a DIF error is found.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_dif_verify_copy(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				      size_t dst_iovcnt, struct iovec *src_iovs, size_t src_iovcnt,
+				      uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				      struct spdk_dif_error *err, spdk_accel_completion_cb cb_fn,
+				      void *cb_arg);
+
 /** Object grouping multiple accel operations to be executed at the same point in time */
 struct spdk_accel_sequence;
 
@@ -379,6 +484,38 @@ int spdk_accel_append_fill(struct spdk_accel_sequence **seq, struct spdk_io_chan
 			   struct spdk_memory_domain *domain, void *domain_ctx, uint8_t pattern,
 			   int flags, spdk_accel_step_cb cb_fn, void *cb_arg);
 
+/**
+ * Append a compress operation to a sequence.
+ *
+ * The size of the compressed data is only known once the operation is executed, so the
+ * operations following it in the sequence process the whole destination buffer.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param dst_iovs Destination I/O vector array.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param dst_domain Memory domain to which the destination buffers belong.
+ * \param dst_domain_ctx Destination buffer domain context.
+ * \param src_iovs Source I/O vector array.
+ * \param src_iovcnt Size of the `src_iovs` array.
+ * \param src_domain Memory domain to which the source buffers belong.
+ * \param src_domain_ctx Source buffer domain context.
+ * \param output_size The size of the compressed data (may be NULL if not desired).  It's valid
+ * once `cb_fn` is executed.
+ * \param flags Accel operation flags.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_compress(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			       struct iovec *dst_iovs, size_t dst_iovcnt,
+			       struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+			       struct iovec *src_iovs, size_t src_iovcnt,
+			       struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+			       uint32_t *output_size, int flags,
+			       spdk_accel_step_cb cb_fn, void *cb_arg);
+
 /**
  * Append a decompress operation to a sequence.
  *
@@ -501,6 +638,141 @@ int spdk_accel_append_crc32c(struct spdk_accel_sequence **seq, struct spdk_io_ch
 			     struct spdk_memory_domain *domain, void *domain_ctx,
 			     uint32_t seed, spdk_accel_step_cb cb_fn, void *cb_arg);
 
+/**
+ * Append an xor operation to a sequence.
+ *
+ * The source buffers are plain virtual addresses, so only the destination may be part of a
+ * memory domain.  A copy of the destination buffer appended right after this operation is
+ * removed and the xor result is written directly to the copy's destination.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param dst_iovs Destination I/O vector array.  Must contain a single element.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param dst_domain Memory domain to which the destination buffer belongs.
+ * \param dst_domain_ctx Destination buffer domain context.
+ * \param sources Array of source buffers.  It must stay valid until the sequence completes.
+ * \param nsrcs Number of source buffers in the array.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_xor(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			  struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+			  void **sources, uint32_t nsrcs, spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a DIF verify operation to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param iovs I/O vector array describing the extended LBA payload.
+ * \param iovcnt Size of the `iovs` array.
+ * \param domain Memory domain to which the buffers belong.
+ * \param domain_ctx Buffer domain context.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the sequence completes.
+ * \param err Error information of the block in which a DIF error is found.  The sequence
+ * completes with -EIO in that case.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_dif_verify(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+				 struct iovec *iovs, size_t iovcnt,
+				 struct spdk_memory_domain *domain, void *domain_ctx,
+				 uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				 struct spdk_dif_error *err, spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a DIF generate operation to a sequence.  The DIF is generated in place, so the buffers
+ * can't belong to a memory domain other than the accel one.  Use
+ * spdk_accel_append_dif_generate_copy() for such buffers.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param iovs I/O vector array describing the extended LBA payload.
+ * \param iovcnt Size of the `iovs` array.
+ * \param domain Memory domain to which the buffers belong.
+ * \param domain_ctx Buffer domain context.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the sequence completes.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_dif_generate(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+				   struct iovec *iovs, size_t iovcnt,
+				   struct spdk_memory_domain *domain, void *domain_ctx,
+				   uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				   spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append an operation copying an LBA payload to an extended LBA payload and inserting DIF into
+ * it to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param dst_iovs Destination I/O vector array describing the extended LBA payload.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param dst_domain Memory domain to which the destination buffers belong.
+ * \param dst_domain_ctx Destination buffer domain context.
+ * \param src_iovs Source I/O vector array describing the LBA payload.
+ * \param src_iovcnt Size of the `src_iovs` array.
+ * \param src_domain Memory domain to which the source buffers belong.
+ * \param src_domain_ctx Source buffer domain context.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the sequence completes.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_dif_generate_copy(struct spdk_accel_sequence **seq,
+					struct spdk_io_channel *ch,
+					struct iovec *dst_iovs, size_t dst_iovcnt,
+					struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+					struct iovec *src_iovs, size_t src_iovcnt,
+					struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+					uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+					spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append an operation verifying DIF of an extended LBA payload and copying the data without the
+ * metadata to an LBA payload to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel.
+ * \param dst_iovs Destination I/O vector array describing the LBA payload.
+ * \param dst_iovcnt Size of the `dst_iovs` array.
+ * \param dst_domain Memory domain to which the destination buffers belong.
+ * \param dst_domain_ctx Destination buffer domain context.
+ * \param src_iovs Source I/O vector array describing the extended LBA payload.
+ * \param src_iovcnt Size of the `src_iovs` array.
+ * \param src_domain Memory domain to which the source buffers belong.
+ * \param src_domain_ctx Source buffer domain context.
+ * \param num_blocks Number of blocks of the payload.
+ * \param ctx DIF context. It must stay valid until the sequence completes.
+ * \param err Error information of the block in which a DIF error is found.  The sequence
+ * completes with -EIO in that case.
+ * \param cb_fn Callback to be executed once this operation is completed.
+ * \param cb_arg Argument to be passed to `cb_fn`.
+ *
+ * \return 0 if operation was successfully added to the sequence, negative errno otherwise.
+ */
+int spdk_accel_append_dif_verify_copy(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+				      struct iovec *dst_iovs, size_t dst_iovcnt,
+				      struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+				      struct iovec *src_iovs, size_t src_iovcnt,
+				      struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+				      uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				      struct spdk_dif_error *err, spdk_accel_step_cb cb_fn,
+				      void *cb_arg);
+
 /**
  * Finish a sequence and execute all its operations. After the completion callback is executed, the
  * sequence object is automatically freed.
@@ -682,6 +954,14 @@ struct spdk_accel_opts {
 	uint32_t	sequence_count;
 	/** Maximum number of accel buffers per IO channel */
 	uint32_t	buf_count;
+	/**
+	 * Mask of the cores running the software module's workers.  If set, operations executed
+	 * by the software module are handed over to a worker thread on one of these cores and
+	 * completed back on the submitting thread.  If NULL, they're executed synchronously by
+	 * the submitting thread.  The cores must be a part of the application's core mask.  The
+	 * workers are SPDK threads, so they share the cores with other threads placed on them.
+	 */
+	const char	*sw_worker_cpumask;
 } __attribute__((packed));
 
 /**
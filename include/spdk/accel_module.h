@@ -115,11 +115,16 @@ struct spdk_accel_task {
 		uint32_t			seed;
 		uint64_t			fill_pattern;
 		struct spdk_accel_crypto_key	*crypto_key;
+		struct {
+			const struct spdk_dif_ctx	*ctx;
+			struct spdk_dif_error		*err;
+		} dif;
 	};
 	union {
 		uint32_t		*crc_dst;
 		uint32_t		*output_size;
 		uint32_t		block_size; /* for crypto op */
+		uint32_t		num_blocks; /* for DIF ops */
 	};
 	uint64_t			iv; /* Initialization vector (tweak) for crypto op */
 	/* Uses enum spdk_accel_opcode */
@@ -50,6 +50,31 @@ uint32_t spdk_crc32c_update(const void *buf, size_t len, uint32_t crc);
  */
 uint32_t spdk_crc32c_iov_update(struct iovec *iov, int iovcnt, uint32_t crc32c);
 
+/**
+ * Copy a buffer and calculate its partial CRC-32C checksum in a single pass.
+ *
+ * \param dst Destination buffer.
+ * \param src Source buffer to checksum.
+ * \param len Length of the buffers in bytes.
+ * \param crc Previous CRC-32C value.
+ * \return Updated CRC-32C value.
+ */
+uint32_t spdk_crc32c_copy(void *dst, const void *src, size_t len, uint32_t crc);
+
+/**
+ * Combine the CRC-32C checksums of two adjacent buffers.
+ *
+ * This allows checksumming fragments of the data independently, e.g. in parallel or as they
+ * arrive, and merging the results afterwards.
+ *
+ * \param crc1 CRC-32C of the first buffer, calculated by spdk_crc32c_update() with any initial value.
+ * \param crc2 CRC-32C of the second buffer, calculated by spdk_crc32c_update() with initial value 0.
+ * \param len2 Length of the second buffer in bytes.
+ * \return CRC-32C of both buffers, the same as spdk_crc32c_update() of the second buffer
+ * with crc1 as the initial value.
+ */
+uint32_t spdk_crc32c_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 /**
  * Calculate a CRC-32C checksum, for NVMe Protection Information
  *
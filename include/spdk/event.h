@@ -178,8 +178,14 @@ struct spdk_app_opts {
 	 * If non-NULL, a pointer to JSON RPC log file.
 	 */
 	FILE *rpc_log_file;
+
+	/**
+	 * Maximum number of independent JSON config entries sent concurrently, see
+	 * spdk_subsystem_set_json_config_max_concurrent_rpcs().
+	 */
+	uint32_t json_config_max_concurrent_rpcs;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 236, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 240, "Incorrect size");
 
 /**
  * Initialize the default value of opts
@@ -34,6 +34,28 @@ uint64_t spdk_fd_get_size(int fd);
  */
 uint32_t spdk_fd_get_blocklen(int fd);
 
+/**
+ * Get the fallocate() mode deallocating ranges of the file.
+ *
+ * The support of the mode is probed without modifying the file.
+ *
+ * \param fd  File descriptor, opened for writing.
+ *
+ * \return    fallocate() mode, or negative errno if ranges of the file can't be deallocated.
+ */
+int spdk_fd_get_discard_mode(int fd);
+
+/**
+ * Get the fallocate() mode zeroing ranges of the file.
+ *
+ * The support of the mode is probed without modifying the file.
+ *
+ * \param fd  File descriptor, opened for writing.
+ *
+ * \return    fallocate() mode, or negative errno if ranges of the file can't be zeroed.
+ */
+int spdk_fd_get_zeroes_mode(int fd);
+
 #ifdef __cplusplus
 }
 #endif
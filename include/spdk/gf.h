@@ -0,0 +1,102 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+/**
+ * \file
+ * Galois field GF(2^8) utility functions
+ *
+ * The field is generated by the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d) with generator 2,
+ * the same field as used by Linux MD and ISA-L RAID6.
+ */
+
+#ifndef SPDK_GF_H
+#define SPDK_GF_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Multiply two GF(2^8) elements.
+ *
+ * \param a First element.
+ * \param b Second element.
+ * \return Product of a and b.
+ */
+uint8_t spdk_gf_mul(uint8_t a, uint8_t b);
+
+/**
+ * Get the multiplicative inverse of a GF(2^8) element.
+ *
+ * \param a Element to invert.
+ * \return Inverse of a, or 0 if a is 0.
+ */
+uint8_t spdk_gf_inv(uint8_t a);
+
+/**
+ * Raise the generator of GF(2^8) to a power.
+ *
+ * \param e Exponent.
+ * \return Generator raised to the power of e. It is the Q syndrome coefficient of data buffer e.
+ */
+uint8_t spdk_gf_exp(uint32_t e);
+
+/**
+ * Multiply every byte of a buffer by a constant.
+ *
+ * \param dest Destination buffer. May be the same as src.
+ * \param src Source buffer.
+ * \param c Constant to multiply by.
+ * \param len Length of the buffers in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_gf_mul_buf(void *dest, const void *src, uint8_t c, uint32_t len);
+
+/**
+ * Generate P (XOR) and Q (Reed-Solomon) syndromes from multiple source buffers.
+ *
+ * Q is the sum of every source buffer i multiplied by the generator raised to the power of i.
+ *
+ * \param p Destination buffer for the P syndrome.
+ * \param q Destination buffer for the Q syndrome.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers in the array. At most 255.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_gf_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len);
+
+/**
+ * Recover one or two data buffers from the remaining data buffers and the P and Q syndromes
+ * generated by spdk_gf_pq_gen().
+ *
+ * \param data Array of data buffers. The buffers of failed indexes are the destination of the
+ * recovered data, their content on input is ignored.
+ * \param n Number of data buffers in the array. At most 255.
+ * \param p P syndrome or NULL if it is not available.
+ * \param q Q syndrome or NULL if it is not available.
+ * \param failed Array of failed data buffer indexes.
+ * \param nfailed Number of failed data buffers, 1 or 2. Recovery of one buffer requires either
+ * of the syndromes, recovery of two buffers requires both.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_gf_pq_recover(void **data, uint32_t n, void *p, void *q, const uint32_t *failed,
+		       uint32_t nfailed, uint32_t len);
+
+/**
+ * Get the optimal buffer alignment for GF(2^8) functions.
+ *
+ * \return The alignment in bytes.
+ */
+size_t spdk_gf_get_optimal_alignment(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPDK_GF_H */
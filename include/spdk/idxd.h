@@ -12,6 +12,7 @@
 
 #include "spdk/stdinc.h"
 #include "spdk/idxd_spec.h"
+#include "spdk/dif.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -253,6 +254,95 @@ int spdk_idxd_submit_copy_crc32c(struct spdk_idxd_io_channel *chan,
 				 uint32_t seed, uint32_t *crc_dst, int flags,
 				 spdk_idxd_req_cb cb_fn, void *cb_arg);
 
+/**
+ * Check whether DSA can process DIF of the given format.
+ *
+ * DSA supports 512 and 4096 byte data blocks followed by 8 bytes of metadata holding the DIF
+ * with a 16-bit guard computed with a zero seed.
+ *
+ * \param ctx DIF context.
+ *
+ * \return true if spdk_idxd_submit_dif_check(), spdk_idxd_submit_dif_insert() and
+ * spdk_idxd_submit_dif_strip() can be used with the context.
+ */
+bool spdk_idxd_dif_ctx_is_supported(const struct spdk_dif_ctx *ctx);
+
+/**
+ * Build and submit a DSA DIF check request, the equivalent of spdk_dif_verify().
+ *
+ * Each element of siov must hold whole extended blocks. The request completes with -EIO
+ * status if a DIF error is found.
+ *
+ * \param chan IDXD channel to submit request.
+ * \param siov Source iovec describing the extended LBA payload.
+ * \param siovcnt Number of elements in siov
+ * \param num_blocks Number of blocks to check.
+ * \param ctx DIF context, see spdk_idxd_dif_ctx_is_supported().
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Callback function which will be called when the request is complete.
+ * \param cb_arg Opaque value which will be passed back as the cb_arg parameter
+ * in the completion callback.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_idxd_submit_dif_check(struct spdk_idxd_io_channel *chan,
+			       struct iovec *siov, size_t siovcnt,
+			       uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+			       spdk_idxd_req_cb cb_fn, void *cb_arg);
+
+/**
+ * Build and submit a DSA DIF insert request, the equivalent of spdk_dif_generate_copy().
+ *
+ * Each element of siov must hold whole data blocks and each element of diov whole extended
+ * blocks.
+ *
+ * \param chan IDXD channel to submit request.
+ * \param diov Destination iovec describing the extended LBA payload.
+ * \param diovcnt Number of elements in diov
+ * \param siov Source iovec describing the LBA payload.
+ * \param siovcnt Number of elements in siov
+ * \param num_blocks Number of blocks to copy.
+ * \param ctx DIF context, see spdk_idxd_dif_ctx_is_supported().
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Callback function which will be called when the request is complete.
+ * \param cb_arg Opaque value which will be passed back as the cb_arg parameter
+ * in the completion callback.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_idxd_submit_dif_insert(struct spdk_idxd_io_channel *chan,
+				struct iovec *diov, size_t diovcnt,
+				struct iovec *siov, size_t siovcnt,
+				uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+				spdk_idxd_req_cb cb_fn, void *cb_arg);
+
+/**
+ * Build and submit a DSA DIF strip request, which checks the DIF and copies the data without
+ * the metadata, the equivalent of spdk_dif_verify_copy().
+ *
+ * Each element of siov must hold whole extended blocks and each element of diov whole data
+ * blocks. The request completes with -EIO status if a DIF error is found.
+ *
+ * \param chan IDXD channel to submit request.
+ * \param diov Destination iovec describing the LBA payload.
+ * \param diovcnt Number of elements in diov
+ * \param siov Source iovec describing the extended LBA payload.
+ * \param siovcnt Number of elements in siov
+ * \param num_blocks Number of blocks to copy.
+ * \param ctx DIF context, see spdk_idxd_dif_ctx_is_supported().
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Callback function which will be called when the request is complete.
+ * \param cb_arg Opaque value which will be passed back as the cb_arg parameter
+ * in the completion callback.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_idxd_submit_dif_strip(struct spdk_idxd_io_channel *chan,
+			       struct iovec *diov, size_t diovcnt,
+			       struct iovec *siov, size_t siovcnt,
+			       uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+			       spdk_idxd_req_cb cb_fn, void *cb_arg);
+
 /**
  * Build and submit an IAA memory compress request.
  *
@@ -38,6 +38,28 @@ extern "C" {
 #define IDXD_FLAG_DEST_STEERING_TAG	(1 << 15)
 #define IDXD_FLAG_CRC_READ_CRC_SEED	(1 << 16)
 
+#define IDXD_DIF_FLAG_INVERT_CRC_SEED		(1 << 2)
+#define IDXD_DIF_FLAG_INVERT_CRC_RESULT		(1 << 3)
+#define IDXD_DIF_FLAG_DIF_BLOCK_SIZE_512	0x0
+#define IDXD_DIF_FLAG_DIF_BLOCK_SIZE_520	0x1
+#define IDXD_DIF_FLAG_DIF_BLOCK_SIZE_4096	0x2
+#define IDXD_DIF_FLAG_DIF_BLOCK_SIZE_4104	0x3
+
+#define IDXD_DIF_SOURCE_FLAG_ENABLE_ALL_F_DETECT_ERROR	(1 << 0)
+#define IDXD_DIF_SOURCE_FLAG_ALL_F_DETECT		(1 << 1)
+#define IDXD_DIF_SOURCE_FLAG_APP_TAG_F_DETECT		(1 << 2)
+#define IDXD_DIF_SOURCE_FLAG_APP_AND_REF_TAG_F_DETECT	(1 << 3)
+#define IDXD_DIF_SOURCE_FLAG_APP_TAG_TYPE		(1 << 4)
+#define IDXD_DIF_SOURCE_FLAG_GUARD_CHECK_DISABLE	(1 << 5)
+#define IDXD_DIF_SOURCE_FLAG_REF_TAG_CHECK_DISABLE	(1 << 6)
+#define IDXD_DIF_SOURCE_FLAG_REF_TAG_TYPE		(1 << 7)
+
+#define IDXD_DIF_DEST_FLAG_APP_TAG_PASS_THROUGH		(1 << 3)
+#define IDXD_DIF_DEST_FLAG_APP_TAG_TYPE			(1 << 4)
+#define IDXD_DIF_DEST_FLAG_GUARD_PASS_THROUGH		(1 << 5)
+#define IDXD_DIF_DEST_FLAG_REF_TAG_PASS_THROUGH		(1 << 6)
+#define IDXD_DIF_DEST_FLAG_REF_TAG_TYPE			(1 << 7)
+
 #define IAA_FLAG_RD_SRC2_AECS		(1 << 16)
 #define IAA_COMP_FLUSH_OUTPUT		(1 << 1)
 #define IAA_COMP_APPEND_EOB		(1 << 2)
@@ -72,6 +72,18 @@ typedef void (*spdk_subsystem_init_fn)(int rc, void *ctx);
  */
 void spdk_subsystem_init(spdk_subsystem_init_fn cb_fn, void *cb_arg);
 
+/**
+ * Set the maximum number of JSON config entries sent concurrently by
+ * spdk_subsystem_init_from_json_config. Only consecutive entries creating independent objects
+ * (e.g. bdev_malloc_create entries with different names) are sent concurrently, all other
+ * entries are still sent one by one. The default is 1, i.e. no concurrency.
+ *
+ * \param max_concurrent_rpcs Maximum number of entries sent concurrently, from 1 to 32.
+ *
+ * \return 0 on success, -EINVAL if max_concurrent_rpcs is out of range.
+ */
+int spdk_subsystem_set_json_config_max_concurrent_rpcs(uint32_t max_concurrent_rpcs);
+
 /**
  * Like spdk_subsystem_init, but additionally configure each subsystem using the provided JSON config
  * file. This will automatically start a JSON RPC server and then stop it.
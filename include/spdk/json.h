@@ -179,6 +179,15 @@ typedef int (*spdk_json_write_cb)(void *cb_ctx, const void *data, size_t size);
 struct spdk_json_write_ctx *spdk_json_write_begin(spdk_json_write_cb write_cb, void *cb_ctx,
 		uint32_t flags);
 int spdk_json_write_end(struct spdk_json_write_ctx *w);
+
+/**
+ * Pass everything written so far to the write callback, without ending the JSON value.
+ *
+ * \param w JSON write context.
+ *
+ * \return 0 on success, -1 if the write context has failed.
+ */
+int spdk_json_write_flush(struct spdk_json_write_ctx *w);
 int spdk_json_write_null(struct spdk_json_write_ctx *w);
 int spdk_json_write_bool(struct spdk_json_write_ctx *w, bool val);
 int spdk_json_write_uint8(struct spdk_json_write_ctx *w, uint8_t val);
@@ -171,6 +171,19 @@ struct spdk_json_write_ctx *spdk_jsonrpc_begin_result(struct spdk_jsonrpc_reques
  */
 void spdk_jsonrpc_end_result(struct spdk_jsonrpc_request *request, struct spdk_json_write_ctx *w);
 
+/**
+ * Start sending the part of a JSON-RPC response written so far, before it's complete.
+ *
+ * This lets large responses be sent while they're still being written, instead of being
+ * buffered until spdk_jsonrpc_end_result() is called.  Once a part of a response has been sent,
+ * other responses on the same connection are only sent after it's complete.
+ *
+ * \param request Request to send the part of the response for.
+ * \param w JSON write context returned from spdk_jsonrpc_begin_result().
+ */
+void spdk_jsonrpc_flush_result(struct spdk_jsonrpc_request *request,
+			       struct spdk_json_write_ctx *w);
+
 /**
  * Complete a JSON-RPC response and write bool result.
  *
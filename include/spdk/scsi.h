@@ -58,6 +58,7 @@ enum spdk_scsi_task_mgmt_resp {
 };
 
 struct spdk_scsi_task;
+struct spdk_scsi_lun_channel;
 typedef void (*spdk_scsi_task_cpl)(struct spdk_scsi_task *task);
 typedef void (*spdk_scsi_task_free)(struct spdk_scsi_task *task);
 
@@ -110,6 +111,12 @@ struct spdk_scsi_task {
 
 	uint32_t abort_id;
 	struct spdk_bdev_io_wait_entry bdev_io_wait;
+
+	/**
+	 * \internal
+	 * Per-thread state of the LUN which the task is executed on.
+	 */
+	struct spdk_scsi_lun_channel *lun_ch;
 };
 
 struct spdk_scsi_port;
@@ -219,7 +226,8 @@ struct spdk_scsi_lun *spdk_scsi_dev_get_next_lun(struct spdk_scsi_lun *prev_lun)
  *
  * \param dev SCSI device.
  * \param initiator_port Check tasks only from the initiator if specified, or
- * all all tasks otherwise.
+ * all all tasks otherwise. Tasks of the initiator are only checked if they were
+ * submitted from the calling thread.
  *
  * \return true if the SCSI device has any pending task, or false otherwise.
  */
@@ -1072,6 +1072,19 @@ int spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts);
  */
 void spdk_iobuf_get_opts(struct spdk_iobuf_opts *opts);
 
+/**
+ * Get the memory regions the iobuf pools are allocated from.  Every buffer returned by
+ * `spdk_iobuf_get()` is located within one of them, which allows registering the buffers
+ * with e.g. a kernel interface once, instead of for each I/O.
+ *
+ * \param iovs Array filled with the base address and the size of each region.
+ * \param iovcnt Number of entries in iovs.
+ *
+ * \return Number of regions, 0 if the pools are not initialized, or -ENOMEM if iovcnt is too
+ * small to describe all of them.
+ */
+int spdk_iobuf_get_pool_regions(struct iovec *iovs, int iovcnt);
+
 /**
  * Register a module as an iobuf pool user.  Only registered users can request buffers from the
  * iobuf pool.
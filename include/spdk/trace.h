@@ -87,7 +87,10 @@ struct spdk_trace_tpoint {
 };
 
 struct spdk_trace_history {
-	/** Logical core number associated with this structure instance. */
+	/**
+	 * Logical core number associated with this structure instance, or
+	 *  SPDK_TRACE_THREAD_HISTORY_ID(n) for the n-th thread history.
+	 */
 	int				lcore;
 
 	/** Number of trace_entries contained in each trace_history. */
@@ -114,7 +117,21 @@ struct spdk_trace_history {
 
 #define SPDK_TRACE_MAX_LCORE		128
 
+/*
+ * Threads that don't run on an SPDK lcore (e.g. threads of an application embedding SPDK)
+ * get their own trace history on first use, identified by SPDK_TRACE_THREAD_HISTORY_ID(n).
+ * SPDK_TRACE_MAX_LCORE itself is never a history, the trace parser uses it to select all of them.
+ */
+#define SPDK_TRACE_MAX_THREADS		64
+#define SPDK_TRACE_THREAD_HISTORY_ID(n)	(SPDK_TRACE_MAX_LCORE + 1 + (n))
+#define SPDK_TRACE_MAX_HISTORIES	SPDK_TRACE_THREAD_HISTORY_ID(SPDK_TRACE_MAX_THREADS)
+
+/* Layout version of struct spdk_trace_histories, changed whenever the layout changes */
+#define SPDK_TRACE_VERSION		2
+
 struct spdk_trace_flags {
+	/** SPDK_TRACE_VERSION of the process that created the trace file. */
+	uint64_t			version;
 	uint64_t			tsc_rate;
 	uint64_t			tpoint_mask[SPDK_TRACE_MAX_GROUP_ID];
 	struct spdk_trace_owner		owner[UCHAR_MAX + 1];
@@ -122,9 +139,10 @@ struct spdk_trace_flags {
 	struct spdk_trace_tpoint	tpoint[SPDK_TRACE_MAX_TPOINT_ID];
 
 	/** Offset of each trace_history from the beginning of this data structure.
-	 * The last one is the offset of the file end.
+	 * The first SPDK_TRACE_MAX_LCORE ones belong to lcores, the others to threads and are
+	 * set when a thread registers its history.  The last one is the offset of the file end.
 	 */
-	uint64_t			lcore_history_offsets[SPDK_TRACE_MAX_LCORE + 1];
+	uint64_t			lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES + 1];
 };
 extern struct spdk_trace_flags *g_trace_flags;
 extern struct spdk_trace_histories *g_trace_histories;
@@ -151,7 +169,7 @@ spdk_get_trace_history_size(uint64_t num_entries)
 static inline uint64_t
 spdk_get_trace_histories_size(struct spdk_trace_histories *trace_histories)
 {
-	return trace_histories->flags.lcore_history_offsets[SPDK_TRACE_MAX_LCORE];
+	return trace_histories->flags.lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES];
 }
 
 static inline struct spdk_trace_history *
@@ -159,7 +177,7 @@ spdk_get_per_lcore_history(struct spdk_trace_histories *trace_histories, unsigne
 {
 	uint64_t lcore_history_offset;
 
-	if (lcore >= SPDK_TRACE_MAX_LCORE) {
+	if (lcore >= SPDK_TRACE_MAX_HISTORIES) {
 		return NULL;
 	}
 
@@ -224,6 +242,64 @@ void _spdk_trace_record(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id,
 #define spdk_trace_record(tpoint_id, poller_id, size, object_id, ...) \
 	spdk_trace_record_tsc(0, tpoint_id, poller_id, size, object_id, ## __VA_ARGS__)
 
+#define SPDK_TRACE_MAX_INT_ARGS_COUNT 4
+
+void _spdk_trace_record_int(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id,
+			    uint32_t size, uint64_t object_id, int num_args,
+			    uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4);
+
+#define _spdk_trace_int_args(...) __spdk_trace_int_args(__VA_ARGS__)
+#define __spdk_trace_int_args(v, a1, a2, a3, a4, ...)				\
+	(uint64_t)(uintptr_t)(a1), (uint64_t)(uintptr_t)(a2),			\
+	(uint64_t)(uintptr_t)(a3), (uint64_t)(uintptr_t)(a4)
+
+/**
+ * Record a tracepoint whose arguments are all integers or pointers.
+ *
+ * Unlike spdk_trace_record_tsc(), the number of arguments is fixed at compile time and
+ * they are passed in registers.  Each argument is recorded as 8 bytes, so the layout of
+ * the entries is known at compile time too and the tracepoint definition isn't consulted.
+ * The entries are the same as the ones recorded by spdk_trace_record_tsc().
+ *
+ * \param tsc Current tsc.
+ * \param tpoint_id Tracepoint id to record.
+ * \param poller_id Poller id to record.
+ * \param size Size to record.
+ * \param object_id Object id to record.
+ * \param ... Up to 4 integer or pointer arguments. The number and order of the arguments
+ *	      must match the definition of the tracepoint, whose arguments must all be 8 byte
+ *	      integers or pointers.
+ */
+#define spdk_trace_record_int_tsc(tsc, tpoint_id, poller_id, size, object_id, ...)		\
+	do {											\
+		SPDK_STATIC_ASSERT(spdk_trace_num_args(__VA_ARGS__) <= SPDK_TRACE_MAX_INT_ARGS_COUNT, \
+				   "Too many integer tracepoint arguments");			\
+		assert(tpoint_id < SPDK_TRACE_MAX_TPOINT_ID);					\
+		if (g_trace_histories == NULL ||						\
+		    !((1ULL << (tpoint_id & 0x3F)) &						\
+		      g_trace_histories->flags.tpoint_mask[tpoint_id >> 6])) {			\
+			break;									\
+		}										\
+		_spdk_trace_record_int(tsc, tpoint_id, poller_id, size, object_id,		\
+				       spdk_trace_num_args(__VA_ARGS__),			\
+				       _spdk_trace_int_args(, ## __VA_ARGS__, 0, 0, 0, 0));	\
+	} while (0)
+
+/**
+ * Record a tracepoint whose arguments are all integers or pointers. This macro will call
+ * spdk_get_ticks() to get the current tsc to save in the tracepoint.
+ *
+ * \param tpoint_id Tracepoint id to record.
+ * \param poller_id Poller id to record.
+ * \param size Size to record.
+ * \param object_id Object id to record.
+ * \param ... Up to 4 integer or pointer arguments. The number and order of the arguments
+ *	      must match the definition of the tracepoint, whose arguments must all be 8 byte
+ *	      integers or pointers.
+ */
+#define spdk_trace_record_int(tpoint_id, poller_id, size, object_id, ...) \
+	spdk_trace_record_int_tsc(0, tpoint_id, poller_id, size, object_id, ## __VA_ARGS__)
+
 /**
  * Get the current tpoint mask of the given tpoint group.
  *
@@ -277,8 +353,11 @@ void spdk_trace_clear_tpoint_group_mask(uint64_t tpoint_group_mask);
  * the given shared memory to post-process the tpoint entries and display in a
  * human-readable format.
  *
+ * Threads not running on an SPDK lcore get a history of the same size in the shared memory
+ * the first time they record a tracepoint, up to SPDK_TRACE_MAX_THREADS of them.
+ *
  * \param shm_name Name of shared memory.
- * \param num_entries Number of trace entries per lcore.
+ * \param num_entries Number of trace entries per lcore or thread.
  * \return 0 on success, else non-zero indicates a failure.
  */
 int spdk_trace_init(const char *shm_name, uint64_t num_entries);
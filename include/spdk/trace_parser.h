@@ -33,14 +33,18 @@ struct spdk_trace_parser_opts {
 	const char	*filename;
 	/** Trace file type, either regular file or shared memory */
 	int		mode;
-	/** Logical core number to parse the traces from (or SPDK_TRACE_MAX_LCORE) for all cores */
+	/**
+	 * Logical core number or thread history ID to parse the traces from (or
+	 * SPDK_TRACE_MAX_LCORE for all cores and threads)
+	 */
 	uint16_t	lcore;
 };
 
 /**
  * Initialize the parser using a specified trace file.  This results in parsing the traces, merging
  * entries from multiple cores together and sorting them by their tsc, so it can take a significant
- * amount of time to complete.
+ * amount of time to complete.  Files written by spdk_trace_record in streaming mode are instead
+ * decoded block by block as the entries are read.
  *
  * \param opts Describes the trace file to parse.
  *
@@ -85,7 +89,7 @@ struct spdk_trace_parser_entry {
 	uint64_t		object_index;
 	/** The tsc of when the object tied to this entry was created */
 	uint64_t		object_start;
-	/** Logical core number */
+	/** Logical core number or thread history ID */
 	uint16_t		lcore;
 	/** Related object index */
 	uint64_t		related_index;
@@ -101,7 +105,8 @@ struct spdk_trace_parser_entry {
 
 /**
  * Return next parsed trace entry.  Once no more traces are available, this will return false and
- * entry won't be touched.
+ * entry won't be touched.  The trace entry referenced by entry->entry is only valid until the next
+ * call.
  *
  * \param parser Parser object to be used.
  * \param entry Tracepoint entry.
@@ -112,15 +117,85 @@ bool spdk_trace_parser_next_entry(struct spdk_trace_parser *parser,
 				  struct spdk_trace_parser_entry *entry);
 
 /**
- * Return the number of entries recorded on a given core.
+ * Return the number of entries recorded on a given core or thread.
  *
  * \param parser Parser object to be used.
- * \param lcore Logical core number.
+ * \param lcore Logical core number or thread history ID.
  *
  * \return Number of entries.
  */
 uint64_t spdk_trace_parser_get_entry_count(const struct spdk_trace_parser *parser, uint16_t lcore);
 
+/**
+ * Return the number of entries of a given core that were lost while recording a trace stream,
+ * i.e. overwritten in the shared memory before spdk_trace_record could read them.
+ *
+ * \param parser Parser object to be used.
+ * \param lcore Logical core number or thread history ID.
+ *
+ * \return Number of dropped entries, always 0 unless the trace file is a trace stream.
+ */
+uint64_t spdk_trace_parser_get_dropped_count(const struct spdk_trace_parser *parser,
+		uint16_t lcore);
+
+/** Latency analysis of parsed trace entries */
+struct spdk_trace_analysis;
+
+/** Options of a latency analysis */
+struct spdk_trace_analysis_opts {
+	/** Number of the slowest requests whose timelines are reported */
+	uint32_t	top_n;
+	/** Report the latency histogram of each stage, not only its percentiles */
+	bool		histograms;
+};
+
+/**
+ * Create a latency analysis of trace entries.
+ *
+ * Entries of objects tied together by tracepoint relations (e.g. an nvmf request, the bdev_io
+ * submitted for it and the NVMe request submitted for that bdev_io) are grouped into a single
+ * request.  A request is complete once the object ID of its first object is reused or at the end
+ * of the trace.  Requests are classified by their first tracepoint and the latencies between the
+ * consecutive tracepoints of each request are accumulated per class.
+ *
+ * \param parser Parser object the entries come from.
+ * \param opts Analysis options.
+ *
+ * \return Analysis object or NULL in case of any failures.
+ */
+struct spdk_trace_analysis *spdk_trace_analysis_create(const struct spdk_trace_parser *parser,
+		const struct spdk_trace_analysis_opts *opts);
+
+/**
+ * Add a parsed trace entry to the analysis.  Entries need to be added in the order they are
+ * returned by spdk_trace_parser_next_entry().
+ *
+ * \param analysis Analysis object.
+ * \param entry Tracepoint entry.
+ *
+ * \return 0 on success, -ENOMEM if memory could not be allocated.
+ */
+int spdk_trace_analysis_add_entry(struct spdk_trace_analysis *analysis,
+				  const struct spdk_trace_parser_entry *entry);
+
+/**
+ * Complete the requests still in progress and print the per stage latency percentiles of each
+ * class of requests, followed by the timelines of the slowest requests.
+ *
+ * \param analysis Analysis object.
+ * \param file File to print the report to.
+ *
+ * \return 0 on success, -ENOMEM if memory could not be allocated.
+ */
+int spdk_trace_analysis_report(struct spdk_trace_analysis *analysis, FILE *file);
+
+/**
+ * Free an analysis object.
+ *
+ * \param analysis Analysis object.
+ */
+void spdk_trace_analysis_free(struct spdk_trace_analysis *analysis);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,83 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+/** \file
+ * Trace stream file format, written by spdk_trace_record in streaming mode
+ *
+ * The file is laid out as:
+ *
+ *   struct spdk_trace_stream_header
+ *   struct spdk_trace_stream_block, followed by data_size bytes of entries (repeated)
+ *   struct spdk_trace_stream_index_entry[num_blocks]
+ *   struct spdk_trace_stream_footer
+ *
+ * Each block holds consecutive entries of a single trace history, either stored as they are or
+ * deflate-compressed.  The index and the footer are only written once the capture ends, a file
+ * without them (e.g. if the recorder got killed) can still be read by walking the blocks.
+ */
+
+#ifndef SPDK_INTERNAL_TRACE_STREAM_H
+#define SPDK_INTERNAL_TRACE_STREAM_H
+
+#include "spdk/stdinc.h"
+#include "spdk/assert.h"
+#include "spdk/trace.h"
+
+#define SPDK_TRACE_STREAM_MAGIC		"SPDKTRZ"
+#define SPDK_TRACE_STREAM_VERSION	1
+#define SPDK_TRACE_STREAM_BLOCK_MAGIC	0x4b4c4254 /* "TBLK" */
+
+/* Maximum number of entries in a block */
+#define SPDK_TRACE_STREAM_BLOCK_ENTRIES	4096
+
+enum spdk_trace_stream_encoding {
+	SPDK_TRACE_STREAM_ENCODING_RAW		= 0,
+	SPDK_TRACE_STREAM_ENCODING_DEFLATE	= 1,
+};
+
+struct spdk_trace_stream_header {
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		reserved;
+
+	/* Tracepoint definitions, lcore_history_offsets are not used */
+	struct spdk_trace_flags	flags;
+};
+
+struct spdk_trace_stream_block {
+	uint32_t		magic;
+	uint16_t		lcore;
+	/* One of enum spdk_trace_stream_encoding */
+	uint8_t			encoding;
+	uint8_t			reserved;
+	uint32_t		num_entries;
+	/* Size of the data following the block header */
+	uint32_t		data_size;
+	uint64_t		first_tsc;
+	uint64_t		last_tsc;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_trace_stream_block) == 32, "Incorrect size");
+
+struct spdk_trace_stream_index_entry {
+	/* Offset of the block header in the file */
+	uint64_t		offset;
+	uint64_t		first_tsc;
+	uint64_t		last_tsc;
+	uint32_t		num_entries;
+	uint16_t		lcore;
+	uint16_t		reserved;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_trace_stream_index_entry) == 32, "Incorrect size");
+
+struct spdk_trace_stream_footer {
+	uint64_t		index_offset;
+	uint64_t		num_blocks;
+	/* Number of entries recorded and lost (overwritten before they were read) per history */
+	uint64_t		num_entries[SPDK_TRACE_MAX_HISTORIES];
+	uint64_t		num_dropped[SPDK_TRACE_MAX_HISTORIES];
+	char			magic[8];
+};
+
+#endif /* SPDK_INTERNAL_TRACE_STREAM_H */
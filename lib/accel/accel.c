@@ -76,7 +76,8 @@ static struct spdk_spinlock g_stats_lock;
 
 static const char *g_opcode_strings[SPDK_ACCEL_OPC_LAST] = {
 	"copy", "fill", "dualcast", "compare", "crc32c", "copy_crc32c",
-	"compress", "decompress", "encrypt", "decrypt", "xor"
+	"compress", "decompress", "encrypt", "decrypt", "xor", "pq_gen",
+	"dif_verify", "dif_generate", "dif_generate_copy", "dif_verify_copy"
 };
 
 enum accel_sequence_state {
@@ -136,12 +137,23 @@ struct accel_buffer {
 	TAILQ_ENTRY(accel_buffer)	link;
 };
 
-struct accel_io_channel {
-	struct spdk_io_channel			*module_ch[SPDK_ACCEL_OPC_LAST];
-	struct spdk_io_channel			*driver_channel;
+/*
+ * Memory of the task, sequence and buffer pools of a channel.  A module may hold it past the
+ * lifetime of the channel, while some of the channel's tasks are still in its hands.
+ */
+struct accel_channel_pools {
 	void					*task_pool_base;
 	struct spdk_accel_sequence		*seq_pool_base;
 	struct accel_buffer			*buf_pool_base;
+	/* Channel owning the pools, NULL once it's destroyed */
+	struct accel_io_channel			*ch;
+	uint32_t				refcnt;
+};
+
+struct accel_io_channel {
+	struct spdk_io_channel			*module_ch[SPDK_ACCEL_OPC_LAST];
+	struct spdk_io_channel			*driver_channel;
+	struct accel_channel_pools		*pools;
 	TAILQ_HEAD(, spdk_accel_task)		task_pool;
 	TAILQ_HEAD(, spdk_accel_sequence)	seq_pool;
 	TAILQ_HEAD(, accel_buffer)		buf_pool;
@@ -781,6 +793,153 @@ spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uin
 	return accel_submit_task(accel_ch, accel_task);
 }
 
+int
+spdk_accel_submit_pq_gen(struct spdk_io_channel *ch, void *p, void *q, void **sources,
+			 uint32_t nsrcs, uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	accel_task->nsrcs.srcs = sources;
+	accel_task->nsrcs.cnt = nsrcs;
+	accel_task->d.iovs = &accel_task->aux_iovs[SPDK_ACCEL_AUX_IOV_DST];
+	accel_task->d.iovs[0].iov_base = p;
+	accel_task->d.iovs[0].iov_len = nbytes;
+	accel_task->d.iovcnt = 1;
+	accel_task->d2.iovs = &accel_task->aux_iovs[SPDK_ACCEL_AUX_IOV_DST2];
+	accel_task->d2.iovs[0].iov_base = q;
+	accel_task->d2.iovs[0].iov_len = nbytes;
+	accel_task->d2.iovcnt = 1;
+	accel_task->nbytes = nbytes;
+	accel_task->op_code = SPDK_ACCEL_OPC_PQ_GEN;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+	accel_task->step_cb_fn = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+int
+spdk_accel_submit_dif_verify(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+			     uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			     struct spdk_dif_error *err, spdk_accel_completion_cb cb_fn,
+			     void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	accel_task->s.iovs = iovs;
+	accel_task->s.iovcnt = iovcnt;
+	accel_task->dif.ctx = ctx;
+	accel_task->dif.err = err;
+	accel_task->num_blocks = num_blocks;
+	accel_task->nbytes = accel_get_iovlen(iovs, iovcnt);
+	accel_task->op_code = SPDK_ACCEL_OPC_DIF_VERIFY;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+	accel_task->step_cb_fn = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+int
+spdk_accel_submit_dif_generate(struct spdk_io_channel *ch, struct iovec *iovs, size_t iovcnt,
+			       uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			       spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	accel_task->s.iovs = iovs;
+	accel_task->s.iovcnt = iovcnt;
+	accel_task->dif.ctx = ctx;
+	accel_task->dif.err = NULL;
+	accel_task->num_blocks = num_blocks;
+	accel_task->nbytes = accel_get_iovlen(iovs, iovcnt);
+	accel_task->op_code = SPDK_ACCEL_OPC_DIF_GENERATE;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+	accel_task->step_cb_fn = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+int
+spdk_accel_submit_dif_generate_copy(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				    size_t dst_iovcnt, struct iovec *src_iovs, size_t src_iovcnt,
+				    uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				    spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	accel_task->s.iovs = src_iovs;
+	accel_task->s.iovcnt = src_iovcnt;
+	accel_task->d.iovs = dst_iovs;
+	accel_task->d.iovcnt = dst_iovcnt;
+	accel_task->dif.ctx = ctx;
+	accel_task->dif.err = NULL;
+	accel_task->num_blocks = num_blocks;
+	accel_task->nbytes = accel_get_iovlen(src_iovs, src_iovcnt);
+	accel_task->op_code = SPDK_ACCEL_OPC_DIF_GENERATE_COPY;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+	accel_task->step_cb_fn = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+int
+spdk_accel_submit_dif_verify_copy(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				  size_t dst_iovcnt, struct iovec *src_iovs, size_t src_iovcnt,
+				  uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				  struct spdk_dif_error *err, spdk_accel_completion_cb cb_fn,
+				  void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (spdk_unlikely(accel_task == NULL)) {
+		return -ENOMEM;
+	}
+
+	accel_task->s.iovs = src_iovs;
+	accel_task->s.iovcnt = src_iovcnt;
+	accel_task->d.iovs = dst_iovs;
+	accel_task->d.iovcnt = dst_iovcnt;
+	accel_task->dif.ctx = ctx;
+	accel_task->dif.err = err;
+	accel_task->num_blocks = num_blocks;
+	accel_task->nbytes = accel_get_iovlen(src_iovs, src_iovcnt);
+	accel_task->op_code = SPDK_ACCEL_OPC_DIF_VERIFY_COPY;
+	accel_task->src_domain = NULL;
+	accel_task->dst_domain = NULL;
+	accel_task->step_cb_fn = NULL;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
 static inline struct accel_buffer *
 accel_get_buf(struct accel_io_channel *ch, uint64_t len)
 {
@@ -966,6 +1125,54 @@ spdk_accel_append_fill(struct spdk_accel_sequence **pseq, struct spdk_io_channel
 	return 0;
 }
 
+int
+spdk_accel_append_compress(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+			   struct iovec *dst_iovs, size_t dst_iovcnt,
+			   struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+			   struct iovec *src_iovs, size_t src_iovcnt,
+			   struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+			   uint32_t *output_size, int flags, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->output_size = output_size;
+	task->dst_domain = dst_domain;
+	task->dst_domain_ctx = dst_domain_ctx;
+	task->d.iovs = dst_iovs;
+	task->d.iovcnt = dst_iovcnt;
+	task->src_domain = src_domain;
+	task->src_domain_ctx = src_domain_ctx;
+	task->s.iovs = src_iovs;
+	task->s.iovcnt = src_iovcnt;
+	task->nbytes = accel_get_iovlen(src_iovs, src_iovcnt);
+	task->flags = flags;
+	task->op_code = SPDK_ACCEL_OPC_COMPRESS;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
 int
 spdk_accel_append_decompress(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
 			     struct iovec *dst_iovs, size_t dst_iovcnt,
@@ -1166,6 +1373,249 @@ spdk_accel_append_crc32c(struct spdk_accel_sequence **pseq, struct spdk_io_chann
 	return 0;
 }
 
+int
+spdk_accel_append_xor(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+		      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		      struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+		      void **sources, uint32_t nsrcs, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	if (spdk_unlikely(dst_iovcnt != 1 || nsrcs < 2)) {
+		return -EINVAL;
+	}
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->nsrcs.srcs = sources;
+	task->nsrcs.cnt = nsrcs;
+	task->dst_domain = dst_domain;
+	task->dst_domain_ctx = dst_domain_ctx;
+	task->d.iovs = dst_iovs;
+	task->d.iovcnt = dst_iovcnt;
+	task->nbytes = dst_iovs[0].iov_len;
+	task->op_code = SPDK_ACCEL_OPC_XOR;
+	task->src_domain = NULL;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
+int
+spdk_accel_append_dif_verify(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+			     struct iovec *iovs, size_t iovcnt,
+			     struct spdk_memory_domain *domain, void *domain_ctx,
+			     uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			     struct spdk_dif_error *err, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->s.iovs = iovs;
+	task->s.iovcnt = iovcnt;
+	task->src_domain = domain;
+	task->src_domain_ctx = domain_ctx;
+	task->dst_domain = NULL;
+	task->nbytes = accel_get_iovlen(iovs, iovcnt);
+	task->dif.ctx = ctx;
+	task->dif.err = err;
+	task->num_blocks = num_blocks;
+	task->op_code = SPDK_ACCEL_OPC_DIF_VERIFY;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
+int
+spdk_accel_append_dif_generate(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+			       struct iovec *iovs, size_t iovcnt,
+			       struct spdk_memory_domain *domain, void *domain_ctx,
+			       uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			       spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	/* The data is modified in place and only destination buffers are pushed back to their
+	 * memory domain */
+	if (domain != NULL && domain != g_accel_domain) {
+		return -ENOTSUP;
+	}
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->s.iovs = iovs;
+	task->s.iovcnt = iovcnt;
+	task->src_domain = domain;
+	task->src_domain_ctx = domain_ctx;
+	task->dst_domain = NULL;
+	task->nbytes = accel_get_iovlen(iovs, iovcnt);
+	task->dif.ctx = ctx;
+	task->dif.err = NULL;
+	task->num_blocks = num_blocks;
+	task->op_code = SPDK_ACCEL_OPC_DIF_GENERATE;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
+int
+spdk_accel_append_dif_generate_copy(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+				    struct iovec *dst_iovs, size_t dst_iovcnt,
+				    struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+				    struct iovec *src_iovs, size_t src_iovcnt,
+				    struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+				    uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				    spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->dst_domain = dst_domain;
+	task->dst_domain_ctx = dst_domain_ctx;
+	task->d.iovs = dst_iovs;
+	task->d.iovcnt = dst_iovcnt;
+	task->src_domain = src_domain;
+	task->src_domain_ctx = src_domain_ctx;
+	task->s.iovs = src_iovs;
+	task->s.iovcnt = src_iovcnt;
+	task->nbytes = accel_get_iovlen(src_iovs, src_iovcnt);
+	task->dif.ctx = ctx;
+	task->dif.err = NULL;
+	task->num_blocks = num_blocks;
+	task->op_code = SPDK_ACCEL_OPC_DIF_GENERATE_COPY;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
+int
+spdk_accel_append_dif_verify_copy(struct spdk_accel_sequence **pseq, struct spdk_io_channel *ch,
+				  struct iovec *dst_iovs, size_t dst_iovcnt,
+				  struct spdk_memory_domain *dst_domain, void *dst_domain_ctx,
+				  struct iovec *src_iovs, size_t src_iovcnt,
+				  struct spdk_memory_domain *src_domain, void *src_domain_ctx,
+				  uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+				  struct spdk_dif_error *err, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	struct spdk_accel_sequence *seq = *pseq;
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (spdk_unlikely(seq == NULL)) {
+			return -ENOMEM;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (spdk_unlikely(task == NULL)) {
+		if (*pseq == NULL) {
+			accel_sequence_put(seq);
+		}
+
+		return -ENOMEM;
+	}
+
+	task->dst_domain = dst_domain;
+	task->dst_domain_ctx = dst_domain_ctx;
+	task->d.iovs = dst_iovs;
+	task->d.iovcnt = dst_iovcnt;
+	task->src_domain = src_domain;
+	task->src_domain_ctx = src_domain_ctx;
+	task->s.iovs = src_iovs;
+	task->s.iovcnt = src_iovcnt;
+	task->nbytes = accel_get_iovlen(src_iovs, src_iovcnt);
+	task->dif.ctx = ctx;
+	task->dif.err = err;
+	task->num_blocks = num_blocks;
+	task->op_code = SPDK_ACCEL_OPC_DIF_VERIFY_COPY;
+
+	TAILQ_INSERT_TAIL(&seq->tasks, task, seq_link);
+	*pseq = seq;
+
+	return 0;
+}
+
 int
 spdk_accel_get_buf(struct spdk_io_channel *ch, uint64_t len, void **buf,
 		   struct spdk_memory_domain **domain, void **domain_ctx)
@@ -1799,10 +2249,19 @@ accel_task_set_dstbuf(struct spdk_accel_task *task, struct spdk_accel_task *next
 	struct spdk_accel_task *prev;
 
 	switch (task->op_code) {
+	case SPDK_ACCEL_OPC_XOR:
+		/* xor can only write to a single, contiguous buffer */
+		if (next->d.iovcnt != 1) {
+			return false;
+		}
+		/* fallthrough */
+	case SPDK_ACCEL_OPC_COMPRESS:
 	case SPDK_ACCEL_OPC_DECOMPRESS:
 	case SPDK_ACCEL_OPC_FILL:
 	case SPDK_ACCEL_OPC_ENCRYPT:
 	case SPDK_ACCEL_OPC_DECRYPT:
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 		if (task->dst_domain != next->src_domain) {
 			return false;
 		}
@@ -1815,8 +2274,17 @@ accel_task_set_dstbuf(struct spdk_accel_task *task, struct spdk_accel_task *next
 		task->dst_domain = next->dst_domain;
 		task->dst_domain_ctx = next->dst_domain_ctx;
 		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		/* In-place DIF generation writes to its buffer, which can't be moved to a memory
+		 * domain, as such buffers are only pulled before the operation is executed */
+		if (next->dst_domain != NULL && next->dst_domain != g_accel_domain) {
+			return false;
+		}
+		/* fallthrough */
 	case SPDK_ACCEL_OPC_CRC32C:
-		/* crc32 is special, because it doesn't have a dst buffer */
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		/* crc32 and in-place DIF operations are special, because they don't have a dst
+		 * buffer */
 		if (task->src_domain != next->src_domain) {
 			return false;
 		}
@@ -1857,11 +2325,15 @@ accel_sequence_merge_tasks(struct spdk_accel_sequence *seq, struct spdk_accel_ta
 		 * change the src of the operation after fill (which in turn could also be a fill).
 		 * So, for the sake of simplicity, skip this type of operations for now.
 		 */
-		if (next->op_code != SPDK_ACCEL_OPC_DECOMPRESS &&
+		if (next->op_code != SPDK_ACCEL_OPC_COMPRESS &&
+		    next->op_code != SPDK_ACCEL_OPC_DECOMPRESS &&
 		    next->op_code != SPDK_ACCEL_OPC_COPY &&
 		    next->op_code != SPDK_ACCEL_OPC_ENCRYPT &&
 		    next->op_code != SPDK_ACCEL_OPC_DECRYPT &&
-		    next->op_code != SPDK_ACCEL_OPC_CRC32C) {
+		    next->op_code != SPDK_ACCEL_OPC_CRC32C &&
+		    next->op_code != SPDK_ACCEL_OPC_DIF_VERIFY &&
+		    next->op_code != SPDK_ACCEL_OPC_DIF_GENERATE_COPY &&
+		    next->op_code != SPDK_ACCEL_OPC_DIF_VERIFY_COPY) {
 			break;
 		}
 		if (task->dst_domain != next->src_domain) {
@@ -1878,11 +2350,17 @@ accel_sequence_merge_tasks(struct spdk_accel_sequence *seq, struct spdk_accel_ta
 		TAILQ_REMOVE(&seq->tasks, task, seq_link);
 		TAILQ_INSERT_TAIL(&seq->completed, task, seq_link);
 		break;
+	case SPDK_ACCEL_OPC_COMPRESS:
 	case SPDK_ACCEL_OPC_DECOMPRESS:
+	case SPDK_ACCEL_OPC_XOR:
 	case SPDK_ACCEL_OPC_FILL:
 	case SPDK_ACCEL_OPC_ENCRYPT:
 	case SPDK_ACCEL_OPC_DECRYPT:
 	case SPDK_ACCEL_OPC_CRC32C:
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 		/* We can only merge tasks when one of them is a copy */
 		if (next->op_code != SPDK_ACCEL_OPC_COPY) {
 			break;
@@ -2325,6 +2803,38 @@ spdk_accel_module_list_add(struct spdk_accel_module_if *accel_module)
 	}
 }
 
+struct accel_channel_pools *
+accel_task_get_pools(struct spdk_accel_task *task)
+{
+	return task->accel_ch->pools;
+}
+
+void
+accel_channel_pools_get(struct accel_channel_pools *pools)
+{
+	pools->refcnt++;
+}
+
+void
+accel_channel_pools_put(struct accel_channel_pools *pools)
+{
+	assert(pools->refcnt > 0);
+	if (--pools->refcnt > 0) {
+		return;
+	}
+
+	free(pools->task_pool_base);
+	free(pools->seq_pool_base);
+	free(pools->buf_pool_base);
+	free(pools);
+}
+
+bool
+accel_channel_pools_orphaned(struct accel_channel_pools *pools)
+{
+	return pools->ch == NULL;
+}
+
 /* Framework level channel create callback. */
 static int
 accel_create_channel(void *io_device, void *ctx_buf)
@@ -2333,22 +2843,32 @@ accel_create_channel(void *io_device, void *ctx_buf)
 	struct spdk_accel_task *accel_task;
 	struct spdk_accel_sequence *seq;
 	struct accel_buffer *buf;
+	struct accel_channel_pools *pools;
 	uint8_t *task_mem;
 	uint32_t i = 0, j;
 	int rc;
 
-	accel_ch->task_pool_base = calloc(g_opts.task_count, g_max_accel_module_size);
-	if (accel_ch->task_pool_base == NULL) {
+	pools = calloc(1, sizeof(*pools));
+	if (pools == NULL) {
 		return -ENOMEM;
 	}
 
-	accel_ch->seq_pool_base = calloc(g_opts.sequence_count, sizeof(struct spdk_accel_sequence));
-	if (accel_ch->seq_pool_base == NULL) {
+	pools->ch = accel_ch;
+	pools->refcnt = 1;
+	accel_ch->pools = pools;
+
+	pools->task_pool_base = calloc(g_opts.task_count, g_max_accel_module_size);
+	if (pools->task_pool_base == NULL) {
+		goto err;
+	}
+
+	pools->seq_pool_base = calloc(g_opts.sequence_count, sizeof(struct spdk_accel_sequence));
+	if (pools->seq_pool_base == NULL) {
 		goto err;
 	}
 
-	accel_ch->buf_pool_base = calloc(g_opts.buf_count, sizeof(struct accel_buffer));
-	if (accel_ch->buf_pool_base == NULL) {
+	pools->buf_pool_base = calloc(g_opts.buf_count, sizeof(struct accel_buffer));
+	if (pools->buf_pool_base == NULL) {
 		goto err;
 	}
 
@@ -2356,18 +2876,18 @@ accel_create_channel(void *io_device, void *ctx_buf)
 	TAILQ_INIT(&accel_ch->seq_pool);
 	TAILQ_INIT(&accel_ch->buf_pool);
 
-	task_mem = accel_ch->task_pool_base;
+	task_mem = pools->task_pool_base;
 	for (i = 0; i < g_opts.task_count; i++) {
 		accel_task = (struct spdk_accel_task *)task_mem;
 		TAILQ_INSERT_TAIL(&accel_ch->task_pool, accel_task, link);
 		task_mem += g_max_accel_module_size;
 	}
 	for (i = 0; i < g_opts.sequence_count; i++) {
-		seq = &accel_ch->seq_pool_base[i];
+		seq = &pools->seq_pool_base[i];
 		TAILQ_INSERT_TAIL(&accel_ch->seq_pool, seq, link);
 	}
 	for (i = 0; i < g_opts.buf_count; i++) {
-		buf = &accel_ch->buf_pool_base[i];
+		buf = &pools->buf_pool_base[i];
 		TAILQ_INSERT_TAIL(&accel_ch->buf_pool, buf, link);
 	}
 
@@ -2404,9 +2924,7 @@ err:
 	for (j = 0; j < i; j++) {
 		spdk_put_io_channel(accel_ch->module_ch[j]);
 	}
-	free(accel_ch->task_pool_base);
-	free(accel_ch->seq_pool_base);
-	free(accel_ch->buf_pool_base);
+	accel_channel_pools_put(pools);
 
 	return -ENOMEM;
 }
@@ -2449,9 +2967,10 @@ accel_destroy_channel(void *io_device, void *ctx_buf)
 	accel_add_stats(&g_stats, &accel_ch->stats);
 	spdk_spin_unlock(&g_stats_lock);
 
-	free(accel_ch->task_pool_base);
-	free(accel_ch->seq_pool_base);
-	free(accel_ch->buf_pool_base);
+	/* A module might still hold some of the channel's tasks, in which case the pools are freed
+	 * once it releases them */
+	accel_ch->pools->ch = NULL;
+	accel_channel_pools_put(accel_ch->pools);
 }
 
 struct spdk_io_channel *
@@ -2642,6 +3161,9 @@ accel_write_options(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "task_count", g_opts.task_count);
 	spdk_json_write_named_uint32(w, "sequence_count", g_opts.sequence_count);
 	spdk_json_write_named_uint32(w, "buf_count", g_opts.buf_count);
+	if (g_opts.sw_worker_cpumask != NULL) {
+		spdk_json_write_named_string(w, "sw_worker_cpumask", g_opts.sw_worker_cpumask);
+	}
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 }
@@ -2709,6 +3231,8 @@ spdk_accel_module_finish(void)
 			spdk_memory_domain_destroy(g_accel_domain);
 			g_accel_domain = NULL;
 		}
+		free((char *)g_opts.sw_worker_cpumask);
+		g_opts.sw_worker_cpumask = NULL;
 		accel_module_finish_cb();
 		return;
 	}
@@ -2799,11 +3323,27 @@ spdk_accel_driver_register(struct spdk_accel_driver *driver)
 int
 spdk_accel_set_opts(const struct spdk_accel_opts *opts)
 {
+	const char *sw_worker_cpumask = g_opts.sw_worker_cpumask;
+	char *cpumask = NULL;
+
 	if (opts->size > sizeof(*opts)) {
 		return -EINVAL;
 	}
 
+	if (opts->size > offsetof(struct spdk_accel_opts, sw_worker_cpumask) &&
+	    opts->sw_worker_cpumask != sw_worker_cpumask) {
+		if (opts->sw_worker_cpumask != NULL) {
+			cpumask = strdup(opts->sw_worker_cpumask);
+			if (cpumask == NULL) {
+				return -ENOMEM;
+			}
+		}
+		free((char *)sw_worker_cpumask);
+		sw_worker_cpumask = cpumask;
+	}
+
 	memcpy(&g_opts, opts, opts->size);
+	g_opts.sw_worker_cpumask = sw_worker_cpumask;
 
 	return 0;
 }
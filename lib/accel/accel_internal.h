@@ -39,6 +39,18 @@ void _accel_for_each_module(struct module_info *info, _accel_for_each_module_fn
 int _accel_get_opc_name(enum spdk_accel_opcode opcode, const char **opcode_name);
 void _accel_crypto_key_dump_param(struct spdk_json_write_ctx *w, struct spdk_accel_crypto_key *key);
 void _accel_crypto_keys_dump_param(struct spdk_json_write_ctx *w);
+/*
+ * The memory of the pools of an accel channel, which the tasks are allocated from.  A module
+ * holding tasks past the lifetime of their channel keeps a reference to it, so that the tasks
+ * remain valid.  The references must be taken and released on the channel's thread.
+ */
+struct accel_channel_pools;
+struct accel_channel_pools *accel_task_get_pools(struct spdk_accel_task *task);
+void accel_channel_pools_get(struct accel_channel_pools *pools);
+void accel_channel_pools_put(struct accel_channel_pools *pools);
+/* Returns true if the channel owning the pools was destroyed */
+bool accel_channel_pools_orphaned(struct accel_channel_pools *pools);
+
 typedef void (*accel_get_stats_cb)(struct accel_stats *stats, void *cb_arg);
 int accel_get_stats(accel_get_stats_cb cb_fn, void *cb_arg);
 
@@ -363,6 +363,7 @@ struct rpc_accel_opts {
 	uint32_t	task_count;
 	uint32_t	sequence_count;
 	uint32_t	buf_count;
+	char		*sw_worker_cpumask;
 };
 
 static const struct spdk_json_object_decoder rpc_accel_set_options_decoders[] = {
@@ -371,13 +372,14 @@ static const struct spdk_json_object_decoder rpc_accel_set_options_decoders[] =
 	{"task_count", offsetof(struct rpc_accel_opts, task_count), spdk_json_decode_uint32, true},
 	{"sequence_count", offsetof(struct rpc_accel_opts, sequence_count), spdk_json_decode_uint32, true},
 	{"buf_count", offsetof(struct rpc_accel_opts, buf_count), spdk_json_decode_uint32, true},
+	{"sw_worker_cpumask", offsetof(struct rpc_accel_opts, sw_worker_cpumask), spdk_json_decode_string, true},
 };
 
 static void
 rpc_accel_set_options(struct spdk_jsonrpc_request *request, const struct spdk_json_val *params)
 {
 	struct spdk_accel_opts opts = { .size = sizeof(opts) };
-	struct rpc_accel_opts rpc_opts;
+	struct rpc_accel_opts rpc_opts = {};
 	int rc;
 
 	/* We can't pass spdk_accel_opts directly to spdk_json_decode_object(), because that
@@ -393,7 +395,7 @@ rpc_accel_set_options(struct spdk_jsonrpc_request *request, const struct spdk_js
 				    SPDK_COUNTOF(rpc_accel_set_options_decoders), &rpc_opts)) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_PARSE_ERROR,
 						 "spdk_json_decode_object failed");
-		return;
+		goto cleanup;
 	}
 
 	opts.small_cache_size = rpc_opts.small_cache_size;
@@ -401,14 +403,19 @@ rpc_accel_set_options(struct spdk_jsonrpc_request *request, const struct spdk_js
 	opts.task_count = rpc_opts.task_count;
 	opts.sequence_count = rpc_opts.sequence_count;
 	opts.buf_count = rpc_opts.buf_count;
+	if (rpc_opts.sw_worker_cpumask != NULL) {
+		opts.sw_worker_cpumask = rpc_opts.sw_worker_cpumask;
+	}
 
 	rc = spdk_accel_set_opts(&opts);
 	if (rc != 0) {
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
-		return;
+		goto cleanup;
 	}
 
 	spdk_jsonrpc_send_bool_response(request, true);
+cleanup:
+	free(rpc_opts.sw_worker_cpumask);
 }
 SPDK_RPC_REGISTER("accel_set_options", rpc_accel_set_options, SPDK_RPC_STARTUP)
 
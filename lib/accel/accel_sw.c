@@ -9,14 +9,18 @@
 #include "spdk/accel_module.h"
 #include "accel_internal.h"
 
+#include "spdk/cpuset.h"
 #include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
+#include "spdk/string.h"
 #include "spdk/thread.h"
 #include "spdk/json.h"
 #include "spdk/crc32.h"
 #include "spdk/util.h"
 #include "spdk/xor.h"
+#include "spdk/gf.h"
+#include "spdk/dif.h"
 
 #ifdef SPDK_CONFIG_ISAL
 #include "../isa-l/include/igzip_lib.h"
@@ -28,6 +32,11 @@
 /* Per the AES-XTS spec, the size of data unit cannot be bigger than 2^20 blocks, 128b each block */
 #define ACCEL_AES_XTS_MAX_BLOCK_SIZE (1 << 24)
 
+/* Size of the rings used to pass tasks to the workers and back to the submitting channels */
+#define SW_ACCEL_RING_SIZE	4096
+/* Maximum number of tasks dequeued from a ring at once */
+#define SW_ACCEL_BATCH_SIZE	32
+
 struct sw_accel_io_channel {
 	/* for ISAL */
 #ifdef SPDK_CONFIG_ISAL
@@ -36,8 +45,45 @@ struct sw_accel_io_channel {
 #endif
 	struct spdk_poller		*completion_poller;
 	TAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
+	/* Tasks executed by the workers, only used if there are any workers */
+	struct spdk_ring		*completion_ring;
+	uint32_t			worker_idx;
+	/* Tasks passed to the workers, which didn't come back through completion_ring yet */
+	uint32_t			num_worker_tasks;
+	/* Pools of the accel channel the worker tasks come from, held while there are any */
+	struct accel_channel_pools	*pools;
+};
+
+struct sw_accel_task {
+	struct spdk_accel_task		task;
+	/* Completion ring of the channel the task was submitted on, used to send it back from
+	 * a worker.  The ring may outlive the channel, see sw_accel_destroy_cb(). */
+	struct spdk_ring		*completion_ring;
+};
+
+/* Completion ring of a destroyed channel and the accel pools its tasks were allocated from,
+ * released once the workers sent back all its tasks */
+struct sw_accel_ring_drain {
+	struct spdk_ring		*ring;
+	struct accel_channel_pools	*pools;
+	uint32_t			num_tasks;
+	struct spdk_poller		*poller;
+};
+
+struct sw_accel_worker {
+	struct spdk_thread		*thread;
+	struct spdk_poller		*poller;
+	struct spdk_ring		*ring;
+	/* Execution context of the worker, its tasks_to_complete list holds the tasks that
+	 * couldn't be sent back yet, because the completion ring of their channel was full */
+	struct sw_accel_io_channel	ch;
 };
 
+static struct sw_accel_worker *g_sw_workers;
+static uint32_t g_sw_num_workers;
+static uint32_t g_sw_num_running_workers;
+static struct spdk_thread *g_sw_fini_thread;
+
 typedef void (*sw_accel_crypto_op)(uint8_t *k2, uint8_t *k1, uint8_t *tweak, uint64_t lba_size,
 				   const uint8_t *src, uint8_t *dst);
 
@@ -77,6 +123,11 @@ sw_accel_supports_opcode(enum spdk_accel_opcode opc)
 	case SPDK_ACCEL_OPC_ENCRYPT:
 	case SPDK_ACCEL_OPC_DECRYPT:
 	case SPDK_ACCEL_OPC_XOR:
+	case SPDK_ACCEL_OPC_PQ_GEN:
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 		return true;
 	default:
 		return false;
@@ -158,6 +209,26 @@ _sw_accel_crc32cv(uint32_t *crc_dst, struct iovec *iov, uint32_t iovcnt, uint32_
 	*crc_dst = spdk_crc32c_iov_update(iov, iovcnt, ~seed);
 }
 
+static void
+_sw_accel_copy_crc32cv(uint32_t *crc_dst, struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		       struct iovec *src_iovs, uint32_t src_iovcnt, uint32_t seed)
+{
+	struct spdk_ioviter iter;
+	void *src, *dst;
+	size_t len;
+	uint32_t crc = ~seed;
+
+	/* Checksum the data while it is copied instead of reading it again */
+	for (len = spdk_ioviter_first(&iter, src_iovs, src_iovcnt,
+				      dst_iovs, dst_iovcnt, &src, &dst);
+	     len != 0;
+	     len = spdk_ioviter_next(&iter, &src, &dst)) {
+		crc = spdk_crc32c_copy(dst, src, len, crc);
+	}
+
+	*crc_dst = crc;
+}
+
 static int
 _sw_accel_compress(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
 {
@@ -441,64 +512,169 @@ _sw_accel_xor(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_t
 			    accel_task->d.iovs[0].iov_len);
 }
 
+static int
+_sw_accel_pq_gen(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	return spdk_gf_pq_gen(accel_task->d.iovs[0].iov_base,
+			      accel_task->d2.iovs[0].iov_base,
+			      accel_task->nsrcs.srcs,
+			      accel_task->nsrcs.cnt,
+			      accel_task->d.iovs[0].iov_len);
+}
+
+/* spdk_dif_verify*() return -1 if the DIF doesn't match and negated errno on invalid parameters */
+static inline int
+_sw_accel_dif_status(int rc)
+{
+	return rc == -1 ? -EIO : rc;
+}
+
+static int
+_sw_accel_dif_verify(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	return _sw_accel_dif_status(spdk_dif_verify(accel_task->s.iovs, accel_task->s.iovcnt,
+				    accel_task->num_blocks, accel_task->dif.ctx,
+				    accel_task->dif.err));
+}
+
+static int
+_sw_accel_dif_generate(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	return spdk_dif_generate(accel_task->s.iovs, accel_task->s.iovcnt,
+				 accel_task->num_blocks, accel_task->dif.ctx);
+}
+
+static int
+_sw_accel_dif_generate_copy(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	return spdk_dif_generate_copy(accel_task->s.iovs, accel_task->s.iovcnt,
+				      accel_task->d.iovs, accel_task->d.iovcnt,
+				      accel_task->num_blocks, accel_task->dif.ctx);
+}
+
+static int
+_sw_accel_dif_verify_copy(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	return _sw_accel_dif_status(spdk_dif_verify_copy(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt,
+				    accel_task->num_blocks, accel_task->dif.ctx,
+				    accel_task->dif.err));
+}
+
+static int
+sw_accel_execute_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	int rc = 0;
+
+	switch (accel_task->op_code) {
+	case SPDK_ACCEL_OPC_COPY:
+		_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_FILL:
+		rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->fill_pattern);
+		break;
+	case SPDK_ACCEL_OPC_DUALCAST:
+		rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+					     accel_task->d2.iovs, accel_task->d2.iovcnt,
+					     accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_COMPARE:
+		rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
+				       accel_task->s2.iovs, accel_task->s2.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_CRC32C:
+		_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COPY_CRC32C:
+		_sw_accel_copy_crc32cv(accel_task->crc_dst, accel_task->d.iovs, accel_task->d.iovcnt,
+				       accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COMPRESS:
+		rc = _sw_accel_compress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECOMPRESS:
+		rc = _sw_accel_decompress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_XOR:
+		rc = _sw_accel_xor(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_PQ_GEN:
+		rc = _sw_accel_pq_gen(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_ENCRYPT:
+		rc = _sw_accel_encrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECRYPT:
+		rc = _sw_accel_decrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		rc = _sw_accel_dif_verify(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		rc = _sw_accel_dif_generate(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		rc = _sw_accel_dif_generate_copy(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		rc = _sw_accel_dif_verify_copy(sw_ch, accel_task);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	return rc;
+}
+
+static int
+sw_accel_worker_submit(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_task *task = SPDK_CONTAINEROF(accel_task, struct sw_accel_task, task);
+	struct accel_channel_pools *pools = accel_task_get_pools(accel_task);
+	struct sw_accel_worker *worker;
+
+	/* The workers may only hold tasks of a single accel channel at a time, those of a
+	 * previous channel of this thread have to come back first */
+	if (spdk_unlikely(sw_ch->num_worker_tasks > 0 && sw_ch->pools != pools)) {
+		return -EBUSY;
+	}
+
+	task->completion_ring = sw_ch->completion_ring;
+	worker = &g_sw_workers[sw_ch->worker_idx];
+	sw_ch->worker_idx = (sw_ch->worker_idx + 1) % g_sw_num_workers;
+
+	if (spdk_unlikely(spdk_ring_enqueue(worker->ring, (void **)&accel_task, 1, NULL) != 1)) {
+		return -ENOMEM;
+	}
+
+	/* Keep the task's memory valid even if its channel gets destroyed in the meantime */
+	if (sw_ch->num_worker_tasks++ == 0) {
+		accel_channel_pools_get(pools);
+		sw_ch->pools = pools;
+	}
+
+	return 0;
+}
+
 static int
 sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task)
 {
 	struct sw_accel_io_channel *sw_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *tmp;
-	int rc = 0;
+	int rc;
 
 	do {
-		switch (accel_task->op_code) {
-		case SPDK_ACCEL_OPC_COPY:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_FILL:
-			rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->fill_pattern);
-			break;
-		case SPDK_ACCEL_OPC_DUALCAST:
-			rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-						     accel_task->d2.iovs, accel_task->d2.iovcnt,
-						     accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_COMPARE:
-			rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
-					       accel_task->s2.iovs, accel_task->s2.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_CRC32C:
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COPY_CRC32C:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs,
-					  accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COMPRESS:
-			rc = _sw_accel_compress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECOMPRESS:
-			rc = _sw_accel_decompress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_XOR:
-			rc = _sw_accel_xor(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_ENCRYPT:
-			rc = _sw_accel_encrypt(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECRYPT:
-			rc = _sw_accel_decrypt(sw_ch, accel_task);
-			break;
-		default:
-			assert(false);
-			break;
-		}
-
+		/* Once the task is passed to a worker, it can't be touched anymore */
 		tmp = TAILQ_NEXT(accel_task, link);
 
-		_add_to_comp_list(sw_ch, accel_task, rc);
+		/* Execute the task right away if the workers are overloaded */
+		if (g_sw_num_workers == 0 || sw_accel_worker_submit(sw_ch, accel_task) != 0) {
+			rc = sw_accel_execute_task(sw_ch, accel_task);
+			_add_to_comp_list(sw_ch, accel_task, rc);
+		}
 
 		accel_task = tmp;
 	} while (accel_task);
@@ -506,15 +682,67 @@ sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_
 	return 0;
 }
 
+static bool
+sw_accel_worker_complete_task(struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_task *task = SPDK_CONTAINEROF(accel_task, struct sw_accel_task, task);
+
+	return spdk_ring_enqueue(task->completion_ring, (void **)&accel_task, 1, NULL) == 1;
+}
+
+static int
+sw_accel_worker_poll(void *arg)
+{
+	struct sw_accel_worker *worker = arg;
+	struct spdk_accel_task *tasks[SW_ACCEL_BATCH_SIZE], *accel_task, *tmp;
+	size_t i, count;
+	int busy = SPDK_POLLER_IDLE;
+
+	TAILQ_FOREACH_SAFE(accel_task, &worker->ch.tasks_to_complete, link, tmp) {
+		if (sw_accel_worker_complete_task(accel_task)) {
+			TAILQ_REMOVE(&worker->ch.tasks_to_complete, accel_task, link);
+			busy = SPDK_POLLER_BUSY;
+		}
+	}
+
+	count = spdk_ring_dequeue(worker->ring, (void **)tasks, SPDK_COUNTOF(tasks));
+	for (i = 0; i < count; i++) {
+		accel_task = tasks[i];
+		accel_task->status = sw_accel_execute_task(&worker->ch, accel_task);
+		if (spdk_unlikely(!sw_accel_worker_complete_task(accel_task))) {
+			TAILQ_INSERT_TAIL(&worker->ch.tasks_to_complete, accel_task, link);
+		}
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : busy;
+}
+
 static int
 accel_comp_poll(void *arg)
 {
 	struct sw_accel_io_channel	*sw_ch = arg;
 	TAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
-	struct spdk_accel_task		*accel_task;
+	struct spdk_accel_task		*accel_task, *tasks[SW_ACCEL_BATCH_SIZE];
+	size_t				i, count = 0;
+
+	if (sw_ch->completion_ring != NULL) {
+		count = spdk_ring_dequeue(sw_ch->completion_ring, (void **)tasks, SPDK_COUNTOF(tasks));
+		/* Tasks of a destroyed accel channel have no one to be completed to */
+		if (spdk_likely(count == 0 || !accel_channel_pools_orphaned(sw_ch->pools))) {
+			for (i = 0; i < count; i++) {
+				spdk_accel_task_complete(tasks[i], tasks[i]->status);
+			}
+		}
+
+		sw_ch->num_worker_tasks -= count;
+		if (count > 0 && sw_ch->num_worker_tasks == 0) {
+			accel_channel_pools_put(sw_ch->pools);
+			sw_ch->pools = NULL;
+		}
+	}
 
 	if (TAILQ_EMPTY(&sw_ch->tasks_to_complete)) {
-		return SPDK_POLLER_IDLE;
+		return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 	}
 
 	TAILQ_INIT(&tasks_to_complete);
@@ -529,12 +757,9 @@ accel_comp_poll(void *arg)
 }
 
 static int
-sw_accel_create_cb(void *io_device, void *ctx_buf)
+sw_accel_exec_ctx_init(struct sw_accel_io_channel *sw_ch)
 {
-	struct sw_accel_io_channel *sw_ch = ctx_buf;
-
 	TAILQ_INIT(&sw_ch->tasks_to_complete);
-	sw_ch->completion_poller = SPDK_POLLER_REGISTER(accel_comp_poll, sw_ch, 0);
 
 #ifdef SPDK_CONFIG_ISAL
 	isal_deflate_init(&sw_ch->stream);
@@ -553,15 +778,95 @@ sw_accel_create_cb(void *io_device, void *ctx_buf)
 }
 
 static void
-sw_accel_destroy_cb(void *io_device, void *ctx_buf)
+sw_accel_exec_ctx_fini(struct sw_accel_io_channel *sw_ch)
 {
-	struct sw_accel_io_channel *sw_ch = ctx_buf;
-
 #ifdef SPDK_CONFIG_ISAL
 	free(sw_ch->stream.level_buf);
 #endif
+}
+
+static int
+sw_accel_create_cb(void *io_device, void *ctx_buf)
+{
+	struct sw_accel_io_channel *sw_ch = ctx_buf;
+	int rc;
+
+	rc = sw_accel_exec_ctx_init(sw_ch);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (g_sw_num_workers > 0) {
+		sw_ch->completion_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SW_ACCEL_RING_SIZE,
+				SPDK_ENV_SOCKET_ID_ANY);
+		if (sw_ch->completion_ring == NULL) {
+			SPDK_ERRLOG("Could not allocate completion ring\n");
+			sw_accel_exec_ctx_fini(sw_ch);
+			return -ENOMEM;
+		}
+		/* Spread the channels across the workers */
+		sw_ch->worker_idx = spdk_env_get_current_core() % g_sw_num_workers;
+	}
+
+	sw_ch->completion_poller = SPDK_POLLER_REGISTER(accel_comp_poll, sw_ch, 0);
+
+	return 0;
+}
+
+static int
+sw_accel_ring_drain_poll(void *arg)
+{
+	struct sw_accel_ring_drain *drain = arg;
+	struct spdk_accel_task *tasks[SW_ACCEL_BATCH_SIZE];
+	size_t count;
+
+	/* The tasks were submitted on the destroyed channel, so there's no one to complete them */
+	count = spdk_ring_dequeue(drain->ring, (void **)tasks, SPDK_COUNTOF(tasks));
+	drain->num_tasks -= count;
+	if (drain->num_tasks > 0) {
+		return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+	}
 
+	spdk_poller_unregister(&drain->poller);
+	spdk_ring_free(drain->ring);
+	accel_channel_pools_put(drain->pools);
+	free(drain);
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+sw_accel_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct sw_accel_io_channel *sw_ch = ctx_buf;
+	struct sw_accel_ring_drain *drain;
+
+	sw_accel_exec_ctx_fini(sw_ch);
 	spdk_poller_unregister(&sw_ch->completion_poller);
+
+	if (sw_ch->num_worker_tasks == 0) {
+		spdk_ring_free(sw_ch->completion_ring);
+		return;
+	}
+
+	/* The workers still hold tasks submitted on this channel and will send them back through
+	 * the completion ring, so neither the ring nor the tasks' memory can be freed before
+	 * they're all done. */
+	SPDK_WARNLOG("Channel destroyed with %" PRIu32 " outstanding tasks\n", sw_ch->num_worker_tasks);
+	drain = calloc(1, sizeof(*drain));
+	if (drain == NULL) {
+		SPDK_ERRLOG("Could not allocate memory, leaking the outstanding tasks\n");
+		return;
+	}
+
+	drain->ring = sw_ch->completion_ring;
+	drain->pools = sw_ch->pools;
+	drain->num_tasks = sw_ch->num_worker_tasks;
+	drain->poller = SPDK_POLLER_REGISTER(sw_accel_ring_drain_poll, drain, 0);
+	if (drain->poller == NULL) {
+		SPDK_ERRLOG("Could not register poller, leaking the outstanding tasks\n");
+		free(drain);
+	}
 }
 
 static struct spdk_io_channel *
@@ -573,23 +878,191 @@ sw_accel_get_io_channel(void)
 static size_t
 sw_accel_module_get_ctx_size(void)
 {
-	return sizeof(struct spdk_accel_task);
+	return sizeof(struct sw_accel_task);
+}
+
+static void
+sw_accel_worker_start(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	worker->poller = SPDK_POLLER_REGISTER(sw_accel_worker_poll, worker, 0);
+}
+
+static void
+sw_accel_workers_free(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_sw_num_workers; i++) {
+		sw_accel_exec_ctx_fini(&g_sw_workers[i].ch);
+		spdk_ring_free(g_sw_workers[i].ring);
+	}
+
+	free(g_sw_workers);
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+}
+
+static int
+sw_accel_worker_create(struct sw_accel_worker *worker, uint32_t core)
+{
+	struct spdk_cpuset cpumask;
+	char name[32];
+	int rc;
+
+	rc = sw_accel_exec_ctx_init(&worker->ch);
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* Only the submitting channels enqueue tasks to a worker's ring */
+	worker->ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SW_ACCEL_RING_SIZE,
+					SPDK_ENV_SOCKET_ID_ANY);
+	if (worker->ring == NULL) {
+		sw_accel_exec_ctx_fini(&worker->ch);
+		return -ENOMEM;
+	}
+
+	spdk_cpuset_zero(&cpumask);
+	spdk_cpuset_set_cpu(&cpumask, core, true);
+	snprintf(name, sizeof(name), "accel_sw_worker_%u", core);
+
+	worker->thread = spdk_thread_create(name, &cpumask);
+	if (worker->thread == NULL) {
+		spdk_ring_free(worker->ring);
+		sw_accel_exec_ctx_fini(&worker->ch);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static int
+sw_accel_workers_create(const char *mask)
+{
+	struct spdk_cpuset cpumask, app_cpumask, tmp_cpumask;
+	uint32_t i, core;
+	int rc;
+
+	rc = spdk_cpuset_parse(&cpumask, mask);
+	if (rc != 0 || spdk_cpuset_count(&cpumask) == 0) {
+		SPDK_ERRLOG("Invalid software module worker cpumask: %s\n", mask);
+		return -EINVAL;
+	}
+
+	/* The workers are SPDK threads, so they can only run on the application's cores.  A core
+	 * outside of its mask would make them land on an arbitrary reactor. */
+	spdk_cpuset_zero(&app_cpumask);
+	SPDK_ENV_FOREACH_CORE(core) {
+		spdk_cpuset_set_cpu(&app_cpumask, core, true);
+	}
+	spdk_cpuset_copy(&tmp_cpumask, &cpumask);
+	spdk_cpuset_and(&tmp_cpumask, &app_cpumask);
+	if (!spdk_cpuset_equal(&tmp_cpumask, &cpumask)) {
+		SPDK_ERRLOG("Software module worker cpumask %s is not a subset of the application's "
+			    "cpumask %s\n", mask, spdk_cpuset_fmt(&app_cpumask));
+		return -EINVAL;
+	}
+
+	g_sw_workers = calloc(spdk_cpuset_count(&cpumask), sizeof(*g_sw_workers));
+	if (g_sw_workers == NULL) {
+		return -ENOMEM;
+	}
+
+	for (core = 0; core < SPDK_CPUSET_SIZE; core++) {
+		if (!spdk_cpuset_get_cpu(&cpumask, core)) {
+			continue;
+		}
+
+		rc = sw_accel_worker_create(&g_sw_workers[g_sw_num_workers], core);
+		if (rc != 0) {
+			/* Keep going with the workers that were already created */
+			SPDK_ERRLOG("Could not create software module worker on core %u: %s\n",
+				    core, spdk_strerror(-rc));
+			break;
+		}
+
+		g_sw_num_workers++;
+	}
+
+	if (g_sw_num_workers == 0) {
+		free(g_sw_workers);
+		g_sw_workers = NULL;
+		return rc;
+	}
+
+	for (i = 0; i < g_sw_num_workers; i++) {
+		spdk_thread_send_msg(g_sw_workers[i].thread, sw_accel_worker_start, &g_sw_workers[i]);
+	}
+
+	g_sw_num_running_workers = g_sw_num_workers;
+	SPDK_NOTICELOG("Started %u software module workers, cpumask: %s\n", g_sw_num_workers, mask);
+
+	return 0;
 }
 
 static int
 sw_accel_module_init(void)
 {
+	struct spdk_accel_opts opts = { .size = sizeof(opts) };
+	int rc;
+
+	spdk_accel_get_opts(&opts);
+	if (opts.sw_worker_cpumask != NULL) {
+		rc = sw_accel_workers_create(opts.sw_worker_cpumask);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
 	spdk_io_device_register(&g_sw_module, sw_accel_create_cb, sw_accel_destroy_cb,
 				sizeof(struct sw_accel_io_channel), "sw_accel_module");
 
 	return 0;
 }
 
+static void
+sw_accel_worker_stopped(void *ctx)
+{
+	assert(g_sw_num_running_workers > 0);
+	if (--g_sw_num_running_workers > 0) {
+		return;
+	}
+
+	sw_accel_workers_free();
+	spdk_accel_module_finish();
+}
+
+static void
+sw_accel_worker_stop(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	/* All channels are gone by now, so there can't be any outstanding tasks */
+	assert(TAILQ_EMPTY(&worker->ch.tasks_to_complete));
+	spdk_poller_unregister(&worker->poller);
+	spdk_thread_exit(worker->thread);
+	spdk_thread_send_msg(g_sw_fini_thread, sw_accel_worker_stopped, NULL);
+}
+
 static void
 sw_accel_module_fini(void *ctxt)
 {
+	uint32_t i;
+
 	spdk_io_device_unregister(&g_sw_module, NULL);
-	spdk_accel_module_finish();
+
+	if (g_sw_num_running_workers == 0) {
+		sw_accel_workers_free();
+		spdk_accel_module_finish();
+		return;
+	}
+
+	g_sw_fini_thread = spdk_get_thread();
+	for (i = 0; i < g_sw_num_workers; i++) {
+		spdk_thread_send_msg(g_sw_workers[i].thread, sw_accel_worker_stop, &g_sw_workers[i]);
+	}
 }
 
 static int
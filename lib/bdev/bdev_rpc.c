@@ -13,6 +13,7 @@
 #include "spdk/base64.h"
 #include "spdk/bdev_module.h"
 #include "spdk/dma.h"
+#include "spdk/thread.h"
 
 #include "spdk/log.h"
 
@@ -775,6 +776,9 @@ rpc_dump_bdev_info(void *ctx, struct spdk_bdev *bdev)
 struct rpc_bdev_get_bdevs {
 	char		*name;
 	uint64_t	timeout;
+	char		*product_name;
+	uint32_t	offset;
+	uint32_t	limit;
 };
 
 struct rpc_bdev_get_bdevs_ctx {
@@ -784,17 +788,118 @@ struct rpc_bdev_get_bdevs_ctx {
 	uint64_t			timeout_ticks;
 };
 
+/* Number of bdevs dumped before the response is flushed and other work is let in */
+#define RPC_BDEV_GET_BDEVS_BATCH	64
+
+struct rpc_bdev_get_bdevs_list_ctx {
+	struct rpc_bdev_get_bdevs	rpc;
+	struct spdk_jsonrpc_request	*request;
+	struct spdk_json_write_ctx	*w;
+	char				**names;
+	uint32_t			num_names;
+	uint32_t			max_names;
+	uint32_t			skipped;
+	uint32_t			current;
+};
+
 static void
 free_rpc_bdev_get_bdevs(struct rpc_bdev_get_bdevs *r)
 {
 	free(r->name);
+	free(r->product_name);
 }
 
 static const struct spdk_json_object_decoder rpc_bdev_get_bdevs_decoders[] = {
 	{"name", offsetof(struct rpc_bdev_get_bdevs, name), spdk_json_decode_string, true},
 	{"timeout", offsetof(struct rpc_bdev_get_bdevs, timeout), spdk_json_decode_uint64, true},
+	{"product_name", offsetof(struct rpc_bdev_get_bdevs, product_name), spdk_json_decode_string, true},
+	{"offset", offsetof(struct rpc_bdev_get_bdevs, offset), spdk_json_decode_uint32, true},
+	{"limit", offsetof(struct rpc_bdev_get_bdevs, limit), spdk_json_decode_uint32, true},
 };
 
+static void
+free_rpc_bdev_get_bdevs_list_ctx(struct rpc_bdev_get_bdevs_list_ctx *ctx)
+{
+	uint32_t i;
+
+	for (i = 0; i < ctx->num_names; i++) {
+		free(ctx->names[i]);
+	}
+	free(ctx->names);
+	free_rpc_bdev_get_bdevs(&ctx->rpc);
+	free(ctx);
+}
+
+static int
+rpc_bdev_get_bdevs_add_name(void *_ctx, struct spdk_bdev *bdev)
+{
+	struct rpc_bdev_get_bdevs_list_ctx *ctx = _ctx;
+	char **names;
+
+	if (ctx->rpc.product_name != NULL &&
+	    strcmp(ctx->rpc.product_name, spdk_bdev_get_product_name(bdev)) != 0) {
+		return 0;
+	}
+
+	if (ctx->skipped < ctx->rpc.offset) {
+		ctx->skipped++;
+		return 0;
+	}
+
+	if (ctx->rpc.limit != 0 && ctx->num_names == ctx->rpc.limit) {
+		return 0;
+	}
+
+	if (ctx->num_names == ctx->max_names) {
+		names = realloc(ctx->names, (ctx->max_names + RPC_BDEV_GET_BDEVS_BATCH) * sizeof(*names));
+		if (names == NULL) {
+			return -ENOMEM;
+		}
+		ctx->names = names;
+		ctx->max_names += RPC_BDEV_GET_BDEVS_BATCH;
+	}
+
+	ctx->names[ctx->num_names] = strdup(spdk_bdev_get_name(bdev));
+	if (ctx->names[ctx->num_names] == NULL) {
+		return -ENOMEM;
+	}
+	ctx->num_names++;
+
+	return 0;
+}
+
+static void
+rpc_bdev_get_bdevs_list(void *_ctx)
+{
+	struct rpc_bdev_get_bdevs_list_ctx *ctx = _ctx;
+	struct spdk_bdev_desc *desc;
+	uint32_t end;
+	int rc;
+
+	end = spdk_min(ctx->current + RPC_BDEV_GET_BDEVS_BATCH, ctx->num_names);
+	for (; ctx->current < end; ctx->current++) {
+		/* Bdevs removed since the list was taken are skipped */
+		rc = spdk_bdev_open_ext(ctx->names[ctx->current], false, dummy_bdev_event_cb, NULL, &desc);
+		if (rc != 0) {
+			continue;
+		}
+
+		rpc_dump_bdev_info(ctx->w, spdk_bdev_desc_get_bdev(desc));
+		spdk_bdev_close(desc);
+	}
+
+	if (ctx->current < ctx->num_names) {
+		/* Send what's been written so far and let other pollers and RPCs run */
+		spdk_jsonrpc_flush_result(ctx->request, ctx->w);
+		spdk_thread_send_msg(spdk_get_thread(), rpc_bdev_get_bdevs_list, ctx);
+		return;
+	}
+
+	spdk_json_write_array_end(ctx->w);
+	spdk_jsonrpc_end_result(ctx->request, ctx->w);
+	free_rpc_bdev_get_bdevs_list_ctx(ctx);
+}
+
 static void
 rpc_bdev_get_bdev_cb(struct spdk_bdev_desc *desc, int rc, void *cb_arg)
 {
@@ -820,8 +925,8 @@ rpc_bdev_get_bdevs(struct spdk_jsonrpc_request *request,
 		   const struct spdk_json_val *params)
 {
 	struct rpc_bdev_get_bdevs req = {};
+	struct rpc_bdev_get_bdevs_list_ctx *ctx;
 	struct spdk_bdev_open_async_opts opts = {};
-	struct spdk_json_write_ctx *w;
 	int rc;
 
 	if (params && spdk_json_decode_object(params, rpc_bdev_get_bdevs_decoders,
@@ -834,6 +939,14 @@ rpc_bdev_get_bdevs(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
+	if (req.name && (req.product_name || req.offset != 0 || req.limit != 0)) {
+		/* Filtering and paging only apply to the list of all bdevs */
+		spdk_jsonrpc_send_error_response(request, -EINVAL,
+						 "name can't be used with product_name, offset or limit");
+		free_rpc_bdev_get_bdevs(&req);
+		return;
+	}
+
 	if (req.name) {
 		opts.size = sizeof(opts);
 		opts.timeout_ms = req.timeout;
@@ -849,16 +962,28 @@ rpc_bdev_get_bdevs(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	free_rpc_bdev_get_bdevs(&req);
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		free_rpc_bdev_get_bdevs(&req);
+		return;
+	}
 
-	w = spdk_jsonrpc_begin_result(request);
-	spdk_json_write_array_begin(w);
+	ctx->rpc = req;
+	ctx->request = request;
 
-	spdk_for_each_bdev(w, rpc_dump_bdev_info);
+	/* Take the list of bdevs up front, the response is written in batches */
+	rc = spdk_for_each_bdev(ctx, rpc_bdev_get_bdevs_add_name);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		free_rpc_bdev_get_bdevs_list_ctx(ctx);
+		return;
+	}
 
-	spdk_json_write_array_end(w);
+	ctx->w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(ctx->w);
 
-	spdk_jsonrpc_end_result(request, w);
+	rpc_bdev_get_bdevs_list(ctx);
 }
 SPDK_RPC_REGISTER("bdev_get_bdevs", rpc_bdev_get_bdevs, SPDK_RPC_RUNTIME)
 
@@ -76,9 +76,19 @@ static struct vfio_cfg g_vfio = {
  */
 #define REG_MAP_NOTIFY_START	(1ULL << 63)
 
+/* Maximum length of a run of contiguous 2MB pages recorded in the map, matching a 1GB hugepage.
+ * It bounds the number of entries updated when a translation changes, longer regions are
+ * described by consecutive runs.
+ */
+#define MAP_RUN_MAX_2MB		(1ULL << (SHIFT_1GB - SHIFT_2MB))
+
 /* Translation of a single 2MB page. */
 struct map_2mb {
 	uint64_t translation_2mb;
+	/* Number of pages, starting with this one, whose translations are contiguous according
+	 * to the map's are_contiguous callback (1 if there's no callback).
+	 */
+	uint64_t run_2mb;
 };
 
 /* Second-level map table indexed by bits [21..29] of the virtual address.
@@ -554,6 +564,7 @@ mem_map_get_map_1gb(struct spdk_mem_map *map, uint64_t vfn_2mb)
 				/* initialize all entries to default translation */
 				for (i = 0; i < SPDK_COUNTOF(map_1gb->map); i++) {
 					map_1gb->map[i].translation_2mb = map->default_translation;
+					map_1gb->map[i].run_2mb = 1;
 				}
 				map->map_256tb.map[idx_256tb] = map_1gb;
 			}
@@ -570,14 +581,81 @@ mem_map_get_map_1gb(struct spdk_mem_map *map, uint64_t vfn_2mb)
 	return map_1gb;
 }
 
+/* Get the entry of a 2MB page without allocating the second-level table */
+static inline struct map_2mb *
+mem_map_get_map_2mb(const struct spdk_mem_map *map, uint64_t vfn_2mb)
+{
+	struct map_1gb *map_1gb;
+	uint64_t idx_256tb = MAP_256TB_IDX(vfn_2mb);
+
+	if (spdk_unlikely(idx_256tb >= SPDK_COUNTOF(map->map_256tb.map))) {
+		return NULL;
+	}
+
+	map_1gb = map->map_256tb.map[idx_256tb];
+	if (spdk_unlikely(!map_1gb)) {
+		return NULL;
+	}
+
+	return &map_1gb->map[MAP_1GB_IDX(vfn_2mb)];
+}
+
+static uint64_t
+mem_map_calc_run(const struct spdk_mem_map *map, const struct map_2mb *map_2mb, uint64_t vfn_2mb)
+{
+	const struct map_2mb *next;
+
+	next = mem_map_get_map_2mb(map, vfn_2mb + 1);
+	if (next == NULL || next->translation_2mb == map->default_translation ||
+	    !map->ops.are_contiguous(map_2mb->translation_2mb, next->translation_2mb)) {
+		return 1;
+	}
+
+	return spdk_min(next->run_2mb + 1, MAP_RUN_MAX_2MB);
+}
+
+/* Recalculate the runs of the pages in [vfn_2mb, vfn_2mb_end) along with the runs of the pages
+ * in front of them that could have reached into that range.
+ */
+static void
+mem_map_update_runs(struct spdk_mem_map *map, uint64_t vfn_2mb, uint64_t vfn_2mb_end)
+{
+	struct map_2mb *map_2mb;
+	uint64_t vfn, run;
+
+	if (map->ops.are_contiguous == NULL) {
+		return;
+	}
+
+	for (vfn = vfn_2mb_end; vfn > vfn_2mb; vfn--) {
+		map_2mb = mem_map_get_map_2mb(map, vfn - 1);
+		assert(map_2mb != NULL);
+		map_2mb->run_2mb = mem_map_calc_run(map, map_2mb, vfn - 1);
+	}
+
+	for (vfn = vfn_2mb; vfn > 0; vfn--) {
+		map_2mb = mem_map_get_map_2mb(map, vfn - 1);
+		if (map_2mb == NULL) {
+			break;
+		}
+
+		run = mem_map_calc_run(map, map_2mb, vfn - 1);
+		if (run == map_2mb->run_2mb) {
+			break;
+		}
+		map_2mb->run_2mb = run;
+	}
+}
+
 int
 spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t size,
 			     uint64_t translation)
 {
-	uint64_t vfn_2mb;
+	uint64_t vfn_2mb, vfn_2mb_start;
 	struct map_1gb *map_1gb;
 	uint64_t idx_1gb;
 	struct map_2mb *map_2mb;
+	int rc = 0;
 
 	if ((uintptr_t)vaddr & ~MASK_256TB) {
 		DEBUG_PRINT("invalid usermode virtual address %" PRIu64 "\n", vaddr);
@@ -592,12 +670,14 @@ spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 	}
 
 	vfn_2mb = vaddr >> SHIFT_2MB;
+	vfn_2mb_start = vfn_2mb;
 
 	while (size) {
 		map_1gb = mem_map_get_map_1gb(map, vfn_2mb);
 		if (!map_1gb) {
 			DEBUG_PRINT("could not get %p map\n", (void *)vaddr);
-			return -ENOMEM;
+			rc = -ENOMEM;
+			break;
 		}
 
 		idx_1gb = MAP_1GB_IDX(vfn_2mb);
@@ -608,7 +688,9 @@ spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		vfn_2mb++;
 	}
 
-	return 0;
+	mem_map_update_runs(map, vfn_2mb_start, vfn_2mb);
+
+	return rc;
 }
 
 int
@@ -620,14 +702,12 @@ spdk_mem_map_clear_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_
 inline uint64_t
 spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t *size)
 {
-	const struct map_1gb *map_1gb;
 	const struct map_2mb *map_2mb;
-	uint64_t idx_256tb;
-	uint64_t idx_1gb;
+	const struct map_2mb *next;
 	uint64_t vfn_2mb;
 	uint64_t cur_size;
-	uint64_t prev_translation;
 	uint64_t orig_translation;
+	uint64_t run_2mb;
 
 	if (spdk_unlikely(vaddr & ~MASK_256TB)) {
 		DEBUG_PRINT("invalid usermode virtual address %p\n", (void *)vaddr);
@@ -635,43 +715,40 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 	}
 
 	vfn_2mb = vaddr >> SHIFT_2MB;
-	idx_256tb = MAP_256TB_IDX(vfn_2mb);
-	idx_1gb = MAP_1GB_IDX(vfn_2mb);
 
-	map_1gb = map->map_256tb.map[idx_256tb];
-	if (spdk_unlikely(!map_1gb)) {
+	map_2mb = mem_map_get_map_2mb(map, vfn_2mb);
+	if (spdk_unlikely(!map_2mb)) {
 		return map->default_translation;
 	}
 
+	orig_translation = map_2mb->translation_2mb;
+	run_2mb = map_2mb->run_2mb;
+
 	cur_size = VALUE_2MB - _2MB_OFFSET(vaddr);
-	map_2mb = &map_1gb->map[idx_1gb];
-	if (size == NULL || map->ops.are_contiguous == NULL ||
-	    map_2mb->translation_2mb == map->default_translation) {
+	if (size == NULL || *size <= cur_size || map->ops.are_contiguous == NULL ||
+	    orig_translation == map->default_translation) {
 		if (size != NULL) {
 			*size = spdk_min(*size, cur_size);
 		}
-		return map_2mb->translation_2mb;
+		return orig_translation;
 	}
 
-	orig_translation = map_2mb->translation_2mb;
-	prev_translation = orig_translation;
+	/* The whole run is contiguous, only regions longer than MAP_RUN_MAX_2MB need to check
+	 * whether the following runs are contiguous with it.
+	 */
+	cur_size += (run_2mb - 1) * VALUE_2MB;
 	while (cur_size < *size) {
-		vfn_2mb++;
-		idx_256tb = MAP_256TB_IDX(vfn_2mb);
-		idx_1gb = MAP_1GB_IDX(vfn_2mb);
-
-		map_1gb = map->map_256tb.map[idx_256tb];
-		if (spdk_unlikely(!map_1gb)) {
-			break;
-		}
-
-		map_2mb = &map_1gb->map[idx_1gb];
-		if (!map->ops.are_contiguous(prev_translation, map_2mb->translation_2mb)) {
+		map_2mb = mem_map_get_map_2mb(map, vfn_2mb + run_2mb - 1);
+		next = mem_map_get_map_2mb(map, vfn_2mb + run_2mb);
+		if (map_2mb == NULL || next == NULL ||
+		    next->translation_2mb == map->default_translation ||
+		    !map->ops.are_contiguous(map_2mb->translation_2mb, next->translation_2mb)) {
 			break;
 		}
 
-		cur_size += VALUE_2MB;
-		prev_translation = map_2mb->translation_2mb;
+		vfn_2mb += run_2mb;
+		run_2mb = next->run_2mb;
+		cur_size += run_2mb * VALUE_2MB;
 	}
 
 	*size = spdk_min(*size, cur_size);
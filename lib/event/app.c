@@ -44,6 +44,7 @@
 struct spdk_app {
 	const char			*json_config_file;
 	bool				json_config_ignore_errors;
+	uint32_t			json_config_max_concurrent_rpcs;
 	bool				stopped;
 	const char			*rpc_addr;
 	const char			**rpc_allowlist;
@@ -141,6 +142,8 @@ static const struct option g_cmdline_options[] = {
 	{"msg-mempool-size",		required_argument,	NULL, MSG_MEMPOOL_SIZE_OPT_IDX},
 #define LCORES_OPT_IDX	271
 	{"lcores",			required_argument,	NULL, LCORES_OPT_IDX},
+#define JSON_MAX_CONCURRENT_RPCS_OPT_IDX	272
+	{"json-max-concurrent-rpcs",	required_argument,	NULL, JSON_MAX_CONCURRENT_RPCS_OPT_IDX},
 };
 
 static void
@@ -242,6 +245,7 @@ spdk_app_opts_init(struct spdk_app_opts *opts, size_t opts_size)
 	SET_FIELD(rpc_allowlist, NULL);
 	SET_FIELD(rpc_log_file, NULL);
 	SET_FIELD(rpc_log_level, SPDK_LOG_DISABLED);
+	SET_FIELD(json_config_max_concurrent_rpcs, 1);
 #undef SET_FIELD
 }
 
@@ -501,6 +505,7 @@ bootstrap_fn(void *arg1)
 
 	if (g_spdk_app.json_config_file) {
 		g_delay_subsystem_init = false;
+		spdk_subsystem_set_json_config_max_concurrent_rpcs(g_spdk_app.json_config_max_concurrent_rpcs);
 		spdk_subsystem_init_from_json_config(g_spdk_app.json_config_file, g_spdk_app.rpc_addr,
 						     app_start_rpc,
 						     NULL, !g_spdk_app.json_config_ignore_errors);
@@ -567,10 +572,11 @@ app_copy_opts(struct spdk_app_opts *opts, struct spdk_app_opts *opts_user, size_
 	SET_FIELD(vf_token);
 	SET_FIELD(rpc_log_file);
 	SET_FIELD(rpc_log_level);
+	SET_FIELD(json_config_max_concurrent_rpcs);
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 236, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_app_opts) == 240, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -745,6 +751,7 @@ spdk_app_start(struct spdk_app_opts *opts_user, spdk_msg_fn start_fn,
 	memset(&g_spdk_app, 0, sizeof(g_spdk_app));
 	g_spdk_app.json_config_file = opts->json_config_file;
 	g_spdk_app.json_config_ignore_errors = opts->json_config_ignore_errors;
+	g_spdk_app.json_config_max_concurrent_rpcs = opts->json_config_max_concurrent_rpcs;
 	g_spdk_app.rpc_addr = opts->rpc_addr;
 	g_spdk_app.rpc_allowlist = opts->rpc_allowlist;
 	g_spdk_app.rpc_log_file = opts->rpc_log_file;
@@ -916,6 +923,8 @@ usage(void (*app_usage)(void))
 	       g_default_opts.json_config_file != NULL ? g_default_opts.json_config_file : "none");
 	printf("     --json-ignore-init-errors\n");
 	printf("                           don't exit on invalid config entry\n");
+	printf("     --json-max-concurrent-rpcs <num>\n");
+	printf("                           max number of independent config entries loaded concurrently (1-32, default 1)\n");
 	printf(" -d, --limit-coredump      do not set max coredump size to RLIM_INFINITY\n");
 	printf(" -g, --single-file-segments\n");
 	printf("                           force creating just one hugetlbfs file\n");
@@ -1036,6 +1045,15 @@ spdk_app_parse_args(int argc, char **argv, struct spdk_app_opts *opts,
 		case JSON_CONFIG_IGNORE_INIT_ERRORS_IDX:
 			opts->json_config_ignore_errors = true;
 			break;
+		case JSON_MAX_CONCURRENT_RPCS_OPT_IDX:
+			tmp = spdk_strtol(optarg, 10);
+			if (tmp <= 0 || tmp > 32) {
+				SPDK_ERRLOG("Invalid number of concurrent JSON config entries %s\n", optarg);
+				goto out;
+			}
+
+			opts->json_config_max_concurrent_rpcs = (uint32_t)tmp;
+			break;
 		case LIMIT_COREDUMP_OPT_IDX:
 			opts->enable_coredump = false;
 			break;
@@ -1150,6 +1150,245 @@ error:
 	return rc;
 }
 
+bool
+spdk_idxd_dif_ctx_is_supported(const struct spdk_dif_ctx *ctx)
+{
+	uint32_t data_block_size = ctx->block_size - ctx->md_size;
+
+	return ctx->md_interleave && ctx->md_size == 8 &&
+	       ctx->dif_pi_format == SPDK_DIF_PI_FORMAT_16 &&
+	       ctx->dif_type != SPDK_DIF_DISABLE &&
+	       ctx->guard_interval == data_block_size &&
+	       ctx->guard_seed == 0 &&
+	       (data_block_size == 512 || data_block_size == 4096);
+}
+
+static uint8_t
+idxd_dif_flags(const struct spdk_dif_ctx *ctx)
+{
+	return ctx->block_size == 520 ? IDXD_DIF_FLAG_DIF_BLOCK_SIZE_520 :
+	       IDXD_DIF_FLAG_DIF_BLOCK_SIZE_4104;
+}
+
+static uint8_t
+idxd_dif_source_flags(const struct spdk_dif_ctx *ctx)
+{
+	uint8_t flags = 0;
+
+	/* Checks are disabled if the application tag, and the reference tag for type 3, is all
+	 * ones, as spdk_dif_verify() does */
+	if (ctx->dif_type == SPDK_DIF_TYPE3) {
+		flags |= IDXD_DIF_SOURCE_FLAG_REF_TAG_TYPE | IDXD_DIF_SOURCE_FLAG_APP_AND_REF_TAG_F_DETECT;
+	} else {
+		flags |= IDXD_DIF_SOURCE_FLAG_APP_TAG_F_DETECT;
+	}
+
+	if (!(ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK)) {
+		flags |= IDXD_DIF_SOURCE_FLAG_GUARD_CHECK_DISABLE;
+	}
+
+	if (!(ctx->dif_flags & SPDK_DIF_FLAGS_REFTAG_CHECK)) {
+		flags |= IDXD_DIF_SOURCE_FLAG_REF_TAG_CHECK_DISABLE;
+	}
+
+	return flags;
+}
+
+/* Bits set in the DSA application tag mask are not checked */
+static uint16_t
+idxd_dif_app_tag_mask(const struct spdk_dif_ctx *ctx)
+{
+	if (!(ctx->dif_flags & SPDK_DIF_FLAGS_APPTAG_CHECK)) {
+		return 0xFFFF;
+	}
+
+	return ~ctx->apptag_mask;
+}
+
+static uint32_t
+idxd_dif_ref_tag(const struct spdk_dif_ctx *ctx, uint32_t offset_blocks)
+{
+	if (ctx->dif_type == SPDK_DIF_TYPE3) {
+		offset_blocks = 0;
+	}
+
+	return (uint32_t)(ctx->init_ref_tag + ctx->ref_tag_offset + offset_blocks);
+}
+
+/* Translate as much of buf as is physically contiguous, up to len bytes */
+static uint64_t
+idxd_vtophys_len(struct spdk_idxd_io_channel *chan, const void *buf, uint64_t len,
+		 uint64_t *buf_addr)
+{
+	if (chan->pasid_enabled) {
+		*buf_addr = (uint64_t)buf;
+		return len;
+	}
+
+	*buf_addr = spdk_vtophys(buf, &len);
+	if (*buf_addr == SPDK_VTOPHYS_ERROR) {
+		SPDK_ERRLOG("Error translating address\n");
+		return 0;
+	}
+
+	return len;
+}
+
+/*
+ * Build one descriptor per physically contiguous run of whole blocks. DIF check has no
+ * destination, DIF insert adds and DIF strip removes the metadata of each block.
+ */
+static int
+idxd_submit_dif(struct spdk_idxd_io_channel *chan, uint8_t opcode,
+		struct iovec *diov, size_t diovcnt, struct iovec *siov, size_t siovcnt,
+		uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+		spdk_idxd_req_cb cb_fn, void *cb_arg)
+{
+	struct idxd_hw_desc *desc;
+	struct idxd_ops *first_op, *op;
+	uint32_t data_block_size = ctx->block_size - ctx->md_size;
+	uint32_t src_block_size, dst_block_size, offset_blocks, blocks;
+	uint64_t src_addr, dst_addr = 0, src_off = 0, dst_off = 0;
+	size_t sidx = 0, didx = 0;
+	int rc, count;
+
+	assert(chan != NULL);
+	assert(siov != NULL);
+
+	if (!spdk_idxd_dif_ctx_is_supported(ctx)) {
+		return -EINVAL;
+	}
+
+	src_block_size = opcode == IDXD_OPCODE_DIF_INS ? data_block_size : ctx->block_size;
+	dst_block_size = opcode == IDXD_OPCODE_DIF_STRP ? data_block_size : ctx->block_size;
+
+	rc = _idxd_setup_batch(chan);
+	if (rc) {
+		return rc;
+	}
+
+	count = 0;
+	first_op = NULL;
+	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks += blocks) {
+		if (sidx == siovcnt || (diov != NULL && didx == diovcnt)) {
+			rc = -EINVAL;
+			goto error;
+		}
+
+		blocks = spdk_min(num_blocks - offset_blocks,
+				  (siov[sidx].iov_len - src_off) / src_block_size);
+		blocks = spdk_min(blocks, idxd_vtophys_len(chan, (uint8_t *)siov[sidx].iov_base + src_off,
+				  (uint64_t)blocks * src_block_size, &src_addr) / src_block_size);
+		if (diov != NULL) {
+			blocks = spdk_min(blocks, (diov[didx].iov_len - dst_off) / dst_block_size);
+			blocks = spdk_min(blocks, idxd_vtophys_len(chan, (uint8_t *)diov[didx].iov_base + dst_off,
+					  (uint64_t)blocks * dst_block_size, &dst_addr) / dst_block_size);
+		}
+
+		/* A block is split across iovecs or physical pages */
+		if (blocks == 0) {
+			rc = -EINVAL;
+			goto error;
+		}
+
+		if (first_op == NULL) {
+			rc = _idxd_prep_batch_cmd(chan, cb_fn, cb_arg, flags, &desc, &op);
+			if (rc) {
+				goto error;
+			}
+
+			first_op = op;
+		} else {
+			rc = _idxd_prep_batch_cmd(chan, NULL, NULL, flags, &desc, &op);
+			if (rc) {
+				goto error;
+			}
+
+			first_op->count++;
+			op->parent = first_op;
+		}
+
+		count++;
+
+		desc->opcode = opcode;
+		desc->src_addr = src_addr;
+		desc->dst_addr = dst_addr;
+		desc->xfer_size = blocks * src_block_size;
+		if (opcode == IDXD_OPCODE_DIF_INS) {
+			desc->dif_ins.flags = idxd_dif_flags(ctx);
+			if (ctx->dif_type == SPDK_DIF_TYPE3) {
+				desc->dif_ins.dest_flag = IDXD_DIF_DEST_FLAG_REF_TAG_TYPE;
+			}
+			desc->dif_ins.ref_tag_seed = idxd_dif_ref_tag(ctx, offset_blocks);
+			desc->dif_ins.app_tag_seed = ctx->app_tag;
+		} else {
+			desc->dif_chk.flags = idxd_dif_flags(ctx);
+			desc->dif_chk.src_flags = idxd_dif_source_flags(ctx);
+			desc->dif_chk.ref_tag_seed = idxd_dif_ref_tag(ctx, offset_blocks);
+			desc->dif_chk.app_tag_mask = idxd_dif_app_tag_mask(ctx);
+			desc->dif_chk.app_tag_seed = ctx->app_tag;
+		}
+		if (diov != NULL) {
+			_update_write_flags(chan, desc);
+		}
+
+		src_off += (uint64_t)blocks * src_block_size;
+		if (src_off == siov[sidx].iov_len) {
+			sidx++;
+			src_off = 0;
+		}
+		if (diov != NULL) {
+			dst_off += (uint64_t)blocks * dst_block_size;
+			if (dst_off == diov[didx].iov_len) {
+				didx++;
+				dst_off = 0;
+			}
+		}
+	}
+
+	return _idxd_flush_batch(chan);
+
+error:
+	chan->batch->index -= count;
+	return rc;
+}
+
+int
+spdk_idxd_submit_dif_check(struct spdk_idxd_io_channel *chan,
+			   struct iovec *siov, size_t siovcnt,
+			   uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+			   spdk_idxd_req_cb cb_fn, void *cb_arg)
+{
+	return idxd_submit_dif(chan, IDXD_OPCODE_DIF_CHECK, NULL, 0, siov, siovcnt,
+			       num_blocks, ctx, flags, cb_fn, cb_arg);
+}
+
+int
+spdk_idxd_submit_dif_insert(struct spdk_idxd_io_channel *chan,
+			    struct iovec *diov, size_t diovcnt,
+			    struct iovec *siov, size_t siovcnt,
+			    uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+			    spdk_idxd_req_cb cb_fn, void *cb_arg)
+{
+	assert(diov != NULL);
+
+	return idxd_submit_dif(chan, IDXD_OPCODE_DIF_INS, diov, diovcnt, siov, siovcnt,
+			       num_blocks, ctx, flags, cb_fn, cb_arg);
+}
+
+int
+spdk_idxd_submit_dif_strip(struct spdk_idxd_io_channel *chan,
+			   struct iovec *diov, size_t diovcnt,
+			   struct iovec *siov, size_t siovcnt,
+			   uint32_t num_blocks, const struct spdk_dif_ctx *ctx, int flags,
+			   spdk_idxd_req_cb cb_fn, void *cb_arg)
+{
+	assert(diov != NULL);
+
+	return idxd_submit_dif(chan, IDXD_OPCODE_DIF_STRP, diov, diovcnt, siov, siovcnt,
+			       num_blocks, ctx, flags, cb_fn, cb_arg);
+}
+
 static inline int
 _idxd_submit_compress_single(struct spdk_idxd_io_channel *chan, void *dst, const void *src,
 			     uint64_t nbytes_dst, uint64_t nbytes_src, uint32_t *output_size,
@@ -1354,9 +1593,14 @@ spdk_idxd_process_events(struct spdk_idxd_io_channel *chan)
 
 		/* Status is in the same location for both IAA and DSA completion records. */
 		if (spdk_unlikely(IDXD_FAILURE(op->hw.status))) {
-			SPDK_ERRLOG("Completion status 0x%x\n", op->hw.status);
-			status = -EINVAL;
-			_dump_sw_error_reg(chan);
+			if (op->hw.status == DSA_COMP_DIF_ERR) {
+				/* Not a device error, the DIF of the data doesn't match */
+				status = -EIO;
+			} else {
+				SPDK_ERRLOG("Completion status 0x%x\n", op->hw.status);
+				status = -EINVAL;
+				_dump_sw_error_reg(chan);
+			}
 		}
 
 		switch (op->desc->opcode) {
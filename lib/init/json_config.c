@@ -57,6 +57,34 @@ typedef void (*client_resp_handler)(struct load_json_config_ctx *,
  * So just print WARNLOG every 10s. */
 #define RPC_CLIENT_REQUEST_TIMEOUT_US (10U * 1000 * 1000)
 
+/* Maximum number of "config" entries sent concurrently */
+#define JSON_CONFIG_MAX_CONCURRENT_RPCS 32
+
+/*
+ * Methods creating independent objects, identified by the given parameter.  Consecutive entries
+ * of one of these methods are sent concurrently, as long as the identifying parameters differ.
+ */
+static const struct {
+	const char *method;
+	const char *key;
+} g_concurrent_methods[] = {
+	{"bdev_nvme_attach_controller", "name"},
+	{"bdev_malloc_create", "name"},
+	{"bdev_null_create", "name"},
+	{"bdev_aio_create", "name"},
+	{"nvmf_create_subsystem", "nqn"},
+};
+
+static uint32_t g_max_concurrent_rpcs = 1;
+
+/* Connection used to send one of the entries loaded concurrently */
+struct config_lane {
+	struct spdk_jsonrpc_client *client;
+	/* Identifying parameter of the entry being sent, NULL if the lane is idle */
+	struct spdk_json_val *key;
+	uint64_t timeout;
+};
+
 struct load_json_config_ctx {
 	/* Thread used during configuration. */
 	struct spdk_thread *thread;
@@ -93,23 +121,74 @@ struct load_json_config_ctx {
 
 	/* Timeout for current RPC client action. */
 	uint64_t timeout;
+
+	/* Entries loaded concurrently, from batch_it up to (but not including) batch_end */
+	struct config_lane *lanes;
+	uint32_t num_lanes;
+	uint32_t lanes_busy;
+	bool batch_active;
+	struct spdk_json_val *batch_it;
+	struct spdk_json_val *batch_end;
+	const char *batch_key;
+
+	/* Timing of the configuration phases */
+	uint64_t start_tsc;
+	uint64_t init_start_tsc;
+	uint64_t init_end_tsc;
+	uint64_t subsystem_start_tsc;
+	uint32_t subsystem_entries;
 };
 
 static void app_json_config_load_subsystem(void *_ctx);
 
+int
+spdk_subsystem_set_json_config_max_concurrent_rpcs(uint32_t max_concurrent_rpcs)
+{
+	if (max_concurrent_rpcs == 0 || max_concurrent_rpcs > JSON_CONFIG_MAX_CONCURRENT_RPCS) {
+		return -EINVAL;
+	}
+
+	g_max_concurrent_rpcs = max_concurrent_rpcs;
+	return 0;
+}
+
+static uint64_t
+ticks_to_ms(uint64_t ticks)
+{
+	return ticks * 1000 / spdk_get_ticks_hz();
+}
+
 static void
 app_json_config_load_done(struct load_json_config_ctx *ctx, int rc)
 {
+	uint64_t now = spdk_get_ticks();
+	uint32_t i;
+
 	spdk_poller_unregister(&ctx->client_conn_poller);
 	if (ctx->client_conn != NULL) {
 		spdk_jsonrpc_client_close(ctx->client_conn);
 	}
+	for (i = 0; i < ctx->num_lanes; i++) {
+		if (ctx->lanes[i].client != NULL) {
+			spdk_jsonrpc_client_close(ctx->lanes[i].client);
+		}
+	}
 
 	spdk_rpc_finish();
 
+	if (rc == 0 && ctx->init_end_tsc != 0) {
+		SPDK_NOTICELOG("JSON configuration loaded in %" PRIu64 " ms (startup RPCs: %" PRIu64
+			       " ms, subsystem init: %" PRIu64 " ms, runtime RPCs: %" PRIu64 " ms)\n",
+			       ticks_to_ms(now - ctx->start_tsc),
+			       ticks_to_ms(ctx->init_start_tsc - ctx->start_tsc),
+			       ticks_to_ms(ctx->init_end_tsc - ctx->init_start_tsc),
+			       ticks_to_ms(now - ctx->init_end_tsc));
+	}
+
 	SPDK_DEBUG_APP_CFG("Config load finished with rc %d\n", rc);
 	ctx->cb_fn(rc, ctx->cb_arg);
 
+	free(ctx->lanes);
 	free(ctx->json_data);
 	free(ctx->values);
 	free(ctx);
@@ -151,6 +230,78 @@ json_write_stdout(void *cb_ctx, const void *data, size_t size)
 	return rc == size ? 0 : -1;
 }
 
+static void
+rpc_client_print_error(struct spdk_jsonrpc_client_response *resp)
+{
+	struct json_write_buf buf = {};
+	struct spdk_json_write_ctx *w = spdk_json_write_begin(json_write_stdout,
+					&buf, SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
+
+	if (w == NULL) {
+		SPDK_ERRLOG("error response: (?)\n");
+	} else {
+		spdk_json_write_val(w, resp->error);
+		spdk_json_write_end(w);
+		SPDK_ERRLOG("error response: \n%s\n", buf.data);
+	}
+}
+
+static int app_json_config_load_batch(struct load_json_config_ctx *ctx);
+
+/* Poll the connections used for the entries loaded concurrently */
+static int
+rpc_client_poll_lanes(struct load_json_config_ctx *ctx)
+{
+	struct spdk_jsonrpc_client_response *resp;
+	struct config_lane *lane;
+	uint32_t i;
+	int rc;
+
+	for (i = 0; i < ctx->num_lanes; i++) {
+		lane = &ctx->lanes[i];
+		if (lane->key == NULL) {
+			continue;
+		}
+
+		rc = spdk_jsonrpc_client_poll(lane->client, 0);
+		if (rc == 0 || rc == -ENOTCONN) {
+			/* No response yet, or still connecting */
+			if (lane->timeout < spdk_get_ticks()) {
+				SPDK_WARNLOG("RPC client command timeout.\n");
+				lane->timeout = spdk_get_ticks() + RPC_CLIENT_REQUEST_TIMEOUT_US *
+						spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+			}
+			continue;
+		} else if (rc < 0) {
+			app_json_config_load_done(ctx, rc);
+			return SPDK_POLLER_BUSY;
+		}
+
+		resp = spdk_jsonrpc_client_get_response(lane->client);
+		assert(resp);
+
+		if (resp->error) {
+			rpc_client_print_error(resp);
+			if (ctx->stop_on_error) {
+				spdk_jsonrpc_client_free_response(resp);
+				app_json_config_load_done(ctx, -EINVAL);
+				return SPDK_POLLER_BUSY;
+			}
+		}
+
+		/* Don't care about the response */
+		spdk_jsonrpc_client_free_response(resp);
+		lane->key = NULL;
+		ctx->lanes_busy--;
+
+		if (app_json_config_load_batch(ctx) != 0 || !ctx->batch_active) {
+			break;
+		}
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
 static int
 rpc_client_poller(void *arg)
 {
@@ -161,6 +312,10 @@ rpc_client_poller(void *arg)
 
 	assert(spdk_get_thread() == ctx->thread);
 
+	if (ctx->batch_active) {
+		return rpc_client_poll_lanes(ctx);
+	}
+
 	rc = spdk_jsonrpc_client_poll(ctx->client_conn, 0);
 	if (rc == 0) {
 		rc = rpc_client_check_timeout(ctx);
@@ -182,17 +337,7 @@ rpc_client_poller(void *arg)
 	assert(resp);
 
 	if (resp->error) {
-		struct json_write_buf buf = {};
-		struct spdk_json_write_ctx *w = spdk_json_write_begin(json_write_stdout,
-						&buf, SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
-
-		if (w == NULL) {
-			SPDK_ERRLOG("error response: (?)\n");
-		} else {
-			spdk_json_write_val(w, resp->error);
-			spdk_json_write_end(w);
-			SPDK_ERRLOG("error response: \n%s\n", buf.data);
-		}
+		rpc_client_print_error(resp);
 	}
 
 	if (resp->error && ctx->stop_on_error) {
@@ -307,6 +452,178 @@ static struct spdk_json_object_decoder jsonrpc_cmd_decoders[] = {
 
 static void app_json_config_load_subsystem_config_entry(void *_ctx);
 
+static struct spdk_jsonrpc_client_request *
+app_json_config_create_request(struct load_json_config_ctx *ctx, struct config_entry *cfg)
+{
+	struct spdk_jsonrpc_client_request *rpc_request;
+	struct spdk_json_write_ctx *w;
+	struct spdk_json_val *params_end;
+	size_t params_len = 0;
+
+	SPDK_DEBUG_APP_CFG("\tmethod: %s\n", cfg->method);
+
+	if (cfg->params) {
+		/* Get _END by skipping params and going back by one element. */
+		params_end = cfg->params + spdk_json_val_len(cfg->params) - 1;
+
+		/* Need to add one character to include '}' */
+		params_len = params_end->start - cfg->params->start + 1;
+
+		SPDK_DEBUG_APP_CFG("\tparams: %.*s\n", (int)params_len, (char *)cfg->params->start);
+	}
+
+	rpc_request = spdk_jsonrpc_client_create_request();
+	if (!rpc_request) {
+		return NULL;
+	}
+
+	w = spdk_jsonrpc_begin_request(rpc_request, ctx->rpc_request_id, NULL);
+	if (!w) {
+		spdk_jsonrpc_client_free_request(rpc_request);
+		return NULL;
+	}
+
+	spdk_json_write_named_string(w, "method", cfg->method);
+
+	if (cfg->params) {
+		/* No need to parse "params". Just dump the whole content of "params"
+		 * directly into the request and let the remote side verify it. */
+		spdk_json_write_name(w, "params");
+		spdk_json_write_val_raw(w, cfg->params->start, params_len);
+	}
+
+	spdk_jsonrpc_end_request(rpc_request, w);
+
+	ctx->subsystem_entries++;
+
+	return rpc_request;
+}
+
+static const char *
+config_method_concurrent_key(const char *method)
+{
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_concurrent_methods); i++) {
+		if (strcmp(method, g_concurrent_methods[i].method) == 0) {
+			return g_concurrent_methods[i].key;
+		}
+	}
+
+	return NULL;
+}
+
+static struct spdk_json_val *
+config_entry_key(struct config_entry *cfg, const char *key)
+{
+	struct spdk_json_val *val;
+
+	if (cfg->params == NULL || spdk_json_find_string(cfg->params, key, NULL, &val) != 0) {
+		return NULL;
+	}
+
+	return val;
+}
+
+/*
+ * Send the entries of the current batch, each over an idle connection, unless an entry with the
+ * same identifying parameter is still being loaded.  Once all of them are done, loading of the
+ * following entries continues.
+ */
+static int
+app_json_config_load_batch(struct load_json_config_ctx *ctx)
+{
+	struct spdk_jsonrpc_client_request *rpc_request;
+	struct config_entry cfg;
+	struct config_lane *lane;
+	struct spdk_json_val *key;
+	uint32_t i;
+	int rc;
+
+	while (ctx->batch_it != ctx->batch_end) {
+		memset(&cfg, 0, sizeof(cfg));
+		rc = spdk_json_decode_object(ctx->batch_it, jsonrpc_cmd_decoders,
+					     SPDK_COUNTOF(jsonrpc_cmd_decoders), &cfg);
+		/* Entries were checked when the batch was started */
+		assert(rc == 0);
+		key = config_entry_key(&cfg, ctx->batch_key);
+		assert(key != NULL);
+
+		lane = NULL;
+		for (i = 0; i < ctx->num_lanes; i++) {
+			if (ctx->lanes[i].key == NULL) {
+				lane = lane ? lane : &ctx->lanes[i];
+			} else if (ctx->lanes[i].key->len == key->len &&
+				   memcmp(ctx->lanes[i].key->start, key->start, key->len) == 0) {
+				/* Wait for the entry with the same identifying parameter */
+				lane = NULL;
+				break;
+			}
+		}
+
+		if (lane == NULL) {
+			free(cfg.method);
+			break;
+		}
+
+		rpc_request = app_json_config_create_request(ctx, &cfg);
+		free(cfg.method);
+		if (rpc_request == NULL) {
+			app_json_config_load_done(ctx, -ENOMEM);
+			return -ENOMEM;
+		}
+
+		rc = spdk_jsonrpc_client_send_request(lane->client, rpc_request);
+		if (rc != 0) {
+			spdk_jsonrpc_client_free_request(rpc_request);
+			app_json_config_load_done(ctx, rc);
+			return rc;
+		}
+
+		lane->key = key;
+		lane->timeout = spdk_get_ticks() + RPC_CLIENT_REQUEST_TIMEOUT_US * spdk_get_ticks_hz() /
+				SPDK_SEC_TO_USEC;
+		ctx->lanes_busy++;
+		ctx->batch_it = spdk_json_next(ctx->batch_it);
+	}
+
+	if (ctx->lanes_busy == 0) {
+		ctx->batch_active = false;
+		ctx->config_it = ctx->batch_end;
+		spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem_config_entry, ctx);
+	}
+
+	return 0;
+}
+
+/* Load the entry at config_it, and the consecutive entries of the same method, concurrently */
+static void
+app_json_config_start_batch(struct load_json_config_ctx *ctx, const char *method, const char *key)
+{
+	struct spdk_json_val *it;
+	struct config_entry next;
+	bool same;
+
+	for (it = spdk_json_next(ctx->config_it); it != NULL; it = spdk_json_next(it)) {
+		memset(&next, 0, sizeof(next));
+		same = spdk_json_decode_object(it, jsonrpc_cmd_decoders, SPDK_COUNTOF(jsonrpc_cmd_decoders),
+					       &next) == 0 &&
+		       strcmp(next.method, method) == 0 && config_entry_key(&next, key) != NULL;
+		free(next.method);
+		if (!same) {
+			break;
+		}
+	}
+
+	SPDK_DEBUG_APP_CFG("Loading '%s' entries concurrently\n", method);
+	ctx->batch_active = true;
+	ctx->batch_it = ctx->config_it;
+	ctx->batch_end = it;
+	ctx->batch_key = key;
+
+	app_json_config_load_batch(ctx);
+}
+
 static void
 app_json_config_load_subsystem_config_entry_next(struct load_json_config_ctx *ctx,
 		struct spdk_jsonrpc_client_response *resp)
@@ -324,16 +641,17 @@ app_json_config_load_subsystem_config_entry(void *_ctx)
 {
 	struct load_json_config_ctx *ctx = _ctx;
 	struct spdk_jsonrpc_client_request *rpc_request;
-	struct spdk_json_write_ctx *w;
 	struct config_entry cfg = {};
-	struct spdk_json_val *params_end;
-	size_t params_len = 0;
+	const char *key;
 	uint32_t state_mask = 0, cur_state_mask, startup_runtime = SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME;
 	int rc;
 
 	if (ctx->config_it == NULL) {
 		SPDK_DEBUG_APP_CFG("Subsystem '%.*s': configuration done.\n", ctx->subsystem_name->len,
 				   (char *)ctx->subsystem_name->start);
+		SPDK_INFOLOG(app_config, "Subsystem '%.*s': %u entries loaded in %" PRIu64 " ms\n",
+			     ctx->subsystem_name->len, (char *)ctx->subsystem_name->start,
+			     ctx->subsystem_entries, ticks_to_ms(spdk_get_ticks() - ctx->subsystem_start_tsc));
 		ctx->subsystems_it = spdk_json_next(ctx->subsystems_it);
 		/* Invoke later to avoid recurrence */
 		spdk_thread_send_msg(ctx->thread, app_json_config_load_subsystem, ctx);
@@ -371,42 +689,19 @@ app_json_config_load_subsystem_config_entry(void *_ctx)
 		goto out;
 	}
 
-	SPDK_DEBUG_APP_CFG("\tmethod: %s\n", cfg.method);
-
-	if (cfg.params) {
-		/* Get _END by skipping params and going back by one element. */
-		params_end = cfg.params + spdk_json_val_len(cfg.params) - 1;
-
-		/* Need to add one character to include '}' */
-		params_len = params_end->start - cfg.params->start + 1;
-
-		SPDK_DEBUG_APP_CFG("\tparams: %.*s\n", (int)params_len, (char *)cfg.params->start);
-	}
-
-	rpc_request = spdk_jsonrpc_client_create_request();
-	if (!rpc_request) {
-		app_json_config_load_done(ctx, -errno);
+	/* Entries creating independent objects are sent over the additional connections */
+	key = ctx->num_lanes > 0 ? config_method_concurrent_key(cfg.method) : NULL;
+	if (key != NULL && config_entry_key(&cfg, key) != NULL) {
+		app_json_config_start_batch(ctx, cfg.method, key);
 		goto out;
 	}
 
-	w = spdk_jsonrpc_begin_request(rpc_request, ctx->rpc_request_id, NULL);
-	if (!w) {
-		spdk_jsonrpc_client_free_request(rpc_request);
+	rpc_request = app_json_config_create_request(ctx, &cfg);
+	if (!rpc_request) {
 		app_json_config_load_done(ctx, -ENOMEM);
 		goto out;
 	}
 
-	spdk_json_write_named_string(w, "method", cfg.method);
-
-	if (cfg.params) {
-		/* No need to parse "params". Just dump the whole content of "params"
-		 * directly into the request and let the remote side verify it. */
-		spdk_json_write_name(w, "params");
-		spdk_json_write_val_raw(w, cfg.params->start, params_len);
-	}
-
-	spdk_jsonrpc_end_request(rpc_request, w);
-
 	rc = client_send_request(ctx, rpc_request, app_json_config_load_subsystem_config_entry_next);
 	if (rc != 0) {
 		app_json_config_load_done(ctx, -rc);
@@ -426,6 +721,7 @@ subsystem_init_done(int rc, void *arg1)
 		return;
 	}
 
+	ctx->init_end_tsc = spdk_get_ticks();
 	spdk_rpc_set_state(SPDK_RPC_RUNTIME);
 	/* Another round. This time for RUNTIME methods */
 	SPDK_DEBUG_APP_CFG("'framework_start_init' done - continuing configuration\n");
@@ -468,6 +764,7 @@ app_json_config_load_subsystem(void *_ctx)
 	if (ctx->subsystems_it == NULL) {
 		if (spdk_rpc_get_state() == SPDK_RPC_STARTUP) {
 			SPDK_DEBUG_APP_CFG("No more entries for current state, calling 'framework_start_init'\n");
+			ctx->init_start_tsc = spdk_get_ticks();
 			spdk_subsystem_init(subsystem_init_done, ctx);
 		} else {
 			app_json_config_load_done(ctx, 0);
@@ -487,6 +784,9 @@ app_json_config_load_subsystem(void *_ctx)
 	SPDK_DEBUG_APP_CFG("Loading subsystem '%.*s' configuration\n", ctx->subsystem_name->len,
 			   (char *)ctx->subsystem_name->start);
 
+	ctx->subsystem_start_tsc = spdk_get_ticks();
+	ctx->subsystem_entries = 0;
+
 	/* Get 'config' array first configuration entry */
 	ctx->config_it = spdk_json_array_first(ctx->config);
 	app_json_config_load_subsystem_config_entry(ctx);
@@ -563,6 +863,7 @@ spdk_subsystem_init_from_json_config(const char *json_config_file, const char *r
 				     bool stop_on_error)
 {
 	struct load_json_config_ctx *ctx = calloc(1, sizeof(*ctx));
+	uint32_t i;
 	int rc;
 
 	assert(cb_fn);
@@ -575,6 +876,7 @@ spdk_subsystem_init_from_json_config(const char *json_config_file, const char *r
 	ctx->cb_arg = cb_arg;
 	ctx->stop_on_error = stop_on_error;
 	ctx->thread = spdk_get_thread();
+	ctx->start_tsc = spdk_get_ticks();
 
 	rc = app_json_config_read(json_config_file, ctx);
 	if (rc) {
@@ -629,6 +931,25 @@ spdk_subsystem_init_from_json_config(const char *json_config_file, const char *r
 		goto fail;
 	}
 
+	/* Additional connections, used to send independent entries concurrently. They complete
+	 * connecting in the background, requests are queued until then. */
+	if (g_max_concurrent_rpcs > 1) {
+		ctx->lanes = calloc(g_max_concurrent_rpcs, sizeof(*ctx->lanes));
+		if (ctx->lanes == NULL) {
+			SPDK_ERRLOG("Out of memory\n");
+			goto fail;
+		}
+		ctx->num_lanes = g_max_concurrent_rpcs;
+
+		for (i = 0; i < ctx->num_lanes; i++) {
+			ctx->lanes[i].client = spdk_jsonrpc_client_connect(ctx->rpc_socket_path_temp, AF_UNIX);
+			if (ctx->lanes[i].client == NULL) {
+				SPDK_ERRLOG("Failed to connect to '%s'\n", ctx->rpc_socket_path_temp);
+				goto fail;
+			}
+		}
+	}
+
 	rpc_client_set_timeout(ctx, RPC_CLIENT_CONNECT_TIMEOUT_US);
 	ctx->client_conn_poller = SPDK_POLLER_REGISTER(rpc_client_connect_poller, ctx, 100);
 	return;
@@ -9,6 +9,7 @@
 #include "spdk/log.h"
 #include "spdk/queue.h"
 #include "spdk/thread.h"
+#include "spdk/util.h"
 
 #include "spdk_internal/init.h"
 #include "spdk/env.h"
@@ -30,6 +31,7 @@ static void *g_subsystem_start_arg = NULL;
 static spdk_msg_fn g_subsystem_stop_fn = NULL;
 static void *g_subsystem_stop_arg = NULL;
 static struct spdk_thread *g_fini_thread = NULL;
+static uint64_t g_subsystem_init_start_tsc;
 
 void
 spdk_add_subsystem(struct spdk_subsystem *subsystem)
@@ -153,6 +155,9 @@ spdk_subsystem_init_next(int rc)
 	if (!g_next_subsystem) {
 		g_next_subsystem = TAILQ_FIRST(&g_subsystems);
 	} else {
+		SPDK_INFOLOG(subsystem, "Subsystem %s initialized in %" PRIu64 " us\n", g_next_subsystem->name,
+			     (uint64_t)((spdk_get_ticks() - g_subsystem_init_start_tsc) * SPDK_SEC_TO_USEC /
+					spdk_get_ticks_hz()));
 		g_next_subsystem = TAILQ_NEXT(g_next_subsystem, tailq);
 	}
 
@@ -162,6 +167,7 @@ spdk_subsystem_init_next(int rc)
 		return;
 	}
 
+	g_subsystem_init_start_tsc = spdk_get_ticks();
 	if (g_next_subsystem->init) {
 		g_next_subsystem->init();
 	} else {
@@ -261,3 +267,5 @@ subsystem_config_json(struct spdk_json_write_ctx *w, struct spdk_subsystem *subs
 		spdk_json_write_null(w);
 	}
 }
+
+SPDK_LOG_REGISTER_COMPONENT(subsystem)
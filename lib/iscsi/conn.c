@@ -34,6 +34,14 @@
 
 #define SPDK_ISCSI_CONNECTION_STATUS(status, rnstr) case(status): return(rnstr)
 
+/* Difference in busy percentage above which a poll group is considered more loaded
+ *  regardless of the number of outstanding tasks.
+ */
+#define ISCSI_POLL_GROUP_BUSY_PCT_HYSTERESIS	10
+
+/* Time given to a connection to quiesce before its migration is cancelled. */
+#define ISCSI_CONN_MIGRATE_TIMEOUT_US		1000000
+
 static struct spdk_iscsi_conn *g_conns_array = NULL;
 
 static TAILQ_HEAD(, spdk_iscsi_conn) g_free_conns = TAILQ_HEAD_INITIALIZER(g_free_conns);
@@ -45,6 +53,7 @@ static struct spdk_poller *g_shutdown_timer = NULL;
 
 static void iscsi_conn_sock_cb(void *arg, struct spdk_sock_group *group,
 			       struct spdk_sock *sock);
+static void iscsi_conn_migrate_cancel(struct spdk_iscsi_conn *conn);
 
 static struct spdk_iscsi_conn *
 allocate_conn(void)
@@ -58,6 +67,7 @@ allocate_conn(void)
 		TAILQ_REMOVE(&g_free_conns, conn, conn_link);
 		SPDK_ISCSI_CONNECTION_MEMSET(conn);
 		conn->is_valid = 1;
+		conn->generation++;
 
 		TAILQ_INSERT_TAIL(&g_active_conns, conn, conn_link);
 	}
@@ -142,6 +152,18 @@ iscsi_poll_group_remove_conn(struct spdk_iscsi_poll_group *pg, struct spdk_iscsi
 	STAILQ_REMOVE(&pg->connections, conn, spdk_iscsi_conn, pg_link);
 }
 
+/* conn->pg changes when the connection is scheduled or migrated, on the thread of its previous
+ *  poll group.  Other threads must use this to find the thread to send a message to, and the
+ *  message must check that it still runs on the thread of the connection.
+ */
+static inline struct spdk_thread *
+iscsi_conn_get_thread(struct spdk_iscsi_conn *conn)
+{
+	struct spdk_iscsi_poll_group *pg = __atomic_load_n(&conn->pg, __ATOMIC_ACQUIRE);
+
+	return spdk_io_channel_get_thread(spdk_io_channel_from_ctx(pg));
+}
+
 static int
 login_timeout(void *arg)
 {
@@ -217,6 +239,7 @@ iscsi_conn_construct(struct spdk_iscsi_portal *portal,
 	conn->pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY;
 
 	TAILQ_INIT(&conn->write_pdu_list);
+	STAILQ_INIT(&conn->free_write_batches);
 	TAILQ_INIT(&conn->snack_pdu_list);
 	TAILQ_INIT(&conn->queued_r2t_tasks);
 	TAILQ_INIT(&conn->active_r2t_tasks);
@@ -257,7 +280,7 @@ iscsi_conn_construct(struct spdk_iscsi_portal *portal,
 		goto error_return;
 	}
 
-	conn->pg = pg;
+	__atomic_store_n(&conn->pg, pg, __ATOMIC_RELEASE);
 	spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(pg)),
 			     iscsi_conn_start, conn);
 	return 0;
@@ -268,6 +291,20 @@ error_return:
 	return -1;
 }
 
+/* The socket is closed, hence no batch is in flight anymore. */
+static void
+iscsi_conn_free_write_batches(struct spdk_iscsi_conn *conn)
+{
+	struct iscsi_write_batch *batch;
+
+	assert(conn->write_batch == NULL);
+
+	while ((batch = STAILQ_FIRST(&conn->free_write_batches)) != NULL) {
+		STAILQ_REMOVE_HEAD(&conn->free_write_batches, link);
+		free(batch);
+	}
+}
+
 void
 iscsi_conn_free_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 {
@@ -361,6 +398,12 @@ iscsi_conn_free(struct spdk_iscsi_conn *conn)
 	sess = conn->sess;
 	conn->sess = NULL;
 
+	pthread_mutex_lock(&sess->lock);
+	if (conn->cmdsn_waiting) {
+		TAILQ_REMOVE(&sess->cmdsn_waiters, conn, cmdsn_link);
+		conn->cmdsn_waiting = false;
+	}
+
 	for (i = 0; i < sess->connections; i++) {
 		if (sess->conns[i] == conn) {
 			idx = i;
@@ -368,15 +411,23 @@ iscsi_conn_free(struct spdk_iscsi_conn *conn)
 		}
 	}
 
-	if (idx < 0) {
-		SPDK_ERRLOG("remove conn not found\n");
-	} else {
+	if (idx >= 0) {
 		for (i = idx; i < sess->connections - 1; i++) {
 			sess->conns[i] = sess->conns[i + 1];
 		}
 		sess->conns[sess->connections - 1] = NULL;
 		sess->connections--;
 
+		/* Let the remaining connections recheck their waiting commands.
+		 *  A single connection left does not wait anymore.
+		 */
+		iscsi_sess_resume_cmdsn_waiters(sess);
+	}
+	pthread_mutex_unlock(&sess->lock);
+
+	if (idx < 0) {
+		SPDK_ERRLOG("remove conn not found\n");
+	} else {
 		if (sess->connections == 0) {
 			/* cleanup last connection */
 			SPDK_DEBUGLOG(iscsi,
@@ -391,6 +442,7 @@ iscsi_conn_free(struct spdk_iscsi_conn *conn)
 end:
 	SPDK_DEBUGLOG(iscsi, "cleanup free conn\n");
 	iscsi_param_free(conn->params);
+	iscsi_conn_free_write_batches(conn);
 	_free_conn(conn);
 
 	pthread_mutex_unlock(&g_conns_mutex);
@@ -577,6 +629,13 @@ iscsi_conn_stop(struct spdk_iscsi_conn *conn)
 		target->num_active_conns--;
 		pthread_mutex_unlock(&target->mutex);
 
+		if (conn->is_scheduled) {
+			pthread_mutex_lock(&g_iscsi.mutex);
+			assert(conn->pg->num_conns > 0);
+			conn->pg->num_conns--;
+			pthread_mutex_unlock(&g_iscsi.mutex);
+		}
+
 		iscsi_conn_close_luns(conn);
 	}
 
@@ -614,6 +673,9 @@ _iscsi_conn_destruct(struct spdk_iscsi_conn *conn)
 	spdk_poller_unregister(&conn->logout_request_timer);
 	spdk_poller_unregister(&conn->logout_timer);
 	spdk_poller_unregister(&conn->login_timer);
+	if (conn->migrate_pg != NULL) {
+		iscsi_conn_migrate_cancel(conn);
+	}
 
 	rc = iscsi_conn_free_tasks(conn);
 	if (rc < 0) {
@@ -754,8 +816,7 @@ iscsi_send_logout_request(struct spdk_iscsi_conn *conn)
 
 	to_be32(&rsph->stat_sn, conn->StatSN);
 	conn->StatSN++;
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn, false);
 
 	iscsi_conn_write_pdu(conn, rsp_pdu, iscsi_conn_pdu_generic_complete, NULL);
 }
@@ -779,6 +840,16 @@ static void
 _iscsi_conn_request_logout(void *ctx)
 {
 	struct spdk_iscsi_conn *conn = ctx;
+	struct spdk_thread *thread;
+
+	/* The connection may have been migrated to another poll group after
+	 *  this message was sent. Follow it.
+	 */
+	thread = iscsi_conn_get_thread(conn);
+	if (spdk_unlikely(thread != spdk_get_thread())) {
+		spdk_thread_send_msg(thread, _iscsi_conn_request_logout, conn);
+		return;
+	}
 
 	if (conn->state > ISCSI_CONN_STATE_RUNNING ||
 	    conn->logout_request_timer != NULL) {
@@ -801,7 +872,7 @@ iscsi_conn_request_logout(struct spdk_iscsi_conn *conn)
 		conn->state = ISCSI_CONN_STATE_EXITING;
 	} else if (conn->state == ISCSI_CONN_STATE_RUNNING &&
 		   conn->logout_request_timer == NULL) {
-		thread = spdk_io_channel_get_thread(spdk_io_channel_from_ctx(conn->pg));
+		thread = iscsi_conn_get_thread(conn);
 		spdk_thread_send_msg(thread, _iscsi_conn_request_logout, conn);
 	}
 }
@@ -840,6 +911,14 @@ static void
 _iscsi_conn_drop(void *ctx)
 {
 	struct spdk_iscsi_conn *conn = ctx;
+	struct spdk_thread *thread;
+
+	/* Follow the connection if it was migrated after this message was sent. */
+	thread = iscsi_conn_get_thread(conn);
+	if (spdk_unlikely(thread != spdk_get_thread())) {
+		spdk_thread_send_msg(thread, _iscsi_conn_drop, conn);
+		return;
+	}
 
 	if (conn->state < ISCSI_CONN_STATE_EXITING) {
 		conn->state = ISCSI_CONN_STATE_EXITING;
@@ -897,7 +976,7 @@ iscsi_drop_conns(struct spdk_iscsi_conn *conn, const char *conn_match,
 
 			SPDK_DEBUGLOG(iscsi, "CID=%u\n", xconn->cid);
 
-			thread = spdk_io_channel_get_thread(spdk_io_channel_from_ctx(xconn->pg));
+			thread = iscsi_conn_get_thread(xconn);
 			spdk_thread_send_msg(thread, _iscsi_conn_drop, xconn);
 
 			num++;
@@ -992,6 +1071,11 @@ iscsi_conn_handle_queued_datain_tasks(struct spdk_iscsi_conn *conn)
 {
 	struct spdk_iscsi_task *task;
 
+	/* Subtasks may complete before they are returned from, so write their Data-In PDUs
+	 *  together too.
+	 */
+	iscsi_conn_write_batch_begin(conn);
+
 	while (!TAILQ_EMPTY(&conn->queued_datain_tasks) &&
 	       conn->data_in_cnt < g_iscsi.MaxLargeDataInPerConnection) {
 		task = TAILQ_FIRST(&conn->queued_datain_tasks);
@@ -1014,7 +1098,7 @@ iscsi_conn_handle_queued_datain_tasks(struct spdk_iscsi_conn *conn)
 				subtask->scsi.transfer_len = remaining_size;
 				spdk_scsi_task_process_null_lun(&subtask->scsi);
 				iscsi_task_cpl(&subtask->scsi);
-				return 0;
+				break;
 			}
 
 			subtask->scsi.length = spdk_min(SPDK_BDEV_LARGE_BUF_MAX_SIZE, remaining_size);
@@ -1025,6 +1109,9 @@ iscsi_conn_handle_queued_datain_tasks(struct spdk_iscsi_conn *conn)
 			TAILQ_REMOVE(&conn->queued_datain_tasks, task, link);
 		}
 	}
+
+	iscsi_conn_write_batch_end(conn);
+
 	return 0;
 }
 
@@ -1179,7 +1266,12 @@ iscsi_task_cpl(struct spdk_scsi_task *scsi_task)
 	primary = iscsi_task_get_primary(task);
 
 	if (iscsi_task_is_read(primary)) {
+		/* Data-In PDUs of all subtasks which are completed in order by this
+		 *  completion are written together.
+		 */
+		iscsi_conn_write_batch_begin(conn);
 		process_read_task_completion(conn, task, primary);
+		iscsi_conn_write_batch_end(conn);
 	} else {
 		process_non_read_task_completion(conn, task, primary);
 	}
@@ -1220,8 +1312,7 @@ iscsi_conn_send_nopin(struct spdk_iscsi_conn *conn)
 	to_be32(&rsp->itt, 0xFFFFFFFFU);
 	to_be32(&rsp->ttt, conn->id);
 	to_be32(&rsp->stat_sn, conn->StatSN);
-	to_be32(&rsp->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsp->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsp->exp_cmd_sn, &rsp->max_cmd_sn, false);
 	iscsi_conn_write_pdu(conn, rsp_pdu, iscsi_conn_pdu_generic_complete, NULL);
 	conn->last_nopin = spdk_get_ticks();
 	conn->nop_outstanding = true;
@@ -1420,6 +1511,122 @@ iscsi_conn_pdu_generic_complete(void *cb_arg)
 {
 }
 
+static void
+_iscsi_conn_write_batch_done(void *cb_arg, int err)
+{
+	struct iscsi_write_batch *batch = cb_arg;
+	struct spdk_iscsi_conn *conn = batch->conn;
+	int i;
+
+	/* Completing the Data-In PDUs submits the queued subtasks of large reads.  Batch the PDUs
+	 *  they write as well.
+	 */
+	iscsi_conn_write_batch_begin(conn);
+	for (i = 0; i < batch->num_pdus; i++) {
+		_iscsi_conn_pdu_write_done(batch->pdus[i], err);
+	}
+
+	STAILQ_INSERT_HEAD(&conn->free_write_batches, batch, link);
+	iscsi_conn_write_batch_end(conn);
+}
+
+static struct iscsi_write_batch *
+iscsi_conn_get_write_batch(struct spdk_iscsi_conn *conn)
+{
+	struct iscsi_write_batch *batch;
+
+	batch = STAILQ_FIRST(&conn->free_write_batches);
+	if (spdk_likely(batch != NULL)) {
+		STAILQ_REMOVE_HEAD(&conn->free_write_batches, link);
+	} else {
+		batch = calloc(1, sizeof(*batch));
+		if (batch == NULL) {
+			return NULL;
+		}
+		batch->conn = conn;
+	}
+
+	batch->num_pdus = 0;
+	batch->mapped_length = 0;
+	batch->sock_req.iovcnt = 0;
+	batch->sock_req.cb_fn = _iscsi_conn_write_batch_done;
+	batch->sock_req.cb_arg = batch;
+
+	return batch;
+}
+
+static void
+iscsi_conn_flush_write_batch(struct spdk_iscsi_conn *conn)
+{
+	struct iscsi_write_batch *batch = conn->write_batch;
+
+	if (batch == NULL) {
+		return;
+	}
+	conn->write_batch = NULL;
+
+	if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
+		/* The PDUs are on write_pdu_list and are freed with the connection. */
+		STAILQ_INSERT_HEAD(&conn->free_write_batches, batch, link);
+		return;
+	}
+
+	spdk_trace_record(TRACE_ISCSI_FLUSH_WRITEBUF_START, conn->id, batch->mapped_length,
+			  (uintptr_t)batch->pdus[0], batch->sock_req.iovcnt, batch->num_pdus);
+	spdk_sock_writev_async(conn->sock, &batch->sock_req);
+}
+
+static int
+iscsi_conn_batch_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
+{
+	struct iscsi_write_batch *batch = conn->write_batch;
+	int iovcnt;
+
+	/* Map the PDU by itself first to know how many iovecs it takes. */
+	iovcnt = iscsi_build_iovs(conn, pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
+				  &pdu->mapped_length);
+
+	if (batch != NULL && (batch->num_pdus == ISCSI_WRITE_BATCH_MAX_PDUS ||
+			      batch->sock_req.iovcnt + iovcnt > ISCSI_WRITE_BATCH_IOVCNT)) {
+		iscsi_conn_flush_write_batch(conn);
+		batch = NULL;
+	}
+
+	if (batch == NULL) {
+		batch = iscsi_conn_get_write_batch(conn);
+		if (spdk_unlikely(batch == NULL)) {
+			return -ENOMEM;
+		}
+		conn->write_batch = batch;
+	}
+
+	memcpy(&batch->iov[batch->sock_req.iovcnt], pdu->iov, iovcnt * sizeof(struct iovec));
+	batch->sock_req.iovcnt += iovcnt;
+	batch->mapped_length += pdu->mapped_length;
+	batch->pdus[batch->num_pdus++] = pdu;
+
+	return 0;
+}
+
+/* Collect the PDUs written until the matching iscsi_conn_write_batch_end() into
+ *  a few large sock requests instead of one request per PDU.  Calls may nest.
+ */
+void
+iscsi_conn_write_batch_begin(struct spdk_iscsi_conn *conn)
+{
+	conn->write_batch_depth++;
+}
+
+void
+iscsi_conn_write_batch_end(struct spdk_iscsi_conn *conn)
+{
+	assert(conn->write_batch_depth > 0);
+
+	if (--conn->write_batch_depth == 0) {
+		iscsi_conn_flush_write_batch(conn);
+	}
+}
+
 void
 iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 		     iscsi_conn_xfer_complete_cb cb_fn,
@@ -1458,13 +1665,23 @@ iscsi_conn_write_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 	if (spdk_unlikely(conn->state >= ISCSI_CONN_STATE_EXITING)) {
 		return;
 	}
+
+	if (conn->write_batch_depth > 0 && !pdu->dif_insert_or_strip) {
+		if (iscsi_conn_batch_pdu(conn, pdu) == 0) {
+			return;
+		}
+	}
+
+	/* PDUs must go out in the order they were written. */
+	iscsi_conn_flush_write_batch(conn);
+
 	pdu->sock_req.iovcnt = iscsi_build_iovs(conn, pdu->iov, SPDK_COUNTOF(pdu->iov), pdu,
 						&pdu->mapped_length);
 	pdu->sock_req.cb_fn = _iscsi_conn_pdu_write_done;
 	pdu->sock_req.cb_arg = pdu;
 
 	spdk_trace_record(TRACE_ISCSI_FLUSH_WRITEBUF_START, conn->id, pdu->mapped_length, (uintptr_t)pdu,
-			  pdu->sock_req.iovcnt);
+			  pdu->sock_req.iovcnt, 1);
 	spdk_sock_writev_async(conn->sock, &pdu->sock_req);
 }
 
@@ -1488,6 +1705,68 @@ iscsi_conn_sock_cb(void *arg, struct spdk_sock_group *group, struct spdk_sock *s
 	}
 }
 
+/* The connection may have been freed, and even reused, by the time the resume message
+ *  is handled, so the message carries its id and generation rather than a pointer.
+ */
+#define ISCSI_CONN_RESUME_ARG(conn)	\
+	((void *)(((uintptr_t)(conn)->generation << 32) | (uint32_t)(conn)->id))
+
+static void
+iscsi_conn_resume_cmdsn(void *arg)
+{
+	struct spdk_iscsi_conn *conn;
+	struct spdk_thread *thread;
+	uint32_t id = (uint32_t)(uintptr_t)arg;
+	uint32_t generation = (uint32_t)((uintptr_t)arg >> 32);
+	bool valid;
+	int rc;
+
+	assert(id < MAX_ISCSI_CONNECTIONS);
+	conn = &g_conns_array[id];
+
+	pthread_mutex_lock(&g_conns_mutex);
+	valid = conn->is_valid && conn->generation == generation;
+	pthread_mutex_unlock(&g_conns_mutex);
+	if (!valid) {
+		return;
+	}
+
+	/* The connection migrated to another poll group after the message was sent. */
+	thread = iscsi_conn_get_thread(conn);
+	if (thread != spdk_get_thread()) {
+		spdk_thread_send_msg(thread, iscsi_conn_resume_cmdsn, arg);
+		return;
+	}
+
+	if (conn->state != ISCSI_CONN_STATE_RUNNING ||
+	    conn->pdu_recv_state != ISCSI_PDU_RECV_STATE_AWAIT_CMDSN) {
+		return;
+	}
+
+	/* The socket may have no new data, so do not wait for the sock callback. */
+	rc = iscsi_handle_incoming_pdus(conn);
+	if (rc < 0) {
+		conn->state = ISCSI_CONN_STATE_EXITING;
+	}
+}
+
+/* Wake up the connections waiting for ExpCmdSN to reach the CmdSN of their
+ *  next command. Must be called with sess->lock held.
+ */
+void
+iscsi_sess_resume_cmdsn_waiters(struct spdk_iscsi_sess *sess)
+{
+	struct spdk_iscsi_conn *conn;
+
+	while ((conn = TAILQ_FIRST(&sess->cmdsn_waiters)) != NULL) {
+		TAILQ_REMOVE(&sess->cmdsn_waiters, conn, cmdsn_link);
+		conn->cmdsn_waiting = false;
+
+		spdk_thread_send_msg(iscsi_conn_get_thread(conn), iscsi_conn_resume_cmdsn,
+				     ISCSI_CONN_RESUME_ARG(conn));
+	}
+}
+
 static void
 iscsi_conn_full_feature_migrate(void *arg)
 {
@@ -1518,25 +1797,93 @@ iscsi_conn_full_feature_migrate(void *arg)
 
 static struct spdk_iscsi_poll_group *g_next_pg = NULL;
 
+/* Returns a negative value if pg1 is less loaded than pg2, a positive value
+ *  if pg1 is more loaded than pg2, and 0 otherwise.
+ *
+ * Must be called with g_iscsi.mutex held.
+ */
+static int
+iscsi_poll_group_cmp_load(const struct spdk_iscsi_poll_group *pg1,
+			  const struct spdk_iscsi_poll_group *pg2)
+{
+	uint32_t busy_pct1, busy_pct2;
+	uint64_t load1, load2;
+
+	/* Busy time catches CPU bound poll groups (e.g. with digests enabled)
+	 *  whose connections have only a few outstanding tasks.
+	 */
+	busy_pct1 = __atomic_load_n(&pg1->busy_pct, __ATOMIC_RELAXED);
+	busy_pct2 = __atomic_load_n(&pg2->busy_pct, __ATOMIC_RELAXED);
+	if (busy_pct1 + ISCSI_POLL_GROUP_BUSY_PCT_HYSTERESIS < busy_pct2) {
+		return -1;
+	} else if (busy_pct2 + ISCSI_POLL_GROUP_BUSY_PCT_HYSTERESIS < busy_pct1) {
+		return 1;
+	}
+
+	/* Count each connection as an outstanding task so that connections
+	 *  scheduled since the last load sample are taken into account.
+	 */
+	load1 = (uint64_t)__atomic_load_n(&pg1->outstanding_tasks, __ATOMIC_RELAXED) + pg1->num_conns;
+	load2 = (uint64_t)__atomic_load_n(&pg2->outstanding_tasks, __ATOMIC_RELAXED) + pg2->num_conns;
+
+	if (load1 < load2) {
+		return -1;
+	} else if (load1 > load2) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Must be called with g_iscsi.mutex held. */
+static struct spdk_iscsi_poll_group *
+iscsi_get_least_loaded_pg(void)
+{
+	struct spdk_iscsi_poll_group *pg, *best = NULL;
+
+	TAILQ_FOREACH(pg, &g_iscsi.poll_group_head, link) {
+		if (best == NULL || iscsi_poll_group_cmp_load(pg, best) < 0) {
+			best = pg;
+		}
+	}
+
+	return best;
+}
+
 void
 iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 {
 	struct spdk_iscsi_poll_group	*pg;
 	struct spdk_iscsi_tgt_node	*target;
+	bool				leading;
 
 	if (conn->sess->session_type != SESSION_TYPE_NORMAL) {
 		/* Leave all non-normal sessions on the acceptor
 		 * thread. */
 		return;
 	}
+
+	pthread_mutex_lock(&conn->sess->lock);
+	leading = conn->sess->conns[0] == conn;
+	pthread_mutex_unlock(&conn->sess->lock);
+
 	pthread_mutex_lock(&g_iscsi.mutex);
 
 	target = conn->sess->target;
 	pthread_mutex_lock(&target->mutex);
 	target->num_active_conns++;
-	if (target->num_active_conns == 1) {
+	if (g_iscsi.conn_placement == ISCSI_CONN_PLACEMENT_LOAD) {
 		/**
-		 * This is the only active connection for this target node.
+		 * LUNs can be used from multiple threads. Place every connection,
+		 *  even of the same session, on the least loaded poll group.
+		 */
+		pg = iscsi_get_least_loaded_pg();
+		assert(pg != NULL);
+	} else if (target->num_active_conns == 1 || !leading) {
+		/**
+		 * This is the only active connection for this target node, or
+		 *  an additional connection of a session, which is spread over
+		 *  the poll groups so that the session can use several of them.
 		 *  Pick a poll group using round-robin.
 		 */
 		if (g_next_pg == NULL) {
@@ -1547,8 +1894,10 @@ iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 		pg = g_next_pg;
 		g_next_pg = TAILQ_NEXT(g_next_pg, link);
 
-		/* Save the pg in the target node so it can be used for any other connections to this target node. */
-		target->pg = pg;
+		if (target->num_active_conns == 1) {
+			/* Save the pg in the target node so it can be used for any other connections to this target node. */
+			target->pg = pg;
+		}
 	} else {
 		/**
 		 * There are other active connections for this target node.
@@ -1557,20 +1906,201 @@ iscsi_conn_schedule(struct spdk_iscsi_conn *conn)
 	}
 
 	pthread_mutex_unlock(&target->mutex);
+	pg->num_conns++;
 	pthread_mutex_unlock(&g_iscsi.mutex);
 
+	conn->is_scheduled = true;
+
 	assert(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(conn->pg)) ==
 	       spdk_get_thread());
 
 	/* Remove this connection from the previous poll group */
 	iscsi_poll_group_remove_conn(conn->pg, conn);
 
-	conn->pg = pg;
+	__atomic_store_n(&conn->pg, pg, __ATOMIC_RELEASE);
 
 	spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(pg)),
 			     iscsi_conn_full_feature_migrate, conn);
 }
 
+static bool
+iscsi_conn_is_quiesced(struct spdk_iscsi_conn *conn)
+{
+	struct spdk_iscsi_lun *iscsi_lun;
+
+	if (!iscsi_conn_is_quiescing(conn) ||
+	    conn->pending_task_cnt != 0 ||
+	    !TAILQ_EMPTY(&conn->write_pdu_list) ||
+	    !TAILQ_EMPTY(&conn->queued_datain_tasks)) {
+		return false;
+	}
+
+	/* LUN hot removal is tied to the current thread. */
+	TAILQ_FOREACH(iscsi_lun, &conn->luns, tailq) {
+		if (iscsi_lun->remove_poller != NULL) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void
+iscsi_conn_migrate_cancel(struct spdk_iscsi_conn *conn)
+{
+	spdk_poller_unregister(&conn->migrate_timer);
+
+	pthread_mutex_lock(&g_iscsi.mutex);
+	assert(conn->migrate_pg->num_conns > 0);
+	conn->migrate_pg->num_conns--;
+	conn->pg->num_conns++;
+	pthread_mutex_unlock(&g_iscsi.mutex);
+
+	conn->migrate_pg = NULL;
+}
+
+static int
+iscsi_conn_check_migrate(void *arg)
+{
+	struct spdk_iscsi_conn *conn = arg;
+
+	if (conn->state != ISCSI_CONN_STATE_RUNNING || conn->logout_request_timer != NULL ||
+	    conn->is_logged_out) {
+		/* The connection is going away. There is no point in moving it. */
+		iscsi_conn_migrate_cancel(conn);
+		return SPDK_POLLER_BUSY;
+	}
+
+	if (!iscsi_conn_is_quiesced(conn)) {
+		if (spdk_get_ticks() > conn->migrate_timeout_tsc) {
+			SPDK_DEBUGLOG(iscsi, "conn %d did not quiesce, cancel migration\n", conn->id);
+			iscsi_conn_migrate_cancel(conn);
+		}
+		return SPDK_POLLER_BUSY;
+	}
+
+	spdk_poller_unregister(&conn->migrate_timer);
+
+	SPDK_DEBUGLOG(iscsi, "Migrate conn %d to poll group %p\n", conn->id, conn->migrate_pg);
+
+	/* Every task of this connection has completed and no PDU is in flight.
+	 *  Release the resources tied to the current thread and reopen them
+	 *  on the new one.
+	 */
+	iscsi_poll_group_remove_conn(conn->pg, conn);
+	iscsi_conn_close_luns(conn);
+
+	__atomic_store_n(&conn->pg, conn->migrate_pg, __ATOMIC_RELEASE);
+	conn->migrate_pg = NULL;
+
+	spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(conn->pg)),
+			     iscsi_conn_full_feature_migrate, conn);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/* Move a running connection to another poll group. The connection stops
+ *  reading new commands, waits until its outstanding tasks complete, and
+ *  then moves its socket and LUNs to the thread of the new poll group
+ *  between two PDUs.
+ *
+ * This function must be called on the thread of the current poll group.
+ */
+int
+iscsi_conn_migrate(struct spdk_iscsi_conn *conn, struct spdk_iscsi_poll_group *pg)
+{
+	assert(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(conn->pg)) ==
+	       spdk_get_thread());
+
+	if (conn->state != ISCSI_CONN_STATE_RUNNING || !conn->full_feature ||
+	    conn->sess == NULL || conn->sess->session_type != SESSION_TYPE_NORMAL) {
+		return -EINVAL;
+	}
+
+	if (conn->migrate_pg != NULL) {
+		return -EBUSY;
+	}
+
+	if (pg == conn->pg) {
+		return 0;
+	}
+
+	conn->migrate_timer = SPDK_POLLER_REGISTER(iscsi_conn_check_migrate, conn, 1000);
+	if (conn->migrate_timer == NULL) {
+		return -ENOMEM;
+	}
+
+	conn->migrate_timeout_tsc = spdk_get_ticks() +
+				    ISCSI_CONN_MIGRATE_TIMEOUT_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+
+	/* Account for the connection on the new poll group right away so that
+	 *  concurrent placement decisions see it.
+	 */
+	pthread_mutex_lock(&g_iscsi.mutex);
+	assert(conn->pg->num_conns > 0);
+	conn->pg->num_conns--;
+	pg->num_conns++;
+	pthread_mutex_unlock(&g_iscsi.mutex);
+
+	conn->migrate_pg = pg;
+
+	return 0;
+}
+
+/* Move one connection from this poll group to the least loaded poll group
+ *  if this poll group is significantly more loaded. Called periodically on
+ *  the thread of the poll group.
+ */
+void
+iscsi_poll_group_rebalance(struct spdk_iscsi_poll_group *pg)
+{
+	struct spdk_iscsi_poll_group *target_pg;
+	struct spdk_iscsi_conn *conn, *best = NULL;
+	uint32_t tasks, target_tasks, gap, load, best_load = 0;
+	bool imbalanced;
+
+	/* num_conns changes on any thread scheduling or moving connections, so decide
+	 *  while holding the lock.  Moving the only connection does not help anyone.
+	 */
+	pthread_mutex_lock(&g_iscsi.mutex);
+	target_pg = iscsi_get_least_loaded_pg();
+	imbalanced = target_pg != NULL && target_pg != pg && pg->num_conns >= 2 &&
+		     iscsi_poll_group_cmp_load(pg, target_pg) > 0;
+	pthread_mutex_unlock(&g_iscsi.mutex);
+
+	if (!imbalanced) {
+		return;
+	}
+
+	/* Pick the busiest connection whose move does not simply swap the roles
+	 *  of the two poll groups.
+	 */
+	tasks = pg->outstanding_tasks;
+	target_tasks = __atomic_load_n(&target_pg->outstanding_tasks, __ATOMIC_RELAXED);
+	gap = tasks > target_tasks ? tasks - target_tasks : 0;
+
+	STAILQ_FOREACH(conn, &pg->connections, pg_link) {
+		if (conn->migrate_pg != NULL || conn->state != ISCSI_CONN_STATE_RUNNING ||
+		    conn->sess == NULL) {
+			continue;
+		}
+
+		load = conn->pending_task_cnt + 1;
+		if (gap != 0 && load > gap / 2 + 1) {
+			continue;
+		}
+
+		if (best == NULL || load > best_load) {
+			best = conn;
+			best_load = load;
+		}
+	}
+
+	if (best != NULL) {
+		iscsi_conn_migrate(best, target_pg);
+	}
+}
+
 static int
 logout_timeout(void *arg)
 {
@@ -1615,14 +2145,24 @@ iscsi_conn_get_login_phase(struct spdk_iscsi_conn *conn)
 
 SPDK_TRACE_REGISTER_FN(iscsi_conn_trace, "iscsi_conn", TRACE_GROUP_ISCSI)
 {
+	/* A write may carry several PDUs, the object is the first one of them. */
+	struct spdk_trace_tpoint_opts opts[] = {
+		{
+			"ISCSI_WRITE_START", TRACE_ISCSI_FLUSH_WRITEBUF_START,
+			OWNER_ISCSI_CONN, OBJECT_ISCSI_PDU, 1,
+			{
+				{ "iovec", SPDK_TRACE_ARG_TYPE_INT, 8 },
+				{ "pdus", SPDK_TRACE_ARG_TYPE_INT, 8 }
+			}
+		},
+	};
+
 	spdk_trace_register_owner(OWNER_ISCSI_CONN, 'c');
 	spdk_trace_register_object(OBJECT_ISCSI_PDU, 'p');
 	spdk_trace_register_description("ISCSI_READ_DONE", TRACE_ISCSI_READ_FROM_SOCKET_DONE,
 					OWNER_ISCSI_CONN, OBJECT_NONE, 0,
 					SPDK_TRACE_ARG_TYPE_INT, "");
-	spdk_trace_register_description("ISCSI_WRITE_START", TRACE_ISCSI_FLUSH_WRITEBUF_START,
-					OWNER_ISCSI_CONN, OBJECT_ISCSI_PDU, 1,
-					SPDK_TRACE_ARG_TYPE_INT, "iovec");
+	spdk_trace_register_description_ext(opts, SPDK_COUNTOF(opts));
 	spdk_trace_register_description("ISCSI_WRITE_DONE", TRACE_ISCSI_FLUSH_WRITEBUF_DONE,
 					OWNER_ISCSI_CONN, OBJECT_ISCSI_PDU, 0,
 					SPDK_TRACE_ARG_TYPE_INT, "");
@@ -34,6 +34,11 @@ enum iscsi_pdu_recv_state {
 	/* Active connection waiting for any PDU header */
 	ISCSI_PDU_RECV_STATE_AWAIT_PDU_HDR,
 
+	/* Active connection holding a command until the commands with lower
+	 *  CmdSN on other connections of the session are delivered
+	 */
+	ISCSI_PDU_RECV_STATE_AWAIT_CMDSN,
+
 	/* Active connection waiting for payload */
 	ISCSI_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD,
 
@@ -52,9 +57,35 @@ struct spdk_iscsi_lun {
 	TAILQ_ENTRY(spdk_iscsi_lun)	tailq;
 };
 
+/* Same as the number of iovecs the socket layer flushes at once. */
+#define ISCSI_WRITE_BATCH_IOVCNT	64
+#define ISCSI_WRITE_BATCH_MAX_PDUS	32
+
+/*
+ * Several PDUs written by a single sock request.  Each PDU still completes
+ *  individually and in order when the request completes.
+ */
+struct iscsi_write_batch {
+	struct spdk_iscsi_conn		*conn;
+	STAILQ_ENTRY(iscsi_write_batch)	link;
+	int				num_pdus;
+	uint32_t			mapped_length;
+	struct spdk_iscsi_pdu		*pdus[ISCSI_WRITE_BATCH_MAX_PDUS];
+
+	/* The sock request ends with a 0 length iovec. Place the actual iovec immediately
+	 * after it. */
+	struct spdk_sock_request	sock_req;
+	struct iovec			iov[ISCSI_WRITE_BATCH_IOVCNT];
+};
+SPDK_STATIC_ASSERT(offsetof(struct iscsi_write_batch,
+			    sock_req) + sizeof(struct spdk_sock_request) == offsetof(struct iscsi_write_batch, iov),
+		   "Compiler inserted padding between iov and sock_req");
+
 struct spdk_iscsi_conn {
 	int				id;
 	int				is_valid;
+	/* Incremented each time the connection object is allocated. */
+	uint32_t			generation;
 	/*
 	 * All fields below this point are reinitialized each time the
 	 *  connection object is allocated.  Make sure to update the
@@ -162,6 +193,28 @@ struct spdk_iscsi_conn {
 
 	STAILQ_ENTRY(spdk_iscsi_conn) pg_link;
 	bool			is_stopped;  /* Set true when connection is stopped for migration */
+
+	/* Set once the connection is accounted in the num_conns of its poll group. */
+	bool				is_scheduled;
+
+	/* Poll group this connection is going to be migrated to once it is quiesced. */
+	struct spdk_iscsi_poll_group	*migrate_pg;
+
+	/* Timer used to wait for the connection to quiesce before migration. */
+	struct spdk_poller		*migrate_timer;
+	uint64_t			migrate_timeout_tsc;
+
+	/* Set while the connection is on the CmdSN waiter list of its session. */
+	bool				cmdsn_waiting;
+	TAILQ_ENTRY(spdk_iscsi_conn)	cmdsn_link;
+
+	/* PDUs written between iscsi_conn_write_batch_begin() and _end() are
+	 *  collected into write_batch and submitted by a single sock request.
+	 */
+	uint32_t					write_batch_depth;
+	struct iscsi_write_batch			*write_batch;
+	STAILQ_HEAD(, iscsi_write_batch)		free_write_batches;
+
 	TAILQ_HEAD(queued_r2t_tasks, spdk_iscsi_task)	queued_r2t_tasks;
 	TAILQ_HEAD(active_r2t_tasks, spdk_iscsi_task)	active_r2t_tasks;
 	TAILQ_HEAD(queued_datain_tasks, spdk_iscsi_task)	queued_datain_tasks;
@@ -183,6 +236,9 @@ int iscsi_conn_construct(struct spdk_iscsi_portal *portal, struct spdk_sock *soc
 void iscsi_conn_destruct(struct spdk_iscsi_conn *conn);
 void iscsi_conn_handle_nop(struct spdk_iscsi_conn *conn);
 void iscsi_conn_schedule(struct spdk_iscsi_conn *conn);
+int iscsi_conn_migrate(struct spdk_iscsi_conn *conn, struct spdk_iscsi_poll_group *pg);
+void iscsi_poll_group_rebalance(struct spdk_iscsi_poll_group *pg);
+void iscsi_sess_resume_cmdsn_waiters(struct spdk_iscsi_sess *sess);
 void iscsi_conn_logout(struct spdk_iscsi_conn *conn);
 int iscsi_drop_conns(struct spdk_iscsi_conn *conn,
 		     const char *conn_match, int drop_all);
@@ -204,4 +260,18 @@ void iscsi_conn_free_pdu(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pd
 
 void iscsi_conn_info_json(struct spdk_json_write_ctx *w, struct spdk_iscsi_conn *conn);
 void iscsi_conn_pdu_generic_complete(void *cb_arg);
+void iscsi_conn_write_batch_begin(struct spdk_iscsi_conn *conn);
+void iscsi_conn_write_batch_end(struct spdk_iscsi_conn *conn);
+
+/* A connection being migrated stops reading new PDUs once no Data-Out PDUs
+ *  are expected anymore, so that its outstanding tasks can drain.
+ */
+static inline bool
+iscsi_conn_is_quiescing(struct spdk_iscsi_conn *conn)
+{
+	return conn->migrate_pg != NULL &&
+	       conn->pdu_recv_state == ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY &&
+	       conn->pending_r2t == 0 &&
+	       TAILQ_EMPTY(&conn->queued_r2t_tasks);
+}
 #endif /* SPDK_ISCSI_CONN_H */
@@ -242,8 +242,7 @@ iscsi_reject(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu,
 	conn->StatSN++;
 
 	if (conn->sess != NULL) {
-		to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-		to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+		iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn, false);
 	} else {
 		to_be32(&rsph->exp_cmd_sn, 1);
 		to_be32(&rsph->max_cmd_sn, 1);
@@ -508,9 +507,31 @@ iscsi_free_sess(struct spdk_iscsi_sess *sess)
 	iscsi_param_free(sess->params);
 	free(sess->conns);
 	spdk_scsi_port_free(&sess->initiator_port);
+	pthread_mutex_destroy(&sess->lock);
 	spdk_mempool_put(g_iscsi.session_pool, (void *)sess);
 }
 
+/*
+ * Fill in ExpCmdSN and MaxCmdSN of a response PDU.  Responses which complete
+ *  a non-immediate command open the command window by one.  The connections
+ *  of a session may send responses from different threads.
+ */
+void
+iscsi_sess_fill_cmdsn(struct spdk_iscsi_sess *sess, uint32_t *exp_cmd_sn,
+		      uint32_t *max_cmd_sn, bool open_window)
+{
+	uint32_t MaxCmdSN;
+
+	if (open_window) {
+		MaxCmdSN = __atomic_add_fetch(&sess->MaxCmdSN, 1, __ATOMIC_RELAXED);
+	} else {
+		MaxCmdSN = __atomic_load_n(&sess->MaxCmdSN, __ATOMIC_RELAXED);
+	}
+
+	to_be32(exp_cmd_sn, __atomic_load_n(&sess->ExpCmdSN, __ATOMIC_RELAXED));
+	to_be32(max_cmd_sn, MaxCmdSN);
+}
+
 static int
 create_iscsi_sess(struct spdk_iscsi_conn *conn,
 		  struct spdk_iscsi_tgt_node *target,
@@ -553,6 +574,15 @@ create_iscsi_sess(struct spdk_iscsi_conn *conn,
 		return -ENOMEM;
 	}
 
+	rc = pthread_mutex_init(&sess->lock, NULL);
+	if (rc != 0) {
+		free(sess->conns);
+		spdk_mempool_put(g_iscsi.session_pool, (void *)sess);
+		SPDK_ERRLOG("pthread_mutex_init() failed\n");
+		return -rc;
+	}
+	TAILQ_INIT(&sess->cmdsn_waiters);
+
 	sess->connections = 0;
 
 	sess->conns[sess->connections] = conn;
@@ -714,12 +744,13 @@ append_iscsi_sess(struct spdk_iscsi_conn *conn,
 	SPDK_DEBUGLOG(iscsi, "Connections (tsih %d): %d\n", sess->tsih, sess->connections);
 	conn->sess = sess;
 
-	/*
-	 * TODO: need a mutex or other sync mechanism to protect the session's
-	 *  connection list.
+	/* Other connections of the session read the connection count when they
+	 *  order their commands by CmdSN.
 	 */
+	pthread_mutex_lock(&sess->lock);
 	sess->conns[sess->connections] = conn;
 	sess->connections++;
+	pthread_mutex_unlock(&sess->lock);
 
 	return 0;
 }
@@ -1157,8 +1188,7 @@ iscsi_op_login_response(struct spdk_iscsi_conn *conn,
 	conn->StatSN++;
 
 	if (conn->sess != NULL) {
-		to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-		to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+		iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn, false);
 	} else {
 		to_be32(&rsph->exp_cmd_sn, rsp_pdu->cmd_sn);
 		to_be32(&rsph->max_cmd_sn, rsp_pdu->cmd_sn);
@@ -2437,12 +2467,8 @@ iscsi_pdu_payload_op_text(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *p
 	to_be32(&rsph->stat_sn, conn->StatSN);
 	conn->StatSN++;
 
-	if (reqh->immediate == 0) {
-		conn->sess->MaxCmdSN++;
-	}
-
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+			      reqh->immediate == 0);
 
 	iscsi_conn_write_pdu(conn, rsp_pdu, iscsi_conn_text_pdu_complete, conn);
 	return 0;
@@ -2563,12 +2589,8 @@ iscsi_pdu_hdr_op_logout(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu
 		to_be32(&rsph->stat_sn, conn->StatSN);
 		conn->StatSN++;
 
-		if (conn->sess->connections == 1) {
-			conn->sess->MaxCmdSN++;
-		}
-
-		to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-		to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+		iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+				      conn->sess->connections == 1);
 	} else {
 		to_be32(&rsph->stat_sn, conn->StatSN);
 		conn->StatSN++;
@@ -2608,8 +2630,7 @@ iscsi_send_r2t(struct spdk_iscsi_conn *conn,
 	to_be32(&rsph->ttt, transfer_tag);
 
 	to_be32(&rsph->stat_sn, conn->StatSN);
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn, false);
 
 	to_be32(&rsph->r2t_sn, *R2TSN);
 	*R2TSN += 1;
@@ -2950,12 +2971,8 @@ iscsi_send_datain(struct spdk_iscsi_conn *conn,
 		conn->StatSN++;
 	}
 
-	if (F_bit && S_bit && !iscsi_task_is_immediate(primary)) {
-		conn->sess->MaxCmdSN++;
-	}
-
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+			      F_bit && S_bit && !iscsi_task_is_immediate(primary));
 
 	to_be32(&rsph->data_sn, DataSN);
 
@@ -3165,12 +3182,8 @@ iscsi_task_response(struct spdk_iscsi_conn *conn,
 	to_be32(&rsph->stat_sn, conn->StatSN);
 	conn->StatSN++;
 
-	if (!iscsi_task_is_immediate(primary)) {
-		conn->sess->MaxCmdSN++;
-	}
-
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+			      !iscsi_task_is_immediate(primary));
 
 	to_be32(&rsph->bi_read_res_cnt, 0);
 	to_be32(&rsph->res_cnt, residual_len);
@@ -3515,12 +3528,8 @@ iscsi_task_mgmt_response(struct spdk_iscsi_conn *conn,
 	to_be32(&rsph->stat_sn, conn->StatSN);
 	conn->StatSN++;
 
-	if (reqh->immediate == 0) {
-		conn->sess->MaxCmdSN++;
-	}
-
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+			      reqh->immediate == 0);
 
 	iscsi_conn_write_pdu(conn, rsp_pdu, iscsi_conn_pdu_generic_complete, NULL);
 }
@@ -3812,12 +3821,8 @@ iscsi_pdu_payload_op_nopout(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu
 	to_be32(&rsph->stat_sn, conn->StatSN);
 	conn->StatSN++;
 
-	if (I_bit == 0) {
-		conn->sess->MaxCmdSN++;
-	}
-
-	to_be32(&rsph->exp_cmd_sn, conn->sess->ExpCmdSN);
-	to_be32(&rsph->max_cmd_sn, conn->sess->MaxCmdSN);
+	iscsi_sess_fill_cmdsn(conn->sess, &rsph->exp_cmd_sn, &rsph->max_cmd_sn,
+			      I_bit == 0);
 
 	iscsi_conn_write_pdu(conn, rsp_pdu, iscsi_conn_pdu_generic_complete, NULL);
 	conn->last_nopin = spdk_get_ticks();
@@ -4401,11 +4406,58 @@ remove_acked_pdu(struct spdk_iscsi_conn *conn, uint32_t ExpStatSN)
 	}
 }
 
+/* Data-Out and SNACK Request PDUs do not carry a CmdSN. */
+static inline bool
+iscsi_op_has_cmdsn(int opcode)
+{
+	return opcode != ISCSI_OP_SCSI_DATAOUT && opcode != ISCSI_OP_SNACK;
+}
+
+/*
+ * Commands of a session which has several connections have to be delivered
+ *  in CmdSN order even if the connections run on different poll groups.
+ *  Return true and put the connection on the waiter list of the session if
+ *  commands with lower CmdSN received on other connections are not
+ *  delivered yet.  The connection is resumed when ExpCmdSN advances.
+ */
+static bool
+iscsi_conn_wait_cmdsn(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
+{
+	struct spdk_iscsi_sess *sess = conn->sess;
+	struct iscsi_bhs_scsi_req *reqh;
+	uint32_t cmd_sn;
+	bool wait = false;
+
+	/* A connection joins a session only after its login completes, so an
+	 *  unlocked check is enough to skip single connection sessions.
+	 */
+	if (sess == NULL || spdk_likely(sess->connections <= 1) ||
+	    pdu->bhs.immediate || !iscsi_op_has_cmdsn(pdu->bhs.opcode)) {
+		return false;
+	}
+
+	reqh = (struct iscsi_bhs_scsi_req *)&pdu->bhs;
+	cmd_sn = from_be32(&reqh->cmd_sn);
+
+	pthread_mutex_lock(&sess->lock);
+	if (sess->connections > 1 && spdk_sn32_gt(cmd_sn, sess->ExpCmdSN) &&
+	    !spdk_sn32_gt(cmd_sn, __atomic_load_n(&sess->MaxCmdSN, __ATOMIC_RELAXED))) {
+		if (!conn->cmdsn_waiting) {
+			TAILQ_INSERT_TAIL(&sess->cmdsn_waiters, conn, cmdsn_link);
+			conn->cmdsn_waiting = true;
+		}
+		wait = true;
+	}
+	pthread_mutex_unlock(&sess->lock);
+
+	return wait;
+}
+
 static int
 iscsi_update_cmdsn(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 {
 	int opcode;
-	uint32_t ExpStatSN;
+	uint32_t ExpStatSN, ExpCmdSN, MaxCmdSN;
 	int I_bit;
 	struct spdk_iscsi_sess *sess;
 	struct iscsi_bhs_scsi_req *reqh;
@@ -4421,24 +4473,43 @@ iscsi_update_cmdsn(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 
 	pdu->cmd_sn = from_be32(&reqh->cmd_sn);
 
+	pthread_mutex_lock(&sess->lock);
+	ExpCmdSN = sess->ExpCmdSN;
+	MaxCmdSN = __atomic_load_n(&sess->MaxCmdSN, __ATOMIC_RELAXED);
+
 	I_bit = reqh->immediate;
 	if (I_bit == 0) {
-		if (spdk_sn32_lt(pdu->cmd_sn, sess->ExpCmdSN) ||
-		    spdk_sn32_gt(pdu->cmd_sn, sess->MaxCmdSN)) {
+		if (spdk_sn32_lt(pdu->cmd_sn, ExpCmdSN) ||
+		    spdk_sn32_gt(pdu->cmd_sn, MaxCmdSN)) {
 			if (sess->session_type == SESSION_TYPE_NORMAL &&
 			    opcode != ISCSI_OP_SCSI_DATAOUT) {
 				SPDK_ERRLOG("CmdSN(%u) ignore (ExpCmdSN=%u, MaxCmdSN=%u)\n",
-					    pdu->cmd_sn, sess->ExpCmdSN, sess->MaxCmdSN);
+					    pdu->cmd_sn, ExpCmdSN, MaxCmdSN);
 
 				if (sess->ErrorRecoveryLevel >= 1) {
 					SPDK_DEBUGLOG(iscsi, "Skip the error in ERL 1 and 2\n");
 				} else {
+					pthread_mutex_unlock(&sess->lock);
 					return SPDK_PDU_FATAL;
 				}
 			}
+		} else if (iscsi_op_has_cmdsn(opcode)) {
+			if (sess->connections > 1) {
+				/* Commands of a multi-connection session which are
+				 *  received ahead of ExpCmdSN wait in
+				 *  iscsi_conn_wait_cmdsn(), so they follow the last
+				 *  delivered one.
+				 */
+				sess->ExpCmdSN = pdu->cmd_sn + 1;
+			} else {
+				sess->ExpCmdSN++;
+			}
+			if (spdk_unlikely(!TAILQ_EMPTY(&sess->cmdsn_waiters))) {
+				iscsi_sess_resume_cmdsn_waiters(sess);
+			}
 		}
-	} else if (pdu->cmd_sn != sess->ExpCmdSN) {
-		SPDK_ERRLOG("CmdSN(%u) error ExpCmdSN=%u\n", pdu->cmd_sn, sess->ExpCmdSN);
+	} else if (pdu->cmd_sn != ExpCmdSN) {
+		SPDK_ERRLOG("CmdSN(%u) error ExpCmdSN=%u\n", pdu->cmd_sn, ExpCmdSN);
 
 		if (sess->ErrorRecoveryLevel >= 1) {
 			SPDK_DEBUGLOG(iscsi, "Skip the error in ERL 1 and 2\n");
@@ -4448,9 +4519,11 @@ iscsi_update_cmdsn(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 			 *  nopout under heavy load, so do not close the
 			 *  connection in that case.
 			 */
+			pthread_mutex_unlock(&sess->lock);
 			return SPDK_ISCSI_CONNECTION_FATAL;
 		}
 	}
+	pthread_mutex_unlock(&sess->lock);
 
 	ExpStatSN = from_be32(&reqh->exp_stat_sn);
 	if (spdk_sn32_gt(ExpStatSN, conn->StatSN)) {
@@ -4462,10 +4535,6 @@ iscsi_update_cmdsn(struct spdk_iscsi_conn *conn, struct spdk_iscsi_pdu *pdu)
 		remove_acked_pdu(conn, ExpStatSN);
 	}
 
-	if (!I_bit && opcode != ISCSI_OP_SCSI_DATAOUT) {
-		sess->ExpCmdSN++;
-	}
-
 	return 0;
 }
 
@@ -4817,6 +4886,13 @@ iscsi_read_pdu(struct spdk_iscsi_conn *conn)
 				}
 			}
 
+			conn->pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_CMDSN;
+			break;
+		case ISCSI_PDU_RECV_STATE_AWAIT_CMDSN:
+			if (spdk_unlikely(iscsi_conn_wait_cmdsn(conn, pdu))) {
+				return 0;
+			}
+
 			rc = iscsi_pdu_hdr_handle(conn, pdu);
 			if (rc < 0) {
 				SPDK_ERRLOG("Critical error is detected. Close the connection\n");
@@ -4877,6 +4953,10 @@ iscsi_handle_incoming_pdus(struct spdk_iscsi_conn *conn)
 
 	/* Read new PDUs from network */
 	for (i = 0; i < GET_PDU_LOOP_COUNT; i++) {
+		if (spdk_unlikely(iscsi_conn_is_quiescing(conn))) {
+			break;
+		}
+
 		rc = iscsi_read_pdu(conn);
 		if (rc == 0) {
 			break;
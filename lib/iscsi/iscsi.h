@@ -276,9 +276,18 @@ struct spdk_iscsi_sess {
 	bool DataSequenceInOrder;
 	uint32_t ErrorRecoveryLevel;
 
+	/*
+	 * Connections of a session may run on different poll groups.  The lock
+	 *  protects ExpCmdSN and the CmdSN waiters.  MaxCmdSN is only updated
+	 *  atomically when responses are sent.
+	 */
+	pthread_mutex_t lock;
 	uint32_t ExpCmdSN;
 	uint32_t MaxCmdSN;
 
+	/* Connections holding a command whose CmdSN is ahead of ExpCmdSN. */
+	TAILQ_HEAD(, spdk_iscsi_conn) cmdsn_waiters;
+
 	uint32_t current_text_itt;
 };
 
@@ -288,6 +297,30 @@ struct spdk_iscsi_poll_group {
 	STAILQ_HEAD(connections, spdk_iscsi_conn)	connections;
 	struct spdk_sock_group				*sock_group;
 	TAILQ_ENTRY(spdk_iscsi_poll_group)		link;
+
+	/*
+	 * Load statistics used for connection placement.  They are sampled by
+	 *  the poll group thread once per second and read atomically, without
+	 *  locking, by the threads scheduling connections.
+	 */
+	uint64_t					last_busy_tsc;
+	uint64_t					last_idle_tsc;
+	uint32_t					busy_pct;
+	uint32_t					outstanding_tasks;
+
+	/* Number of full feature connections assigned, protected by g_iscsi.mutex. */
+	uint32_t					num_conns;
+
+	/* Seconds elapsed since the last rebalance attempt. */
+	uint32_t					rebalance_ticks;
+};
+
+enum iscsi_conn_placement {
+	/* Spread targets over poll groups in round-robin order. */
+	ISCSI_CONN_PLACEMENT_ROUND_ROBIN = 0,
+
+	/* Place each connection on the least loaded poll group. */
+	ISCSI_CONN_PLACEMENT_LOAD = 1,
 };
 
 struct spdk_iscsi_opts {
@@ -314,6 +347,8 @@ struct spdk_iscsi_opts {
 	uint32_t pdu_pool_size;
 	uint32_t immediate_data_pool_size;
 	uint32_t data_out_pool_size;
+	enum iscsi_conn_placement conn_placement;
+	uint32_t conn_rebalance_interval;
 };
 
 struct spdk_iscsi_globals {
@@ -350,6 +385,8 @@ struct spdk_iscsi_globals {
 	uint32_t pdu_pool_size;
 	uint32_t immediate_data_pool_size;
 	uint32_t data_out_pool_size;
+	enum iscsi_conn_placement conn_placement;
+	uint32_t conn_rebalance_interval;
 
 	struct spdk_mempool *pdu_pool;
 	struct spdk_mempool *pdu_immediate_data_pool;
@@ -405,6 +442,8 @@ struct spdk_iscsi_opts *iscsi_opts_alloc(void);
 void iscsi_opts_free(struct spdk_iscsi_opts *opts);
 struct spdk_iscsi_opts *iscsi_opts_copy(struct spdk_iscsi_opts *src);
 void iscsi_opts_info_json(struct spdk_json_write_ctx *w);
+const char *iscsi_conn_placement_str(enum iscsi_conn_placement placement);
+int iscsi_conn_placement_parse(const char *str, enum iscsi_conn_placement *placement);
 int iscsi_set_discovery_auth(bool disable_chap, bool require_chap,
 			     bool mutual_chap, int32_t chap_group);
 int iscsi_chap_get_authinfo(struct iscsi_chap_auth *auth, const char *authuser,
@@ -428,6 +467,8 @@ void iscsi_task_mgmt_response(struct spdk_iscsi_conn *conn,
 			      struct spdk_iscsi_task *task);
 
 void iscsi_free_sess(struct spdk_iscsi_sess *sess);
+void iscsi_sess_fill_cmdsn(struct spdk_iscsi_sess *sess, uint32_t *exp_cmd_sn,
+			   uint32_t *max_cmd_sn, bool open_window);
 void iscsi_clear_all_transfer_task(struct spdk_iscsi_conn *conn,
 				   struct spdk_scsi_lun *lun,
 				   struct spdk_iscsi_pdu *pdu);
@@ -40,6 +40,36 @@ mobj_ctor(struct spdk_mempool *mp, __attribute__((unused)) void *arg,
 			  ~ISCSI_DATA_BUFFER_MASK);
 }
 
+static const char *g_conn_placement_names[] = {
+	[ISCSI_CONN_PLACEMENT_ROUND_ROBIN] = "round_robin",
+	[ISCSI_CONN_PLACEMENT_LOAD] = "load",
+};
+
+const char *
+iscsi_conn_placement_str(enum iscsi_conn_placement placement)
+{
+	if ((size_t)placement >= SPDK_COUNTOF(g_conn_placement_names)) {
+		return "unknown";
+	}
+
+	return g_conn_placement_names[placement];
+}
+
+int
+iscsi_conn_placement_parse(const char *str, enum iscsi_conn_placement *placement)
+{
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(g_conn_placement_names); i++) {
+		if (strcmp(str, g_conn_placement_names[i]) == 0) {
+			*placement = (enum iscsi_conn_placement)i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
 static int
 iscsi_initialize_pdu_pool(void)
 {
@@ -290,6 +320,11 @@ iscsi_log_globals(void)
 
 	SPDK_DEBUGLOG(iscsi, "MaxR2TPerConnection %d\n",
 		      g_iscsi.MaxR2TPerConnection);
+
+	SPDK_DEBUGLOG(iscsi, "ConnPlacement %s\n",
+		      iscsi_conn_placement_str(g_iscsi.conn_placement));
+	SPDK_DEBUGLOG(iscsi, "ConnRebalanceInterval %d\n",
+		      g_iscsi.conn_rebalance_interval);
 }
 
 #define NUM_PDU_PER_CONNECTION(opts)	(2 * (opts->MaxQueueDepth +	\
@@ -324,6 +359,8 @@ iscsi_opts_init(struct spdk_iscsi_opts *opts)
 	opts->pdu_pool_size = PDU_POOL_SIZE(opts);
 	opts->immediate_data_pool_size = IMMEDIATE_DATA_POOL_SIZE(opts);
 	opts->data_out_pool_size = DATA_OUT_POOL_SIZE(opts);
+	opts->conn_placement = ISCSI_CONN_PLACEMENT_ROUND_ROBIN;
+	opts->conn_rebalance_interval = 0;
 }
 
 struct spdk_iscsi_opts *
@@ -401,6 +438,8 @@ iscsi_opts_copy(struct spdk_iscsi_opts *src)
 	dst->pdu_pool_size = src->pdu_pool_size;
 	dst->immediate_data_pool_size = src->immediate_data_pool_size;
 	dst->data_out_pool_size = src->data_out_pool_size;
+	dst->conn_placement = src->conn_placement;
+	dst->conn_rebalance_interval = src->conn_rebalance_interval;
 
 	return dst;
 }
@@ -505,6 +544,13 @@ iscsi_opts_verify(struct spdk_iscsi_opts *opts)
 		return -EINVAL;
 	}
 
+	if (opts->conn_rebalance_interval != 0 &&
+	    opts->conn_placement != ISCSI_CONN_PLACEMENT_LOAD) {
+		SPDK_ERRLOG("conn_rebalance_interval requires conn_placement to be %s\n",
+			    iscsi_conn_placement_str(ISCSI_CONN_PLACEMENT_LOAD));
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -553,6 +599,8 @@ iscsi_set_global_params(struct spdk_iscsi_opts *opts)
 	g_iscsi.pdu_pool_size = opts->pdu_pool_size;
 	g_iscsi.immediate_data_pool_size = opts->immediate_data_pool_size;
 	g_iscsi.data_out_pool_size = opts->data_out_pool_size;
+	g_iscsi.conn_placement = opts->conn_placement;
+	g_iscsi.conn_rebalance_interval = opts->conn_rebalance_interval;
 
 	iscsi_log_globals();
 
@@ -974,6 +1022,35 @@ iscsi_poll_group_poll(void *ctx)
 	return rc != 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+static void
+iscsi_poll_group_update_load(struct spdk_iscsi_poll_group *group)
+{
+	struct spdk_iscsi_conn *conn;
+	struct spdk_thread_stats stats;
+	uint64_t busy_tsc, idle_tsc;
+	uint32_t outstanding_tasks = 0;
+
+	/* Each poll group runs on its own SPDK thread, so the thread statistics
+	 *  reflect the time spent on polling this group only.
+	 */
+	if (spdk_thread_get_stats(&stats) == 0) {
+		busy_tsc = stats.busy_tsc - group->last_busy_tsc;
+		idle_tsc = stats.idle_tsc - group->last_idle_tsc;
+		group->last_busy_tsc = stats.busy_tsc;
+		group->last_idle_tsc = stats.idle_tsc;
+
+		if (busy_tsc + idle_tsc != 0) {
+			__atomic_store_n(&group->busy_pct, busy_tsc * 100 / (busy_tsc + idle_tsc),
+					 __ATOMIC_RELAXED);
+		}
+	}
+
+	STAILQ_FOREACH(conn, &group->connections, pg_link) {
+		outstanding_tasks += conn->pending_task_cnt;
+	}
+	__atomic_store_n(&group->outstanding_tasks, outstanding_tasks, __ATOMIC_RELAXED);
+}
+
 static int
 iscsi_poll_group_handle_nop(void *ctx)
 {
@@ -984,6 +1061,16 @@ iscsi_poll_group_handle_nop(void *ctx)
 		iscsi_conn_handle_nop(conn);
 	}
 
+	if (g_iscsi.conn_placement == ISCSI_CONN_PLACEMENT_LOAD) {
+		iscsi_poll_group_update_load(group);
+
+		if (g_iscsi.conn_rebalance_interval != 0 &&
+		    ++group->rebalance_ticks >= g_iscsi.conn_rebalance_interval) {
+			group->rebalance_ticks = 0;
+			iscsi_poll_group_rebalance(group);
+		}
+	}
+
 	return SPDK_POLLER_BUSY;
 }
 
@@ -1261,6 +1348,11 @@ iscsi_opts_info_json(struct spdk_json_write_ctx *w)
 				     g_iscsi.immediate_data_pool_size);
 	spdk_json_write_named_uint32(w, "data_out_pool_size", g_iscsi.data_out_pool_size);
 
+	spdk_json_write_named_string(w, "conn_placement",
+				     iscsi_conn_placement_str(g_iscsi.conn_placement));
+	spdk_json_write_named_uint32(w, "conn_rebalance_interval",
+				     g_iscsi.conn_rebalance_interval);
+
 	spdk_json_write_object_end(w);
 }
 
@@ -7,8 +7,115 @@
 
 #include "spdk_internal/utf.h"
 
+#if defined(__SSE2__)
+#include <x86intrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #define SPDK_JSON_MAX_NESTING_DEPTH	64
 
+static inline bool
+json_char_is_plain(uint8_t c)
+{
+	return c >= 0x20 && c < 0x80 && c != '"' && c != '\\';
+}
+
+static inline bool
+json_char_is_whitespace(uint8_t c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/*
+ * Return the number of plain characters (printable ASCII other than quotes and backslashes) at
+ *  the beginning of str.  These make up most of the strings and don't need any decoding or UTF-8
+ *  validation, so they are looked for 16 bytes at a time where possible.
+ */
+static inline size_t
+json_plain_len(const uint8_t *str, const uint8_t *buf_end)
+{
+	const uint8_t *p = str;
+#if defined(__SSE2__)
+	__m128i v, special;
+	int mask;
+
+	while (buf_end - p >= 16) {
+		v = _mm_loadu_si128((const __m128i *)p);
+		/* Signed comparison catches both control characters and non-ASCII bytes */
+		special = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20)),
+				       _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+						    _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+		mask = _mm_movemask_epi8(special);
+		if (mask != 0) {
+			return p - str + __builtin_ctz(mask);
+		}
+		p += 16;
+	}
+#elif defined(__aarch64__)
+	uint8x16_t v, special;
+
+	while (buf_end - p >= 16) {
+		v = vld1q_u8(p);
+		special = vorrq_u8(vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vcgeq_u8(v, vdupq_n_u8(0x80))),
+				   vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+		if (vmaxvq_u8(special) != 0) {
+			/* The scalar loop below finds the exact position */
+			break;
+		}
+		p += 16;
+	}
+#endif
+
+	while (p < buf_end && json_char_is_plain(*p)) {
+		p++;
+	}
+
+	return p - str;
+}
+
+/* Return the number of whitespace characters at the beginning of data */
+static inline size_t
+json_whitespace_len(const uint8_t *data, const uint8_t *buf_end)
+{
+	const uint8_t *p = data;
+#if defined(__SSE2__)
+	__m128i v, ws;
+	int mask;
+
+	while (buf_end - p >= 16) {
+		v = _mm_loadu_si128((const __m128i *)p);
+		ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+					       _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+				  _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+					       _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+		mask = _mm_movemask_epi8(ws) ^ 0xffff;
+		if (mask != 0) {
+			return p - data + __builtin_ctz(mask);
+		}
+		p += 16;
+	}
+#elif defined(__aarch64__)
+	uint8x16_t v, ws;
+
+	while (buf_end - p >= 16) {
+		v = vld1q_u8(p);
+		ws = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+			      vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')), vceqq_u8(v, vdupq_n_u8('\n'))));
+		if (vminvq_u8(ws) == 0) {
+			break;
+		}
+		p += 16;
+	}
+#endif
+
+	while (p < buf_end && json_char_is_whitespace(*p)) {
+		p++;
+	}
+
+	return p - data;
+}
+
 static int
 hex_value(uint8_t c)
 {
@@ -171,6 +278,7 @@ json_decode_string(uint8_t *str_start, uint8_t *buf_end, uint8_t **str_end, uint
 {
 	uint8_t *str = str_start;
 	uint8_t *out = str_start + 1; /* Decode string in place (skip the initial quote) */
+	size_t len;
 	int rc;
 
 	if (buf_end - str_start < 2) {
@@ -188,6 +296,18 @@ json_decode_string(uint8_t *str_start, uint8_t *buf_end, uint8_t **str_end, uint
 	}
 
 	while (str < buf_end) {
+		len = json_plain_len(str, buf_end);
+		if (len > 0) {
+			if (out != str && (flags & SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE)) {
+				memmove(out, str, len);
+			}
+			out += len;
+			str += len;
+			if (str == buf_end) {
+				break;
+			}
+		}
+
 		if (str[0] == '"') {
 			/*
 			 * End of string.
@@ -452,7 +572,7 @@ spdk_json_parse(void *json, size_t size, struct spdk_json_val *values, size_t nu
 		case '\r':
 		case '\n':
 			/* Whitespace is allowed between any tokens. */
-			data++;
+			data += json_whitespace_len(data, json_end);
 			break;
 
 		case 't':
@@ -601,15 +721,7 @@ spdk_json_parse(void *json, size_t size, struct spdk_json_val *values, size_t nu
 
 	if (state == STATE_END) {
 		/* Skip trailing whitespace */
-		while (data < json_end) {
-			uint8_t c = *data;
-
-			if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-				data++;
-			} else {
-				break;
-			}
-		}
+		data += json_whitespace_len(data, json_end);
 
 		/*
 		 * These asserts are just for sanity checking - they are guaranteed by the allowed
@@ -7,6 +7,7 @@
 
 #include "spdk_internal/utf.h"
 #include "spdk/log.h"
+#include "spdk/util.h"
 
 #define SPDK_JSON_DEBUG(...) SPDK_DEBUGLOG(json_util, __VA_ARGS__)
 
@@ -292,6 +293,71 @@ spdk_json_number_to_uint64(const struct spdk_json_val *val, uint64_t *num)
 	return 0;
 }
 
+/*
+ * Objects decoded with at least this many decoders look the keys up in a hash table of the
+ * decoder names, instead of comparing each key against all of the names.
+ */
+#define JSON_DECODE_HASH_MIN_DECODERS	16
+
+static uint32_t
+json_decode_hash(const void *str, size_t len)
+{
+	const uint8_t *p = str;
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ p[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+ * Fill a hash table of hash_size (a power of two) slots with decoder indexes plus one, leaving 0
+ * for empty slots.  If a name is repeated, only the first decoder is used, like in linear lookup.
+ */
+static void
+json_decode_hash_init(uint32_t *hash, size_t hash_size,
+		      const struct spdk_json_object_decoder *decoders, size_t num_decoders)
+{
+	const struct spdk_json_object_decoder *dec;
+	size_t decidx, slot;
+
+	for (decidx = 0; decidx < num_decoders; decidx++) {
+		dec = &decoders[decidx];
+		slot = json_decode_hash(dec->name, strlen(dec->name)) & (hash_size - 1);
+		while (hash[slot] != 0 && strcmp(decoders[hash[slot] - 1].name, dec->name) != 0) {
+			slot = (slot + 1) & (hash_size - 1);
+		}
+		if (hash[slot] == 0) {
+			hash[slot] = decidx + 1;
+		}
+	}
+}
+
+static size_t
+json_decode_hash_find(const uint32_t *hash, size_t hash_size, const struct spdk_json_val *name,
+		      const struct spdk_json_object_decoder *decoders, size_t num_decoders)
+{
+	size_t slot;
+
+	if (name->type != SPDK_JSON_VAL_NAME && name->type != SPDK_JSON_VAL_STRING) {
+		return num_decoders;
+	}
+
+	slot = json_decode_hash(name->start, name->len) & (hash_size - 1);
+	while (hash[slot] != 0) {
+		if (spdk_json_strequal(name, decoders[hash[slot] - 1].name)) {
+			return hash[slot] - 1;
+		}
+		slot = (slot + 1) & (hash_size - 1);
+	}
+
+	return num_decoders;
+}
+
 static int
 _json_decode_object(const struct spdk_json_val *values,
 		    const struct spdk_json_object_decoder *decoders, size_t num_decoders, void *out, bool relaxed)
@@ -299,15 +365,28 @@ _json_decode_object(const struct spdk_json_val *values,
 	uint32_t i;
 	bool invalid = false;
 	size_t decidx;
+	uint32_t *hash = NULL;
+	size_t hash_size = 0;
 	bool *seen;
 
 	if (values == NULL || values->type != SPDK_JSON_VAL_OBJECT_BEGIN) {
 		return -1;
 	}
 
-	seen = calloc(sizeof(bool), num_decoders);
-	if (seen == NULL) {
-		return -1;
+	if (num_decoders >= JSON_DECODE_HASH_MIN_DECODERS) {
+		/* Keep the table at most half full */
+		hash_size = spdk_align64pow2(num_decoders * 2);
+		hash = calloc(1, hash_size * sizeof(*hash) + num_decoders * sizeof(bool));
+		if (hash == NULL) {
+			return -1;
+		}
+		json_decode_hash_init(hash, hash_size, decoders, num_decoders);
+		seen = (bool *)&hash[hash_size];
+	} else {
+		seen = calloc(sizeof(bool), num_decoders);
+		if (seen == NULL) {
+			return -1;
+		}
 	}
 
 	for (i = 0; i < values->len;) {
@@ -315,7 +394,13 @@ _json_decode_object(const struct spdk_json_val *values,
 		const struct spdk_json_val *v = &values[i + 2];
 		bool found = false;
 
-		for (decidx = 0; decidx < num_decoders; decidx++) {
+		if (hash != NULL) {
+			decidx = json_decode_hash_find(hash, hash_size, name, decoders, num_decoders);
+		} else {
+			decidx = 0;
+		}
+
+		for (; decidx < num_decoders; decidx++) {
 			const struct spdk_json_object_decoder *dec = &decoders[decidx];
 			if (spdk_json_strequal(name, dec->name)) {
 				void *field = (void *)((uintptr_t)out + dec->offset);
@@ -354,7 +439,11 @@ _json_decode_object(const struct spdk_json_val *values,
 		}
 	}
 
-	free(seen);
+	if (hash != NULL) {
+		free(hash);
+	} else {
+		free(seen);
+	}
 	return invalid ? -1 : 0;
 }
 
@@ -20,6 +20,14 @@
 #define SPDK_JSONRPC_MAX_VALUES		1024
 #define SPDK_JSONRPC_CLIENT_MAX_VALUES		8192
 
+/* Part of a response queued for sending before the response was complete */
+struct jsonrpc_send_chunk {
+	uint8_t *buf;
+	size_t len;
+	size_t offset;
+	STAILQ_ENTRY(jsonrpc_send_chunk) link;
+};
+
 struct spdk_jsonrpc_request {
 	struct spdk_jsonrpc_server_conn *conn;
 
@@ -42,6 +50,17 @@ struct spdk_jsonrpc_request {
 
 	struct spdk_json_write_ctx *response;
 
+	/* The response is in the send queue while it's still being written.  The parts written
+	 * so far are queued in send_chunks, the last part stays in send_buf until the response
+	 * is complete.  Both flags and send_chunks are protected by conn->queue_lock.
+	 */
+	bool streaming;
+	bool complete;
+	STAILQ_HEAD(, jsonrpc_send_chunk) send_chunks;
+
+	/* Part of a streamed response being sent, only accessed from the server poll thread */
+	struct jsonrpc_send_chunk *send_chunk;
+
 	STAILQ_ENTRY(spdk_jsonrpc_request) link;
 };
 
@@ -120,6 +139,10 @@ void jsonrpc_server_handle_error(struct spdk_jsonrpc_request *request, int error
 /* Might be called from any thread */
 void jsonrpc_server_send_response(struct spdk_jsonrpc_request *request);
 
+/* Might be called from any thread */
+void jsonrpc_server_send_chunk(struct spdk_jsonrpc_request *request,
+			       struct jsonrpc_send_chunk *chunk);
+
 /* jsonrpc_server */
 int jsonrpc_parse_request(struct spdk_jsonrpc_server_conn *conn, const void *json,
 			  size_t size);
@@ -130,6 +153,8 @@ void jsonrpc_free_request(struct spdk_jsonrpc_request *request);
 /* Must be called only from server poll thread */
 void jsonrpc_complete_request(struct spdk_jsonrpc_request *request);
 
+void jsonrpc_free_send_chunk(struct jsonrpc_send_chunk *chunk);
+
 /*
  * Parse JSON data as RPC command response.
  *
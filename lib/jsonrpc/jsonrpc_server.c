@@ -192,6 +192,7 @@ jsonrpc_parse_request(struct spdk_jsonrpc_server_conn *conn, const void *json, s
 	pthread_spin_unlock(&conn->queue_lock);
 
 	request->conn = conn;
+	STAILQ_INIT(&request->send_chunks);
 
 	len = end - json;
 	request->recv_buffer = malloc(len + 1);
@@ -247,7 +248,7 @@ jsonrpc_parse_request(struct spdk_jsonrpc_server_conn *conn, const void *json, s
 	}
 
 	/* Decode a second time now that there is a full JSON value available. */
-	rc = spdk_json_parse(request->recv_buffer, size, request->values, request->values_cnt, &end,
+	rc = spdk_json_parse(request->recv_buffer, len, request->values, request->values_cnt, &end,
 			     SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
 	if (rc < 0 || rc > SPDK_JSONRPC_MAX_VALUES) {
 		SPDK_DEBUGLOG(rpc, "JSON parse error on second pass\n");
@@ -315,11 +316,21 @@ end_response(struct spdk_jsonrpc_request *request)
 	jsonrpc_server_send_response(request);
 }
 
+void
+jsonrpc_free_send_chunk(struct jsonrpc_send_chunk *chunk)
+{
+	if (chunk != NULL) {
+		free(chunk->buf);
+		free(chunk);
+	}
+}
+
 void
 jsonrpc_free_request(struct spdk_jsonrpc_request *request)
 {
 	struct spdk_jsonrpc_request *req;
 	struct spdk_jsonrpc_server_conn *conn;
+	struct jsonrpc_send_chunk *chunk;
 
 	if (!request) {
 		return;
@@ -341,6 +352,11 @@ jsonrpc_free_request(struct spdk_jsonrpc_request *request)
 		}
 		pthread_spin_unlock(&conn->queue_lock);
 	}
+	while ((chunk = STAILQ_FIRST(&request->send_chunks)) != NULL) {
+		STAILQ_REMOVE_HEAD(&request->send_chunks, link);
+		jsonrpc_free_send_chunk(chunk);
+	}
+	jsonrpc_free_send_chunk(request->send_chunk);
 	free(request->recv_buffer);
 	free(request->values);
 	free(request->send_buf);
@@ -350,7 +366,10 @@ jsonrpc_free_request(struct spdk_jsonrpc_request *request)
 void
 jsonrpc_complete_request(struct spdk_jsonrpc_request *request)
 {
-	jsonrpc_log(request->send_buf, "response: ");
+	/* Only the last part of a streamed response is left */
+	if (!request->streaming) {
+		jsonrpc_log(request->send_buf, "response: ");
+	}
 
 	jsonrpc_free_request(request);
 }
@@ -378,6 +397,45 @@ spdk_jsonrpc_end_result(struct spdk_jsonrpc_request *request, struct spdk_json_w
 	}
 }
 
+void
+spdk_jsonrpc_flush_result(struct spdk_jsonrpc_request *request, struct spdk_json_write_ctx *w)
+{
+	struct jsonrpc_send_chunk *chunk;
+	uint8_t *send_buf;
+
+	assert(w != NULL);
+	assert(w == request->response);
+
+	if (spdk_json_write_flush(w) != 0 || request->send_len == 0) {
+		return;
+	}
+
+	/* If there was no ID in request the response is skipped anyway. */
+	if (request->id == NULL || request->id->type == SPDK_JSON_VAL_NULL) {
+		request->send_len = 0;
+		return;
+	}
+
+	chunk = calloc(1, sizeof(*chunk));
+	/* Add extra byte for the null terminator. */
+	send_buf = malloc(SPDK_JSONRPC_SEND_BUF_SIZE_INIT + 1);
+	if (chunk == NULL || send_buf == NULL) {
+		/* Keep the response in send_buf, it will be sent once it's complete. */
+		free(chunk);
+		free(send_buf);
+		return;
+	}
+
+	chunk->buf = request->send_buf;
+	chunk->len = request->send_len;
+
+	request->send_buf = send_buf;
+	request->send_buf_size = SPDK_JSONRPC_SEND_BUF_SIZE_INIT;
+	request->send_len = 0;
+
+	jsonrpc_server_send_chunk(request, chunk);
+}
+
 void
 spdk_jsonrpc_send_bool_response(struct spdk_jsonrpc_request *request, bool value)
 {
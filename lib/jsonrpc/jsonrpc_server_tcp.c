@@ -78,13 +78,37 @@ jsonrpc_server_dequeue_request(struct spdk_jsonrpc_server_conn *conn)
 	return request;
 }
 
+/* Free a request of a closed connection, unless its response is still being written.  Such
+ * requests are only detached from the connection and freed once the response is complete.
+ */
+static void
+jsonrpc_server_drop_request(struct spdk_jsonrpc_server_conn *conn,
+			    struct spdk_jsonrpc_request *request)
+{
+	bool detached = false;
+
+	pthread_spin_lock(&conn->queue_lock);
+	if (request->streaming && !request->complete) {
+		request->conn = NULL;
+		conn->outstanding_requests--;
+		detached = true;
+	}
+	pthread_spin_unlock(&conn->queue_lock);
+
+	if (!detached) {
+		jsonrpc_free_request(request);
+	}
+}
+
 static void
 jsonrpc_server_free_conn_request(struct spdk_jsonrpc_server_conn *conn)
 {
 	struct spdk_jsonrpc_request *request;
 
-	jsonrpc_free_request(conn->send_request);
-	conn->send_request = NULL ;
+	if (conn->send_request != NULL) {
+		jsonrpc_server_drop_request(conn, conn->send_request);
+		conn->send_request = NULL;
+	}
 
 	pthread_spin_lock(&conn->queue_lock);
 	/* There might still be some requests being processed.
@@ -95,7 +119,7 @@ jsonrpc_server_free_conn_request(struct spdk_jsonrpc_server_conn *conn)
 	pthread_spin_unlock(&conn->queue_lock);
 
 	while ((request = jsonrpc_server_dequeue_request(conn)) != NULL) {
-		jsonrpc_free_request(request);
+		jsonrpc_server_drop_request(conn, request);
 	}
 }
 
@@ -327,11 +351,95 @@ jsonrpc_server_send_response(struct spdk_jsonrpc_request *request)
 
 	/* Queue the response to be sent */
 	pthread_spin_lock(&conn->queue_lock);
-	STAILQ_REMOVE(&conn->outstanding_queue, request, spdk_jsonrpc_request, link);
-	STAILQ_INSERT_TAIL(&conn->send_queue, request, link);
+	if (request->streaming) {
+		if (request->conn == NULL) {
+			/* The connection got closed while the response was being written */
+			pthread_spin_unlock(&conn->queue_lock);
+			jsonrpc_free_request(request);
+			return;
+		}
+
+		/* Already in the send queue, the rest of the response can be sent now */
+		request->complete = true;
+	} else {
+		STAILQ_REMOVE(&conn->outstanding_queue, request, spdk_jsonrpc_request, link);
+		STAILQ_INSERT_TAIL(&conn->send_queue, request, link);
+	}
 	pthread_spin_unlock(&conn->queue_lock);
 }
 
+void
+jsonrpc_server_send_chunk(struct spdk_jsonrpc_request *request, struct jsonrpc_send_chunk *chunk)
+{
+	struct spdk_jsonrpc_server_conn *conn = request->conn;
+
+	if (conn != NULL) {
+		pthread_spin_lock(&conn->queue_lock);
+		if (request->conn != NULL) {
+			STAILQ_INSERT_TAIL(&request->send_chunks, chunk, link);
+			if (!request->streaming) {
+				/* Queue the response to be sent while the rest of it is written */
+				request->streaming = true;
+				STAILQ_REMOVE(&conn->outstanding_queue, request, spdk_jsonrpc_request, link);
+				STAILQ_INSERT_TAIL(&conn->send_queue, request, link);
+			}
+			chunk = NULL;
+		}
+		pthread_spin_unlock(&conn->queue_lock);
+	}
+
+	/* Nobody to send it to if the connection is closed */
+	jsonrpc_free_send_chunk(chunk);
+}
+
+/* Send the parts of a streamed response queued so far.  Returns 1 once the response is complete
+ * and only its last part, in send_buf, is left, 0 if more parts are yet to be written.
+ */
+static int
+jsonrpc_server_conn_send_chunks(struct spdk_jsonrpc_server_conn *conn,
+				struct spdk_jsonrpc_request *request)
+{
+	struct jsonrpc_send_chunk *chunk;
+	bool complete;
+	ssize_t rc;
+
+	while (true) {
+		chunk = request->send_chunk;
+		if (chunk == NULL) {
+			pthread_spin_lock(&conn->queue_lock);
+			chunk = STAILQ_FIRST(&request->send_chunks);
+			if (chunk != NULL) {
+				STAILQ_REMOVE_HEAD(&request->send_chunks, link);
+			}
+			complete = request->complete;
+			pthread_spin_unlock(&conn->queue_lock);
+
+			if (chunk == NULL) {
+				return complete ? 1 : 0;
+			}
+			request->send_chunk = chunk;
+		}
+
+		rc = send(conn->sockfd, chunk->buf + chunk->offset, chunk->len - chunk->offset, 0);
+		if (rc < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+				return 0;
+			}
+
+			SPDK_DEBUGLOG(rpc, "send() failed: %s\n", spdk_strerror(errno));
+			return -1;
+		}
+
+		chunk->offset += rc;
+		if (chunk->offset < chunk->len) {
+			return 0;
+		}
+
+		request->send_chunk = NULL;
+		jsonrpc_free_send_chunk(chunk);
+	}
+}
+
 
 static int
 jsonrpc_server_conn_send(struct spdk_jsonrpc_server_conn *conn)
@@ -354,6 +462,13 @@ more:
 		return 0;
 	}
 
+	if (request->streaming) {
+		rc = jsonrpc_server_conn_send_chunks(conn, request);
+		if (rc <= 0) {
+			return rc;
+		}
+	}
+
 	if (request->send_offset == 0) {
 		/* A byte for the null terminator is included in the send buffer. */
 		request->send_buf[request->send_len] = '\0';
@@ -1201,7 +1201,8 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 {
 	struct spdk_nvme_cmd *cmd = &tr->req->cmd;
 	uintptr_t page_mask = page_size - 1;
-	uint64_t phys_addr;
+	uint64_t phys_addr = 0;
+	uint64_t mapping_length = 0;
 	uint32_t i;
 
 	SPDK_DEBUGLOG(nvme, "prp_index:%u virt_addr:%p len:%u\n",
@@ -1225,10 +1226,16 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 			return -EFAULT;
 		}
 
-		phys_addr = nvme_pcie_vtophys(ctrlr, virt_addr, NULL);
-		if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR)) {
-			SPDK_ERRLOG("vtophys(%p) failed\n", virt_addr);
-			return -EFAULT;
+		/* Only translate the buffer again once the previous physically contiguous part of it
+		 * is used up.
+		 */
+		if (mapping_length == 0) {
+			mapping_length = len;
+			phys_addr = nvme_pcie_vtophys(ctrlr, virt_addr, &mapping_length);
+			if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR)) {
+				SPDK_ERRLOG("vtophys(%p) failed\n", virt_addr);
+				return -EFAULT;
+			}
 		}
 
 		if (i == 0) {
@@ -1250,6 +1257,13 @@ nvme_pcie_prp_list_append(struct spdk_nvme_ctrlr *ctrlr, struct nvme_tracker *tr
 		virt_addr = (uint8_t *)virt_addr + seg_len;
 		len -= seg_len;
 		i++;
+
+		if (seg_len < mapping_length) {
+			phys_addr += seg_len;
+			mapping_length -= seg_len;
+		} else {
+			mapping_length = 0;
+		}
 	}
 
 	cmd->psdt = SPDK_NVME_PSDT_PRP;
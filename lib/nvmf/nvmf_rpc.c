@@ -13,6 +13,7 @@
 #include "spdk/string.h"
 #include "spdk/util.h"
 #include "spdk/bit_array.h"
+#include "spdk/thread.h"
 
 #include "spdk_internal/assert.h"
 
@@ -162,11 +163,27 @@ decode_ns_uuid(const struct spdk_json_val *val, void *out)
 struct rpc_get_subsystem {
 	char *nqn;
 	char *tgt_name;
+	uint32_t offset;
+	uint32_t limit;
 };
 
 static const struct spdk_json_object_decoder rpc_get_subsystem_decoders[] = {
 	{"nqn", offsetof(struct rpc_get_subsystem, nqn), spdk_json_decode_string, true},
 	{"tgt_name", offsetof(struct rpc_get_subsystem, tgt_name), spdk_json_decode_string, true},
+	{"offset", offsetof(struct rpc_get_subsystem, offset), spdk_json_decode_uint32, true},
+	{"limit", offsetof(struct rpc_get_subsystem, limit), spdk_json_decode_uint32, true},
+};
+
+/* Number of subsystems dumped before the response is flushed and other work is let in */
+#define RPC_NVMF_GET_SUBSYSTEMS_BATCH	64
+
+struct rpc_get_subsystems_ctx {
+	struct rpc_get_subsystem	rpc;
+	struct spdk_jsonrpc_request	*request;
+	struct spdk_json_write_ctx	*w;
+	char				**nqns;
+	uint32_t			num_nqns;
+	uint32_t			current;
 };
 
 static void
@@ -277,14 +294,100 @@ SPDK_LOG_DEPRECATION_REGISTER(rpc_nvmf_get_subsystems,
 			      "listener.transport is deprecated in favor of trtype",
 			      "v24.01", 0);
 
+static void
+free_rpc_get_subsystems_ctx(struct rpc_get_subsystems_ctx *ctx)
+{
+	uint32_t i;
+
+	for (i = 0; i < ctx->num_nqns; i++) {
+		free(ctx->nqns[i]);
+	}
+	free(ctx->nqns);
+	free(ctx->rpc.tgt_name);
+	free(ctx->rpc.nqn);
+	free(ctx);
+}
+
+/* Take the NQNs of the subsystems to list up front, the response is written in batches */
+static int
+rpc_get_subsystems_add_nqns(struct rpc_get_subsystems_ctx *ctx, struct spdk_nvmf_tgt *tgt)
+{
+	struct spdk_nvmf_subsystem *subsystem;
+	uint32_t skipped = 0, max_nqns = 0;
+	char **nqns;
+
+	for (subsystem = spdk_nvmf_subsystem_get_first(tgt); subsystem != NULL;
+	     subsystem = spdk_nvmf_subsystem_get_next(subsystem)) {
+		if (skipped < ctx->rpc.offset) {
+			skipped++;
+			continue;
+		}
+
+		if (ctx->rpc.limit != 0 && ctx->num_nqns == ctx->rpc.limit) {
+			break;
+		}
+
+		if (ctx->num_nqns == max_nqns) {
+			nqns = realloc(ctx->nqns, (max_nqns + RPC_NVMF_GET_SUBSYSTEMS_BATCH) * sizeof(*nqns));
+			if (nqns == NULL) {
+				return -ENOMEM;
+			}
+			ctx->nqns = nqns;
+			max_nqns += RPC_NVMF_GET_SUBSYSTEMS_BATCH;
+		}
+
+		ctx->nqns[ctx->num_nqns] = strdup(spdk_nvmf_subsystem_get_nqn(subsystem));
+		if (ctx->nqns[ctx->num_nqns] == NULL) {
+			return -ENOMEM;
+		}
+		ctx->num_nqns++;
+	}
+
+	return 0;
+}
+
+static void
+rpc_get_subsystems_list(void *_ctx)
+{
+	struct rpc_get_subsystems_ctx *ctx = _ctx;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct spdk_nvmf_tgt *tgt;
+	uint32_t end;
+
+	/* The target may be destroyed while the response is being written */
+	tgt = spdk_nvmf_get_tgt(ctx->rpc.tgt_name);
+	end = tgt != NULL ? spdk_min(ctx->current + RPC_NVMF_GET_SUBSYSTEMS_BATCH, ctx->num_nqns) :
+	      ctx->num_nqns;
+	for (; tgt != NULL && ctx->current < end; ctx->current++) {
+		/* Subsystems removed since the list was taken are skipped */
+		subsystem = spdk_nvmf_tgt_find_subsystem(tgt, ctx->nqns[ctx->current]);
+		if (subsystem != NULL) {
+			dump_nvmf_subsystem(ctx->w, subsystem);
+		}
+	}
+
+	if (ctx->current < ctx->num_nqns) {
+		/* Send what's been written so far and let other pollers and RPCs run */
+		spdk_jsonrpc_flush_result(ctx->request, ctx->w);
+		spdk_thread_send_msg(spdk_get_thread(), rpc_get_subsystems_list, ctx);
+		return;
+	}
+
+	spdk_json_write_array_end(ctx->w);
+	spdk_jsonrpc_end_result(ctx->request, ctx->w);
+	free_rpc_get_subsystems_ctx(ctx);
+}
+
 static void
 rpc_nvmf_get_subsystems(struct spdk_jsonrpc_request *request,
 			const struct spdk_json_val *params)
 {
 	struct rpc_get_subsystem req = { 0 };
+	struct rpc_get_subsystems_ctx *ctx;
 	struct spdk_json_write_ctx *w;
 	struct spdk_nvmf_subsystem *subsystem = NULL;
 	struct spdk_nvmf_tgt *tgt;
+	int rc;
 
 	/* Log only once */
 	if (!g_logged_deprecated_nvmf_get_subsystems) {
@@ -298,6 +401,8 @@ rpc_nvmf_get_subsystems(struct spdk_jsonrpc_request *request,
 					    &req)) {
 			SPDK_ERRLOG("spdk_json_decode_object failed\n");
 			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+			free(req.tgt_name);
+			free(req.nqn);
 			return;
 		}
 	}
@@ -312,6 +417,15 @@ rpc_nvmf_get_subsystems(struct spdk_jsonrpc_request *request,
 	}
 
 	if (req.nqn) {
+		if (req.offset != 0 || req.limit != 0) {
+			/* Paging only applies to the list of all subsystems */
+			spdk_jsonrpc_send_error_response(request, -EINVAL,
+							 "nqn can't be used with offset or limit");
+			free(req.tgt_name);
+			free(req.nqn);
+			return;
+		}
+
 		subsystem = spdk_nvmf_tgt_find_subsystem(tgt, req.nqn);
 		if (!subsystem) {
 			SPDK_ERRLOG("subsystem '%s' does not exist\n", req.nqn);
@@ -320,24 +434,38 @@ rpc_nvmf_get_subsystems(struct spdk_jsonrpc_request *request,
 			free(req.nqn);
 			return;
 		}
+
+		w = spdk_jsonrpc_begin_result(request);
+		spdk_json_write_array_begin(w);
+		dump_nvmf_subsystem(w, subsystem);
+		spdk_json_write_array_end(w);
+		spdk_jsonrpc_end_result(request, w);
+		free(req.tgt_name);
+		free(req.nqn);
+		return;
 	}
 
-	w = spdk_jsonrpc_begin_result(request);
-	spdk_json_write_array_begin(w);
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		free(req.tgt_name);
+		return;
+	}
 
-	if (subsystem) {
-		dump_nvmf_subsystem(w, subsystem);
-	} else {
-		for (subsystem = spdk_nvmf_subsystem_get_first(tgt); subsystem != NULL;
-		     subsystem = spdk_nvmf_subsystem_get_next(subsystem)) {
-			dump_nvmf_subsystem(w, subsystem);
-		}
+	ctx->rpc = req;
+	ctx->request = request;
+
+	rc = rpc_get_subsystems_add_nqns(ctx, tgt);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		free_rpc_get_subsystems_ctx(ctx);
+		return;
 	}
 
-	spdk_json_write_array_end(w);
-	spdk_jsonrpc_end_result(request, w);
-	free(req.tgt_name);
-	free(req.nqn);
+	ctx->w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(ctx->w);
+
+	rpc_get_subsystems_list(ctx);
 }
 SPDK_RPC_REGISTER("nvmf_get_subsystems", rpc_nvmf_get_subsystems, SPDK_RPC_RUNTIME)
 
@@ -14,11 +14,99 @@
 static void scsi_lun_execute_tasks(struct spdk_scsi_lun *lun);
 static void _scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun);
 
+static struct spdk_scsi_lun_channel *
+scsi_lun_first_channel(const struct spdk_scsi_lun *lun)
+{
+	/* Pairs with the release store in scsi_lun_get_channel(). */
+	return __atomic_load_n(&lun->channels, __ATOMIC_ACQUIRE);
+}
+
+static struct spdk_scsi_lun_channel *
+scsi_lun_find_channel(const struct spdk_scsi_lun *lun, const struct spdk_thread *thread)
+{
+	struct spdk_scsi_lun_channel *ch;
+
+	for (ch = scsi_lun_first_channel(lun); ch != NULL; ch = ch->next) {
+		if (ch->thread == thread) {
+			return ch;
+		}
+	}
+
+	return NULL;
+}
+
+/* Get the channel of the calling thread, and create it at the first use. */
+static struct spdk_scsi_lun_channel *
+scsi_lun_get_channel(struct spdk_scsi_lun *lun)
+{
+	struct spdk_thread *thread = spdk_get_thread();
+	struct spdk_scsi_lun_channel *ch;
+
+	ch = scsi_lun_find_channel(lun, thread);
+	if (spdk_likely(ch != NULL)) {
+		return ch;
+	}
+
+	ch = calloc(1, sizeof(*ch));
+	if (ch == NULL) {
+		SPDK_ERRLOG("could not allocate channel for lun %s\n",
+			    spdk_bdev_get_name(lun->bdev));
+		return NULL;
+	}
+
+	ch->lun = lun;
+	ch->thread = thread;
+	TAILQ_INIT(&ch->tasks);
+	TAILQ_INIT(&ch->pending_tasks);
+
+	/* Only the calling thread adds its own channel, hence no duplicate can
+	 * be added in the meantime.  Readers walk the list without the lock.
+	 */
+	pthread_mutex_lock(&lun->mutex);
+	ch->next = lun->channels;
+	__atomic_store_n(&lun->channels, ch, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return ch;
+}
+
+static void
+scsi_lun_free_channels(struct spdk_scsi_lun *lun)
+{
+	struct spdk_scsi_lun_channel *ch, *tmp;
+
+	for (ch = lun->channels; ch != NULL; ch = tmp) {
+		tmp = ch->next;
+		assert(ch->io_channel == NULL);
+		assert(TAILQ_EMPTY(&ch->tasks));
+		assert(TAILQ_EMPTY(&ch->pending_tasks));
+		free(ch);
+	}
+	lun->channels = NULL;
+}
+
+/* Task counters are written only by the owner thread but are read by any thread. */
+static inline void
+scsi_lun_channel_inc_outstanding(struct spdk_scsi_lun_channel *ch)
+{
+	__atomic_store_n(&ch->num_outstanding_tasks, ch->num_outstanding_tasks + 1,
+			 __ATOMIC_RELAXED);
+}
+
+static inline void
+scsi_lun_channel_dec_outstanding(struct spdk_scsi_lun_channel *ch)
+{
+	assert(ch->num_outstanding_tasks > 0);
+	__atomic_store_n(&ch->num_outstanding_tasks, ch->num_outstanding_tasks - 1,
+			 __ATOMIC_RELAXED);
+}
+
 void
 scsi_lun_complete_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 {
 	if (lun) {
-		TAILQ_REMOVE(&lun->tasks, task, scsi_link);
+		TAILQ_REMOVE(&task->lun_ch->tasks, task, scsi_link);
+		scsi_lun_channel_dec_outstanding(task->lun_ch);
 		spdk_trace_record(TRACE_SCSI_TASK_DONE, lun->dev->id, 0, (uintptr_t)task);
 	}
 	task->cpl_fn(task);
@@ -27,7 +115,9 @@ scsi_lun_complete_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 static void
 scsi_lun_complete_mgmt_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 {
+	pthread_mutex_lock(&lun->mutex);
 	TAILQ_REMOVE(&lun->mgmt_tasks, task, scsi_link);
+	pthread_mutex_unlock(&lun->mutex);
 
 	task->cpl_fn(task);
 
@@ -47,16 +137,52 @@ scsi_lun_has_outstanding_mgmt_tasks(const struct spdk_scsi_lun *lun)
 	return !TAILQ_EMPTY(&lun->mgmt_tasks);
 }
 
+/* Lockless check used by the IO fast path. */
+static bool
+scsi_lun_has_queued_mgmt_tasks(const struct spdk_scsi_lun *lun)
+{
+	return __atomic_load_n(&lun->num_pending_mgmt_tasks, __ATOMIC_SEQ_CST) != 0;
+}
+
+static bool
+scsi_lun_has_submitted_mgmt_tasks(struct spdk_scsi_lun *lun)
+{
+	bool ret;
+
+	pthread_mutex_lock(&lun->mutex);
+	ret = scsi_lun_has_outstanding_mgmt_tasks(lun);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return ret;
+}
+
 static bool
 _scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun)
 {
-	return !TAILQ_EMPTY(&lun->pending_tasks);
+	struct spdk_scsi_lun_channel *ch;
+
+	for (ch = scsi_lun_first_channel(lun); ch != NULL; ch = ch->next) {
+		if (__atomic_load_n(&ch->num_pending_tasks, __ATOMIC_SEQ_CST) != 0) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
+/* Aggregate the outstanding tasks of all channels. */
 static bool
 scsi_lun_has_outstanding_tasks(const struct spdk_scsi_lun *lun)
 {
-	return !TAILQ_EMPTY(&lun->tasks);
+	struct spdk_scsi_lun_channel *ch;
+
+	for (ch = scsi_lun_first_channel(lun); ch != NULL; ch = ch->next) {
+		if (__atomic_load_n(&ch->num_outstanding_tasks, __ATOMIC_RELAXED) != 0) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 /* Reset task have to wait until all prior outstanding tasks complete. */
@@ -94,7 +220,10 @@ static void
 scsi_lun_append_mgmt_task(struct spdk_scsi_lun *lun,
 			  struct spdk_scsi_task *task)
 {
+	pthread_mutex_lock(&lun->mutex);
 	TAILQ_INSERT_TAIL(&lun->pending_mgmt_tasks, task, scsi_link);
+	__atomic_fetch_add(&lun->num_pending_mgmt_tasks, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&lun->mutex);
 }
 
 static bool
@@ -115,23 +244,9 @@ _scsi_lun_handle_unit_attention(struct spdk_scsi_task *task)
 }
 
 static void
-_scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun)
+scsi_lun_run_mgmt_task(struct spdk_scsi_task *task)
 {
-	struct spdk_scsi_task *task;
-
-	if (!TAILQ_EMPTY(&lun->mgmt_tasks)) {
-		return;
-	}
-
-	task = TAILQ_FIRST(&lun->pending_mgmt_tasks);
-	if (spdk_likely(task == NULL)) {
-		/* Try to execute all pending tasks */
-		scsi_lun_execute_tasks(lun);
-		return;
-	}
-	TAILQ_REMOVE(&lun->pending_mgmt_tasks, task, scsi_link);
-
-	TAILQ_INSERT_TAIL(&lun->mgmt_tasks, task, scsi_link);
+	struct spdk_scsi_lun *lun = task->lun_ch->lun;
 
 	if (lun->removed) {
 		task->response = SPDK_SCSI_TASK_MGMT_RESP_INVALID_LUN;
@@ -168,39 +283,84 @@ _scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun)
 	scsi_lun_complete_mgmt_task(lun, task);
 }
 
+static void
+_scsi_lun_run_mgmt_task(void *arg)
+{
+	scsi_lun_run_mgmt_task((struct spdk_scsi_task *)arg);
+}
+
+static void
+_scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun)
+{
+	struct spdk_scsi_task *task;
+
+	pthread_mutex_lock(&lun->mutex);
+	if (!TAILQ_EMPTY(&lun->mgmt_tasks)) {
+		pthread_mutex_unlock(&lun->mutex);
+		return;
+	}
+
+	task = TAILQ_FIRST(&lun->pending_mgmt_tasks);
+	if (spdk_likely(task == NULL)) {
+		pthread_mutex_unlock(&lun->mutex);
+		/* Try to execute all pending tasks */
+		scsi_lun_execute_tasks(lun);
+		return;
+	}
+	TAILQ_REMOVE(&lun->pending_mgmt_tasks, task, scsi_link);
+	__atomic_fetch_sub(&lun->num_pending_mgmt_tasks, 1, __ATOMIC_SEQ_CST);
+
+	TAILQ_INSERT_TAIL(&lun->mgmt_tasks, task, scsi_link);
+	pthread_mutex_unlock(&lun->mutex);
+
+	/* The task runs and completes on the thread which submitted it. */
+	if (task->lun_ch->thread != spdk_get_thread()) {
+		spdk_thread_send_msg(task->lun_ch->thread, _scsi_lun_run_mgmt_task, task);
+	} else {
+		scsi_lun_run_mgmt_task(task);
+	}
+}
+
 void
 scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun,
 			   struct spdk_scsi_task *task)
 {
+	task->lun_ch = scsi_lun_get_channel(lun);
+	if (spdk_unlikely(task->lun_ch == NULL)) {
+		task->response = SPDK_SCSI_TASK_MGMT_RESP_TARGET_FAILURE;
+		task->cpl_fn(task);
+		return;
+	}
+
 	scsi_lun_append_mgmt_task(lun, task);
 	_scsi_lun_execute_mgmt_task(lun);
 }
 
 static void
-_scsi_lun_execute_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
+_scsi_lun_execute_task(struct spdk_scsi_lun_channel *ch, struct spdk_scsi_task *task)
 {
+	struct spdk_scsi_lun *lun = ch->lun;
 	int rc;
 
 	task->status = SPDK_SCSI_STATUS_GOOD;
 	spdk_trace_record(TRACE_SCSI_TASK_START, lun->dev->id, task->length, (uintptr_t)task);
-	TAILQ_INSERT_TAIL(&lun->tasks, task, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->tasks, task, scsi_link);
+	scsi_lun_channel_inc_outstanding(ch);
 	if (spdk_unlikely(lun->removed)) {
 		spdk_scsi_task_process_abort(task);
 		rc = SPDK_SCSI_TASK_COMPLETE;
-	} else if (spdk_unlikely(lun->resizing) && _scsi_lun_handle_unit_attention(task)) {
+	} else if (spdk_unlikely(__atomic_load_n(&lun->resizing, __ATOMIC_RELAXED)) &&
+		   _scsi_lun_handle_unit_attention(task) &&
+		   __atomic_exchange_n(&lun->resizing, false, __ATOMIC_RELAXED)) {
+		/* Only the task clearing the flag reports the unit attention */
 		spdk_scsi_task_set_status(task, SPDK_SCSI_STATUS_CHECK_CONDITION,
 					  SPDK_SCSI_SENSE_UNIT_ATTENTION,
 					  SPDK_SCSI_ASC_CAPACITY_DATA_HAS_CHANGED,
 					  SPDK_SCSI_ASCQ_CAPACITY_DATA_HAS_CHANGED);
-		lun->resizing = false;
 		rc = SPDK_SCSI_TASK_COMPLETE;
 	} else {
 		/* Check the command is allowed or not when reservation is exist */
-		if (spdk_unlikely(lun->reservation.flags & SCSI_SPC2_RESERVE)) {
-			rc = scsi2_reserve_check(task);
-		} else {
-			rc = scsi_pr_check(task);
-		}
+		rc = scsi_pr_check(task);
 		if (spdk_unlikely(rc < 0)) {
 			/* Reservation Conflict */
 			rc = SPDK_SCSI_TASK_COMPLETE;
@@ -223,40 +383,85 @@ _scsi_lun_execute_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 }
 
 static void
-scsi_lun_append_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
+scsi_lun_append_task(struct spdk_scsi_lun_channel *ch, struct spdk_scsi_task *task)
 {
-	TAILQ_INSERT_TAIL(&lun->pending_tasks, task, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->pending_tasks, task, scsi_link);
+	__atomic_fetch_add(&ch->num_pending_tasks, 1, __ATOMIC_SEQ_CST);
 }
 
 static void
-scsi_lun_execute_tasks(struct spdk_scsi_lun *lun)
+scsi_lun_channel_execute_tasks(struct spdk_scsi_lun_channel *ch)
 {
 	struct spdk_scsi_task *task, *task_tmp;
 
-	TAILQ_FOREACH_SAFE(task, &lun->pending_tasks, scsi_link, task_tmp) {
-		TAILQ_REMOVE(&lun->pending_tasks, task, scsi_link);
-		_scsi_lun_execute_task(lun, task);
+	TAILQ_FOREACH_SAFE(task, &ch->pending_tasks, scsi_link, task_tmp) {
+		TAILQ_REMOVE(&ch->pending_tasks, task, scsi_link);
+		__atomic_fetch_sub(&ch->num_pending_tasks, 1, __ATOMIC_SEQ_CST);
+		_scsi_lun_execute_task(ch, task);
+	}
+}
+
+static void
+_scsi_lun_channel_execute_tasks(void *arg)
+{
+	scsi_lun_channel_execute_tasks((struct spdk_scsi_lun_channel *)arg);
+}
+
+/* Execute pending tasks of all channels, each on its owner thread. */
+static void
+scsi_lun_execute_tasks(struct spdk_scsi_lun *lun)
+{
+	struct spdk_thread *thread = spdk_get_thread();
+	struct spdk_scsi_lun_channel *ch;
+
+	for (ch = scsi_lun_first_channel(lun); ch != NULL; ch = ch->next) {
+		if (__atomic_load_n(&ch->num_pending_tasks, __ATOMIC_SEQ_CST) == 0) {
+			continue;
+		}
+
+		if (ch->thread == thread) {
+			scsi_lun_channel_execute_tasks(ch);
+		} else {
+			spdk_thread_send_msg(ch->thread, _scsi_lun_channel_execute_tasks, ch);
+		}
 	}
 }
 
 void
 scsi_lun_execute_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task)
 {
-	if (spdk_unlikely(_scsi_lun_has_pending_mgmt_tasks(lun))) {
+	struct spdk_scsi_lun_channel *ch;
+
+	ch = scsi_lun_get_channel(lun);
+	if (spdk_unlikely(ch == NULL)) {
+		spdk_scsi_task_process_abort(task);
+		task->cpl_fn(task);
+		return;
+	}
+	task->lun_ch = ch;
+
+	if (spdk_unlikely(scsi_lun_has_queued_mgmt_tasks(lun))) {
 		/* Add the IO task to pending list and wait for completion of
 		 * existing mgmt tasks.
 		 */
-		scsi_lun_append_task(lun, task);
-	} else if (spdk_unlikely(_scsi_lun_has_pending_tasks(lun))) {
+		scsi_lun_append_task(ch, task);
+
+		/* The last pending mgmt task may have been started before the IO
+		 * task was visible to it. Execute pending IO tasks by ourselves then.
+		 */
+		if (!scsi_lun_has_queued_mgmt_tasks(lun)) {
+			scsi_lun_channel_execute_tasks(ch);
+		}
+	} else if (spdk_unlikely(!TAILQ_EMPTY(&ch->pending_tasks))) {
 		/* If there is any pending IO task, append the IO task to the
 		 * tail of the pending list, and then execute all pending IO tasks
 		 * from the head to submit IO tasks in order.
 		 */
-		scsi_lun_append_task(lun, task);
-		scsi_lun_execute_tasks(lun);
+		scsi_lun_append_task(ch, task);
+		scsi_lun_channel_execute_tasks(ch);
 	} else {
 		/* Execute the IO task directly. */
-		_scsi_lun_execute_task(lun, task);
+		_scsi_lun_execute_task(ch, task);
 	}
 }
 
@@ -267,6 +472,8 @@ _scsi_lun_remove(void *arg)
 
 	spdk_bdev_close(lun->bdev_desc);
 	spdk_scsi_dev_delete_lun(lun->dev, lun);
+	scsi_lun_free_channels(lun);
+	pthread_mutex_destroy(&lun->mutex);
 	free(lun);
 }
 
@@ -283,12 +490,26 @@ scsi_lun_remove(struct spdk_scsi_lun *lun)
 	spdk_thread_exec_msg(lun->thread, _scsi_lun_remove, lun);
 }
 
+static bool
+scsi_lun_has_io_channels(const struct spdk_scsi_lun *lun)
+{
+	struct spdk_scsi_lun_channel *ch;
+
+	for (ch = scsi_lun_first_channel(lun); ch != NULL; ch = ch->next) {
+		if (__atomic_load_n(&ch->ref, __ATOMIC_ACQUIRE) != 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static int
 scsi_lun_check_io_channel(void *arg)
 {
 	struct spdk_scsi_lun *lun = (struct spdk_scsi_lun *)arg;
 
-	if (lun->io_channel) {
+	if (scsi_lun_has_io_channels(lun)) {
 		return SPDK_POLLER_BUSY;
 	}
 	spdk_poller_unregister(&lun->hotremove_poller);
@@ -297,6 +518,13 @@ scsi_lun_check_io_channel(void *arg)
 	return SPDK_POLLER_BUSY;
 }
 
+static void
+_scsi_lun_close(struct spdk_scsi_lun_desc *desc)
+{
+	TAILQ_REMOVE(&desc->lun->open_descs, desc, link);
+	free(desc);
+}
+
 static void
 scsi_lun_notify_hot_remove(struct spdk_scsi_lun *lun)
 {
@@ -306,15 +534,20 @@ scsi_lun_notify_hot_remove(struct spdk_scsi_lun *lun)
 		lun->hotremove_cb(lun, lun->hotremove_ctx);
 	}
 
+	/* Descriptor callbacks are called with the mutex held, hence they must
+	 * not close the descriptor synchronously.
+	 */
+	pthread_mutex_lock(&lun->mutex);
 	TAILQ_FOREACH_SAFE(desc, &lun->open_descs, link, tmp) {
 		if (desc->hotremove_cb) {
 			desc->hotremove_cb(lun, desc->hotremove_ctx);
 		} else {
-			spdk_scsi_lun_close(desc);
+			_scsi_lun_close(desc);
 		}
 	}
+	pthread_mutex_unlock(&lun->mutex);
 
-	if (lun->io_channel) {
+	if (scsi_lun_has_io_channels(lun)) {
 		lun->hotremove_poller = SPDK_POLLER_REGISTER(scsi_lun_check_io_channel,
 					lun, 10);
 	} else {
@@ -327,8 +560,9 @@ scsi_lun_check_outstanding_tasks(void *arg)
 {
 	struct spdk_scsi_lun *lun = (struct spdk_scsi_lun *)arg;
 
-	if (scsi_lun_has_outstanding_tasks(lun) ||
-	    scsi_lun_has_outstanding_mgmt_tasks(lun)) {
+	if (_scsi_lun_has_pending_tasks(lun) ||
+	    scsi_lun_has_outstanding_tasks(lun) ||
+	    scsi_lun_has_submitted_mgmt_tasks(lun)) {
 		return SPDK_POLLER_BUSY;
 	}
 	spdk_poller_unregister(&lun->hotremove_poller);
@@ -338,20 +572,28 @@ scsi_lun_check_outstanding_tasks(void *arg)
 }
 
 static void
-_scsi_lun_hot_remove(void *arg1)
+scsi_lun_hot_remove(void *remove_ctx)
 {
-	struct spdk_scsi_lun *lun = arg1;
+	struct spdk_scsi_lun *lun = (struct spdk_scsi_lun *)remove_ctx;
+
+	if (lun->removed) {
+		return;
+	}
+
+	lun->removed = true;
 
 	/* If lun->removed is set, no new task can be submitted to the LUN.
 	 * Execute previously queued tasks, which will be immediately aborted.
+	 * Tasks queued on other threads are executed there asynchronously.
 	 */
 	scsi_lun_execute_tasks(lun);
 
 	/* Then we only need to wait for all outstanding tasks to be completed
 	 * before notifying the upper layer about the removal.
 	 */
-	if (scsi_lun_has_outstanding_tasks(lun) ||
-	    scsi_lun_has_outstanding_mgmt_tasks(lun)) {
+	if (_scsi_lun_has_pending_tasks(lun) ||
+	    scsi_lun_has_outstanding_tasks(lun) ||
+	    scsi_lun_has_submitted_mgmt_tasks(lun)) {
 		lun->hotremove_poller = SPDK_POLLER_REGISTER(scsi_lun_check_outstanding_tasks,
 					lun, 10);
 	} else {
@@ -359,30 +601,6 @@ _scsi_lun_hot_remove(void *arg1)
 	}
 }
 
-static void
-scsi_lun_hot_remove(void *remove_ctx)
-{
-	struct spdk_scsi_lun *lun = (struct spdk_scsi_lun *)remove_ctx;
-	struct spdk_thread *thread;
-
-	if (lun->removed) {
-		return;
-	}
-
-	lun->removed = true;
-	if (lun->io_channel == NULL) {
-		_scsi_lun_hot_remove(lun);
-		return;
-	}
-
-	thread = spdk_io_channel_get_thread(lun->io_channel);
-	if (thread != spdk_get_thread()) {
-		spdk_thread_send_msg(thread, _scsi_lun_hot_remove, lun);
-	} else {
-		_scsi_lun_hot_remove(lun);
-	}
-}
-
 static void
 bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
 	      void *event_ctx)
@@ -395,7 +613,7 @@ bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
 		break;
 	case SPDK_BDEV_EVENT_RESIZE:
 		SPDK_NOTICELOG("bdev name (%s) received event(SPDK_BDEV_EVENT_RESIZE)\n", spdk_bdev_get_name(bdev));
-		lun->resizing = true;
+		__atomic_store_n(&lun->resizing, true, __ATOMIC_RELAXED);
 		if (lun->resize_cb) {
 			lun->resize_cb(lun, lun->resize_ctx);
 		}
@@ -442,16 +660,21 @@ struct spdk_scsi_lun *scsi_lun_construct(const char *bdev_name,
 		return NULL;
 	}
 
+	rc = pthread_mutex_init(&lun->mutex, NULL);
+	if (rc != 0) {
+		SPDK_ERRLOG("mutex_init() failed, error=%d\n", rc);
+		spdk_bdev_close(lun->bdev_desc);
+		free(lun);
+		return NULL;
+	}
+
 	lun->thread = spdk_get_thread();
 
-	TAILQ_INIT(&lun->tasks);
-	TAILQ_INIT(&lun->pending_tasks);
 	TAILQ_INIT(&lun->mgmt_tasks);
 	TAILQ_INIT(&lun->pending_mgmt_tasks);
 
 	/* Bdev is not removed while it is opened. */
 	lun->bdev = spdk_bdev_desc_get_bdev(lun->bdev_desc);
-	lun->io_channel = NULL;
 	lun->hotremove_cb = hotremove_cb;
 	lun->hotremove_ctx = hotremove_ctx;
 
@@ -483,11 +706,14 @@ spdk_scsi_lun_open(struct spdk_scsi_lun *lun, spdk_scsi_lun_remove_cb_t hotremov
 		return -ENOMEM;
 	}
 
-	TAILQ_INSERT_TAIL(&lun->open_descs, desc, link);
-
 	desc->lun = lun;
 	desc->hotremove_cb = hotremove_cb;
 	desc->hotremove_ctx = hotremove_ctx;
+
+	pthread_mutex_lock(&lun->mutex);
+	TAILQ_INSERT_TAIL(&lun->open_descs, desc, link);
+	pthread_mutex_unlock(&lun->mutex);
+
 	*_desc = desc;
 
 	return 0;
@@ -498,50 +724,51 @@ spdk_scsi_lun_close(struct spdk_scsi_lun_desc *desc)
 {
 	struct spdk_scsi_lun *lun = desc->lun;
 
-	TAILQ_REMOVE(&lun->open_descs, desc, link);
-	free(desc);
-
-	assert(!TAILQ_EMPTY(&lun->open_descs) || lun->io_channel == NULL);
+	pthread_mutex_lock(&lun->mutex);
+	_scsi_lun_close(desc);
+	assert(!TAILQ_EMPTY(&lun->open_descs) || !scsi_lun_has_io_channels(lun));
+	pthread_mutex_unlock(&lun->mutex);
 }
 
+/* Each thread allocates its own io_channel, so a LUN can be used by multiple threads. */
 int
 scsi_lun_allocate_io_channel(struct spdk_scsi_lun *lun)
 {
-	if (lun->io_channel != NULL) {
-		if (spdk_get_thread() == spdk_io_channel_get_thread(lun->io_channel)) {
-			lun->ref++;
-			return 0;
-		}
-		SPDK_ERRLOG("io_channel already allocated for lun %s\n",
-			    spdk_bdev_get_name(lun->bdev));
+	struct spdk_scsi_lun_channel *ch;
+
+	ch = scsi_lun_get_channel(lun);
+	if (ch == NULL) {
 		return -1;
 	}
 
-	lun->io_channel = spdk_bdev_get_io_channel(lun->bdev_desc);
-	if (lun->io_channel == NULL) {
+	if (ch->io_channel != NULL) {
+		__atomic_store_n(&ch->ref, ch->ref + 1, __ATOMIC_RELEASE);
+		return 0;
+	}
+
+	ch->io_channel = spdk_bdev_get_io_channel(lun->bdev_desc);
+	if (ch->io_channel == NULL) {
 		return -1;
 	}
-	lun->ref = 1;
+	__atomic_store_n(&ch->ref, 1, __ATOMIC_RELEASE);
 	return 0;
 }
 
 void
 scsi_lun_free_io_channel(struct spdk_scsi_lun *lun)
 {
-	if (lun->io_channel == NULL) {
-		return;
-	}
+	struct spdk_scsi_lun_channel *ch;
 
-	if (spdk_get_thread() != spdk_io_channel_get_thread(lun->io_channel)) {
-		SPDK_ERRLOG("io_channel was freed by different thread\n");
+	ch = scsi_lun_find_channel(lun, spdk_get_thread());
+	if (ch == NULL || ch->io_channel == NULL) {
 		return;
 	}
 
-	lun->ref--;
-	if (lun->ref == 0) {
-		spdk_put_io_channel(lun->io_channel);
-		lun->io_channel = NULL;
+	if (ch->ref == 1) {
+		spdk_put_io_channel(ch->io_channel);
+		ch->io_channel = NULL;
 	}
+	__atomic_store_n(&ch->ref, ch->ref - 1, __ATOMIC_RELEASE);
 }
 
 int
@@ -578,17 +805,12 @@ spdk_scsi_lun_get_dev(const struct spdk_scsi_lun *lun)
 	return lun->dev;
 }
 
-bool
-scsi_lun_has_pending_mgmt_tasks(const struct spdk_scsi_lun *lun,
-				const struct spdk_scsi_port *initiator_port)
+static bool
+_scsi_lun_has_initiator_mgmt_tasks(const struct spdk_scsi_lun *lun,
+				   const struct spdk_scsi_port *initiator_port)
 {
 	struct spdk_scsi_task *task;
 
-	if (initiator_port == NULL) {
-		return _scsi_lun_has_pending_mgmt_tasks(lun) ||
-		       scsi_lun_has_outstanding_mgmt_tasks(lun);
-	}
-
 	TAILQ_FOREACH(task, &lun->pending_mgmt_tasks, scsi_link) {
 		if (task->initiator_port == initiator_port) {
 			return true;
@@ -603,11 +825,36 @@ scsi_lun_has_pending_mgmt_tasks(const struct spdk_scsi_lun *lun,
 
 	return false;
 }
-/* This check includes both pending and submitted (outstanding) tasks. */
+
+bool
+scsi_lun_has_pending_mgmt_tasks(struct spdk_scsi_lun *lun,
+				const struct spdk_scsi_port *initiator_port)
+{
+	bool ret;
+
+	pthread_mutex_lock(&lun->mutex);
+	if (initiator_port == NULL) {
+		ret = _scsi_lun_has_pending_mgmt_tasks(lun) ||
+		      scsi_lun_has_outstanding_mgmt_tasks(lun);
+	} else {
+		ret = _scsi_lun_has_initiator_mgmt_tasks(lun, initiator_port);
+	}
+	pthread_mutex_unlock(&lun->mutex);
+
+	return ret;
+}
+
+/* This check includes both pending and submitted (outstanding) tasks.
+ *
+ * IO tasks of an initiator are looked up only on the channel of the calling
+ * thread because task lists are owned by their thread.  Initiators submit
+ * tasks from the thread that waits for them.
+ */
 bool
-scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun,
+scsi_lun_has_pending_tasks(struct spdk_scsi_lun *lun,
 			   const struct spdk_scsi_port *initiator_port)
 {
+	struct spdk_scsi_lun_channel *ch;
 	struct spdk_scsi_task *task;
 
 	if (initiator_port == NULL) {
@@ -615,13 +862,18 @@ scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun,
 		       scsi_lun_has_outstanding_tasks(lun);
 	}
 
-	TAILQ_FOREACH(task, &lun->pending_tasks, scsi_link) {
+	ch = scsi_lun_find_channel(lun, spdk_get_thread());
+	if (ch == NULL) {
+		return false;
+	}
+
+	TAILQ_FOREACH(task, &ch->pending_tasks, scsi_link) {
 		if (task->initiator_port == initiator_port) {
 			return true;
 		}
 	}
 
-	TAILQ_FOREACH(task, &lun->tasks, scsi_link) {
+	TAILQ_FOREACH(task, &ch->tasks, scsi_link) {
 		if (task->initiator_port == initiator_port) {
 			return true;
 		}
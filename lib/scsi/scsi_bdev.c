@@ -1157,7 +1157,7 @@ bdev_scsi_queue_io(struct spdk_scsi_task *task, spdk_bdev_io_wait_cb cb_fn, void
 {
 	struct spdk_scsi_lun *lun = task->lun;
 	struct spdk_bdev *bdev = lun->bdev;
-	struct spdk_io_channel *ch = lun->io_channel;
+	struct spdk_io_channel *ch = task->lun_ch->io_channel;
 	int rc;
 
 	task->bdev_io_wait.bdev = bdev;
@@ -1423,7 +1423,7 @@ _bdev_scsi_unmap(struct spdk_bdev_scsi_unmap_ctx *ctx)
 
 		ctx->count++;
 		rc = spdk_bdev_unmap_blocks(lun->bdev_desc,
-					    lun->io_channel,
+					    task->lun_ch->io_channel,
 					    offset_blocks,
 					    num_blocks,
 					    bdev_scsi_task_complete_unmap_cmd,
@@ -1525,7 +1525,7 @@ bdev_scsi_process_block(struct spdk_scsi_task *task)
 		if (xfer_len == 0) {
 			xfer_len = 256;
 		}
-		return bdev_scsi_readwrite(bdev, lun->bdev_desc, lun->io_channel,
+		return bdev_scsi_readwrite(bdev, lun->bdev_desc, task->lun_ch->io_channel,
 					   task, lba, xfer_len,
 					   cdb[0] == SPDK_SBC_READ_6);
 
@@ -1533,7 +1533,7 @@ bdev_scsi_process_block(struct spdk_scsi_task *task)
 	case SPDK_SBC_WRITE_10:
 		lba = from_be32(&cdb[2]);
 		xfer_len = from_be16(&cdb[7]);
-		return bdev_scsi_readwrite(bdev, lun->bdev_desc, lun->io_channel,
+		return bdev_scsi_readwrite(bdev, lun->bdev_desc, task->lun_ch->io_channel,
 					   task, lba, xfer_len,
 					   cdb[0] == SPDK_SBC_READ_10);
 
@@ -1541,14 +1541,14 @@ bdev_scsi_process_block(struct spdk_scsi_task *task)
 	case SPDK_SBC_WRITE_12:
 		lba = from_be32(&cdb[2]);
 		xfer_len = from_be32(&cdb[6]);
-		return bdev_scsi_readwrite(bdev, lun->bdev_desc, lun->io_channel,
+		return bdev_scsi_readwrite(bdev, lun->bdev_desc, task->lun_ch->io_channel,
 					   task, lba, xfer_len,
 					   cdb[0] == SPDK_SBC_READ_12);
 	case SPDK_SBC_READ_16:
 	case SPDK_SBC_WRITE_16:
 		lba = from_be64(&cdb[2]);
 		xfer_len = from_be32(&cdb[10]);
-		return bdev_scsi_readwrite(bdev, lun->bdev_desc, lun->io_channel,
+		return bdev_scsi_readwrite(bdev, lun->bdev_desc, task->lun_ch->io_channel,
 					   task, lba, xfer_len,
 					   cdb[0] == SPDK_SBC_READ_16);
 
@@ -1626,7 +1626,8 @@ bdev_scsi_process_block(struct spdk_scsi_task *task)
 			len = spdk_bdev_get_num_blocks(bdev) - lba;
 		}
 
-		return bdev_scsi_sync(bdev, lun->bdev_desc, lun->io_channel, task, lba, len);
+		return bdev_scsi_sync(bdev, lun->bdev_desc, task->lun_ch->io_channel, task,
+				      lba, len);
 		break;
 
 	case SPDK_SBC_UNMAP:
@@ -1967,8 +1968,8 @@ bdev_scsi_reset(struct spdk_scsi_task *task)
 	struct spdk_scsi_lun *lun = task->lun;
 	int rc;
 
-	rc = spdk_bdev_reset(lun->bdev_desc, lun->io_channel, bdev_scsi_task_complete_reset,
-			     task);
+	rc = spdk_bdev_reset(lun->bdev_desc, task->lun_ch->io_channel,
+			     bdev_scsi_task_complete_reset, task);
 	if (rc == -ENOMEM) {
 		bdev_scsi_queue_io(task, bdev_scsi_reset_resubmit, task);
 	}
@@ -57,6 +57,18 @@ struct spdk_scsi_pr_reservation {
 	uint64_t				crkey;
 };
 
+/*
+ * Copy of the reservation state which the I/O path reads without taking the LUN mutex.  It's
+ * updated under the mutex, seq being odd while an update is in progress.
+ */
+struct scsi_pr_snapshot {
+	uint32_t				seq;
+	bool					reserved;
+	bool					spc2_reserved;
+	struct spdk_scsi_port			*spc2_initiator_port;
+	struct spdk_scsi_port			*spc2_target_port;
+};
+
 struct spdk_scsi_dev {
 	int					id;
 	int					is_allocated;
@@ -81,6 +93,39 @@ struct spdk_scsi_lun_desc {
 	TAILQ_ENTRY(spdk_scsi_lun_desc)	link;
 };
 
+/*
+ * Per-thread state of a LUN.  Only the owner thread touches the I/O channel
+ *  and the task lists.  Other threads only read the counters.
+ */
+struct spdk_scsi_lun_channel {
+	/** The LUN this channel belongs to. */
+	struct spdk_scsi_lun *lun;
+
+	/** The thread which owns this channel. */
+	struct spdk_thread *thread;
+
+	/** I/O channel for the bdev associated with this LUN on the owner thread. */
+	struct spdk_io_channel *io_channel;
+
+	/** The reference number for io_channel, thus we can correctly free it */
+	uint32_t ref;
+
+	/** Number of tasks on the tasks list */
+	uint32_t num_outstanding_tasks;
+
+	/** Number of tasks on the pending_tasks list */
+	uint32_t num_pending_tasks;
+
+	/** submitted tasks */
+	TAILQ_HEAD(tasks, spdk_scsi_task) tasks;
+
+	/** pending tasks */
+	TAILQ_HEAD(pending_tasks, spdk_scsi_task) pending_tasks;
+
+	/** Next channel of the LUN. Channels are freed only with the LUN. */
+	struct spdk_scsi_lun_channel *next;
+};
+
 struct spdk_scsi_lun {
 	/** LUN id for this logical unit. */
 	int id;
@@ -97,11 +142,17 @@ struct spdk_scsi_lun {
 	/** The thread which opens this LUN. */
 	struct spdk_thread *thread;
 
-	/** I/O channel for the bdev associated with this LUN. */
-	struct spdk_io_channel *io_channel;
+	/** Per-thread channels, only appended to until the LUN is freed. */
+	struct spdk_scsi_lun_channel *channels;
 
-	/**  The reference number for this LUN, thus we can correctly free the io_channel */
-	uint32_t ref;
+	/**
+	 * Protects adding channels, the management task lists, the open descriptors
+	 *  and the persistent reservation state.
+	 */
+	pthread_mutex_t mutex;
+
+	/** Number of tasks on the pending_mgmt_tasks list. */
+	uint32_t num_pending_mgmt_tasks;
 
 	/** Poller to release the resource of the lun when it is hot removed */
 	struct spdk_poller *hotremove_poller;
@@ -129,16 +180,12 @@ struct spdk_scsi_lun {
 	struct spdk_scsi_pr_reservation reservation;
 	/** Reservation holder for SPC2 RESERVE(6) and RESERVE(10) */
 	struct spdk_scsi_pr_registrant scsi2_holder;
+	/** Reservation state checked by the I/O path */
+	struct scsi_pr_snapshot pr_snapshot;
 
 	/** List of open descriptors for this LUN. */
 	TAILQ_HEAD(, spdk_scsi_lun_desc) open_descs;
 
-	/** submitted tasks */
-	TAILQ_HEAD(tasks, spdk_scsi_task) tasks;
-
-	/** pending tasks */
-	TAILQ_HEAD(pending_tasks, spdk_scsi_task) pending_tasks;
-
 	/** submitted management tasks */
 	TAILQ_HEAD(mgmt_tasks, spdk_scsi_task) mgmt_tasks;
 
@@ -151,7 +198,8 @@ struct spdk_scsi_lun {
 	/** A structure to connect LUNs in a list. */
 	TAILQ_ENTRY(spdk_scsi_lun) tailq;
 
-	/** The LUN is resizing */
+	/** The LUN is resizing, cleared by the first task reporting it as a unit attention.
+	 * Accessed atomically, as tasks are executed on multiple threads. */
 	bool resizing;
 };
 
@@ -164,11 +212,11 @@ void scsi_lun_destruct(struct spdk_scsi_lun *lun);
 
 void scsi_lun_execute_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task);
 void scsi_lun_execute_mgmt_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task);
-bool scsi_lun_has_pending_mgmt_tasks(const struct spdk_scsi_lun *lun,
+bool scsi_lun_has_pending_mgmt_tasks(struct spdk_scsi_lun *lun,
 				     const struct spdk_scsi_port *initiator_port);
 void scsi_lun_complete_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task);
 void scsi_lun_complete_reset_task(struct spdk_scsi_lun *lun, struct spdk_scsi_task *task);
-bool scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun,
+bool scsi_lun_has_pending_tasks(struct spdk_scsi_lun *lun,
 				const struct spdk_scsi_port *initiator_port);
 int scsi_lun_allocate_io_channel(struct spdk_scsi_lun *lun);
 void scsi_lun_free_io_channel(struct spdk_scsi_lun *lun);
@@ -25,23 +25,6 @@ scsi_pr_get_registrant(struct spdk_scsi_lun *lun,
 	return NULL;
 }
 
-static bool
-scsi2_it_nexus_is_holder(struct spdk_scsi_lun *lun,
-			 struct spdk_scsi_port *initiator_port,
-			 struct spdk_scsi_port *target_port)
-{
-	struct spdk_scsi_pr_registrant *reg = lun->reservation.holder;
-
-	assert(reg != NULL);
-
-	if ((reg->initiator_port == initiator_port) &&
-	    (reg->target_port == target_port)) {
-		return true;
-	}
-
-	return false;
-}
-
 /* Reservation type is all registrants or not */
 static inline bool
 scsi_pr_is_all_registrants_type(struct spdk_scsi_lun *lun)
@@ -69,6 +52,45 @@ scsi_pr_has_reservation(struct spdk_scsi_lun *lun)
 	return !(lun->reservation.holder == NULL);
 }
 
+/* Publish the reservation state to the I/O path, must be called with the mutex held */
+static void
+scsi_pr_update_snapshot(struct spdk_scsi_lun *lun)
+{
+	struct scsi_pr_snapshot *snap = &lun->pr_snapshot;
+	struct spdk_scsi_pr_registrant *holder = lun->reservation.holder;
+	bool spc2_reserved = !!(lun->reservation.flags & SCSI_SPC2_RESERVE);
+	uint32_t seq = snap->seq;
+
+	__atomic_store_n(&snap->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&snap->reserved, holder != NULL, __ATOMIC_RELAXED);
+	__atomic_store_n(&snap->spc2_reserved, spc2_reserved, __ATOMIC_RELAXED);
+	__atomic_store_n(&snap->spc2_initiator_port, spc2_reserved ? holder->initiator_port : NULL,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&snap->spc2_target_port, spc2_reserved ? holder->target_port : NULL,
+			 __ATOMIC_RELAXED);
+
+	__atomic_store_n(&snap->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* Get a consistent copy of the reservation state without taking the mutex */
+static void
+scsi_pr_get_snapshot(struct spdk_scsi_lun *lun, struct scsi_pr_snapshot *copy)
+{
+	struct scsi_pr_snapshot *snap = &lun->pr_snapshot;
+
+	do {
+		copy->seq = __atomic_load_n(&snap->seq, __ATOMIC_ACQUIRE);
+		copy->reserved = __atomic_load_n(&snap->reserved, __ATOMIC_RELAXED);
+		copy->spc2_reserved = __atomic_load_n(&snap->spc2_reserved, __ATOMIC_RELAXED);
+		copy->spc2_initiator_port = __atomic_load_n(&snap->spc2_initiator_port,
+					    __ATOMIC_RELAXED);
+		copy->spc2_target_port = __atomic_load_n(&snap->spc2_target_port, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((copy->seq & 1) || copy->seq != __atomic_load_n(&snap->seq, __ATOMIC_RELAXED));
+}
+
 static int
 scsi_pr_register_registrant(struct spdk_scsi_lun *lun,
 			    struct spdk_scsi_port *initiator_port,
@@ -123,6 +145,7 @@ scsi_pr_release_reservation(struct spdk_scsi_lun *lun, struct spdk_scsi_pr_regis
 	}
 
 	memset(&lun->reservation, 0, sizeof(struct spdk_scsi_pr_reservation));
+	scsi_pr_update_snapshot(lun);
 }
 
 static void
@@ -134,6 +157,7 @@ scsi_pr_reserve_reservation(struct spdk_scsi_lun *lun,
 	lun->reservation.rtype = type;
 	lun->reservation.crkey = rkey;
 	lun->reservation.holder = holder;
+	scsi_pr_update_snapshot(lun);
 }
 
 static void
@@ -495,9 +519,9 @@ conflict:
 	return -EINVAL;
 }
 
-int
-scsi_pr_out(struct spdk_scsi_task *task, uint8_t *cdb,
-	    uint8_t *data, uint16_t data_len)
+static int
+_scsi_pr_out(struct spdk_scsi_task *task, uint8_t *cdb,
+	     uint8_t *data, uint16_t data_len)
 {
 	int rc = -1;
 	uint64_t rkey, sa_rkey;
@@ -560,6 +584,20 @@ invalid:
 	return -EINVAL;
 }
 
+int
+scsi_pr_out(struct spdk_scsi_task *task, uint8_t *cdb,
+	    uint8_t *data, uint16_t data_len)
+{
+	struct spdk_scsi_lun *lun = task->lun;
+	int rc;
+
+	pthread_mutex_lock(&lun->mutex);
+	rc = _scsi_pr_out(task, cdb, data, data_len);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return rc;
+}
+
 static int
 scsi_pr_in_read_keys(struct spdk_scsi_task *task, uint8_t *data,
 		     uint16_t data_len)
@@ -688,9 +726,9 @@ scsi_pr_in_read_full_status(struct spdk_scsi_task *task,
 	return (sizeof(param->header) + add_len);
 }
 
-int
-scsi_pr_in(struct spdk_scsi_task *task, uint8_t *cdb,
-	   uint8_t *data, uint16_t data_len)
+static int
+_scsi_pr_in(struct spdk_scsi_task *task, uint8_t *cdb,
+	    uint8_t *data, uint16_t data_len)
 {
 	enum spdk_scsi_pr_in_action_code action;
 	int rc = 0;
@@ -731,7 +769,21 @@ invalid:
 }
 
 int
-scsi_pr_check(struct spdk_scsi_task *task)
+scsi_pr_in(struct spdk_scsi_task *task, uint8_t *cdb,
+	   uint8_t *data, uint16_t data_len)
+{
+	struct spdk_scsi_lun *lun = task->lun;
+	int rc;
+
+	pthread_mutex_lock(&lun->mutex);
+	rc = _scsi_pr_in(task, cdb, data, data_len);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return rc;
+}
+
+static int
+_scsi_pr_check(struct spdk_scsi_task *task)
 {
 	struct spdk_scsi_lun *lun = task->lun;
 	uint8_t *cdb = task->cdb;
@@ -875,6 +927,33 @@ conflict:
 	return -1;
 }
 
+static int _scsi2_reserve_check(struct spdk_scsi_task *task, const struct scsi_pr_snapshot *snap);
+
+int
+scsi_pr_check(struct spdk_scsi_task *task)
+{
+	struct spdk_scsi_lun *lun = task->lun;
+	struct scsi_pr_snapshot snap;
+	int rc;
+
+	/* Commands usually arrive without any reservation. Skip the lock then. */
+	scsi_pr_get_snapshot(lun, &snap);
+	if (!snap.reserved) {
+		return 0;
+	}
+
+	/* An SPC2 reservation only depends on the holder's I_T nexus, which is in the snapshot */
+	if (snap.spc2_reserved) {
+		return _scsi2_reserve_check(task, &snap);
+	}
+
+	pthread_mutex_lock(&lun->mutex);
+	rc = _scsi_pr_check(task);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return rc;
+}
+
 static int
 scsi2_check_reservation_conflict(struct spdk_scsi_task *task)
 {
@@ -940,8 +1019,8 @@ scsi2_check_reservation_conflict(struct spdk_scsi_task *task)
 	return 0;
 }
 
-int
-scsi2_reserve(struct spdk_scsi_task *task, uint8_t *cdb)
+static int
+_scsi2_reserve(struct spdk_scsi_task *task, uint8_t *cdb)
 {
 	struct spdk_scsi_lun *lun = task->lun;
 	struct spdk_scsi_pr_registrant *reg = &lun->scsi2_holder;
@@ -981,12 +1060,26 @@ scsi2_reserve(struct spdk_scsi_task *task, uint8_t *cdb)
 
 	lun->reservation.flags = SCSI_SPC2_RESERVE;
 	lun->reservation.holder = &lun->scsi2_holder;
+	scsi_pr_update_snapshot(lun);
 
 	return 0;
 }
 
 int
-scsi2_release(struct spdk_scsi_task *task)
+scsi2_reserve(struct spdk_scsi_task *task, uint8_t *cdb)
+{
+	struct spdk_scsi_lun *lun = task->lun;
+	int rc;
+
+	pthread_mutex_lock(&lun->mutex);
+	rc = _scsi2_reserve(task, cdb);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return rc;
+}
+
+static int
+_scsi2_release(struct spdk_scsi_task *task)
 {
 	struct spdk_scsi_lun *lun = task->lun;
 	int ret;
@@ -1009,14 +1102,27 @@ scsi2_release(struct spdk_scsi_task *task)
 
 	memset(&lun->reservation, 0, sizeof(struct spdk_scsi_pr_reservation));
 	memset(&lun->scsi2_holder, 0, sizeof(struct spdk_scsi_pr_registrant));
+	scsi_pr_update_snapshot(lun);
 
 	return 0;
 }
 
 int
-scsi2_reserve_check(struct spdk_scsi_task *task)
+scsi2_release(struct spdk_scsi_task *task)
 {
 	struct spdk_scsi_lun *lun = task->lun;
+	int rc;
+
+	pthread_mutex_lock(&lun->mutex);
+	rc = _scsi2_release(task);
+	pthread_mutex_unlock(&lun->mutex);
+
+	return rc;
+}
+
+static int
+_scsi2_reserve_check(struct spdk_scsi_task *task, const struct scsi_pr_snapshot *snap)
+{
 	uint8_t *cdb = task->cdb;
 
 	switch (cdb[0]) {
@@ -1030,11 +1136,12 @@ scsi2_reserve_check(struct spdk_scsi_task *task)
 	}
 
 	/* no reservation holders */
-	if (!scsi_pr_has_reservation(lun)) {
+	if (!snap->reserved) {
 		return 0;
 	}
 
-	if (scsi2_it_nexus_is_holder(lun, task->initiator_port, task->target_port)) {
+	if (snap->spc2_initiator_port == task->initiator_port &&
+	    snap->spc2_target_port == task->target_port) {
 		return 0;
 	}
 
@@ -1044,3 +1151,13 @@ scsi2_reserve_check(struct spdk_scsi_task *task)
 				  SPDK_SCSI_ASCQ_CAUSE_NOT_REPORTABLE);
 	return -1;
 }
+
+int
+scsi2_reserve_check(struct spdk_scsi_task *task)
+{
+	struct scsi_pr_snapshot snap;
+
+	scsi_pr_get_snapshot(task->lun, &snap);
+
+	return _scsi2_reserve_check(task, &snap);
+}
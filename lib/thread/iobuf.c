@@ -231,6 +231,25 @@ spdk_iobuf_get_opts(struct spdk_iobuf_opts *opts)
 	*opts = g_iobuf.opts;
 }
 
+int
+spdk_iobuf_get_pool_regions(struct iovec *iovs, int iovcnt)
+{
+	if (g_iobuf.small_pool_base == NULL || g_iobuf.large_pool_base == NULL) {
+		return 0;
+	}
+
+	if (iovcnt < 2) {
+		return -ENOMEM;
+	}
+
+	iovs[0].iov_base = g_iobuf.small_pool_base;
+	iovs[0].iov_len = g_iobuf.opts.small_bufsize * g_iobuf.opts.small_pool_count;
+	iovs[1].iov_base = g_iobuf.large_pool_base;
+	iovs[1].iov_len = g_iobuf.opts.large_bufsize * g_iobuf.opts.large_pool_count;
+
+	return 2;
+}
+
 int
 spdk_iobuf_channel_init(struct spdk_iobuf_channel *ch, const char *name,
 			uint32_t small_cache_size, uint32_t large_cache_size)
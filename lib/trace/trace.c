@@ -20,12 +20,93 @@ static char g_shm_name[64];
 
 struct spdk_trace_histories *g_trace_histories;
 
+/* Size of the address range reserved for g_trace_histories, including the thread histories */
+static size_t g_trace_map_size;
+static uint64_t g_trace_num_entries;
+static uint64_t g_trace_thread_history_size;
+static uint32_t g_trace_num_threads;
+static uint64_t g_trace_generation;
+static pthread_mutex_t g_trace_thread_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* History of a thread not running on an SPDK lcore, valid if t_trace_generation matches */
+static __thread struct spdk_trace_history *t_trace_history;
+static __thread uint64_t t_trace_generation;
+
 static inline struct spdk_trace_entry *
 get_trace_entry(struct spdk_trace_history *history, uint64_t offset)
 {
 	return &history->entries[offset & (history->num_entries - 1)];
 }
 
+static struct spdk_trace_history *
+trace_register_thread_history(void)
+{
+	struct spdk_trace_history *history = NULL;
+	uint64_t offset;
+	void *addr;
+
+	pthread_mutex_lock(&g_trace_thread_mutex);
+	if (g_trace_histories == NULL || g_trace_num_threads == SPDK_TRACE_MAX_THREADS) {
+		goto out;
+	}
+
+	/* The address range is reserved at init, so the thread history is simply mapped right
+	 * after the last one and readers only need to remap the file once it has grown.
+	 */
+	offset = g_trace_flags->lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES];
+	if (ftruncate(g_trace_fd, offset + g_trace_thread_history_size) != 0) {
+		SPDK_ERRLOG("could not truncate shm for thread trace history\n");
+		goto out;
+	}
+
+	addr = mmap((uint8_t *)g_trace_histories + offset, g_trace_thread_history_size,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, g_trace_fd, offset);
+	if (addr == MAP_FAILED) {
+		SPDK_ERRLOG("could not mmap shm for thread trace history\n");
+		goto out;
+	}
+
+#if defined(__linux__)
+	if (mlock(addr, g_trace_thread_history_size) != 0) {
+		SPDK_ERRLOG("Could not mlock thread trace history - %s.\n", spdk_strerror(errno));
+	}
+#endif
+
+	history = addr;
+	history->lcore = SPDK_TRACE_THREAD_HISTORY_ID(g_trace_num_threads);
+	history->num_entries = g_trace_num_entries;
+
+	/* Ensure the history is initialized before the trace tools can see it */
+	spdk_smp_wmb();
+	g_trace_flags->lcore_history_offsets[history->lcore] = offset;
+	g_trace_flags->lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES] = offset +
+			g_trace_thread_history_size;
+	g_trace_num_threads++;
+out:
+	/* Don't retry on failure, it'd just take the lock for every tracepoint */
+	t_trace_history = history;
+	t_trace_generation = g_trace_generation;
+	pthread_mutex_unlock(&g_trace_thread_mutex);
+
+	return history;
+}
+
+static inline struct spdk_trace_history *
+trace_get_history(void)
+{
+	unsigned lcore = spdk_env_get_current_core();
+
+	if (spdk_likely(lcore < SPDK_TRACE_MAX_LCORE)) {
+		return spdk_get_per_lcore_history(g_trace_histories, lcore);
+	}
+
+	if (spdk_likely(t_trace_generation == g_trace_generation)) {
+		return t_trace_history;
+	}
+
+	return trace_register_thread_history();
+}
+
 void
 _spdk_trace_record(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id, uint32_t size,
 		   uint64_t object_id, int num_args, ...)
@@ -35,18 +116,16 @@ _spdk_trace_record(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id, uint32_
 	struct spdk_trace_entry_buffer *buffer;
 	struct spdk_trace_tpoint *tpoint;
 	struct spdk_trace_argument *argument;
-	unsigned lcore, i, offset, num_entries, arglen, argoff, curlen;
+	unsigned i, offset, num_entries, arglen, argoff, curlen;
 	uint64_t intval;
 	void *argval;
 	va_list vl;
 
-	lcore = spdk_env_get_current_core();
-	if (spdk_unlikely(lcore >= SPDK_TRACE_MAX_LCORE)) {
+	lcore_history = trace_get_history();
+	if (spdk_unlikely(lcore_history == NULL)) {
 		return;
 	}
 
-	lcore_history = spdk_get_per_lcore_history(g_trace_histories, lcore);
-
 	if (tsc == 0) {
 		tsc = spdk_get_ticks();
 	}
@@ -143,13 +222,90 @@ _spdk_trace_record(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id, uint32_
 	lcore_history->next_entry += num_entries;
 }
 
+static inline bool
+trace_int_args_valid(uint16_t tpoint_id, int num_args)
+{
+	struct spdk_trace_tpoint *tpoint = &g_trace_flags->tpoint[tpoint_id];
+	int i;
+
+	if (tpoint->num_args != num_args) {
+		return false;
+	}
+
+	for (i = 0; i < num_args; i++) {
+		if (tpoint->args[i].type == SPDK_TRACE_ARG_TYPE_STR ||
+		    tpoint->args[i].size != sizeof(uint64_t)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+_spdk_trace_record_int(uint64_t tsc, uint16_t tpoint_id, uint16_t poller_id, uint32_t size,
+		       uint64_t object_id, int num_args, uint64_t arg1, uint64_t arg2,
+		       uint64_t arg3, uint64_t arg4)
+{
+	struct spdk_trace_history *lcore_history;
+	struct spdk_trace_entry *next_entry;
+	struct spdk_trace_entry_buffer *buffer;
+	uint64_t args[SPDK_TRACE_MAX_INT_ARGS_COUNT] = { arg1, arg2, arg3, arg4 };
+	unsigned len, offset, curlen, num_entries;
+
+	lcore_history = trace_get_history();
+	if (spdk_unlikely(lcore_history == NULL)) {
+		return;
+	}
+
+	if (tsc == 0) {
+		tsc = spdk_get_ticks();
+	}
+
+	lcore_history->tpoint_count[tpoint_id]++;
+
+	/* The arguments are always recorded as 8 bytes each, so their layout only depends on
+	 * num_args, which is a compile time constant.  The tracepoint definition is only
+	 * checked in debug builds.
+	 */
+	assert(trace_int_args_valid(tpoint_id, num_args) &&
+	       "Tracepoint arguments don't match its definition");
+	len = (unsigned)num_args * sizeof(uint64_t);
+
+	next_entry = get_trace_entry(lcore_history, lcore_history->next_entry);
+	next_entry->tsc = tsc;
+	next_entry->tpoint_id = tpoint_id;
+	next_entry->poller_id = poller_id;
+	next_entry->size = size;
+	next_entry->object_id = object_id;
+
+	curlen = spdk_min(len, sizeof(next_entry->args));
+	memcpy(next_entry->args, args, curlen);
+
+	num_entries = 1;
+	for (offset = curlen; offset < len; offset += curlen) {
+		buffer = (struct spdk_trace_entry_buffer *)get_trace_entry(
+				 lcore_history, lcore_history->next_entry + num_entries);
+		buffer->tpoint_id = SPDK_TRACE_MAX_TPOINT_ID;
+		buffer->tsc = tsc;
+		curlen = spdk_min(len - offset, sizeof(buffer->data));
+		memcpy(buffer->data, (uint8_t *)args + offset, curlen);
+		num_entries++;
+	}
+
+	/* Ensure all elements of the trace entry are visible to outside trace tools */
+	spdk_smp_wmb();
+	lcore_history->next_entry += num_entries;
+}
+
 int
 spdk_trace_init(const char *shm_name, uint64_t num_entries)
 {
 	uint32_t i = 0;
-	int histories_size;
+	uint64_t histories_size, page_size;
 	uint64_t lcore_offsets[SPDK_TRACE_MAX_LCORE + 1] = { 0 };
 	struct spdk_cpuset cpuset = {};
+	void *addr;
 
 	/* 0 entries requested - skip trace initialization */
 	if (num_entries == 0) {
@@ -163,8 +319,16 @@ spdk_trace_init(const char *shm_name, uint64_t num_entries)
 		lcore_offsets[i] = histories_size;
 		histories_size += spdk_get_trace_history_size(num_entries);
 	}
+	/* Thread histories are mapped on demand, so keep them page aligned */
+	page_size = sysconf(_SC_PAGESIZE);
+	histories_size = SPDK_ALIGN_CEIL(histories_size, page_size);
 	lcore_offsets[SPDK_TRACE_MAX_LCORE] = histories_size;
 
+	g_trace_num_entries = num_entries;
+	g_trace_thread_history_size = SPDK_ALIGN_CEIL(spdk_get_trace_history_size(num_entries),
+				      page_size);
+	g_trace_map_size = histories_size + SPDK_TRACE_MAX_THREADS * g_trace_thread_history_size;
+
 	snprintf(g_shm_name, sizeof(g_shm_name), "%s", shm_name);
 
 	g_trace_fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
@@ -179,9 +343,17 @@ spdk_trace_init(const char *shm_name, uint64_t num_entries)
 		goto trace_init_err;
 	}
 
-	g_trace_histories = mmap(NULL, histories_size, PROT_READ | PROT_WRITE,
-				 MAP_SHARED, g_trace_fd, 0);
+	/* Reserve the address space for the thread histories too, they'll be mapped in place */
+	g_trace_histories = mmap(NULL, g_trace_map_size, PROT_NONE,
+				 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
 	if (g_trace_histories == MAP_FAILED) {
+		SPDK_ERRLOG("could not reserve address space for shm\n");
+		goto trace_init_err;
+	}
+
+	addr = mmap(g_trace_histories, histories_size, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_FIXED, g_trace_fd, 0);
+	if (addr == MAP_FAILED) {
 		SPDK_ERRLOG("could not mmap shm\n");
 		goto trace_init_err;
 	}
@@ -204,6 +376,7 @@ spdk_trace_init(const char *shm_name, uint64_t num_entries)
 
 	g_trace_flags = &g_trace_histories->flags;
 
+	g_trace_flags->version = SPDK_TRACE_VERSION;
 	g_trace_flags->tsc_rate = spdk_get_ticks_hz();
 
 	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
@@ -218,7 +391,13 @@ spdk_trace_init(const char *shm_name, uint64_t num_entries)
 		lcore_history->lcore = i;
 		lcore_history->num_entries = num_entries;
 	}
-	g_trace_flags->lcore_history_offsets[SPDK_TRACE_MAX_LCORE] = lcore_offsets[SPDK_TRACE_MAX_LCORE];
+	g_trace_flags->lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES] =
+		lcore_offsets[SPDK_TRACE_MAX_LCORE];
+
+	pthread_mutex_lock(&g_trace_thread_mutex);
+	g_trace_num_threads = 0;
+	g_trace_generation++;
+	pthread_mutex_unlock(&g_trace_thread_mutex);
 
 	spdk_trace_flags_init();
 
@@ -226,7 +405,7 @@ spdk_trace_init(const char *shm_name, uint64_t num_entries)
 
 trace_init_err:
 	if (g_trace_histories != MAP_FAILED) {
-		munmap(g_trace_histories, histories_size);
+		munmap(g_trace_histories, g_trace_map_size);
 	}
 	close(g_trace_fd);
 	g_trace_fd = -1;
@@ -253,7 +432,7 @@ spdk_trace_cleanup(void)
 	 * can be used after this process exits/crashes for debugging.
 	 * Note that we have to calculate this value before g_trace_histories gets unmapped.
 	 */
-	for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
 		lcore_history = spdk_get_per_lcore_history(g_trace_histories, i);
 		if (lcore_history == NULL) {
 			continue;
@@ -264,8 +443,10 @@ spdk_trace_cleanup(void)
 		}
 	}
 
-	munmap(g_trace_histories, sizeof(struct spdk_trace_histories));
+	pthread_mutex_lock(&g_trace_thread_mutex);
+	munmap(g_trace_histories, g_trace_map_size);
 	g_trace_histories = NULL;
+	pthread_mutex_unlock(&g_trace_thread_mutex);
 	close(g_trace_fd);
 
 	if (unlink) {
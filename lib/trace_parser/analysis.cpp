@@ -0,0 +1,481 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/histogram_data.h"
+#include "spdk/trace_parser.h"
+#include "spdk/util.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <map>
+#include <new>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#define ANALYSIS_NO_OBJECT UINT64_MAX
+
+static const double g_latency_cutoffs[] = { 0.5, 0.9, 0.99, 0.999 };
+
+struct analysis_event {
+	uint64_t	tsc;
+	uint64_t	object_index;
+	uint16_t	tpoint_id;
+	uint16_t	lcore;
+	uint8_t		object_type;
+};
+
+/* A traced object, e.g. an nvmf request, a bdev_io or an NVMe request */
+struct analysis_object {
+	uint8_t				type;
+	uint64_t			object_id;
+	uint64_t			object_index;
+	uint64_t			parent;
+	std::vector<uint64_t>		children;
+	std::vector<analysis_event>	events;
+};
+
+struct analysis_stage {
+	analysis_stage() : histogram(NULL), count(0), total(0), max(0), position(SIZE_MAX) {}
+	~analysis_stage() { spdk_histogram_data_free(histogram); }
+	analysis_stage(const analysis_stage &) = delete;
+	analysis_stage &operator=(const analysis_stage &) = delete;
+
+	spdk_histogram_data	*histogram;
+	uint64_t		count;
+	uint64_t		total;
+	uint64_t		max;
+	/* Lowest position of the stage in the requests' timelines, used to sort the report */
+	size_t			position;
+};
+
+/* Latencies between two tracepoints, keyed by their IDs */
+typedef std::map<std::pair<uint16_t, uint16_t>, analysis_stage> stage_map;
+
+/* Requests starting with the same tracepoint, with latencies between consecutive tracepoints */
+struct analysis_class {
+	analysis_class() : incomplete(0) {}
+
+	stage_map		stages;
+	analysis_stage		total;
+	/* Tracepoints that ended the requests known to be done */
+	std::set<uint16_t>	last_tpoints;
+	/* Requests still in flight at the end of the trace, not accounted in the stages */
+	uint64_t		incomplete;
+};
+
+struct analysis_request {
+	uint64_t			latency;
+	std::vector<analysis_event>	events;
+
+	bool operator>(const analysis_request &other) const { return latency > other.latency; }
+};
+
+struct spdk_trace_analysis {
+	spdk_trace_analysis(const spdk_trace_parser *parser, const spdk_trace_analysis_opts *opts);
+	spdk_trace_analysis(const spdk_trace_analysis &) = delete;
+	spdk_trace_analysis &operator=(const spdk_trace_analysis &) = delete;
+	void add_entry(const spdk_trace_parser_entry *pe);
+	void finish();
+	void report(FILE *file);
+private:
+	void collect_events(uint64_t id, std::vector<analysis_event> &events);
+	void release(uint64_t id);
+	void finish_request(uint64_t id, bool done);
+	void add_latency(analysis_stage &stage, uint64_t latency, size_t position);
+	void print_stage(FILE *file, const char *name, const analysis_stage &stage);
+	void print_histogram(FILE *file, const analysis_stage &stage);
+	double tsc_to_us(uint64_t tsc) const { return (double)tsc * 1000 * 1000 / _flags->tsc_rate; }
+	const char *tpoint_name(uint16_t tpoint_id) const { return _flags->tpoint[tpoint_id].name; }
+
+	const spdk_trace_flags					*_flags;
+	spdk_trace_analysis_opts				_opts;
+	uint64_t						_next_id;
+	std::unordered_map<uint64_t, analysis_object>		_objects;
+	/* In-flight objects by type and trace object ID */
+	std::map<std::pair<uint8_t, uint64_t>, uint64_t>	_live;
+	/* In-flight objects by type and object index, which is what relations refer to */
+	std::map<std::pair<uint8_t, uint64_t>, uint64_t>	_indexes;
+	std::map<uint16_t, analysis_class>			_classes;
+	std::priority_queue<analysis_request, std::vector<analysis_request>,
+	    std::greater<analysis_request>>			_slowest;
+};
+
+spdk_trace_analysis::spdk_trace_analysis(const spdk_trace_parser *parser,
+		const spdk_trace_analysis_opts *opts) :
+	_flags(spdk_trace_parser_get_flags(parser)),
+	_opts(*opts),
+	_next_id(0)
+{
+}
+
+void
+spdk_trace_analysis::add_entry(const spdk_trace_parser_entry *pe)
+{
+	const spdk_trace_entry *entry = pe->entry;
+	const spdk_trace_tpoint *tpoint = &_flags->tpoint[entry->tpoint_id];
+	std::pair<uint8_t, uint64_t> key(tpoint->object_type, entry->object_id);
+	std::map<std::pair<uint8_t, uint64_t>, uint64_t>::iterator it;
+	analysis_object *object;
+	uint64_t id;
+
+	if (tpoint->object_type == OBJECT_NONE || pe->object_index == UINT64_MAX) {
+		return;
+	}
+
+	it = _live.find(key);
+	if (tpoint->new_object) {
+		/* Object IDs are reused once an object is done, so a request is complete once the
+		 * ID of its root object shows up again.
+		 */
+		if (it != _live.end()) {
+			id = it->second;
+			_live.erase(it);
+			if (_objects.at(id).parent == ANALYSIS_NO_OBJECT) {
+				finish_request(id, true);
+			}
+		}
+
+		id = _next_id++;
+		object = &_objects[id];
+		object->type = tpoint->object_type;
+		object->object_id = entry->object_id;
+		object->object_index = pe->object_index;
+		object->parent = ANALYSIS_NO_OBJECT;
+		_live[key] = id;
+		_indexes[std::make_pair(tpoint->object_type, pe->object_index)] = id;
+	} else {
+		if (it == _live.end()) {
+			return;
+		}
+		id = it->second;
+		object = &_objects.at(id);
+	}
+
+	object->events.push_back({entry->tsc, pe->object_index, entry->tpoint_id, pe->lcore,
+				  tpoint->object_type});
+
+	if (pe->related_type != OBJECT_NONE && object->parent == ANALYSIS_NO_OBJECT) {
+		it = _indexes.find(std::make_pair(pe->related_type, pe->related_index));
+		if (it != _indexes.end() && it->second != id) {
+			object->parent = it->second;
+			_objects.at(it->second).children.push_back(id);
+		}
+	}
+}
+
+void
+spdk_trace_analysis::collect_events(uint64_t id, std::vector<analysis_event> &events)
+{
+	analysis_object &object = _objects.at(id);
+
+	events.insert(events.end(), object.events.begin(), object.events.end());
+	for (uint64_t child : object.children) {
+		collect_events(child, events);
+	}
+}
+
+void
+spdk_trace_analysis::release(uint64_t id)
+{
+	analysis_object &object = _objects.at(id);
+	std::map<std::pair<uint8_t, uint64_t>, uint64_t>::iterator it;
+
+	for (uint64_t child : object.children) {
+		release(child);
+	}
+
+	it = _live.find(std::make_pair(object.type, object.object_id));
+	if (it != _live.end() && it->second == id) {
+		_live.erase(it);
+	}
+	it = _indexes.find(std::make_pair(object.type, object.object_index));
+	if (it != _indexes.end() && it->second == id) {
+		_indexes.erase(it);
+	}
+
+	_objects.erase(id);
+}
+
+void
+spdk_trace_analysis::add_latency(analysis_stage &stage, uint64_t latency, size_t position)
+{
+	if (stage.histogram == NULL) {
+		stage.histogram = spdk_histogram_data_alloc();
+		if (stage.histogram == NULL) {
+			throw std::bad_alloc();
+		}
+	}
+
+	spdk_histogram_data_tally(stage.histogram, latency);
+	stage.count++;
+	stage.total += latency;
+	stage.max = spdk_max(stage.max, latency);
+	stage.position = spdk_min(stage.position, position);
+}
+
+/*
+ * Account the latencies of a request.  Requests are known to be done once the ID of their root
+ * object is reused.  The ones left at the end of the trace are only considered done if they
+ * ended with a tracepoint that ended a done request of the same class, the others were still in
+ * flight (or their last entries were dropped) and would report bogus latencies.
+ */
+void
+spdk_trace_analysis::finish_request(uint64_t id, bool done)
+{
+	std::vector<analysis_event> events;
+	analysis_request request;
+	size_t i;
+
+	collect_events(id, events);
+	release(id);
+
+	if (events.empty() || (done && events.size() < 2)) {
+		return;
+	}
+
+	std::stable_sort(events.begin(), events.end(),
+	[](const analysis_event & a, const analysis_event & b) { return a.tsc < b.tsc; });
+
+	analysis_class &cls = _classes[events.front().tpoint_id];
+	if (done) {
+		cls.last_tpoints.insert(events.back().tpoint_id);
+	} else if (events.size() < 2 || cls.last_tpoints.count(events.back().tpoint_id) == 0) {
+		cls.incomplete++;
+		return;
+	}
+
+	for (i = 1; i < events.size(); i++) {
+		add_latency(cls.stages[std::make_pair(events[i - 1].tpoint_id, events[i].tpoint_id)],
+			    events[i].tsc - events[i - 1].tsc, i);
+	}
+
+	request.latency = events.back().tsc - events.front().tsc;
+	add_latency(cls.total, request.latency, 0);
+
+	if (_opts.top_n == 0) {
+		return;
+	}
+
+	if (_slowest.size() == _opts.top_n) {
+		if (_slowest.top().latency >= request.latency) {
+			return;
+		}
+		_slowest.pop();
+	}
+
+	request.events = std::move(events);
+	_slowest.push(std::move(request));
+}
+
+void
+spdk_trace_analysis::finish()
+{
+	std::vector<uint64_t> roots;
+
+	for (const auto &kv : _objects) {
+		if (kv.second.parent == ANALYSIS_NO_OBJECT) {
+			roots.push_back(kv.first);
+		}
+	}
+
+	/* Keep the order in which the requests were started */
+	std::sort(roots.begin(), roots.end());
+	for (uint64_t id : roots) {
+		finish_request(id, false);
+	}
+}
+
+struct latency_cutoffs {
+	uint64_t	tsc[SPDK_COUNTOF(g_latency_cutoffs)];
+	size_t		idx;
+};
+
+static void
+check_cutoff(void *ctx, uint64_t start, uint64_t end, uint64_t count, uint64_t total,
+	     uint64_t so_far)
+{
+	latency_cutoffs *cutoffs = static_cast<latency_cutoffs *>(ctx);
+
+	if (count == 0) {
+		return;
+	}
+
+	while (cutoffs->idx < SPDK_COUNTOF(g_latency_cutoffs) &&
+	       (double)so_far / total >= g_latency_cutoffs[cutoffs->idx]) {
+		cutoffs->tsc[cutoffs->idx++] = end;
+	}
+}
+
+void
+spdk_trace_analysis::print_stage(FILE *file, const char *name, const analysis_stage &stage)
+{
+	latency_cutoffs cutoffs = {};
+
+	spdk_histogram_data_iterate(stage.histogram, check_cutoff, &cutoffs);
+
+	fprintf(file, "  %-56s %10ju %10.3f", name, stage.count,
+		tsc_to_us(stage.total / stage.count));
+	for (size_t i = 0; i < SPDK_COUNTOF(g_latency_cutoffs); i++) {
+		/* Buckets only give an upper bound of the latencies they hold */
+		fprintf(file, " %10.3f", tsc_to_us(spdk_min(cutoffs.tsc[i], stage.max)));
+	}
+	fprintf(file, " %10.3f\n", tsc_to_us(stage.max));
+}
+
+struct histogram_ctx {
+	FILE		*file;
+	double		tsc_rate;
+};
+
+static void
+print_bucket(void *ctx, uint64_t start, uint64_t end, uint64_t count, uint64_t total,
+	     uint64_t so_far)
+{
+	histogram_ctx *hctx = static_cast<histogram_ctx *>(ctx);
+
+	if (count == 0) {
+		return;
+	}
+
+	fprintf(hctx->file, "    %12.3f - %12.3f: %9.4f%%  (%9ju)\n",
+		(double)start * 1000 * 1000 / hctx->tsc_rate,
+		(double)end * 1000 * 1000 / hctx->tsc_rate,
+		(double)so_far * 100 / total, count);
+}
+
+void
+spdk_trace_analysis::print_histogram(FILE *file, const analysis_stage &stage)
+{
+	histogram_ctx ctx = { file, (double)_flags->tsc_rate };
+
+	fprintf(file, "    %12s   %12s   %10s   %11s\n", "Range (us)", "", "Cumulative", "Count");
+	spdk_histogram_data_iterate(stage.histogram, print_bucket, &ctx);
+}
+
+void
+spdk_trace_analysis::report(FILE *file)
+{
+	std::vector<const stage_map::value_type *> stages;
+	std::vector<analysis_request> slowest;
+	char name[128];
+	size_t i;
+
+	for (auto &kv : _classes) {
+		analysis_class &cls = kv.second;
+
+		if (cls.total.count == 0) {
+			fprintf(file, "\n%ju requests starting with %s, all still in flight\n",
+				cls.incomplete, tpoint_name(kv.first));
+			continue;
+		}
+
+		fprintf(file, "\n%ju requests starting with %s, latencies in usec:\n", cls.total.count,
+			tpoint_name(kv.first));
+		if (cls.incomplete != 0) {
+			fprintf(file, "  (%ju more still in flight at the end of the trace, not included)\n",
+				cls.incomplete);
+		}
+		fprintf(file, "  %-56s %10s %10s %10s %10s %10s %10s %10s\n", "Stage", "Count",
+			"Average", "p50", "p90", "p99", "p99.9", "Max");
+
+		stages.clear();
+		for (auto &stage : cls.stages) {
+			stages.push_back(&stage);
+		}
+		std::stable_sort(stages.begin(), stages.end(),
+		[](const stage_map::value_type * a, const stage_map::value_type * b) {
+			return a->second.position < b->second.position;
+		});
+
+		for (auto stage : stages) {
+			snprintf(name, sizeof(name), "%s -> %s", tpoint_name(stage->first.first),
+				 tpoint_name(stage->first.second));
+			print_stage(file, name, stage->second);
+		}
+		print_stage(file, "Total", cls.total);
+
+		if (!_opts.histograms) {
+			continue;
+		}
+
+		for (auto stage : stages) {
+			fprintf(file, "\n  %s -> %s:\n", tpoint_name(stage->first.first),
+				tpoint_name(stage->first.second));
+			print_histogram(file, stage->second);
+		}
+		fprintf(file, "\n  Total:\n");
+		print_histogram(file, cls.total);
+	}
+
+	while (!_slowest.empty()) {
+		slowest.push_back(_slowest.top());
+		_slowest.pop();
+	}
+	if (slowest.empty()) {
+		return;
+	}
+
+	fprintf(file, "\nSlowest %zu requests:\n", slowest.size());
+	for (i = slowest.size(); i > 0; i--) {
+		const analysis_request &request = slowest[i - 1];
+		const analysis_event &first = request.events.front();
+
+		fprintf(file, "\n  %s %c%ju: %.3f usec\n", tpoint_name(first.tpoint_id),
+			_flags->object[first.object_type].id_prefix, first.object_index,
+			tsc_to_us(request.latency));
+		for (const analysis_event &event : request.events) {
+			fprintf(file, "    %+12.3f  lcore %3u  %-28s %c%ju\n",
+				tsc_to_us(event.tsc - first.tsc), event.lcore, tpoint_name(event.tpoint_id),
+				_flags->object[event.object_type].id_prefix, event.object_index);
+		}
+	}
+}
+
+struct spdk_trace_analysis *
+spdk_trace_analysis_create(const struct spdk_trace_parser *parser,
+			   const struct spdk_trace_analysis_opts *opts)
+{
+	try {
+		return new spdk_trace_analysis(parser, opts);
+	} catch (...) {
+		return NULL;
+	}
+}
+
+int
+spdk_trace_analysis_add_entry(struct spdk_trace_analysis *analysis,
+			      const struct spdk_trace_parser_entry *entry)
+{
+	try {
+		analysis->add_entry(entry);
+	} catch (...) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+int
+spdk_trace_analysis_report(struct spdk_trace_analysis *analysis, FILE *file)
+{
+	try {
+		analysis->finish();
+		analysis->report(file);
+	} catch (...) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+void
+spdk_trace_analysis_free(struct spdk_trace_analysis *analysis)
+{
+	delete analysis;
+}
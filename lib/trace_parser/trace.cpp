@@ -4,14 +4,22 @@
  */
 
 #include "spdk/stdinc.h"
+#include "spdk/config.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
 #include "spdk/trace_parser.h"
 #include "spdk/util.h"
+#include "spdk_internal/trace_stream.h"
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/igzip_lib.h"
+#endif
 
 #include <exception>
 #include <map>
 #include <new>
+#include <set>
+#include <vector>
 
 struct entry_key {
 	entry_key(uint16_t _lcore, uint64_t _tsc) : lcore(_lcore), tsc(_tsc) {}
@@ -53,6 +61,17 @@ struct argument_context {
 	}
 };
 
+/* Blocks of a single trace history of a trace stream file, decoded one at a time */
+struct stream_cursor {
+	std::vector<spdk_trace_stream_index_entry>	blocks;
+	size_t						next_block;
+	/* Entries of the current block, and of the next one if an entry spills into it */
+	std::vector<spdk_trace_entry>			entries;
+	size_t						pos;
+
+	stream_cursor() : next_block(0), pos(0) {}
+};
+
 struct object_stats {
 	std::map<uint64_t, uint64_t>	index;
 	std::map<uint64_t, uint64_t>	start;
@@ -70,42 +89,113 @@ struct spdk_trace_parser {
 	uint64_t tsc_offset() const { return _tsc_offset; }
 	bool next_entry(spdk_trace_parser_entry *entry);
 	uint64_t entry_count(uint16_t lcore) const;
+	uint64_t dropped_count(uint16_t lcore) const;
 private:
 	spdk_trace_entry_buffer *get_next_buffer(spdk_trace_entry_buffer *buf, uint16_t lcore);
 	bool build_arg(argument_context *argctx, const spdk_trace_argument *arg, int argid,
 		       spdk_trace_parser_entry *pe);
-	void populate_events(spdk_trace_history *history, int num_entries);
+	void populate_events(spdk_trace_history *history, uint64_t num_entries);
+	bool map_histories(const spdk_trace_parser_opts *opts, size_t file_size);
+	bool read_stream_index(size_t file_size, std::vector<spdk_trace_stream_index_entry> &index);
+	bool read_stream_block(const spdk_trace_stream_index_entry &index, spdk_trace_entry *entries);
+	bool load_stream(const spdk_trace_parser_opts *opts, size_t file_size);
+	bool decode_stream_block(uint16_t lcore, bool append);
+	bool seek_stream_entry(uint16_t lcore);
+	spdk_trace_entry *next_stream_entry(uint16_t *lcore);
 	bool init(const spdk_trace_parser_opts *opts);
 	void cleanup();
 
 	spdk_trace_histories	*_histories;
 	size_t			_map_size;
+	/* Tracepoint definitions of a trace stream file, _histories points to it */
+	uint8_t			*_stream_buf;
+	uint64_t		_num_dropped[SPDK_TRACE_MAX_HISTORIES];
 	int			_fd;
 	uint64_t		_tsc_offset;
 	entry_map		_entries;
 	entry_map::iterator	_iter;
 	object_stats		_stats[SPDK_TRACE_MAX_OBJECT];
+	/*
+	 * A trace stream file may be far larger than the memory, so its entries aren't sorted up
+	 *  front.  Instead, the histories are merged block by block, keyed by their next entry.
+	 */
+	stream_cursor		_cursors[SPDK_TRACE_MAX_HISTORIES];
+	std::set<entry_key, compare_entry_key> _stream_heads;
+	/* History of the last returned entry, which is only advanced on the next call */
+	uint16_t		_stream_lcore;
+	std::vector<uint8_t>	_stream_data;
 };
 
+/* Number of buffers following an entry of a tracepoint that hold the rest of its arguments */
+static size_t
+get_num_arg_buffers(const spdk_trace_tpoint *tpoint)
+{
+	size_t size = 0, first;
+
+	/* See argument_context for the offset of the first argument */
+	first = sizeof(spdk_trace_entry_buffer::data) -
+		(offsetof(spdk_trace_entry, args) - offsetof(spdk_trace_entry_buffer, data));
+	for (uint8_t i = 0; i < tpoint->num_args; ++i) {
+		size += tpoint->args[i].size;
+	}
+
+	if (size <= first) {
+		return 0;
+	}
+
+	return SPDK_CEIL_DIV(size - first, sizeof(spdk_trace_entry_buffer::data));
+}
+
 uint64_t
 spdk_trace_parser::entry_count(uint16_t lcore) const
 {
 	spdk_trace_history *history;
+	uint64_t num_entries = 0;
 
-	if (lcore >= SPDK_TRACE_MAX_LCORE) {
+	if (lcore >= SPDK_TRACE_MAX_HISTORIES) {
 		return 0;
 	}
 
+	if (_stream_buf != NULL) {
+		for (const spdk_trace_stream_index_entry &block : _cursors[lcore].blocks) {
+			num_entries += block.num_entries;
+		}
+
+		return num_entries;
+	}
+
 	history = spdk_get_per_lcore_history(_histories, lcore);
 
 	return history == NULL ? 0 : history->num_entries;
 }
 
+uint64_t
+spdk_trace_parser::dropped_count(uint16_t lcore) const
+{
+	if (lcore >= SPDK_TRACE_MAX_HISTORIES) {
+		return 0;
+	}
+
+	return _num_dropped[lcore];
+}
+
 spdk_trace_entry_buffer *
 spdk_trace_parser::get_next_buffer(spdk_trace_entry_buffer *buf, uint16_t lcore)
 {
 	spdk_trace_history *history;
 
+	if (_stream_buf != NULL) {
+		const stream_cursor &cursor = _cursors[lcore];
+
+		/* The rest of the arguments is missing, the file must be truncated */
+		if (static_cast<void *>(buf + 1) ==
+		    static_cast<const void *>(cursor.entries.data() + cursor.entries.size())) {
+			return NULL;
+		}
+
+		return buf + 1;
+	}
+
 	history = spdk_get_per_lcore_history(_histories, lcore);
 	assert(history);
 
@@ -133,7 +223,7 @@ spdk_trace_parser::build_arg(argument_context *argctx, const spdk_trace_argument
 	while (argoff < arg->size) {
 		if (argctx->offset == sizeof(buffer->data)) {
 			buffer = get_next_buffer(buffer, argctx->lcore);
-			if (spdk_unlikely(buffer->tpoint_id != SPDK_TRACE_MAX_TPOINT_ID ||
+			if (spdk_unlikely(buffer == NULL || buffer->tpoint_id != SPDK_TRACE_MAX_TPOINT_ID ||
 					  buffer->tsc != entry->tsc)) {
 				return false;
 			}
@@ -163,12 +253,21 @@ spdk_trace_parser::next_entry(spdk_trace_parser_entry *pe)
 	object_stats *stats;
 	std::map<uint64_t, uint64_t>::iterator related_kv;
 
-	if (_iter == _entries.end()) {
-		return false;
+	if (_stream_buf != NULL) {
+		entry = next_stream_entry(&pe->lcore);
+		if (entry == NULL) {
+			return false;
+		}
+	} else {
+		if (_iter == _entries.end()) {
+			return false;
+		}
+
+		entry = _iter->second;
+		pe->lcore = _iter->first.lcore;
 	}
 
-	pe->entry = entry = _iter->second;
-	pe->lcore = _iter->first.lcore;
+	pe->entry = entry;
 	/* Set related index to the max value to indicate "empty" state */
 	pe->related_index = UINT64_MAX;
 	pe->related_type = OBJECT_NONE;
@@ -216,16 +315,20 @@ spdk_trace_parser::next_entry(spdk_trace_parser_entry *pe)
 		}
 	}
 
-	_iter++;
+	if (_stream_buf == NULL) {
+		_iter++;
+	}
+
 	return true;
 }
 
 void
-spdk_trace_parser::populate_events(spdk_trace_history *history, int num_entries)
+spdk_trace_parser::populate_events(spdk_trace_history *history, uint64_t num_entries)
 {
-	int i, num_entries_filled;
+	uint64_t i, num_entries_filled;
 	spdk_trace_entry *e;
-	int first, last, lcore;
+	uint64_t first, last;
+	uint16_t lcore;
 
 	lcore = history->lcore;
 	e = history->entries;
@@ -280,6 +383,7 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 {
 	spdk_trace_history *history;
 	struct stat st;
+	char magic[sizeof(SPDK_TRACE_STREAM_MAGIC)];
 	int rc, i;
 
 	switch (opts->mode) {
@@ -305,7 +409,46 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 		return false;
 	}
 
-	if ((size_t)st.st_size < sizeof(*_histories)) {
+	if ((size_t)st.st_size >= sizeof(magic) && pread(_fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+	    memcmp(magic, SPDK_TRACE_STREAM_MAGIC, sizeof(magic)) == 0) {
+		if (!load_stream(opts, st.st_size)) {
+			return false;
+		}
+
+		return true;
+	} else if (!map_histories(opts, st.st_size)) {
+		return false;
+	}
+
+	if (opts->lcore == SPDK_TRACE_MAX_LCORE) {
+		for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+			history = spdk_get_per_lcore_history(_histories, i);
+			if (history == NULL || history->num_entries == 0 || history->entries[0].tsc == 0) {
+				continue;
+			}
+
+			populate_events(history, history->num_entries);
+		}
+	} else {
+		history = spdk_get_per_lcore_history(_histories, opts->lcore);
+		if (history == NULL) {
+			SPDK_ERRLOG("Trace file %s has no trace history for lcore %d\n",
+				    opts->filename, opts->lcore);
+			return false;
+		}
+		if (history->num_entries > 0 && history->entries[0].tsc != 0) {
+			populate_events(history, history->num_entries);
+		}
+	}
+
+	_iter = _entries.begin();
+	return true;
+}
+
+bool
+spdk_trace_parser::map_histories(const spdk_trace_parser_opts *opts, size_t file_size)
+{
+	if (file_size < sizeof(*_histories)) {
 		SPDK_ERRLOG("Invalid trace file: %s\n", opts->filename);
 		return false;
 	}
@@ -320,10 +463,18 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 		return false;
 	}
 
+	if (_histories->flags.version != SPDK_TRACE_VERSION) {
+		SPDK_ERRLOG("Trace file %s has version %" PRIu64 ", expected %d\n", opts->filename,
+			    _histories->flags.version, SPDK_TRACE_VERSION);
+		munmap(_histories, sizeof(*_histories));
+		_histories = NULL;
+		return false;
+	}
+
 	/* Remap the entire trace file */
 	_map_size = spdk_get_trace_histories_size(_histories);
 	munmap(_histories, sizeof(*_histories));
-	if ((size_t)st.st_size < _map_size) {
+	if (file_size < _map_size) {
 		SPDK_ERRLOG("Trace file %s is not valid\n", opts->filename);
 		_histories = NULL;
 		return false;
@@ -336,35 +487,260 @@ spdk_trace_parser::init(const spdk_trace_parser_opts *opts)
 		return false;
 	}
 
-	if (opts->lcore == SPDK_TRACE_MAX_LCORE) {
-		for (i = 0; i < SPDK_TRACE_MAX_LCORE; i++) {
-			history = spdk_get_per_lcore_history(_histories, i);
-			if (history == NULL || history->num_entries == 0 || history->entries[0].tsc == 0) {
-				continue;
-			}
+	return true;
+}
 
-			populate_events(history, history->num_entries);
+bool
+spdk_trace_parser::read_stream_index(size_t file_size,
+				     std::vector<spdk_trace_stream_index_entry> &index)
+{
+	spdk_trace_stream_footer footer;
+	spdk_trace_stream_block block;
+	spdk_trace_stream_index_entry entry = {};
+	size_t offset, size;
+
+	if (file_size >= sizeof(spdk_trace_stream_header) + sizeof(footer) &&
+	    pread(_fd, &footer, sizeof(footer), file_size - sizeof(footer)) == sizeof(footer) &&
+	    memcmp(footer.magic, SPDK_TRACE_STREAM_MAGIC, sizeof(footer.magic)) == 0 &&
+	    footer.index_offset + footer.num_blocks * sizeof(entry) + sizeof(footer) == file_size) {
+		size = footer.num_blocks * sizeof(entry);
+		index.resize(footer.num_blocks);
+		if (pread(_fd, index.data(), size, footer.index_offset) != (ssize_t)size) {
+			return false;
 		}
-	} else {
-		history = spdk_get_per_lcore_history(_histories, opts->lcore);
-		if (history == NULL) {
-			SPDK_ERRLOG("Trace file %s has no trace history for lcore %d\n",
-				    opts->filename, opts->lcore);
+
+		memcpy(_num_dropped, footer.num_dropped, sizeof(_num_dropped));
+		return true;
+	}
+
+	/* The capture didn't finish properly, so there's no index, walk the blocks instead */
+	SPDK_NOTICELOG("Trace stream file has no index, it may be truncated\n");
+	for (offset = sizeof(spdk_trace_stream_header); offset + sizeof(block) <= file_size;
+	     offset += sizeof(block) + block.data_size) {
+		if (pread(_fd, &block, sizeof(block), offset) != sizeof(block) ||
+		    block.magic != SPDK_TRACE_STREAM_BLOCK_MAGIC ||
+		    offset + sizeof(block) + block.data_size > file_size) {
+			break;
+		}
+
+		entry.offset = offset;
+		entry.first_tsc = block.first_tsc;
+		entry.last_tsc = block.last_tsc;
+		entry.num_entries = block.num_entries;
+		entry.lcore = block.lcore;
+		index.push_back(entry);
+	}
+
+	return true;
+}
+
+bool
+spdk_trace_parser::read_stream_block(const spdk_trace_stream_index_entry &index,
+				     spdk_trace_entry *entries)
+{
+	spdk_trace_stream_block block;
+	size_t size = index.num_entries * sizeof(*entries);
+
+	if (pread(_fd, &block, sizeof(block), index.offset) != sizeof(block) ||
+	    block.magic != SPDK_TRACE_STREAM_BLOCK_MAGIC || block.lcore != index.lcore ||
+	    block.num_entries != index.num_entries) {
+		return false;
+	}
+
+	switch (block.encoding) {
+	case SPDK_TRACE_STREAM_ENCODING_RAW:
+		return block.data_size == size &&
+		       pread(_fd, entries, size, index.offset + sizeof(block)) == (ssize_t)size;
+	case SPDK_TRACE_STREAM_ENCODING_DEFLATE:
+#ifdef SPDK_CONFIG_ISAL
+	{
+		inflate_state state;
+
+		_stream_data.resize(block.data_size);
+		if (pread(_fd, _stream_data.data(), block.data_size, index.offset + sizeof(block)) !=
+		    (ssize_t)block.data_size) {
 			return false;
 		}
-		if (history->num_entries > 0 && history->entries[0].tsc != 0) {
-			populate_events(history, history->num_entries);
+
+		isal_inflate_init(&state);
+		state.next_in = _stream_data.data();
+		state.avail_in = block.data_size;
+		state.next_out = reinterpret_cast<uint8_t *>(entries);
+		state.avail_out = size;
+
+		return isal_inflate_stateless(&state) == ISAL_DECOMP_OK && state.total_out == size;
+	}
+#else
+		SPDK_ERRLOG("Reading compressed trace blocks requires ISA-L support\n");
+		return false;
+#endif
+	default:
+		SPDK_ERRLOG("Invalid trace block encoding: %u\n", block.encoding);
+		return false;
+	}
+}
+
+/*
+ * Decode the next block of a history.  The block replaces the entries of the current one, or is
+ *  appended to them if the arguments of the current entry spill into it.
+ */
+bool
+spdk_trace_parser::decode_stream_block(uint16_t lcore, bool append)
+{
+	stream_cursor &cursor = _cursors[lcore];
+	size_t num_entries;
+
+	if (cursor.next_block == cursor.blocks.size()) {
+		return false;
+	}
+
+	const spdk_trace_stream_index_entry &block = cursor.blocks[cursor.next_block];
+
+	if (append) {
+		cursor.entries.erase(cursor.entries.begin(), cursor.entries.begin() + cursor.pos);
+	} else {
+		cursor.entries.clear();
+	}
+	cursor.pos = 0;
+
+	num_entries = cursor.entries.size();
+	cursor.entries.resize(num_entries + block.num_entries);
+	if (!read_stream_block(block, &cursor.entries[num_entries])) {
+		SPDK_ERRLOG("Could not read trace block at offset %ju\n", block.offset);
+		cursor.entries.resize(num_entries);
+		/* Don't try the following blocks, there'd be a gap in the history */
+		cursor.next_block = cursor.blocks.size();
+		return false;
+	}
+
+	cursor.next_block++;
+	return true;
+}
+
+/* Move to the next entry of a history, skipping the buffers holding arguments */
+bool
+spdk_trace_parser::seek_stream_entry(uint16_t lcore)
+{
+	stream_cursor &cursor = _cursors[lcore];
+
+	while (cursor.pos == cursor.entries.size() ||
+	       cursor.entries[cursor.pos].tpoint_id == SPDK_TRACE_MAX_TPOINT_ID) {
+		if (cursor.pos == cursor.entries.size()) {
+			if (!decode_stream_block(lcore, false)) {
+				return false;
+			}
+		} else {
+			cursor.pos++;
 		}
 	}
 
-	_iter = _entries.begin();
+	_stream_heads.insert(entry_key(lcore, cursor.entries[cursor.pos].tsc));
+	return true;
+}
+
+spdk_trace_entry *
+spdk_trace_parser::next_stream_entry(uint16_t *lcore)
+{
+	spdk_trace_entry *entry;
+
+	/* The previous entry is no longer used, so its history can be advanced */
+	if (_stream_lcore < SPDK_TRACE_MAX_HISTORIES) {
+		_cursors[_stream_lcore].pos++;
+		seek_stream_entry(_stream_lcore);
+		_stream_lcore = SPDK_TRACE_MAX_HISTORIES;
+	}
+
+	if (_stream_heads.empty()) {
+		return NULL;
+	}
+
+	*lcore = _stream_heads.begin()->lcore;
+	_stream_heads.erase(_stream_heads.begin());
+
+	stream_cursor &cursor = _cursors[*lcore];
+	entry = &cursor.entries[cursor.pos];
+	if (cursor.pos + get_num_arg_buffers(&_histories->flags.tpoint[entry->tpoint_id]) >=
+	    cursor.entries.size() && decode_stream_block(*lcore, true)) {
+		entry = &cursor.entries[cursor.pos];
+	}
+
+	_stream_lcore = *lcore;
+	return entry;
+}
+
+bool
+spdk_trace_parser::load_stream(const spdk_trace_parser_opts *opts, size_t file_size)
+{
+	spdk_trace_stream_header header;
+	std::vector<spdk_trace_stream_index_entry> index;
+	uint64_t first_tsc;
+	int i;
+
+	if (pread(_fd, &header, sizeof(header), 0) != sizeof(header) ||
+	    header.version != SPDK_TRACE_STREAM_VERSION ||
+	    header.flags.version != SPDK_TRACE_VERSION) {
+		SPDK_ERRLOG("Invalid trace stream file: %s\n", opts->filename);
+		return false;
+	}
+
+	if (!read_stream_index(file_size, index)) {
+		SPDK_ERRLOG("Could not read trace stream index: %s\n", opts->filename);
+		return false;
+	}
+
+	/* Only the tracepoint definitions are kept in memory, the entries are read on demand */
+	_stream_buf = static_cast<uint8_t *>(calloc(1, sizeof(*_histories)));
+	if (_stream_buf == NULL) {
+		SPDK_ERRLOG("Could not allocate memory for trace stream: %s\n", opts->filename);
+		return false;
+	}
+
+	_histories = reinterpret_cast<spdk_trace_histories *>(_stream_buf);
+	memcpy(&_histories->flags, &header.flags, sizeof(header.flags));
+	memset(_histories->flags.lcore_history_offsets, 0,
+	       sizeof(_histories->flags.lcore_history_offsets));
+
+	for (const spdk_trace_stream_index_entry &entry : index) {
+		if (entry.lcore < SPDK_TRACE_MAX_HISTORIES && entry.num_entries > 0 &&
+		    (opts->lcore == SPDK_TRACE_MAX_LCORE || entry.lcore == opts->lcore)) {
+			_cursors[entry.lcore].blocks.push_back(entry);
+		}
+	}
+
+	if (opts->lcore != SPDK_TRACE_MAX_LCORE &&
+	    (opts->lcore >= SPDK_TRACE_MAX_HISTORIES || _cursors[opts->lcore].blocks.empty())) {
+		SPDK_ERRLOG("Trace file %s has no trace history for lcore %d\n",
+			    opts->filename, opts->lcore);
+		return false;
+	}
+
+	for (i = 0; i < SPDK_TRACE_MAX_HISTORIES; i++) {
+		if (_cursors[i].blocks.empty()) {
+			continue;
+		}
+
+		/* Same as populate_events(), only keep the time range covered by all histories */
+		first_tsc = UINT64_MAX;
+		for (const spdk_trace_stream_index_entry &block : _cursors[i].blocks) {
+			first_tsc = spdk_min(first_tsc, block.first_tsc);
+		}
+		_tsc_offset = spdk_max(_tsc_offset, first_tsc);
+
+		if (!decode_stream_block(i, false)) {
+			return false;
+		}
+		seek_stream_entry(i);
+	}
+
 	return true;
 }
 
 void
 spdk_trace_parser::cleanup()
 {
-	if (_histories != NULL) {
+	if (_stream_buf != NULL) {
+		free(_stream_buf);
+	} else if (_histories != NULL) {
 		munmap(_histories, _map_size);
 	}
 
@@ -376,8 +752,11 @@ spdk_trace_parser::cleanup()
 spdk_trace_parser::spdk_trace_parser(const spdk_trace_parser_opts *opts) :
 	_histories(NULL),
 	_map_size(0),
+	_stream_buf(NULL),
+	_num_dropped(),
 	_fd(-1),
-	_tsc_offset(0)
+	_tsc_offset(0),
+	_stream_lcore(SPDK_TRACE_MAX_HISTORIES)
 {
 	if (!init(opts)) {
 		cleanup();
@@ -430,3 +809,9 @@ spdk_trace_parser_get_entry_count(const struct spdk_trace_parser *parser, uint16
 {
 	return parser->entry_count(lcore);
 }
+
+uint64_t
+spdk_trace_parser_get_dropped_count(const struct spdk_trace_parser *parser, uint16_t lcore)
+{
+	return parser->dropped_count(lcore);
+}
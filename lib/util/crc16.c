@@ -3,8 +3,11 @@
  *   All rights reserved.
  */
 
+#include "util_internal.h"
+#include "crc_internal.h"
 #include "spdk/crc16.h"
 #include "spdk/config.h"
+#include "spdk/util.h"
 
 /*
  * Use Intelligent Storage Acceleration Library for line speed CRC
@@ -638,3 +641,126 @@ spdk_crc16_t10dif_copy(uint16_t init_crc, uint8_t *dst, uint8_t *src, size_t len
 }
 
 #endif
+
+#ifdef __x86_64__
+/*
+ * x^128 mod P and x^192 mod P. Multiplying the low and high 64 bits of a 128-bit
+ * accumulator by them folds the accumulator onto the next 128 bits of data.
+ */
+#define CRC16_T10DIF_K128	0xa010
+#define CRC16_T10DIF_K192	0x1faa
+
+/* If dsts is not NULL, the buffers are also copied to dsts while they are folded */
+static inline __attribute__((always_inline, target("pclmul,ssse3"))) void
+crc16_t10dif_fold(uint16_t *crcs, uint8_t **dsts, uint8_t **bufs, size_t len, uint32_t n)
+{
+	const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i k = _mm_set_epi64x(CRC16_T10DIF_K192, CRC16_T10DIF_K128);
+	__m128i acc[SPDK_CRC_MULTI_LANES], raw, data;
+	uint8_t tmp[16];
+	size_t offset;
+	uint32_t i;
+
+	assert(len >= sizeof(tmp));
+	assert(n <= SPDK_CRC_MULTI_LANES);
+
+	/* Starting from an initial CRC is the same as XORing it into the first 2 bytes */
+	for (i = 0; i < n; i++) {
+		raw = _mm_loadu_si128((const __m128i *)bufs[i]);
+		if (dsts != NULL) {
+			_mm_storeu_si128((__m128i *)dsts[i], raw);
+		}
+		acc[i] = _mm_shuffle_epi8(raw, bswap);
+		acc[i] = _mm_xor_si128(acc[i], _mm_set_epi64x((uint64_t)crcs[i] << 48, 0));
+	}
+
+	for (offset = sizeof(tmp); offset + sizeof(tmp) <= len; offset += sizeof(tmp)) {
+		for (i = 0; i < n; i++) {
+			raw = _mm_loadu_si128((const __m128i *)(bufs[i] + offset));
+			if (dsts != NULL) {
+				_mm_storeu_si128((__m128i *)(dsts[i] + offset), raw);
+			}
+			data = _mm_shuffle_epi8(raw, bswap);
+			data = _mm_xor_si128(data, _mm_clmulepi64_si128(acc[i], k, 0x11));
+			acc[i] = _mm_xor_si128(data, _mm_clmulepi64_si128(acc[i], k, 0x00));
+		}
+	}
+
+	/* The accumulator is congruent to the data folded so far, reduce it with the tail */
+	for (i = 0; i < n; i++) {
+		_mm_storeu_si128((__m128i *)tmp, _mm_shuffle_epi8(acc[i], bswap));
+		crcs[i] = spdk_crc16_t10dif(0, tmp, sizeof(tmp));
+		if (dsts != NULL) {
+			crcs[i] = spdk_crc16_t10dif_copy(crcs[i], dsts[i] + offset, bufs[i] + offset,
+							 len - offset);
+		} else {
+			crcs[i] = spdk_crc16_t10dif(crcs[i], bufs[i] + offset, len - offset);
+		}
+	}
+}
+
+__attribute__((target("pclmul,ssse3"))) static void
+crc16_t10dif_multi_pclmul(uint16_t *crcs, uint8_t **bufs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i += SPDK_CRC_MULTI_LANES) {
+		crc16_t10dif_fold(&crcs[i], NULL, &bufs[i], len,
+				  spdk_min(n - i, SPDK_CRC_MULTI_LANES));
+	}
+}
+
+__attribute__((target("pclmul,ssse3"))) static void
+crc16_t10dif_copy_multi_pclmul(uint16_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len,
+			       uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i += SPDK_CRC_MULTI_LANES) {
+		crc16_t10dif_fold(&crcs[i], &dsts[i], &srcs[i], len,
+				  spdk_min(n - i, SPDK_CRC_MULTI_LANES));
+	}
+}
+
+/* Whether the CPU supports the carry-less multiplication the kernels above use */
+static bool g_crc16_pclmul;
+
+__attribute__((constructor)) static void
+crc16_multi_init(void)
+{
+	__builtin_cpu_init();
+	g_crc16_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+#endif
+
+void
+crc16_t10dif_multi(uint16_t *crcs, uint8_t **bufs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+#ifdef __x86_64__
+	if (g_crc16_pclmul && len >= 16) {
+		crc16_t10dif_multi_pclmul(crcs, bufs, len, n);
+		return;
+	}
+#endif
+	for (i = 0; i < n; i++) {
+		crcs[i] = spdk_crc16_t10dif(crcs[i], bufs[i], len);
+	}
+}
+
+void
+crc16_t10dif_copy_multi(uint16_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+#ifdef __x86_64__
+	if (g_crc16_pclmul && len >= 16) {
+		crc16_t10dif_copy_multi_pclmul(crcs, dsts, srcs, len, n);
+		return;
+	}
+#endif
+	for (i = 0; i < n; i++) {
+		crcs[i] = spdk_crc16_t10dif_copy(crcs[i], dsts[i], srcs[i], len);
+	}
+}
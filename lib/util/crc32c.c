@@ -6,6 +6,62 @@
 #include "util_internal.h"
 #include "crc_internal.h"
 #include "spdk/crc32.h"
+#include "spdk/util.h"
+
+/*
+ * GF(2) polynomials modulo the CRC-32C polynomial are represented bit reflected, x^0 is the
+ * most significant bit. g_crc32c_x2n[k] is x^(2^k) modulo the polynomial.
+ */
+static uint32_t g_crc32c_x2n[32];
+
+static uint32_t
+crc32c_multmodp(uint32_t a, uint32_t b)
+{
+	uint32_t m = 1U << 31, p = 0;
+
+	while (m != 0) {
+		if (a & m) {
+			p ^= b;
+		}
+		m >>= 1;
+		b = (b & 1) ? (b >> 1) ^ SPDK_CRC32C_POLYNOMIAL_REFLECT : b >> 1;
+	}
+
+	return p;
+}
+
+/* x^(n * 2^k) modulo the polynomial */
+static uint32_t
+crc32c_x2nmodp(uint64_t n, uint32_t k)
+{
+	uint32_t p = 1U << 31;
+
+	while (n != 0) {
+		if (n & 1) {
+			p = crc32c_multmodp(g_crc32c_x2n[k & 31], p);
+		}
+		n >>= 1;
+		k++;
+	}
+
+	return p;
+}
+
+static void crc32c_kernel_init(void);
+
+__attribute__((constructor)) static void
+crc32c_combine_init(void)
+{
+	uint32_t p = 1U << 30, k;
+
+	/* x^1, then square it */
+	for (k = 0; k < SPDK_COUNTOF(g_crc32c_x2n); k++) {
+		g_crc32c_x2n[k] = p;
+		p = crc32c_multmodp(p, p);
+	}
+
+	crc32c_kernel_init();
+}
 
 #ifdef SPDK_HAVE_ISAL
 
@@ -15,8 +71,81 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	return crc32_iscsi((unsigned char *)buf, len, crc);
 }
 
+static void
+crc32c_kernel_init(void)
+{
+}
+
 #elif defined(SPDK_HAVE_SSE4_2)
 
+#ifdef SPDK_HAVE_PCLMUL
+/*
+ * The CRC instruction has a latency of 3 cycles but a throughput of 1 per cycle. Three blocks
+ * are checksummed at once and their CRCs are merged by shifting them over the following blocks.
+ * Long blocks amortize the merge, short blocks handle buffers of a few KiB.
+ */
+#define CRC32C_LONG_BLOCK	2048
+#define CRC32C_SHORT_BLOCK	256
+
+/*
+ * Constants to shift a CRC over one and two blocks, x^(8 * block * i - 33). The product of
+ * two reflected 32-bit values and the CRC instruction add 33 more powers of x.
+ */
+static uint32_t g_crc32c_long_k[2];
+static uint32_t g_crc32c_short_k[2];
+
+static void
+crc32c_kernel_init(void)
+{
+	g_crc32c_long_k[0] = crc32c_x2nmodp(8 * CRC32C_LONG_BLOCK - 33, 0);
+	g_crc32c_long_k[1] = crc32c_x2nmodp(16 * CRC32C_LONG_BLOCK - 33, 0);
+	g_crc32c_short_k[0] = crc32c_x2nmodp(8 * CRC32C_SHORT_BLOCK - 33, 0);
+	g_crc32c_short_k[1] = crc32c_x2nmodp(16 * CRC32C_SHORT_BLOCK - 33, 0);
+}
+
+static inline uint64_t
+crc32c_shift(uint64_t crc, uint32_t k)
+{
+	__m128i prod;
+
+	prod = _mm_clmulepi64_si128(_mm_cvtsi64_si128(crc), _mm_cvtsi32_si128(k), 0);
+
+	return _mm_crc32_u64(0, _mm_cvtsi128_si64(prod));
+}
+
+static inline uint64_t
+crc32c_3way(const uint64_t **_buf, size_t *_count, uint64_t crc, size_t block, const uint32_t *k)
+{
+	const uint64_t *buf = *_buf;
+	size_t count = *_count, i, n = block / sizeof(uint64_t);
+	uint64_t crc1, crc2;
+
+	while (count >= 3 * n) {
+		crc1 = 0;
+		crc2 = 0;
+		for (i = 0; i < n; i++) {
+			crc = _mm_crc32_u64(crc, buf[i]);
+			crc1 = _mm_crc32_u64(crc1, buf[n + i]);
+			crc2 = _mm_crc32_u64(crc2, buf[2 * n + i]);
+		}
+
+		crc = crc32c_shift(crc, k[1]) ^ crc32c_shift(crc1, k[0]) ^ crc2;
+		buf += 3 * n;
+		count -= 3 * n;
+	}
+
+	*_buf = buf;
+	*_count = count;
+
+	return crc;
+}
+#else
+static void
+crc32c_kernel_init(void)
+{
+}
+#endif
+
 uint32_t
 spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 {
@@ -28,7 +157,8 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	 * passed to _mm_crc32_u64 is 8 byte aligned. This can avoid unaligned loads.
 	 */
 	count_pre = ((uint64_t)buf & 7) == 0 ? 0 : 8 - ((uint64_t)buf & 7);
-	count_post = (uint64_t)((uintptr_t)buf + len) & 7;
+	count_pre = spdk_min(count_pre, len);
+	count_post = count_pre == len ? 0 : (uint64_t)((uintptr_t)buf + len) & 7;
 	count_mid = (len - count_pre - count_post) / 8;
 
 	while (count_pre--) {
@@ -40,6 +170,11 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	crc_tmp64 = crc;
 	dword_buf = (const uint64_t *)buf;
 
+#ifdef SPDK_HAVE_PCLMUL
+	crc_tmp64 = crc32c_3way(&dword_buf, &count_mid, crc_tmp64, CRC32C_LONG_BLOCK, g_crc32c_long_k);
+	crc_tmp64 = crc32c_3way(&dword_buf, &count_mid, crc_tmp64, CRC32C_SHORT_BLOCK, g_crc32c_short_k);
+#endif
+
 	while (count_mid--) {
 		crc_tmp64 = _mm_crc32_u64(crc_tmp64, *dword_buf);
 		dword_buf++;
@@ -57,6 +192,11 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 
 #elif defined(SPDK_HAVE_ARM_CRC)
 
+static void
+crc32c_kernel_init(void)
+{
+}
+
 uint32_t
 spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 {
@@ -67,7 +207,8 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 	 * passed to crc32_cd is 8 byte aligned. This can avoid unaligned loads.
 	 */
 	count_pre = ((uint64_t)buf & 7) == 0 ? 0 : 8 - ((uint64_t)buf & 7);
-	count_post = (uint64_t)(buf + len) & 7;
+	count_pre = spdk_min(count_pre, len);
+	count_post = count_pre == len ? 0 : (uint64_t)(buf + len) & 7;
 	count_mid = (len - count_pre - count_post) / 8;
 
 	while (count_pre--) {
@@ -94,8 +235,8 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 
 static struct spdk_crc32_table g_crc32c_table;
 
-__attribute__((constructor)) static void
-crc32c_init(void)
+static void
+crc32c_kernel_init(void)
 {
 	crc32_table_init(&g_crc32c_table, SPDK_CRC32C_POLYNOMIAL_REFLECT);
 }
@@ -108,6 +249,29 @@ spdk_crc32c_update(const void *buf, size_t len, uint32_t crc)
 
 #endif
 
+/*
+ * Copies are done in chunks small enough to stay in the L1 cache, so the source is read from
+ * memory only once. The chunk is three long blocks of the SSE4.2 kernel.
+ */
+#define CRC32C_COPY_CHUNK	(3 * 2048)
+
+uint32_t
+spdk_crc32c_copy(void *dst, const void *src, size_t len, uint32_t crc)
+{
+	size_t n;
+
+	while (len > 0) {
+		n = spdk_min(len, CRC32C_COPY_CHUNK);
+		crc = spdk_crc32c_update(src, n, crc);
+		memcpy(dst, src, n);
+		dst = (uint8_t *)dst + n;
+		src = (const uint8_t *)src + n;
+		len -= n;
+	}
+
+	return crc;
+}
+
 uint32_t
 spdk_crc32c_iov_update(struct iovec *iov, int iovcnt, uint32_t crc32c)
 {
@@ -126,6 +290,12 @@ spdk_crc32c_iov_update(struct iovec *iov, int iovcnt, uint32_t crc32c)
 	return crc32c;
 }
 
+uint32_t
+spdk_crc32c_combine(uint32_t crc1, uint32_t crc2, size_t len2)
+{
+	return crc32c_multmodp(crc32c_x2nmodp(len2, 3), crc1) ^ crc2;
+}
+
 uint32_t
 spdk_crc32c_nvme(const void *buf, size_t len, uint32_t crc)
 {
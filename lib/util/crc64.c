@@ -3,8 +3,10 @@
  *   All rights reserved.
  */
 
+#include "util_internal.h"
 #include "crc_internal.h"
 #include "spdk/crc64.h"
+#include "spdk/util.h"
 
 static const uint64_t crc64_rocksoft_refl_table[256] = {
 	0x0000000000000000ULL, 0x7f6ef0c830358979ULL,
@@ -155,3 +157,122 @@ spdk_crc64_nvme(const void *buf, size_t len, uint64_t crc)
 {
 	return crc64_rocksoft_refl_base(crc, (const uint8_t *)buf, len);
 }
+
+#ifdef __x86_64__
+/*
+ * Bit reflected x^191 mod P and x^127 mod P. The product of two reflected operands
+ * is one bit short, hence the exponents are one less than 192 and 128.
+ */
+#define CRC64_NVME_K191		0xeadc41fd2ba3d420ULL
+#define CRC64_NVME_K127		0x21e9761e252621acULL
+
+/* If dsts is not NULL, the buffers are also copied to dsts while they are folded */
+static inline __attribute__((always_inline, target("pclmul,ssse3"))) void
+crc64_nvme_fold(uint64_t *crcs, uint8_t **dsts, uint8_t **bufs, size_t len, uint32_t n)
+{
+	const __m128i k = _mm_set_epi64x(CRC64_NVME_K127, CRC64_NVME_K191);
+	__m128i acc[SPDK_CRC_MULTI_LANES], data;
+	uint8_t tmp[16];
+	size_t offset;
+	uint32_t i;
+
+	assert(len >= sizeof(tmp));
+	assert(n <= SPDK_CRC_MULTI_LANES);
+
+	/* Starting from an initial CRC is the same as XORing it into the first 8 bytes */
+	for (i = 0; i < n; i++) {
+		acc[i] = _mm_loadu_si128((const __m128i *)bufs[i]);
+		if (dsts != NULL) {
+			_mm_storeu_si128((__m128i *)dsts[i], acc[i]);
+		}
+		acc[i] = _mm_xor_si128(acc[i], _mm_set_epi64x(0, ~crcs[i]));
+	}
+
+	for (offset = sizeof(tmp); offset + sizeof(tmp) <= len; offset += sizeof(tmp)) {
+		for (i = 0; i < n; i++) {
+			data = _mm_loadu_si128((const __m128i *)(bufs[i] + offset));
+			if (dsts != NULL) {
+				_mm_storeu_si128((__m128i *)(dsts[i] + offset), data);
+			}
+			data = _mm_xor_si128(data, _mm_clmulepi64_si128(acc[i], k, 0x00));
+			acc[i] = _mm_xor_si128(data, _mm_clmulepi64_si128(acc[i], k, 0x11));
+		}
+	}
+
+	/* The accumulator is congruent to the data folded so far, reduce it with the tail */
+	for (i = 0; i < n; i++) {
+		_mm_storeu_si128((__m128i *)tmp, acc[i]);
+		crcs[i] = crc64_rocksoft_refl_base(~0ULL, tmp, sizeof(tmp));
+		crcs[i] = crc64_rocksoft_refl_base(crcs[i], bufs[i] + offset, len - offset);
+		if (dsts != NULL) {
+			memcpy(dsts[i] + offset, bufs[i] + offset, len - offset);
+		}
+	}
+}
+
+__attribute__((target("pclmul,ssse3"))) static void
+crc64_nvme_multi_pclmul(uint64_t *crcs, uint8_t **bufs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i += SPDK_CRC_MULTI_LANES) {
+		crc64_nvme_fold(&crcs[i], NULL, &bufs[i], len,
+				spdk_min(n - i, SPDK_CRC_MULTI_LANES));
+	}
+}
+
+__attribute__((target("pclmul,ssse3"))) static void
+crc64_nvme_copy_multi_pclmul(uint64_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len,
+			     uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i += SPDK_CRC_MULTI_LANES) {
+		crc64_nvme_fold(&crcs[i], &dsts[i], &srcs[i], len,
+				spdk_min(n - i, SPDK_CRC_MULTI_LANES));
+	}
+}
+
+/* Whether the CPU supports the carry-less multiplication the kernels above use */
+static bool g_crc64_pclmul;
+
+__attribute__((constructor)) static void
+crc64_multi_init(void)
+{
+	__builtin_cpu_init();
+	g_crc64_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+#endif
+
+void
+crc64_nvme_multi(uint64_t *crcs, uint8_t **bufs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+#ifdef __x86_64__
+	if (g_crc64_pclmul && len >= 16) {
+		crc64_nvme_multi_pclmul(crcs, bufs, len, n);
+		return;
+	}
+#endif
+	for (i = 0; i < n; i++) {
+		crcs[i] = crc64_rocksoft_refl_base(crcs[i], bufs[i], len);
+	}
+}
+
+void
+crc64_nvme_copy_multi(uint64_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len, uint32_t n)
+{
+	uint32_t i;
+
+#ifdef __x86_64__
+	if (g_crc64_pclmul && len >= 16) {
+		crc64_nvme_copy_multi_pclmul(crcs, dsts, srcs, len, n);
+		return;
+	}
+#endif
+	for (i = 0; i < n; i++) {
+		memcpy(dsts[i], srcs[i], len);
+		crcs[i] = crc64_rocksoft_refl_base(crcs[i], dsts[i], len);
+	}
+}
@@ -19,4 +19,11 @@
 #include <x86intrin.h>
 #endif
 
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#if defined(__PCLMUL__) && defined(__SSSE3__)
+#define SPDK_HAVE_PCLMUL
+#endif
+#endif
+
 #endif /* SPDK_CRC_INTERNAL_H */
@@ -11,6 +11,8 @@
 #include "spdk/log.h"
 #include "spdk/util.h"
 
+#include "util_internal.h"
+
 #define APPTAG_IGNORE 0xFFFF
 #define REFTAG_MASK_16 0x00000000FFFFFFFF
 #define REFTAG_MASK_32 0xFFFFFFFFFFFFFFFF
@@ -331,8 +333,7 @@ _dif_generate_guard_copy(uint64_t guard_seed, void *dst, void *src, size_t buf_l
 	if (dif_pi_format == SPDK_DIF_PI_FORMAT_16) {
 		guard = (uint64_t)spdk_crc16_t10dif_copy((uint16_t)guard_seed, dst, src, buf_len);
 	} else if (dif_pi_format == SPDK_DIF_PI_FORMAT_32) {
-		memcpy(dst, src, buf_len);
-		guard = (uint64_t)spdk_crc32c_nvme(src, buf_len, guard_seed);
+		guard = (uint64_t)~spdk_crc32c_copy(dst, src, buf_len, ~(uint32_t)guard_seed);
 	} else {
 		memcpy(dst, src, buf_len);
 		guard = spdk_crc64_nvme(src, buf_len, guard_seed);
@@ -341,6 +342,63 @@ _dif_generate_guard_copy(uint64_t guard_seed, void *dst, void *src, size_t buf_l
 	return guard;
 }
 
+/* Maximum number of blocks whose guards are computed in parallel */
+#define DIF_GUARD_BATCH SPDK_CRC_MULTI_LANES
+
+/* Compute the guards of multiple blocks. guards holds the seed of each block on input. */
+static inline void
+_dif_generate_guard_multi(uint64_t *guards, uint8_t **bufs, size_t buf_len, uint32_t count,
+			  enum spdk_dif_pi_format dif_pi_format)
+{
+	uint16_t crcs[DIF_GUARD_BATCH];
+	uint32_t i;
+
+	assert(count <= DIF_GUARD_BATCH);
+
+	if (dif_pi_format == SPDK_DIF_PI_FORMAT_16) {
+		for (i = 0; i < count; i++) {
+			crcs[i] = (uint16_t)guards[i];
+		}
+		crc16_t10dif_multi(crcs, bufs, buf_len, count);
+		for (i = 0; i < count; i++) {
+			guards[i] = crcs[i];
+		}
+	} else if (dif_pi_format == SPDK_DIF_PI_FORMAT_32) {
+		for (i = 0; i < count; i++) {
+			guards[i] = (uint64_t)spdk_crc32c_nvme(bufs[i], buf_len, guards[i]);
+		}
+	} else {
+		crc64_nvme_multi(guards, bufs, buf_len, count);
+	}
+}
+
+/* Copy multiple blocks and compute their guards in the same pass. */
+static inline void
+_dif_generate_guard_copy_multi(uint64_t *guards, uint8_t **dsts, uint8_t **srcs, size_t buf_len,
+			       uint32_t count, enum spdk_dif_pi_format dif_pi_format)
+{
+	uint16_t crcs[DIF_GUARD_BATCH];
+	uint32_t i;
+
+	assert(count <= DIF_GUARD_BATCH);
+
+	if (dif_pi_format == SPDK_DIF_PI_FORMAT_16) {
+		for (i = 0; i < count; i++) {
+			crcs[i] = (uint16_t)guards[i];
+		}
+		crc16_t10dif_copy_multi(crcs, dsts, srcs, buf_len, count);
+		for (i = 0; i < count; i++) {
+			guards[i] = crcs[i];
+		}
+	} else if (dif_pi_format == SPDK_DIF_PI_FORMAT_32) {
+		for (i = 0; i < count; i++) {
+			guards[i] = (uint64_t)~spdk_crc32c_copy(dsts[i], srcs[i], buf_len, ~(uint32_t)guards[i]);
+		}
+	} else {
+		crc64_nvme_copy_multi(guards, dsts, srcs, buf_len, count);
+	}
+}
+
 static inline uint8_t
 _dif_apptag_offset(enum spdk_dif_pi_format dif_pi_format)
 {
@@ -605,21 +663,30 @@ _dif_generate(void *_dif, uint64_t guard, uint32_t offset_blocks,
 static void
 dif_generate(struct _dif_sgl *sgl, uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks = 0;
-	uint8_t *buf;
-	uint64_t guard = 0;
+	uint32_t offset_blocks = 0, count, i;
+	uint8_t *bufs[DIF_GUARD_BATCH];
+	uint64_t guards[DIF_GUARD_BATCH];
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(sgl, &buf, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(sgl, &bufs[i], NULL);
+			_dif_sgl_advance(sgl, ctx->block_size);
+			guards[i] = ctx->guard_seed;
+		}
 
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard(ctx->guard_seed, buf, ctx->guard_interval, ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, bufs, ctx->guard_interval, count, ctx->dif_pi_format);
+		} else {
+			memset(guards, 0, sizeof(guards));
 		}
 
-		_dif_generate(buf + ctx->guard_interval, guard, offset_blocks, ctx);
+		for (i = 0; i < count; i++) {
+			_dif_generate(bufs[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx);
+		}
 
-		_dif_sgl_advance(sgl, ctx->block_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 }
 
@@ -850,25 +917,34 @@ static int
 dif_verify(struct _dif_sgl *sgl, uint32_t num_blocks,
 	   const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks = 0;
+	uint32_t offset_blocks = 0, count, i;
 	int rc;
-	uint8_t *buf;
-	uint64_t guard = 0;
+	uint8_t *bufs[DIF_GUARD_BATCH];
+	uint64_t guards[DIF_GUARD_BATCH];
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(sgl, &buf, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(sgl, &bufs[i], NULL);
+			_dif_sgl_advance(sgl, ctx->block_size);
+			guards[i] = ctx->guard_seed;
+		}
 
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard(ctx->guard_seed, buf, ctx->guard_interval, ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, bufs, ctx->guard_interval, count, ctx->dif_pi_format);
+		} else {
+			memset(guards, 0, sizeof(guards));
 		}
 
-		rc = _dif_verify(buf + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
-		if (rc != 0) {
-			return rc;
+		for (i = 0; i < count; i++) {
+			rc = _dif_verify(bufs[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx, err_blk);
+			if (rc != 0) {
+				return rc;
+			}
 		}
 
-		_dif_sgl_advance(sgl, ctx->block_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 
 	return 0;
@@ -1078,31 +1154,41 @@ static void
 dif_generate_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 		  uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks = 0, data_block_size;
-	uint8_t *src, *dst;
-	uint64_t guard;
+	uint32_t offset_blocks = 0, data_block_size, count, i;
+	uint8_t *srcs[DIF_GUARD_BATCH], *dsts[DIF_GUARD_BATCH], *mds[DIF_GUARD_BATCH];
+	uint64_t guards[DIF_GUARD_BATCH];
 
 	data_block_size = ctx->block_size - ctx->md_size;
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(src_sgl, &src, NULL);
-		_dif_sgl_get_buf(dst_sgl, &dst, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(src_sgl, &srcs[i], NULL);
+			_dif_sgl_get_buf(dst_sgl, &dsts[i], NULL);
+			_dif_sgl_advance(src_sgl, data_block_size);
+			_dif_sgl_advance(dst_sgl, ctx->block_size);
+			mds[i] = dsts[i] + data_block_size;
+			guards[i] = ctx->guard_seed;
+		}
 
-		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard_copy(ctx->guard_seed, dst, src, data_block_size,
-							 ctx->dif_pi_format);
-			guard = _dif_generate_guard(guard, dst + data_block_size,
-						    ctx->guard_interval - data_block_size, ctx->dif_pi_format);
+			_dif_generate_guard_copy_multi(guards, dsts, srcs, data_block_size, count,
+						       ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, mds, ctx->guard_interval - data_block_size, count,
+						  ctx->dif_pi_format);
 		} else {
-			memcpy(dst, src, data_block_size);
+			for (i = 0; i < count; i++) {
+				memcpy(dsts[i], srcs[i], data_block_size);
+			}
+			memset(guards, 0, sizeof(guards));
 		}
 
-		_dif_generate(dst + ctx->guard_interval, guard, offset_blocks, ctx);
+		for (i = 0; i < count; i++) {
+			_dif_generate(dsts[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx);
+		}
 
-		_dif_sgl_advance(src_sgl, data_block_size);
-		_dif_sgl_advance(dst_sgl, ctx->block_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 }
 
@@ -1203,35 +1289,44 @@ dif_verify_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 		uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
 		struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks = 0, data_block_size;
-	uint8_t *src, *dst;
+	uint32_t offset_blocks = 0, data_block_size, count, i;
+	uint8_t *srcs[DIF_GUARD_BATCH], *dsts[DIF_GUARD_BATCH];
 	int rc;
-	uint64_t guard;
+	uint64_t guards[DIF_GUARD_BATCH];
 
 	data_block_size = ctx->block_size - ctx->md_size;
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(src_sgl, &src, NULL);
-		_dif_sgl_get_buf(dst_sgl, &dst, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(src_sgl, &srcs[i], NULL);
+			_dif_sgl_get_buf(dst_sgl, &dsts[i], NULL);
+			_dif_sgl_advance(src_sgl, ctx->block_size);
+			_dif_sgl_advance(dst_sgl, data_block_size);
+			guards[i] = ctx->guard_seed;
+		}
 
-		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard_copy(ctx->guard_seed, dst, src, data_block_size,
-							 ctx->dif_pi_format);
-			guard = _dif_generate_guard(guard, src + data_block_size,
-						    ctx->guard_interval - data_block_size, ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, srcs, ctx->guard_interval, count, ctx->dif_pi_format);
 		} else {
-			memcpy(dst, src, data_block_size);
+			memset(guards, 0, sizeof(guards));
 		}
 
-		rc = _dif_verify(src + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
-		if (rc != 0) {
-			return rc;
+		/*
+		 * The guards are computed from the source before anything is copied, so that
+		 * the blocks following the first one which fails verification are left untouched.
+		 */
+		for (i = 0; i < count; i++) {
+			memcpy(dsts[i], srcs[i], data_block_size);
+			rc = _dif_verify(srcs[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx,
+					 err_blk);
+			if (rc != 0) {
+				return rc;
+			}
 		}
 
-		_dif_sgl_advance(src_sgl, ctx->block_size);
-		_dif_sgl_advance(dst_sgl, data_block_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 
 	return 0;
@@ -1482,27 +1577,33 @@ static void
 dix_generate(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 	     uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks = 0;
-	uint8_t *data_buf, *md_buf;
-	uint64_t guard;
+	uint32_t offset_blocks = 0, count, i;
+	uint8_t *data_bufs[DIF_GUARD_BATCH], *md_bufs[DIF_GUARD_BATCH];
+	uint64_t guards[DIF_GUARD_BATCH];
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(data_sgl, &data_buf, NULL);
-		_dif_sgl_get_buf(md_sgl, &md_buf, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(data_sgl, &data_bufs[i], NULL);
+			_dif_sgl_get_buf(md_sgl, &md_bufs[i], NULL);
+			_dif_sgl_advance(data_sgl, ctx->block_size);
+			_dif_sgl_advance(md_sgl, ctx->md_size);
+			guards[i] = ctx->guard_seed;
+		}
 
-		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard(ctx->guard_seed, data_buf, ctx->block_size,
-						    ctx->dif_pi_format);
-			guard = _dif_generate_guard(guard, md_buf, ctx->guard_interval,
-						    ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, data_bufs, ctx->block_size, count, ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, md_bufs, ctx->guard_interval, count, ctx->dif_pi_format);
+		} else {
+			memset(guards, 0, sizeof(guards));
 		}
 
-		_dif_generate(md_buf + ctx->guard_interval, guard, offset_blocks, ctx);
+		for (i = 0; i < count; i++) {
+			_dif_generate(md_bufs[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx);
+		}
 
-		_dif_sgl_advance(data_sgl, ctx->block_size);
-		_dif_sgl_advance(md_sgl, ctx->md_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 }
 
@@ -1588,31 +1689,38 @@ dix_verify(struct _dif_sgl *data_sgl, struct _dif_sgl *md_sgl,
 	   uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
 	   struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks = 0;
-	uint8_t *data_buf, *md_buf;
-	uint64_t guard;
+	uint32_t offset_blocks = 0, count, i;
+	uint8_t *data_bufs[DIF_GUARD_BATCH], *md_bufs[DIF_GUARD_BATCH];
+	uint64_t guards[DIF_GUARD_BATCH];
 	int rc;
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(data_sgl, &data_buf, NULL);
-		_dif_sgl_get_buf(md_sgl, &md_buf, NULL);
+		count = spdk_min(num_blocks - offset_blocks, DIF_GUARD_BATCH);
+
+		for (i = 0; i < count; i++) {
+			_dif_sgl_get_buf(data_sgl, &data_bufs[i], NULL);
+			_dif_sgl_get_buf(md_sgl, &md_bufs[i], NULL);
+			_dif_sgl_advance(data_sgl, ctx->block_size);
+			_dif_sgl_advance(md_sgl, ctx->md_size);
+			guards[i] = ctx->guard_seed;
+		}
 
-		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = _dif_generate_guard(ctx->guard_seed, data_buf, ctx->block_size,
-						    ctx->dif_pi_format);
-			guard = _dif_generate_guard(guard, md_buf, ctx->guard_interval,
-						    ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, data_bufs, ctx->block_size, count, ctx->dif_pi_format);
+			_dif_generate_guard_multi(guards, md_bufs, ctx->guard_interval, count, ctx->dif_pi_format);
+		} else {
+			memset(guards, 0, sizeof(guards));
 		}
 
-		rc = _dif_verify(md_buf + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
-		if (rc != 0) {
-			return rc;
+		for (i = 0; i < count; i++) {
+			rc = _dif_verify(md_bufs[i] + ctx->guard_interval, guards[i], offset_blocks + i, ctx,
+					 err_blk);
+			if (rc != 0) {
+				return rc;
+			}
 		}
 
-		_dif_sgl_advance(data_sgl, ctx->block_size);
-		_dif_sgl_advance(md_sgl, ctx->md_size);
-		offset_blocks++;
+		offset_blocks += count;
 	}
 
 	return 0;
@@ -9,6 +9,7 @@
 
 #ifdef __linux__
 #include <linux/fs.h>
+#include <sys/sysmacros.h>
 #endif
 
 #ifdef __FreeBSD__
@@ -83,3 +84,103 @@ spdk_fd_get_size(int fd)
 	/* Not REG, CHR or BLK */
 	return 0;
 }
+
+/*
+ * The fallocate() modes are probed past the end of the file, which doesn't modify it:
+ *  - regular files deallocate and zero ranges by punching holes, which read back as zeroes.
+ *    Unlike zeroed ranges, which would allocate space past the end of the file, they can be
+ *    probed there and more filesystems support them. A supported mode succeeds there without
+ *    doing anything.
+ *  - block devices turn punched holes into write zeroes commands allowed to deallocate the
+ *    blocks, which fail if the device doesn't support them, and zero ranges with write zeroes
+ *    commands or by writing zeroes. Both are only used if the device supports write zeroes
+ *    commands. Past the end of the device, a supported mode fails with EINVAL instead of
+ *    EOPNOTSUPP.
+ */
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_ZERO_RANGE)
+static uint64_t
+dev_get_queue_attr(dev_t dev, const char *attr)
+{
+	char path[PATH_MAX], str[32];
+	uint64_t val = 0;
+	FILE *file;
+
+	snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/queue/%s", major(dev), minor(dev), attr);
+	file = fopen(path, "r");
+	if (file == NULL) {
+		/* Partitions share the queue of their disk, in the parent directory */
+		snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/../queue/%s",
+			 major(dev), minor(dev), attr);
+		file = fopen(path, "r");
+		if (file == NULL) {
+			return 0;
+		}
+	}
+
+	if (fgets(str, sizeof(str), file) != NULL) {
+		val = strtoull(str, NULL, 10);
+	}
+	fclose(file);
+
+	return val;
+}
+
+static int
+fd_get_fallocate_mode(int fd, int dev_mode)
+{
+	struct stat st;
+	uint64_t size;
+	int mode;
+
+	if (fstat(fd, &st) != 0) {
+		return -errno;
+	}
+
+	if (S_ISREG(st.st_mode)) {
+		mode = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+		if (fallocate(fd, mode, st.st_size, st.st_blksize) != 0) {
+			return -errno;
+		}
+		return mode;
+	} else if (!S_ISBLK(st.st_mode)) {
+		return -ENOTSUP;
+	}
+
+	/* Without write zeroes commands, the kernel would zero ranges by writing zeroes itself */
+	if (dev_get_queue_attr(st.st_rdev, "write_zeroes_max_bytes") == 0) {
+		return -ENOTSUP;
+	}
+
+	size = dev_get_size(fd);
+	if (size == 0 || fallocate(fd, dev_mode, size, spdk_fd_get_blocklen(fd)) == 0 ||
+	    errno != EINVAL) {
+		return -ENOTSUP;
+	}
+
+	return dev_mode;
+}
+
+int
+spdk_fd_get_discard_mode(int fd)
+{
+	return fd_get_fallocate_mode(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE);
+}
+
+int
+spdk_fd_get_zeroes_mode(int fd)
+{
+	return fd_get_fallocate_mode(fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE);
+}
+#else
+int
+spdk_fd_get_discard_mode(int fd)
+{
+	return -ENOTSUP;
+}
+
+int
+spdk_fd_get_zeroes_mode(int fd)
+{
+	return -ENOTSUP;
+}
+#endif
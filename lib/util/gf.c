@@ -0,0 +1,683 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/gf.h"
+#include "spdk/config.h"
+#include "spdk/assert.h"
+#include "spdk/util.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* x^8 + x^4 + x^3 + x^2 + 1 */
+#define SPDK_GF_POLY	0x11d
+
+/* maximum number of data buffers, Q coefficients of more buffers would repeat */
+#define SPDK_GF_MAX_SRC	255
+
+static uint8_t g_gf_log[256];
+static uint8_t g_gf_exp[255 * 2];
+
+/*
+ * Products of every element and all values of the low (first 16 bytes) and high (last 16 bytes)
+ * nibble of a byte. They allow multiplying by a constant with byte shuffle instructions.
+ */
+static uint8_t g_gf_nibble_tbl[256][32];
+
+static inline uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	if (a == 0 || b == 0) {
+		return 0;
+	}
+
+	return g_gf_exp[g_gf_log[a] + g_gf_log[b]];
+}
+
+static inline uint8_t
+gf_mul2(uint8_t a)
+{
+	return (a << 1) ^ ((a & 0x80) ? (SPDK_GF_POLY & 0xff) : 0);
+}
+
+/*
+ * The region kernels are written once against a small set of vector primitives: load/store/xor
+ * of a vector, multiplication of every byte of a vector by 2 (the Q syndrome Horner step) and
+ * multiplication by an arbitrary constant using nibble lookup tables.  GF_DEFINE_KERNELS
+ * instantiates them with the primitives of an instruction set, gf_init() then selects the best
+ * set supported by the CPU.
+ */
+typedef void (*gf_pq_gen_fn)(uint8_t *p, uint8_t *q, uint8_t **srcs, uint32_t n, uint32_t len);
+typedef void (*gf_mul_fn)(uint8_t *dest, const uint8_t *a, const uint8_t *b, uint8_t c,
+			  uint32_t len);
+typedef void (*gf_rec2_fn)(uint8_t *dx, uint8_t *dy, const uint8_t *p, const uint8_t *q,
+			   uint8_t ca, uint8_t cb, uint32_t len);
+
+struct gf_kernels {
+	/* P = sum(srcs[i]), Q = sum(g^i * srcs[i]), where NULL sources are treated as zero. */
+	gf_pq_gen_fn	pq_gen;
+	/* dest = c * (a + b), where b may be NULL. */
+	gf_mul_fn	mul;
+	/*
+	 * On input dx and dy hold the P and Q syndromes of the remaining data. Replace them with
+	 * the data of the two failed buffers:
+	 *   pxy = dy + p, qxy = dx + q
+	 *   dx = ca * pxy + cb * qxy
+	 *   dy = pxy + dx
+	 */
+	gf_rec2_fn	rec2;
+	/* Length of the vectors, which is also the alignment the kernels prefer */
+	size_t		vec_len;
+};
+
+/* Byte by byte versions of the kernels, for the remainder of the regions starting at off */
+static inline void
+gf_pq_gen_tail(uint8_t *p, uint8_t *q, uint8_t **srcs, uint32_t n, uint32_t off, uint32_t len)
+{
+	uint32_t j;
+
+	for (; off < len; off++) {
+		uint8_t bp = 0, bq = 0;
+
+		for (j = n; j-- > 0;) {
+			bq = gf_mul2(bq);
+			if (srcs[j] != NULL) {
+				bp ^= srcs[j][off];
+				bq ^= srcs[j][off];
+			}
+		}
+
+		if (p != NULL) {
+			p[off] = bp;
+		}
+		if (q != NULL) {
+			q[off] = bq;
+		}
+	}
+}
+
+static inline void
+gf_mul_tail(uint8_t *dest, const uint8_t *a, const uint8_t *b, uint8_t c, uint32_t off,
+	    uint32_t len)
+{
+	for (; off < len; off++) {
+		dest[off] = gf_mul(c, b != NULL ? a[off] ^ b[off] : a[off]);
+	}
+}
+
+static inline void
+gf_rec2_tail(uint8_t *dx, uint8_t *dy, const uint8_t *p, const uint8_t *q, uint8_t ca,
+	     uint8_t cb, uint32_t off, uint32_t len)
+{
+	for (; off < len; off++) {
+		uint8_t pxy = dy[off] ^ p[off];
+		uint8_t qxy = dx[off] ^ q[off];
+		uint8_t x = gf_mul(ca, pxy) ^ gf_mul(cb, qxy);
+
+		dx[off] = x;
+		dy[off] = pxy ^ x;
+	}
+}
+
+#define GF_DEFINE_KERNELS(isa, target)								\
+static target void										\
+gf_pq_gen_##isa(uint8_t *p, uint8_t *q, uint8_t **srcs, uint32_t n, uint32_t len)		\
+{												\
+	uint32_t off, j;									\
+												\
+	for (off = 0; off + sizeof(gf_##isa##_vec_t) <= len; off += sizeof(gf_##isa##_vec_t)) {	\
+		gf_##isa##_vec_t vp = gf_##isa##_zero();					\
+		gf_##isa##_vec_t vq = gf_##isa##_zero();					\
+												\
+		for (j = n; j-- > 0;) {								\
+			if (q != NULL) {							\
+				vq = gf_##isa##_mul2(vq);					\
+			}									\
+			if (srcs[j] != NULL) {							\
+				gf_##isa##_vec_t d = gf_##isa##_load(srcs[j] + off);		\
+												\
+				vp = gf_##isa##_xor(vp, d);					\
+				vq = gf_##isa##_xor(vq, d);					\
+			}									\
+		}										\
+												\
+		if (p != NULL) {								\
+			gf_##isa##_store(p + off, vp);						\
+		}										\
+		if (q != NULL) {								\
+			gf_##isa##_store(q + off, vq);						\
+		}										\
+	}											\
+												\
+	gf_pq_gen_tail(p, q, srcs, n, off, len);						\
+}												\
+												\
+static target void										\
+gf_mul_##isa(uint8_t *dest, const uint8_t *a, const uint8_t *b, uint8_t c, uint32_t len)	\
+{												\
+	gf_##isa##_tbl_t lo = gf_##isa##_tbl(&g_gf_nibble_tbl[c][0]);				\
+	gf_##isa##_tbl_t hi = gf_##isa##_tbl(&g_gf_nibble_tbl[c][16]);				\
+	uint32_t off;										\
+												\
+	for (off = 0; off + sizeof(gf_##isa##_vec_t) <= len; off += sizeof(gf_##isa##_vec_t)) {	\
+		gf_##isa##_vec_t v = gf_##isa##_load(a + off);					\
+												\
+		if (b != NULL) {								\
+			v = gf_##isa##_xor(v, gf_##isa##_load(b + off));			\
+		}										\
+		gf_##isa##_store(dest + off, gf_##isa##_mul(v, lo, hi));			\
+	}											\
+												\
+	gf_mul_tail(dest, a, b, c, off, len);							\
+}												\
+												\
+static target void										\
+gf_rec2_##isa(uint8_t *dx, uint8_t *dy, const uint8_t *p, const uint8_t *q, uint8_t ca,	\
+	      uint8_t cb, uint32_t len)								\
+{												\
+	gf_##isa##_tbl_t alo = gf_##isa##_tbl(&g_gf_nibble_tbl[ca][0]);				\
+	gf_##isa##_tbl_t ahi = gf_##isa##_tbl(&g_gf_nibble_tbl[ca][16]);			\
+	gf_##isa##_tbl_t blo = gf_##isa##_tbl(&g_gf_nibble_tbl[cb][0]);				\
+	gf_##isa##_tbl_t bhi = gf_##isa##_tbl(&g_gf_nibble_tbl[cb][16]);			\
+	uint32_t off;										\
+												\
+	for (off = 0; off + sizeof(gf_##isa##_vec_t) <= len; off += sizeof(gf_##isa##_vec_t)) {	\
+		gf_##isa##_vec_t pxy = gf_##isa##_xor(gf_##isa##_load(dy + off),		\
+						      gf_##isa##_load(p + off));		\
+		gf_##isa##_vec_t qxy = gf_##isa##_xor(gf_##isa##_load(dx + off),		\
+						      gf_##isa##_load(q + off));		\
+		gf_##isa##_vec_t x = gf_##isa##_xor(gf_##isa##_mul(pxy, alo, ahi),		\
+						    gf_##isa##_mul(qxy, blo, bhi));		\
+												\
+		gf_##isa##_store(dx + off, x);							\
+		gf_##isa##_store(dy + off, gf_##isa##_xor(pxy, x));				\
+	}											\
+												\
+	gf_rec2_tail(dx, dy, p, q, ca, cb, off, len);						\
+}												\
+												\
+static const struct gf_kernels g_gf_kernels_##isa = {						\
+	.pq_gen = gf_pq_gen_##isa,								\
+	.mul = gf_mul_##isa,									\
+	.rec2 = gf_rec2_##isa,									\
+	.vec_len = sizeof(gf_##isa##_vec_t),							\
+}
+
+/* 64-bit scalar primitives, available everywhere */
+typedef uint64_t gf_basic_vec_t;
+typedef const uint8_t *gf_basic_tbl_t;
+
+static inline gf_basic_vec_t
+gf_basic_load(const uint8_t *p)
+{
+	gf_basic_vec_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void
+gf_basic_store(uint8_t *p, gf_basic_vec_t v)
+{
+	memcpy(p, &v, sizeof(v));
+}
+
+static inline gf_basic_vec_t
+gf_basic_xor(gf_basic_vec_t a, gf_basic_vec_t b)
+{
+	return a ^ b;
+}
+
+static inline gf_basic_vec_t
+gf_basic_zero(void)
+{
+	return 0;
+}
+
+static inline gf_basic_vec_t
+gf_basic_mul2(gf_basic_vec_t v)
+{
+	gf_basic_vec_t carry = (v & 0x8080808080808080ULL) >> 7;
+
+	return ((v << 1) & 0xfefefefefefefefeULL) ^ (carry * (SPDK_GF_POLY & 0xff));
+}
+
+static inline gf_basic_tbl_t
+gf_basic_tbl(const uint8_t *tbl)
+{
+	return tbl;
+}
+
+static inline gf_basic_vec_t
+gf_basic_mul(gf_basic_vec_t v, gf_basic_tbl_t lo, gf_basic_tbl_t hi)
+{
+	uint8_t b[sizeof(v)];
+	uint32_t i;
+
+	memcpy(b, &v, sizeof(v));
+	for (i = 0; i < sizeof(v); i++) {
+		b[i] = lo[b[i] & 0x0f] ^ hi[b[i] >> 4];
+	}
+	memcpy(&v, b, sizeof(v));
+
+	return v;
+}
+
+GF_DEFINE_KERNELS(basic, );
+
+#if defined(__x86_64__)
+
+#define GF_SSSE3_TARGET		__attribute__((target("ssse3")))
+#define GF_AVX2_TARGET		__attribute__((target("avx2")))
+#define GF_AVX512_TARGET	__attribute__((target("avx512f,avx512bw")))
+
+typedef __m128i gf_ssse3_vec_t;
+typedef __m128i gf_ssse3_tbl_t;
+
+static inline GF_SSSE3_TARGET gf_ssse3_vec_t
+gf_ssse3_load(const uint8_t *p)
+{
+	return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline GF_SSSE3_TARGET void
+gf_ssse3_store(uint8_t *p, gf_ssse3_vec_t v)
+{
+	_mm_storeu_si128((__m128i *)p, v);
+}
+
+static inline GF_SSSE3_TARGET gf_ssse3_vec_t
+gf_ssse3_xor(gf_ssse3_vec_t a, gf_ssse3_vec_t b)
+{
+	return _mm_xor_si128(a, b);
+}
+
+static inline GF_SSSE3_TARGET gf_ssse3_vec_t
+gf_ssse3_zero(void)
+{
+	return _mm_setzero_si128();
+}
+
+static inline GF_SSSE3_TARGET gf_ssse3_vec_t
+gf_ssse3_mul2(gf_ssse3_vec_t v)
+{
+	gf_ssse3_vec_t carry = _mm_cmpgt_epi8(_mm_setzero_si128(), v);
+
+	v = _mm_add_epi8(v, v);
+	return _mm_xor_si128(v, _mm_and_si128(carry, _mm_set1_epi8(SPDK_GF_POLY & 0xff)));
+}
+
+static inline GF_SSSE3_TARGET gf_ssse3_tbl_t
+gf_ssse3_tbl(const uint8_t *tbl)
+{
+	return _mm_loadu_si128((const __m128i *)tbl);
+}
+
+static inline GF_SSSE3_TARGET gf_ssse3_vec_t
+gf_ssse3_mul(gf_ssse3_vec_t v, gf_ssse3_tbl_t lo, gf_ssse3_tbl_t hi)
+{
+	gf_ssse3_vec_t mask = _mm_set1_epi8(0x0f);
+
+	return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(v, mask)),
+			     _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(v, 4), mask)));
+}
+
+GF_DEFINE_KERNELS(ssse3, GF_SSSE3_TARGET);
+
+typedef __m256i gf_avx2_vec_t;
+typedef __m256i gf_avx2_tbl_t;
+
+static inline GF_AVX2_TARGET gf_avx2_vec_t
+gf_avx2_load(const uint8_t *p)
+{
+	return _mm256_loadu_si256((const __m256i *)p);
+}
+
+static inline GF_AVX2_TARGET void
+gf_avx2_store(uint8_t *p, gf_avx2_vec_t v)
+{
+	_mm256_storeu_si256((__m256i *)p, v);
+}
+
+static inline GF_AVX2_TARGET gf_avx2_vec_t
+gf_avx2_xor(gf_avx2_vec_t a, gf_avx2_vec_t b)
+{
+	return _mm256_xor_si256(a, b);
+}
+
+static inline GF_AVX2_TARGET gf_avx2_vec_t
+gf_avx2_zero(void)
+{
+	return _mm256_setzero_si256();
+}
+
+static inline GF_AVX2_TARGET gf_avx2_vec_t
+gf_avx2_mul2(gf_avx2_vec_t v)
+{
+	gf_avx2_vec_t carry = _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+
+	v = _mm256_add_epi8(v, v);
+	return _mm256_xor_si256(v, _mm256_and_si256(carry, _mm256_set1_epi8(SPDK_GF_POLY & 0xff)));
+}
+
+static inline GF_AVX2_TARGET gf_avx2_tbl_t
+gf_avx2_tbl(const uint8_t *tbl)
+{
+	return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)tbl));
+}
+
+static inline GF_AVX2_TARGET gf_avx2_vec_t
+gf_avx2_mul(gf_avx2_vec_t v, gf_avx2_tbl_t lo, gf_avx2_tbl_t hi)
+{
+	gf_avx2_vec_t mask = _mm256_set1_epi8(0x0f);
+
+	return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(v, mask)),
+				_mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(v, 4), mask)));
+}
+
+GF_DEFINE_KERNELS(avx2, GF_AVX2_TARGET);
+
+typedef __m512i gf_avx512_vec_t;
+typedef __m512i gf_avx512_tbl_t;
+
+static inline GF_AVX512_TARGET gf_avx512_vec_t
+gf_avx512_load(const uint8_t *p)
+{
+	return _mm512_loadu_si512((const void *)p);
+}
+
+static inline GF_AVX512_TARGET void
+gf_avx512_store(uint8_t *p, gf_avx512_vec_t v)
+{
+	_mm512_storeu_si512((void *)p, v);
+}
+
+static inline GF_AVX512_TARGET gf_avx512_vec_t
+gf_avx512_xor(gf_avx512_vec_t a, gf_avx512_vec_t b)
+{
+	return _mm512_xor_si512(a, b);
+}
+
+static inline GF_AVX512_TARGET gf_avx512_vec_t
+gf_avx512_zero(void)
+{
+	return _mm512_setzero_si512();
+}
+
+static inline GF_AVX512_TARGET gf_avx512_vec_t
+gf_avx512_mul2(gf_avx512_vec_t v)
+{
+	__mmask64 carry = _mm512_movepi8_mask(v);
+
+	v = _mm512_add_epi8(v, v);
+	return _mm512_xor_si512(v, _mm512_maskz_mov_epi8(carry, _mm512_set1_epi8(SPDK_GF_POLY & 0xff)));
+}
+
+static inline GF_AVX512_TARGET gf_avx512_tbl_t
+gf_avx512_tbl(const uint8_t *tbl)
+{
+	return _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)tbl));
+}
+
+static inline GF_AVX512_TARGET gf_avx512_vec_t
+gf_avx512_mul(gf_avx512_vec_t v, gf_avx512_tbl_t lo, gf_avx512_tbl_t hi)
+{
+	gf_avx512_vec_t mask = _mm512_set1_epi8(0x0f);
+
+	return _mm512_xor_si512(_mm512_shuffle_epi8(lo, _mm512_and_si512(v, mask)),
+				_mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi64(v, 4), mask)));
+}
+
+GF_DEFINE_KERNELS(avx512, GF_AVX512_TARGET);
+
+#elif defined(__aarch64__)
+
+/* NEON is part of the base ARMv8-A instruction set */
+typedef uint8x16_t gf_neon_vec_t;
+typedef uint8x16_t gf_neon_tbl_t;
+
+static inline gf_neon_vec_t
+gf_neon_load(const uint8_t *p)
+{
+	return vld1q_u8(p);
+}
+
+static inline void
+gf_neon_store(uint8_t *p, gf_neon_vec_t v)
+{
+	vst1q_u8(p, v);
+}
+
+static inline gf_neon_vec_t
+gf_neon_xor(gf_neon_vec_t a, gf_neon_vec_t b)
+{
+	return veorq_u8(a, b);
+}
+
+static inline gf_neon_vec_t
+gf_neon_zero(void)
+{
+	return vdupq_n_u8(0);
+}
+
+static inline gf_neon_vec_t
+gf_neon_mul2(gf_neon_vec_t v)
+{
+	gf_neon_vec_t carry = vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(v), 7));
+
+	return veorq_u8(vshlq_n_u8(v, 1), vandq_u8(carry, vdupq_n_u8(SPDK_GF_POLY & 0xff)));
+}
+
+static inline gf_neon_tbl_t
+gf_neon_tbl(const uint8_t *tbl)
+{
+	return vld1q_u8(tbl);
+}
+
+static inline gf_neon_vec_t
+gf_neon_mul(gf_neon_vec_t v, gf_neon_tbl_t lo, gf_neon_tbl_t hi)
+{
+	return veorq_u8(vqtbl1q_u8(lo, vandq_u8(v, vdupq_n_u8(0x0f))),
+			vqtbl1q_u8(hi, vshrq_n_u8(v, 4)));
+}
+
+GF_DEFINE_KERNELS(neon, );
+
+#endif
+
+/* The best kernels supported by the CPU */
+static const struct gf_kernels *g_gf_kernels = &g_gf_kernels_basic;
+
+__attribute__((constructor)) static void
+gf_init(void)
+{
+	uint32_t i, c;
+	uint8_t x = 1;
+
+	for (i = 0; i < 255; i++) {
+		g_gf_exp[i] = x;
+		g_gf_exp[i + 255] = x;
+		g_gf_log[x] = i;
+		x = gf_mul2(x);
+	}
+
+	for (c = 0; c < 256; c++) {
+		for (i = 0; i < 16; i++) {
+			g_gf_nibble_tbl[c][i] = gf_mul(c, i);
+			g_gf_nibble_tbl[c][i + 16] = gf_mul(c, i << 4);
+		}
+	}
+
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512bw")) {
+		g_gf_kernels = &g_gf_kernels_avx512;
+	} else if (__builtin_cpu_supports("avx2")) {
+		g_gf_kernels = &g_gf_kernels_avx2;
+	} else if (__builtin_cpu_supports("ssse3")) {
+		g_gf_kernels = &g_gf_kernels_ssse3;
+	}
+#elif defined(__aarch64__)
+	g_gf_kernels = &g_gf_kernels_neon;
+#endif
+}
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/raid.h"
+
+#define SPDK_GF_BUF_ALIGN 32
+
+static inline bool
+is_aligned(void *ptr, size_t alignment)
+{
+	uintptr_t p = (uintptr_t)ptr;
+
+	return p == SPDK_ALIGN_FLOOR(p, alignment);
+}
+
+static int
+do_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	void *buffers[SPDK_GF_MAX_SRC + 2];
+	uint32_t i;
+	bool aligned = is_aligned(p, 32) && is_aligned(q, 32) && (len % 32) == 0;
+
+	for (i = 0; i < n && aligned; i++) {
+		aligned = is_aligned(sources[i], 32);
+	}
+
+	/* ISA-L requires at least two sources and 32 byte aligned buffers and length */
+	if (aligned && n >= 2) {
+		memcpy(buffers, sources, n * sizeof(buffers[0]));
+		buffers[n] = p;
+		buffers[n + 1] = q;
+
+		if (pq_gen(n + 2, len, buffers)) {
+			return -EINVAL;
+		}
+	} else {
+		g_gf_kernels->pq_gen(p, q, (uint8_t **)sources, n, len);
+	}
+
+	return 0;
+}
+
+#else
+
+#define SPDK_GF_BUF_ALIGN sizeof(uint64_t)
+
+static inline int
+do_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	g_gf_kernels->pq_gen(p, q, (uint8_t **)sources, n, len);
+	return 0;
+}
+
+#endif
+
+uint8_t
+spdk_gf_mul(uint8_t a, uint8_t b)
+{
+	return gf_mul(a, b);
+}
+
+uint8_t
+spdk_gf_inv(uint8_t a)
+{
+	if (a == 0) {
+		return 0;
+	}
+
+	return g_gf_exp[255 - g_gf_log[a]];
+}
+
+uint8_t
+spdk_gf_exp(uint32_t e)
+{
+	return g_gf_exp[e % 255];
+}
+
+int
+spdk_gf_mul_buf(void *dest, const void *src, uint8_t c, uint32_t len)
+{
+	if (dest == NULL || src == NULL) {
+		return -EINVAL;
+	}
+
+	g_gf_kernels->mul(dest, src, NULL, c, len);
+
+	return 0;
+}
+
+int
+spdk_gf_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	if (p == NULL || q == NULL || n < 1 || n > SPDK_GF_MAX_SRC) {
+		return -EINVAL;
+	}
+
+	return do_pq_gen(p, q, sources, n, len);
+}
+
+int
+spdk_gf_pq_recover(void **data, uint32_t n, void *p, void *q, const uint32_t *failed,
+		   uint32_t nfailed, uint32_t len)
+{
+	uint8_t *srcs[SPDK_GF_MAX_SRC];
+	uint32_t x, y;
+
+	if (n < 1 || n > SPDK_GF_MAX_SRC || nfailed < 1 || nfailed > 2) {
+		return -EINVAL;
+	}
+
+	x = failed[0];
+	y = nfailed == 2 ? failed[1] : x;
+	if (x >= n || y >= n || (nfailed == 2 && x == y)) {
+		return -EINVAL;
+	}
+
+	memcpy(srcs, data, n * sizeof(srcs[0]));
+
+	if (nfailed == 1) {
+		if (p != NULL) {
+			/* P is the only term of the XOR with a coefficient other than the data */
+			srcs[x] = p;
+			g_gf_kernels->pq_gen(data[x], NULL, srcs, n, len);
+		} else if (q != NULL) {
+			srcs[x] = NULL;
+			g_gf_kernels->pq_gen(NULL, data[x], srcs, n, len);
+			g_gf_kernels->mul(data[x], data[x], q, spdk_gf_inv(spdk_gf_exp(x)), len);
+		} else {
+			return -EINVAL;
+		}
+	} else {
+		uint8_t gx = spdk_gf_exp(x);
+		uint8_t gy = spdk_gf_exp(y);
+		uint8_t denom = spdk_gf_inv(gx ^ gy);
+
+		if (p == NULL || q == NULL) {
+			return -EINVAL;
+		}
+
+		srcs[x] = NULL;
+		srcs[y] = NULL;
+		g_gf_kernels->pq_gen(data[y], data[x], srcs, n, len);
+		g_gf_kernels->rec2(data[x], data[y], p, q, gf_mul(gy, denom), denom, len);
+	}
+
+	return 0;
+}
+
+size_t
+spdk_gf_get_optimal_alignment(void)
+{
+	return spdk_max(SPDK_GF_BUF_ALIGN, g_gf_kernels->vec_len);
+}
+
+SPDK_STATIC_ASSERT(SPDK_GF_BUF_ALIGN > 0 && !(SPDK_GF_BUF_ALIGN & (SPDK_GF_BUF_ALIGN - 1)),
+		   "Must be power of 2");
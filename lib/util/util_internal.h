@@ -46,4 +46,63 @@ uint32_t crc32_update(const struct spdk_crc32_table *table,
 		      const void *buf, size_t len,
 		      uint32_t crc);
 
+/**
+ * Maximum number of buffers whose CRCs are computed in parallel by the multi-buffer
+ * CRC functions. Larger counts are processed in groups of this size.
+ */
+#define SPDK_CRC_MULTI_LANES 4
+
+/**
+ * Calculate the CRC-16 T10-DIF of multiple buffers of the same length.
+ *
+ * Each buffer is an independent dependency chain, so interleaving them makes
+ * use of the multiple carry-less multiplication or table lookup units of the CPU.
+ *
+ * \param crcs Array of n CRCs. On input the initial CRC of each buffer, on output
+ * the CRC of each buffer.
+ * \param bufs Array of n data buffers.
+ * \param len Length of each buffer in bytes.
+ * \param n Number of buffers.
+ */
+void crc16_t10dif_multi(uint16_t *crcs, uint8_t **bufs, size_t len, uint32_t n);
+
+/**
+ * Calculate the CRC-64 NVMe of multiple buffers of the same length.
+ *
+ * \param crcs Array of n CRCs. On input the initial CRC of each buffer, on output
+ * the CRC of each buffer.
+ * \param bufs Array of n data buffers.
+ * \param len Length of each buffer in bytes.
+ * \param n Number of buffers.
+ */
+void crc64_nvme_multi(uint64_t *crcs, uint8_t **bufs, size_t len, uint32_t n);
+
+/**
+ * Copy multiple buffers of the same length and calculate their CRC-16 T10-DIF
+ * in a single pass.
+ *
+ * \param crcs Array of n CRCs. On input the initial CRC of each buffer, on output
+ * the CRC of each buffer.
+ * \param dsts Array of n destination buffers.
+ * \param srcs Array of n source buffers.
+ * \param len Length of each buffer in bytes.
+ * \param n Number of buffers.
+ */
+void crc16_t10dif_copy_multi(uint16_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len,
+			     uint32_t n);
+
+/**
+ * Copy multiple buffers of the same length and calculate their CRC-64 NVMe
+ * in a single pass.
+ *
+ * \param crcs Array of n CRCs. On input the initial CRC of each buffer, on output
+ * the CRC of each buffer.
+ * \param dsts Array of n destination buffers.
+ * \param srcs Array of n source buffers.
+ * \param len Length of each buffer in bytes.
+ * \param n Number of buffers.
+ */
+void crc64_nvme_copy_multi(uint64_t *crcs, uint8_t **dsts, uint8_t **srcs, size_t len,
+			   uint32_t n);
+
 #endif /* SPDK_UTIL_INTERNAL_H */
@@ -8,9 +8,23 @@
 #include "spdk/assert.h"
 #include "spdk/util.h"
 
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 /* maximum number of source buffers */
 #define SPDK_XOR_MAX_SRC	256
 
+/*
+ * Destinations of at least this size are written with non-temporal stores. Parity of large
+ * stripes is not read back by the CPU and would only evict the source data from the cache.
+ */
+#define XOR_NT_STORE_THRESHOLD	(256 * 1024)
+
+typedef void (*xor_gen_fn)(void *dest, void **sources, uint32_t n, uint32_t len);
+
 static inline bool
 is_aligned(void *ptr, size_t alignment)
 {
@@ -48,6 +62,22 @@ xor_gen_unaligned(void *dest, void **sources, uint32_t n, uint32_t len)
 	}
 }
 
+/* XOR the remaining bytes starting at offset */
+static void
+xor_gen_tail(void *dest, void **sources, uint32_t n, uint32_t len, uint32_t offset)
+{
+	uint32_t j;
+
+	for (; offset < len; offset++) {
+		uint8_t b = 0;
+
+		for (j = 0; j < n; j++) {
+			b ^= ((uint8_t *)sources[j])[offset];
+		}
+		((uint8_t *)dest)[offset] = b;
+	}
+}
+
 static void
 xor_gen_basic(void *dest, void **sources, uint32_t n, uint32_t len)
 {
@@ -73,15 +103,211 @@ xor_gen_basic(void *dest, void **sources, uint32_t n, uint32_t len)
 		((uint64_t *)dest)[i] = w;
 	}
 
-	if (len_rem < len) {
-		void *sources2[SPDK_XOR_MAX_SRC];
+	xor_gen_tail(dest, sources, n, len, len_rem);
+}
+
+#if defined(__x86_64__)
 
-		for (j = 0; j < n; j++) {
-			sources2[j] = (uint8_t *)sources[j] + len_rem;
+#define XOR_AVX2_TARGET		__attribute__((target("avx2")))
+#define XOR_AVX512_TARGET	__attribute__((target("avx512f")))
+
+#define XOR_LOAD256(p, aligned) \
+	((aligned) ? _mm256_load_si256((const __m256i *)(p)) : _mm256_loadu_si256((const __m256i *)(p)))
+#define XOR_LOAD512(p, aligned) \
+	((aligned) ? _mm512_load_si512((const void *)(p)) : _mm512_loadu_si512((const void *)(p)))
+
+/* Process 4 vectors per iteration to have enough loads in flight */
+static inline __attribute__((always_inline)) XOR_AVX2_TARGET void
+_xor_gen_avx2(uint8_t *dest, void **sources, uint32_t n, uint32_t len, bool aligned, bool nt)
+{
+	__m256i v0, v1, v2, v3;
+	const uint8_t *s;
+	uint32_t offset, i;
+
+	for (offset = 0; offset + 4 * sizeof(__m256i) <= len; offset += 4 * sizeof(__m256i)) {
+		s = (const uint8_t *)sources[0] + offset;
+		v0 = XOR_LOAD256(s, aligned);
+		v1 = XOR_LOAD256(s + 32, aligned);
+		v2 = XOR_LOAD256(s + 64, aligned);
+		v3 = XOR_LOAD256(s + 96, aligned);
+
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + offset;
+			v0 = _mm256_xor_si256(v0, XOR_LOAD256(s, aligned));
+			v1 = _mm256_xor_si256(v1, XOR_LOAD256(s + 32, aligned));
+			v2 = _mm256_xor_si256(v2, XOR_LOAD256(s + 64, aligned));
+			v3 = _mm256_xor_si256(v3, XOR_LOAD256(s + 96, aligned));
+		}
+
+		if (nt) {
+			_mm256_stream_si256((__m256i *)(dest + offset), v0);
+			_mm256_stream_si256((__m256i *)(dest + offset + 32), v1);
+			_mm256_stream_si256((__m256i *)(dest + offset + 64), v2);
+			_mm256_stream_si256((__m256i *)(dest + offset + 96), v3);
+		} else {
+			_mm256_storeu_si256((__m256i *)(dest + offset), v0);
+			_mm256_storeu_si256((__m256i *)(dest + offset + 32), v1);
+			_mm256_storeu_si256((__m256i *)(dest + offset + 64), v2);
+			_mm256_storeu_si256((__m256i *)(dest + offset + 96), v3);
 		}
+	}
+
+	for (; offset + sizeof(__m256i) <= len; offset += sizeof(__m256i)) {
+		v0 = _mm256_loadu_si256((const __m256i *)((const uint8_t *)sources[0] + offset));
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + offset;
+			v0 = _mm256_xor_si256(v0, _mm256_loadu_si256((const __m256i *)s));
+		}
+		_mm256_storeu_si256((__m256i *)(dest + offset), v0);
+	}
 
-		xor_gen_unaligned((uint8_t *)dest + len_rem, sources2, n, len - len_rem);
+	if (nt) {
+		_mm_sfence();
 	}
+
+	xor_gen_tail(dest, sources, n, len, offset);
+}
+
+static XOR_AVX2_TARGET void
+xor_gen_avx2(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	if (!buffers_aligned(dest, sources, n, sizeof(__m256i))) {
+		_xor_gen_avx2(dest, sources, n, len, false, false);
+	} else if (len < XOR_NT_STORE_THRESHOLD) {
+		_xor_gen_avx2(dest, sources, n, len, true, false);
+	} else {
+		_xor_gen_avx2(dest, sources, n, len, true, true);
+	}
+}
+
+static inline __attribute__((always_inline)) XOR_AVX512_TARGET void
+_xor_gen_avx512(uint8_t *dest, void **sources, uint32_t n, uint32_t len, bool aligned, bool nt)
+{
+	__m512i v0, v1, v2, v3;
+	const uint8_t *s;
+	uint32_t offset, i;
+
+	for (offset = 0; offset + 4 * sizeof(__m512i) <= len; offset += 4 * sizeof(__m512i)) {
+		s = (const uint8_t *)sources[0] + offset;
+		v0 = XOR_LOAD512(s, aligned);
+		v1 = XOR_LOAD512(s + 64, aligned);
+		v2 = XOR_LOAD512(s + 128, aligned);
+		v3 = XOR_LOAD512(s + 192, aligned);
+
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + offset;
+			v0 = _mm512_xor_si512(v0, XOR_LOAD512(s, aligned));
+			v1 = _mm512_xor_si512(v1, XOR_LOAD512(s + 64, aligned));
+			v2 = _mm512_xor_si512(v2, XOR_LOAD512(s + 128, aligned));
+			v3 = _mm512_xor_si512(v3, XOR_LOAD512(s + 192, aligned));
+		}
+
+		if (nt) {
+			_mm512_stream_si512((void *)(dest + offset), v0);
+			_mm512_stream_si512((void *)(dest + offset + 64), v1);
+			_mm512_stream_si512((void *)(dest + offset + 128), v2);
+			_mm512_stream_si512((void *)(dest + offset + 192), v3);
+		} else {
+			_mm512_storeu_si512((void *)(dest + offset), v0);
+			_mm512_storeu_si512((void *)(dest + offset + 64), v1);
+			_mm512_storeu_si512((void *)(dest + offset + 128), v2);
+			_mm512_storeu_si512((void *)(dest + offset + 192), v3);
+		}
+	}
+
+	for (; offset + sizeof(__m512i) <= len; offset += sizeof(__m512i)) {
+		v0 = _mm512_loadu_si512((const void *)((const uint8_t *)sources[0] + offset));
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + offset;
+			v0 = _mm512_xor_si512(v0, _mm512_loadu_si512((const void *)s));
+		}
+		_mm512_storeu_si512((void *)(dest + offset), v0);
+	}
+
+	if (nt) {
+		_mm_sfence();
+	}
+
+	xor_gen_tail(dest, sources, n, len, offset);
+}
+
+static XOR_AVX512_TARGET void
+xor_gen_avx512(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	if (!buffers_aligned(dest, sources, n, sizeof(__m512i))) {
+		_xor_gen_avx512(dest, sources, n, len, false, false);
+	} else if (len < XOR_NT_STORE_THRESHOLD) {
+		_xor_gen_avx512(dest, sources, n, len, true, false);
+	} else {
+		_xor_gen_avx512(dest, sources, n, len, true, true);
+	}
+}
+
+#elif defined(__aarch64__)
+
+/* NEON loads and stores don't depend on the alignment and have no non-temporal variant */
+static void
+xor_gen_neon(void *dest, void **sources, uint32_t n, uint32_t len)
+{
+	uint8x16_t v0, v1, v2, v3;
+	const uint8_t *s;
+	uint8_t *d = dest;
+	uint32_t offset, i;
+
+	for (offset = 0; offset + 4 * sizeof(uint8x16_t) <= len; offset += 4 * sizeof(uint8x16_t)) {
+		s = (const uint8_t *)sources[0] + offset;
+		v0 = vld1q_u8(s);
+		v1 = vld1q_u8(s + 16);
+		v2 = vld1q_u8(s + 32);
+		v3 = vld1q_u8(s + 48);
+
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + offset;
+			v0 = veorq_u8(v0, vld1q_u8(s));
+			v1 = veorq_u8(v1, vld1q_u8(s + 16));
+			v2 = veorq_u8(v2, vld1q_u8(s + 32));
+			v3 = veorq_u8(v3, vld1q_u8(s + 48));
+		}
+
+		vst1q_u8(d + offset, v0);
+		vst1q_u8(d + offset + 16, v1);
+		vst1q_u8(d + offset + 32, v2);
+		vst1q_u8(d + offset + 48, v3);
+	}
+
+	for (; offset + sizeof(uint8x16_t) <= len; offset += sizeof(uint8x16_t)) {
+		v0 = vld1q_u8((const uint8_t *)sources[0] + offset);
+		for (i = 1; i < n; i++) {
+			v0 = veorq_u8(v0, vld1q_u8((const uint8_t *)sources[i] + offset));
+		}
+		vst1q_u8(d + offset, v0);
+	}
+
+	xor_gen_tail(dest, sources, n, len, offset);
+}
+
+#endif
+
+/* The best kernel supported by the CPU and the buffer alignment it prefers */
+static xor_gen_fn g_xor_gen_fn = xor_gen_basic;
+static size_t g_xor_gen_align = sizeof(uint64_t);
+
+__attribute__((constructor)) static void
+xor_init(void)
+{
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		g_xor_gen_fn = xor_gen_avx512;
+		g_xor_gen_align = sizeof(__m512i);
+	} else if (__builtin_cpu_supports("avx2")) {
+		g_xor_gen_fn = xor_gen_avx2;
+		g_xor_gen_align = sizeof(__m256i);
+	}
+#elif defined(__aarch64__)
+	g_xor_gen_fn = xor_gen_neon;
+	g_xor_gen_align = sizeof(uint8x16_t);
+#endif
 }
 
 #ifdef SPDK_CONFIG_ISAL
@@ -92,7 +318,8 @@ xor_gen_basic(void *dest, void **sources, uint32_t n, uint32_t len)
 static int
 do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 {
-	if (buffers_aligned(dest, sources, n, SPDK_XOR_BUF_ALIGN)) {
+	/* ISA-L doesn't use non-temporal stores, large stripes go to our kernels */
+	if (len < XOR_NT_STORE_THRESHOLD && buffers_aligned(dest, sources, n, SPDK_XOR_BUF_ALIGN)) {
 		void *buffers[SPDK_XOR_MAX_SRC + 1];
 
 		if (n >= INT_MAX) {
@@ -106,7 +333,7 @@ do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 			return -EINVAL;
 		}
 	} else {
-		xor_gen_basic(dest, sources, n, len);
+		g_xor_gen_fn(dest, sources, n, len);
 	}
 
 	return 0;
@@ -119,7 +346,7 @@ do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 static inline int
 do_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 {
-	xor_gen_basic(dest, sources, n, len);
+	g_xor_gen_fn(dest, sources, n, len);
 	return 0;
 }
 
@@ -138,7 +365,7 @@ spdk_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 size_t
 spdk_xor_get_optimal_alignment(void)
 {
-	return SPDK_XOR_BUF_ALIGN;
+	return spdk_max(SPDK_XOR_BUF_ALIGN, g_xor_gen_align);
 }
 
 SPDK_STATIC_ASSERT(SPDK_XOR_BUF_ALIGN > 0 && !(SPDK_XOR_BUF_ALIGN & (SPDK_XOR_BUF_ALIGN - 1)),
@@ -18,6 +18,7 @@
 #include "spdk/thread.h"
 #include "spdk/idxd.h"
 #include "spdk/util.h"
+#include "spdk/dif.h"
 #include "spdk/json.h"
 #include "spdk/trace.h"
 #include "spdk_internal/trace_defs.h"
@@ -109,10 +110,20 @@ static void
 dsa_done(void *cb_arg, int status)
 {
 	struct idxd_task *idxd_task = cb_arg;
+	struct spdk_accel_task *task = &idxd_task->task;
 	struct idxd_io_channel *chan;
 
 	chan = idxd_task->chan;
 
+	/* DSA reports only that a DIF error was found, verify the data on the CPU to find out
+	 * which block and field it was */
+	if (spdk_unlikely(status == -EIO && task->dif.err != NULL &&
+			  (task->op_code == SPDK_ACCEL_OPC_DIF_VERIFY ||
+			   task->op_code == SPDK_ACCEL_OPC_DIF_VERIFY_COPY))) {
+		spdk_dif_verify(task->s.iovs, task->s.iovcnt, task->num_blocks, task->dif.ctx,
+				task->dif.err);
+	}
+
 	assert(chan->num_outstanding > 0);
 	spdk_trace_record(TRACE_ACCEL_DSA_OP_COMPLETE, 0, 0, 0, chan->num_outstanding - 1);
 	chan->num_outstanding--;
@@ -139,6 +150,64 @@ idxd_submit_dualcast(struct idxd_io_channel *ch, struct idxd_task *idxd_task, in
 					 task->d.iovs[0].iov_len, flags, dsa_done, idxd_task);
 }
 
+static bool
+dsa_task_needs_sw(struct spdk_accel_task *task)
+{
+	const struct spdk_dif_ctx *ctx = task->dif.ctx;
+	uint32_t required_flags;
+
+	switch (task->op_code) {
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		return !spdk_idxd_dif_ctx_is_supported(ctx);
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		/* DSA always writes all the DIF fields */
+		required_flags = SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK;
+		if (ctx->dif_type != SPDK_DIF_TYPE3) {
+			required_flags |= SPDK_DIF_FLAGS_REFTAG_CHECK;
+		}
+		return !spdk_idxd_dif_ctx_is_supported(ctx) ||
+		       (ctx->dif_flags & required_flags) != required_flags;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		/* DSA can't insert DIF in place */
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* DIF formats and operations DSA can't handle are processed on the CPU */
+static int
+dsa_dif_sw(struct spdk_accel_task *task)
+{
+	int rc;
+
+	switch (task->op_code) {
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		rc = spdk_dif_verify(task->s.iovs, task->s.iovcnt, task->num_blocks,
+				     task->dif.ctx, task->dif.err);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		rc = spdk_dif_generate(task->s.iovs, task->s.iovcnt, task->num_blocks,
+				       task->dif.ctx);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		rc = spdk_dif_generate_copy(task->s.iovs, task->s.iovcnt, task->d.iovs,
+					    task->d.iovcnt, task->num_blocks, task->dif.ctx);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		rc = spdk_dif_verify_copy(task->d.iovs, task->d.iovcnt, task->s.iovs,
+					  task->s.iovcnt, task->num_blocks, task->dif.ctx,
+					  task->dif.err);
+		break;
+	default:
+		assert(false);
+		return -EINVAL;
+	}
+
+	return rc == -1 ? -EIO : rc;
+}
+
 static int
 _process_single_task(struct spdk_io_channel *ch, struct spdk_accel_task *task)
 {
@@ -176,6 +245,23 @@ _process_single_task(struct spdk_io_channel *ch, struct spdk_accel_task *task)
 						  task->seed, task->crc_dst, flags,
 						  dsa_done, idxd_task);
 		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		rc = spdk_idxd_submit_dif_check(chan->chan, task->s.iovs, task->s.iovcnt,
+						task->num_blocks, task->dif.ctx, flags,
+						dsa_done, idxd_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		rc = spdk_idxd_submit_dif_insert(chan->chan, task->d.iovs, task->d.iovcnt,
+						 task->s.iovs, task->s.iovcnt,
+						 task->num_blocks, task->dif.ctx, flags,
+						 dsa_done, idxd_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		rc = spdk_idxd_submit_dif_strip(chan->chan, task->d.iovs, task->d.iovcnt,
+						task->s.iovs, task->s.iovcnt,
+						task->num_blocks, task->dif.ctx, flags,
+						dsa_done, idxd_task);
+		break;
 	default:
 		assert(false);
 		rc = -EINVAL;
@@ -220,6 +306,12 @@ dsa_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *first_task)
 	 */
 	while (task) {
 		tmp = TAILQ_NEXT(task, link);
+		if (spdk_unlikely(dsa_task_needs_sw(task))) {
+			spdk_accel_task_complete(task, dsa_dif_sw(task));
+			task = tmp;
+			continue;
+		}
+
 		rc = _process_single_task(ch, task);
 
 		if (rc == -EBUSY) {
@@ -288,6 +380,10 @@ dsa_supports_opcode(enum spdk_accel_opcode opc)
 	case SPDK_ACCEL_OPC_COMPARE:
 	case SPDK_ACCEL_OPC_CRC32C:
 	case SPDK_ACCEL_OPC_COPY_CRC32C:
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
 		return true;
 	default:
 		return false;
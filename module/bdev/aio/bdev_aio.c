@@ -56,6 +56,12 @@ struct bdev_aio_task {
 #endif
 	uint64_t			len;
 	struct bdev_aio_io_channel	*ch;
+#ifndef __FreeBSD__
+	/* Unmaps and write zeroes executed by the fallocate() thread */
+	struct spdk_thread		*thread;
+	int				rc;
+	TAILQ_ENTRY(bdev_aio_task)	link;
+#endif
 };
 
 struct file_disk {
@@ -67,6 +73,9 @@ struct file_disk {
 	TAILQ_ENTRY(file_disk)  link;
 	bool			block_size_override;
 	bool			readonly;
+	/* fallocate() modes of unmap and write zeroes, negative if not supported */
+	int			discard_mode;
+	int			zeroes_mode;
 };
 
 /* For user space reaping of completions */
@@ -174,6 +183,8 @@ bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 
 	if (type == SPDK_BDEV_IO_TYPE_READ) {
 		return aio_readv(aiocb);
+	} else if (type == SPDK_BDEV_IO_TYPE_FLUSH) {
+		return aio_fsync(O_SYNC, aiocb);
 	}
 
 	return aio_writev(aiocb);
@@ -189,6 +200,8 @@ bdev_aio_submit_io(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 
 	if (type == SPDK_BDEV_IO_TYPE_READ) {
 		io_prep_preadv(iocb, fdisk->fd, iov, iovcnt, offset);
+	} else if (type == SPDK_BDEV_IO_TYPE_FLUSH) {
+		io_prep_fdsync(iocb, fdisk->fd);
 	} else {
 		io_prep_pwritev(iocb, fdisk->fd, iov, iovcnt, offset);
 	}
@@ -234,10 +247,22 @@ bdev_aio_rw(enum spdk_bdev_io_type type, struct file_disk *fdisk,
 }
 
 static void
-bdev_aio_flush(struct file_disk *fdisk, struct bdev_aio_task *aio_task)
+bdev_aio_flush(struct file_disk *fdisk, struct spdk_io_channel *ch, struct bdev_aio_task *aio_task)
 {
-	int rc = fsync(fdisk->fd);
+	struct bdev_aio_io_channel *aio_ch = spdk_io_channel_get_ctx(ch);
+	int rc;
 
+	rc = bdev_aio_submit_io(SPDK_BDEV_IO_TYPE_FLUSH, fdisk, ch, aio_task, NULL, 0, 0, 0);
+	if (spdk_likely(rc >= 0)) {
+		aio_ch->io_inflight++;
+		return;
+	} else if (rc == -EAGAIN) {
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task), SPDK_BDEV_IO_STATUS_NOMEM);
+		return;
+	}
+
+	/* Asynchronous fsync is not supported by older kernels and by some filesystems */
+	rc = fsync(fdisk->fd);
 	if (rc == 0) {
 		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task), SPDK_BDEV_IO_STATUS_SUCCESS);
 	} else {
@@ -245,6 +270,130 @@ bdev_aio_flush(struct file_disk *fdisk, struct bdev_aio_task *aio_task)
 	}
 }
 
+#ifndef __FreeBSD__
+/* There are no AIO operations deallocating or zeroing ranges, so fallocate() is called by a
+ * separate thread, which doesn't block the reactors */
+static pthread_t g_fallocate_thread;
+static bool g_fallocate_thread_running;
+static bool g_fallocate_thread_exit;
+static pthread_mutex_t g_fallocate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_fallocate_cond = PTHREAD_COND_INITIALIZER;
+static TAILQ_HEAD(, bdev_aio_task) g_fallocate_tasks = TAILQ_HEAD_INITIALIZER(g_fallocate_tasks);
+
+static void
+bdev_aio_fallocate_done(void *ctx)
+{
+	struct bdev_aio_task *aio_task = ctx;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(aio_task);
+
+	aio_task->ch->io_inflight--;
+	if (aio_task->rc == 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else {
+		spdk_bdev_io_complete_aio_status(bdev_io, aio_task->rc);
+	}
+}
+
+static void
+bdev_aio_fallocate(struct bdev_aio_task *aio_task)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(aio_task);
+	struct file_disk *fdisk = bdev_io->bdev->ctxt;
+	uint64_t offset = bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen;
+	uint64_t len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+	int mode;
+
+	mode = bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP ? fdisk->discard_mode : fdisk->zeroes_mode;
+	aio_task->rc = fallocate(fdisk->fd, mode, offset, len) == 0 ? 0 : -errno;
+
+	while (spdk_thread_send_msg(aio_task->thread, bdev_aio_fallocate_done, aio_task) == -ENOMEM) {
+		usleep(100);
+	}
+}
+
+static void *
+bdev_aio_fallocate_thread(void *arg)
+{
+	struct bdev_aio_task *aio_task;
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	while (true) {
+		aio_task = TAILQ_FIRST(&g_fallocate_tasks);
+		if (aio_task == NULL) {
+			if (g_fallocate_thread_exit) {
+				break;
+			}
+			pthread_cond_wait(&g_fallocate_cond, &g_fallocate_lock);
+			continue;
+		}
+
+		TAILQ_REMOVE(&g_fallocate_tasks, aio_task, link);
+		pthread_mutex_unlock(&g_fallocate_lock);
+		bdev_aio_fallocate(aio_task);
+		pthread_mutex_lock(&g_fallocate_lock);
+	}
+	pthread_mutex_unlock(&g_fallocate_lock);
+
+	return NULL;
+}
+
+static void *
+bdev_aio_fallocate_thread_start(void *arg)
+{
+	if (pthread_create(&g_fallocate_thread, NULL, bdev_aio_fallocate_thread, NULL) != 0) {
+		return NULL;
+	}
+	pthread_setname_np(g_fallocate_thread, "aio_fallocate");
+
+	return &g_fallocate_thread;
+}
+
+static void
+bdev_aio_fallocate_thread_stop(void)
+{
+	if (!g_fallocate_thread_running) {
+		return;
+	}
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	g_fallocate_thread_exit = true;
+	pthread_cond_signal(&g_fallocate_cond);
+	pthread_mutex_unlock(&g_fallocate_lock);
+
+	pthread_join(g_fallocate_thread, NULL);
+	g_fallocate_thread_running = false;
+}
+
+static void
+bdev_aio_unmap_write_zeroes(struct spdk_io_channel *ch, struct bdev_aio_task *aio_task)
+{
+	struct bdev_aio_io_channel *aio_ch = spdk_io_channel_get_ctx(ch);
+
+	aio_task->ch = aio_ch;
+	aio_task->thread = spdk_get_thread();
+	aio_ch->io_inflight++;
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	TAILQ_INSERT_TAIL(&g_fallocate_tasks, aio_task, link);
+	pthread_cond_signal(&g_fallocate_cond);
+	pthread_mutex_unlock(&g_fallocate_lock);
+}
+
+static bool
+bdev_aio_unmap_write_zeroes_supported(struct file_disk *fdisk, enum spdk_bdev_io_type io_type)
+{
+	if (!g_fallocate_thread_running) {
+		return false;
+	}
+
+	if (io_type == SPDK_BDEV_IO_TYPE_UNMAP) {
+		return fdisk->discard_mode >= 0;
+	}
+
+	return fdisk->zeroes_mode >= 0;
+}
+#endif
+
 static void
 bdev_aio_destruct_cb(void *io_device)
 {
@@ -569,10 +718,17 @@ _bdev_aio_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 		return 0;
 
 	case SPDK_BDEV_IO_TYPE_FLUSH:
-		bdev_aio_flush((struct file_disk *)bdev_io->bdev->ctxt,
+		bdev_aio_flush((struct file_disk *)bdev_io->bdev->ctxt, ch,
 			       (struct bdev_aio_task *)bdev_io->driver_ctx);
 		return 0;
 
+#ifndef __FreeBSD__
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		bdev_aio_unmap_write_zeroes(ch, (struct bdev_aio_task *)bdev_io->driver_ctx);
+		return 0;
+#endif
+
 	case SPDK_BDEV_IO_TYPE_RESET:
 		bdev_aio_reset((struct file_disk *)bdev_io->bdev->ctxt,
 			       (struct bdev_aio_task *)bdev_io->driver_ctx);
@@ -600,6 +756,12 @@ bdev_aio_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	case SPDK_BDEV_IO_TYPE_RESET:
 		return true;
 
+#ifndef __FreeBSD__
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		return bdev_aio_unmap_write_zeroes_supported(ctx, io_type);
+#endif
+
 	default:
 		return false;
 	}
@@ -841,6 +1003,8 @@ create_aio_bdev(const char *name, const char *filename, uint32_t block_size, boo
 	}
 
 	disk_size = spdk_fd_get_size(fdisk->fd);
+	fdisk->discard_mode = spdk_fd_get_discard_mode(fdisk->fd);
+	fdisk->zeroes_mode = spdk_fd_get_zeroes_mode(fdisk->fd);
 
 	fdisk->disk.name = strdup(name);
 	if (!fdisk->disk.name) {
@@ -1014,12 +1178,25 @@ bdev_aio_initialize(void)
 	spdk_io_device_register(&aio_if, bdev_aio_group_create_cb, bdev_aio_group_destroy_cb,
 				sizeof(struct bdev_aio_group_channel), "aio_module");
 
+#ifndef __FreeBSD__
+	/* Keep the thread off the reactors' cores, unmaps and write zeroes are still
+	 * emulated by the bdev layer if it can't be started */
+	if (spdk_call_unaffinitized(bdev_aio_fallocate_thread_start, NULL) != NULL) {
+		g_fallocate_thread_running = true;
+	} else {
+		SPDK_WARNLOG("Unable to start the fallocate thread, unmap is not supported\n");
+	}
+#endif
+
 	return 0;
 }
 
 static void
 bdev_aio_fini(void)
 {
+#ifndef __FreeBSD__
+	bdev_aio_fallocate_thread_stop();
+#endif
 	spdk_io_device_unregister(&aio_if, NULL);
 }
 
@@ -765,6 +765,8 @@ static struct {
 	{ "1", RAID1 },
 	{ "raid5f", RAID5F },
 	{ "5f", RAID5F },
+	{ "raid6", RAID6 },
+	{ "6", RAID6 },
 	{ "concat", CONCAT },
 	{ }
 };
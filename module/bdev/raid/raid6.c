@@ -0,0 +1,1248 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "bdev_raid.h"
+
+#include "spdk/env.h"
+#include "spdk/thread.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+#include "spdk/likely.h"
+#include "spdk/log.h"
+#include "spdk/accel.h"
+#include "spdk/gf.h"
+
+/* Maximum concurrent full stripe writes per io channel */
+#define RAID6_MAX_STRIPES 32
+
+struct chunk {
+	/* Corresponds to base_bdev index */
+	uint8_t index;
+
+	/* Array of iovecs */
+	struct iovec *iovs;
+
+	/* Number of used iovecs */
+	int iovcnt;
+
+	/* Total number of available iovecs in the array */
+	int iovcnt_max;
+
+	/* Pointer to buffer with I/O metadata */
+	void *md_buf;
+
+	/* Shallow copy of IO request parameters */
+	struct spdk_bdev_ext_io_opts ext_opts;
+};
+
+struct stripe_request;
+typedef void (*stripe_req_pq_cb)(struct stripe_request *stripe_req, int status);
+
+struct stripe_request {
+	enum stripe_request_type {
+		STRIPE_REQ_WRITE,
+		STRIPE_REQ_RECONSTRUCT,
+	} type;
+
+	struct raid6_io_channel *r6ch;
+
+	/* The associated raid_bdev_io */
+	struct raid_bdev_io *raid_io;
+
+	/* The stripe's index in the raid array. */
+	uint64_t stripe_index;
+
+	/* The stripe's P (XOR) and Q (Reed-Solomon) parity chunks */
+	struct chunk *p_chunk;
+	struct chunk *q_chunk;
+
+	union {
+		struct {
+			/* Buffers for stripe parity */
+			void *p_buf;
+			void *q_buf;
+
+			/* Buffers for stripe io metadata parity */
+			void *p_md_buf;
+			void *q_md_buf;
+		} write;
+
+		struct {
+			/* Array of buffers for reading chunk data */
+			void **chunk_buffers;
+
+			/* Array of buffers for reading chunk metadata */
+			void **chunk_md_buffers;
+
+			/* Chunk to reconstruct */
+			struct chunk *chunk;
+
+			/* Offset from chunk start */
+			uint64_t chunk_offset;
+		} reconstruct;
+	};
+
+	/* Array of iovec iterators for each chunk */
+	struct spdk_ioviter *chunk_iov_iters;
+
+	/* Array of data buffer pointers for parity calculation */
+	void **chunk_pq_buffers;
+
+	/* Array of data buffer pointers for parity calculation of io metadata */
+	void **chunk_pq_md_buffers;
+
+	struct {
+		size_t len;
+		size_t remaining;
+		size_t remaining_md;
+		int status;
+		stripe_req_pq_cb cb;
+	} pq;
+
+	TAILQ_ENTRY(stripe_request) link;
+
+	/* Array of chunks corresponding to base_bdevs */
+	struct chunk chunks[0];
+};
+
+struct raid6_info {
+	/* The parent raid bdev */
+	struct raid_bdev *raid_bdev;
+
+	/* Number of data blocks in a stripe (without parity) */
+	uint64_t stripe_blocks;
+
+	/* Number of stripes on this array */
+	uint64_t total_stripes;
+
+	/* Alignment for buffer allocation */
+	size_t buf_alignment;
+};
+
+struct raid6_io_channel {
+	/* All available stripe requests on this channel */
+	struct {
+		TAILQ_HEAD(, stripe_request) write;
+		TAILQ_HEAD(, stripe_request) reconstruct;
+	} free_stripe_requests;
+
+	/* accel_fw channel */
+	struct spdk_io_channel *accel_ch;
+
+	/* For retrying parity calculation if accel_ch runs out of resources */
+	TAILQ_HEAD(, stripe_request) pq_retry_queue;
+
+	/* For iterating over chunk iovecs during parity calculation and reconstruction */
+	void **chunk_buffers;
+	struct iovec **chunk_iovs;
+	size_t *chunk_iovcnt;
+};
+
+#define __CHUNK_IN_RANGE(req, c) \
+	c < req->chunks + raid6_ch_to_r6_info(req->r6ch)->raid_bdev->num_base_bdevs
+
+#define FOR_EACH_CHUNK_FROM(req, c, from) \
+	for (c = from; __CHUNK_IN_RANGE(req, c); c++)
+
+#define FOR_EACH_CHUNK(req, c) \
+	FOR_EACH_CHUNK_FROM(req, c, req->chunks)
+
+#define FOR_EACH_DATA_CHUNK(req, c) \
+	for (c = raid6_next_data_chunk(req, req->chunks); __CHUNK_IN_RANGE(req, c); \
+	     c = raid6_next_data_chunk(req, c+1))
+
+static inline struct raid6_info *
+raid6_ch_to_r6_info(struct raid6_io_channel *r6ch)
+{
+	return spdk_io_channel_get_io_device(spdk_io_channel_from_ctx(r6ch));
+}
+
+static inline struct stripe_request *
+raid6_chunk_stripe_req(struct chunk *chunk)
+{
+	return SPDK_CONTAINEROF((chunk - chunk->index), struct stripe_request, chunks);
+}
+
+static inline struct chunk *
+raid6_next_data_chunk(struct stripe_request *stripe_req, struct chunk *chunk)
+{
+	while (chunk == stripe_req->p_chunk || chunk == stripe_req->q_chunk) {
+		chunk++;
+	}
+
+	return chunk;
+}
+
+static inline uint8_t
+raid6_stripe_data_chunks_num(const struct raid_bdev *raid_bdev)
+{
+	return raid_bdev->min_base_bdevs_operational;
+}
+
+/* Q rotates backwards from the last base bdev and P precedes it, wrapping around. */
+static inline uint8_t
+raid6_stripe_q_chunk_index(const struct raid_bdev *raid_bdev, uint64_t stripe_index)
+{
+	return raid_bdev->num_base_bdevs - 1 - stripe_index % raid_bdev->num_base_bdevs;
+}
+
+static inline uint8_t
+raid6_stripe_p_chunk_index(const struct raid_bdev *raid_bdev, uint64_t stripe_index)
+{
+	uint8_t q_idx = raid6_stripe_q_chunk_index(raid_bdev, stripe_index);
+
+	return q_idx == 0 ? raid_bdev->num_base_bdevs - 1 : q_idx - 1;
+}
+
+static inline uint8_t
+raid6_stripe_data_chunk_index(const struct raid_bdev *raid_bdev, uint64_t stripe_index,
+			      uint8_t data_idx)
+{
+	uint8_t p_idx = raid6_stripe_p_chunk_index(raid_bdev, stripe_index);
+	uint8_t q_idx = raid6_stripe_q_chunk_index(raid_bdev, stripe_index);
+	uint8_t chunk_idx = data_idx;
+
+	if (chunk_idx >= spdk_min(p_idx, q_idx)) {
+		chunk_idx++;
+	}
+	if (chunk_idx >= spdk_max(p_idx, q_idx)) {
+		chunk_idx++;
+	}
+
+	return chunk_idx;
+}
+
+static inline void
+raid6_stripe_request_release(struct stripe_request *stripe_req)
+{
+	if (spdk_likely(stripe_req->type == STRIPE_REQ_WRITE)) {
+		TAILQ_INSERT_HEAD(&stripe_req->r6ch->free_stripe_requests.write, stripe_req, link);
+	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
+		TAILQ_INSERT_HEAD(&stripe_req->r6ch->free_stripe_requests.reconstruct, stripe_req, link);
+	} else {
+		assert(false);
+	}
+}
+
+static void raid6_pq_stripe_retry(struct stripe_request *stripe_req);
+
+static void
+raid6_pq_stripe_done(struct stripe_request *stripe_req)
+{
+	struct raid6_io_channel *r6ch = stripe_req->r6ch;
+
+	if (stripe_req->pq.status != 0) {
+		SPDK_ERRLOG("stripe parity calculation failed: %s\n", spdk_strerror(-stripe_req->pq.status));
+	}
+
+	stripe_req->pq.cb(stripe_req, stripe_req->pq.status);
+
+	if (!TAILQ_EMPTY(&r6ch->pq_retry_queue)) {
+		stripe_req = TAILQ_FIRST(&r6ch->pq_retry_queue);
+		TAILQ_REMOVE(&r6ch->pq_retry_queue, stripe_req, link);
+		raid6_pq_stripe_retry(stripe_req);
+	}
+}
+
+static void raid6_pq_stripe_continue(struct stripe_request *stripe_req);
+
+static void
+_raid6_pq_stripe_cb(struct stripe_request *stripe_req, int status)
+{
+	if (status != 0) {
+		stripe_req->pq.status = status;
+	}
+
+	if (stripe_req->pq.remaining + stripe_req->pq.remaining_md == 0) {
+		raid6_pq_stripe_done(stripe_req);
+	}
+}
+
+static void
+raid6_pq_stripe_cb(void *_stripe_req, int status)
+{
+	struct stripe_request *stripe_req = _stripe_req;
+
+	stripe_req->pq.remaining -= stripe_req->pq.len;
+
+	if (stripe_req->pq.remaining > 0) {
+		stripe_req->pq.len = spdk_ioviter_nextv(stripe_req->chunk_iov_iters,
+							stripe_req->r6ch->chunk_buffers);
+		raid6_pq_stripe_continue(stripe_req);
+	}
+
+	_raid6_pq_stripe_cb(stripe_req, status);
+}
+
+static void
+raid6_pq_stripe_md_cb(void *_stripe_req, int status)
+{
+	struct stripe_request *stripe_req = _stripe_req;
+
+	stripe_req->pq.remaining_md = 0;
+
+	_raid6_pq_stripe_cb(stripe_req, status);
+}
+
+static void
+raid6_pq_stripe_continue(struct stripe_request *stripe_req)
+{
+	struct raid6_io_channel *r6ch = stripe_req->r6ch;
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t n_src = raid6_stripe_data_chunks_num(raid_bdev);
+	uint8_t i;
+	int ret;
+
+	assert(stripe_req->pq.len > 0);
+
+	for (i = 0; i < n_src; i++) {
+		stripe_req->chunk_pq_buffers[i] = r6ch->chunk_buffers[i];
+	}
+
+	ret = spdk_accel_submit_pq_gen(r6ch->accel_ch, r6ch->chunk_buffers[n_src],
+				       r6ch->chunk_buffers[n_src + 1], stripe_req->chunk_pq_buffers,
+				       n_src, stripe_req->pq.len, raid6_pq_stripe_cb, stripe_req);
+	if (spdk_unlikely(ret)) {
+		if (ret == -ENOMEM) {
+			TAILQ_INSERT_HEAD(&r6ch->pq_retry_queue, stripe_req, link);
+		} else {
+			stripe_req->pq.status = ret;
+			raid6_pq_stripe_done(stripe_req);
+		}
+	}
+}
+
+static void
+raid6_pq_stripe(struct stripe_request *stripe_req, stripe_req_pq_cb cb)
+{
+	struct raid6_io_channel *r6ch = stripe_req->r6ch;
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct chunk *chunk;
+	uint8_t c;
+
+	assert(cb != NULL);
+	assert(stripe_req->type == STRIPE_REQ_WRITE);
+
+	/* Data chunks in order of their Q coefficients, followed by P and Q */
+	c = 0;
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		r6ch->chunk_iovs[c] = chunk->iovs;
+		r6ch->chunk_iovcnt[c] = chunk->iovcnt;
+		c++;
+	}
+	r6ch->chunk_iovs[c] = stripe_req->p_chunk->iovs;
+	r6ch->chunk_iovcnt[c] = stripe_req->p_chunk->iovcnt;
+	c++;
+	r6ch->chunk_iovs[c] = stripe_req->q_chunk->iovs;
+	r6ch->chunk_iovcnt[c] = stripe_req->q_chunk->iovcnt;
+
+	stripe_req->pq.len = spdk_ioviter_firstv(stripe_req->chunk_iov_iters,
+			     raid_bdev->num_base_bdevs,
+			     r6ch->chunk_iovs,
+			     r6ch->chunk_iovcnt,
+			     r6ch->chunk_buffers);
+	stripe_req->pq.remaining = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	stripe_req->pq.status = 0;
+	stripe_req->pq.cb = cb;
+
+	if (spdk_bdev_io_get_md_buf(bdev_io)) {
+		uint8_t n_src = raid6_stripe_data_chunks_num(raid_bdev);
+		uint64_t len = raid_bdev->strip_size * spdk_bdev_get_md_size(&raid_bdev->bdev);
+		int ret;
+
+		stripe_req->pq.remaining_md = len;
+
+		c = 0;
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			stripe_req->chunk_pq_md_buffers[c] = chunk->md_buf;
+			c++;
+		}
+
+		ret = spdk_accel_submit_pq_gen(r6ch->accel_ch, stripe_req->p_chunk->md_buf,
+					       stripe_req->q_chunk->md_buf, stripe_req->chunk_pq_md_buffers,
+					       n_src, len, raid6_pq_stripe_md_cb, stripe_req);
+		if (spdk_unlikely(ret)) {
+			if (ret == -ENOMEM) {
+				TAILQ_INSERT_HEAD(&r6ch->pq_retry_queue, stripe_req, link);
+			} else {
+				stripe_req->pq.status = ret;
+				raid6_pq_stripe_done(stripe_req);
+			}
+			return;
+		}
+	}
+
+	raid6_pq_stripe_continue(stripe_req);
+}
+
+static void
+raid6_pq_stripe_retry(struct stripe_request *stripe_req)
+{
+	if (stripe_req->pq.remaining_md) {
+		raid6_pq_stripe(stripe_req, stripe_req->pq.cb);
+	} else {
+		raid6_pq_stripe_continue(stripe_req);
+	}
+}
+
+/*
+ * Recover the data of the failed chunks of a reconstruct request from the chunks read from the
+ * remaining base bdevs. This is done synchronously on the calling thread, as only reads of a
+ * degraded array take this path.
+ */
+static int
+raid6_reconstruct_stripe(struct stripe_request *stripe_req)
+{
+	struct raid6_io_channel *r6ch = stripe_req->r6ch;
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	uint8_t n = raid6_stripe_data_chunks_num(raid_bdev);
+	bool p_ok = raid_io->raid_ch->base_channel[stripe_req->p_chunk->index] != NULL;
+	bool q_ok = raid_io->raid_ch->base_channel[stripe_req->q_chunk->index] != NULL;
+	uint32_t failed[2];
+	uint32_t nfailed = 0;
+	struct chunk *chunk;
+	size_t len;
+	uint8_t c;
+	int ret;
+
+	c = 0;
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (raid_io->raid_ch->base_channel[chunk->index] == NULL) {
+			if (nfailed == SPDK_COUNTOF(failed)) {
+				return -EIO;
+			}
+			failed[nfailed++] = c;
+		}
+		c++;
+	}
+	assert(nfailed > 0);
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		r6ch->chunk_iovs[chunk->index] = chunk->iovs;
+		r6ch->chunk_iovcnt[chunk->index] = chunk->iovcnt;
+	}
+
+	len = spdk_ioviter_firstv(stripe_req->chunk_iov_iters, raid_bdev->num_base_bdevs,
+				  r6ch->chunk_iovs, r6ch->chunk_iovcnt, r6ch->chunk_buffers);
+	while (len > 0) {
+		c = 0;
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			stripe_req->chunk_pq_buffers[c++] = r6ch->chunk_buffers[chunk->index];
+		}
+
+		ret = spdk_gf_pq_recover(stripe_req->chunk_pq_buffers, n,
+					 p_ok ? r6ch->chunk_buffers[stripe_req->p_chunk->index] : NULL,
+					 q_ok ? r6ch->chunk_buffers[stripe_req->q_chunk->index] : NULL,
+					 failed, nfailed, len);
+		if (spdk_unlikely(ret)) {
+			return ret;
+		}
+
+		len = spdk_ioviter_nextv(stripe_req->chunk_iov_iters, r6ch->chunk_buffers);
+	}
+
+	if (spdk_bdev_io_get_md_buf(bdev_io)) {
+		c = 0;
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			stripe_req->chunk_pq_md_buffers[c++] = chunk->md_buf;
+		}
+
+		ret = spdk_gf_pq_recover(stripe_req->chunk_pq_md_buffers, n,
+					 p_ok ? stripe_req->p_chunk->md_buf : NULL,
+					 q_ok ? stripe_req->q_chunk->md_buf : NULL,
+					 failed, nfailed,
+					 bdev_io->u.bdev.num_blocks * spdk_bdev_get_md_size(&raid_bdev->bdev));
+		if (spdk_unlikely(ret)) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static void
+raid6_stripe_request_chunk_write_complete(struct stripe_request *stripe_req,
+		enum spdk_bdev_io_status status)
+{
+	if (raid_bdev_io_complete_part(stripe_req->raid_io, 1, status)) {
+		raid6_stripe_request_release(stripe_req);
+	}
+}
+
+static void
+raid6_stripe_request_chunk_read_complete(struct stripe_request *stripe_req,
+		enum spdk_bdev_io_status status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	int ret;
+
+	if (raid_io->base_bdev_io_remaining == 1) {
+		if (raid_io->base_bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS &&
+		    status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+			ret = raid6_reconstruct_stripe(stripe_req);
+			if (spdk_unlikely(ret)) {
+				SPDK_ERRLOG("stripe reconstruction failed: %s\n", spdk_strerror(-ret));
+				status = SPDK_BDEV_IO_STATUS_FAILED;
+			}
+		}
+		raid6_stripe_request_release(stripe_req);
+	}
+
+	raid_bdev_io_complete_part(raid_io, 1, status);
+}
+
+static void
+raid6_stripe_request_chunk_complete(struct stripe_request *stripe_req,
+				    enum spdk_bdev_io_status status)
+{
+	if (spdk_likely(stripe_req->type == STRIPE_REQ_WRITE)) {
+		raid6_stripe_request_chunk_write_complete(stripe_req, status);
+	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
+		raid6_stripe_request_chunk_read_complete(stripe_req, status);
+	} else {
+		assert(false);
+	}
+}
+
+static void
+raid6_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct chunk *chunk = cb_arg;
+	struct stripe_request *stripe_req = raid6_chunk_stripe_req(chunk);
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid6_stripe_request_chunk_complete(stripe_req, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+					    SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid6_stripe_request_submit_chunks(struct stripe_request *stripe_req);
+
+static void
+raid6_chunk_submit_retry(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+	struct stripe_request *stripe_req = raid_io->module_private;
+
+	raid6_stripe_request_submit_chunks(stripe_req);
+}
+
+static inline void
+raid6_init_ext_io_opts(struct spdk_bdev_io *bdev_io, struct spdk_bdev_ext_io_opts *opts)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->size = sizeof(*opts);
+	opts->memory_domain = bdev_io->u.bdev.memory_domain;
+	opts->memory_domain_ctx = bdev_io->u.bdev.memory_domain_ctx;
+	opts->metadata = bdev_io->u.bdev.md_buf;
+}
+
+static int
+raid6_chunk_submit(struct chunk *chunk)
+{
+	struct stripe_request *stripe_req = raid6_chunk_stripe_req(chunk);
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk->index];
+	struct spdk_io_channel *base_ch = raid_io->raid_ch->base_channel[chunk->index];
+	uint64_t base_offset_blocks = (stripe_req->stripe_index << raid_bdev->strip_size_shift);
+	int ret;
+
+	raid_io->base_bdev_io_submitted++;
+
+	/* Missing base bdevs are skipped, their chunks are reconstructed from parity when read */
+	if (base_ch == NULL) {
+		raid6_stripe_request_chunk_complete(stripe_req, SPDK_BDEV_IO_STATUS_SUCCESS);
+		return 0;
+	}
+
+	raid6_init_ext_io_opts(bdev_io, &chunk->ext_opts);
+	chunk->ext_opts.metadata = chunk->md_buf;
+
+	switch (stripe_req->type) {
+	case STRIPE_REQ_WRITE:
+		ret = spdk_bdev_writev_blocks_ext(base_info->desc, base_ch, chunk->iovs, chunk->iovcnt,
+						  base_offset_blocks, raid_bdev->strip_size,
+						  raid6_chunk_complete_bdev_io, chunk,
+						  &chunk->ext_opts);
+		break;
+	case STRIPE_REQ_RECONSTRUCT:
+		base_offset_blocks += stripe_req->reconstruct.chunk_offset;
+
+		ret = spdk_bdev_readv_blocks_ext(base_info->desc, base_ch, chunk->iovs, chunk->iovcnt,
+						 base_offset_blocks, bdev_io->u.bdev.num_blocks,
+						 raid6_chunk_complete_bdev_io, chunk,
+						 &chunk->ext_opts);
+		break;
+	default:
+		assert(false);
+		ret = -EINVAL;
+		break;
+	}
+
+	if (spdk_unlikely(ret)) {
+		raid_io->base_bdev_io_submitted--;
+		if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+						base_ch, raid6_chunk_submit_retry);
+		} else {
+			/*
+			 * Implicitly complete any I/Os not yet submitted as FAILED. If completing
+			 * these means there are no more to complete for the stripe request, we can
+			 * release the stripe request as well.
+			 */
+			uint64_t base_bdev_io_not_submitted = raid_bdev->num_base_bdevs -
+							      raid_io->base_bdev_io_submitted;
+
+			if (raid_bdev_io_complete_part(raid_io, base_bdev_io_not_submitted,
+						       SPDK_BDEV_IO_STATUS_FAILED)) {
+				raid6_stripe_request_release(stripe_req);
+			}
+		}
+	}
+
+	return ret;
+}
+
+static int
+raid6_chunk_set_iovcnt(struct chunk *chunk, int iovcnt)
+{
+	if (iovcnt > chunk->iovcnt_max) {
+		struct iovec *iovs = chunk->iovs;
+
+		iovs = realloc(iovs, iovcnt * sizeof(*iovs));
+		if (!iovs) {
+			return -ENOMEM;
+		}
+		chunk->iovs = iovs;
+		chunk->iovcnt_max = iovcnt;
+	}
+	chunk->iovcnt = iovcnt;
+
+	return 0;
+}
+
+static int
+raid6_stripe_request_map_iovecs(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req->raid_io->raid_bdev;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(stripe_req->raid_io);
+	const struct iovec *raid_io_iovs = bdev_io->u.bdev.iovs;
+	int raid_io_iovcnt = bdev_io->u.bdev.iovcnt;
+	void *raid_io_md = spdk_bdev_io_get_md_buf(bdev_io);
+	uint32_t raid_io_md_size = spdk_bdev_get_md_size(&raid_bdev->bdev);
+	struct chunk *chunk;
+	int raid_io_iov_idx = 0;
+	size_t raid_io_offset = 0;
+	size_t raid_io_iov_offset = 0;
+	int i;
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		int chunk_iovcnt = 0;
+		uint64_t len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+		size_t off = raid_io_iov_offset;
+		int ret;
+
+		for (i = raid_io_iov_idx; i < raid_io_iovcnt; i++) {
+			chunk_iovcnt++;
+			off += raid_io_iovs[i].iov_len;
+			if (off >= raid_io_offset + len) {
+				break;
+			}
+		}
+
+		assert(raid_io_iov_idx + chunk_iovcnt <= raid_io_iovcnt);
+
+		ret = raid6_chunk_set_iovcnt(chunk, chunk_iovcnt);
+		if (ret) {
+			return ret;
+		}
+
+		if (raid_io_md) {
+			chunk->md_buf = raid_io_md +
+					(raid_io_offset >> raid_bdev->blocklen_shift) * raid_io_md_size;
+		}
+
+		for (i = 0; i < chunk_iovcnt; i++) {
+			struct iovec *chunk_iov = &chunk->iovs[i];
+			const struct iovec *raid_io_iov = &raid_io_iovs[raid_io_iov_idx];
+			size_t chunk_iov_offset = raid_io_offset - raid_io_iov_offset;
+
+			chunk_iov->iov_base = raid_io_iov->iov_base + chunk_iov_offset;
+			chunk_iov->iov_len = spdk_min(len, raid_io_iov->iov_len - chunk_iov_offset);
+			raid_io_offset += chunk_iov->iov_len;
+			len -= chunk_iov->iov_len;
+
+			if (raid_io_offset >= raid_io_iov_offset + raid_io_iov->iov_len) {
+				raid_io_iov_idx++;
+				raid_io_iov_offset += raid_io_iov->iov_len;
+			}
+		}
+
+		if (spdk_unlikely(len > 0)) {
+			return -EINVAL;
+		}
+	}
+
+	stripe_req->p_chunk->iovs[0].iov_base = stripe_req->write.p_buf;
+	stripe_req->p_chunk->iovs[0].iov_len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	stripe_req->p_chunk->iovcnt = 1;
+	stripe_req->p_chunk->md_buf = stripe_req->write.p_md_buf;
+
+	stripe_req->q_chunk->iovs[0].iov_base = stripe_req->write.q_buf;
+	stripe_req->q_chunk->iovs[0].iov_len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	stripe_req->q_chunk->iovcnt = 1;
+	stripe_req->q_chunk->md_buf = stripe_req->write.q_md_buf;
+
+	return 0;
+}
+
+static void
+raid6_stripe_request_submit_chunks(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct chunk *start = &stripe_req->chunks[raid_io->base_bdev_io_submitted];
+	struct chunk *chunk;
+
+	FOR_EACH_CHUNK_FROM(stripe_req, chunk, start) {
+		if (spdk_unlikely(raid6_chunk_submit(chunk) != 0)) {
+			break;
+		}
+	}
+}
+
+static inline void
+raid6_stripe_request_init(struct stripe_request *stripe_req, struct raid_bdev_io *raid_io,
+			  uint64_t stripe_index)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+
+	stripe_req->raid_io = raid_io;
+	stripe_req->stripe_index = stripe_index;
+	stripe_req->p_chunk = &stripe_req->chunks[raid6_stripe_p_chunk_index(raid_bdev, stripe_index)];
+	stripe_req->q_chunk = &stripe_req->chunks[raid6_stripe_q_chunk_index(raid_bdev, stripe_index)];
+}
+
+static void
+raid6_stripe_write_request_pq_done(struct stripe_request *stripe_req, int status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	if (status != 0) {
+		raid6_stripe_request_release(stripe_req);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	} else {
+		raid6_stripe_request_submit_chunks(stripe_req);
+	}
+}
+
+static int
+raid6_submit_write_request(struct raid_bdev_io *raid_io, uint64_t stripe_index)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid6_io_channel *r6ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+	struct spdk_io_channel **base_channel = raid_io->raid_ch->base_channel;
+	struct stripe_request *stripe_req;
+	int ret;
+
+	stripe_req = TAILQ_FIRST(&r6ch->free_stripe_requests.write);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	raid6_stripe_request_init(stripe_req, raid_io, stripe_index);
+
+	ret = raid6_stripe_request_map_iovecs(stripe_req);
+	if (spdk_unlikely(ret)) {
+		return ret;
+	}
+
+	TAILQ_REMOVE(&r6ch->free_stripe_requests.write, stripe_req, link);
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+
+	if (base_channel[stripe_req->p_chunk->index] != NULL ||
+	    base_channel[stripe_req->q_chunk->index] != NULL) {
+		raid6_pq_stripe(stripe_req, raid6_stripe_write_request_pq_done);
+	} else {
+		raid6_stripe_write_request_pq_done(stripe_req, 0);
+	}
+
+	return 0;
+}
+
+static void
+raid6_chunk_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete(raid_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid6_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid6_submit_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid6_submit_rw_request(raid_io);
+}
+
+static int
+raid6_submit_reconstruct_read(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			      uint8_t chunk_idx, uint64_t chunk_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid6_io_channel *r6ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	void *bdev_io_md = spdk_bdev_io_get_md_buf(bdev_io);
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	int buf_idx;
+
+	stripe_req = TAILQ_FIRST(&r6ch->free_stripe_requests.reconstruct);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	raid6_stripe_request_init(stripe_req, raid_io, stripe_index);
+
+	stripe_req->reconstruct.chunk = &stripe_req->chunks[chunk_idx];
+	stripe_req->reconstruct.chunk_offset = chunk_offset;
+	buf_idx = 0;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		if (chunk == stripe_req->reconstruct.chunk) {
+			int i;
+			int ret;
+
+			ret = raid6_chunk_set_iovcnt(chunk, bdev_io->u.bdev.iovcnt);
+			if (ret) {
+				return ret;
+			}
+
+			for (i = 0; i < bdev_io->u.bdev.iovcnt; i++) {
+				chunk->iovs[i] = bdev_io->u.bdev.iovs[i];
+			}
+
+			chunk->md_buf = bdev_io_md;
+		} else {
+			struct iovec *iov = &chunk->iovs[0];
+
+			iov->iov_base = stripe_req->reconstruct.chunk_buffers[buf_idx];
+			iov->iov_len = bdev_io->u.bdev.num_blocks << raid_bdev->blocklen_shift;
+			chunk->iovcnt = 1;
+
+			if (bdev_io_md) {
+				chunk->md_buf = stripe_req->reconstruct.chunk_md_buffers[buf_idx];
+			}
+
+			buf_idx++;
+		}
+	}
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+
+	TAILQ_REMOVE(&r6ch->free_stripe_requests.reconstruct, stripe_req, link);
+
+	raid6_stripe_request_submit_chunks(stripe_req);
+
+	return 0;
+}
+
+static int
+raid6_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			  uint64_t stripe_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t chunk_data_idx = stripe_offset >> raid_bdev->strip_size_shift;
+	uint8_t chunk_idx = raid6_stripe_data_chunk_index(raid_bdev, stripe_index, chunk_data_idx);
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk_idx];
+	struct spdk_io_channel *base_ch = raid_io->raid_ch->base_channel[chunk_idx];
+	uint64_t chunk_offset = stripe_offset - (chunk_data_idx << raid_bdev->strip_size_shift);
+	uint64_t base_offset_blocks = (stripe_index << raid_bdev->strip_size_shift) + chunk_offset;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct spdk_bdev_ext_io_opts io_opts;
+	int ret;
+
+	raid6_init_ext_io_opts(bdev_io, &io_opts);
+	if (base_ch == NULL) {
+		return raid6_submit_reconstruct_read(raid_io, stripe_index, chunk_idx, chunk_offset);
+	}
+
+	ret = spdk_bdev_readv_blocks_ext(base_info->desc, base_ch, bdev_io->u.bdev.iovs,
+					 bdev_io->u.bdev.iovcnt,
+					 base_offset_blocks, bdev_io->u.bdev.num_blocks, raid6_chunk_read_complete, raid_io,
+					 &io_opts);
+
+	if (spdk_unlikely(ret == -ENOMEM)) {
+		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+					base_ch, _raid6_submit_rw_request);
+		return 0;
+	}
+
+	return ret;
+}
+
+static void
+raid6_submit_rw_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t stripe_index = offset_blocks / r6_info->stripe_blocks;
+	uint64_t stripe_offset = offset_blocks % r6_info->stripe_blocks;
+	int ret;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		assert(bdev_io->u.bdev.num_blocks <= raid_bdev->strip_size);
+		ret = raid6_submit_read_request(raid_io, stripe_index, stripe_offset);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		assert(stripe_offset == 0);
+		assert(bdev_io->u.bdev.num_blocks == r6_info->stripe_blocks);
+		ret = raid6_submit_write_request(raid_io, stripe_index);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	if (spdk_unlikely(ret)) {
+		raid_bdev_io_complete(raid_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+raid6_stripe_request_free(struct stripe_request *stripe_req)
+{
+	struct chunk *chunk;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		free(chunk->iovs);
+	}
+
+	if (stripe_req->type == STRIPE_REQ_WRITE) {
+		spdk_dma_free(stripe_req->write.p_buf);
+		spdk_dma_free(stripe_req->write.q_buf);
+		spdk_dma_free(stripe_req->write.p_md_buf);
+		spdk_dma_free(stripe_req->write.q_md_buf);
+	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
+		struct raid6_info *r6_info = raid6_ch_to_r6_info(stripe_req->r6ch);
+		struct raid_bdev *raid_bdev = r6_info->raid_bdev;
+		uint8_t i;
+
+		if (stripe_req->reconstruct.chunk_buffers) {
+			for (i = 0; i < raid_bdev->num_base_bdevs - 1; i++) {
+				spdk_dma_free(stripe_req->reconstruct.chunk_buffers[i]);
+			}
+			free(stripe_req->reconstruct.chunk_buffers);
+		}
+
+		if (stripe_req->reconstruct.chunk_md_buffers) {
+			for (i = 0; i < raid_bdev->num_base_bdevs - 1; i++) {
+				spdk_dma_free(stripe_req->reconstruct.chunk_md_buffers[i]);
+			}
+			free(stripe_req->reconstruct.chunk_md_buffers);
+		}
+	} else {
+		assert(false);
+	}
+
+	free(stripe_req->chunk_pq_buffers);
+	free(stripe_req->chunk_pq_md_buffers);
+	free(stripe_req->chunk_iov_iters);
+
+	free(stripe_req);
+}
+
+static struct stripe_request *
+raid6_stripe_request_alloc(struct raid6_io_channel *r6ch, enum stripe_request_type type)
+{
+	struct raid6_info *r6_info = raid6_ch_to_r6_info(r6ch);
+	struct raid_bdev *raid_bdev = r6_info->raid_bdev;
+	uint32_t raid_io_md_size = spdk_bdev_get_md_size(&raid_bdev->bdev);
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	size_t chunk_len;
+
+	stripe_req = calloc(1, sizeof(*stripe_req) + sizeof(*chunk) * raid_bdev->num_base_bdevs);
+	if (!stripe_req) {
+		return NULL;
+	}
+
+	stripe_req->r6ch = r6ch;
+	stripe_req->type = type;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->index = chunk - stripe_req->chunks;
+		chunk->iovcnt_max = 4;
+		chunk->iovs = calloc(chunk->iovcnt_max, sizeof(chunk->iovs[0]));
+		if (!chunk->iovs) {
+			goto err;
+		}
+	}
+
+	chunk_len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+
+	if (type == STRIPE_REQ_WRITE) {
+		stripe_req->write.p_buf = spdk_dma_malloc(chunk_len, r6_info->buf_alignment, NULL);
+		stripe_req->write.q_buf = spdk_dma_malloc(chunk_len, r6_info->buf_alignment, NULL);
+		if (!stripe_req->write.p_buf || !stripe_req->write.q_buf) {
+			goto err;
+		}
+
+		if (raid_io_md_size != 0) {
+			size_t md_len = raid_bdev->strip_size * raid_io_md_size;
+
+			stripe_req->write.p_md_buf = spdk_dma_malloc(md_len, r6_info->buf_alignment, NULL);
+			stripe_req->write.q_md_buf = spdk_dma_malloc(md_len, r6_info->buf_alignment, NULL);
+			if (!stripe_req->write.p_md_buf || !stripe_req->write.q_md_buf) {
+				goto err;
+			}
+		}
+	} else if (type == STRIPE_REQ_RECONSTRUCT) {
+		/* Buffers for every chunk but the one being read, missing chunks are recovered too */
+		uint8_t n = raid_bdev->num_base_bdevs - 1;
+		void *buf;
+		uint8_t i;
+
+		stripe_req->reconstruct.chunk_buffers = calloc(n, sizeof(void *));
+		if (!stripe_req->reconstruct.chunk_buffers) {
+			goto err;
+		}
+
+		for (i = 0; i < n; i++) {
+			buf = spdk_dma_malloc(chunk_len, r6_info->buf_alignment, NULL);
+			if (!buf) {
+				goto err;
+			}
+			stripe_req->reconstruct.chunk_buffers[i] = buf;
+		}
+
+		if (raid_io_md_size != 0) {
+			stripe_req->reconstruct.chunk_md_buffers = calloc(n, sizeof(void *));
+			if (!stripe_req->reconstruct.chunk_md_buffers) {
+				goto err;
+			}
+
+			for (i = 0; i < n; i++) {
+				buf = spdk_dma_malloc(raid_bdev->strip_size * raid_io_md_size, r6_info->buf_alignment, NULL);
+				if (!buf) {
+					goto err;
+				}
+				stripe_req->reconstruct.chunk_md_buffers[i] = buf;
+			}
+		}
+	} else {
+		assert(false);
+		return NULL;
+	}
+
+	stripe_req->chunk_iov_iters = malloc(SPDK_IOVITER_SIZE(raid_bdev->num_base_bdevs));
+	if (!stripe_req->chunk_iov_iters) {
+		goto err;
+	}
+
+	stripe_req->chunk_pq_buffers = calloc(raid6_stripe_data_chunks_num(raid_bdev),
+					      sizeof(stripe_req->chunk_pq_buffers[0]));
+	if (!stripe_req->chunk_pq_buffers) {
+		goto err;
+	}
+
+	stripe_req->chunk_pq_md_buffers = calloc(raid6_stripe_data_chunks_num(raid_bdev),
+					  sizeof(stripe_req->chunk_pq_md_buffers[0]));
+	if (!stripe_req->chunk_pq_md_buffers) {
+		goto err;
+	}
+
+	return stripe_req;
+err:
+	raid6_stripe_request_free(stripe_req);
+	return NULL;
+}
+
+static void
+raid6_ioch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid6_io_channel *r6ch = ctx_buf;
+	struct stripe_request *stripe_req;
+
+	assert(TAILQ_EMPTY(&r6ch->pq_retry_queue));
+
+	while ((stripe_req = TAILQ_FIRST(&r6ch->free_stripe_requests.write))) {
+		TAILQ_REMOVE(&r6ch->free_stripe_requests.write, stripe_req, link);
+		raid6_stripe_request_free(stripe_req);
+	}
+
+	while ((stripe_req = TAILQ_FIRST(&r6ch->free_stripe_requests.reconstruct))) {
+		TAILQ_REMOVE(&r6ch->free_stripe_requests.reconstruct, stripe_req, link);
+		raid6_stripe_request_free(stripe_req);
+	}
+
+	if (r6ch->accel_ch) {
+		spdk_put_io_channel(r6ch->accel_ch);
+	}
+
+	free(r6ch->chunk_buffers);
+	free(r6ch->chunk_iovs);
+	free(r6ch->chunk_iovcnt);
+}
+
+static int
+raid6_ioch_create(void *io_device, void *ctx_buf)
+{
+	struct raid6_io_channel *r6ch = ctx_buf;
+	struct raid6_info *r6_info = io_device;
+	struct raid_bdev *raid_bdev = r6_info->raid_bdev;
+	struct stripe_request *stripe_req;
+	int i;
+
+	TAILQ_INIT(&r6ch->free_stripe_requests.write);
+	TAILQ_INIT(&r6ch->free_stripe_requests.reconstruct);
+	TAILQ_INIT(&r6ch->pq_retry_queue);
+
+	for (i = 0; i < RAID6_MAX_STRIPES; i++) {
+		stripe_req = raid6_stripe_request_alloc(r6ch, STRIPE_REQ_WRITE);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r6ch->free_stripe_requests.write, stripe_req, link);
+	}
+
+	for (i = 0; i < RAID6_MAX_STRIPES; i++) {
+		stripe_req = raid6_stripe_request_alloc(r6ch, STRIPE_REQ_RECONSTRUCT);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r6ch->free_stripe_requests.reconstruct, stripe_req, link);
+	}
+
+	r6ch->accel_ch = spdk_accel_get_io_channel();
+	if (!r6ch->accel_ch) {
+		SPDK_ERRLOG("Failed to get accel framework's IO channel\n");
+		goto err;
+	}
+
+	r6ch->chunk_buffers = calloc(raid_bdev->num_base_bdevs, sizeof(*r6ch->chunk_buffers));
+	if (!r6ch->chunk_buffers) {
+		goto err;
+	}
+
+	r6ch->chunk_iovs = calloc(raid_bdev->num_base_bdevs, sizeof(*r6ch->chunk_iovs));
+	if (!r6ch->chunk_iovs) {
+		goto err;
+	}
+
+	r6ch->chunk_iovcnt = calloc(raid_bdev->num_base_bdevs, sizeof(*r6ch->chunk_iovcnt));
+	if (!r6ch->chunk_iovcnt) {
+		goto err;
+	}
+
+	return 0;
+err:
+	SPDK_ERRLOG("Failed to initialize io channel\n");
+	raid6_ioch_destroy(r6_info, r6ch);
+	return -ENOMEM;
+}
+
+static int
+raid6_start(struct raid_bdev *raid_bdev)
+{
+	uint64_t min_blockcnt = UINT64_MAX;
+	struct raid_base_bdev_info *base_info;
+	struct raid6_info *r6_info;
+	size_t alignment = spdk_gf_get_optimal_alignment();
+
+	r6_info = calloc(1, sizeof(*r6_info));
+	if (!r6_info) {
+		SPDK_ERRLOG("Failed to allocate r6_info\n");
+		return -ENOMEM;
+	}
+	r6_info->raid_bdev = raid_bdev;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		struct spdk_bdev *base_bdev;
+
+		base_bdev = spdk_bdev_desc_get_bdev(base_info->desc);
+		min_blockcnt = spdk_min(min_blockcnt, base_bdev->blockcnt);
+		alignment = spdk_max(alignment, spdk_bdev_get_buf_align(base_bdev));
+	}
+
+	r6_info->total_stripes = min_blockcnt / raid_bdev->strip_size;
+	r6_info->stripe_blocks = raid_bdev->strip_size * raid6_stripe_data_chunks_num(raid_bdev);
+	r6_info->buf_alignment = alignment;
+
+	raid_bdev->bdev.blockcnt = r6_info->stripe_blocks * r6_info->total_stripes;
+	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+	raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	raid_bdev->bdev.write_unit_size = r6_info->stripe_blocks;
+	raid_bdev->bdev.split_on_write_unit = true;
+
+	raid_bdev->module_private = r6_info;
+
+	spdk_io_device_register(r6_info, raid6_ioch_create, raid6_ioch_destroy,
+				sizeof(struct raid6_io_channel), NULL);
+
+	return 0;
+}
+
+static void
+raid6_io_device_unregister_done(void *io_device)
+{
+	struct raid6_info *r6_info = io_device;
+
+	raid_bdev_module_stop_done(r6_info->raid_bdev);
+
+	free(r6_info);
+}
+
+static bool
+raid6_stop(struct raid_bdev *raid_bdev)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+
+	spdk_io_device_unregister(r6_info, raid6_io_device_unregister_done);
+
+	return false;
+}
+
+static struct spdk_io_channel *
+raid6_get_io_channel(struct raid_bdev *raid_bdev)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+
+	return spdk_get_io_channel(r6_info);
+}
+
+static struct raid_bdev_module g_raid6_module = {
+	.level = RAID6,
+	.base_bdevs_min = 4,
+	.base_bdevs_constraint = {CONSTRAINT_MAX_BASE_BDEVS_REMOVED, 2},
+	.start = raid6_start,
+	.stop = raid6_stop,
+	.submit_rw_request = raid6_submit_rw_request,
+	.get_io_channel = raid6_get_io_channel,
+};
+RAID_MODULE_REGISTER(&g_raid6_module)
+
+SPDK_LOG_REGISTER_COMPONENT(bdev_raid6)
@@ -16,6 +16,7 @@
 #include "spdk/json.h"
 #include "spdk/util.h"
 #include "spdk/string.h"
+#include "spdk/nvme_spec.h"
 
 #include "spdk/log.h"
 #include "spdk_internal/uring.h"
@@ -25,44 +26,115 @@
 #define SECTOR_SHIFT 9
 #endif
 
+#include <linux/nvme_ioctl.h>
+#if defined(NVME_URING_CMD_IO_VEC) && defined(IORING_SETUP_SQE128) && defined(IORING_SETUP_CQE32)
+/* NVMe commands can be sent to the generic char devices of the namespaces with io_uring_cmd */
+#define URING_NVME_PASSTHRU
+#endif
+
 struct bdev_uring_zoned_dev {
 	uint64_t		num_zones;
 	uint32_t		zone_shift;
 	uint32_t		lba_shift;
 };
 
+struct bdev_uring_nvme_dev {
+	uint32_t		nsid;
+	bool			dsm;
+	bool			write_zeroes;
+	bool			copy;
+};
+
+#define SPDK_URING_QUEUE_DEPTH 512
+#define MAX_EVENTS_PER_POLL 32
+/* Size of the table of files registered with each ring */
+#define SPDK_URING_MAX_FIXED_FILES 256
+#define SPDK_URING_MAX_FIXED_BUFS 2
+
+struct bdev_uring_ring {
+	struct io_uring				uring;
+	uint64_t				io_inflight;
+	uint64_t				io_pending;
+	bool					initialized;
+	bool					iopoll;
+	bool					sqpoll;
+	bool					fixed_files;
+	/* Ring with IORING_SETUP_SQE128 and IORING_SETUP_CQE32, carrying NVMe commands */
+	bool					nvme;
+	/* Buffers registered with the ring, indexed by the buf_index of the fixed operations */
+	struct iovec				fixed_bufs[SPDK_URING_MAX_FIXED_BUFS];
+	int					num_fixed_bufs;
+	TAILQ_ENTRY(bdev_uring_ring)		sqpoll_link;
+};
+
 struct bdev_uring_io_channel {
 	struct bdev_uring_group_channel		*group_ch;
+	struct bdev_uring_ring			*ring;
+	/* The file is registered with the ring, at the file_index of the bdev */
+	bool					fixed_file;
 };
 
 struct bdev_uring_group_channel {
-	uint64_t				io_inflight;
-	uint64_t				io_pending;
 	struct spdk_poller			*poller;
-	struct io_uring				uring;
+	struct bdev_uring_ring			ring;
+	/* Ring with IORING_SETUP_IOPOLL, used by the bdevs supporting polled I/O */
+	struct bdev_uring_ring			iopoll_ring;
+	/* Ring for the NVMe passthrough bdevs, set up when the first one gets a channel */
+	struct bdev_uring_ring			nvme_ring;
 };
 
 struct bdev_uring_task {
 	uint64_t			len;
-	struct bdev_uring_io_channel	*ch;
+	struct bdev_uring_ring		*ring;
+	/* Unmaps and write zeroes executed by the fallocate() thread */
+	struct spdk_thread		*thread;
+	int				rc;
+	/* Range descriptor of the NVMe dataset management and copy commands */
+	union {
+		struct spdk_nvme_dsm_range		dsm_range;
+		struct spdk_nvme_scc_source_range	copy_range;
+	};
 	TAILQ_ENTRY(bdev_uring_task)	link;
 };
 
 struct bdev_uring {
 	struct spdk_bdev	bdev;
 	struct bdev_uring_zoned_dev	zd;
+	struct bdev_uring_nvme_dev	nd;
 	char			*filename;
 	int			fd;
+	bool			direct;
+	bool			iopoll;
+	/* NVMe generic char device, the I/O are sent as NVMe commands */
+	bool			nvme_passthru;
+	/* fallocate() modes of unmap and write zeroes, negative if not supported */
+	int			discard_mode;
+	int			zeroes_mode;
+	/* Index of the file in the tables of files registered with the rings, -1 if none */
+	int			file_index;
 	TAILQ_ENTRY(bdev_uring)  link;
 };
 
 static int bdev_uring_init(void);
 static void bdev_uring_fini(void);
 static void uring_free_bdev(struct bdev_uring *uring);
+static int bdev_uring_config_json(struct spdk_json_write_ctx *w);
+static int bdev_uring_ring_init(struct bdev_uring_ring *ring, uint32_t flags);
 static TAILQ_HEAD(, bdev_uring) g_uring_bdev_head = TAILQ_HEAD_INITIALIZER(g_uring_bdev_head);
 
-#define SPDK_URING_QUEUE_DEPTH 512
-#define MAX_EVENTS_PER_POLL 32
+static struct spdk_bdev_uring_opts g_opts = {
+	.fixed_files = false,
+	.fixed_buffers = false,
+	.sqpoll = false,
+	.sqpoll_idle_ms = 1000,
+	.iopoll = false,
+};
+
+static bool g_fixed_file_used[SPDK_URING_MAX_FIXED_FILES];
+
+/* Rings created with IORING_SETUP_SQPOLL, new ones attach to the kernel thread of the first one */
+static TAILQ_HEAD(, bdev_uring_ring) g_sqpoll_rings = TAILQ_HEAD_INITIALIZER(g_sqpoll_rings);
+static pthread_mutex_t g_sqpoll_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static int
 bdev_uring_get_ctx_size(void)
@@ -75,17 +147,59 @@ static struct spdk_bdev_module uring_if = {
 	.module_init	= bdev_uring_init,
 	.module_fini	= bdev_uring_fini,
 	.get_ctx_size	= bdev_uring_get_ctx_size,
+	.config_json	= bdev_uring_config_json,
 };
 
 SPDK_BDEV_MODULE_REGISTER(uring, &uring_if)
 
+void
+bdev_uring_get_opts(struct spdk_bdev_uring_opts *opts)
+{
+	*opts = g_opts;
+}
+
+int
+bdev_uring_set_opts(const struct spdk_bdev_uring_opts *opts)
+{
+	/* The options apply to the rings and the bdevs created afterwards */
+	if (!TAILQ_EMPTY(&g_uring_bdev_head)) {
+		return -EPERM;
+	}
+
+	g_opts = *opts;
+
+	return 0;
+}
+
+static int
+bdev_uring_config_json(struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_uring_set_options");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_bool(w, "fixed_files", g_opts.fixed_files);
+	spdk_json_write_named_bool(w, "fixed_buffers", g_opts.fixed_buffers);
+	spdk_json_write_named_bool(w, "sqpoll", g_opts.sqpoll);
+	spdk_json_write_named_uint32(w, "sqpoll_idle_ms", g_opts.sqpoll_idle_ms);
+	spdk_json_write_named_bool(w, "iopoll", g_opts.iopoll);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
 static int
 bdev_uring_open(struct bdev_uring *bdev)
 {
 	int fd;
 
+	bdev->direct = true;
 	fd = open(bdev->filename, O_RDWR | O_DIRECT | O_NOATIME);
 	if (fd < 0) {
+		bdev->direct = false;
 		/* Try without O_DIRECT for non-disk files */
 		fd = open(bdev->filename, O_RDWR | O_NOATIME);
 		if (fd < 0) {
@@ -122,30 +236,81 @@ bdev_uring_close(struct bdev_uring *bdev)
 	return 0;
 }
 
+/* Find the registered buffer containing the whole payload, -1 if there is none */
+static int
+bdev_uring_fixed_buf_index(struct bdev_uring_ring *ring, struct iovec *iov, int iovcnt)
+{
+	uintptr_t start, end;
+	int i;
+
+	/* The fixed operations take a single buffer */
+	if (iovcnt != 1) {
+		return -1;
+	}
+
+	start = (uintptr_t)iov->iov_base;
+	end = start + iov->iov_len;
+	for (i = 0; i < ring->num_fixed_bufs; i++) {
+		if (start >= (uintptr_t)ring->fixed_bufs[i].iov_base &&
+		    end <= (uintptr_t)ring->fixed_bufs[i].iov_base + ring->fixed_bufs[i].iov_len) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void
+bdev_uring_prep_rw(struct bdev_uring_io_channel *uring_ch, struct bdev_uring *uring,
+		   struct io_uring_sqe *sqe, bool write, struct iovec *iov, int iovcnt,
+		   uint64_t offset)
+{
+	int fd = uring_ch->fixed_file ? uring->file_index : uring->fd;
+	int buf_index = bdev_uring_fixed_buf_index(uring_ch->ring, iov, iovcnt);
+
+	if (buf_index >= 0) {
+		if (write) {
+			io_uring_prep_write_fixed(sqe, fd, iov->iov_base, iov->iov_len, offset, buf_index);
+		} else {
+			io_uring_prep_read_fixed(sqe, fd, iov->iov_base, iov->iov_len, offset, buf_index);
+		}
+	} else {
+		if (write) {
+			io_uring_prep_writev(sqe, fd, iov, iovcnt, offset);
+		} else {
+			io_uring_prep_readv(sqe, fd, iov, iovcnt, offset);
+		}
+	}
+
+	if (uring_ch->fixed_file) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+}
+
 static int64_t
 bdev_uring_readv(struct bdev_uring *uring, struct spdk_io_channel *ch,
 		 struct bdev_uring_task *uring_task,
 		 struct iovec *iov, int iovcnt, uint64_t nbytes, uint64_t offset)
 {
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
-	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
+	struct bdev_uring_ring *ring = uring_ch->ring;
 	struct io_uring_sqe *sqe;
 
-	sqe = io_uring_get_sqe(&group_ch->uring);
+	sqe = io_uring_get_sqe(&ring->uring);
 	if (!sqe) {
 		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
 		return -ENOMEM;
 	}
 
-	io_uring_prep_readv(sqe, uring->fd, iov, iovcnt, offset);
+	bdev_uring_prep_rw(uring_ch, uring, sqe, false, iov, iovcnt, offset);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
-	uring_task->ch = uring_ch;
+	uring_task->ring = ring;
 
 	SPDK_DEBUGLOG(uring, "read %d iovs size %lu to off: %#lx\n",
 		      iovcnt, nbytes, offset);
 
-	group_ch->io_pending++;
+	ring->io_pending++;
 	return nbytes;
 }
 
@@ -155,27 +320,511 @@ bdev_uring_writev(struct bdev_uring *uring, struct spdk_io_channel *ch,
 		  struct iovec *iov, int iovcnt, size_t nbytes, uint64_t offset)
 {
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
-	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
+	struct bdev_uring_ring *ring = uring_ch->ring;
 	struct io_uring_sqe *sqe;
 
-	sqe = io_uring_get_sqe(&group_ch->uring);
+	sqe = io_uring_get_sqe(&ring->uring);
 	if (!sqe) {
 		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
 		return -ENOMEM;
 	}
 
-	io_uring_prep_writev(sqe, uring->fd, iov, iovcnt, offset);
+	bdev_uring_prep_rw(uring_ch, uring, sqe, true, iov, iovcnt, offset);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
-	uring_task->ch = uring_ch;
+	uring_task->ring = ring;
 
 	SPDK_DEBUGLOG(uring, "write %d iovs size %lu from off: %#lx\n",
 		      iovcnt, nbytes, offset);
 
-	group_ch->io_pending++;
+	ring->io_pending++;
 	return nbytes;
 }
 
+#ifdef URING_NVME_PASSTHRU
+static inline uint32_t
+bdev_uring_nvme_cqe_cdw0(struct io_uring_cqe *cqe)
+{
+	/* With IORING_SETUP_CQE32, the completion is followed by the result of the command */
+	return (uint32_t)cqe->big_cqe[0];
+}
+
+static int
+bdev_uring_nvme_identify(int fd, uint32_t nsid, uint8_t cns, void *buf, uint32_t len)
+{
+	struct nvme_admin_cmd cmd = {};
+
+	cmd.opcode = SPDK_NVME_OPC_IDENTIFY;
+	cmd.nsid = nsid;
+	cmd.addr = (uintptr_t)buf;
+	cmd.data_len = len;
+	cmd.cdw10 = cns;
+
+	return ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd);
+}
+
+static int
+bdev_uring_nvme_probe(struct bdev_uring *uring, uint64_t *size, uint32_t *block_size)
+{
+	struct spdk_nvme_ctrlr_data *cdata;
+	struct spdk_nvme_ns_data *nsdata;
+	uint32_t format_index, max_xfer_blocks;
+	int nsid, rc = -EINVAL;
+
+	nsid = ioctl(uring->fd, NVME_IOCTL_ID);
+	if (nsid <= 0) {
+		SPDK_ERRLOG("%s is not the generic device of an NVMe namespace\n", uring->filename);
+		return -EINVAL;
+	}
+	uring->nd.nsid = nsid;
+
+	cdata = calloc(1, sizeof(*cdata));
+	nsdata = calloc(1, sizeof(*nsdata));
+	if (cdata == NULL || nsdata == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	if (bdev_uring_nvme_identify(uring->fd, 0, SPDK_NVME_IDENTIFY_CTRLR,
+				     cdata, sizeof(*cdata)) != 0 ||
+	    bdev_uring_nvme_identify(uring->fd, nsid, SPDK_NVME_IDENTIFY_NS,
+				     nsdata, sizeof(*nsdata)) != 0) {
+		SPDK_ERRLOG("Unable to identify namespace %d of %s\n", nsid, uring->filename);
+		goto out;
+	}
+
+	if (nsdata->nlbaf < 16) {
+		format_index = nsdata->flbas.format;
+	} else {
+		format_index = (nsdata->flbas.msb_format << 4) + nsdata->flbas.format;
+	}
+
+	if (nsdata->lbaf[format_index].ms != 0) {
+		SPDK_ERRLOG("Namespace %d of %s is formatted with metadata, which is not supported\n",
+			    nsid, uring->filename);
+		goto out;
+	}
+
+	*block_size = 1U << nsdata->lbaf[format_index].lbads;
+	*size = nsdata->nsze * *block_size;
+
+	uring->nd.dsm = cdata->oncs.dsm;
+	uring->nd.write_zeroes = cdata->oncs.write_zeroes;
+	uring->nd.copy = cdata->oncs.copy;
+	uring->bdev.write_cache = cdata->vwc.present;
+
+	/* Reads and writes are limited by the 16 bit block count of the commands and by the MDTS,
+	 * in units of the minimum page size of the controller, taken as 4 KiB */
+	max_xfer_blocks = UINT16_MAX + 1;
+	if (cdata->mdts != 0) {
+		max_xfer_blocks = spdk_min(max_xfer_blocks,
+					   (uint32_t)((4096ULL << cdata->mdts) / *block_size));
+	}
+	uring->bdev.optimal_io_boundary = max_xfer_blocks;
+	uring->bdev.split_on_optimal_io_boundary = true;
+
+	if (uring->nd.dsm) {
+		uring->bdev.max_unmap = UINT32_MAX;
+		uring->bdev.max_unmap_segments = 1;
+	}
+	if (uring->nd.write_zeroes) {
+		uring->bdev.max_write_zeroes = UINT16_MAX + 1;
+	}
+	if (uring->nd.copy) {
+		uring->bdev.max_copy = nsdata->mssrl;
+	}
+
+	rc = 0;
+out:
+	free(cdata);
+	free(nsdata);
+	return rc;
+}
+
+static void
+bdev_uring_nvme_set_lba_range(struct nvme_uring_cmd *cmd, uint64_t lba, uint64_t num_blocks)
+{
+	cmd->cdw10 = (uint32_t)lba;
+	cmd->cdw11 = (uint32_t)(lba >> 32);
+	/* 0's based */
+	cmd->cdw12 = num_blocks - 1;
+}
+
+static int
+bdev_uring_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
+	struct bdev_uring_task *uring_task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	struct bdev_uring_ring *ring = uring_ch->ring;
+	struct spdk_nvme_cmd *passthru_cmd;
+	struct nvme_uring_cmd cmd = {};
+	struct io_uring_sqe *sqe;
+	uint32_t cmd_op = NVME_URING_CMD_IO;
+
+	cmd.nsid = uring->nd.nsid;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		cmd.opcode = bdev_io->type == SPDK_BDEV_IO_TYPE_READ ? SPDK_NVME_OPC_READ :
+			     SPDK_NVME_OPC_WRITE;
+		if (bdev_io->u.bdev.iovcnt == 1) {
+			cmd.addr = (uintptr_t)bdev_io->u.bdev.iovs[0].iov_base;
+			cmd.data_len = bdev_io->u.bdev.iovs[0].iov_len;
+		} else {
+			cmd_op = NVME_URING_CMD_IO_VEC;
+			cmd.addr = (uintptr_t)bdev_io->u.bdev.iovs;
+			cmd.data_len = bdev_io->u.bdev.iovcnt;
+		}
+		bdev_uring_nvme_set_lba_range(&cmd, bdev_io->u.bdev.offset_blocks,
+					      bdev_io->u.bdev.num_blocks);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		cmd.opcode = SPDK_NVME_OPC_WRITE_ZEROES;
+		bdev_uring_nvme_set_lba_range(&cmd, bdev_io->u.bdev.offset_blocks,
+					      bdev_io->u.bdev.num_blocks);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		memset(&uring_task->dsm_range, 0, sizeof(uring_task->dsm_range));
+		uring_task->dsm_range.starting_lba = bdev_io->u.bdev.offset_blocks;
+		uring_task->dsm_range.length = bdev_io->u.bdev.num_blocks;
+
+		cmd.opcode = SPDK_NVME_OPC_DATASET_MANAGEMENT;
+		cmd.addr = (uintptr_t)&uring_task->dsm_range;
+		cmd.data_len = sizeof(uring_task->dsm_range);
+		/* A single range, 0's based */
+		cmd.cdw10 = 0;
+		cmd.cdw11 = SPDK_NVME_DSM_ATTR_DEALLOCATE;
+		break;
+	case SPDK_BDEV_IO_TYPE_COPY:
+		memset(&uring_task->copy_range, 0, sizeof(uring_task->copy_range));
+		uring_task->copy_range.slba = bdev_io->u.bdev.copy.src_offset_blocks;
+		/* 0's based */
+		uring_task->copy_range.nlb = bdev_io->u.bdev.num_blocks - 1;
+
+		cmd.opcode = SPDK_NVME_OPC_COPY;
+		cmd.addr = (uintptr_t)&uring_task->copy_range;
+		cmd.data_len = sizeof(uring_task->copy_range);
+		cmd.cdw10 = (uint32_t)bdev_io->u.bdev.offset_blocks;
+		cmd.cdw11 = (uint32_t)(bdev_io->u.bdev.offset_blocks >> 32);
+		/* A single range in descriptor format 0 */
+		cmd.cdw12 = 0;
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		cmd.opcode = SPDK_NVME_OPC_FLUSH;
+		break;
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+		passthru_cmd = &bdev_io->u.nvme_passthru.cmd;
+		cmd.opcode = passthru_cmd->opc;
+		cmd.addr = (uintptr_t)bdev_io->u.nvme_passthru.buf;
+		cmd.data_len = bdev_io->u.nvme_passthru.nbytes;
+		cmd.cdw10 = passthru_cmd->cdw10;
+		cmd.cdw11 = passthru_cmd->cdw11;
+		cmd.cdw12 = passthru_cmd->cdw12;
+		cmd.cdw13 = passthru_cmd->cdw13;
+		cmd.cdw14 = passthru_cmd->cdw14;
+		cmd.cdw15 = passthru_cmd->cdw15;
+		break;
+	default:
+		SPDK_ERRLOG("Wrong io type\n");
+		return -EINVAL;
+	}
+
+	sqe = io_uring_get_sqe(&ring->uring);
+	if (!sqe) {
+		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
+		return -ENOMEM;
+	}
+
+	io_uring_prep_rw(IORING_OP_URING_CMD, sqe,
+			 uring_ch->fixed_file ? uring->file_index : uring->fd, NULL, 0, 0);
+	if (uring_ch->fixed_file) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+	sqe->off = cmd_op;
+	/* The command takes the 80 bytes at the end of the 128 byte SQE */
+	memcpy(&sqe->addr3, &cmd, sizeof(cmd));
+	io_uring_sqe_set_data(sqe, uring_task);
+	/* The command completes with its NVMe status */
+	uring_task->len = 0;
+	uring_task->ring = ring;
+
+	SPDK_DEBUGLOG(uring, "nvme cmd opc %#x nsid %u on %s\n",
+		      cmd.opcode, cmd.nsid, uring->bdev.name);
+
+	ring->io_pending++;
+	return 0;
+}
+
+static int
+bdev_uring_nvme_admin_passthru(struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	struct spdk_nvme_cmd *passthru_cmd = &bdev_io->u.nvme_passthru.cmd;
+	struct nvme_admin_cmd cmd = {};
+	int rc;
+
+	cmd.opcode = passthru_cmd->opc;
+	cmd.nsid = passthru_cmd->nsid;
+	cmd.addr = (uintptr_t)bdev_io->u.nvme_passthru.buf;
+	cmd.data_len = bdev_io->u.nvme_passthru.nbytes;
+	cmd.cdw10 = passthru_cmd->cdw10;
+	cmd.cdw11 = passthru_cmd->cdw11;
+	cmd.cdw12 = passthru_cmd->cdw12;
+	cmd.cdw13 = passthru_cmd->cdw13;
+	cmd.cdw14 = passthru_cmd->cdw14;
+	cmd.cdw15 = passthru_cmd->cdw15;
+
+	/* io_uring_cmd only carries I/O commands on the generic devices of the namespaces, so the
+	 * admin commands are rare enough to go through the synchronous ioctl */
+	rc = ioctl(uring->fd, NVME_IOCTL_ADMIN_CMD, &cmd);
+	if (rc < 0) {
+		SPDK_ERRLOG("Ioctl NVME_IOCTL_ADMIN_CMD failed errno: %d(%s)\n",
+			    errno, strerror(errno));
+		return -EINVAL;
+	}
+
+	spdk_bdev_io_complete_nvme_status(bdev_io, cmd.result, (rc >> 8) & 0x7, rc & 0xff);
+
+	return 0;
+}
+
+static int
+bdev_uring_nvme_ring_init(struct bdev_uring_group_channel *group_ch)
+{
+	int rc;
+
+	if (group_ch->nvme_ring.initialized) {
+		return 0;
+	}
+
+	rc = bdev_uring_ring_init(&group_ch->nvme_ring, IORING_SETUP_SQE128 | IORING_SETUP_CQE32);
+	if (rc < 0) {
+		SPDK_ERRLOG("Unable to set up uring for NVMe commands (%s)\n", spdk_strerror(-rc));
+		return rc;
+	}
+	group_ch->nvme_ring.nvme = true;
+
+	return 0;
+}
+#else
+/* No support for NVMe passthrough */
+static inline uint32_t
+bdev_uring_nvme_cqe_cdw0(struct io_uring_cqe *cqe)
+{
+	return 0;
+}
+
+static int
+bdev_uring_nvme_probe(struct bdev_uring *uring, uint64_t *size, uint32_t *block_size)
+{
+	SPDK_ERRLOG("%s is a character device, NVMe passthrough is not supported by this build\n",
+		    uring->filename);
+	return -ENOTSUP;
+}
+
+static int
+bdev_uring_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	return -1;
+}
+
+static int
+bdev_uring_nvme_admin_passthru(struct spdk_bdev_io *bdev_io)
+{
+	return -1;
+}
+
+static int
+bdev_uring_nvme_ring_init(struct bdev_uring_group_channel *group_ch)
+{
+	return -ENOTSUP;
+}
+#endif
+
+/* Whether the kernel supports IORING_OP_FALLOCATE, added in Linux 5.6 */
+static bool g_fallocate_op;
+
+/* Without IORING_OP_FALLOCATE, fallocate() is called by a separate thread, which doesn't block the
+ * reactors */
+static pthread_t g_fallocate_thread;
+static bool g_fallocate_thread_running;
+static bool g_fallocate_thread_exit;
+static pthread_mutex_t g_fallocate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_fallocate_cond = PTHREAD_COND_INITIALIZER;
+static TAILQ_HEAD(, bdev_uring_task) g_fallocate_tasks = TAILQ_HEAD_INITIALIZER(g_fallocate_tasks);
+
+static void
+bdev_uring_fallocate_done(void *ctx)
+{
+	struct bdev_uring_task *uring_task = ctx;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(uring_task);
+
+	if (uring_task->rc == 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else {
+		spdk_bdev_io_complete_aio_status(bdev_io, uring_task->rc);
+	}
+}
+
+static void
+bdev_uring_fallocate(struct bdev_uring_task *uring_task)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(uring_task);
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	uint64_t offset = bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen;
+	uint64_t len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+	int mode;
+
+	mode = bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP ? uring->discard_mode : uring->zeroes_mode;
+	uring_task->rc = fallocate(uring->fd, mode, offset, len) == 0 ? 0 : -errno;
+
+	while (spdk_thread_send_msg(uring_task->thread, bdev_uring_fallocate_done,
+				    uring_task) == -ENOMEM) {
+		usleep(100);
+	}
+}
+
+static void *
+bdev_uring_fallocate_thread(void *arg)
+{
+	struct bdev_uring_task *uring_task;
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	while (true) {
+		uring_task = TAILQ_FIRST(&g_fallocate_tasks);
+		if (uring_task == NULL) {
+			if (g_fallocate_thread_exit) {
+				break;
+			}
+			pthread_cond_wait(&g_fallocate_cond, &g_fallocate_lock);
+			continue;
+		}
+
+		TAILQ_REMOVE(&g_fallocate_tasks, uring_task, link);
+		pthread_mutex_unlock(&g_fallocate_lock);
+		bdev_uring_fallocate(uring_task);
+		pthread_mutex_lock(&g_fallocate_lock);
+	}
+	pthread_mutex_unlock(&g_fallocate_lock);
+
+	return NULL;
+}
+
+static void *
+bdev_uring_fallocate_thread_start(void *arg)
+{
+	if (pthread_create(&g_fallocate_thread, NULL, bdev_uring_fallocate_thread, NULL) != 0) {
+		return NULL;
+	}
+	pthread_setname_np(g_fallocate_thread, "uring_fallocate");
+
+	return &g_fallocate_thread;
+}
+
+static void
+bdev_uring_fallocate_thread_stop(void)
+{
+	if (!g_fallocate_thread_running) {
+		return;
+	}
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	g_fallocate_thread_exit = true;
+	pthread_cond_signal(&g_fallocate_cond);
+	pthread_mutex_unlock(&g_fallocate_lock);
+
+	pthread_join(g_fallocate_thread, NULL);
+	g_fallocate_thread_running = false;
+}
+
+static void
+bdev_uring_fallocate_submit(struct bdev_uring_task *uring_task)
+{
+	uring_task->thread = spdk_get_thread();
+
+	pthread_mutex_lock(&g_fallocate_lock);
+	TAILQ_INSERT_TAIL(&g_fallocate_tasks, uring_task, link);
+	pthread_cond_signal(&g_fallocate_cond);
+	pthread_mutex_unlock(&g_fallocate_lock);
+}
+
+static bool
+bdev_uring_fallocate_probe(void)
+{
+	struct io_uring_probe *probe;
+	bool supported;
+
+	probe = io_uring_get_probe();
+	if (probe == NULL) {
+		return false;
+	}
+
+	supported = io_uring_opcode_supported(probe, IORING_OP_FALLOCATE);
+	io_uring_free_probe(probe);
+
+	return supported;
+}
+
+/* Flush, unmap and write zeroes, which don't transfer any data */
+static int
+bdev_uring_submit_no_data(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
+	struct bdev_uring_task *uring_task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	struct bdev_uring_ring *ring = uring_ch->ring;
+	uint64_t offset = bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen;
+	uint64_t len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+	bool fixed_file = uring_ch->fixed_file;
+	struct io_uring_sqe *sqe;
+	int fd;
+
+	if (bdev_io->type != SPDK_BDEV_IO_TYPE_FLUSH && !g_fallocate_op) {
+		bdev_uring_fallocate_submit(uring_task);
+		return 0;
+	}
+
+	/* Only reads and writes can be polled, the other operations go through the interrupt driven
+	 * ring, which the file isn't registered with */
+	if (ring->iopoll) {
+		ring = &uring_ch->group_ch->ring;
+		fixed_file = false;
+	}
+
+	sqe = io_uring_get_sqe(&ring->uring);
+	if (!sqe) {
+		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
+		return -ENOMEM;
+	}
+
+	fd = fixed_file ? uring->file_index : uring->fd;
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		io_uring_prep_fsync(sqe, fd, IORING_FSYNC_DATASYNC);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		io_uring_prep_fallocate(sqe, fd, uring->discard_mode, offset, len);
+		break;
+	default:
+		io_uring_prep_fallocate(sqe, fd, uring->zeroes_mode, offset, len);
+		break;
+	}
+
+	if (fixed_file) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+	io_uring_sqe_set_data(sqe, uring_task);
+	uring_task->len = 0;
+	uring_task->ring = ring;
+
+	SPDK_DEBUGLOG(uring, "io type %d len %lu at off: %#lx\n", bdev_io->type, len, offset);
+
+	ring->io_pending++;
+	return 0;
+}
+
 static int
 bdev_uring_destruct(void *ctx)
 {
@@ -193,18 +842,20 @@ bdev_uring_destruct(void *ctx)
 }
 
 static int
-bdev_uring_reap(struct io_uring *ring, int max)
+bdev_uring_reap(struct bdev_uring_ring *ring, int max)
 {
-	int i, count, ret;
+	int i, count, ret, res;
 	struct io_uring_cqe *cqe;
 	struct bdev_uring_task *uring_task;
-	enum spdk_bdev_io_status status;
+	struct spdk_bdev_io *bdev_io;
+	uint32_t cdw0 = 0;
 
 	count = 0;
 	for (i = 0; i < max; i++) {
-		ret = io_uring_peek_cqe(ring, &cqe);
+		ret = io_uring_peek_cqe(&ring->uring, &cqe);
 		if (ret != 0) {
-			return ret;
+			/* -EAGAIN if there are no more completions */
+			return count;
 		}
 
 		if (cqe == NULL) {
@@ -212,15 +863,24 @@ bdev_uring_reap(struct io_uring *ring, int max)
 		}
 
 		uring_task = (struct bdev_uring_task *)cqe->user_data;
-		if (cqe->res != (signed)uring_task->len) {
-			status = SPDK_BDEV_IO_STATUS_FAILED;
-		} else {
-			status = SPDK_BDEV_IO_STATUS_SUCCESS;
+		bdev_io = spdk_bdev_io_from_ctx(uring_task);
+		res = cqe->res;
+		if (ring->nvme) {
+			cdw0 = bdev_uring_nvme_cqe_cdw0(cqe);
 		}
 
-		uring_task->ch->group_ch->io_inflight--;
-		io_uring_cqe_seen(ring, cqe);
-		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), status);
+		ring->io_inflight--;
+		io_uring_cqe_seen(&ring->uring, cqe);
+
+		if (ring->nvme && res >= 0) {
+			/* The result of an NVMe command is its status field */
+			spdk_bdev_io_complete_nvme_status(bdev_io, cdw0, (res >> 8) & 0x7,
+							  res & 0xff);
+		} else if (res != (signed)uring_task->len) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		} else {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		}
 		count++;
 	}
 
@@ -228,33 +888,53 @@ bdev_uring_reap(struct io_uring *ring, int max)
 }
 
 static int
-bdev_uring_group_poll(void *arg)
+bdev_uring_ring_poll(struct bdev_uring_ring *ring)
 {
-	struct bdev_uring_group_channel *group_ch = arg;
 	int to_complete, to_submit;
 	int count, ret;
 
-	to_submit = group_ch->io_pending;
+	to_submit = ring->io_pending;
 
 	if (to_submit > 0) {
 		/* If there are I/O to submit, use io_uring_submit here.
 		 * It will automatically call spdk_io_uring_enter appropriately. */
-		ret = io_uring_submit(&group_ch->uring);
+		ret = io_uring_submit(&ring->uring);
 		if (ret < 0) {
-			return SPDK_POLLER_BUSY;
+			return 1;
 		}
 
-		group_ch->io_pending = 0;
-		group_ch->io_inflight += to_submit;
+		ring->io_pending = 0;
+		ring->io_inflight += to_submit;
+	} else if (ring->iopoll && !ring->sqpoll && ring->io_inflight > 0) {
+		/* The completions of polled I/O are only posted when entering the kernel, which
+		 * io_uring_submit() does for IOPOLL rings even if there is nothing to submit. */
+		io_uring_submit(&ring->uring);
 	}
 
-	to_complete = group_ch->io_inflight;
+	to_complete = ring->io_inflight;
 	count = 0;
 	if (to_complete > 0) {
-		count = bdev_uring_reap(&group_ch->uring, to_complete);
+		count = bdev_uring_reap(ring, to_complete);
 	}
 
-	if (count + to_submit > 0) {
+	return count + to_submit;
+}
+
+static int
+bdev_uring_group_poll(void *arg)
+{
+	struct bdev_uring_group_channel *group_ch = arg;
+	int count;
+
+	count = bdev_uring_ring_poll(&group_ch->ring);
+	if (group_ch->iopoll_ring.initialized) {
+		count += bdev_uring_ring_poll(&group_ch->iopoll_ring);
+	}
+	if (group_ch->nvme_ring.initialized) {
+		count += bdev_uring_ring_poll(&group_ch->nvme_ring);
+	}
+
+	if (count > 0) {
 		return SPDK_POLLER_BUSY;
 	} else {
 		return SPDK_POLLER_IDLE;
@@ -265,6 +945,7 @@ static void
 bdev_uring_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 		      bool success)
 {
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
 	int64_t ret = 0;
 
 	if (!success) {
@@ -272,6 +953,15 @@ bdev_uring_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 		return;
 	}
 
+	if (uring->nvme_passthru) {
+		ret = bdev_uring_nvme_submit_request(ch, bdev_io);
+		if (ret < 0) {
+			spdk_bdev_io_complete(bdev_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+					      SPDK_BDEV_IO_STATUS_FAILED);
+		}
+		return;
+	}
+
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 		ret = bdev_uring_readv((struct bdev_uring *)bdev_io->bdev->ctxt,
@@ -301,7 +991,6 @@ bdev_uring_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 	}
 }
 
-#ifdef SPDK_CONFIG_URING_ZNS
 static int
 bdev_uring_read_sysfs_attr(const char *devname, const char *attr, char *str, int str_len)
 {
@@ -341,6 +1030,21 @@ close:
 	return ret;
 }
 
+static bool
+bdev_uring_supports_iopoll(struct bdev_uring *uring)
+{
+	char str[16];
+
+	/* Polled I/O requires direct I/O to a block device with poll queues */
+	if (!uring->direct ||
+	    bdev_uring_read_sysfs_attr(uring->filename, "queue/io_poll", str, sizeof(str)) != 0) {
+		return false;
+	}
+
+	return strcmp(str, "1") == 0;
+}
+
+#ifdef SPDK_CONFIG_URING_ZNS
 static int
 bdev_uring_read_sysfs_attr_long(const char *devname, const char *attr, long *val)
 {
@@ -590,6 +1294,7 @@ bdev_uring_check_zoned_support(struct bdev_uring *uring, const char *name, const
 static int
 _bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
 
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
@@ -604,6 +1309,19 @@ _bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev
 		spdk_bdev_io_get_buf(bdev_io, bdev_uring_get_buf_cb,
 				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 		return 0;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		if (uring->nvme_passthru) {
+			return bdev_uring_nvme_submit_request(ch, bdev_io);
+		}
+		return bdev_uring_submit_no_data(ch, bdev_io);
+	/* Only supported by the NVMe passthrough bdevs */
+	case SPDK_BDEV_IO_TYPE_COPY:
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+		return bdev_uring_nvme_submit_request(ch, bdev_io);
+	case SPDK_BDEV_IO_TYPE_NVME_ADMIN:
+		return bdev_uring_nvme_admin_passthru(bdev_io);
 	default:
 		return -1;
 	}
@@ -612,14 +1330,46 @@ _bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev
 static void
 bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
-	if (_bdev_uring_submit_request(ch, bdev_io) < 0) {
+	int rc;
+
+	rc = _bdev_uring_submit_request(ch, bdev_io);
+	if (rc == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	} else if (rc < 0) {
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
 	}
 }
 
+static bool
+bdev_uring_nvme_io_type_supported(struct bdev_uring *uring, enum spdk_bdev_io_type io_type)
+{
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_NVME_IO:
+	case SPDK_BDEV_IO_TYPE_NVME_ADMIN:
+		return true;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return uring->nd.dsm;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		return uring->nd.write_zeroes;
+	case SPDK_BDEV_IO_TYPE_COPY:
+		return uring->nd.copy;
+	default:
+		return false;
+	}
+}
+
 static bool
 bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 {
+	struct bdev_uring *uring = ctx;
+
+	if (uring->nvme_passthru) {
+		return bdev_uring_nvme_io_type_supported(uring, io_type);
+	}
+
 	switch (io_type) {
 #ifdef SPDK_CONFIG_URING_ZNS
 	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
@@ -627,7 +1377,15 @@ bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 #endif
 	case SPDK_BDEV_IO_TYPE_READ:
 	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
 		return true;
+	/* Zones can only be written sequentially */
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return uring->discard_mode >= 0 && !uring->bdev.zoned &&
+		       (g_fallocate_op || g_fallocate_thread_running);
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		return uring->zeroes_mode >= 0 && !uring->bdev.zoned &&
+		       (g_fallocate_op || g_fallocate_thread_running);
 	default:
 		return false;
 	}
@@ -636,9 +1394,33 @@ bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 static int
 bdev_uring_create_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_uring *uring = io_device;
 	struct bdev_uring_io_channel *ch = ctx_buf;
+	struct spdk_io_channel *group_ioch;
+	int rc;
+
+	group_ioch = spdk_get_io_channel(&uring_if);
+	if (group_ioch == NULL) {
+		return -ENOMEM;
+	}
 
-	ch->group_ch = spdk_io_channel_get_ctx(spdk_get_io_channel(&uring_if));
+	ch->group_ch = spdk_io_channel_get_ctx(group_ioch);
+	ch->ring = &ch->group_ch->ring;
+	if (uring->nvme_passthru) {
+		rc = bdev_uring_nvme_ring_init(ch->group_ch);
+		if (rc < 0) {
+			spdk_put_io_channel(group_ioch);
+			return rc;
+		}
+		ch->ring = &ch->group_ch->nvme_ring;
+	} else if (uring->iopoll && ch->group_ch->iopoll_ring.initialized) {
+		ch->ring = &ch->group_ch->iopoll_ring;
+	}
+
+	if (ch->ring->fixed_files && uring->file_index >= 0) {
+		ch->fixed_file = io_uring_register_files_update(&ch->ring->uring, uring->file_index,
+				 &uring->fd, 1) == 1;
+	}
 
 	return 0;
 }
@@ -646,7 +1428,13 @@ bdev_uring_create_cb(void *io_device, void *ctx_buf)
 static void
 bdev_uring_destroy_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_uring *uring = io_device;
 	struct bdev_uring_io_channel *ch = ctx_buf;
+	int fd = -1;
+
+	if (ch->fixed_file) {
+		io_uring_register_files_update(&ch->ring->uring, uring->file_index, &fd, 1);
+	}
 
 	spdk_put_io_channel(spdk_io_channel_from_ctx(ch->group_ch));
 }
@@ -667,6 +1455,8 @@ bdev_uring_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_object_begin(w, "uring");
 
 	spdk_json_write_named_string(w, "filename", uring->filename);
+	spdk_json_write_named_bool(w, "iopoll", uring->iopoll);
+	spdk_json_write_named_bool(w, "nvme_passthru", uring->nvme_passthru);
 
 	spdk_json_write_object_end(w);
 
@@ -706,23 +1496,134 @@ uring_free_bdev(struct bdev_uring *uring)
 	if (uring == NULL) {
 		return;
 	}
+	if (uring->file_index >= 0) {
+		g_fixed_file_used[uring->file_index] = false;
+	}
 	free(uring->filename);
 	free(uring->bdev.name);
 	free(uring);
 }
 
+static int
+bdev_uring_ring_init_sqpoll(struct bdev_uring_ring *ring, struct io_uring_params *params)
+{
+	struct bdev_uring_ring *sqpoll_ring;
+	int rc;
+
+	params->flags |= IORING_SETUP_SQPOLL;
+	params->sq_thread_idle = g_opts.sqpoll_idle_ms;
+
+	/* Share a single submission thread between all rings */
+	pthread_mutex_lock(&g_sqpoll_mutex);
+	sqpoll_ring = TAILQ_FIRST(&g_sqpoll_rings);
+	if (sqpoll_ring != NULL) {
+		params->flags |= IORING_SETUP_ATTACH_WQ;
+		params->wq_fd = sqpoll_ring->uring.ring_fd;
+	}
+
+	rc = io_uring_queue_init_params(SPDK_URING_QUEUE_DEPTH, &ring->uring, params);
+	if (rc == 0) {
+		TAILQ_INSERT_TAIL(&g_sqpoll_rings, ring, sqpoll_link);
+		ring->sqpoll = true;
+	}
+	pthread_mutex_unlock(&g_sqpoll_mutex);
+
+	return rc;
+}
+
+static int
+bdev_uring_ring_init(struct bdev_uring_ring *ring, uint32_t flags)
+{
+	struct io_uring_params params = {};
+	struct iovec regions[SPDK_URING_MAX_FIXED_BUFS];
+	int files[SPDK_URING_MAX_FIXED_FILES];
+	int i, rc = -1;
+
+	if (g_opts.sqpoll) {
+		params.flags = flags;
+		rc = bdev_uring_ring_init_sqpoll(ring, &params);
+		if (rc < 0) {
+			SPDK_WARNLOG("Unable to set up uring with SQPOLL (%s), submitting from the poller\n",
+				     spdk_strerror(-rc));
+		}
+	}
+
+	if (!ring->sqpoll) {
+		memset(&params, 0, sizeof(params));
+		params.flags = flags;
+		rc = io_uring_queue_init_params(SPDK_URING_QUEUE_DEPTH, &ring->uring, &params);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+
+	if (g_opts.fixed_files) {
+		/* Sparse table, the files are added when the bdevs get their channels */
+		for (i = 0; i < SPDK_URING_MAX_FIXED_FILES; i++) {
+			files[i] = -1;
+		}
+
+		rc = io_uring_register_files(&ring->uring, files, SPDK_URING_MAX_FIXED_FILES);
+		if (rc < 0) {
+			SPDK_WARNLOG("Unable to register files with uring (%s)\n", spdk_strerror(-rc));
+		}
+		ring->fixed_files = rc == 0;
+	}
+
+	if (g_opts.fixed_buffers) {
+		rc = spdk_iobuf_get_pool_regions(regions, SPDK_COUNTOF(regions));
+		if (rc > 0) {
+			ring->num_fixed_bufs = rc;
+			rc = io_uring_register_buffers(&ring->uring, regions, ring->num_fixed_bufs);
+		}
+		if (rc == 0) {
+			/* Nothing is registered if the pools aren't set up */
+			memcpy(ring->fixed_bufs, regions, ring->num_fixed_bufs * sizeof(regions[0]));
+		} else {
+			SPDK_WARNLOG("Unable to register buffers with uring (%s)\n", spdk_strerror(-rc));
+			ring->num_fixed_bufs = 0;
+		}
+	}
+
+	ring->iopoll = (flags & IORING_SETUP_IOPOLL) != 0;
+	ring->initialized = true;
+
+	return 0;
+}
+
+static void
+bdev_uring_ring_fini(struct bdev_uring_ring *ring)
+{
+	if (!ring->initialized) {
+		return;
+	}
+
+	if (ring->sqpoll) {
+		pthread_mutex_lock(&g_sqpoll_mutex);
+		TAILQ_REMOVE(&g_sqpoll_rings, ring, sqpoll_link);
+		pthread_mutex_unlock(&g_sqpoll_mutex);
+	}
+
+	io_uring_queue_exit(&ring->uring);
+	ring->initialized = false;
+}
+
 static int
 bdev_uring_group_create_cb(void *io_device, void *ctx_buf)
 {
 	struct bdev_uring_group_channel *ch = ctx_buf;
 
-	/* Do not use IORING_SETUP_IOPOLL until the Linux kernel can support not only
-	 * local devices but also devices attached from remote target */
-	if (io_uring_queue_init(SPDK_URING_QUEUE_DEPTH, &ch->uring, 0) < 0) {
+	if (bdev_uring_ring_init(&ch->ring, 0) < 0) {
 		SPDK_ERRLOG("uring I/O context setup failure\n");
 		return -1;
 	}
 
+	/* Polled I/O is only supported by local devices with poll queues, so it gets a separate
+	 * ring, used by the bdevs supporting it */
+	if (g_opts.iopoll && bdev_uring_ring_init(&ch->iopoll_ring, IORING_SETUP_IOPOLL) < 0) {
+		SPDK_WARNLOG("Unable to set up uring with IOPOLL, using interrupt driven I/O\n");
+	}
+
 	ch->poller = SPDK_POLLER_REGISTER(bdev_uring_group_poll, ch, 0);
 	return 0;
 }
@@ -732,7 +1633,9 @@ bdev_uring_group_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct bdev_uring_group_channel *ch = ctx_buf;
 
-	io_uring_queue_exit(&ch->uring);
+	bdev_uring_ring_fini(&ch->nvme_ring);
+	bdev_uring_ring_fini(&ch->iopoll_ring);
+	bdev_uring_ring_fini(&ch->ring);
 
 	spdk_poller_unregister(&ch->poller);
 }
@@ -743,13 +1646,15 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 	struct bdev_uring *uring;
 	uint32_t detected_block_size;
 	uint64_t bdev_size;
-	int rc;
+	struct stat st;
+	int i, rc;
 
 	uring = calloc(1, sizeof(*uring));
 	if (!uring) {
 		SPDK_ERRLOG("Unable to allocate enough memory for uring backend\n");
 		return NULL;
 	}
+	uring->file_index = -1;
 
 	uring->filename = strdup(filename);
 	if (!uring->filename) {
@@ -761,7 +1666,35 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 		goto error_return;
 	}
 
-	bdev_size = spdk_fd_get_size(uring->fd);
+	if (fstat(uring->fd, &st) != 0) {
+		SPDK_ERRLOG("fstat() failed (file:%s), errno %d: %s\n",
+			    filename, errno, spdk_strerror(errno));
+		goto error_return;
+	}
+
+	if (S_ISCHR(st.st_mode)) {
+		/* Generic char device of an NVMe namespace, e.g. /dev/ng0n1 */
+		uring->nvme_passthru = true;
+		if (bdev_uring_nvme_probe(uring, &bdev_size, &detected_block_size) != 0) {
+			goto error_return;
+		}
+	} else {
+		bdev_size = spdk_fd_get_size(uring->fd);
+		detected_block_size = spdk_fd_get_blocklen(uring->fd);
+		uring->discard_mode = spdk_fd_get_discard_mode(uring->fd);
+		uring->zeroes_mode = spdk_fd_get_zeroes_mode(uring->fd);
+	}
+	uring->iopoll = g_opts.iopoll && bdev_uring_supports_iopoll(uring);
+
+	if (g_opts.fixed_files) {
+		for (i = 0; i < SPDK_URING_MAX_FIXED_FILES; i++) {
+			if (!g_fixed_file_used[i]) {
+				g_fixed_file_used[i] = true;
+				uring->file_index = i;
+				break;
+			}
+		}
+	}
 
 	uring->bdev.name = strdup(name);
 	if (!uring->bdev.name) {
@@ -770,9 +1703,13 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 	uring->bdev.product_name = "URING bdev";
 	uring->bdev.module = &uring_if;
 
-	uring->bdev.write_cache = 0;
+	if (uring->nvme_passthru && block_size != 0 && block_size != detected_block_size) {
+		/* The commands address the blocks of the namespace */
+		SPDK_ERRLOG("Specified block size %" PRIu32 " does not match the block size %" PRIu32
+			    " of the namespace\n", block_size, detected_block_size);
+		goto error_return;
+	}
 
-	detected_block_size = spdk_fd_get_blocklen(uring->fd);
 	if (block_size == 0) {
 		/* User did not specify block size - use autodetected block size. */
 		if (detected_block_size == 0) {
@@ -806,9 +1743,11 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 	uring->bdev.blocklen = block_size;
 	uring->bdev.required_alignment = spdk_u32log2(block_size);
 
-	rc = bdev_uring_check_zoned_support(uring, name, filename);
-	if (rc) {
-		goto error_return;
+	if (!uring->nvme_passthru) {
+		rc = bdev_uring_check_zoned_support(uring, name, filename);
+		if (rc) {
+			goto error_return;
+		}
 	}
 
 	if (bdev_size % uring->bdev.blocklen != 0) {
@@ -880,12 +1819,24 @@ bdev_uring_init(void)
 	spdk_io_device_register(&uring_if, bdev_uring_group_create_cb, bdev_uring_group_destroy_cb,
 				sizeof(struct bdev_uring_group_channel), "uring_module");
 
+	g_fallocate_op = bdev_uring_fallocate_probe();
+	if (!g_fallocate_op) {
+		/* Keep the thread off the reactors' cores, unmaps and write zeroes are still
+		 * emulated by the bdev layer if it can't be started */
+		if (spdk_call_unaffinitized(bdev_uring_fallocate_thread_start, NULL) != NULL) {
+			g_fallocate_thread_running = true;
+		} else {
+			SPDK_WARNLOG("Unable to start the fallocate thread, unmap is not supported\n");
+		}
+	}
+
 	return 0;
 }
 
 static void
 bdev_uring_fini(void)
 {
+	bdev_uring_fallocate_thread_stop();
 	spdk_io_device_unregister(&uring_if, NULL);
 }
 
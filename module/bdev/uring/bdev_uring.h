@@ -13,10 +13,26 @@
 
 #include "spdk/bdev_module.h"
 
+struct spdk_bdev_uring_opts {
+	/* Register the files of the bdevs with the rings, to avoid looking them up for each I/O */
+	bool		fixed_files;
+	/* Register the iobuf pools with the rings, to avoid mapping the buffers for each I/O */
+	bool		fixed_buffers;
+	/* Submit the I/O from a kernel thread shared by all rings */
+	bool		sqpoll;
+	/* Time without I/O after which the submission thread goes to sleep */
+	uint32_t	sqpoll_idle_ms;
+	/* Busy poll for the completions of the bdevs supporting it */
+	bool		iopoll;
+};
+
 typedef void (*spdk_delete_uring_complete)(void *cb_arg, int bdeverrno);
 
 struct spdk_bdev *create_uring_bdev(const char *name, const char *filename, uint32_t block_size);
 
 void delete_uring_bdev(const char *name, spdk_delete_uring_complete cb_fn, void *cb_arg);
 
+void bdev_uring_get_opts(struct spdk_bdev_uring_opts *opts);
+int bdev_uring_set_opts(const struct spdk_bdev_uring_opts *opts);
+
 #endif /* SPDK_BDEV_URING_H */
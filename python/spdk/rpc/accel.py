@@ -94,7 +94,7 @@ def accel_set_driver(client, name):
 
 
 def accel_set_options(client, small_cache_size, large_cache_size,
-                      task_count, sequence_count, buf_count):
+                      task_count, sequence_count, buf_count, sw_worker_cpumask=None):
     """Set accel framework's options."""
     params = {}
 
@@ -108,6 +108,8 @@ def accel_set_options(client, small_cache_size, large_cache_size,
         params['sequence_count'] = sequence_count
     if buf_count is not None:
         params['buf_count'] = buf_count
+    if sw_worker_cpumask is not None:
+        params['sw_worker_cpumask'] = sw_worker_cpumask
 
     return client.call('accel_set_options', params)
 
@@ -493,6 +493,33 @@ def bdev_aio_delete(client, name):
     return client.call('bdev_aio_delete', params)
 
 
+def bdev_uring_set_options(client, fixed_files=None, fixed_buffers=None, sqpoll=None,
+                           sqpoll_idle_ms=None, iopoll=None):
+    """Set options for the bdev uring. Not allowed once uring bdevs are created.
+
+    Args:
+        fixed_files: register the files of the bdevs with the rings (optional)
+        fixed_buffers: register the iobuf pools with the rings (optional)
+        sqpoll: submit I/O from a kernel thread shared by all rings (optional)
+        sqpoll_idle_ms: time without I/O after which the submission thread sleeps (optional)
+        iopoll: busy poll for completions of the devices supporting it (optional)
+    """
+    params = {}
+
+    if fixed_files is not None:
+        params['fixed_files'] = fixed_files
+    if fixed_buffers is not None:
+        params['fixed_buffers'] = fixed_buffers
+    if sqpoll is not None:
+        params['sqpoll'] = sqpoll
+    if sqpoll_idle_ms is not None:
+        params['sqpoll_idle_ms'] = sqpoll_idle_ms
+    if iopoll is not None:
+        params['iopoll'] = iopoll
+
+    return client.call('bdev_uring_set_options', params)
+
+
 def bdev_uring_create(client, filename, name, block_size=None):
     """Create a bdev with Linux io_uring backend.
 
@@ -1588,12 +1615,15 @@ def bdev_ftl_get_stats(client, name):
     return client.call('bdev_ftl_get_stats', params)
 
 
-def bdev_get_bdevs(client, name=None, timeout=None):
+def bdev_get_bdevs(client, name=None, timeout=None, product_name=None, offset=None, limit=None):
     """Get information about block devices.
 
     Args:
         name: bdev name to query (optional; if omitted, query all bdevs)
         timeout: time in ms to wait for the bdev with specified name to appear
+        product_name: only list bdevs with this product name (optional)
+        offset: number of bdevs to skip from the beginning of the list (optional)
+        limit: maximum number of bdevs to list (optional; 0 means no limit)
 
     Returns:
         List of bdev information objects.
@@ -1603,6 +1633,12 @@ def bdev_get_bdevs(client, name=None, timeout=None):
         params['name'] = name
     if timeout:
         params['timeout'] = timeout
+    if product_name:
+        params['product_name'] = product_name
+    if offset is not None:
+        params['offset'] = offset
+    if limit is not None:
+        params['limit'] = limit
     return client.call('bdev_get_bdevs', params)
 
 
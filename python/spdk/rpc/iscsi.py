@@ -26,7 +26,9 @@ def iscsi_set_options(
         max_r2t_per_connection=None,
         pdu_pool_size=None,
         immediate_data_pool_size=None,
-        data_out_pool_size=None):
+        data_out_pool_size=None,
+        conn_placement=None,
+        conn_rebalance_interval=None):
     """Set iSCSI target options.
 
     Args:
@@ -52,6 +54,8 @@ def iscsi_set_options(
         pdu_pool_size: Number of PDUs in the pool (optional)
         immediate_data_pool_size: Number of immediate data buffers in the pool (optional)
         data_out_pool_size: Number of data out buffers in the pool (optional)
+        conn_placement: Connection placement policy, round_robin or load (optional)
+        conn_rebalance_interval: Interval in seconds between connection rebalancing, 0 to disable (optional)
 
     Returns:
         True or False
@@ -102,6 +106,10 @@ def iscsi_set_options(
         params['immediate_data_pool_size'] = immediate_data_pool_size
     if data_out_pool_size:
         params['data_out_pool_size'] = data_out_pool_size
+    if conn_placement:
+        params['conn_placement'] = conn_placement
+    if conn_rebalance_interval:
+        params['conn_rebalance_interval'] = conn_rebalance_interval
 
     return client.call('iscsi_set_options', params)
 
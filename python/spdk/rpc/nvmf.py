@@ -156,11 +156,13 @@ def nvmf_get_transports(client, trtype=None, tgt_name=None):
     return client.call('nvmf_get_transports', params)
 
 
-def nvmf_get_subsystems(client, nqn=None, tgt_name=None):
+def nvmf_get_subsystems(client, nqn=None, tgt_name=None, offset=None, limit=None):
     """Get list of NVMe-oF subsystems.
     Args:
         nqn: Subsystem NQN (optional; if omitted, query all subsystems).
         tgt_name: name of the parent NVMe-oF target (optional).
+        offset: number of subsystems to skip from the beginning of the list (optional)
+        limit: maximum number of subsystems to list (optional; 0 means no limit)
 
     Returns:
         List of NVMe-oF subsystem objects.
@@ -174,6 +176,12 @@ def nvmf_get_subsystems(client, nqn=None, tgt_name=None):
     if nqn:
         params['nqn'] = nqn
 
+    if offset is not None:
+        params['offset'] = offset
+
+    if limit is not None:
+        params['limit'] = limit
+
     return client.call('nvmf_get_subsystems', params)
 
 
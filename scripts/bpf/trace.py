@@ -302,7 +302,8 @@ class CTracepoint(ct.Structure):
 
 
 class CTraceFlags(ct.Structure):
-    _fields_ = [('tsc_rate', ct.c_uint64),
+    _fields_ = [('version', ct.c_uint64),
+                ('tsc_rate', ct.c_uint64),
                 ('tpoint_mask', ct.c_uint64 * TRACE_MAX_GROUP_ID),
                 ('owner', CTraceOwner * (UCHAR_MAX + 1)),
                 ('object', CTraceObject * (UCHAR_MAX + 1)),
@@ -499,6 +499,27 @@ if __name__ == "__main__":
     p.add_argument('name', help='aio bdev name')
     p.set_defaults(func=bdev_aio_delete)
 
+    def bdev_uring_set_options(args):
+        rpc.bdev.bdev_uring_set_options(args.client,
+                                        fixed_files=args.fixed_files,
+                                        fixed_buffers=args.fixed_buffers,
+                                        sqpoll=args.sqpoll,
+                                        sqpoll_idle_ms=args.sqpoll_idle_ms,
+                                        iopoll=args.iopoll)
+
+    p = subparsers.add_parser('bdev_uring_set_options', help='Set options for the bdev uring type')
+    p.add_argument('-f', '--fixed-files', help='Register the files of the bdevs with the rings',
+                   action='store_true', default=None)
+    p.add_argument('-b', '--fixed-buffers', help='Register the iobuf pools with the rings',
+                   action='store_true', default=None)
+    p.add_argument('-s', '--sqpoll', help='Submit I/O from a kernel thread shared by all rings',
+                   action='store_true', default=None)
+    p.add_argument('-i', '--sqpoll-idle-ms', help='Time without I/O after which the submission thread sleeps',
+                   type=int)
+    p.add_argument('-p', '--iopoll', help='Busy poll for completions of the devices supporting it',
+                   action='store_true', default=None)
+    p.set_defaults(func=bdev_uring_set_options)
+
     def bdev_uring_create(args):
         print_json(rpc.bdev.bdev_uring_create(args.client,
                                               filename=args.filename,
@@ -1171,7 +1192,9 @@ if __name__ == "__main__":
 
     def bdev_get_bdevs(args):
         print_dict(rpc.bdev.bdev_get_bdevs(args.client,
-                                           name=args.name, timeout=args.timeout_ms))
+                                           name=args.name, timeout=args.timeout_ms,
+                                           product_name=args.product_name,
+                                           offset=args.offset, limit=args.limit))
 
     p = subparsers.add_parser('bdev_get_bdevs',
                               help='Display current blockdev list or required blockdev')
@@ -1180,6 +1203,12 @@ if __name__ == "__main__":
     with the -b|--name option). The default timeout is 0, meaning the RPC returns immediately
     whether the bdev exists or not.""",
                    type=int, required=False)
+    p.add_argument('-p', '--product-name', help="Only list bdevs with this product name. Example: Malloc disk",
+                   required=False)
+    p.add_argument('-o', '--offset', help="Number of bdevs to skip from the beginning of the list",
+                   type=int, required=False)
+    p.add_argument('-l', '--limit', help="Maximum number of bdevs to list (0 means no limit)",
+                   type=int, required=False)
     p.set_defaults(func=bdev_get_bdevs)
 
     def bdev_get_iostat(args):
@@ -1334,7 +1363,9 @@ if __name__ == "__main__":
             max_r2t_per_connection=args.max_r2t_per_connection,
             pdu_pool_size=args.pdu_pool_size,
             immediate_data_pool_size=args.immediate_data_pool_size,
-            data_out_pool_size=args.data_out_pool_size)
+            data_out_pool_size=args.data_out_pool_size,
+            conn_placement=args.conn_placement,
+            conn_rebalance_interval=args.conn_rebalance_interval)
 
     p = subparsers.add_parser('iscsi_set_options',
                               help="""Set options of iSCSI subsystem""")
@@ -1363,6 +1394,10 @@ if __name__ == "__main__":
     p.add_argument('-u', '--pdu-pool-size', help='Number of PDUs in the pool', type=int)
     p.add_argument('-j', '--immediate-data-pool-size', help='Number of immediate data buffers in the pool', type=int)
     p.add_argument('-z', '--data-out-pool-size', help='Number of data out buffers in the pool', type=int)
+    p.add_argument('--conn-placement', help='Connection placement policy (default: round_robin)',
+                   choices=['round_robin', 'load'])
+    p.add_argument('--conn-rebalance-interval', help="""Interval in seconds between moving connections off
+    overloaded poll groups. Requires --conn-placement load. 0 disables rebalancing (default: 0)""", type=int)
     p.set_defaults(func=iscsi_set_options)
 
     def iscsi_set_discovery_auth(args):
@@ -2426,11 +2461,16 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.set_defaults(func=nvmf_get_transports)
 
     def nvmf_get_subsystems(args):
-        print_dict(rpc.nvmf.nvmf_get_subsystems(args.client, nqn=args.nqn, tgt_name=args.tgt_name))
+        print_dict(rpc.nvmf.nvmf_get_subsystems(args.client, nqn=args.nqn, tgt_name=args.tgt_name,
+                                                offset=args.offset, limit=args.limit))
 
     p = subparsers.add_parser('nvmf_get_subsystems', help='Display nvmf subsystems or required subsystem')
     p.add_argument('nqn', help='Subsystem NQN (optional)', nargs="?")
     p.add_argument('-t', '--tgt-name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.add_argument('-o', '--offset', help="Number of subsystems to skip from the beginning of the list",
+                   type=int, required=False)
+    p.add_argument('-l', '--limit', help="Maximum number of subsystems to list (0 means no limit)",
+                   type=int, required=False)
     p.set_defaults(func=nvmf_get_subsystems)
 
     def nvmf_create_subsystem(args):
@@ -2943,7 +2983,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
 
     def accel_set_options(args):
         rpc.accel.accel_set_options(args.client, args.small_cache_size, args.large_cache_size,
-                                    args.task_count, args.sequence_count, args.buf_count)
+                                    args.task_count, args.sequence_count, args.buf_count,
+                                    args.sw_worker_cpumask)
 
     p = subparsers.add_parser('accel_set_options', help='Set accel framework\'s options')
     p.add_argument('--small-cache-size', type=int, help='Size of the small iobuf cache')
@@ -2951,6 +2992,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--task-count', type=int, help='Maximum number of tasks per IO channel')
     p.add_argument('--sequence-count', type=int, help='Maximum number of sequences per IO channel')
     p.add_argument('--buf-count', type=int, help='Maximum number of buffers per IO channel')
+    p.add_argument('--sw-worker-cpumask', help='Mask of the cores running the software module\'s '
+                   'workers.  If not set, the software module executes operations synchronously')
     p.set_defaults(func=accel_set_options)
 
     def accel_get_stats(args):
@@ -20,6 +20,9 @@ run_test "accel_dualcast" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w dualcast -y
 run_test "accel_compare" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w compare -y
 run_test "accel_xor" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w xor -y
 run_test "accel_xor" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w xor -y -x 3
+run_test "accel_mixed" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w copy:2,crc32c:1,fill:1 -o 512:1,4096:2 -y
+run_test "accel_sequence" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -S fill,copy,crc32c -y
+run_test "accel_sequence_crypto" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -S encrypt,copy,decrypt,crc32c -y
 # do not run compress/decompress unless ISAL is installed
 if [[ $CONFIG_ISAL == y ]]; then
 	run_test "accel_comp" $SPDK_EXAMPLE_DIR/accel_perf -t 1 -w compress -l $testdir/bib
@@ -0,0 +1,265 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/json.h"
+#include "spdk/file.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+/*
+ * This application measures the throughput of spdk_json_parse() and of decoding objects with
+ *  spdk_json_decode_object().  It can be used to measure the effect of changes to the JSON
+ *  library on loading large configuration files.
+ *
+ * By default it parses a generated configuration with the given number of bdevs, formatted
+ *  like the output of save_config.  A file can be given instead.  Each "params" object found
+ *  in the input is decoded with a set of decoders similar to the ones used by RPC methods.
+ */
+
+#define NUM_DECODED_FIELDS 20
+
+struct json_perf_buf {
+	uint8_t	*buf;
+	size_t	size;
+	size_t	len;
+};
+
+struct json_perf_params {
+	char		*name;
+	uint64_t	values[NUM_DECODED_FIELDS];
+};
+
+static char g_field_names[NUM_DECODED_FIELDS][16];
+static struct spdk_json_object_decoder g_decoders[NUM_DECODED_FIELDS + 1];
+
+static void
+usage(const char *prog)
+{
+	printf("usage: %s [-f file.json] [-n num_bdevs] [-i iterations]\n", prog);
+	printf("Options:\n");
+	printf("-f\tparse the given file instead of a generated configuration\n");
+	printf("-n\tnumber of bdevs in the generated configuration (default: 10000)\n");
+	printf("-i\tnumber of times the input is parsed and decoded (default: 20)\n");
+}
+
+static int
+json_perf_write_cb(void *cb_ctx, const void *data, size_t size)
+{
+	struct json_perf_buf *b = cb_ctx;
+	uint8_t *buf;
+
+	if (b->len + size > b->size) {
+		b->size = spdk_max(b->size * 2, b->len + size);
+		buf = realloc(b->buf, b->size);
+		if (buf == NULL) {
+			return -1;
+		}
+		b->buf = buf;
+	}
+
+	memcpy(b->buf + b->len, data, size);
+	b->len += size;
+
+	return 0;
+}
+
+static void *
+generate_config(uint32_t num_bdevs, size_t *size)
+{
+	struct json_perf_buf b = {};
+	struct spdk_json_write_ctx *w;
+	char name[32];
+	uint32_t i, j;
+
+	w = spdk_json_write_begin(json_perf_write_cb, &b, SPDK_JSON_WRITE_FLAG_FORMATTED);
+	if (w == NULL) {
+		return NULL;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_array_begin(w, "subsystems");
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "subsystem", "bdev");
+	spdk_json_write_named_array_begin(w, "config");
+	for (i = 0; i < num_bdevs; i++) {
+		snprintf(name, sizeof(name), "Malloc%u", i);
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_malloc_create");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", name);
+		spdk_json_write_named_string(w, "uuid", "b8c6b1f4-1d4e-4a5e-9c3a-5f1b0a2d7e6c");
+		/* Keys in reverse order of the decoders, to stress the lookup */
+		for (j = NUM_DECODED_FIELDS; j > 0; j--) {
+			spdk_json_write_named_uint64(w, g_field_names[j - 1], (uint64_t)i * j);
+		}
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+
+	if (spdk_json_write_end(w) != 0) {
+		free(b.buf);
+		return NULL;
+	}
+
+	*size = b.len;
+	return b.buf;
+}
+
+static uint64_t
+get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * SPDK_SEC_TO_NSEC + ts.tv_nsec;
+}
+
+static uint32_t
+decode_params(struct spdk_json_val *values, size_t num_values)
+{
+	struct json_perf_params params;
+	uint32_t count = 0;
+	size_t i;
+
+	for (i = 0; i + 1 < num_values; i++) {
+		if (values[i].type != SPDK_JSON_VAL_NAME || !spdk_json_strequal(&values[i], "params") ||
+		    values[i + 1].type != SPDK_JSON_VAL_OBJECT_BEGIN) {
+			continue;
+		}
+
+		memset(&params, 0, sizeof(params));
+		if (spdk_json_decode_object_relaxed(&values[i + 1], g_decoders, SPDK_COUNTOF(g_decoders),
+						    &params) == 0) {
+			count++;
+		}
+		free(params.name);
+	}
+
+	return count;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *filename = NULL;
+	uint32_t num_bdevs = 10000, iterations = 20, i, decoded = 0;
+	struct spdk_json_val *values = NULL;
+	uint64_t parse_ns = 0, decode_ns = 0, start;
+	size_t size = 0, num_values;
+	void *json, *copy;
+	FILE *f;
+	ssize_t rc;
+	int ch;
+
+	while ((ch = getopt(argc, argv, "f:i:n:")) != -1) {
+		switch (ch) {
+		case 'f':
+			filename = optarg;
+			break;
+		case 'i':
+			iterations = spdk_strtol(optarg, 10);
+			break;
+		case 'n':
+			num_bdevs = spdk_strtol(optarg, 10);
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if ((int32_t)iterations <= 0 || (int32_t)num_bdevs < 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	g_decoders[0].name = "name";
+	g_decoders[0].offset = offsetof(struct json_perf_params, name);
+	g_decoders[0].decode_func = spdk_json_decode_string;
+	for (i = 0; i < NUM_DECODED_FIELDS; i++) {
+		snprintf(g_field_names[i], sizeof(g_field_names[i]), "field_%u", i);
+		g_decoders[i + 1].name = g_field_names[i];
+		g_decoders[i + 1].offset = offsetof(struct json_perf_params, values[i]);
+		g_decoders[i + 1].decode_func = spdk_json_decode_uint64;
+		g_decoders[i + 1].optional = true;
+	}
+
+	if (filename != NULL) {
+		f = fopen(filename, "r");
+		if (f == NULL) {
+			fprintf(stderr, "%s: %s\n", filename, spdk_strerror(errno));
+			return 1;
+		}
+		json = spdk_posix_file_load(f, &size);
+		fclose(f);
+	} else {
+		json = generate_config(num_bdevs, &size);
+	}
+	if (json == NULL) {
+		fprintf(stderr, "Unable to load the JSON input\n");
+		return 1;
+	}
+
+	/* Parsing decodes in place, so each iteration parses a fresh copy of the input */
+	copy = malloc(size);
+	if (copy == NULL) {
+		fprintf(stderr, "Unable to allocate %zu bytes\n", size);
+		free(json);
+		return 1;
+	}
+
+	rc = spdk_json_parse(json, size, NULL, 0, NULL, SPDK_JSON_PARSE_FLAG_ALLOW_COMMENTS);
+	if (rc <= 0) {
+		fprintf(stderr, "Invalid JSON input: %zd\n", rc);
+		rc = -EINVAL;
+		goto out;
+	}
+	num_values = rc;
+
+	values = calloc(num_values, sizeof(*values));
+	if (values == NULL) {
+		fprintf(stderr, "Unable to allocate %zu values\n", num_values);
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < iterations; i++) {
+		memcpy(copy, json, size);
+
+		/* Count the values first, like the users of spdk_json_parse() do */
+		start = get_time_ns();
+		spdk_json_parse(copy, size, NULL, 0, NULL, SPDK_JSON_PARSE_FLAG_ALLOW_COMMENTS);
+		rc = spdk_json_parse(copy, size, values, num_values, NULL,
+				     SPDK_JSON_PARSE_FLAG_ALLOW_COMMENTS | SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
+		parse_ns += get_time_ns() - start;
+		if (rc != (ssize_t)num_values) {
+			fprintf(stderr, "Unexpected number of values: %zd\n", rc);
+			goto out;
+		}
+
+		start = get_time_ns();
+		decoded = decode_params(values, num_values);
+		decode_ns += get_time_ns() - start;
+	}
+
+	printf("input size:  %zu bytes, %zu values\n", size, num_values);
+	printf("parse:       %.2f MB/s, %.3f ms per iteration\n",
+	       (double)size * iterations / 1024 / 1024 / ((double)parse_ns / SPDK_SEC_TO_NSEC),
+	       (double)parse_ns / iterations / 1000000);
+	printf("decode:      %u objects, %.3f ms per iteration\n", decoded,
+	       (double)decode_ns / iterations / 1000000);
+	rc = 0;
+out:
+	free(values);
+	free(copy);
+	free(json);
+	return rc == 0 ? 0 : 1;
+}
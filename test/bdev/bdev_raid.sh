@@ -177,7 +177,7 @@ function verify_raid_bdev_state() (
 
 function has_redundancy() {
 	case $1 in
-		"raid1" | "raid5f") return 0 ;;
+		"raid1" | "raid5f" | "raid6") return 0 ;;
 		*) return 1 ;;
 	esac
 }
@@ -331,4 +331,10 @@ if [ "$CONFIG_RAID5F" == y ]; then
 	done
 fi
 
+if [ "$CONFIG_RAID6" == y ]; then
+	for n in {4..5}; do
+		raid_state_function_test raid6 $n
+	done
+fi
+
 rm -f $tmp_file
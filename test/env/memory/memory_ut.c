@@ -13,6 +13,7 @@
 #include "spdk/bit_array.h"
 
 #define PAGE_ARRAY_SIZE (100)
+#define VALUE_1GB (1ULL << SHIFT_1GB)
 static struct spdk_bit_array *g_page_array;
 static void *g_vaddr_to_fail = (void *)UINT64_MAX;
 
@@ -465,6 +466,67 @@ test_mem_map_registration_adjacent(void)
 	CU_ASSERT(map == NULL);
 }
 
+static void
+test_mem_map_translation_runs(void)
+{
+	struct spdk_mem_map *map;
+	uint64_t default_translation = 0xDEADBEEF0BADF00D;
+	uint64_t vaddr = 1ULL << 40;
+	uint64_t addr, mapping_length;
+	int rc;
+
+	map = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+
+	/* A region spanning more than one second-level table, set in 2MB steps */
+	for (mapping_length = 0; mapping_length < 3 * VALUE_1GB; mapping_length += VALUE_2MB) {
+		rc = spdk_mem_map_set_translation(map, vaddr + mapping_length, VALUE_2MB, 0x1000);
+		CU_ASSERT(rc == 0);
+	}
+
+	mapping_length = 3 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 3 * VALUE_1GB);
+
+	mapping_length = 4 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr + VALUE_1GB + VALUE_4KB, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 2 * VALUE_1GB - VALUE_4KB);
+
+	/* Break the region in two, the preceding pages must stop at the gap */
+	rc = spdk_mem_map_clear_translation(map, vaddr + VALUE_1GB, VALUE_2MB);
+	CU_ASSERT(rc == 0);
+	mapping_length = 3 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr + VALUE_2MB, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == VALUE_1GB - VALUE_2MB);
+	mapping_length = 3 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr + VALUE_1GB + VALUE_2MB, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 2 * VALUE_1GB - VALUE_2MB);
+
+	/* Fill the gap with a translation that isn't contiguous with its neighbours */
+	rc = spdk_mem_map_set_translation(map, vaddr + VALUE_1GB, VALUE_2MB, 0x2000);
+	CU_ASSERT(rc == 0);
+	mapping_length = 3 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr + VALUE_1GB, &mapping_length);
+	CU_ASSERT(addr == 0x2000);
+	CU_ASSERT(mapping_length == VALUE_2MB);
+
+	/* And then with a contiguous one */
+	rc = spdk_mem_map_set_translation(map, vaddr + VALUE_1GB, VALUE_2MB, 0x1000);
+	CU_ASSERT(rc == 0);
+	mapping_length = 3 * VALUE_1GB;
+	addr = spdk_mem_map_translate(map, vaddr, &mapping_length);
+	CU_ASSERT(addr == 0x1000);
+	CU_ASSERT(mapping_length == 3 * VALUE_1GB);
+
+	rc = spdk_mem_map_clear_translation(map, vaddr, 3 * VALUE_1GB);
+	CU_ASSERT(rc == 0);
+	spdk_mem_map_free(&map);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -497,7 +559,8 @@ main(int argc, char **argv)
 		CU_add_test(suite, "alloc and free memory map", test_mem_map_alloc_free) == NULL ||
 		CU_add_test(suite, "mem map translation", test_mem_map_translation) == NULL ||
 		CU_add_test(suite, "mem map registration", test_mem_map_registration) == NULL ||
-		CU_add_test(suite, "mem map adjacent registrations", test_mem_map_registration_adjacent) == NULL
+		CU_add_test(suite, "mem map adjacent registrations", test_mem_map_registration_adjacent) == NULL ||
+		CU_add_test(suite, "mem map translation runs", test_mem_map_translation_runs) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
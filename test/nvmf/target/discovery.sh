@@ -35,6 +35,13 @@ nvme discover -t $TEST_TRANSPORT -a $NVMF_FIRST_TARGET_IP -s $NVMF_PORT
 echo "Perform nvmf subsystem discovery via RPC"
 $rpc_py nvmf_get_subsystems
 
+# Page through the discovery subsystem and the 4 NVMe subsystems
+[[ $($rpc_py nvmf_get_subsystems | jq length) -eq 5 ]]
+[[ $($rpc_py nvmf_get_subsystems -o 1 -l 2 | jq length) -eq 2 ]]
+[[ $($rpc_py nvmf_get_subsystems -o 4 | jq length) -eq 1 ]]
+[[ $($rpc_py nvmf_get_subsystems -o 5 | jq length) -eq 0 ]]
+NOT $rpc_py nvmf_get_subsystems nqn.2016-06.io.spdk:cnode1 -l 1
+
 for i in $(seq 1 4); do
 	$rpc_py nvmf_delete_subsystem nqn.2016-06.io.spdk:cnode$i
 	$rpc_py bdev_null_delete Null$i
@@ -26,6 +26,40 @@ function rpc_integrity() {
 	[ "$(jq length <<< "$bdevs")" == "0" ]
 }
 
+# bdev_get_bdevs describes the bdevs in batches of 64, page through a list spanning several of them
+function rpc_bdev_get_bdevs_paging() {
+	local bdevs malloc
+
+	rpc_cmd < <(printf 'bdev_null_create Null%d 1 512\n' {0..149})
+	malloc=$($rpc bdev_malloc_create 8 512)
+	bdevs=$($rpc bdev_get_bdevs)
+	[ "$(jq length <<< "$bdevs")" == "151" ]
+
+	bdevs=$($rpc bdev_get_bdevs -p "Null disk")
+	[ "$(jq length <<< "$bdevs")" == "150" ]
+	bdevs=$($rpc bdev_get_bdevs -p "Malloc disk")
+	[ "$(jq -r '.[].name' <<< "$bdevs")" == "$malloc" ]
+
+	bdevs=$($rpc bdev_get_bdevs -p "Null disk" -o 70 -l 65)
+	[ "$(jq length <<< "$bdevs")" == "65" ]
+	[ "$(jq -r '.[0].name' <<< "$bdevs")" == "Null70" ]
+	[ "$(jq -r '.[-1].name' <<< "$bdevs")" == "Null134" ]
+
+	bdevs=$($rpc bdev_get_bdevs -o 140)
+	[ "$(jq length <<< "$bdevs")" == "11" ]
+	bdevs=$($rpc bdev_get_bdevs -o 151)
+	[ "$(jq length <<< "$bdevs")" == "0" ]
+
+	# Filtering and paging don't apply to a single bdev
+	NOT $rpc bdev_get_bdevs -b Null0 -l 1
+	NOT $rpc bdev_get_bdevs -b Null0 -p "Null disk"
+
+	$rpc bdev_malloc_delete $malloc
+	rpc_cmd < <(printf 'bdev_null_delete Null%d\n' {0..149})
+	bdevs=$($rpc bdev_get_bdevs)
+	[ "$(jq length <<< "$bdevs")" == "0" ]
+}
+
 function rpc_plugins() {
 	malloc=$($rpc --plugin rpc_plugin create_malloc)
 	bdevs=$($rpc bdev_get_bdevs)
@@ -57,6 +91,7 @@ export PYTHONPATH=$PYTHONPATH:$testdir
 # basic integrity test
 rpc=rpc_cmd
 run_test "rpc_integrity" rpc_integrity
+run_test "rpc_bdev_get_bdevs_paging" rpc_bdev_get_bdevs_paging
 run_test "rpc_plugins" rpc_plugins
 run_test "rpc_trace_cmd_test" rpc_trace_cmd_test
 # same integrity test, but with rpc_cmd() instead
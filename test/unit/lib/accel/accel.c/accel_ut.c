@@ -537,6 +537,313 @@ test_spdk_accel_submit_xor(void)
 	CU_ASSERT(expected_accel_task == &task);
 }
 
+static void
+test_spdk_accel_submit_pq_gen(void)
+{
+	const uint64_t nbytes = TEST_SUBMIT_SIZE;
+	uint8_t p[TEST_SUBMIT_SIZE] = {0};
+	uint8_t q[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src1[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src2[TEST_SUBMIT_SIZE] = {0};
+	void *sources[] = { src1, src2 };
+	uint32_t nsrcs = SPDK_COUNTOF(sources);
+	int rc;
+	struct spdk_accel_task task;
+	struct spdk_accel_task *expected_accel_task = NULL;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_pq_gen(g_ch, p, q, sources, nsrcs, nbytes, NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+
+	/* submission OK. */
+	rc = spdk_accel_submit_pq_gen(g_ch, p, q, sources, nsrcs, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.nsrcs.srcs == sources);
+	CU_ASSERT(task.nsrcs.cnt == nsrcs);
+	CU_ASSERT(task.d.iovcnt == 1);
+	CU_ASSERT(task.d.iovs[0].iov_base == p);
+	CU_ASSERT(task.d.iovs[0].iov_len == nbytes);
+	CU_ASSERT(task.d2.iovcnt == 1);
+	CU_ASSERT(task.d2.iovs[0].iov_base == q);
+	CU_ASSERT(task.d2.iovs[0].iov_len == nbytes);
+	CU_ASSERT(task.op_code == SPDK_ACCEL_OPC_PQ_GEN);
+	expected_accel_task = TAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, expected_accel_task, link);
+	CU_ASSERT(expected_accel_task == &task);
+}
+
+static void
+test_spdk_accel_submit_dif(void)
+{
+	uint8_t src[520 * 2] = {0};
+	uint8_t dst[512 * 2] = {0};
+	struct iovec src_iov = { .iov_base = src, .iov_len = sizeof(src) };
+	struct iovec dst_iov = { .iov_base = dst, .iov_len = sizeof(dst) };
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	struct spdk_dif_ctx ctx;
+	struct spdk_dif_error err;
+	struct spdk_accel_task task;
+	struct spdk_accel_task *expected_accel_task = NULL;
+	int rc;
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = SPDK_DIF_PI_FORMAT_16;
+	rc = spdk_dif_ctx_init(&ctx, 520, 8, true, false, SPDK_DIF_TYPE1, SPDK_DIF_FLAGS_GUARD_CHECK,
+			       0, 0, 0, 0, 0, &dif_opts);
+	CU_ASSERT(rc == 0);
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_dif_verify(g_ch, &src_iov, 1, 1, &ctx, &err, NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+
+	/* submission OK. */
+	rc = spdk_accel_submit_dif_verify(g_ch, &src_iov, 1, 2, &ctx, &err, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.s.iovs == &src_iov);
+	CU_ASSERT(task.s.iovcnt == 1);
+	CU_ASSERT(task.nbytes == sizeof(src));
+	CU_ASSERT(task.num_blocks == 2);
+	CU_ASSERT(task.dif.ctx == &ctx);
+	CU_ASSERT(task.dif.err == &err);
+	CU_ASSERT(task.op_code == SPDK_ACCEL_OPC_DIF_VERIFY);
+	expected_accel_task = TAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, expected_accel_task, link);
+	CU_ASSERT(expected_accel_task == &task);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	rc = spdk_accel_submit_dif_verify_copy(g_ch, &dst_iov, 1, &src_iov, 1, 2, &ctx, &err,
+					       NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.d.iovs == &dst_iov);
+	CU_ASSERT(task.d.iovcnt == 1);
+	CU_ASSERT(task.s.iovs == &src_iov);
+	CU_ASSERT(task.s.iovcnt == 1);
+	CU_ASSERT(task.num_blocks == 2);
+	CU_ASSERT(task.dif.ctx == &ctx);
+	CU_ASSERT(task.dif.err == &err);
+	CU_ASSERT(task.op_code == SPDK_ACCEL_OPC_DIF_VERIFY_COPY);
+	expected_accel_task = TAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, expected_accel_task, link);
+	CU_ASSERT(expected_accel_task == &task);
+}
+
+static void
+ut_sw_worker_cb(void *cb_arg, int status)
+{
+	int *completed = cb_arg;
+
+	CU_ASSERT_EQUAL(status, 0);
+	(*completed)++;
+}
+
+static void
+test_sw_accel_workers(void)
+{
+	struct spdk_io_channel *ch;
+	struct sw_accel_io_channel *sw_ch;
+	struct sw_accel_worker worker = {};
+	struct sw_accel_task tasks[2] = {};
+	struct accel_channel_pools pools = { .ch = g_accel_ch, .refcnt = 1 };
+	TAILQ_HEAD(, spdk_accel_task) submit = TAILQ_HEAD_INITIALIZER(submit);
+	char src[2][64], dst[2][64];
+	struct iovec src_iovs[2], dst_iovs[2];
+	int i, rc, completed = 0;
+
+	allocate_threads(1);
+	set_thread(0);
+
+	ch = calloc(1, sizeof(*ch) + sizeof(*sw_ch));
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	sw_ch = spdk_io_channel_get_ctx(ch);
+	rc = sw_accel_exec_ctx_init(sw_ch);
+	CU_ASSERT_EQUAL(rc, 0);
+	sw_ch->completion_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SW_ACCEL_RING_SIZE, 0);
+	SPDK_CU_ASSERT_FATAL(sw_ch->completion_ring != NULL);
+
+	rc = sw_accel_exec_ctx_init(&worker.ch);
+	CU_ASSERT_EQUAL(rc, 0);
+	worker.ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SW_ACCEL_RING_SIZE, 0);
+	SPDK_CU_ASSERT_FATAL(worker.ring != NULL);
+	g_sw_workers = &worker;
+	g_sw_num_workers = 1;
+	g_accel_ch->pools = &pools;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	for (i = 0; i < 2; i++) {
+		memset(src[i], 'a' + i, sizeof(src[i]));
+		memset(dst[i], 0, sizeof(dst[i]));
+		src_iovs[i].iov_base = src[i];
+		src_iovs[i].iov_len = sizeof(src[i]);
+		dst_iovs[i].iov_base = dst[i];
+		dst_iovs[i].iov_len = sizeof(dst[i]);
+		tasks[i].task.op_code = SPDK_ACCEL_OPC_COPY;
+		tasks[i].task.s.iovs = &src_iovs[i];
+		tasks[i].task.s.iovcnt = 1;
+		tasks[i].task.d.iovs = &dst_iovs[i];
+		tasks[i].task.d.iovcnt = 1;
+		tasks[i].task.nbytes = sizeof(src[i]);
+		tasks[i].task.accel_ch = g_accel_ch;
+		tasks[i].task.cb_fn = ut_sw_worker_cb;
+		tasks[i].task.cb_arg = &completed;
+		TAILQ_INSERT_TAIL(&submit, &tasks[i].task, link);
+	}
+
+	/* The tasks are only executed once the worker polls its ring */
+	rc = sw_accel_submit_tasks(ch, TAILQ_FIRST(&submit));
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT(TAILQ_EMPTY(&sw_ch->tasks_to_complete));
+	CU_ASSERT_EQUAL(sw_ch->num_worker_tasks, 2);
+	CU_ASSERT_EQUAL(pools.refcnt, 2);
+	CU_ASSERT_EQUAL(accel_comp_poll(sw_ch), SPDK_POLLER_IDLE);
+	CU_ASSERT_NOT_EQUAL(memcmp(dst[0], src[0], sizeof(src[0])), 0);
+
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(memcmp(dst[0], src[0], sizeof(src[0])), 0);
+	CU_ASSERT_EQUAL(memcmp(dst[1], src[1], sizeof(src[1])), 0);
+	CU_ASSERT_EQUAL(completed, 0);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_IDLE);
+
+	/* Completions are executed by the submitting channel */
+	CU_ASSERT_EQUAL(accel_comp_poll(sw_ch), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT_EQUAL(sw_ch->num_worker_tasks, 0);
+	CU_ASSERT_EQUAL(pools.refcnt, 1);
+	CU_ASSERT_EQUAL(accel_comp_poll(sw_ch), SPDK_POLLER_IDLE);
+
+	/* A full completion ring delays the completion until there's space */
+	completed = 0;
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	TAILQ_NEXT(&tasks[0].task, link) = NULL;
+	rc = sw_accel_submit_tasks(ch, &tasks[0].task);
+	CU_ASSERT_EQUAL(rc, 0);
+	MOCK_SET(spdk_ring_enqueue, 0);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&worker.ch.tasks_to_complete), &tasks[0].task);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_IDLE);
+	MOCK_CLEAR(spdk_ring_enqueue);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_BUSY);
+	CU_ASSERT(TAILQ_EMPTY(&worker.ch.tasks_to_complete));
+	CU_ASSERT_EQUAL(accel_comp_poll(sw_ch), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(completed, 1);
+
+	/* A full worker ring makes the task execute synchronously */
+	completed = 0;
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	memset(dst[0], 0, sizeof(dst[0]));
+	MOCK_SET(spdk_ring_enqueue, 0);
+	rc = sw_accel_submit_tasks(ch, &tasks[0].task);
+	MOCK_CLEAR(spdk_ring_enqueue);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(memcmp(dst[0], src[0], sizeof(src[0])), 0);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&sw_ch->tasks_to_complete), &tasks[0].task);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_IDLE);
+	CU_ASSERT_EQUAL(accel_comp_poll(sw_ch), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(completed, 1);
+	CU_ASSERT_EQUAL(sw_ch->num_worker_tasks, 0);
+
+	/* The completion ring of a channel destroyed with outstanding tasks is kept until the
+	 * workers send them all back */
+	completed = 0;
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	TAILQ_INIT(&submit);
+	TAILQ_INSERT_TAIL(&submit, &tasks[0].task, link);
+	TAILQ_INSERT_TAIL(&submit, &tasks[1].task, link);
+	rc = sw_accel_submit_tasks(ch, TAILQ_FIRST(&submit));
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT_EQUAL(sw_ch->num_worker_tasks, 2);
+	sw_accel_destroy_cb(NULL, sw_ch);
+	memset(ch, 0xff, sizeof(*ch) + sizeof(*sw_ch));
+	free(ch);
+	poll_threads();
+	CU_ASSERT_EQUAL(pools.refcnt, 2);
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_BUSY);
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 0);
+	CU_ASSERT_EQUAL(pools.refcnt, 1);
+
+	g_accel_ch->pools = NULL;
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+	spdk_ring_free(worker.ring);
+	sw_accel_exec_ctx_fini(&worker.ch);
+	free_threads();
+}
+
+static void
+test_sw_accel_workers_channel_destroy(void)
+{
+	struct spdk_io_channel *ioch;
+	struct accel_io_channel *accel_ch;
+	struct sw_accel_io_channel *sw_ch;
+	struct sw_accel_worker worker = {};
+	char src[2][64], dst[2][64];
+	int i, rc, completed = 0;
+
+	rc = sw_accel_exec_ctx_init(&worker.ch);
+	CU_ASSERT_EQUAL(rc, 0);
+	worker.ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, SW_ACCEL_RING_SIZE, 0);
+	SPDK_CU_ASSERT_FATAL(worker.ring != NULL);
+	g_sw_workers = &worker;
+	g_sw_num_workers = 1;
+
+	ioch = spdk_accel_get_io_channel();
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+	accel_ch = spdk_io_channel_get_ctx(ioch);
+	sw_ch = spdk_io_channel_get_ctx(accel_ch->module_ch[SPDK_ACCEL_OPC_COPY]);
+	SPDK_CU_ASSERT_FATAL(sw_ch->completion_ring != NULL);
+
+	for (i = 0; i < 2; i++) {
+		memset(src[i], 'a' + i, sizeof(src[i]));
+		memset(dst[i], 0, sizeof(dst[i]));
+		rc = spdk_accel_submit_copy(ioch, dst[i], src[i], sizeof(src[i]), 0,
+					    ut_sw_worker_cb, &completed);
+		CU_ASSERT_EQUAL(rc, 0);
+	}
+	CU_ASSERT_EQUAL(sw_ch->num_worker_tasks, 2);
+
+	/* Destroy the channel while the tasks are still queued to the worker.  The tasks, which
+	 * are allocated from the accel channel's pools, need to stay valid until the worker sends
+	 * them back. */
+	spdk_put_io_channel(ioch);
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 0);
+
+	CU_ASSERT_EQUAL(sw_accel_worker_poll(&worker), SPDK_POLLER_BUSY);
+	CU_ASSERT_EQUAL(memcmp(dst[0], src[0], sizeof(src[0])), 0);
+	CU_ASSERT_EQUAL(memcmp(dst[1], src[1], sizeof(src[1])), 0);
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 0);
+
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+	spdk_ring_free(worker.ring);
+	sw_accel_exec_ctx_fini(&worker.ch);
+}
+
+static void
+test_sw_accel_workers_cpumask(void)
+{
+	int rc;
+
+	/* The workers can only run on the application's cores */
+	rc = sw_accel_workers_create("0x2");
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+	CU_ASSERT_EQUAL(g_sw_num_workers, 0);
+	CU_ASSERT_PTR_NULL(g_sw_workers);
+
+	rc = sw_accel_workers_create("0x0");
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+	CU_ASSERT_EQUAL(g_sw_num_workers, 0);
+}
+
 static void
 test_spdk_accel_module_find_by_name(void)
 {
@@ -4062,6 +4369,483 @@ test_sequence_crc32(void)
 	poll_threads();
 }
 
+static int
+ut_submit_compress(struct spdk_io_channel *ch, struct spdk_accel_task *task)
+{
+	/* "Compress" the data by copying the first half of it */
+	*task->output_size = spdk_iovcpy(task->s.iovs, task->s.iovcnt, task->d.iovs,
+					 task->d.iovcnt) / 2;
+
+	spdk_accel_task_complete(task, 0);
+
+	return 0;
+}
+
+static void
+test_sequence_compress_xor(void)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	struct spdk_io_channel *ioch;
+	struct ut_sequence ut_seq;
+	struct accel_module modules[SPDK_ACCEL_OPC_LAST];
+	char buf[4096], tmp[2][4096], out[4096], srcbuf[3][4096];
+	void *sources[3] = { srcbuf[0], srcbuf[1], srcbuf[2] };
+	struct iovec src_iovs[3], dst_iovs[3];
+	uint32_t output_size, crc;
+	int i, rc, completed;
+
+	ioch = spdk_accel_get_io_channel();
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+
+	/* Override the submit_tasks function */
+	g_module_if.submit_tasks = ut_sequnce_submit_tasks;
+	for (i = 0; i < SPDK_ACCEL_OPC_LAST; ++i) {
+		g_seq_operations[i].submit = sw_accel_submit_tasks;
+		modules[i] = g_modules_opc[i];
+		g_modules_opc[i] = g_module;
+	}
+	g_seq_operations[SPDK_ACCEL_OPC_COMPRESS].submit = ut_submit_compress;
+
+	/* Check that copies surrounding a compress are removed */
+	seq = NULL;
+	completed = 0;
+	output_size = 0;
+	memset(buf, 0xa5, sizeof(buf));
+	memset(out, 0, sizeof(out));
+
+	dst_iovs[0].iov_base = tmp[0];
+	dst_iovs[0].iov_len = sizeof(tmp[0]);
+	src_iovs[0].iov_base = buf;
+	src_iovs[0].iov_len = sizeof(buf);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+				    &src_iovs[0], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[1].iov_base = tmp[1];
+	dst_iovs[1].iov_len = sizeof(tmp[1]);
+	src_iovs[1].iov_base = tmp[0];
+	src_iovs[1].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_compress(&seq, ioch, &dst_iovs[1], 1, NULL, NULL,
+					&src_iovs[1], 1, NULL, NULL, &output_size, 0,
+					ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[2].iov_base = out;
+	dst_iovs[2].iov_len = sizeof(out);
+	src_iovs[2].iov_base = tmp[1];
+	src_iovs[2].iov_len = sizeof(tmp[1]);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[2], 1, NULL, NULL,
+				    &src_iovs[2], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 3);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COMPRESS].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	CU_ASSERT_EQUAL(output_size, sizeof(buf) / 2);
+	CU_ASSERT_EQUAL(memcmp(out, buf, sizeof(buf)), 0);
+	g_seq_operations[SPDK_ACCEL_OPC_COMPRESS].count = 0;
+
+	for (i = 0; i < 3; i++) {
+		memset(srcbuf[i], 1 << i, sizeof(srcbuf[i]));
+	}
+	memset(buf, 0x7, sizeof(buf));
+
+	/* Check that the copy following xor is removed, while crc32c is calculated on the final
+	 * destination buffer */
+	seq = NULL;
+	completed = 0;
+	memset(out, 0, sizeof(out));
+
+	dst_iovs[0].iov_base = tmp[0];
+	dst_iovs[0].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_xor(&seq, ioch, &dst_iovs[0], 1, NULL, NULL, sources, 3,
+				   ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[1].iov_base = tmp[0];
+	src_iovs[1].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_crc32c(&seq, ioch, &crc, &src_iovs[1], 1, NULL, NULL, 0,
+				      ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[2].iov_base = out;
+	dst_iovs[2].iov_len = sizeof(out);
+	src_iovs[2].iov_base = tmp[0];
+	src_iovs[2].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[2], 1, NULL, NULL,
+				    &src_iovs[2], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 3);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_XOR].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	CU_ASSERT_EQUAL(memcmp(out, buf, sizeof(buf)), 0);
+	CU_ASSERT_EQUAL(crc, spdk_crc32c_update(buf, sizeof(buf), ~0u));
+	g_seq_operations[SPDK_ACCEL_OPC_XOR].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_CRC32C].count = 0;
+
+	/* Check that the copy isn't removed if its destination isn't a single buffer */
+	seq = NULL;
+	completed = 0;
+	memset(out, 0, sizeof(out));
+
+	dst_iovs[0].iov_base = tmp[0];
+	dst_iovs[0].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_xor(&seq, ioch, &dst_iovs[0], 1, NULL, NULL, sources, 3,
+				   ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[1].iov_base = out;
+	dst_iovs[1].iov_len = 1024;
+	dst_iovs[2].iov_base = &out[1024];
+	dst_iovs[2].iov_len = 3072;
+	src_iovs[0].iov_base = tmp[0];
+	src_iovs[0].iov_len = sizeof(tmp[0]);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[1], 2, NULL, NULL,
+				    &src_iovs[0], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_XOR].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 1);
+	CU_ASSERT_EQUAL(memcmp(out, buf, sizeof(buf)), 0);
+	g_seq_operations[SPDK_ACCEL_OPC_XOR].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_COPY].count = 0;
+
+	/* xor requires a single destination buffer and at least two sources */
+	seq = NULL;
+	rc = spdk_accel_append_xor(&seq, ioch, &dst_iovs[1], 2, NULL, NULL, sources, 3,
+				   ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+	rc = spdk_accel_append_xor(&seq, ioch, &dst_iovs[0], 1, NULL, NULL, sources, 1,
+				   ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+	CU_ASSERT_PTR_NULL(seq);
+
+	/* Clean up */
+	for (i = 0; i < SPDK_ACCEL_OPC_LAST; ++i) {
+		g_modules_opc[i] = modules[i];
+	}
+
+	ut_clear_operations();
+	spdk_put_io_channel(ioch);
+	poll_threads();
+}
+
+#define UT_DIF_BLOCK_SIZE	520
+#define UT_DIF_DATA_SIZE	512
+#define UT_DIF_NUM_BLOCKS	4
+
+static void
+test_sequence_dif(void)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	struct spdk_io_channel *ioch;
+	struct ut_sequence ut_seq;
+	struct ut_domain_ctx domctx;
+	struct accel_module modules[SPDK_ACCEL_OPC_LAST];
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+	struct spdk_dif_ctx ctx;
+	struct spdk_dif_error err;
+	char data[UT_DIF_DATA_SIZE * UT_DIF_NUM_BLOCKS], out[UT_DIF_DATA_SIZE * UT_DIF_NUM_BLOCKS];
+	char ext[UT_DIF_BLOCK_SIZE * UT_DIF_NUM_BLOCKS], tmp[UT_DIF_BLOCK_SIZE * UT_DIF_NUM_BLOCKS];
+	char gen[UT_DIF_BLOCK_SIZE * UT_DIF_NUM_BLOCKS];
+	struct iovec src_iovs[2], dst_iovs[2];
+	int i, rc, completed;
+
+	ioch = spdk_accel_get_io_channel();
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+
+	/* Override the submit_tasks function */
+	g_module_if.submit_tasks = ut_sequnce_submit_tasks;
+	for (i = 0; i < SPDK_ACCEL_OPC_LAST; ++i) {
+		g_seq_operations[i].submit = sw_accel_submit_tasks;
+		modules[i] = g_modules_opc[i];
+		g_modules_opc[i] = g_module;
+	}
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = SPDK_DIF_PI_FORMAT_16;
+	rc = spdk_dif_ctx_init(&ctx, UT_DIF_BLOCK_SIZE, 8, true, false, SPDK_DIF_TYPE1,
+			       SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+			       SPDK_DIF_FLAGS_REFTAG_CHECK, 10, 0xFFFF, 0x1234, 0, 0, &dif_opts);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	for (i = 0; i < (int)sizeof(data); i++) {
+		data[i] = i * 7;
+	}
+
+	/* Generate DIF while copying to a buffer, then copy it to the final destination.  The
+	 * copy should be removed and the DIF inserted directly into the destination.
+	 */
+	seq = NULL;
+	completed = 0;
+	memset(ext, 0, sizeof(ext));
+	memset(tmp, 0, sizeof(tmp));
+
+	src_iovs[0].iov_base = data;
+	src_iovs[0].iov_len = sizeof(data);
+	dst_iovs[0].iov_base = tmp;
+	dst_iovs[0].iov_len = sizeof(tmp);
+	rc = spdk_accel_append_dif_generate_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+						 &src_iovs[0], 1, NULL, NULL, UT_DIF_NUM_BLOCKS,
+						 &ctx, ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[1].iov_base = tmp;
+	src_iovs[1].iov_len = sizeof(tmp);
+	dst_iovs[1].iov_base = ext;
+	dst_iovs[1].iov_len = sizeof(ext);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[1], 1, NULL, NULL,
+				    &src_iovs[1], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE_COPY].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	dst_iovs[1].iov_base = ext;
+	dst_iovs[1].iov_len = sizeof(ext);
+	CU_ASSERT_EQUAL(spdk_dif_verify(&dst_iovs[1], 1, UT_DIF_NUM_BLOCKS, &ctx, &err), 0);
+	for (i = 0; i < UT_DIF_NUM_BLOCKS; i++) {
+		CU_ASSERT_EQUAL(memcmp(&ext[i * UT_DIF_BLOCK_SIZE], &data[i * UT_DIF_DATA_SIZE],
+				       UT_DIF_DATA_SIZE), 0);
+	}
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE_COPY].count = 0;
+
+	/* Copy and verify the copied buffer.  The copy should be removed and the DIF verified in
+	 * the source buffer.
+	 */
+	seq = NULL;
+	completed = 0;
+
+	src_iovs[0].iov_base = ext;
+	src_iovs[0].iov_len = sizeof(ext);
+	dst_iovs[0].iov_base = tmp;
+	dst_iovs[0].iov_len = sizeof(tmp);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+				    &src_iovs[0], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[1].iov_base = tmp;
+	src_iovs[1].iov_len = sizeof(tmp);
+	rc = spdk_accel_append_dif_verify(&seq, ioch, &src_iovs[1], 1, NULL, NULL,
+					  UT_DIF_NUM_BLOCKS, &ctx, &err,
+					  ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_DIF_VERIFY].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_VERIFY].count = 0;
+
+	/* Verify and strip the metadata of a corrupted buffer */
+	seq = NULL;
+	completed = 0;
+	ext[UT_DIF_BLOCK_SIZE * 2 + 5] ^= 0x1;
+	memset(&err, 0, sizeof(err));
+
+	src_iovs[0].iov_base = ext;
+	src_iovs[0].iov_len = sizeof(ext);
+	dst_iovs[0].iov_base = out;
+	dst_iovs[0].iov_len = sizeof(out);
+	rc = spdk_accel_append_dif_verify_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+					       &src_iovs[0], 1, NULL, NULL, UT_DIF_NUM_BLOCKS,
+					       &ctx, &err, ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, -EIO);
+	CU_ASSERT_EQUAL(err.err_type, SPDK_DIF_GUARD_ERROR);
+	CU_ASSERT_EQUAL(err.err_offset, 2);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_DIF_VERIFY_COPY].count, 1);
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_VERIFY_COPY].count = 0;
+
+	/* Regenerate the DIF in place and strip it again */
+	seq = NULL;
+	completed = 0;
+
+	src_iovs[0].iov_base = ext;
+	src_iovs[0].iov_len = sizeof(ext);
+	rc = spdk_accel_append_dif_generate(&seq, ioch, &src_iovs[0], 1, NULL, NULL,
+					    UT_DIF_NUM_BLOCKS, &ctx, ut_sequence_step_cb,
+					    &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[1].iov_base = ext;
+	src_iovs[1].iov_len = sizeof(ext);
+	dst_iovs[1].iov_base = out;
+	dst_iovs[1].iov_len = sizeof(out);
+	rc = spdk_accel_append_dif_verify_copy(&seq, ioch, &dst_iovs[1], 1, NULL, NULL,
+					       &src_iovs[1], 1, NULL, NULL, UT_DIF_NUM_BLOCKS,
+					       &ctx, &err, ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 2);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	data[UT_DIF_DATA_SIZE * 2 + 5] ^= 0x1;
+	CU_ASSERT_EQUAL(memcmp(out, data, sizeof(out)), 0);
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_VERIFY_COPY].count = 0;
+
+	/* Fill a buffer, generate the DIF in place and copy it to the final destination.  The copy
+	 * should be removed and the buffer filled and the DIF generated directly in the destination.
+	 */
+	seq = NULL;
+	completed = 0;
+	memset(gen, 0, sizeof(gen));
+
+	rc = spdk_accel_append_fill(&seq, ioch, tmp, sizeof(tmp), NULL, NULL, 0xa5, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[0].iov_base = tmp;
+	src_iovs[0].iov_len = sizeof(tmp);
+	rc = spdk_accel_append_dif_generate(&seq, ioch, &src_iovs[0], 1, NULL, NULL,
+					    UT_DIF_NUM_BLOCKS, &ctx, ut_sequence_step_cb,
+					    &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[0].iov_base = gen;
+	dst_iovs[0].iov_len = sizeof(gen);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[0], 1, NULL, NULL,
+				    &src_iovs[0], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 3);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_FILL].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 0);
+	dst_iovs[0].iov_base = gen;
+	dst_iovs[0].iov_len = sizeof(gen);
+	CU_ASSERT_EQUAL(spdk_dif_verify(&dst_iovs[0], 1, UT_DIF_NUM_BLOCKS, &ctx, &err), 0);
+	for (i = 0; i < UT_DIF_NUM_BLOCKS * UT_DIF_BLOCK_SIZE; i++) {
+		if (i % UT_DIF_BLOCK_SIZE < UT_DIF_DATA_SIZE) {
+			CU_ASSERT_EQUAL((uint8_t)gen[i], 0xa5);
+		}
+	}
+	g_seq_operations[SPDK_ACCEL_OPC_FILL].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_COPY].count = 0;
+
+	/* Do the same, but copy to a memory domain.  The DIF can't be generated in a buffer pulled
+	 * from it, so the copy needs to stay.
+	 */
+	seq = NULL;
+	completed = 0;
+	memset(gen, 0, sizeof(gen));
+
+	rc = spdk_accel_append_fill(&seq, ioch, tmp, sizeof(tmp), NULL, NULL, 0xa5, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	src_iovs[0].iov_base = tmp;
+	src_iovs[0].iov_len = sizeof(tmp);
+	rc = spdk_accel_append_dif_generate(&seq, ioch, &src_iovs[0], 1, NULL, NULL,
+					    UT_DIF_NUM_BLOCKS, &ctx, ut_sequence_step_cb,
+					    &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	dst_iovs[0].iov_base = (void *)0xfeedbeef;
+	dst_iovs[0].iov_len = sizeof(gen);
+	ut_domain_ctx_init(&domctx, gen, sizeof(gen), &dst_iovs[0]);
+	rc = spdk_accel_append_copy(&seq, ioch, &dst_iovs[0], 1, g_ut_domain, &domctx,
+				    &src_iovs[0], 1, NULL, NULL, 0,
+				    ut_sequence_step_cb, &completed);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	ut_seq.complete = false;
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &ut_seq);
+
+	poll_threads();
+	CU_ASSERT_EQUAL(completed, 3);
+	CU_ASSERT(ut_seq.complete);
+	CU_ASSERT_EQUAL(ut_seq.status, 0);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_FILL].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE].count, 1);
+	CU_ASSERT_EQUAL(g_seq_operations[SPDK_ACCEL_OPC_COPY].count, 1);
+	dst_iovs[0].iov_base = gen;
+	dst_iovs[0].iov_len = sizeof(gen);
+	CU_ASSERT_EQUAL(spdk_dif_verify(&dst_iovs[0], 1, UT_DIF_NUM_BLOCKS, &ctx, &err), 0);
+	for (i = 0; i < UT_DIF_NUM_BLOCKS * UT_DIF_BLOCK_SIZE; i++) {
+		if (i % UT_DIF_BLOCK_SIZE < UT_DIF_DATA_SIZE) {
+			CU_ASSERT_EQUAL((uint8_t)gen[i], 0xa5);
+		}
+	}
+	g_seq_operations[SPDK_ACCEL_OPC_FILL].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_DIF_GENERATE].count = 0;
+	g_seq_operations[SPDK_ACCEL_OPC_COPY].count = 0;
+
+	/* In place generation can't push the data back to a memory domain */
+	seq = NULL;
+	rc = spdk_accel_append_dif_generate(&seq, ioch, &src_iovs[0], 1,
+					    (struct spdk_memory_domain *)0xfeedbeef, NULL,
+					    UT_DIF_NUM_BLOCKS, &ctx, ut_sequence_step_cb,
+					    &completed);
+	CU_ASSERT_EQUAL(rc, -ENOTSUP);
+	CU_ASSERT_PTR_NULL(seq);
+
+	/* Clean up */
+	for (i = 0; i < SPDK_ACCEL_OPC_LAST; ++i) {
+		g_modules_opc[i] = modules[i];
+	}
+
+	spdk_put_io_channel(ioch);
+	poll_threads();
+}
+
 static int
 test_sequence_setup(void)
 {
@@ -4148,6 +4932,10 @@ main(int argc, char **argv)
 	CU_ADD_TEST(seq_suite, test_sequence_driver);
 	CU_ADD_TEST(seq_suite, test_sequence_same_iovs);
 	CU_ADD_TEST(seq_suite, test_sequence_crc32);
+	CU_ADD_TEST(seq_suite, test_sequence_compress_xor);
+	CU_ADD_TEST(seq_suite, test_sequence_dif);
+	CU_ADD_TEST(seq_suite, test_sw_accel_workers_channel_destroy);
+	CU_ADD_TEST(seq_suite, test_sw_accel_workers_cpumask);
 
 	suite = CU_add_suite("accel", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_spdk_accel_task_complete);
@@ -4160,6 +4948,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_spdk_accel_submit_crc32cv);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_copy_crc32c);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_xor);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_pq_gen);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_dif);
+	CU_ADD_TEST(suite, test_sw_accel_workers);
 	CU_ADD_TEST(suite, test_spdk_accel_module_find_by_name);
 	CU_ADD_TEST(suite, test_spdk_accel_module_register);
 
@@ -0,0 +1,553 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+/*
+ * IO fixtures shared by the tests of the parity raid modules (raid5f, raid6), to be included after
+ * the module and common.c. The test defines io_info_setup_parity() to generate the reference
+ * parity of a stripe, and spdk_bdev_readv_blocks_with_md() and spdk_bdev_writev_blocks_with_md()
+ * to play the base bdevs.
+ */
+
+/* P, and Q for raid6 */
+#define RAID_TEST_MAX_PARITY 2
+
+static void *g_accel_p = (void *)0xdeadbeaf;
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
+DEFINE_STUB(accel_channel_create, int, (void *io_device, void *ctx_buf), 0);
+DEFINE_STUB_V(accel_channel_destroy, (void *io_device, void *ctx_buf));
+
+struct spdk_io_channel *
+spdk_accel_get_io_channel(void)
+{
+	return spdk_get_io_channel(g_accel_p);
+}
+
+void *
+spdk_bdev_io_get_md_buf(struct spdk_bdev_io *bdev_io)
+{
+	return bdev_io->u.bdev.md_buf;
+}
+
+uint32_t
+spdk_bdev_get_md_size(const struct spdk_bdev *bdev)
+{
+	return bdev->md_len;
+}
+
+void
+raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+
+	if (bdev_io->internal.cb) {
+		bdev_io->internal.cb(bdev_io, status == SPDK_BDEV_IO_STATUS_SUCCESS, bdev_io->internal.caller_ctx);
+	}
+}
+
+bool
+raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed,
+			   enum spdk_bdev_io_status status)
+{
+	assert(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_io->base_bdev_io_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_bdev_io_complete(raid_io, raid_io->base_bdev_io_status);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+static void
+init_accel(void)
+{
+	spdk_io_device_register(g_accel_p, accel_channel_create, accel_channel_destroy,
+				sizeof(int), "accel_p");
+}
+
+static void
+fini_accel(void)
+{
+	spdk_io_device_unregister(g_accel_p, NULL);
+}
+
+static int
+parity_test_suite_init(const uint8_t *num_base_bdevs_values, size_t num_base_bdevs_count)
+{
+	uint64_t base_bdev_blockcnt_values[] = { 1, 1024, 1024 * 1024 };
+	uint32_t base_bdev_blocklen_values[] = { 512, 4096 };
+	uint32_t strip_size_kb_values[] = { 1, 4, 128 };
+	uint32_t md_len_values[] = { 0, 64 };
+	uint64_t *base_bdev_blockcnt;
+	uint32_t *base_bdev_blocklen;
+	uint32_t *strip_size_kb;
+	uint32_t *md_len;
+	struct raid_params params;
+	uint64_t params_count;
+	size_t i;
+	int rc;
+
+	params_count = num_base_bdevs_count *
+		       SPDK_COUNTOF(base_bdev_blockcnt_values) *
+		       SPDK_COUNTOF(base_bdev_blocklen_values) *
+		       SPDK_COUNTOF(strip_size_kb_values) *
+		       SPDK_COUNTOF(md_len_values);
+	rc = raid_test_params_alloc(params_count);
+	if (rc) {
+		return rc;
+	}
+
+	for (i = 0; i < num_base_bdevs_count; i++) {
+		ARRAY_FOR_EACH(base_bdev_blockcnt_values, base_bdev_blockcnt) {
+			ARRAY_FOR_EACH(base_bdev_blocklen_values, base_bdev_blocklen) {
+				ARRAY_FOR_EACH(strip_size_kb_values, strip_size_kb) {
+					ARRAY_FOR_EACH(md_len_values, md_len) {
+						params.num_base_bdevs = num_base_bdevs_values[i];
+						params.base_bdev_blockcnt = *base_bdev_blockcnt;
+						params.base_bdev_blocklen = *base_bdev_blocklen;
+						params.strip_size = *strip_size_kb * 1024 / *base_bdev_blocklen;
+						params.md_len = *md_len;
+						if (params.strip_size == 0 ||
+						    params.strip_size > *base_bdev_blockcnt) {
+							continue;
+						}
+						raid_test_params_add(&params);
+					}
+				}
+			}
+		}
+	}
+
+	init_accel();
+
+	return 0;
+}
+
+static int
+parity_test_suite_cleanup(void)
+{
+	fini_accel();
+	raid_test_params_free();
+	return 0;
+}
+
+enum test_bdev_error_type {
+	TEST_BDEV_ERROR_NONE,
+	TEST_BDEV_ERROR_SUBMIT,
+	TEST_BDEV_ERROR_COMPLETE,
+	TEST_BDEV_ERROR_NOMEM,
+};
+
+struct raid_io_info {
+	struct raid_bdev *raid_bdev;
+	struct raid_bdev_io_channel *raid_ch;
+	enum spdk_bdev_io_type io_type;
+	uint64_t stripe_index;
+	uint64_t offset_blocks;
+	uint64_t stripe_offset_blocks;
+	uint64_t num_blocks;
+	void *src_buf;
+	void *dest_buf;
+	void *src_md_buf;
+	void *dest_md_buf;
+	size_t buf_size;
+	size_t buf_md_size;
+	void *parity_buf[RAID_TEST_MAX_PARITY];
+	void *reference_parity[RAID_TEST_MAX_PARITY];
+	size_t parity_buf_size;
+	void *parity_md_buf[RAID_TEST_MAX_PARITY];
+	void *reference_md_parity[RAID_TEST_MAX_PARITY];
+	size_t parity_md_buf_size;
+	void *degraded_buf;
+	void *degraded_md_buf;
+	enum spdk_bdev_io_status status;
+	TAILQ_HEAD(, spdk_bdev_io) bdev_io_queue;
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) bdev_io_wait_queue;
+	struct {
+		enum test_bdev_error_type type;
+		struct spdk_bdev *bdev;
+		void (*on_enomem_cb)(struct raid_io_info *io_info, void *ctx);
+		void *on_enomem_cb_ctx;
+	} error;
+};
+
+struct test_raid_bdev_io {
+	char bdev_io_buf[sizeof(struct spdk_bdev_io) + sizeof(struct raid_bdev_io)];
+	struct raid_io_info *io_info;
+	void *buf;
+	void *buf_md;
+};
+
+static void io_info_setup_parity(struct raid_io_info *io_info, void *src, void *src_md);
+
+void
+raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+			struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn)
+{
+	struct raid_io_info *io_info;
+
+	io_info = ((struct test_raid_bdev_io *)spdk_bdev_io_from_ctx(raid_io))->io_info;
+
+	raid_io->waitq_entry.bdev = bdev;
+	raid_io->waitq_entry.cb_fn = cb_fn;
+	raid_io->waitq_entry.cb_arg = raid_io;
+	TAILQ_INSERT_TAIL(&io_info->bdev_io_wait_queue, &raid_io->waitq_entry, link);
+}
+
+static void
+raid_bdev_io_completion_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_io_info *io_info = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		io_info->status = SPDK_BDEV_IO_STATUS_FAILED;
+	} else {
+		io_info->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	}
+}
+
+static struct raid_bdev_io *
+get_raid_io(struct raid_io_info *io_info)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct raid_bdev_io *raid_io;
+	struct raid_bdev *raid_bdev = io_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct test_raid_bdev_io *test_raid_bdev_io;
+	size_t iov_len, remaining;
+	struct iovec *iov;
+	void *buf;
+	int i;
+
+	test_raid_bdev_io = calloc(1, sizeof(*test_raid_bdev_io));
+	SPDK_CU_ASSERT_FATAL(test_raid_bdev_io != NULL);
+
+	SPDK_CU_ASSERT_FATAL(test_raid_bdev_io->bdev_io_buf == (char *)test_raid_bdev_io);
+	bdev_io = (struct spdk_bdev_io *)test_raid_bdev_io->bdev_io_buf;
+	bdev_io->bdev = &raid_bdev->bdev;
+	bdev_io->type = io_info->io_type;
+	bdev_io->u.bdev.offset_blocks = io_info->offset_blocks;
+	bdev_io->u.bdev.num_blocks = io_info->num_blocks;
+	bdev_io->internal.cb = raid_bdev_io_completion_cb;
+	bdev_io->internal.caller_ctx = io_info;
+
+	raid_io = (void *)bdev_io->driver_ctx;
+	raid_io->raid_bdev = raid_bdev;
+	raid_io->raid_ch = io_info->raid_ch;
+	raid_io->base_bdev_io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	test_raid_bdev_io->io_info = io_info;
+
+	if (io_info->io_type == SPDK_BDEV_IO_TYPE_READ) {
+		test_raid_bdev_io->buf = io_info->src_buf;
+		test_raid_bdev_io->buf_md = io_info->src_md_buf;
+		buf = io_info->dest_buf;
+		bdev_io->u.bdev.md_buf = io_info->dest_md_buf;
+	} else {
+		test_raid_bdev_io->buf = io_info->dest_buf;
+		test_raid_bdev_io->buf_md = io_info->dest_md_buf;
+		buf = io_info->src_buf;
+		bdev_io->u.bdev.md_buf = io_info->src_md_buf;
+	}
+
+	bdev_io->u.bdev.iovcnt = 7;
+	bdev_io->u.bdev.iovs = calloc(bdev_io->u.bdev.iovcnt, sizeof(*bdev_io->u.bdev.iovs));
+	SPDK_CU_ASSERT_FATAL(bdev_io->u.bdev.iovs != NULL);
+
+	remaining = io_info->num_blocks * blocklen;
+	iov_len = remaining / bdev_io->u.bdev.iovcnt;
+
+	for (i = 0; i < bdev_io->u.bdev.iovcnt; i++) {
+		iov = &bdev_io->u.bdev.iovs[i];
+		iov->iov_base = buf;
+		iov->iov_len = iov_len;
+		buf += iov_len;
+		remaining -= iov_len;
+	}
+	iov->iov_len += remaining;
+
+	return raid_io;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->u.bdev.iovs);
+	free(bdev_io);
+}
+
+static int
+submit_io(struct raid_io_info *io_info, struct spdk_bdev_desc *desc,
+	  spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct spdk_bdev *bdev = desc->bdev;
+	struct spdk_bdev_io *bdev_io;
+
+	if (bdev == io_info->error.bdev) {
+		if (io_info->error.type == TEST_BDEV_ERROR_SUBMIT) {
+			return -EINVAL;
+		} else if (io_info->error.type == TEST_BDEV_ERROR_NOMEM) {
+			return -ENOMEM;
+		}
+	}
+
+	bdev_io = calloc(1, sizeof(*bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	bdev_io->bdev = bdev;
+	bdev_io->internal.cb = cb;
+	bdev_io->internal.caller_ctx = cb_arg;
+
+	TAILQ_INSERT_TAIL(&io_info->bdev_io_queue, bdev_io, internal.link);
+
+	return 0;
+}
+
+static void
+process_io_completions(struct raid_io_info *io_info)
+{
+	struct spdk_bdev_io *bdev_io;
+	bool success;
+
+	while ((bdev_io = TAILQ_FIRST(&io_info->bdev_io_queue))) {
+		TAILQ_REMOVE(&io_info->bdev_io_queue, bdev_io, internal.link);
+
+		if (io_info->error.type == TEST_BDEV_ERROR_COMPLETE &&
+		    io_info->error.bdev == bdev_io->bdev) {
+			success = false;
+		} else {
+			success = true;
+		}
+
+		bdev_io->internal.cb(bdev_io, success, bdev_io->internal.caller_ctx);
+	}
+
+	if (io_info->error.type == TEST_BDEV_ERROR_NOMEM) {
+		struct spdk_bdev_io_wait_entry *waitq_entry, *tmp;
+		struct spdk_bdev *enomem_bdev = io_info->error.bdev;
+
+		io_info->error.type = TEST_BDEV_ERROR_NONE;
+
+		if (io_info->error.on_enomem_cb != NULL) {
+			io_info->error.on_enomem_cb(io_info, io_info->error.on_enomem_cb_ctx);
+		}
+
+		TAILQ_FOREACH_SAFE(waitq_entry, &io_info->bdev_io_wait_queue, link, tmp) {
+			TAILQ_REMOVE(&io_info->bdev_io_wait_queue, waitq_entry, link);
+			CU_ASSERT(waitq_entry->bdev == enomem_bdev);
+			waitq_entry->cb_fn(waitq_entry->cb_arg);
+		}
+
+		process_io_completions(io_info);
+	} else {
+		CU_ASSERT(TAILQ_EMPTY(&io_info->bdev_io_wait_queue));
+	}
+}
+
+#define DATA_OFFSET_TO_MD_OFFSET(raid_bdev, data_offset) ((data_offset >> raid_bdev->blocklen_shift) * raid_bdev->bdev.md_len)
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt,
+			uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return spdk_bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, NULL, offset_blocks, num_blocks, cb,
+					       cb_arg);
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			    uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT_PTR_NULL(opts->memory_domain);
+	CU_ASSERT_PTR_NULL(opts->memory_domain_ctx);
+
+	return spdk_bdev_writev_blocks_with_md(desc, ch, iov, iovcnt, opts->metadata, offset_blocks,
+					       num_blocks, cb, cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return spdk_bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, NULL, offset_blocks, num_blocks, cb,
+					      cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			   uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT_PTR_NULL(opts->memory_domain);
+	CU_ASSERT_PTR_NULL(opts->memory_domain_ctx);
+
+	return spdk_bdev_readv_blocks_with_md(desc, ch, iov, iovcnt, opts->metadata, offset_blocks,
+					      num_blocks, cb, cb_arg);
+}
+
+static void
+xor_block(uint8_t *a, uint8_t *b, size_t size)
+{
+	while (size-- > 0) {
+		a[size] ^= b[size];
+	}
+}
+
+static void
+deinit_io_info(struct raid_io_info *io_info)
+{
+	int i;
+
+	free(io_info->src_buf);
+	free(io_info->dest_buf);
+	free(io_info->src_md_buf);
+	free(io_info->dest_md_buf);
+	for (i = 0; i < RAID_TEST_MAX_PARITY; i++) {
+		free(io_info->parity_buf[i]);
+		free(io_info->reference_parity[i]);
+		free(io_info->parity_md_buf[i]);
+		free(io_info->reference_md_parity[i]);
+	}
+	free(io_info->degraded_buf);
+	free(io_info->degraded_md_buf);
+}
+
+static void
+init_io_info(struct raid_io_info *io_info, struct raid_bdev *raid_bdev,
+	     struct raid_bdev_io_channel *raid_ch, enum spdk_bdev_io_type io_type,
+	     uint64_t stripe_index, uint64_t stripe_offset_blocks, uint64_t num_blocks)
+{
+	/* Full stripes are the write unit of the parity modules */
+	uint64_t stripe_blocks = raid_bdev->bdev.write_unit_size;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	void *src_buf, *dest_buf;
+	void *src_md_buf, *dest_md_buf;
+	size_t buf_size = num_blocks * blocklen;
+	size_t buf_md_size = num_blocks * raid_bdev->bdev.md_len;
+	uint64_t block;
+	uint64_t i;
+
+	SPDK_CU_ASSERT_FATAL(stripe_offset_blocks < stripe_blocks);
+
+	memset(io_info, 0, sizeof(*io_info));
+
+	if (buf_size) {
+		src_buf = spdk_dma_malloc(buf_size, 4096, NULL);
+		SPDK_CU_ASSERT_FATAL(src_buf != NULL);
+
+		dest_buf = spdk_dma_malloc(buf_size, 4096, NULL);
+		SPDK_CU_ASSERT_FATAL(dest_buf != NULL);
+
+		memset(src_buf, 0xff, buf_size);
+		for (block = 0; block < num_blocks; block++) {
+			*((uint64_t *)(src_buf + block * blocklen)) = block;
+		}
+	} else {
+		src_buf = NULL;
+		dest_buf = NULL;
+	}
+
+	if (buf_md_size) {
+		src_md_buf = spdk_dma_malloc(buf_md_size, 4096, NULL);
+		SPDK_CU_ASSERT_FATAL(src_md_buf != NULL);
+
+		dest_md_buf = spdk_dma_malloc(buf_md_size, 4096, NULL);
+		SPDK_CU_ASSERT_FATAL(dest_md_buf != NULL);
+
+		memset(src_md_buf, 0xff, buf_md_size);
+		for (i = 0; i < buf_md_size; i++) {
+			*((uint8_t *)(src_md_buf + i)) = (uint8_t)i;
+		}
+	} else {
+		src_md_buf = NULL;
+		dest_md_buf = NULL;
+	}
+
+	io_info->raid_bdev = raid_bdev;
+	io_info->raid_ch = raid_ch;
+	io_info->io_type = io_type;
+	io_info->stripe_index = stripe_index;
+	io_info->offset_blocks = stripe_index * stripe_blocks + stripe_offset_blocks;
+	io_info->stripe_offset_blocks = stripe_offset_blocks;
+	io_info->num_blocks = num_blocks;
+	io_info->src_buf = src_buf;
+	io_info->dest_buf = dest_buf;
+	io_info->src_md_buf = src_md_buf;
+	io_info->dest_md_buf = dest_md_buf;
+	io_info->buf_size = buf_size;
+	io_info->buf_md_size = buf_md_size;
+	io_info->status = SPDK_BDEV_IO_STATUS_PENDING;
+
+	TAILQ_INIT(&io_info->bdev_io_queue);
+	TAILQ_INIT(&io_info->bdev_io_wait_queue);
+}
+
+static void
+io_info_setup_degraded(struct raid_io_info *io_info)
+{
+	struct raid_bdev *raid_bdev = io_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint32_t md_len = raid_bdev->bdev.md_len;
+	size_t stripe_len = raid_bdev->bdev.write_unit_size * blocklen;
+	size_t stripe_md_len = raid_bdev->bdev.write_unit_size * md_len;
+
+	io_info->degraded_buf = malloc(stripe_len);
+	SPDK_CU_ASSERT_FATAL(io_info->degraded_buf != NULL);
+
+	memset(io_info->degraded_buf, 0xab, stripe_len);
+
+	memcpy(io_info->degraded_buf + io_info->stripe_offset_blocks * blocklen,
+	       io_info->src_buf, io_info->num_blocks * blocklen);
+
+	if (stripe_md_len != 0) {
+		io_info->degraded_md_buf = malloc(stripe_md_len);
+		SPDK_CU_ASSERT_FATAL(io_info->degraded_md_buf != NULL);
+
+		memset(io_info->degraded_md_buf, 0xab, stripe_md_len);
+
+		memcpy(io_info->degraded_md_buf + io_info->stripe_offset_blocks * md_len,
+		       io_info->src_md_buf, io_info->num_blocks * md_len);
+	}
+
+	io_info_setup_parity(io_info, io_info->degraded_buf, io_info->degraded_md_buf);
+
+	memset(io_info->degraded_buf + io_info->stripe_offset_blocks * blocklen,
+	       0xcd, io_info->num_blocks * blocklen);
+
+	if (stripe_md_len != 0) {
+		memset(io_info->degraded_md_buf + io_info->stripe_offset_blocks * md_len,
+		       0xcd, io_info->num_blocks * md_len);
+	}
+}
+
+struct chunk_write_error_with_enomem_ctx {
+	enum test_bdev_error_type error_type;
+	struct spdk_bdev *bdev;
+};
+
+static void
+chunk_write_error_with_enomem_cb(struct raid_io_info *io_info, void *_ctx)
+{
+	struct chunk_write_error_with_enomem_ctx *ctx = _ctx;
+
+	io_info->error.type = ctx->error_type;
+	io_info->error.bdev = ctx->bdev;
+}
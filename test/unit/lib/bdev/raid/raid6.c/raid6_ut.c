@@ -0,0 +1,733 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk/gf.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid6.c"
+#include "../common.c"
+#include "../parity_common.c"
+
+/* Number of missing base bdevs */
+static uint8_t g_test_degraded;
+
+struct pq_gen_ctx {
+	spdk_accel_completion_cb cb_fn;
+	void *cb_arg;
+};
+
+static void
+finish_pq_gen(void *_ctx)
+{
+	struct pq_gen_ctx *ctx = _ctx;
+
+	ctx->cb_fn(ctx->cb_arg, 0);
+
+	free(ctx);
+}
+
+int
+spdk_accel_submit_pq_gen(struct spdk_io_channel *ch, void *p, void *q, void **sources,
+			 uint32_t nsrcs, uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct pq_gen_ctx *ctx;
+
+	ctx = malloc(sizeof(*ctx));
+	SPDK_CU_ASSERT_FATAL(ctx != NULL);
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	SPDK_CU_ASSERT_FATAL(spdk_gf_pq_gen(p, q, sources, nsrcs, nbytes) == 0);
+
+	spdk_thread_send_msg(spdk_get_thread(), finish_pq_gen, ctx);
+
+	return 0;
+}
+
+static int
+test_suite_init(void)
+{
+	uint8_t num_base_bdevs_values[] = { 4, 5, 6 };
+
+	return parity_test_suite_init(num_base_bdevs_values, SPDK_COUNTOF(num_base_bdevs_values));
+}
+
+static void
+test_setup(void)
+{
+	g_test_degraded = 0;
+}
+
+static struct raid6_info *
+create_raid6(struct raid_params *params)
+{
+	struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid6_module);
+
+	SPDK_CU_ASSERT_FATAL(raid6_start(raid_bdev) == 0);
+
+	return raid_bdev->module_private;
+}
+
+static void
+delete_raid6(struct raid6_info *r6_info)
+{
+	struct raid_bdev *raid_bdev = r6_info->raid_bdev;
+
+	raid6_stop(raid_bdev);
+
+	raid_test_delete_raid_bdev(raid_bdev);
+}
+
+static void
+test_raid6_start(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid6_info *r6_info;
+
+		r6_info = create_raid6(params);
+
+		SPDK_CU_ASSERT_FATAL(r6_info != NULL);
+
+		CU_ASSERT_EQUAL(r6_info->stripe_blocks, params->strip_size * (params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(r6_info->total_stripes, params->base_bdev_blockcnt / params->strip_size);
+		CU_ASSERT_EQUAL(r6_info->raid_bdev->bdev.blockcnt,
+				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
+				(params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(r6_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_TRUE(r6_info->raid_bdev->bdev.split_on_optimal_io_boundary);
+		CU_ASSERT_EQUAL(r6_info->raid_bdev->bdev.write_unit_size, r6_info->stripe_blocks);
+
+		delete_raid6(r6_info);
+	}
+}
+
+static uint8_t
+test_data_chunk_idx(struct stripe_request *stripe_req, struct chunk *chunk)
+{
+	return chunk->index - (stripe_req->p_chunk < chunk) - (stripe_req->q_chunk < chunk);
+}
+
+int
+spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				struct iovec *iov, int iovcnt, void *md_buf,
+				uint64_t offset_blocks, uint64_t num_blocks,
+				spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct chunk *chunk = cb_arg;
+	struct stripe_request *stripe_req;
+	struct test_raid_bdev_io *test_raid_bdev_io;
+	struct raid_io_info *io_info;
+	struct raid_bdev *raid_bdev;
+	uint8_t data_chunk_idx;
+	uint64_t data_offset;
+	struct iovec dest;
+	void *dest_md_buf;
+
+	SPDK_CU_ASSERT_FATAL(cb == raid6_chunk_complete_bdev_io);
+
+	stripe_req = raid6_chunk_stripe_req(chunk);
+	test_raid_bdev_io = (struct test_raid_bdev_io *)spdk_bdev_io_from_ctx(stripe_req->raid_io);
+	io_info = test_raid_bdev_io->io_info;
+	raid_bdev = io_info->raid_bdev;
+
+	if (chunk == stripe_req->p_chunk || chunk == stripe_req->q_chunk) {
+		int i = chunk == stripe_req->p_chunk ? 0 : 1;
+
+		if (io_info->parity_buf[i] == NULL) {
+			goto submit;
+		}
+		dest.iov_base = io_info->parity_buf[i];
+		if (md_buf != NULL) {
+			dest_md_buf = io_info->parity_md_buf[i];
+		}
+	} else {
+		data_chunk_idx = test_data_chunk_idx(stripe_req, chunk);
+		data_offset = data_chunk_idx * raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+		dest.iov_base = test_raid_bdev_io->buf + data_offset;
+		if (md_buf != NULL) {
+			data_offset = DATA_OFFSET_TO_MD_OFFSET(raid_bdev, data_offset);
+			dest_md_buf = test_raid_bdev_io->buf_md + data_offset;
+		}
+	}
+	dest.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+
+	spdk_iovcpy(iov, iovcnt, &dest, 1);
+	if (md_buf != NULL) {
+		memcpy(dest_md_buf, md_buf, num_blocks * raid_bdev->bdev.md_len);
+	}
+
+submit:
+	return submit_io(io_info, desc, cb, cb_arg);
+}
+
+static int
+spdk_bdev_readv_blocks_degraded(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+				struct iovec *iov, int iovcnt, void *md_buf,
+				uint64_t offset_blocks, uint64_t num_blocks,
+				spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct chunk *chunk = cb_arg;
+	struct stripe_request *stripe_req;
+	struct test_raid_bdev_io *test_raid_bdev_io;
+	struct raid_io_info *io_info;
+	struct raid_bdev *raid_bdev;
+	uint8_t data_chunk_idx;
+	void *buf, *buf_md;
+	struct iovec src;
+
+	SPDK_CU_ASSERT_FATAL(cb == raid6_chunk_complete_bdev_io);
+
+	stripe_req = raid6_chunk_stripe_req(chunk);
+	test_raid_bdev_io = (struct test_raid_bdev_io *)spdk_bdev_io_from_ctx(stripe_req->raid_io);
+	io_info = test_raid_bdev_io->io_info;
+	raid_bdev = io_info->raid_bdev;
+
+	if (chunk == stripe_req->p_chunk || chunk == stripe_req->q_chunk) {
+		int i = chunk == stripe_req->p_chunk ? 0 : 1;
+
+		buf = io_info->reference_parity[i];
+		buf_md = io_info->reference_md_parity[i];
+	} else {
+		data_chunk_idx = test_data_chunk_idx(stripe_req, chunk);
+		buf = io_info->degraded_buf +
+		      data_chunk_idx * raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+		buf_md = io_info->degraded_md_buf +
+			 data_chunk_idx * raid_bdev->strip_size * raid_bdev->bdev.md_len;
+	}
+
+	buf += (offset_blocks % raid_bdev->strip_size) * raid_bdev->bdev.blocklen;
+	buf_md += (offset_blocks % raid_bdev->strip_size) * raid_bdev->bdev.md_len;
+
+	src.iov_base = buf;
+	src.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+
+	spdk_iovcpy(&src, 1, iov, iovcnt);
+	if (md_buf != NULL) {
+		memcpy(md_buf, buf_md, num_blocks * raid_bdev->bdev.md_len);
+	}
+
+	return submit_io(io_info, desc, cb, cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			       struct iovec *iov, int iovcnt, void *md_buf,
+			       uint64_t offset_blocks, uint64_t num_blocks,
+			       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct test_raid_bdev_io *test_raid_bdev_io;
+	struct iovec src;
+
+	if (cb == raid6_chunk_complete_bdev_io) {
+		return spdk_bdev_readv_blocks_degraded(desc, ch, iov, iovcnt, md_buf, offset_blocks,
+						       num_blocks, cb, cb_arg);
+	}
+
+	test_raid_bdev_io = (struct test_raid_bdev_io *)spdk_bdev_io_from_ctx(raid_io);
+
+	SPDK_CU_ASSERT_FATAL(cb == raid6_chunk_read_complete);
+
+	src.iov_base = test_raid_bdev_io->buf;
+	src.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+
+	spdk_iovcpy(&src, 1, iov, iovcnt);
+	if (md_buf != NULL) {
+		memcpy(md_buf, test_raid_bdev_io->buf_md, num_blocks * raid_bdev->bdev.md_len);
+	}
+
+	return submit_io(test_raid_bdev_io->io_info, desc, cb, cb_arg);
+}
+
+static void
+gf_mul_xor_block(uint8_t *a, uint8_t *b, uint8_t c, size_t size)
+{
+	while (size-- > 0) {
+		a[size] ^= spdk_gf_mul(c, b[size]);
+	}
+}
+
+static void
+test_raid6_write_request(struct raid_io_info *io_info)
+{
+	struct raid_bdev_io *raid_io;
+
+	SPDK_CU_ASSERT_FATAL(io_info->num_blocks / io_info->raid_bdev->bdev.write_unit_size == 1);
+
+	bool check_parity[2] = { true, true };
+	int j;
+
+	raid_io = get_raid_io(io_info);
+
+	raid6_submit_rw_request(raid_io);
+
+	poll_threads();
+
+	process_io_completions(io_info);
+
+	if (g_test_degraded) {
+		struct raid_bdev *raid_bdev = io_info->raid_bdev;
+		uint8_t p_idx = raid6_stripe_p_chunk_index(raid_bdev, io_info->stripe_index);
+		uint8_t q_idx = raid6_stripe_q_chunk_index(raid_bdev, io_info->stripe_index);
+		uint8_t i, d;
+		off_t offset;
+		uint32_t strip_len;
+
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (io_info->raid_ch->base_channel[i] != NULL) {
+				continue;
+			}
+
+			if (i == p_idx) {
+				check_parity[0] = false;
+				continue;
+			}
+
+			if (i == q_idx) {
+				check_parity[1] = false;
+				continue;
+			}
+
+			d = i - (p_idx < i) - (q_idx < i);
+
+			strip_len = raid_bdev->strip_size_kb * 1024;
+			offset = d * strip_len;
+
+			memcpy(io_info->dest_buf + offset, io_info->src_buf + offset, strip_len);
+			if (io_info->dest_md_buf) {
+				strip_len = raid_bdev->strip_size * raid_bdev->bdev.md_len;
+				offset = d * strip_len;
+				memcpy(io_info->dest_md_buf + offset, io_info->src_md_buf + offset, strip_len);
+			}
+		}
+	}
+
+	if (io_info->status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+		for (j = 0; j < 2; j++) {
+			if (!check_parity[j]) {
+				continue;
+			}
+			if (io_info->parity_buf[j]) {
+				CU_ASSERT(memcmp(io_info->parity_buf[j], io_info->reference_parity[j],
+						 io_info->parity_buf_size) == 0);
+			}
+			if (io_info->parity_md_buf[j]) {
+				CU_ASSERT(memcmp(io_info->parity_md_buf[j], io_info->reference_md_parity[j],
+						 io_info->parity_md_buf_size) == 0);
+			}
+		}
+	}
+}
+
+static void
+test_raid6_read_request(struct raid_io_info *io_info)
+{
+	struct raid_bdev_io *raid_io;
+
+	SPDK_CU_ASSERT_FATAL(io_info->num_blocks <= io_info->raid_bdev->strip_size);
+
+	raid_io = get_raid_io(io_info);
+
+	raid6_submit_rw_request(raid_io);
+
+	process_io_completions(io_info);
+}
+
+static void
+io_info_setup_parity(struct raid_io_info *io_info, void *src, void *src_md)
+{
+	struct raid_bdev *raid_bdev = io_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	size_t strip_len = raid_bdev->strip_size * blocklen;
+	unsigned i;
+
+	io_info->parity_buf_size = strip_len;
+	for (i = 0; i < 2; i++) {
+		io_info->parity_buf[i] = calloc(1, io_info->parity_buf_size);
+		SPDK_CU_ASSERT_FATAL(io_info->parity_buf[i] != NULL);
+
+		io_info->reference_parity[i] = calloc(1, io_info->parity_buf_size);
+		SPDK_CU_ASSERT_FATAL(io_info->reference_parity[i] != NULL);
+	}
+
+	for (i = 0; i < raid6_stripe_data_chunks_num(raid_bdev); i++) {
+		xor_block(io_info->reference_parity[0], src, strip_len);
+		gf_mul_xor_block(io_info->reference_parity[1], src, spdk_gf_exp(i), strip_len);
+		src += strip_len;
+	}
+
+	if (src_md) {
+		size_t strip_md_len = raid_bdev->strip_size * raid_bdev->bdev.md_len;
+
+		io_info->parity_md_buf_size = strip_md_len;
+		for (i = 0; i < 2; i++) {
+			io_info->parity_md_buf[i] = calloc(1, io_info->parity_md_buf_size);
+			SPDK_CU_ASSERT_FATAL(io_info->parity_md_buf[i] != NULL);
+
+			io_info->reference_md_parity[i] = calloc(1, io_info->parity_md_buf_size);
+			SPDK_CU_ASSERT_FATAL(io_info->reference_md_parity[i] != NULL);
+		}
+
+		for (i = 0; i < raid6_stripe_data_chunks_num(raid_bdev); i++) {
+			xor_block(io_info->reference_md_parity[0], src_md, strip_md_len);
+			gf_mul_xor_block(io_info->reference_md_parity[1], src_md, spdk_gf_exp(i), strip_md_len);
+			src_md += strip_md_len;
+		}
+	}
+}
+
+static void
+test_raid6_submit_rw_request(struct raid6_info *r6_info, struct raid_bdev_io_channel *raid_ch,
+			      enum spdk_bdev_io_type io_type, uint64_t stripe_index, uint64_t stripe_offset_blocks,
+			      uint64_t num_blocks)
+{
+	struct raid_io_info io_info;
+
+	init_io_info(&io_info, r6_info->raid_bdev, raid_ch, io_type, stripe_index, stripe_offset_blocks,
+		     num_blocks);
+
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		if (g_test_degraded) {
+			io_info_setup_degraded(&io_info);
+		}
+		test_raid6_read_request(&io_info);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		io_info_setup_parity(&io_info, io_info.src_buf, io_info.src_md_buf);
+		test_raid6_write_request(&io_info);
+		break;
+	default:
+		CU_FAIL_FATAL("unsupported io_type");
+	}
+
+	CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(memcmp(io_info.src_buf, io_info.dest_buf, io_info.buf_size) == 0);
+	if (io_info.buf_md_size) {
+		CU_ASSERT(memcmp(io_info.src_md_buf, io_info.dest_md_buf, io_info.buf_md_size) == 0);
+	}
+
+	deinit_io_info(&io_info);
+}
+
+static void
+run_for_each_raid6_config(void (*test_fn)(struct raid_bdev *raid_bdev,
+			   struct raid_bdev_io_channel *raid_ch))
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid6_info *r6_info;
+		struct raid_bdev_io_channel raid_ch = { 0 };
+		int i;
+
+		r6_info = create_raid6(params);
+
+		raid_ch.num_channels = params->num_base_bdevs;
+		raid_ch.base_channel = calloc(params->num_base_bdevs, sizeof(struct spdk_io_channel *));
+		SPDK_CU_ASSERT_FATAL(raid_ch.base_channel != NULL);
+
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			if (i < g_test_degraded) {
+				continue;
+			}
+			raid_ch.base_channel[i] = (void *)1;
+		}
+
+		raid_ch.module_channel = raid6_get_io_channel(r6_info->raid_bdev);
+		SPDK_CU_ASSERT_FATAL(raid_ch.module_channel);
+
+		test_fn(r6_info->raid_bdev, &raid_ch);
+
+		spdk_put_io_channel(raid_ch.module_channel);
+		poll_threads();
+
+		free(raid_ch.base_channel);
+
+		delete_raid6(r6_info);
+	}
+}
+
+#define RAID6_TEST_FOR_EACH_STRIPE(raid_bdev, i) \
+	for (i = 0; i < spdk_min(raid_bdev->num_base_bdevs, ((struct raid6_info *)raid_bdev->module_private)->total_stripes); i++)
+
+static void
+__test_raid6_submit_read_request(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	uint32_t strip_size = raid_bdev->strip_size;
+	uint64_t stripe_index;
+	unsigned int i;
+
+	for (i = 0; i < raid6_stripe_data_chunks_num(raid_bdev); i++) {
+		uint64_t stripe_offset = i * strip_size;
+
+		RAID6_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			test_raid6_submit_rw_request(r6_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+						      stripe_index, stripe_offset, 1);
+
+			test_raid6_submit_rw_request(r6_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+						      stripe_index, stripe_offset, strip_size);
+
+			test_raid6_submit_rw_request(r6_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+						      stripe_index, stripe_offset + strip_size - 1, 1);
+			if (strip_size <= 2) {
+				continue;
+			}
+			test_raid6_submit_rw_request(r6_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+						      stripe_index, stripe_offset + 1, strip_size - 2);
+		}
+	}
+}
+static void
+test_raid6_submit_read_request(void)
+{
+	run_for_each_raid6_config(__test_raid6_submit_read_request);
+}
+
+static void
+__test_raid6_stripe_request_map_iovecs(struct raid_bdev *raid_bdev,
+					struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	struct raid6_io_channel *r6ch = spdk_io_channel_get_ctx(raid_ch->module_channel);
+	size_t strip_bytes = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	struct raid_io_info io_info;
+	struct raid_bdev_io *raid_io;
+	struct spdk_bdev_io *bdev_io;
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	struct iovec *iovs_bak;
+	struct iovec iovs[] = {
+		{ .iov_base = (void *)0x0ff0000, .iov_len = strip_bytes },
+		{ .iov_base = (void *)0x1ff0000, .iov_len = strip_bytes / 2 },
+		{ .iov_base = (void *)0x2ff0000, .iov_len = strip_bytes * 2 },
+		{ .iov_base = (void *)0x3ff0000, .iov_len = strip_bytes * raid_bdev->num_base_bdevs },
+	};
+	size_t iovcnt = SPDK_COUNTOF(iovs);
+	int ret;
+
+	init_io_info(&io_info, r6_info->raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, 0, 0);
+
+	raid_io = get_raid_io(&io_info);
+	bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	iovs_bak = bdev_io->u.bdev.iovs;
+	bdev_io->u.bdev.iovs = iovs;
+	bdev_io->u.bdev.iovcnt = iovcnt;
+
+	stripe_req = raid6_stripe_request_alloc(r6ch, STRIPE_REQ_WRITE);
+	SPDK_CU_ASSERT_FATAL(stripe_req != NULL);
+
+	stripe_req->p_chunk = &stripe_req->chunks[raid6_stripe_data_chunks_num(raid_bdev)];
+	stripe_req->q_chunk = &stripe_req->chunks[raid6_stripe_data_chunks_num(raid_bdev) + 1];
+	stripe_req->raid_io = raid_io;
+
+	ret = raid6_stripe_request_map_iovecs(stripe_req);
+	CU_ASSERT(ret == 0);
+
+	chunk = &stripe_req->chunks[0];
+	CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[0].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[0].iov_len);
+
+	chunk = &stripe_req->chunks[1];
+	CU_ASSERT_EQUAL(chunk->iovcnt, 2);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[1].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[1].iov_len);
+	CU_ASSERT_EQUAL(chunk->iovs[1].iov_base, iovs[2].iov_base);
+	CU_ASSERT_EQUAL(chunk->iovs[1].iov_len, iovs[2].iov_len / 4);
+
+	if (raid_bdev->num_base_bdevs > 4) {
+		chunk = &stripe_req->chunks[2];
+		CU_ASSERT_EQUAL(chunk->iovcnt, 1);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[2].iov_base + strip_bytes / 2);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[2].iov_len / 2);
+	}
+	if (raid_bdev->num_base_bdevs > 5) {
+		chunk = &stripe_req->chunks[3];
+		CU_ASSERT_EQUAL(chunk->iovcnt, 2);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_base, iovs[2].iov_base + (strip_bytes / 2) * 3);
+		CU_ASSERT_EQUAL(chunk->iovs[0].iov_len, iovs[2].iov_len / 4);
+		CU_ASSERT_EQUAL(chunk->iovs[1].iov_base, iovs[3].iov_base);
+		CU_ASSERT_EQUAL(chunk->iovs[1].iov_len, strip_bytes / 2);
+	}
+
+	bdev_io->u.bdev.iovs = iovs_bak;
+	raid6_stripe_request_free(stripe_req);
+	spdk_bdev_free_io(bdev_io);
+	deinit_io_info(&io_info);
+}
+static void
+test_raid6_stripe_request_map_iovecs(void)
+{
+	run_for_each_raid6_config(__test_raid6_stripe_request_map_iovecs);
+}
+
+static void
+__test_raid6_submit_full_stripe_write_request(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	uint64_t stripe_index;
+
+	RAID6_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+		test_raid6_submit_rw_request(r6_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+					      stripe_index, 0, r6_info->stripe_blocks);
+	}
+}
+static void
+test_raid6_submit_full_stripe_write_request(void)
+{
+	run_for_each_raid6_config(__test_raid6_submit_full_stripe_write_request);
+}
+
+static void
+__test_raid6_chunk_write_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	struct raid_base_bdev_info *base_bdev_info;
+	uint64_t stripe_index;
+	struct raid_io_info io_info;
+	enum test_bdev_error_type error_type;
+
+	for (error_type = TEST_BDEV_ERROR_SUBMIT; error_type <= TEST_BDEV_ERROR_NOMEM; error_type++) {
+		RAID6_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_bdev_info) {
+				init_io_info(&io_info, r6_info->raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+					     stripe_index, 0, r6_info->stripe_blocks);
+
+				io_info.error.type = error_type;
+				io_info.error.bdev = base_bdev_info->desc->bdev;
+
+				test_raid6_write_request(&io_info);
+
+				if (error_type == TEST_BDEV_ERROR_NOMEM) {
+					CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+				} else {
+					CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_FAILED);
+				}
+
+				deinit_io_info(&io_info);
+			}
+		}
+	}
+}
+static void
+test_raid6_chunk_write_error(void)
+{
+	run_for_each_raid6_config(__test_raid6_chunk_write_error);
+}
+
+static void
+__test_raid6_chunk_write_error_with_enomem(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid6_info *r6_info = raid_bdev->module_private;
+	struct raid_base_bdev_info *base_bdev_info;
+	uint64_t stripe_index;
+	struct raid_io_info io_info;
+	enum test_bdev_error_type error_type;
+	struct chunk_write_error_with_enomem_ctx on_enomem_cb_ctx;
+
+	for (error_type = TEST_BDEV_ERROR_SUBMIT; error_type <= TEST_BDEV_ERROR_COMPLETE; error_type++) {
+		RAID6_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+			struct raid_base_bdev_info *base_bdev_info_last =
+					&raid_bdev->base_bdev_info[raid_bdev->num_base_bdevs - 1];
+
+			RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_bdev_info) {
+				if (base_bdev_info == base_bdev_info_last) {
+					continue;
+				}
+
+				init_io_info(&io_info, r6_info->raid_bdev, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+					     stripe_index, 0, r6_info->stripe_blocks);
+
+				io_info.error.type = TEST_BDEV_ERROR_NOMEM;
+				io_info.error.bdev = base_bdev_info->desc->bdev;
+				io_info.error.on_enomem_cb = chunk_write_error_with_enomem_cb;
+				io_info.error.on_enomem_cb_ctx = &on_enomem_cb_ctx;
+				on_enomem_cb_ctx.error_type = error_type;
+				on_enomem_cb_ctx.bdev = base_bdev_info_last->desc->bdev;
+
+				test_raid6_write_request(&io_info);
+
+				CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_FAILED);
+
+				deinit_io_info(&io_info);
+			}
+		}
+	}
+}
+static void
+test_raid6_chunk_write_error_with_enomem(void)
+{
+	run_for_each_raid6_config(__test_raid6_chunk_write_error_with_enomem);
+}
+
+static void
+test_raid6_submit_full_stripe_write_request_degraded(void)
+{
+	g_test_degraded = 1;
+	run_for_each_raid6_config(__test_raid6_submit_full_stripe_write_request);
+}
+
+static void
+test_raid6_submit_read_request_degraded(void)
+{
+	g_test_degraded = 1;
+	run_for_each_raid6_config(__test_raid6_submit_read_request);
+}
+
+static void
+test_raid6_submit_full_stripe_write_request_double_degraded(void)
+{
+	g_test_degraded = 2;
+	run_for_each_raid6_config(__test_raid6_submit_full_stripe_write_request);
+}
+
+static void
+test_raid6_submit_read_request_double_degraded(void)
+{
+	g_test_degraded = 2;
+	run_for_each_raid6_config(__test_raid6_submit_read_request);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite_with_setup_and_teardown("raid6", test_suite_init, parity_test_suite_cleanup,
+			test_setup, NULL);
+	CU_ADD_TEST(suite, test_raid6_start);
+	CU_ADD_TEST(suite, test_raid6_submit_read_request);
+	CU_ADD_TEST(suite, test_raid6_stripe_request_map_iovecs);
+	CU_ADD_TEST(suite, test_raid6_submit_full_stripe_write_request);
+	CU_ADD_TEST(suite, test_raid6_chunk_write_error);
+	CU_ADD_TEST(suite, test_raid6_chunk_write_error_with_enomem);
+	CU_ADD_TEST(suite, test_raid6_submit_full_stripe_write_request_degraded);
+	CU_ADD_TEST(suite, test_raid6_submit_read_request_degraded);
+	CU_ADD_TEST(suite, test_raid6_submit_full_stripe_write_request_double_degraded);
+	CU_ADD_TEST(suite, test_raid6_submit_read_request_double_degraded);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	free_threads();
+
+	return num_failures;
+}
@@ -0,0 +1,473 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+#include "spdk/rpc.h"
+#include "common/lib/ut_multithread.c"
+#include "init/json_config.c"
+
+#define UT_MAX_CLIENTS	8
+#define UT_MAX_SENT	32
+#define UT_REQ_LEN	256
+
+/*
+ * Entries of the "bdev" subsystem: bdev_set_options is a STARTUP method, the remaining ones are
+ * RUNTIME methods.  The bdev_malloc_create and bdev_null_create entries are loaded concurrently,
+ * Malloc0 is created twice to check that the second one waits for the first one.
+ */
+static const char *g_ut_config =
+	"{\"subsystems\":[{\"subsystem\":\"bdev\",\"config\":["
+	"{\"method\":\"bdev_set_options\",\"params\":{\"bdev_io_pool_size\":1024}},"
+	"{\"method\":\"bdev_malloc_create\",\"params\":{\"name\":\"Malloc0\"}},"
+	"{\"method\":\"bdev_malloc_create\",\"params\":{\"name\":\"Malloc1\"}},"
+	"{\"method\":\"bdev_malloc_create\",\"params\":{\"name\":\"Malloc0\"}},"
+	"{\"method\":\"bdev_malloc_create\",\"params\":{\"name\":\"Malloc2\"}},"
+	"{\"method\":\"bdev_null_create\",\"params\":{\"name\":\"Null0\"}},"
+	"{\"method\":\"bdev_null_create\",\"params\":{\"name\":\"Null1\"}},"
+	"{\"method\":\"bdev_wait_for_examine\"}"
+	"]}]}";
+
+struct spdk_jsonrpc_client_request {
+	char	buf[UT_REQ_LEN];
+	size_t	len;
+};
+
+struct spdk_jsonrpc_client {
+	int	id;
+	bool	connected;
+	/* Request being processed, empty if the client is idle */
+	char	request[UT_REQ_LEN];
+	bool	response_ready;
+	bool	error;
+};
+
+static struct spdk_jsonrpc_client *g_clients[UT_MAX_CLIENTS];
+static int g_num_clients;
+static int g_open_clients;
+static char g_sent[UT_MAX_SENT][UT_REQ_LEN];
+static int g_sent_client[UT_MAX_SENT];
+static int g_num_sent;
+/* Fail sending the request with this index */
+static int g_send_fail_idx = -1;
+/* Return this error when polling the client busy with a request */
+static int g_poll_rc;
+static int g_load_rc;
+static int g_load_done;
+static char g_config_file[64];
+
+static char g_error_msg[] = "\"Failed\"";
+static struct spdk_json_val g_error_val = {
+	.start = g_error_msg,
+	.len = sizeof(g_error_msg) - 1,
+	.type = SPDK_JSON_VAL_STRING,
+};
+
+DEFINE_STUB(spdk_rpc_initialize, int, (const char *listen_addr, const struct spdk_rpc_opts *opts),
+	    0);
+DEFINE_STUB_V(spdk_rpc_finish, (void));
+
+static uint32_t g_rpc_state = SPDK_RPC_STARTUP;
+
+void
+spdk_rpc_set_state(uint32_t state)
+{
+	g_rpc_state = state;
+}
+
+uint32_t
+spdk_rpc_get_state(void)
+{
+	return g_rpc_state;
+}
+
+int
+spdk_rpc_get_method_state_mask(const char *method, uint32_t *state_mask)
+{
+	*state_mask = strcmp(method, "bdev_set_options") == 0 ? SPDK_RPC_STARTUP : SPDK_RPC_RUNTIME;
+	return 0;
+}
+
+void
+spdk_subsystem_init(spdk_subsystem_init_fn cb_fn, void *cb_arg)
+{
+	cb_fn(0, cb_arg);
+}
+
+static int
+ut_request_write_cb(void *cb_ctx, const void *data, size_t size)
+{
+	struct spdk_jsonrpc_client_request *request = cb_ctx;
+
+	SPDK_CU_ASSERT_FATAL(request->len + size < sizeof(request->buf));
+	memcpy(request->buf + request->len, data, size);
+	request->len += size;
+
+	return 0;
+}
+
+struct spdk_json_write_ctx *
+spdk_jsonrpc_begin_request(struct spdk_jsonrpc_client_request *request, int32_t id,
+			   const char *method)
+{
+	struct spdk_json_write_ctx *w;
+
+	w = spdk_json_write_begin(ut_request_write_cb, request, 0);
+	SPDK_CU_ASSERT_FATAL(w != NULL);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "jsonrpc", "2.0");
+	if (id >= 0) {
+		spdk_json_write_named_int32(w, "id", id);
+	}
+	if (method != NULL) {
+		spdk_json_write_named_string(w, "method", method);
+	}
+
+	return w;
+}
+
+void
+spdk_jsonrpc_end_request(struct spdk_jsonrpc_client_request *request,
+			 struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_object_end(w);
+	spdk_json_write_end(w);
+}
+
+struct spdk_jsonrpc_client_request *
+spdk_jsonrpc_client_create_request(void)
+{
+	return calloc(1, sizeof(struct spdk_jsonrpc_client_request));
+}
+
+void
+spdk_jsonrpc_client_free_request(struct spdk_jsonrpc_client_request *req)
+{
+	free(req);
+}
+
+struct spdk_jsonrpc_client *
+spdk_jsonrpc_client_connect(const char *addr, int addr_family)
+{
+	struct spdk_jsonrpc_client *client;
+
+	SPDK_CU_ASSERT_FATAL(g_num_clients < UT_MAX_CLIENTS);
+	client = calloc(1, sizeof(*client));
+	SPDK_CU_ASSERT_FATAL(client != NULL);
+	client->id = g_num_clients;
+	g_clients[g_num_clients++] = client;
+	g_open_clients++;
+
+	return client;
+}
+
+void
+spdk_jsonrpc_client_close(struct spdk_jsonrpc_client *client)
+{
+	g_clients[client->id] = NULL;
+	g_open_clients--;
+	free(client);
+}
+
+int
+spdk_jsonrpc_client_send_request(struct spdk_jsonrpc_client *client,
+				 struct spdk_jsonrpc_client_request *req)
+{
+	/* Only one request is sent over a connection at a time */
+	CU_ASSERT(client->request[0] == '\0');
+	SPDK_CU_ASSERT_FATAL(g_num_sent < UT_MAX_SENT);
+
+	if (g_num_sent == g_send_fail_idx) {
+		return -EIO;
+	}
+
+	snprintf(g_sent[g_num_sent], UT_REQ_LEN, "%.*s", (int)req->len, req->buf);
+	g_sent_client[g_num_sent++] = client->id;
+	snprintf(client->request, sizeof(client->request), "%.*s", (int)req->len, req->buf);
+	/* Requests sent over the main connection are completed immediately */
+	client->response_ready = client->id == 0;
+	free(req);
+
+	return 0;
+}
+
+int
+spdk_jsonrpc_client_poll(struct spdk_jsonrpc_client *client, int timeout)
+{
+	if (!client->connected) {
+		client->connected = true;
+		return -ENOTCONN;
+	}
+
+	if (g_poll_rc != 0 && client->request[0] != '\0') {
+		return g_poll_rc;
+	}
+
+	return client->response_ready ? 1 : 0;
+}
+
+struct spdk_jsonrpc_client_response *
+spdk_jsonrpc_client_get_response(struct spdk_jsonrpc_client *client)
+{
+	struct spdk_jsonrpc_client_response *resp;
+
+	CU_ASSERT(client->response_ready);
+	resp = calloc(1, sizeof(*resp));
+	SPDK_CU_ASSERT_FATAL(resp != NULL);
+	if (client->error) {
+		resp->error = &g_error_val;
+	}
+
+	client->request[0] = '\0';
+	client->response_ready = false;
+	client->error = false;
+
+	return resp;
+}
+
+void
+spdk_jsonrpc_client_free_response(struct spdk_jsonrpc_client_response *resp)
+{
+	free(resp);
+}
+
+static void
+ut_load_done(int rc, void *ctx)
+{
+	g_load_rc = rc;
+	g_load_done++;
+}
+
+static void
+ut_poll(void)
+{
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		spdk_delay_us(100);
+		poll_threads();
+	}
+}
+
+/* Respond to the request on one of the additional connections which contains the string */
+static void
+ut_complete(const char *str, bool error)
+{
+	struct spdk_jsonrpc_client *client;
+	int i, found = 0;
+
+	for (i = 1; i < g_num_clients; i++) {
+		client = g_clients[i];
+		if (client != NULL && !client->response_ready && strstr(client->request, str) != NULL) {
+			client->response_ready = true;
+			client->error = error;
+			found++;
+		}
+	}
+
+	CU_ASSERT(found == 1);
+}
+
+static bool
+ut_sent(int idx, int client_id, const char *str)
+{
+	return idx < g_num_sent && g_sent_client[idx] == client_id && strstr(g_sent[idx], str) != NULL;
+}
+
+static void
+ut_start(uint32_t max_concurrent_rpcs, bool stop_on_error)
+{
+	memset(g_clients, 0, sizeof(g_clients));
+	g_num_clients = 0;
+	g_num_sent = 0;
+	g_send_fail_idx = -1;
+	g_poll_rc = 0;
+	g_load_rc = 0;
+	g_load_done = 0;
+	g_rpc_state = SPDK_RPC_STARTUP;
+
+	CU_ASSERT(spdk_subsystem_set_json_config_max_concurrent_rpcs(max_concurrent_rpcs) == 0);
+	spdk_subsystem_init_from_json_config(g_config_file, "/ut_rpc.sock", ut_load_done, NULL,
+					     stop_on_error);
+	ut_poll();
+}
+
+static void
+test_load_sequential(void)
+{
+	const char *names[] = { "bdev_set_options", "Malloc0", "Malloc1", "Malloc0", "Malloc2",
+				"Null0", "Null1", "bdev_wait_for_examine"
+			      };
+	int i;
+
+	/* Without the additional connections all entries go over the main one, in order */
+	ut_start(1, true);
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == 0);
+	CU_ASSERT(g_num_clients == 1);
+	CU_ASSERT(g_open_clients == 0);
+	CU_ASSERT(g_num_sent == SPDK_COUNTOF(names));
+	for (i = 0; i < (int)SPDK_COUNTOF(names); i++) {
+		CU_ASSERT(ut_sent(i, 0, names[i]));
+	}
+}
+
+static void
+test_load_batch(void)
+{
+	ut_start(2, true);
+	CU_ASSERT(g_num_clients == 3);
+
+	/* The STARTUP entry went over the main connection, the first two malloc entries were sent
+	 * concurrently and the duplicate Malloc0 waits */
+	CU_ASSERT(g_num_sent == 3);
+	CU_ASSERT(ut_sent(0, 0, "bdev_set_options"));
+	CU_ASSERT(ut_sent(1, 1, "Malloc0"));
+	CU_ASSERT(ut_sent(2, 2, "Malloc1"));
+
+	/* Free lane, but the next entry still waits for the first Malloc0, and so does Malloc2 */
+	ut_complete("Malloc1", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 3);
+
+	/* Both lanes are reused for the remaining malloc entries */
+	ut_complete("Malloc0", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 5);
+	CU_ASSERT(ut_sent(3, 1, "Malloc0"));
+	CU_ASSERT(ut_sent(4, 2, "Malloc2"));
+
+	/* The null entries are not sent until the whole malloc batch is done */
+	ut_complete("Malloc2", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 5);
+	ut_complete("Malloc0", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 7);
+	CU_ASSERT(ut_sent(5, 1, "Null0"));
+	CU_ASSERT(ut_sent(6, 2, "Null1"));
+	CU_ASSERT(g_load_done == 0);
+
+	/* The last entry goes over the main connection again once the null batch is done */
+	ut_complete("Null1", false);
+	ut_complete("Null0", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 8);
+	CU_ASSERT(ut_sent(7, 0, "bdev_wait_for_examine"));
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == 0);
+	CU_ASSERT(g_open_clients == 0);
+}
+
+static void
+test_load_batch_error(void)
+{
+	/* An error response in the middle of a batch stops loading the configuration */
+	ut_start(2, true);
+	CU_ASSERT(g_num_sent == 3);
+	ut_complete("Malloc1", true);
+	ut_poll();
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == -EINVAL);
+	CU_ASSERT(g_num_sent == 3);
+	CU_ASSERT(g_open_clients == 0);
+
+	/* Unless errors are ignored */
+	ut_start(2, false);
+	ut_complete("Malloc1", true);
+	ut_complete("Malloc0", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 5);
+	ut_complete("Malloc0", true);
+	ut_complete("Malloc2", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 7);
+	ut_complete("Null0", false);
+	ut_complete("Null1", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 8);
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == 0);
+	CU_ASSERT(g_open_clients == 0);
+
+	/* Failure to send one of the entries of a batch */
+	ut_start(2, true);
+	g_send_fail_idx = 4;
+	ut_complete("Malloc1", false);
+	ut_complete("Malloc0", false);
+	ut_poll();
+	CU_ASSERT(g_num_sent == 4);
+	CU_ASSERT(ut_sent(3, 1, "Malloc0"));
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == -EIO);
+	CU_ASSERT(g_open_clients == 0);
+
+	/* Failure of one of the connections busy with an entry */
+	ut_start(2, true);
+	g_poll_rc = -EIO;
+	ut_poll();
+	CU_ASSERT(g_num_sent == 3);
+	CU_ASSERT(g_load_done == 1);
+	CU_ASSERT(g_load_rc == -EIO);
+	CU_ASSERT(g_open_clients == 0);
+}
+
+static int
+test_setup(void)
+{
+	FILE *file;
+	int fd;
+
+	snprintf(g_config_file, sizeof(g_config_file), "/tmp/json_config_ut.XXXXXX");
+	fd = mkstemp(g_config_file);
+	if (fd < 0) {
+		return -1;
+	}
+
+	file = fdopen(fd, "w");
+	if (file == NULL) {
+		close(fd);
+		return -1;
+	}
+
+	fputs(g_ut_config, file);
+	fclose(file);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	free_threads();
+	unlink(g_config_file);
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("json_config", test_setup, test_cleanup);
+
+	CU_ADD_TEST(suite, test_load_sequential);
+	CU_ADD_TEST(suite, test_load_batch);
+	CU_ADD_TEST(suite, test_load_batch_error);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
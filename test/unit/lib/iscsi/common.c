@@ -125,7 +125,7 @@ spdk_scsi_dev_queue_task(struct spdk_scsi_dev *dev, struct spdk_scsi_task *task)
 	lun = TAILQ_FIRST(&dev->luns);
 	SPDK_CU_ASSERT_FATAL(lun != NULL);
 
-	TAILQ_INSERT_TAIL(&lun->tasks, task, scsi_link);
+	TAILQ_INSERT_TAIL(&lun->channels->tasks, task, scsi_link);
 }
 
 DEFINE_STUB(spdk_scsi_dev_find_port_by_id, struct spdk_scsi_port *,
@@ -6,7 +6,8 @@
 
 #include "spdk/stdinc.h"
 
-#include "common/lib/test_env.c"
+#include "thread/thread_internal.h"
+#include "common/lib/ut_multithread.c"
 #include "spdk_internal/cunit.h"
 
 #include "iscsi/conn.c"
@@ -22,8 +23,16 @@ DEFINE_STUB(iscsi_get_pdu, struct spdk_iscsi_pdu *,
 DEFINE_STUB(iscsi_param_eq_val, int,
 	    (struct iscsi_param *params, const char *key, const char *val), 0);
 DEFINE_STUB(iscsi_pdu_calc_data_digest, uint32_t, (struct spdk_iscsi_pdu *pdu), 0);
-DEFINE_STUB_V(spdk_sock_writev_async,
-	      (struct spdk_sock *sock, struct spdk_sock_request *req));
+
+static struct spdk_sock_request *g_sock_reqs[8];
+static int g_num_sock_reqs;
+
+void
+spdk_sock_writev_async(struct spdk_sock *sock, struct spdk_sock_request *req)
+{
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs < (int)SPDK_COUNTOF(g_sock_reqs));
+	g_sock_reqs[g_num_sock_reqs++] = req;
+}
 
 struct spdk_scsi_lun {
 	uint8_t reserved;
@@ -206,10 +215,20 @@ iscsi_del_transfer_task(struct spdk_iscsi_conn *conn, uint32_t task_tag)
 	return true;
 }
 
-DEFINE_STUB(iscsi_handle_incoming_pdus, int, (struct spdk_iscsi_conn *conn), 0);
+static int g_handle_incoming_pdus_cnt;
+
+int
+iscsi_handle_incoming_pdus(struct spdk_iscsi_conn *conn)
+{
+	g_handle_incoming_pdus_cnt++;
+	return 0;
+}
 
 DEFINE_STUB_V(iscsi_free_sess, (struct spdk_iscsi_sess *sess));
 
+DEFINE_STUB_V(iscsi_sess_fill_cmdsn, (struct spdk_iscsi_sess *sess, uint32_t *exp_cmd_sn,
+				      uint32_t *max_cmd_sn, bool open_window));
+
 DEFINE_STUB(iscsi_tgt_node_cleanup_luns, int,
 	    (struct spdk_iscsi_conn *conn, struct spdk_iscsi_tgt_node *target),
 	    0);
@@ -886,6 +905,373 @@ abort_queued_datain_tasks_test(void)
 	g_new_task = NULL;
 }
 
+static void
+poll_group_load_test(void)
+{
+	struct spdk_iscsi_poll_group pg1 = {}, pg2 = {}, pg3 = {};
+
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+	TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, &pg1, link);
+	TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, &pg2, link);
+	TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, &pg3, link);
+
+	/* All poll groups are idle. The first one wins. */
+	CU_ASSERT(iscsi_poll_group_cmp_load(&pg1, &pg2) == 0);
+	CU_ASSERT(iscsi_get_least_loaded_pg() == &pg1);
+
+	/* Outstanding tasks and scheduled connections both count. */
+	pg1.outstanding_tasks = 4;
+	pg2.num_conns = 2;
+	CU_ASSERT(iscsi_poll_group_cmp_load(&pg1, &pg2) > 0);
+	CU_ASSERT(iscsi_poll_group_cmp_load(&pg2, &pg1) < 0);
+	CU_ASSERT(iscsi_get_least_loaded_pg() == &pg3);
+
+	/* Small differences in busy time are ignored. */
+	pg3.busy_pct = ISCSI_POLL_GROUP_BUSY_PCT_HYSTERESIS;
+	CU_ASSERT(iscsi_get_least_loaded_pg() == &pg3);
+
+	/* Large differences in busy time take precedence over tasks. */
+	pg3.busy_pct = 90;
+	pg1.busy_pct = 20;
+	pg2.busy_pct = 50;
+	CU_ASSERT(iscsi_poll_group_cmp_load(&pg3, &pg1) > 0);
+	CU_ASSERT(iscsi_get_least_loaded_pg() == &pg1);
+
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+}
+
+static void
+conn_quiesce_test(void)
+{
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_poll_group pg = {};
+	struct spdk_iscsi_task task = {};
+	struct spdk_iscsi_pdu pdu = {};
+
+	TAILQ_INIT(&conn.write_pdu_list);
+	TAILQ_INIT(&conn.queued_r2t_tasks);
+	TAILQ_INIT(&conn.queued_datain_tasks);
+	TAILQ_INIT(&conn.luns);
+	conn.pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY;
+
+	/* Not migrating. Keep reading. */
+	CU_ASSERT(!iscsi_conn_is_quiescing(&conn));
+	CU_ASSERT(!iscsi_conn_is_quiesced(&conn));
+
+	conn.migrate_pg = &pg;
+	CU_ASSERT(iscsi_conn_is_quiescing(&conn));
+	CU_ASSERT(iscsi_conn_is_quiesced(&conn));
+
+	/* Data-Out PDUs are still expected. Keep reading. */
+	conn.pending_r2t = 1;
+	CU_ASSERT(!iscsi_conn_is_quiescing(&conn));
+	conn.pending_r2t = 0;
+
+	/* In the middle of a PDU. */
+	conn.pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD;
+	CU_ASSERT(!iscsi_conn_is_quiescing(&conn));
+	conn.pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_PDU_READY;
+
+	/* Stop reading but wait for outstanding tasks and PDUs. */
+	conn.pending_task_cnt = 1;
+	CU_ASSERT(iscsi_conn_is_quiescing(&conn));
+	CU_ASSERT(!iscsi_conn_is_quiesced(&conn));
+	conn.pending_task_cnt = 0;
+
+	TAILQ_INSERT_TAIL(&conn.queued_datain_tasks, &task, link);
+	CU_ASSERT(!iscsi_conn_is_quiesced(&conn));
+	TAILQ_REMOVE(&conn.queued_datain_tasks, &task, link);
+
+	TAILQ_INSERT_TAIL(&conn.write_pdu_list, &pdu, tailq);
+	CU_ASSERT(!iscsi_conn_is_quiesced(&conn));
+	TAILQ_REMOVE(&conn.write_pdu_list, &pdu, tailq);
+
+	CU_ASSERT(iscsi_conn_is_quiesced(&conn));
+}
+
+static int g_write_pdu_cpl_cnt;
+
+static void
+ut_write_pdu_cpl(void *cb_arg)
+{
+	g_write_pdu_cpl_cnt++;
+}
+
+static struct spdk_iscsi_pdu *g_ut_next_pdus[2];
+
+/* Write the next PDUs from the completion of a PDU, as refilling the Data-In tasks does. */
+static void
+ut_write_pdu_cpl_write_next(void *cb_arg)
+{
+	struct spdk_iscsi_conn *conn = cb_arg;
+	uint32_t i;
+
+	g_write_pdu_cpl_cnt++;
+	for (i = 0; i < SPDK_COUNTOF(g_ut_next_pdus); i++) {
+		iscsi_conn_write_pdu(conn, g_ut_next_pdus[i], ut_write_pdu_cpl, NULL);
+	}
+}
+
+static void
+write_pdu_batch_test(void)
+{
+	struct spdk_iscsi_conn conn = {};
+	struct spdk_iscsi_pdu pdu1 = {}, pdu2 = {}, pdu3 = {};
+	struct spdk_iscsi_pdu pdus[ISCSI_WRITE_BATCH_IOVCNT / SPDK_ISCSI_MAX_SGL_DESCRIPTORS + 1] = {};
+	struct spdk_sock_request *req;
+	uint32_t i;
+
+	TAILQ_INIT(&conn.write_pdu_list);
+	STAILQ_INIT(&conn.free_write_batches);
+	conn.state = ISCSI_CONN_STATE_RUNNING;
+	pdu1.conn = &conn;
+	pdu1.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	pdu2.conn = &conn;
+	pdu2.bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+	pdu3.conn = &conn;
+	pdu3.bhs.opcode = ISCSI_OP_SCSI_RSP;
+	g_num_sock_reqs = 0;
+	g_write_pdu_cpl_cnt = 0;
+	MOCK_SET(iscsi_build_iovs, 3);
+
+	/* PDUs written inside a batch go out by a single request. */
+	iscsi_conn_write_batch_begin(&conn);
+	iscsi_conn_write_pdu(&conn, &pdu1, ut_write_pdu_cpl, NULL);
+	iscsi_conn_write_batch_begin(&conn);
+	iscsi_conn_write_pdu(&conn, &pdu2, ut_write_pdu_cpl, NULL);
+	iscsi_conn_write_batch_end(&conn);
+	CU_ASSERT(g_num_sock_reqs == 0);
+	iscsi_conn_write_pdu(&conn, &pdu3, ut_write_pdu_cpl, NULL);
+	CU_ASSERT(g_num_sock_reqs == 0);
+	iscsi_conn_write_batch_end(&conn);
+
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs == 1);
+	req = g_sock_reqs[0];
+	CU_ASSERT(req->iovcnt == 9);
+	CU_ASSERT(conn.write_batch == NULL);
+
+	/* Every PDU completes in order by the completion of the request. */
+	req->cb_fn(req->cb_arg, 0);
+	CU_ASSERT(g_write_pdu_cpl_cnt == 3);
+	CU_ASSERT(TAILQ_EMPTY(&conn.write_pdu_list));
+	CU_ASSERT(!STAILQ_EMPTY(&conn.free_write_batches));
+
+	/* A PDU written outside of a batch goes out by itself. */
+	g_num_sock_reqs = 0;
+	iscsi_conn_write_pdu(&conn, &pdu1, ut_write_pdu_cpl, NULL);
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs == 1);
+	CU_ASSERT(g_sock_reqs[0] == &pdu1.sock_req);
+	g_sock_reqs[0]->cb_fn(g_sock_reqs[0]->cb_arg, 0);
+	CU_ASSERT(g_write_pdu_cpl_cnt == 4);
+
+	/* PDUs written by the completions of a batch are batched too. */
+	g_num_sock_reqs = 0;
+	g_ut_next_pdus[0] = &pdu2;
+	g_ut_next_pdus[1] = &pdu3;
+	iscsi_conn_write_batch_begin(&conn);
+	iscsi_conn_write_pdu(&conn, &pdu1, ut_write_pdu_cpl_write_next, &conn);
+	iscsi_conn_write_batch_end(&conn);
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs == 1);
+	g_sock_reqs[0]->cb_fn(g_sock_reqs[0]->cb_arg, 0);
+	CU_ASSERT(g_write_pdu_cpl_cnt == 5);
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs == 2);
+	CU_ASSERT(g_sock_reqs[1] != &pdu2.sock_req);
+	CU_ASSERT(g_sock_reqs[1]->iovcnt == 6);
+	g_sock_reqs[1]->cb_fn(g_sock_reqs[1]->cb_arg, 0);
+	CU_ASSERT(g_write_pdu_cpl_cnt == 7);
+	CU_ASSERT(TAILQ_EMPTY(&conn.write_pdu_list));
+
+	/* A PDU which does not fit flushes the current batch first. */
+	g_num_sock_reqs = 0;
+	g_write_pdu_cpl_cnt = 0;
+	MOCK_SET(iscsi_build_iovs, SPDK_ISCSI_MAX_SGL_DESCRIPTORS);
+	iscsi_conn_write_batch_begin(&conn);
+	for (i = 0; i < SPDK_COUNTOF(pdus); i++) {
+		pdus[i].conn = &conn;
+		pdus[i].bhs.opcode = ISCSI_OP_SCSI_DATAIN;
+		iscsi_conn_write_pdu(&conn, &pdus[i], ut_write_pdu_cpl, NULL);
+	}
+	CU_ASSERT(g_num_sock_reqs == 1);
+	iscsi_conn_write_batch_end(&conn);
+	SPDK_CU_ASSERT_FATAL(g_num_sock_reqs == 2);
+	CU_ASSERT(g_sock_reqs[0]->iovcnt == (SPDK_COUNTOF(pdus) - 1) * SPDK_ISCSI_MAX_SGL_DESCRIPTORS);
+	CU_ASSERT(g_sock_reqs[1]->iovcnt == SPDK_ISCSI_MAX_SGL_DESCRIPTORS);
+	CU_ASSERT(g_sock_reqs[0] != g_sock_reqs[1]);
+
+	g_sock_reqs[0]->cb_fn(g_sock_reqs[0]->cb_arg, 0);
+	g_sock_reqs[1]->cb_fn(g_sock_reqs[1]->cb_arg, 0);
+	CU_ASSERT(g_write_pdu_cpl_cnt == SPDK_COUNTOF(pdus));
+	CU_ASSERT(TAILQ_EMPTY(&conn.write_pdu_list));
+
+	MOCK_CLEAR(iscsi_build_iovs);
+	iscsi_conn_free_write_batches(&conn);
+}
+
+static struct spdk_iscsi_poll_group *
+ut_alloc_pg(uintptr_t thread_id)
+{
+	struct spdk_io_channel *ch;
+
+	ch = calloc(1, sizeof(*ch) + sizeof(struct spdk_iscsi_poll_group));
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	ch->thread = g_ut_threads[thread_id].thread;
+
+	return spdk_io_channel_get_ctx(ch);
+}
+
+static void
+ut_resume_cmdsn(struct spdk_iscsi_sess *sess, struct spdk_iscsi_conn *conn)
+{
+	TAILQ_INSERT_TAIL(&sess->cmdsn_waiters, conn, cmdsn_link);
+	conn->cmdsn_waiting = true;
+	iscsi_sess_resume_cmdsn_waiters(sess);
+	CU_ASSERT(!conn->cmdsn_waiting);
+	CU_ASSERT(TAILQ_EMPTY(&sess->cmdsn_waiters));
+}
+
+static void
+resume_cmdsn_test(void)
+{
+	struct spdk_iscsi_sess sess = {};
+	struct spdk_iscsi_poll_group *pg0, *pg1;
+	struct spdk_iscsi_conn *conn;
+	int rc;
+
+	allocate_threads(2);
+	set_thread(0);
+	pg0 = ut_alloc_pg(0);
+	pg1 = ut_alloc_pg(1);
+	TAILQ_INIT(&sess.cmdsn_waiters);
+
+	rc = initialize_iscsi_conns();
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	conn = allocate_conn();
+	SPDK_CU_ASSERT_FATAL(conn != NULL);
+	conn->pg = pg0;
+	conn->sess = &sess;
+	conn->state = ISCSI_CONN_STATE_RUNNING;
+	conn->pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_CMDSN;
+	g_handle_incoming_pdus_cnt = 0;
+
+	/* The waiting connection is resumed on its thread. */
+	ut_resume_cmdsn(&sess, conn);
+	poll_thread(1);
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 0);
+	poll_thread(0);
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 1);
+
+	/* The connection moved to another thread before it was resumed. */
+	ut_resume_cmdsn(&sess, conn);
+	conn->pg = pg1;
+	poll_thread(0);
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 1);
+	poll_thread(1);
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 2);
+	conn->pg = pg0;
+
+	/* The connection was freed before it was resumed. */
+	ut_resume_cmdsn(&sess, conn);
+	free_conn(conn);
+	poll_threads();
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 2);
+
+	/* The connection was freed, then reused by a new one. */
+	conn = allocate_conn();
+	SPDK_CU_ASSERT_FATAL(conn != NULL);
+	conn->pg = pg0;
+	conn->state = ISCSI_CONN_STATE_RUNNING;
+	conn->pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_CMDSN;
+	ut_resume_cmdsn(&sess, conn);
+	free_conn(conn);
+	TAILQ_REMOVE(&g_free_conns, conn, conn_link);
+	TAILQ_INSERT_HEAD(&g_free_conns, conn, conn_link);
+	SPDK_CU_ASSERT_FATAL(allocate_conn() == conn);
+	conn->pg = pg0;
+	conn->state = ISCSI_CONN_STATE_RUNNING;
+	conn->pdu_recv_state = ISCSI_PDU_RECV_STATE_AWAIT_CMDSN;
+	poll_threads();
+	CU_ASSERT(g_handle_incoming_pdus_cnt == 2);
+
+	free_conn(conn);
+	TAILQ_INIT(&g_free_conns);
+	_iscsi_conns_cleanup();
+	free(spdk_io_channel_from_ctx(pg0));
+	free(spdk_io_channel_from_ctx(pg1));
+	free_threads();
+}
+
+static void
+schedule_mcs_conns_test(void)
+{
+	struct spdk_iscsi_tgt_node target = {};
+	struct spdk_iscsi_sess sess1 = {}, sess2 = {};
+	struct spdk_iscsi_conn *conns1[2], *conns2[1];
+	struct spdk_iscsi_conn conn1 = {}, conn2 = {}, conn3 = {};
+	struct spdk_iscsi_poll_group *pg0, *pg1;
+	int sock;
+
+	allocate_threads(2);
+	set_thread(0);
+	pg0 = ut_alloc_pg(0);
+	pg1 = ut_alloc_pg(1);
+	STAILQ_INIT(&pg0->connections);
+	STAILQ_INIT(&pg1->connections);
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+	TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, pg0, link);
+	TAILQ_INSERT_TAIL(&g_iscsi.poll_group_head, pg1, link);
+	g_iscsi.conn_placement = ISCSI_CONN_PLACEMENT_ROUND_ROBIN;
+	pthread_mutex_init(&target.mutex, NULL);
+
+	/* Session 1 has two connections, session 2 has one, all to the same target. */
+	conns1[0] = &conn1;
+	conns1[1] = &conn2;
+	conns2[0] = &conn3;
+	pthread_mutex_init(&sess1.lock, NULL);
+	sess1.session_type = SESSION_TYPE_NORMAL;
+	sess1.target = &target;
+	sess1.conns = conns1;
+	sess1.connections = 2;
+	pthread_mutex_init(&sess2.lock, NULL);
+	sess2.session_type = SESSION_TYPE_NORMAL;
+	sess2.target = &target;
+	sess2.conns = conns2;
+	sess2.connections = 1;
+	conn1.sess = &sess1;
+	conn2.sess = &sess1;
+	conn3.sess = &sess2;
+	conn1.sock = conn2.sock = conn3.sock = (struct spdk_sock *)&sock;
+
+	/* Connections start on the acceptor's poll group. */
+	conn1.pg = conn2.pg = conn3.pg = pg0;
+	STAILQ_INSERT_TAIL(&pg0->connections, &conn1, pg_link);
+	STAILQ_INSERT_TAIL(&pg0->connections, &conn2, pg_link);
+	STAILQ_INSERT_TAIL(&pg0->connections, &conn3, pg_link);
+
+	/* The connections of a session are spread over the poll groups. */
+	iscsi_conn_schedule(&conn1);
+	CU_ASSERT(conn1.pg == pg0);
+	iscsi_conn_schedule(&conn2);
+	CU_ASSERT(conn2.pg == pg1);
+
+	/* Other sessions to the target still use the poll group of the target. */
+	iscsi_conn_schedule(&conn3);
+	CU_ASSERT(conn3.pg == pg0);
+	CU_ASSERT(target.num_active_conns == 3);
+
+	poll_threads();
+	CU_ASSERT(pg0->num_conns == 2);
+	CU_ASSERT(pg1->num_conns == 1);
+	CU_ASSERT(STAILQ_FIRST(&pg1->connections) == &conn2);
+
+	TAILQ_INIT(&g_iscsi.poll_group_head);
+	pthread_mutex_destroy(&sess1.lock);
+	pthread_mutex_destroy(&sess2.lock);
+	pthread_mutex_destroy(&target.mutex);
+	free(spdk_io_channel_from_ctx(pg0));
+	free(spdk_io_channel_from_ctx(pg1));
+	free_threads();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -904,6 +1290,11 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, free_tasks_with_queued_datain);
 	CU_ADD_TEST(suite, abort_queued_datain_task_test);
 	CU_ADD_TEST(suite, abort_queued_datain_tasks_test);
+	CU_ADD_TEST(suite, poll_group_load_test);
+	CU_ADD_TEST(suite, conn_quiesce_test);
+	CU_ADD_TEST(suite, write_pdu_batch_test);
+	CU_ADD_TEST(suite, resume_cmdsn_test);
+	CU_ADD_TEST(suite, schedule_mcs_conns_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
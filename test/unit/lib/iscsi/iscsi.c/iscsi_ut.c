@@ -91,6 +91,20 @@ DEFINE_STUB(iscsi_chap_get_authinfo, int,
 
 DEFINE_STUB(spdk_sock_set_recvbuf, int, (struct spdk_sock *sock, int sz), 0);
 
+static int g_resume_cmdsn_waiters;
+
+void
+iscsi_sess_resume_cmdsn_waiters(struct spdk_iscsi_sess *sess)
+{
+	struct spdk_iscsi_conn *conn;
+
+	while ((conn = TAILQ_FIRST(&sess->cmdsn_waiters)) != NULL) {
+		TAILQ_REMOVE(&sess->cmdsn_waiters, conn, cmdsn_link);
+		conn->cmdsn_waiting = false;
+		g_resume_cmdsn_waiters++;
+	}
+}
+
 int
 spdk_scsi_lun_get_id(const struct spdk_scsi_lun *lun)
 {
@@ -2182,9 +2196,9 @@ check_write_subtask_submit(struct spdk_scsi_lun *lun, struct spdk_mobj *mobj,
 	uint32_t *data;
 	uint32_t i;
 
-	scsi_task = TAILQ_FIRST(&lun->tasks);
+	scsi_task = TAILQ_FIRST(&lun->channels->tasks);
 	SPDK_CU_ASSERT_FATAL(scsi_task != NULL);
-	TAILQ_REMOVE(&lun->tasks, scsi_task, scsi_link);
+	TAILQ_REMOVE(&lun->channels->tasks, scsi_task, scsi_link);
 
 	subtask = iscsi_task_from_scsi_task(scsi_task);
 
@@ -2206,7 +2220,8 @@ check_write_subtask_submit(struct spdk_scsi_lun *lun, struct spdk_mobj *mobj,
 static void
 data_out_pdu_sequence_test(void)
 {
-	struct spdk_scsi_lun lun = { .tasks = TAILQ_HEAD_INITIALIZER(lun.tasks), };
+	struct spdk_scsi_lun_channel lun_ch = { .tasks = TAILQ_HEAD_INITIALIZER(lun_ch.tasks), };
+	struct spdk_scsi_lun lun = { .channels = &lun_ch, };
 	struct spdk_scsi_dev dev = { .luns = TAILQ_HEAD_INITIALIZER(dev.luns), };
 	struct spdk_iscsi_sess sess = {
 		.session_type = SESSION_TYPE_NORMAL,
@@ -2355,7 +2370,7 @@ data_out_pdu_sequence_test(void)
 	check_write_subtask_submit(&lun, &mobj3, &pdu, 1, 2 * SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH,
 				   SPDK_ISCSI_MAX_RECV_DATA_SEGMENT_LENGTH / 2);
 
-	CU_ASSERT(TAILQ_EMPTY(&lun.tasks));
+	CU_ASSERT(TAILQ_EMPTY(&lun_ch.tasks));
 
 	MOCK_CLEAR(spdk_mempool_get);
 
@@ -2367,7 +2382,8 @@ data_out_pdu_sequence_test(void)
 static void
 immediate_data_and_data_out_pdu_sequence_test(void)
 {
-	struct spdk_scsi_lun lun = { .tasks = TAILQ_HEAD_INITIALIZER(lun.tasks), };
+	struct spdk_scsi_lun_channel lun_ch = { .tasks = TAILQ_HEAD_INITIALIZER(lun_ch.tasks), };
+	struct spdk_scsi_lun lun = { .channels = &lun_ch, };
 	struct spdk_scsi_dev dev = { .luns = TAILQ_HEAD_INITIALIZER(dev.luns), };
 	struct spdk_iscsi_sess sess = {
 		.session_type = SESSION_TYPE_NORMAL,
@@ -2579,7 +2595,7 @@ immediate_data_and_data_out_pdu_sequence_test(void)
 
 	check_write_subtask_submit(&lun, &mobj, &pdu, 0, 0, 65536);
 
-	CU_ASSERT(TAILQ_EMPTY(&lun.tasks));
+	CU_ASSERT(TAILQ_EMPTY(&lun_ch.tasks));
 
 	MOCK_CLEAR(spdk_mempool_get);
 
@@ -2587,6 +2603,97 @@ immediate_data_and_data_out_pdu_sequence_test(void)
 	free(mobj.buf);
 }
 
+static void
+set_cmdsn_pdu(struct spdk_iscsi_pdu *pdu, uint8_t opcode, bool immediate, uint32_t cmd_sn)
+{
+	struct iscsi_bhs_scsi_req *reqh = (struct iscsi_bhs_scsi_req *)&pdu->bhs;
+
+	memset(pdu, 0, sizeof(*pdu));
+	reqh->opcode = opcode;
+	reqh->immediate = immediate;
+	to_be32(&reqh->cmd_sn, cmd_sn);
+}
+
+static void
+mcs_cmdsn_order_test(void)
+{
+	struct spdk_iscsi_sess sess = {};
+	struct spdk_iscsi_conn conn1 = {}, conn2 = {};
+	struct spdk_iscsi_pdu pdu1, pdu2;
+	int rc;
+
+	pthread_mutex_init(&sess.lock, NULL);
+	TAILQ_INIT(&sess.cmdsn_waiters);
+	sess.session_type = SESSION_TYPE_NORMAL;
+	sess.connections = 2;
+	sess.ExpCmdSN = 10;
+	sess.MaxCmdSN = 20;
+	conn1.sess = &sess;
+	conn2.sess = &sess;
+	g_resume_cmdsn_waiters = 0;
+
+	/* Case 1 - A command ahead of ExpCmdSN waits for the commands before it. */
+	set_cmdsn_pdu(&pdu2, ISCSI_OP_SCSI, false, 11);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn2, &pdu2) == true);
+	CU_ASSERT(conn2.cmdsn_waiting == true);
+	CU_ASSERT(TAILQ_FIRST(&sess.cmdsn_waiters) == &conn2);
+
+	/* Checking again does not queue the connection twice. */
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn2, &pdu2) == true);
+	CU_ASSERT(TAILQ_NEXT(&conn2, cmdsn_link) == NULL);
+
+	/* Case 2 - Immediate commands, Data-Out and SNACK PDUs never wait. */
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI, true, 11);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI_DATAOUT, false, 15);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SNACK, false, 15);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	rc = iscsi_update_cmdsn(&conn1, &pdu1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sess.ExpCmdSN == 10);
+
+	/* Case 3 - The command at ExpCmdSN is delivered and resumes the waiters. */
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI, false, 10);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	rc = iscsi_update_cmdsn(&conn1, &pdu1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sess.ExpCmdSN == 11);
+	CU_ASSERT(g_resume_cmdsn_waiters == 1);
+	CU_ASSERT(conn2.cmdsn_waiting == false);
+	CU_ASSERT(TAILQ_EMPTY(&sess.cmdsn_waiters));
+
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn2, &pdu2) == false);
+	rc = iscsi_update_cmdsn(&conn2, &pdu2);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sess.ExpCmdSN == 12);
+
+	/* Case 4 - Commands outside of the window do not wait and are rejected. */
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI, false, 21);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	rc = iscsi_update_cmdsn(&conn1, &pdu1);
+	CU_ASSERT(rc == SPDK_PDU_FATAL);
+	CU_ASSERT(sess.ExpCmdSN == 12);
+
+	/* Case 5 - Commands of a single connection session never wait, and
+	 *  ExpCmdSN only advances by one even if a command is ahead of it.
+	 */
+	sess.connections = 1;
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI, false, 13);
+	CU_ASSERT(iscsi_conn_wait_cmdsn(&conn1, &pdu1) == false);
+	CU_ASSERT(conn1.cmdsn_waiting == false);
+	rc = iscsi_update_cmdsn(&conn1, &pdu1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sess.ExpCmdSN == 13);
+
+	set_cmdsn_pdu(&pdu1, ISCSI_OP_SCSI, false, 13);
+	rc = iscsi_update_cmdsn(&conn1, &pdu1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(sess.ExpCmdSN == 14);
+
+	pthread_mutex_destroy(&sess.lock);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -2621,6 +2728,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, pdu_payload_read_test);
 	CU_ADD_TEST(suite, data_out_pdu_sequence_test);
 	CU_ADD_TEST(suite, immediate_data_and_data_out_pdu_sequence_test);
+	CU_ADD_TEST(suite, mcs_cmdsn_order_test);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
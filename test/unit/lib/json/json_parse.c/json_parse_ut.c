@@ -168,6 +168,17 @@ test_parse_string_simple(void)
 	/* Trailing comma */
 	PARSE_PASS("\"hello world\",", 1, ",");
 	VAL_STRING("hello world");
+
+	/* Strings and whitespace longer than the vectorized scans, special characters at each end */
+	PARSE_PASS("                                  \"0123456789abcdefghijklmnopqrstuvwxyz\"  \t\r\n", 1, "");
+	VAL_STRING("0123456789abcdefghijklmnopqrstuvwxyz");
+	STR_PASS("0123456789abcdefghijklmnopqrstuvwxyz\\n", "0123456789abcdefghijklmnopqrstuvwxyz\n");
+	STR_PASS("\\n0123456789abcdefghijklmnopqrstuvwxyz", "\n0123456789abcdefghijklmnopqrstuvwxyz");
+	STR_PASS("0123456789abcdefg\\\"0123456789abcdefg", "0123456789abcdefg\"0123456789abcdefg");
+	STR_PASS("0123456789abcdefg\xC3\xA9" "0123456789abcdefg",
+		 "0123456789abcdefg\xC3\xA9" "0123456789abcdefg");
+	STR_FAIL("0123456789abcdefg\x01" "0123456789abcdefg", SPDK_JSON_PARSE_INVALID);
+	PARSE_FAIL("\"0123456789abcdefghijklmnopqrstuvwxyz", SPDK_JSON_PARSE_INCOMPLETE);
 }
 
 static void
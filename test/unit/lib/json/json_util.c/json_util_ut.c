@@ -223,6 +223,61 @@ test_decode_object(void)
 	free(output.my_name);
 }
 
+static void
+test_decode_object_many_decoders(void)
+{
+	struct my_object {
+		uint32_t fields[JSON_DECODE_HASH_MIN_DECODERS + 2];
+	};
+	struct spdk_json_val object[] = {
+		{"", 6, SPDK_JSON_VAL_OBJECT_BEGIN},
+		{"f17", 3, SPDK_JSON_VAL_NAME},
+		{"17", 2, SPDK_JSON_VAL_NUMBER},
+		{"f3", 2, SPDK_JSON_VAL_NAME},
+		{"3", 1, SPDK_JSON_VAL_NUMBER},
+		{"dup", 3, SPDK_JSON_VAL_NAME},
+		{"1", 1, SPDK_JSON_VAL_NUMBER},
+		{"", 0, SPDK_JSON_VAL_OBJECT_END},
+	};
+	struct spdk_json_object_decoder decoders[JSON_DECODE_HASH_MIN_DECODERS + 2];
+	char names[JSON_DECODE_HASH_MIN_DECODERS + 2][8];
+	struct my_object output = {};
+	size_t i;
+
+	for (i = 0; i < SPDK_COUNTOF(decoders); i++) {
+		snprintf(names[i], sizeof(names[i]), "f%zu", i);
+		decoders[i].name = names[i];
+		decoders[i].offset = offsetof(struct my_object, fields[i]);
+		decoders[i].decode_func = spdk_json_decode_uint32;
+		decoders[i].optional = true;
+	}
+	/* With repeated names, the first decoder is used */
+	decoders[5].name = "dup";
+	decoders[9].name = "dup";
+
+	CU_ASSERT(spdk_json_decode_object(object, decoders, SPDK_COUNTOF(decoders), &output) == 0);
+	CU_ASSERT(output.fields[17] == 17);
+	CU_ASSERT(output.fields[3] == 3);
+	CU_ASSERT(output.fields[5] == 1);
+	CU_ASSERT(output.fields[9] == 0);
+
+	/* Failing Test: required field is missing */
+	decoders[4].optional = false;
+	CU_ASSERT(spdk_json_decode_object(object, decoders, SPDK_COUNTOF(decoders), &output) != 0);
+	decoders[4].optional = true;
+
+	/* Failing Test: member with no matching decoder */
+	object[3].start = "f30";
+	object[3].len = 3;
+	CU_ASSERT(spdk_json_decode_object(object, decoders, SPDK_COUNTOF(decoders), &output) != 0);
+	CU_ASSERT(spdk_json_decode_object_relaxed(object, decoders, SPDK_COUNTOF(decoders),
+			&output) == 0);
+
+	/* Failing Test: duplicated names for json values */
+	object[3].start = "f17";
+	CU_ASSERT(spdk_json_decode_object(object, decoders, SPDK_COUNTOF(decoders), &output) != 0);
+}
+
 static void
 test_free_object(void)
 {
@@ -964,6 +1019,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_num_to_int32);
 	CU_ADD_TEST(suite, test_num_to_uint64);
 	CU_ADD_TEST(suite, test_decode_object);
+	CU_ADD_TEST(suite, test_decode_object_many_decoders);
 	CU_ADD_TEST(suite, test_decode_array);
 	CU_ADD_TEST(suite, test_decode_bool);
 	CU_ADD_TEST(suite, test_decode_uint16);
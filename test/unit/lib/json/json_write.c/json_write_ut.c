@@ -845,6 +845,24 @@ test_write_val(void)
 	END("{\"a\":[1,2,3],\"b\":{\"c\":\"d\"},\"e\":true,\"f\":false,\"g\":null}");
 }
 
+static void
+test_write_flush(void)
+{
+	struct spdk_json_write_ctx *w;
+
+	BEGIN();
+	CU_ASSERT(spdk_json_write_flush(w) == 0);
+	CU_ASSERT(g_write_pos == g_buf);
+	CU_ASSERT(spdk_json_write_array_begin(w) == 0);
+	VAL_UINT32(1);
+	CU_ASSERT(spdk_json_write_flush(w) == 0);
+	CU_ASSERT(g_write_pos - g_buf == 2);
+	CU_ASSERT(memcmp(g_buf, "[1", 2) == 0);
+	VAL_UINT32(2);
+	CU_ASSERT(spdk_json_write_array_end(w) == 0);
+	END("[1,2]");
+}
+
 int
 main(int argc, char **argv)
 {
@@ -870,6 +888,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_write_object);
 	CU_ADD_TEST(suite, test_write_nesting);
 	CU_ADD_TEST(suite, test_write_val);
+	CU_ADD_TEST(suite, test_write_flush);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -162,6 +162,12 @@ jsonrpc_server_send_response(struct spdk_jsonrpc_request *request)
 {
 }
 
+void
+jsonrpc_server_send_chunk(struct spdk_jsonrpc_request *request, struct jsonrpc_send_chunk *chunk)
+{
+	jsonrpc_free_send_chunk(chunk);
+}
+
 static void
 test_parse_request(void)
 {
@@ -0,0 +1,222 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "jsonrpc/jsonrpc_server.c"
+#include "jsonrpc/jsonrpc_server_tcp.c"
+
+#define UT_REQUEST(id) "{\"jsonrpc\":\"2.0\",\"method\":\"ut\",\"id\":" #id "}"
+#define UT_RESPONSE_BEGIN(id) "{\"jsonrpc\":\"2.0\",\"id\":" #id ",\"result\":"
+
+static struct spdk_jsonrpc_request *g_request;
+static int g_sockfd = -1;
+static char g_recv_buf[4096];
+static size_t g_recv_len;
+
+static void
+ut_handle_request(struct spdk_jsonrpc_request *request, const struct spdk_json_val *method,
+		  const struct spdk_json_val *params)
+{
+	CU_ASSERT(g_request == NULL);
+	g_request = request;
+}
+
+static struct spdk_jsonrpc_request *
+ut_parse_request(struct spdk_jsonrpc_server_conn *conn, const char *json)
+{
+	struct spdk_jsonrpc_request *request;
+
+	CU_ASSERT(jsonrpc_parse_request(conn, json, strlen(json)) == (ssize_t)strlen(json));
+	request = g_request;
+	g_request = NULL;
+	SPDK_CU_ASSERT_FATAL(request != NULL);
+
+	return request;
+}
+
+static void
+ut_conn_init(struct spdk_jsonrpc_server *server, struct spdk_jsonrpc_server_conn *conn)
+{
+	int sv[2];
+
+	SPDK_CU_ASSERT_FATAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+	CU_ASSERT(fcntl(sv[1], F_SETFL, O_NONBLOCK) == 0);
+
+	memset(server, 0, sizeof(*server));
+	memset(conn, 0, sizeof(*conn));
+	server->handle_request = ut_handle_request;
+	conn->server = server;
+	conn->sockfd = sv[0];
+	pthread_spin_init(&conn->queue_lock, PTHREAD_PROCESS_PRIVATE);
+	STAILQ_INIT(&conn->send_queue);
+	STAILQ_INIT(&conn->outstanding_queue);
+
+	g_sockfd = sv[1];
+	g_recv_len = 0;
+}
+
+static void
+ut_conn_fini(struct spdk_jsonrpc_server_conn *conn)
+{
+	jsonrpc_server_conn_close(conn);
+	pthread_spin_destroy(&conn->queue_lock);
+	close(g_sockfd);
+	g_sockfd = -1;
+}
+
+/* Append everything sent on the connection so far to g_recv_buf */
+static void
+ut_recv(void)
+{
+	ssize_t rc;
+
+	while (true) {
+		rc = recv(g_sockfd, g_recv_buf + g_recv_len, sizeof(g_recv_buf) - g_recv_len - 1, 0);
+		if (rc <= 0) {
+			break;
+		}
+		g_recv_len += rc;
+	}
+	g_recv_buf[g_recv_len] = '\0';
+}
+
+static void
+test_send_chunks(void)
+{
+	struct spdk_jsonrpc_server server;
+	struct spdk_jsonrpc_server_conn conn;
+	struct spdk_jsonrpc_request *request, *next;
+	struct spdk_json_write_ctx *w;
+	size_t len;
+
+	ut_conn_init(&server, &conn);
+
+	request = ut_parse_request(&conn, UT_REQUEST(1));
+	next = ut_parse_request(&conn, UT_REQUEST(2));
+	CU_ASSERT(conn.outstanding_requests == 2);
+
+	/* Nothing is sent before the first part of the response is flushed */
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(w);
+	spdk_json_write_string(w, "a");
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	ut_recv();
+	CU_ASSERT(g_recv_len == 0);
+
+	spdk_jsonrpc_flush_result(request, w);
+	CU_ASSERT(request->streaming);
+	CU_ASSERT(!request->complete);
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	ut_recv();
+	CU_ASSERT(strcmp(g_recv_buf, UT_RESPONSE_BEGIN(1) "[\"a\"") == 0);
+	CU_ASSERT(conn.send_request == request);
+
+	/* The response of the second request is complete, but it's queued behind the first one */
+	w = spdk_jsonrpc_begin_result(next);
+	spdk_json_write_string(w, "b");
+	spdk_jsonrpc_end_result(next, w);
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	len = g_recv_len;
+	ut_recv();
+	CU_ASSERT(g_recv_len == len);
+
+	/* Several parts can be queued before they are sent */
+	w = request->response;
+	spdk_json_write_string(w, "c");
+	spdk_jsonrpc_flush_result(request, w);
+	spdk_json_write_string(w, "d");
+	spdk_jsonrpc_flush_result(request, w);
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	ut_recv();
+	CU_ASSERT(strcmp(g_recv_buf, UT_RESPONSE_BEGIN(1) "[\"a\",\"c\",\"d\"") == 0);
+	CU_ASSERT(conn.outstanding_requests == 2);
+
+	/* Once the first response is complete, both responses are sent and the requests freed */
+	spdk_json_write_string(w, "e");
+	spdk_json_write_array_end(w);
+	spdk_jsonrpc_end_result(request, w);
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	ut_recv();
+	CU_ASSERT(strcmp(g_recv_buf, UT_RESPONSE_BEGIN(1) "[\"a\",\"c\",\"d\",\"e\"]}\n"
+			 UT_RESPONSE_BEGIN(2) "\"b\"}\n") == 0);
+	CU_ASSERT(conn.outstanding_requests == 0);
+	CU_ASSERT(conn.send_request == NULL);
+
+	ut_conn_fini(&conn);
+}
+
+static void
+test_close_streaming(void)
+{
+	struct spdk_jsonrpc_server server;
+	struct spdk_jsonrpc_server_conn conn;
+	struct spdk_jsonrpc_request *streamed, *pending, *complete;
+	struct spdk_json_write_ctx *w, *pending_w;
+
+	ut_conn_init(&server, &conn);
+
+	streamed = ut_parse_request(&conn, UT_REQUEST(1));
+	pending = ut_parse_request(&conn, UT_REQUEST(2));
+	complete = ut_parse_request(&conn, UT_REQUEST(3));
+	CU_ASSERT(conn.outstanding_requests == 3);
+
+	w = spdk_jsonrpc_begin_result(streamed);
+	spdk_json_write_array_begin(w);
+	spdk_json_write_string(w, "a");
+	spdk_jsonrpc_flush_result(streamed, w);
+	CU_ASSERT(jsonrpc_server_conn_send(&conn) == 0);
+	CU_ASSERT(conn.send_request == streamed);
+
+	pending_w = spdk_jsonrpc_begin_result(pending);
+
+	w = spdk_jsonrpc_begin_result(complete);
+	spdk_json_write_string(w, "c");
+	spdk_jsonrpc_end_result(complete, w);
+
+	/* The streamed and pending requests are detached from the connection, while the complete
+	 * one is freed right away
+	 */
+	jsonrpc_server_conn_close(&conn);
+	CU_ASSERT(conn.send_request == NULL);
+	CU_ASSERT(STAILQ_EMPTY(&conn.send_queue));
+	CU_ASSERT(streamed->conn == NULL);
+	CU_ASSERT(pending->conn == NULL);
+
+	/* Their handlers can keep writing the responses, which are freed once they're complete */
+	w = streamed->response;
+	spdk_json_write_string(w, "b");
+	spdk_jsonrpc_flush_result(streamed, w);
+	CU_ASSERT(STAILQ_EMPTY(&streamed->send_chunks));
+	spdk_json_write_array_end(w);
+	spdk_jsonrpc_end_result(streamed, w);
+
+	spdk_json_write_string(pending_w, "p");
+	spdk_jsonrpc_end_result(pending, pending_w);
+
+	ut_conn_fini(&conn);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("jsonrpc_server_tcp", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_send_chunks);
+	CU_ADD_TEST(suite, test_close_streaming);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -247,6 +247,28 @@ test_prp_list_append(void)
 					    0x1000) == -EFAULT);
 	CU_ASSERT(prp_index == 2);
 
+	/* 12K buffer, 4K aligned, translated once for the whole contiguous mapping */
+	MOCK_SET(spdk_vtophys, 0x200000);
+	prp_list_prep(&tr, &req, &prp_index);
+	CU_ASSERT(nvme_pcie_prp_list_append(&ctrlr, &tr, &prp_index, (void *)0x100000, 0x3000,
+					    0x1000) == 0);
+	CU_ASSERT(prp_index == 3);
+	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x200000);
+	CU_ASSERT(tr.u.prp[0] == 0x201000);
+	CU_ASSERT(tr.u.prp[1] == 0x202000);
+
+	/* 12K buffer, 4K aligned, translated again after each physically contiguous 4K */
+	g_vtophys_size = 0x1000;
+	prp_list_prep(&tr, &req, &prp_index);
+	CU_ASSERT(nvme_pcie_prp_list_append(&ctrlr, &tr, &prp_index, (void *)0x100000, 0x3000,
+					    0x1000) == 0);
+	CU_ASSERT(prp_index == 3);
+	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x200000);
+	CU_ASSERT(tr.u.prp[0] == 0x200000);
+	CU_ASSERT(tr.u.prp[1] == 0x200000);
+	g_vtophys_size = 0;
+	MOCK_CLEAR(spdk_vtophys);
+
 	/* 4K buffer, 4K aligned, but vtophys fails */
 	MOCK_SET(spdk_vtophys, SPDK_VTOPHYS_ERROR);
 	prp_list_prep(&tr, &req, &prp_index);
@@ -87,14 +87,14 @@ DEFINE_STUB(scsi_lun_allocate_io_channel, int,
 DEFINE_STUB_V(scsi_lun_free_io_channel, (struct spdk_scsi_lun *lun));
 
 bool
-scsi_lun_has_pending_mgmt_tasks(const struct spdk_scsi_lun *lun,
+scsi_lun_has_pending_mgmt_tasks(struct spdk_scsi_lun *lun,
 				const struct spdk_scsi_port *initiator_port)
 {
 	return (g_initiator_port_with_pending_mgmt_tasks == initiator_port);
 }
 
 bool
-scsi_lun_has_pending_tasks(const struct spdk_scsi_lun *lun,
+scsi_lun_has_pending_tasks(struct spdk_scsi_lun *lun,
 			   const struct spdk_scsi_port *initiator_port)
 {
 	return (g_initiator_port_with_pending_tasks == initiator_port);
@@ -10,8 +10,7 @@
 #include "scsi/task.c"
 #include "scsi/lun.c"
 
-#include "spdk_internal/mock.h"
-/* These unit tests aren't multithreads, but we need to allocate threads since
+/* Most of these unit tests aren't multithreaded, but we need to allocate threads since
  * the lun.c code will register pollers.
  */
 #include "common/lib/ut_multithread.c"
@@ -125,7 +124,7 @@ static void
 lun_destruct(struct spdk_scsi_lun *lun)
 {
 	/* LUN will defer its removal if there are any unfinished tasks */
-	SPDK_CU_ASSERT_FATAL(TAILQ_EMPTY(&lun->tasks));
+	SPDK_CU_ASSERT_FATAL(!scsi_lun_has_outstanding_tasks(lun));
 
 	scsi_lun_destruct(lun);
 }
@@ -148,7 +147,7 @@ lun_task_mgmt_execute_abort_task_not_supported(void)
 	mgmt_task.initiator_port = &initiator_port;
 	mgmt_task.function = SPDK_SCSI_TASK_FUNC_ABORT_TASK;
 
-	/* Params to add regular task to the lun->tasks */
+	/* Params to add regular task to the tasks list of the channel */
 	ut_init_task(&task);
 	task.lun = lun;
 	task.cdb = cdb;
@@ -156,7 +155,7 @@ lun_task_mgmt_execute_abort_task_not_supported(void)
 	scsi_lun_execute_task(lun, &task);
 
 	/* task should now be on the tasks list */
-	CU_ASSERT(!TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	scsi_lun_execute_mgmt_task(lun, &mgmt_task);
 
@@ -190,7 +189,7 @@ lun_task_mgmt_execute_abort_task_all_not_supported(void)
 	mgmt_task.initiator_port = &initiator_port;
 	mgmt_task.function = SPDK_SCSI_TASK_FUNC_ABORT_TASK_SET;
 
-	/* Params to add regular task to the lun->tasks */
+	/* Params to add regular task to the tasks list of the channel */
 	ut_init_task(&task);
 	task.initiator_port = &initiator_port;
 	task.lun = lun;
@@ -199,7 +198,7 @@ lun_task_mgmt_execute_abort_task_all_not_supported(void)
 	scsi_lun_execute_task(lun, &task);
 
 	/* task should now be on the tasks list */
-	CU_ASSERT(!TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	scsi_lun_execute_mgmt_task(lun, &mgmt_task);
 
@@ -355,12 +354,12 @@ lun_execute_scsi_task_pending(void)
 	/* the tasks list should still be empty since it has not been
 	   executed yet
 	 */
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	scsi_lun_execute_task(lun, &task);
 
 	/* Assert the task has been successfully added to the tasks queue */
-	CU_ASSERT(!TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	/* task is still on the tasks list */
 	CU_ASSERT_EQUAL(g_task_count, 1);
@@ -392,12 +391,12 @@ lun_execute_scsi_task_complete(void)
 	/* the tasks list should still be empty since it has not been
 	   executed yet
 	 */
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	scsi_lun_execute_task(lun, &task);
 
 	/* Assert the task has not been added to the tasks queue */
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	lun_destruct(lun);
 
@@ -423,7 +422,7 @@ lun_execute_scsi_task_resize(void)
 	/* the tasks list should still be empty since it has not been
 	   executed yet
 	 */
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	scsi_lun_execute_task(lun, &task);
 	CU_ASSERT_EQUAL(task.status, SPDK_SCSI_STATUS_CHECK_CONDITION);
@@ -435,7 +434,16 @@ lun_execute_scsi_task_resize(void)
 	CU_ASSERT(lun->resizing == false);
 
 	/* Assert the task has not been added to the tasks queue */
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
+
+	/* The unit attention is only reported to the first task */
+	ut_init_task(&task);
+	task.lun = lun;
+	task.cdb = &cdb;
+	g_lun_execute_status = SPDK_SCSI_TASK_COMPLETE;
+	scsi_lun_execute_task(lun, &task);
+	CU_ASSERT_EQUAL(task.status, SPDK_SCSI_STATUS_GOOD);
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	lun_destruct(lun);
 
@@ -500,8 +508,8 @@ lun_reset_task_wait_scsi_task_complete(void)
 	/* Execute the task but it is still in the task list. */
 	scsi_lun_execute_task(lun, &task);
 
-	CU_ASSERT(TAILQ_EMPTY(&lun->pending_tasks));
-	CU_ASSERT(!TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->pending_tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	/* Execute the reset task */
 	scsi_lun_execute_mgmt_task(lun, &mgmt_task);
@@ -521,7 +529,7 @@ lun_reset_task_wait_scsi_task_complete(void)
 	/* Complete the task. */
 	scsi_lun_complete_task(lun, &task);
 
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	/* Execute the poller to check if the task prior to the reset task complete. */
 	scsi_lun_reset_check_outstanding_tasks(&mgmt_task);
@@ -556,6 +564,7 @@ lun_reset_task_suspend_scsi_task(void)
 	ut_init_task(&mgmt_task);
 	mgmt_task.lun = lun;
 	mgmt_task.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
+	mgmt_task.lun_ch = scsi_lun_get_channel(lun);
 
 	/* Append a reset task to the pending mgmt task list. */
 	scsi_lun_append_mgmt_task(lun, &mgmt_task);
@@ -565,7 +574,7 @@ lun_reset_task_suspend_scsi_task(void)
 	/* Execute the task but it is on the pending task list. */
 	scsi_lun_execute_task(lun, &task);
 
-	CU_ASSERT(!TAILQ_EMPTY(&lun->pending_tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&scsi_lun_get_channel(lun)->pending_tasks));
 
 	/* Execute the reset task. The task will be executed then. */
 	_scsi_lun_execute_mgmt_task(lun);
@@ -575,8 +584,8 @@ lun_reset_task_suspend_scsi_task(void)
 	CU_ASSERT_EQUAL(mgmt_task.status, SPDK_SCSI_STATUS_GOOD);
 	CU_ASSERT_EQUAL(mgmt_task.response, SPDK_SCSI_TASK_MGMT_RESP_SUCCESS);
 
-	CU_ASSERT(TAILQ_EMPTY(&lun->pending_tasks));
-	CU_ASSERT(TAILQ_EMPTY(&lun->tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->pending_tasks));
+	CU_ASSERT(TAILQ_EMPTY(&scsi_lun_get_channel(lun)->tasks));
 
 	lun_destruct(lun);
 
@@ -587,6 +596,7 @@ static void
 lun_check_pending_tasks_only_for_specific_initiator(void)
 {
 	struct spdk_scsi_lun *lun;
+	struct spdk_scsi_lun_channel *ch;
 	struct spdk_scsi_task task1 = {};
 	struct spdk_scsi_task task2 = {};
 	struct spdk_scsi_port initiator_port1 = {};
@@ -594,33 +604,39 @@ lun_check_pending_tasks_only_for_specific_initiator(void)
 	struct spdk_scsi_port initiator_port3 = {};
 
 	lun = scsi_lun_construct("ut_bdev", NULL, NULL, NULL, NULL);
+	ch = scsi_lun_get_channel(lun);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
 
 	task1.initiator_port = &initiator_port1;
 	task2.initiator_port = &initiator_port2;
 
-	TAILQ_INSERT_TAIL(&lun->tasks, &task1, scsi_link);
-	TAILQ_INSERT_TAIL(&lun->tasks, &task2, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->tasks, &task1, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->tasks, &task2, scsi_link);
+	ch->num_outstanding_tasks = 2;
 	CU_ASSERT(scsi_lun_has_outstanding_tasks(lun) == true);
 	CU_ASSERT(_scsi_lun_has_pending_tasks(lun) == false);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port1) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port2) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port3) == false);
-	TAILQ_REMOVE(&lun->tasks, &task1, scsi_link);
-	TAILQ_REMOVE(&lun->tasks, &task2, scsi_link);
+	TAILQ_REMOVE(&ch->tasks, &task1, scsi_link);
+	TAILQ_REMOVE(&ch->tasks, &task2, scsi_link);
+	ch->num_outstanding_tasks = 0;
 	CU_ASSERT(_scsi_lun_has_pending_tasks(lun) == false);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == false);
 
-	TAILQ_INSERT_TAIL(&lun->pending_tasks, &task1, scsi_link);
-	TAILQ_INSERT_TAIL(&lun->pending_tasks, &task2, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->pending_tasks, &task1, scsi_link);
+	TAILQ_INSERT_TAIL(&ch->pending_tasks, &task2, scsi_link);
+	ch->num_pending_tasks = 2;
 	CU_ASSERT(scsi_lun_has_outstanding_tasks(lun) == false);
 	CU_ASSERT(_scsi_lun_has_pending_tasks(lun) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port1) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port2) == true);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, &initiator_port3) == false);
-	TAILQ_REMOVE(&lun->pending_tasks, &task1, scsi_link);
-	TAILQ_REMOVE(&lun->pending_tasks, &task2, scsi_link);
+	TAILQ_REMOVE(&ch->pending_tasks, &task1, scsi_link);
+	TAILQ_REMOVE(&ch->pending_tasks, &task2, scsi_link);
+	ch->num_pending_tasks = 0;
 	CU_ASSERT(_scsi_lun_has_pending_tasks(lun) == false);
 	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == false);
 
@@ -670,6 +686,9 @@ abort_pending_mgmt_tasks_when_lun_is_removed(void)
 	task1.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
 	task2.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
 	task3.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
+	task1.lun_ch = scsi_lun_get_channel(lun);
+	task2.lun_ch = scsi_lun_get_channel(lun);
+	task3.lun_ch = scsi_lun_get_channel(lun);
 
 	CU_ASSERT(g_task_count == 3);
 
@@ -695,6 +714,9 @@ abort_pending_mgmt_tasks_when_lun_is_removed(void)
 	task1.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
 	task2.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
 	task3.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
+	task1.lun_ch = scsi_lun_get_channel(lun);
+	task2.lun_ch = scsi_lun_get_channel(lun);
+	task3.lun_ch = scsi_lun_get_channel(lun);
 
 	CU_ASSERT(g_task_count == 3);
 
@@ -718,6 +740,98 @@ abort_pending_mgmt_tasks_when_lun_is_removed(void)
 	scsi_lun_remove(lun);
 }
 
+static void
+lun_execute_task_multi_thread(void)
+{
+	struct spdk_scsi_lun *lun;
+	struct spdk_scsi_lun_channel *ch0, *ch1;
+	struct spdk_scsi_task task0, task1, mgmt_task;
+	struct spdk_scsi_dev dev = { 0 };
+
+	lun = lun_construct();
+	lun->dev = &dev;
+
+	g_lun_execute_fail = false;
+	g_lun_execute_status = SPDK_SCSI_TASK_PENDING;
+
+	ut_init_task(&task0);
+	task0.lun = lun;
+	ut_init_task(&task1);
+	task1.lun = lun;
+
+	/* Each thread tracks its tasks on its own channel. */
+	set_thread(0);
+	scsi_lun_execute_task(lun, &task0);
+	set_thread(1);
+	scsi_lun_execute_task(lun, &task1);
+
+	ch0 = task0.lun_ch;
+	ch1 = task1.lun_ch;
+	SPDK_CU_ASSERT_FATAL(ch0 != NULL && ch1 != NULL);
+	CU_ASSERT(ch0 != ch1);
+	CU_ASSERT(ch0->thread != ch1->thread);
+	CU_ASSERT(ch0->num_outstanding_tasks == 1);
+	CU_ASSERT(ch1->num_outstanding_tasks == 1);
+	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == true);
+
+	/* A reset on thread 0 waits for the outstanding tasks of all threads. */
+	set_thread(0);
+	ut_init_task(&mgmt_task);
+	mgmt_task.lun = lun;
+	mgmt_task.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
+	scsi_lun_execute_mgmt_task(lun, &mgmt_task);
+	CU_ASSERT(lun->reset_poller != NULL);
+
+	scsi_lun_complete_task(lun, &task0);
+	CU_ASSERT(ch0->num_outstanding_tasks == 0);
+	scsi_lun_reset_check_outstanding_tasks(&mgmt_task);
+	CU_ASSERT(lun->reset_poller != NULL);
+
+	set_thread(1);
+	scsi_lun_complete_task(lun, &task1);
+	CU_ASSERT(scsi_lun_has_pending_tasks(lun, NULL) == false);
+
+	set_thread(0);
+	scsi_lun_reset_check_outstanding_tasks(&mgmt_task);
+	CU_ASSERT(lun->reset_poller == NULL);
+	CU_ASSERT(TAILQ_EMPTY(&lun->mgmt_tasks));
+	CU_ASSERT_EQUAL(mgmt_task.response, SPDK_SCSI_TASK_MGMT_RESP_SUCCESS);
+
+	/* IO tasks on thread 1 wait for the pending mgmt task and are resumed
+	 * on thread 1 when it completes.
+	 */
+	ut_init_task(&mgmt_task);
+	mgmt_task.lun = lun;
+	mgmt_task.lun_ch = ch0;
+	mgmt_task.function = SPDK_SCSI_TASK_FUNC_LUN_RESET;
+	scsi_lun_append_mgmt_task(lun, &mgmt_task);
+
+	set_thread(1);
+	ut_init_task(&task1);
+	task1.lun = lun;
+	scsi_lun_execute_task(lun, &task1);
+	CU_ASSERT(!TAILQ_EMPTY(&ch1->pending_tasks));
+	CU_ASSERT(TAILQ_EMPTY(&ch1->tasks));
+
+	set_thread(0);
+	_scsi_lun_execute_mgmt_task(lun);
+	CU_ASSERT(TAILQ_EMPTY(&lun->mgmt_tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&ch1->pending_tasks));
+
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&ch1->pending_tasks));
+	CU_ASSERT(!TAILQ_EMPTY(&ch1->tasks));
+
+	set_thread(1);
+	scsi_lun_complete_task(lun, &task1);
+
+	set_thread(0);
+	lun_destruct(lun);
+	poll_threads();
+
+	CU_ASSERT_EQUAL(g_task_count, 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -745,8 +859,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, lun_reset_task_suspend_scsi_task);
 	CU_ADD_TEST(suite, lun_check_pending_tasks_only_for_specific_initiator);
 	CU_ADD_TEST(suite, abort_pending_mgmt_tasks_when_lun_is_removed);
+	CU_ADD_TEST(suite, lun_execute_task_multi_thread);
 
-	allocate_threads(1);
+	allocate_threads(2);
 	set_thread(0);
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	free_threads();
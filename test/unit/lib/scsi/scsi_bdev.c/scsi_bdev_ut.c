@@ -111,10 +111,13 @@ ut_put_task(struct spdk_scsi_task *task)
 	SPDK_CU_ASSERT_FATAL(TAILQ_EMPTY(&g_bdev_io_queue));
 }
 
+static struct spdk_scsi_lun_channel g_lun_ch;
+
 static void
 ut_init_task(struct spdk_scsi_task *task)
 {
 	memset(task, 0xFF, sizeof(*task));
+	task->lun_ch = &g_lun_ch;
 	task->iov.iov_base = NULL;
 	task->iovs = &task->iov;
 	task->iovcnt = 1;
@@ -619,8 +622,8 @@ task_complete_test(void)
 
 	ut_init_task(&task);
 
-	TAILQ_INIT(&lun.tasks);
-	TAILQ_INSERT_TAIL(&lun.tasks, &task, scsi_link);
+	TAILQ_INIT(&g_lun_ch.tasks);
+	TAILQ_INSERT_TAIL(&g_lun_ch.tasks, &task, scsi_link);
 	task.lun = &lun;
 
 	bdev_io.internal.status = SPDK_BDEV_IO_STATUS_SUCCESS;
@@ -668,7 +671,7 @@ lba_range_test(void)
 	ut_init_task(&task);
 	task.lun = &lun;
 	task.lun->bdev_desc = NULL;
-	task.lun->io_channel = NULL;
+	task.lun_ch->io_channel = NULL;
 	task.cdb = cdb;
 
 	memset(cdb, 0, sizeof(cdb));
@@ -749,7 +752,7 @@ xfer_len_test(void)
 	ut_init_task(&task);
 	task.lun = &lun;
 	task.lun->bdev_desc = NULL;
-	task.lun->io_channel = NULL;
+	task.lun_ch->io_channel = NULL;
 	task.cdb = cdb;
 
 	memset(cdb, 0, sizeof(cdb));
@@ -848,7 +851,7 @@ _xfer_test(bool bdev_io_pool_full)
 	ut_init_task(&task);
 	task.lun = &lun;
 	task.lun->bdev_desc = NULL;
-	task.lun->io_channel = NULL;
+	task.lun_ch->io_channel = NULL;
 	task.cdb = cdb;
 	memset(cdb, 0, sizeof(cdb));
 	cdb[0] = 0x88; /* READ (16) */
@@ -541,6 +541,19 @@ test_scsi2_reserve_release(void)
 	SPDK_CU_ASSERT_FATAL(rc < 0);
 	SPDK_CU_ASSERT_FATAL(task.status == SPDK_SCSI_STATUS_RESERVATION_CONFLICT);
 
+	/* Test Case: the generic check applies the SPC2 reservation too */
+	task.status = 0;
+	rc = scsi_pr_check(&task);
+	SPDK_CU_ASSERT_FATAL(rc < 0);
+	SPDK_CU_ASSERT_FATAL(task.status == SPDK_SCSI_STATUS_RESERVATION_CONFLICT);
+
+	/* Test Case: READ command from Host A, the holder */
+	task.initiator_port = &g_i_port_a;
+	task.status = 0;
+	rc = scsi_pr_check(&task);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	task.initiator_port = &g_i_port_b;
+
 	/* Test Case: SPDK_SPC2_RELEASE10 command from Host B */
 	task.initiator_port = &g_i_port_b;
 	task.cdb[0] = SPDK_SPC2_RELEASE_10;
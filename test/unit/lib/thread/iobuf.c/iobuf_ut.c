@@ -78,6 +78,7 @@ iobuf(void)
 		{ .thread_id = 1, .module = "ut_module1", },
 		{ .thread_id = 1, .module = "ut_module1", },
 	};
+	struct iovec regions[2];
 	int rc, finish = 0;
 	uint32_t i;
 
@@ -86,11 +87,21 @@ iobuf(void)
 
 	set_thread(0);
 
+	rc = spdk_iobuf_get_pool_regions(regions, SPDK_COUNTOF(regions));
+	CU_ASSERT_EQUAL(rc, 0);
+
 	/* We cannot use spdk_iobuf_set_opts(), as it won't allow us to use such small pools */
 	g_iobuf.opts = opts;
 	rc = spdk_iobuf_initialize();
 	CU_ASSERT_EQUAL(rc, 0);
 
+	rc = spdk_iobuf_get_pool_regions(regions, 1);
+	CU_ASSERT_EQUAL(rc, -ENOMEM);
+	rc = spdk_iobuf_get_pool_regions(regions, SPDK_COUNTOF(regions));
+	CU_ASSERT_EQUAL(rc, 2);
+	CU_ASSERT_EQUAL(regions[0].iov_len, 2 * SMALL_BUFSIZE);
+	CU_ASSERT_EQUAL(regions[1].iov_len, 2 * LARGE_BUFSIZE);
+
 	rc = spdk_iobuf_register_module("ut_module0");
 	CU_ASSERT_EQUAL(rc, 0);
 
@@ -121,6 +132,10 @@ iobuf(void)
 	entry = &mod0_entries[0];
 	entry->buf = spdk_iobuf_get(entry->ioch, LARGE_BUFSIZE, &entry->iobuf, ut_iobuf_get_buf_cb);
 	CU_ASSERT_PTR_NOT_NULL(entry->buf);
+	/* The buffers are located within the region of their pool */
+	CU_ASSERT((uintptr_t)entry->buf >= (uintptr_t)regions[1].iov_base);
+	CU_ASSERT((uintptr_t)entry->buf + LARGE_BUFSIZE <=
+		  (uintptr_t)regions[1].iov_base + regions[1].iov_len);
 	entry = &mod0_entries[1];
 	entry->buf = spdk_iobuf_get(entry->ioch, LARGE_BUFSIZE, &entry->iobuf, ut_iobuf_get_buf_cb);
 	CU_ASSERT_PTR_NOT_NULL(entry->buf);
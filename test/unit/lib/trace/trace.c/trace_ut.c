@@ -0,0 +1,189 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+#include "trace/trace.c"
+
+#define UT_NUM_ENTRIES		16
+#define UT_TSC			0x1000
+#define UT_POLLER_ID		3
+#define UT_SIZE			0x2000
+#define UT_OBJECT_ID		0xabcd
+
+static const uint64_t g_ut_args[SPDK_TRACE_MAX_INT_ARGS_COUNT] = {
+	0x0102030405060708ULL, 0x1112131415161718ULL, 0x2122232425262728ULL, 0x3132333435363738ULL
+};
+
+static void
+ut_record(uint16_t tpoint_id, bool use_int)
+{
+	const uint64_t *a = g_ut_args;
+
+	/* The tracepoint ID matches its number of arguments */
+	switch (tpoint_id) {
+	case 0:
+		if (use_int) {
+			spdk_trace_record_int_tsc(UT_TSC, 0, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID);
+		} else {
+			spdk_trace_record_tsc(UT_TSC, 0, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID);
+		}
+		break;
+	case 1:
+		if (use_int) {
+			spdk_trace_record_int_tsc(UT_TSC, 1, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID, a[0]);
+		} else {
+			spdk_trace_record_tsc(UT_TSC, 1, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID, a[0]);
+		}
+		break;
+	case 2:
+		if (use_int) {
+			spdk_trace_record_int_tsc(UT_TSC, 2, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID, a[0], a[1]);
+		} else {
+			spdk_trace_record_tsc(UT_TSC, 2, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID, a[0], a[1]);
+		}
+		break;
+	case 3:
+		if (use_int) {
+			spdk_trace_record_int_tsc(UT_TSC, 3, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID,
+						  a[0], a[1], a[2]);
+		} else {
+			spdk_trace_record_tsc(UT_TSC, 3, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID,
+					      a[0], a[1], a[2]);
+		}
+		break;
+	case 4:
+		if (use_int) {
+			spdk_trace_record_int_tsc(UT_TSC, 4, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID,
+						  a[0], a[1], a[2], a[3]);
+		} else {
+			spdk_trace_record_tsc(UT_TSC, 4, UT_POLLER_ID, UT_SIZE, UT_OBJECT_ID,
+					      a[0], a[1], a[2], a[3]);
+		}
+		break;
+	default:
+		CU_FAIL("Unexpected tracepoint");
+	}
+}
+
+static struct spdk_trace_history *
+ut_reset_history(uint64_t next_entry)
+{
+	struct spdk_trace_history *history = spdk_get_per_lcore_history(g_trace_histories, 0);
+
+	memset(history->tpoint_count, 0, sizeof(history->tpoint_count));
+	memset(history->entries, 0xff, UT_NUM_ENTRIES * sizeof(history->entries[0]));
+	history->next_entry = next_entry;
+
+	return history;
+}
+
+static void
+test_record_int(void)
+{
+	/* The first entry holds one argument, each of the following ones up to 22 bytes */
+	const uint64_t num_entries[] = { 1, 1, 2, 2, 3 };
+	struct spdk_trace_entry expected[UT_NUM_ENTRIES];
+	struct spdk_trace_entry_buffer *buffer;
+	struct spdk_trace_history *history;
+	uint64_t start, next_entry;
+	uint16_t tpoint_id;
+
+	/* Start close to the end of the ring too, so that the arguments wrap around */
+	for (start = 0; start < UT_NUM_ENTRIES; start += UT_NUM_ENTRIES - 2) {
+		for (tpoint_id = 0; tpoint_id <= SPDK_TRACE_MAX_INT_ARGS_COUNT; tpoint_id++) {
+			history = ut_reset_history(start);
+			ut_record(tpoint_id, false);
+			next_entry = history->next_entry;
+			CU_ASSERT(next_entry == start + num_entries[tpoint_id]);
+			CU_ASSERT(history->tpoint_count[tpoint_id] == 1);
+			memcpy(expected, history->entries, sizeof(expected));
+
+			history = ut_reset_history(start);
+			ut_record(tpoint_id, true);
+			CU_ASSERT(history->next_entry == next_entry);
+			CU_ASSERT(history->tpoint_count[tpoint_id] == 1);
+			CU_ASSERT(memcmp(history->entries, expected, sizeof(expected)) == 0);
+
+			/* Check the spilled arguments explicitly too */
+			if (tpoint_id == SPDK_TRACE_MAX_INT_ARGS_COUNT) {
+				buffer = (struct spdk_trace_entry_buffer *)get_trace_entry(history, start + 1);
+				CU_ASSERT(buffer->tpoint_id == SPDK_TRACE_MAX_TPOINT_ID);
+				CU_ASSERT(buffer->tsc == UT_TSC);
+				CU_ASSERT(memcmp(buffer->data, &g_ut_args[1], sizeof(buffer->data)) == 0);
+				buffer = (struct spdk_trace_entry_buffer *)get_trace_entry(history, start + 2);
+				CU_ASSERT(buffer->tpoint_id == SPDK_TRACE_MAX_TPOINT_ID);
+				CU_ASSERT(memcmp(buffer->data, (uint8_t *)&g_ut_args[1] + sizeof(buffer->data),
+						 3 * sizeof(uint64_t) - sizeof(buffer->data)) == 0);
+			}
+		}
+	}
+}
+
+static int
+test_setup(void)
+{
+	struct spdk_trace_tpoint *tpoint;
+	size_t size;
+	uint16_t tpoint_id;
+	int i;
+
+	size = sizeof(*g_trace_histories) + spdk_get_trace_history_size(UT_NUM_ENTRIES);
+	g_trace_histories = calloc(1, size);
+	if (g_trace_histories == NULL) {
+		return -ENOMEM;
+	}
+
+	g_trace_flags = &g_trace_histories->flags;
+	g_trace_flags->lcore_history_offsets[0] = sizeof(*g_trace_histories);
+	g_trace_flags->lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES] = size;
+	spdk_get_per_lcore_history(g_trace_histories, 0)->num_entries = UT_NUM_ENTRIES;
+
+	for (tpoint_id = 0; tpoint_id <= SPDK_TRACE_MAX_INT_ARGS_COUNT; tpoint_id++) {
+		tpoint = &g_trace_flags->tpoint[tpoint_id];
+		tpoint->tpoint_id = tpoint_id;
+		tpoint->num_args = tpoint_id;
+		for (i = 0; i < tpoint_id; i++) {
+			tpoint->args[i].type = i % 2 ? SPDK_TRACE_ARG_TYPE_PTR : SPDK_TRACE_ARG_TYPE_INT;
+			tpoint->args[i].size = sizeof(uint64_t);
+		}
+		g_trace_flags->tpoint_mask[tpoint_id >> 6] |= 1ULL << (tpoint_id & 0x3F);
+	}
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	MOCK_CLEAR(spdk_env_get_current_core);
+	free(g_trace_histories);
+	g_trace_histories = NULL;
+	g_trace_flags = NULL;
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("trace", test_setup, test_cleanup);
+
+	CU_ADD_TEST(suite, test_record_int);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
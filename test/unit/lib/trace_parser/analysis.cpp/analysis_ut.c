@@ -0,0 +1,313 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk/util.h"
+#include "spdk/trace.h"
+#include "spdk/trace_parser.h"
+
+#define UT_OBJECT_REQ		1
+#define UT_OBJECT_IO		2
+
+#define UT_TPOINT_REQ_START	0
+#define UT_TPOINT_IO_START	1
+#define UT_TPOINT_IO_DONE	2
+#define UT_TPOINT_REQ_DONE	3
+
+struct ut_entry {
+	uint64_t	tsc;
+	uint16_t	tpoint_id;
+	uint64_t	object_id;
+	uint64_t	arg;
+};
+
+/*
+ * Requests tracked by the REQ object, each submitting a single IO (tied to the request by the
+ * argument of IO_START).  With a tsc_rate of 1MHz, each tick is 1us:
+ *  - r0: REQ_START -10-> IO_START -30-> IO_DONE -10-> REQ_DONE, 50us total
+ *  - r1 (same object ID as r0): REQ_START -10-> IO_START -80-> IO_DONE -10-> REQ_DONE, 100us total
+ *  - r2: REQ_START -20-> REQ_DONE, 20us total, ID not reused before the end of the trace, but
+ *    ending with the same tracepoint as r0
+ *  - r3: REQ_START -10-> IO_START, still in flight at the end of the trace
+ */
+static const struct ut_entry g_ut_entries[] = {
+	{ 100, UT_TPOINT_REQ_START, 0x10, 0 },
+	{ 110, UT_TPOINT_IO_START, 0x20, 0x10 },
+	{ 140, UT_TPOINT_IO_DONE, 0x20, 0 },
+	{ 150, UT_TPOINT_REQ_DONE, 0x10, 0 },
+	{ 200, UT_TPOINT_REQ_START, 0x10, 0 },
+	{ 210, UT_TPOINT_IO_START, 0x20, 0x10 },
+	{ 290, UT_TPOINT_IO_DONE, 0x20, 0 },
+	{ 300, UT_TPOINT_REQ_DONE, 0x10, 0 },
+	{ 400, UT_TPOINT_REQ_START, 0x11, 0 },
+	/* Object that was never started, ignored */
+	{ 410, UT_TPOINT_IO_DONE, 0x99, 0 },
+	{ 420, UT_TPOINT_REQ_DONE, 0x11, 0 },
+	{ 500, UT_TPOINT_REQ_START, 0x12, 0 },
+	{ 510, UT_TPOINT_IO_START, 0x21, 0x12 },
+};
+
+static char g_trace_file[64];
+
+static void
+ut_set_tpoint(struct spdk_trace_flags *flags, uint16_t tpoint_id, const char *name,
+	      uint8_t object_type, uint8_t new_object)
+{
+	struct spdk_trace_tpoint *tpoint = &flags->tpoint[tpoint_id];
+
+	snprintf(tpoint->name, sizeof(tpoint->name), "%s", name);
+	tpoint->tpoint_id = tpoint_id;
+	tpoint->object_type = object_type;
+	tpoint->new_object = new_object;
+}
+
+static int
+ut_write_trace_file(void)
+{
+	struct spdk_trace_histories *histories;
+	struct spdk_trace_history *history;
+	struct spdk_trace_tpoint *tpoint;
+	struct spdk_trace_entry *entry;
+	size_t i, size, num_entries = SPDK_COUNTOF(g_ut_entries);
+	ssize_t rc;
+	int fd;
+
+	size = sizeof(*histories) + spdk_get_trace_history_size(num_entries);
+	histories = calloc(1, size);
+	if (histories == NULL) {
+		return -ENOMEM;
+	}
+
+	histories->flags.version = SPDK_TRACE_VERSION;
+	histories->flags.tsc_rate = 1000 * 1000;
+	histories->flags.object[UT_OBJECT_REQ].type = UT_OBJECT_REQ;
+	histories->flags.object[UT_OBJECT_REQ].id_prefix = 'r';
+	histories->flags.object[UT_OBJECT_IO].type = UT_OBJECT_IO;
+	histories->flags.object[UT_OBJECT_IO].id_prefix = 'i';
+	ut_set_tpoint(&histories->flags, UT_TPOINT_REQ_START, "REQ_START", UT_OBJECT_REQ, 1);
+	ut_set_tpoint(&histories->flags, UT_TPOINT_IO_START, "IO_START", UT_OBJECT_IO, 1);
+	ut_set_tpoint(&histories->flags, UT_TPOINT_IO_DONE, "IO_DONE", UT_OBJECT_IO, 0);
+	ut_set_tpoint(&histories->flags, UT_TPOINT_REQ_DONE, "REQ_DONE", UT_OBJECT_REQ, 0);
+
+	/* IO_START refers to the request the IO is submitted for */
+	tpoint = &histories->flags.tpoint[UT_TPOINT_IO_START];
+	tpoint->num_args = 1;
+	snprintf(tpoint->args[0].name, sizeof(tpoint->args[0].name), "req");
+	tpoint->args[0].type = SPDK_TRACE_ARG_TYPE_PTR;
+	tpoint->args[0].size = sizeof(uint64_t);
+	tpoint->related_objects[0].object_type = UT_OBJECT_REQ;
+	tpoint->related_objects[0].arg_index = 0;
+
+	histories->flags.lcore_history_offsets[0] = sizeof(*histories);
+	histories->flags.lcore_history_offsets[SPDK_TRACE_MAX_HISTORIES] = size;
+
+	history = spdk_get_per_lcore_history(histories, 0);
+	history->lcore = 0;
+	history->num_entries = num_entries;
+	history->next_entry = num_entries;
+	for (i = 0; i < num_entries; i++) {
+		entry = &history->entries[i];
+		entry->tsc = g_ut_entries[i].tsc;
+		entry->tpoint_id = g_ut_entries[i].tpoint_id;
+		entry->object_id = g_ut_entries[i].object_id;
+		memcpy(entry->args, &g_ut_entries[i].arg, sizeof(g_ut_entries[i].arg));
+	}
+
+	snprintf(g_trace_file, sizeof(g_trace_file), "/tmp/analysis_ut.XXXXXX");
+	fd = mkstemp(g_trace_file);
+	if (fd < 0) {
+		free(histories);
+		return -errno;
+	}
+
+	rc = write(fd, histories, size);
+	close(fd);
+	free(histories);
+
+	return rc == (ssize_t)size ? 0 : -EIO;
+}
+
+/* Run the analysis of the trace file and return its report */
+static char *
+ut_analyze(uint32_t top_n)
+{
+	struct spdk_trace_parser_opts popts = {
+		.filename = g_trace_file,
+		.mode = SPDK_TRACE_PARSER_MODE_FILE,
+		.lcore = SPDK_TRACE_MAX_LCORE,
+	};
+	struct spdk_trace_analysis_opts aopts = { .top_n = top_n };
+	struct spdk_trace_parser *parser;
+	struct spdk_trace_parser_entry entry;
+	struct spdk_trace_analysis *analysis;
+	char *report = NULL;
+	size_t report_size;
+	FILE *file;
+	int rc;
+
+	parser = spdk_trace_parser_init(&popts);
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+	analysis = spdk_trace_analysis_create(parser, &aopts);
+	SPDK_CU_ASSERT_FATAL(analysis != NULL);
+
+	while (spdk_trace_parser_next_entry(parser, &entry)) {
+		rc = spdk_trace_analysis_add_entry(analysis, &entry);
+		CU_ASSERT(rc == 0);
+	}
+
+	file = open_memstream(&report, &report_size);
+	SPDK_CU_ASSERT_FATAL(file != NULL);
+	rc = spdk_trace_analysis_report(analysis, file);
+	CU_ASSERT(rc == 0);
+	fclose(file);
+
+	spdk_trace_analysis_free(analysis);
+	spdk_trace_parser_cleanup(parser);
+
+	return report;
+}
+
+struct ut_stage {
+	uint64_t	count;
+	double		avg;
+	double		p50;
+	double		p90;
+	double		p99;
+	double		p999;
+	double		max;
+};
+
+/* Find the line of a stage in the report and parse its statistics */
+static bool
+ut_get_stage(const char *report, const char *name, struct ut_stage *stage)
+{
+	char pattern[128];
+	const char *line;
+
+	snprintf(pattern, sizeof(pattern), "\n  %s ", name);
+	line = strstr(report, pattern);
+	if (line == NULL) {
+		return false;
+	}
+
+	return sscanf(line + strlen(pattern), "%" SCNu64 " %lf %lf %lf %lf %lf %lf", &stage->count,
+		      &stage->avg, &stage->p50, &stage->p90, &stage->p99, &stage->p999,
+		      &stage->max) == 7;
+}
+
+static void
+test_analysis_stages(void)
+{
+	struct ut_stage stage;
+	char *report;
+
+	report = ut_analyze(0);
+	SPDK_CU_ASSERT_FATAL(report != NULL);
+
+	/* All the requests start with the same tracepoint, so they're in a single class */
+	CU_ASSERT(strstr(report, "\n3 requests starting with REQ_START, latencies in usec:\n") != NULL);
+	CU_ASSERT(strstr(report, "requests starting with IO_START") == NULL);
+
+	/* The request still in flight is counted apart, its latencies would be bogus */
+	CU_ASSERT(strstr(report, "\n  (1 more still in flight at the end of the trace, not included)\n")
+		  != NULL);
+
+	/* The events of an IO are accounted to the request it was submitted for */
+	CU_ASSERT(ut_get_stage(report, "REQ_START -> IO_START", &stage));
+	CU_ASSERT(stage.count == 2);
+	CU_ASSERT(stage.avg == 10.0);
+	CU_ASSERT(stage.max == 10.0);
+
+	CU_ASSERT(ut_get_stage(report, "IO_START -> IO_DONE", &stage));
+	CU_ASSERT(stage.count == 2);
+	CU_ASSERT(stage.avg == 55.0);
+	CU_ASSERT(stage.p50 >= 30.0 && stage.p50 < 80.0);
+	CU_ASSERT(stage.p999 == 80.0);
+	CU_ASSERT(stage.max == 80.0);
+
+	CU_ASSERT(ut_get_stage(report, "IO_DONE -> REQ_DONE", &stage));
+	CU_ASSERT(stage.count == 2);
+	CU_ASSERT(stage.avg == 10.0);
+
+	/* The request done, but whose ID wasn't reused before the end of the trace, is accounted */
+	CU_ASSERT(ut_get_stage(report, "REQ_START -> REQ_DONE", &stage));
+	CU_ASSERT(stage.count == 1);
+	CU_ASSERT(stage.avg == 20.0);
+	CU_ASSERT(stage.max == 20.0);
+
+	CU_ASSERT(ut_get_stage(report, "Total", &stage));
+	CU_ASSERT(stage.count == 3);
+	/* Averages are in whole ticks */
+	CU_ASSERT(stage.avg == 56.0);
+	CU_ASSERT(stage.max == 100.0);
+
+	/* The stages are sorted by their position in the requests */
+	CU_ASSERT(strstr(report, "REQ_START -> IO_START") < strstr(report, "IO_START -> IO_DONE"));
+	CU_ASSERT(strstr(report, "IO_START -> IO_DONE") < strstr(report, "IO_DONE -> REQ_DONE"));
+
+	/* No timelines unless asked for */
+	CU_ASSERT(strstr(report, "Slowest") == NULL);
+
+	free(report);
+}
+
+static void
+test_analysis_slowest(void)
+{
+	char *report, *slowest;
+
+	report = ut_analyze(1);
+	SPDK_CU_ASSERT_FATAL(report != NULL);
+
+	/* Only the timeline of the slowest request, r1, is reported */
+	slowest = strstr(report, "\nSlowest 1 requests:\n");
+	SPDK_CU_ASSERT_FATAL(slowest != NULL);
+	CU_ASSERT(strstr(slowest, "\n  REQ_START r1: 100.000 usec\n") != NULL);
+	CU_ASSERT(strstr(slowest, "r0") == NULL);
+	CU_ASSERT(strstr(slowest, "r2") == NULL);
+	CU_ASSERT(strstr(slowest, "r3") == NULL);
+
+	/* Along with the events of its IO, relative to the start of the request */
+	CU_ASSERT(strstr(slowest, "+10.000  lcore   0  IO_START") != NULL);
+	CU_ASSERT(strstr(slowest, "+90.000  lcore   0  IO_DONE") != NULL);
+	CU_ASSERT(strstr(slowest, "+100.000  lcore   0  REQ_DONE") != NULL);
+
+	free(report);
+}
+
+static int
+test_setup(void)
+{
+	return ut_write_trace_file();
+}
+
+static int
+test_cleanup(void)
+{
+	unlink(g_trace_file);
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("analysis", test_setup, test_cleanup);
+
+	CU_ADD_TEST(suite, test_analysis_stages);
+	CU_ADD_TEST(suite, test_analysis_slowest);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,288 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk/util.h"
+#include "spdk/trace.h"
+#include "spdk/trace_parser.h"
+#include "spdk_internal/trace_stream.h"
+
+#define UT_TPOINT_EVENT		0
+#define UT_TPOINT_ARGS		1
+
+/* Number of arguments of UT_TPOINT_ARGS, the last two spill into the next buffer */
+#define UT_NUM_ARGS		3
+
+struct ut_event {
+	uint16_t	lcore;
+	uint64_t	tsc;
+	uint16_t	tpoint_id;
+};
+
+/*
+ * Events of two lcores, in the order the parser is expected to return them.  The arguments of the
+ * event at tsc 50 are split between the first and the second block of lcore 0.
+ */
+static const struct ut_event g_ut_events[] = {
+	{ 0, 10, UT_TPOINT_EVENT },
+	{ 1, 20, UT_TPOINT_EVENT },
+	{ 0, 30, UT_TPOINT_EVENT },
+	{ 1, 40, UT_TPOINT_EVENT },
+	{ 0, 50, UT_TPOINT_ARGS },
+	{ 1, 60, UT_TPOINT_EVENT },
+	{ 0, 70, UT_TPOINT_EVENT },
+};
+
+static const uint64_t g_ut_args[UT_NUM_ARGS] = { 0x1111, 0x2222, 0x3333 };
+
+#define UT_LCORE1_DROPPED	5
+
+static char g_trace_file[64];
+
+static void
+ut_set_entry(struct spdk_trace_entry *entry, uint64_t tsc, uint16_t tpoint_id)
+{
+	memset(entry, 0, sizeof(*entry));
+	entry->tsc = tsc;
+	entry->tpoint_id = tpoint_id;
+	entry->object_id = tsc;
+}
+
+static void
+ut_write_block(int fd, uint64_t *offset, uint16_t lcore, const struct spdk_trace_entry *entries,
+	       uint32_t num_entries, struct spdk_trace_stream_index_entry *index)
+{
+	struct spdk_trace_stream_block block = {};
+
+	block.magic = SPDK_TRACE_STREAM_BLOCK_MAGIC;
+	block.lcore = lcore;
+	block.encoding = SPDK_TRACE_STREAM_ENCODING_RAW;
+	block.num_entries = num_entries;
+	block.data_size = num_entries * sizeof(*entries);
+	block.first_tsc = entries[0].tsc;
+	block.last_tsc = entries[num_entries - 1].tsc;
+
+	SPDK_CU_ASSERT_FATAL(pwrite(fd, &block, sizeof(block), *offset) == sizeof(block));
+	SPDK_CU_ASSERT_FATAL(pwrite(fd, entries, block.data_size, *offset + sizeof(block)) ==
+			     (ssize_t)block.data_size);
+
+	index->offset = *offset;
+	index->first_tsc = block.first_tsc;
+	index->last_tsc = block.last_tsc;
+	index->num_entries = num_entries;
+	index->lcore = lcore;
+
+	*offset += sizeof(block) + block.data_size;
+}
+
+/* Write the events as a trace stream file, optionally leaving out the index and the footer */
+static void
+ut_write_stream_file(bool footer)
+{
+	struct spdk_trace_stream_header header = {};
+	struct spdk_trace_stream_footer tail = {};
+	struct spdk_trace_stream_index_entry index[3] = {};
+	struct spdk_trace_tpoint *tpoint;
+	struct spdk_trace_entry block0[3], block1[2], block2[3];
+	struct spdk_trace_entry_buffer *buffer;
+	struct spdk_trace_stream_block partial = {};
+	uint64_t offset;
+	int fd, i;
+
+	memcpy(header.magic, SPDK_TRACE_STREAM_MAGIC, sizeof(header.magic));
+	header.version = SPDK_TRACE_STREAM_VERSION;
+	header.flags.version = SPDK_TRACE_VERSION;
+	header.flags.tsc_rate = 1000 * 1000;
+
+	tpoint = &header.flags.tpoint[UT_TPOINT_EVENT];
+	snprintf(tpoint->name, sizeof(tpoint->name), "EVENT");
+	tpoint->tpoint_id = UT_TPOINT_EVENT;
+
+	tpoint = &header.flags.tpoint[UT_TPOINT_ARGS];
+	snprintf(tpoint->name, sizeof(tpoint->name), "ARGS");
+	tpoint->tpoint_id = UT_TPOINT_ARGS;
+	tpoint->num_args = UT_NUM_ARGS;
+	for (i = 0; i < UT_NUM_ARGS; i++) {
+		snprintf(tpoint->args[i].name, sizeof(tpoint->args[i].name), "arg%d", i);
+		tpoint->args[i].type = SPDK_TRACE_ARG_TYPE_INT;
+		tpoint->args[i].size = sizeof(uint64_t);
+	}
+
+	/* lcore 0: the first argument is in the entry itself, the other two in the next buffer */
+	ut_set_entry(&block0[0], 10, UT_TPOINT_EVENT);
+	ut_set_entry(&block0[1], 30, UT_TPOINT_EVENT);
+	ut_set_entry(&block0[2], 50, UT_TPOINT_ARGS);
+	memcpy(block0[2].args, &g_ut_args[0], sizeof(g_ut_args[0]));
+	memset(&block1[0], 0, sizeof(block1[0]));
+	buffer = (struct spdk_trace_entry_buffer *)&block1[0];
+	buffer->tsc = 50;
+	buffer->tpoint_id = SPDK_TRACE_MAX_TPOINT_ID;
+	memcpy(&buffer->data[0], &g_ut_args[1], sizeof(g_ut_args[1]));
+	memcpy(&buffer->data[sizeof(g_ut_args[1])], &g_ut_args[2], sizeof(g_ut_args[2]));
+	ut_set_entry(&block1[1], 70, UT_TPOINT_EVENT);
+
+	/* lcore 1 */
+	ut_set_entry(&block2[0], 20, UT_TPOINT_EVENT);
+	ut_set_entry(&block2[1], 40, UT_TPOINT_EVENT);
+	ut_set_entry(&block2[2], 60, UT_TPOINT_EVENT);
+
+	snprintf(g_trace_file, sizeof(g_trace_file), "/tmp/trace_ut.XXXXXX");
+	fd = mkstemp(g_trace_file);
+	SPDK_CU_ASSERT_FATAL(fd >= 0);
+
+	SPDK_CU_ASSERT_FATAL(pwrite(fd, &header, sizeof(header), 0) == sizeof(header));
+	offset = sizeof(header);
+
+	/* The blocks of different lcores are interleaved in the file */
+	ut_write_block(fd, &offset, 0, block0, SPDK_COUNTOF(block0), &index[0]);
+	ut_write_block(fd, &offset, 1, block2, SPDK_COUNTOF(block2), &index[1]);
+	ut_write_block(fd, &offset, 0, block1, SPDK_COUNTOF(block1), &index[2]);
+
+	if (footer) {
+		SPDK_CU_ASSERT_FATAL(pwrite(fd, index, sizeof(index), offset) == sizeof(index));
+		tail.index_offset = offset;
+		tail.num_blocks = SPDK_COUNTOF(index);
+		tail.num_entries[0] = SPDK_COUNTOF(block0) + SPDK_COUNTOF(block1);
+		tail.num_entries[1] = SPDK_COUNTOF(block2);
+		tail.num_dropped[1] = UT_LCORE1_DROPPED;
+		memcpy(tail.magic, SPDK_TRACE_STREAM_MAGIC, sizeof(tail.magic));
+		SPDK_CU_ASSERT_FATAL(pwrite(fd, &tail, sizeof(tail), offset + sizeof(index)) ==
+				     sizeof(tail));
+	} else {
+		/* The recorder got killed in the middle of writing a block */
+		partial.magic = SPDK_TRACE_STREAM_BLOCK_MAGIC;
+		partial.num_entries = 1;
+		partial.data_size = sizeof(struct spdk_trace_entry);
+		SPDK_CU_ASSERT_FATAL(pwrite(fd, &partial, sizeof(partial), offset) == sizeof(partial));
+	}
+
+	close(fd);
+}
+
+static struct spdk_trace_parser *
+ut_parser_init(uint16_t lcore)
+{
+	struct spdk_trace_parser_opts opts = {
+		.filename = g_trace_file,
+		.mode = SPDK_TRACE_PARSER_MODE_FILE,
+		.lcore = lcore,
+	};
+
+	return spdk_trace_parser_init(&opts);
+}
+
+/* Check that the parser returns the events of the given lcore (or all of them) in order */
+static void
+ut_check_events(struct spdk_trace_parser *parser, uint16_t lcore)
+{
+	struct spdk_trace_parser_entry entry;
+	size_t i;
+	int j;
+
+	for (i = 0; i < SPDK_COUNTOF(g_ut_events); i++) {
+		if (lcore != SPDK_TRACE_MAX_LCORE && g_ut_events[i].lcore != lcore) {
+			continue;
+		}
+
+		SPDK_CU_ASSERT_FATAL(spdk_trace_parser_next_entry(parser, &entry));
+		CU_ASSERT(entry.lcore == g_ut_events[i].lcore);
+		CU_ASSERT(entry.entry->tsc == g_ut_events[i].tsc);
+		CU_ASSERT(entry.entry->tpoint_id == g_ut_events[i].tpoint_id);
+		CU_ASSERT(entry.entry->object_id == g_ut_events[i].tsc);
+
+		if (g_ut_events[i].tpoint_id == UT_TPOINT_ARGS) {
+			for (j = 0; j < UT_NUM_ARGS; j++) {
+				CU_ASSERT(entry.args[j].integer == g_ut_args[j]);
+			}
+		}
+	}
+
+	CU_ASSERT(!spdk_trace_parser_next_entry(parser, &entry));
+}
+
+static void
+test_stream(void)
+{
+	struct spdk_trace_parser *parser;
+	const struct spdk_trace_flags *flags;
+
+	ut_write_stream_file(true);
+
+	parser = ut_parser_init(SPDK_TRACE_MAX_LCORE);
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+
+	flags = spdk_trace_parser_get_flags(parser);
+	CU_ASSERT(flags->tsc_rate == 1000 * 1000);
+	CU_ASSERT(strcmp(flags->tpoint[UT_TPOINT_ARGS].name, "ARGS") == 0);
+
+	/* The counters include the buffers holding the arguments */
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 0) == 5);
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 1) == 3);
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 2) == 0);
+	CU_ASSERT(spdk_trace_parser_get_dropped_count(parser, 0) == 0);
+	CU_ASSERT(spdk_trace_parser_get_dropped_count(parser, 1) == UT_LCORE1_DROPPED);
+
+	/* The latest first entry of all lcores */
+	CU_ASSERT(spdk_trace_parser_get_tsc_offset(parser) == 20);
+
+	ut_check_events(parser, SPDK_TRACE_MAX_LCORE);
+	spdk_trace_parser_cleanup(parser);
+
+	/* Only the events of a single lcore */
+	parser = ut_parser_init(0);
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 1) == 0);
+	ut_check_events(parser, 0);
+	spdk_trace_parser_cleanup(parser);
+
+	/* An lcore without any events */
+	parser = ut_parser_init(2);
+	CU_ASSERT(parser == NULL);
+
+	unlink(g_trace_file);
+}
+
+static void
+test_stream_truncated(void)
+{
+	struct spdk_trace_parser *parser;
+
+	ut_write_stream_file(false);
+
+	/* Without the index, the blocks are found by walking the file */
+	parser = ut_parser_init(SPDK_TRACE_MAX_LCORE);
+	SPDK_CU_ASSERT_FATAL(parser != NULL);
+
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 0) == 5);
+	CU_ASSERT(spdk_trace_parser_get_entry_count(parser, 1) == 3);
+	/* The dropped counters are only in the footer */
+	CU_ASSERT(spdk_trace_parser_get_dropped_count(parser, 1) == 0);
+
+	ut_check_events(parser, SPDK_TRACE_MAX_LCORE);
+	spdk_trace_parser_cleanup(parser);
+
+	unlink(g_trace_file);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("trace", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_stream);
+	CU_ADD_TEST(suite, test_stream_truncated);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -50,6 +50,74 @@ test_crc16_t10dif_copy(void)
 	free(buf3);
 }
 
+static void
+check_crc16_t10dif_multi(void)
+{
+	size_t lens[] = { 0, 1, 15, 16, 17, 512, 520, 4096, 4103 };
+	uint8_t *bufs[6], *dsts[6];
+	uint16_t crcs[6];
+	size_t i, j, k;
+
+	for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+		bufs[i] = malloc(4104);
+		dsts[i] = malloc(4104);
+		SPDK_CU_ASSERT_FATAL(bufs[i] != NULL && dsts[i] != NULL);
+		for (j = 0; j < 4104; j++) {
+			bufs[i][j] = rand();
+		}
+	}
+
+	for (k = 0; k < SPDK_COUNTOF(lens); k++) {
+		/* More buffers than lanes, unaligned buffers and different seeds */
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0x1234 * i;
+		}
+		crc16_t10dif_multi(crcs, bufs, lens[k], SPDK_COUNTOF(bufs));
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			CU_ASSERT(crcs[i] == spdk_crc16_t10dif(0x1234 * i, bufs[i], lens[k]));
+		}
+
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0x1234 * i;
+			memset(dsts[i], 0xba, 4104);
+		}
+		crc16_t10dif_copy_multi(crcs, dsts, bufs, lens[k], SPDK_COUNTOF(bufs));
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			CU_ASSERT(crcs[i] == spdk_crc16_t10dif(0x1234 * i, bufs[i], lens[k]));
+			CU_ASSERT(memcmp(dsts[i], bufs[i], lens[k]) == 0);
+			CU_ASSERT(dsts[i][lens[k]] == 0xba);
+		}
+
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0;
+		}
+		crc16_t10dif_multi(crcs, &bufs[1], lens[k], 3);
+		for (i = 0; i < 3; i++) {
+			CU_ASSERT(crcs[i] == spdk_crc16_t10dif(0, bufs[i + 1], lens[k]));
+		}
+		CU_ASSERT(crcs[3] == 0);
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+		free(bufs[i]);
+		free(dsts[i]);
+	}
+}
+
+static void
+test_crc16_t10dif_multi(void)
+{
+	check_crc16_t10dif_multi();
+#ifdef __x86_64__
+	/* Check the fallback used by CPUs without PCLMUL too */
+	if (g_crc16_pclmul) {
+		g_crc16_pclmul = false;
+		check_crc16_t10dif_multi();
+		g_crc16_pclmul = true;
+	}
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -63,6 +131,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_crc16_t10dif);
 	CU_ADD_TEST(suite, test_crc16_t10dif_seed);
 	CU_ADD_TEST(suite, test_crc16_t10dif_copy);
+	CU_ADD_TEST(suite, test_crc16_t10dif_multi);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -164,6 +164,118 @@ test_crc32c_nvme(void)
 	CU_ASSERT(crc == 0x214941A8);
 }
 
+static uint32_t
+ut_crc32c_bitwise(const uint8_t *buf, size_t len, uint32_t crc)
+{
+	size_t i, j;
+
+	for (i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (j = 0; j < 8; j++) {
+			crc = (crc & 1) ? (crc >> 1) ^ SPDK_CRC32C_POLYNOMIAL_REFLECT : crc >> 1;
+		}
+	}
+
+	return crc;
+}
+
+static void
+test_crc32c_long(void)
+{
+	size_t lens[] = { 767, 768, 775, 6144, 6145, 6144 + 768 + 9, 128 * 1024 + 3 };
+	size_t buf_size = 128 * 1024 + 16;
+	uint8_t *buf;
+	size_t i, l, o;
+
+	buf = malloc(buf_size);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	for (i = 0; i < buf_size; i++) {
+		buf[i] = rand();
+	}
+
+	for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+		for (o = 0; o < 8; o += 3) {
+			CU_ASSERT(spdk_crc32c_update(buf + o, lens[l], 0x12345678) ==
+				  ut_crc32c_bitwise(buf + o, lens[l], 0x12345678));
+		}
+	}
+
+	free(buf);
+}
+
+static void
+test_crc32c_copy(void)
+{
+	size_t lens[] = { 0, 1, 7, 768, 6144 + 768 + 9, 64 * 1024 + 3 };
+	size_t buf_size = 64 * 1024 + 16;
+	uint8_t *src, *dst;
+	uint32_t crc;
+	size_t i, l, o;
+
+	src = malloc(buf_size);
+	dst = malloc(buf_size);
+	SPDK_CU_ASSERT_FATAL(src != NULL && dst != NULL);
+	for (i = 0; i < buf_size; i++) {
+		src[i] = rand();
+	}
+
+	for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+		for (o = 0; o < 8; o += 3) {
+			memset(dst, 0xba, buf_size);
+			crc = spdk_crc32c_copy(dst + 1, src + o, lens[l], 0x12345678);
+			CU_ASSERT(crc == spdk_crc32c_update(src + o, lens[l], 0x12345678));
+			CU_ASSERT(memcmp(dst + 1, src + o, lens[l]) == 0);
+			CU_ASSERT(dst[0] == 0xba);
+			CU_ASSERT(dst[lens[l] + 1] == 0xba);
+		}
+	}
+
+	free(src);
+	free(dst);
+}
+
+static void
+test_crc32c_combine(void)
+{
+	size_t buf_size = 16 * 1024 + 7;
+	size_t splits[] = { 0, 1, 8, 100, 4096, 16 * 1024 + 7 };
+	struct iovec iovs[3];
+	uint32_t crc, crc1, crc2, crc3;
+	uint8_t *buf;
+	size_t i, s;
+
+	buf = malloc(buf_size);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	for (i = 0; i < buf_size; i++) {
+		buf[i] = rand();
+	}
+
+	crc = spdk_crc32c_update(buf, buf_size, ~0U);
+
+	for (s = 0; s < SPDK_COUNTOF(splits); s++) {
+		crc1 = spdk_crc32c_update(buf, splits[s], ~0U);
+		crc2 = spdk_crc32c_update(buf + splits[s], buf_size - splits[s], 0);
+		CU_ASSERT(spdk_crc32c_combine(crc1, crc2, buf_size - splits[s]) == crc);
+	}
+
+	/* fragments computed in any order */
+	iovs[0].iov_base = buf;
+	iovs[0].iov_len = 1000;
+	iovs[1].iov_base = buf + 1000;
+	iovs[1].iov_len = 5000;
+	iovs[2].iov_base = buf + 6000;
+	iovs[2].iov_len = buf_size - 6000;
+
+	crc3 = spdk_crc32c_iov_update(&iovs[2], 1, 0);
+	crc2 = spdk_crc32c_iov_update(&iovs[1], 1, 0);
+	crc1 = spdk_crc32c_iov_update(&iovs[0], 1, ~0U);
+	crc2 = spdk_crc32c_combine(crc2, crc3, iovs[2].iov_len);
+	CU_ASSERT(spdk_crc32c_combine(crc1, crc2, iovs[1].iov_len + iovs[2].iov_len) == crc);
+	CU_ASSERT(spdk_crc32c_iov_update(iovs, 3, ~0U) == crc);
+
+	free(buf);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -176,6 +288,9 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, test_crc32c);
 	CU_ADD_TEST(suite, test_crc32c_nvme);
+	CU_ADD_TEST(suite, test_crc32c_long);
+	CU_ADD_TEST(suite, test_crc32c_copy);
+	CU_ADD_TEST(suite, test_crc32c_combine);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -58,6 +58,74 @@ test_crc64_nvme(void)
 	CU_ASSERT(crc == 0x9A2DF64B8E9E517E);
 }
 
+static void
+check_crc64_nvme_multi(void)
+{
+	size_t lens[] = { 0, 1, 15, 16, 17, 512, 520, 4096, 4103 };
+	uint8_t *bufs[6], *dsts[6];
+	uint64_t crcs[6];
+	size_t i, j, k;
+
+	for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+		bufs[i] = malloc(4104);
+		dsts[i] = malloc(4104);
+		SPDK_CU_ASSERT_FATAL(bufs[i] != NULL && dsts[i] != NULL);
+		for (j = 0; j < 4104; j++) {
+			bufs[i][j] = rand();
+		}
+	}
+
+	for (k = 0; k < SPDK_COUNTOF(lens); k++) {
+		/* More buffers than lanes, unaligned buffers and different seeds */
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0x123456789ULL * i;
+		}
+		crc64_nvme_multi(crcs, bufs, lens[k], SPDK_COUNTOF(bufs));
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			CU_ASSERT(crcs[i] == spdk_crc64_nvme(bufs[i], lens[k], 0x123456789ULL * i));
+		}
+
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0x123456789ULL * i;
+			memset(dsts[i], 0xba, 4104);
+		}
+		crc64_nvme_copy_multi(crcs, dsts, bufs, lens[k], SPDK_COUNTOF(bufs));
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			CU_ASSERT(crcs[i] == spdk_crc64_nvme(bufs[i], lens[k], 0x123456789ULL * i));
+			CU_ASSERT(memcmp(dsts[i], bufs[i], lens[k]) == 0);
+			CU_ASSERT(dsts[i][lens[k]] == 0xba);
+		}
+
+		for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+			crcs[i] = 0;
+		}
+		crc64_nvme_multi(crcs, &bufs[1], lens[k], 3);
+		for (i = 0; i < 3; i++) {
+			CU_ASSERT(crcs[i] == spdk_crc64_nvme(bufs[i + 1], lens[k], 0));
+		}
+		CU_ASSERT(crcs[3] == 0);
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(bufs); i++) {
+		free(bufs[i]);
+		free(dsts[i]);
+	}
+}
+
+static void
+test_crc64_nvme_multi(void)
+{
+	check_crc64_nvme_multi();
+#ifdef __x86_64__
+	/* Check the fallback used by CPUs without PCLMUL too */
+	if (g_crc64_pclmul) {
+		g_crc64_pclmul = false;
+		check_crc64_nvme_multi();
+		g_crc64_pclmul = true;
+	}
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -70,6 +138,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("crc64", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_crc64_nvme);
+	CU_ADD_TEST(suite, test_crc64_nvme_multi);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
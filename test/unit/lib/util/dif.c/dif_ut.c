@@ -1992,6 +1992,67 @@ dif_copy_sec_4096_md_128_inject_1_2_4_8_multi_iovs_split_test(void)
 	_iov_free_buf(&bounce_iov);
 }
 
+static void
+_dif_copy_verify_stop_at_error(enum spdk_dif_pi_format dif_pi_format)
+{
+	struct spdk_dif_ctx ctx = {};
+	struct spdk_dif_error err_blk = {};
+	struct iovec iov, bounce_iov;
+	uint32_t dif_flags, num_blocks = 6, i;
+	uint8_t *buf;
+	int rc;
+	struct spdk_dif_ctx_init_ext_opts dif_opts;
+
+	dif_flags = SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+		    SPDK_DIF_FLAGS_REFTAG_CHECK;
+
+	_iov_alloc_buf(&iov, 4096 * num_blocks);
+	_iov_alloc_buf(&bounce_iov, (4096 + 128) * num_blocks);
+
+	rc = ut_data_pattern_generate(&iov, 1, 4096, 0, num_blocks);
+	CU_ASSERT(rc == 0);
+
+	dif_opts.size = SPDK_SIZEOF(&dif_opts, dif_pi_format);
+	dif_opts.dif_pi_format = dif_pi_format;
+	rc = spdk_dif_ctx_init(&ctx, 4096 + 128, 128, true, true, SPDK_DIF_TYPE1, dif_flags,
+			       88, 0xFFFF, 0x88, 0, GUARD_SEED, &dif_opts);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	rc = spdk_dif_generate_copy(&iov, 1, &bounce_iov, 1, num_blocks, &ctx);
+	CU_ASSERT(rc == 0);
+
+	/* Corrupt the data of the second block, in the same batch as the following ones */
+	buf = bounce_iov.iov_base;
+	buf[4096 + 128 + 100] ^= 0xFF;
+	memset(iov.iov_base, 0xA5, iov.iov_len);
+
+	rc = spdk_dif_verify_copy(&iov, 1, &bounce_iov, 1, num_blocks, &ctx, &err_blk);
+	CU_ASSERT(rc != 0);
+	CU_ASSERT(err_blk.err_type == SPDK_DIF_GUARD_ERROR);
+	CU_ASSERT(err_blk.err_offset == 1);
+
+	/* The blocks before the error were copied, the ones after it were not */
+	buf = iov.iov_base;
+	CU_ASSERT(memcmp(buf, bounce_iov.iov_base, 4096) == 0);
+	for (i = 4096 * 2; i < iov.iov_len; i++) {
+		if (buf[i] != 0xA5) {
+			break;
+		}
+	}
+	CU_ASSERT(i == iov.iov_len);
+
+	_iov_free_buf(&iov);
+	_iov_free_buf(&bounce_iov);
+}
+
+static void
+dif_copy_verify_stop_at_error_test(void)
+{
+	_dif_copy_verify_stop_at_error(SPDK_DIF_PI_FORMAT_16);
+	_dif_copy_verify_stop_at_error(SPDK_DIF_PI_FORMAT_32);
+	_dif_copy_verify_stop_at_error(SPDK_DIF_PI_FORMAT_64);
+}
+
 static void
 dix_sec_512_md_0_error(void)
 {
@@ -4088,6 +4149,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, dif_copy_sec_4096_md_128_prchk_7_multi_iovs_complex_splits_test);
 	CU_ADD_TEST(suite, dif_copy_sec_4096_md_128_inject_1_2_4_8_multi_iovs_test);
 	CU_ADD_TEST(suite, dif_copy_sec_4096_md_128_inject_1_2_4_8_multi_iovs_split_test);
+	CU_ADD_TEST(suite, dif_copy_verify_stop_at_error_test);
 	CU_ADD_TEST(suite, dix_sec_512_md_0_error);
 	CU_ADD_TEST(suite, dix_sec_512_md_8_prchk_0_single_iov);
 	CU_ADD_TEST(suite, dix_sec_4096_md_128_prchk_0_single_iov_test);
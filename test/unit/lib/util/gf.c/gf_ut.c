@@ -0,0 +1,369 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2023 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+
+#include "util/gf.c"
+#include "common/lib/test_env.c"
+
+#define SRC_BUF_COUNT 6
+#define BUF_SIZE 4096
+
+static void *g_src[SRC_BUF_COUNT];
+static uint8_t *g_ref_p;
+static uint8_t *g_ref_q;
+
+static int
+gf_ut_setup(void)
+{
+	uint32_t i, j;
+	int ret;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		ret = posix_memalign(&g_src[i], spdk_gf_get_optimal_alignment(), BUF_SIZE);
+		if (ret != 0) {
+			return -1;
+		}
+
+		for (j = 0; j < BUF_SIZE; j++) {
+			((uint8_t *)g_src[i])[j] = rand();
+		}
+	}
+
+	g_ref_p = calloc(1, BUF_SIZE);
+	g_ref_q = calloc(1, BUF_SIZE);
+	if (!g_ref_p || !g_ref_q) {
+		return -1;
+	}
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		for (j = 0; j < BUF_SIZE; j++) {
+			uint8_t d = ((uint8_t *)g_src[i])[j];
+
+			g_ref_p[j] ^= d;
+			g_ref_q[j] ^= spdk_gf_mul(spdk_gf_exp(i), d);
+		}
+	}
+
+	return 0;
+}
+
+static int
+gf_ut_cleanup(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		free(g_src[i]);
+	}
+	free(g_ref_p);
+	free(g_ref_q);
+
+	return 0;
+}
+
+static void
+test_gf_mul(void)
+{
+	uint32_t a, b, r;
+	uint32_t i;
+
+	CU_ASSERT(spdk_gf_exp(0) == 1);
+	CU_ASSERT(spdk_gf_exp(1) == 2);
+	CU_ASSERT(spdk_gf_exp(8) == 0x1d);
+	CU_ASSERT(spdk_gf_exp(255) == 1);
+	CU_ASSERT(spdk_gf_inv(0) == 0);
+
+	for (a = 0; a < 256; a++) {
+		CU_ASSERT(spdk_gf_mul(a, 0) == 0);
+		CU_ASSERT(spdk_gf_mul(a, 1) == a);
+		if (a != 0) {
+			CU_ASSERT(spdk_gf_mul(a, spdk_gf_inv(a)) == 1);
+		}
+
+		/* compare with carry-less multiplication reduced by the polynomial */
+		for (b = 0; b < 256; b++) {
+			r = 0;
+			for (i = 0; i < 8; i++) {
+				if (b & (1 << i)) {
+					r ^= a << i;
+				}
+			}
+			for (i = 15; i >= 8; i--) {
+				if (r & (1 << i)) {
+					r ^= SPDK_GF_POLY << (i - 8);
+				}
+			}
+			CU_ASSERT(spdk_gf_mul(a, b) == r);
+		}
+	}
+}
+
+static void
+test_gf_mul_buf(void)
+{
+	uint8_t *src = g_src[0];
+	uint8_t *dest;
+	uint32_t j;
+	int ret;
+
+	dest = malloc(BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(dest != NULL);
+
+	/* unaligned length and buffers */
+	ret = spdk_gf_mul_buf(dest + 1, src + 3, 0x53, BUF_SIZE - 5);
+	CU_ASSERT(ret == 0);
+	for (j = 0; j < BUF_SIZE - 5; j++) {
+		CU_ASSERT(dest[j + 1] == spdk_gf_mul(0x53, src[j + 3]));
+	}
+
+	/* in place */
+	memcpy(dest, src, BUF_SIZE);
+	ret = spdk_gf_mul_buf(dest, dest, 0xca, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	ret = spdk_gf_mul_buf(dest, dest, spdk_gf_inv(0xca), BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(dest, src, BUF_SIZE) == 0);
+
+	free(dest);
+}
+
+static void
+test_gf_pq_gen(void)
+{
+	void *sources[SRC_BUF_COUNT];
+	uint8_t *p, *q;
+	uint32_t i;
+	int ret;
+
+	ret = posix_memalign((void **)&p, spdk_gf_get_optimal_alignment(), BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+	ret = posix_memalign((void **)&q, spdk_gf_get_optimal_alignment(), BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+
+	ret = spdk_gf_pq_gen(p, q, g_src, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(p, g_ref_p, BUF_SIZE) == 0);
+	CU_ASSERT(memcmp(q, g_ref_q, BUF_SIZE) == 0);
+
+	/* len not multiple of alignment */
+	memset(p, 0xba, BUF_SIZE);
+	memset(q, 0xba, BUF_SIZE);
+	ret = spdk_gf_pq_gen(p, q, g_src, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(p, g_ref_p, BUF_SIZE - 1) == 0);
+	CU_ASSERT(memcmp(q, g_ref_q, BUF_SIZE - 1) == 0);
+
+	/* unaligned buffers */
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		sources[i] = (uint8_t *)g_src[i] + 1;
+	}
+	ret = spdk_gf_pq_gen(p + 1, q + 1, sources, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(p + 1, g_ref_p + 1, BUF_SIZE - 1) == 0);
+	CU_ASSERT(memcmp(q + 1, g_ref_q + 1, BUF_SIZE - 1) == 0);
+
+	/* a single source is copied to both syndromes */
+	ret = spdk_gf_pq_gen(p, q, g_src, 1, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(p, g_src[0], BUF_SIZE) == 0);
+	CU_ASSERT(memcmp(q, g_src[0], BUF_SIZE) == 0);
+
+	/* invalid parameters */
+	ret = spdk_gf_pq_gen(p, q, g_src, 0, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	ret = spdk_gf_pq_gen(p, q, g_src, SPDK_GF_MAX_SRC + 1, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	ret = spdk_gf_pq_gen(NULL, q, g_src, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	free(p);
+	free(q);
+}
+
+static void
+test_gf_pq_recover(void)
+{
+	void *data[SRC_BUF_COUNT];
+	void *rec[2];
+	uint32_t failed[2];
+	uint32_t x, y, i;
+	int ret;
+
+	for (i = 0; i < 2; i++) {
+		rec[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(rec[i] != NULL);
+	}
+
+	for (x = 0; x < SRC_BUF_COUNT; x++) {
+		memcpy(data, g_src, sizeof(data));
+		data[x] = rec[0];
+		failed[0] = x;
+
+		/* from P */
+		memset(rec[0], 0xba, BUF_SIZE);
+		ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, NULL, failed, 1, BUF_SIZE);
+		CU_ASSERT(ret == 0);
+		CU_ASSERT(memcmp(rec[0], g_src[x], BUF_SIZE) == 0);
+
+		/* from Q */
+		memset(rec[0], 0xba, BUF_SIZE);
+		ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, NULL, g_ref_q, failed, 1, BUF_SIZE - 3);
+		CU_ASSERT(ret == 0);
+		CU_ASSERT(memcmp(rec[0], g_src[x], BUF_SIZE - 3) == 0);
+
+		/* no syndrome */
+		ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, NULL, NULL, failed, 1, BUF_SIZE);
+		CU_ASSERT(ret == -EINVAL);
+
+		for (y = 0; y < SRC_BUF_COUNT; y++) {
+			if (y == x) {
+				continue;
+			}
+
+			data[y] = rec[1];
+			failed[1] = y;
+
+			memset(rec[0], 0xba, BUF_SIZE);
+			memset(rec[1], 0xba, BUF_SIZE);
+			ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, g_ref_q, failed, 2, BUF_SIZE - 7);
+			CU_ASSERT(ret == 0);
+			CU_ASSERT(memcmp(rec[0], g_src[x], BUF_SIZE - 7) == 0);
+			CU_ASSERT(memcmp(rec[1], g_src[y], BUF_SIZE - 7) == 0);
+
+			/* both syndromes are required */
+			ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, NULL, failed, 2, BUF_SIZE);
+			CU_ASSERT(ret == -EINVAL);
+
+			data[y] = g_src[y];
+		}
+	}
+
+	/* invalid indexes */
+	failed[0] = SRC_BUF_COUNT;
+	ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, g_ref_q, failed, 1, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	failed[0] = 1;
+	failed[1] = 1;
+	ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, g_ref_q, failed, 2, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+	ret = spdk_gf_pq_recover(data, SRC_BUF_COUNT, g_ref_p, g_ref_q, failed, 3, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < 2; i++) {
+		free(rec[i]);
+	}
+}
+
+static void
+check_gf_kernels(const struct gf_kernels *kernels)
+{
+	uint32_t lens[] = { 1, 31, 64, 255, BUF_SIZE - 9 };
+	uint32_t offsets[] = { 0, 1, 8 };
+	uint8_t *srcs[SRC_BUF_COUNT], *p, *q, *dx, *dy;
+	uint8_t c = 0x8e;
+	size_t i, j, l, o;
+
+	p = malloc(BUF_SIZE);
+	q = malloc(BUF_SIZE);
+	dx = malloc(BUF_SIZE);
+	dy = malloc(BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(p && q && dx && dy);
+
+	for (o = 0; o < SPDK_COUNTOF(offsets); o++) {
+		/* misalign the last source only, the first one is missing (zero) */
+		for (i = 0; i < SRC_BUF_COUNT; i++) {
+			srcs[i] = g_src[i];
+		}
+		srcs[SRC_BUF_COUNT - 1] += offsets[o];
+		srcs[0] = NULL;
+
+		for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+			memset(p, 0xba, BUF_SIZE);
+			memset(q, 0xba, BUF_SIZE);
+			kernels->pq_gen(p, q, srcs, SRC_BUF_COUNT, lens[l]);
+			for (j = 0; j < lens[l]; j++) {
+				uint8_t bp = 0, bq = 0;
+
+				for (i = 1; i < SRC_BUF_COUNT; i++) {
+					bp ^= srcs[i][j];
+					bq ^= spdk_gf_mul(spdk_gf_exp(i), srcs[i][j]);
+				}
+				CU_ASSERT(p[j] == bp);
+				CU_ASSERT(q[j] == bq);
+			}
+			CU_ASSERT(p[lens[l]] == 0xba);
+			CU_ASSERT(q[lens[l]] == 0xba);
+
+			memset(dx, 0xba, BUF_SIZE);
+			kernels->mul(dx, srcs[1], srcs[SRC_BUF_COUNT - 1], c, lens[l]);
+			for (j = 0; j < lens[l]; j++) {
+				CU_ASSERT(dx[j] == spdk_gf_mul(c, srcs[1][j] ^ srcs[SRC_BUF_COUNT - 1][j]));
+			}
+			CU_ASSERT(dx[lens[l]] == 0xba);
+
+			/* recover sources 1 and 2 from the syndromes of the others */
+			srcs[1] = NULL;
+			srcs[2] = NULL;
+			kernels->pq_gen(dy, dx, srcs, SRC_BUF_COUNT, lens[l]);
+			kernels->rec2(dx, dy, p, q, spdk_gf_mul(spdk_gf_exp(2), spdk_gf_inv(6)),
+				      spdk_gf_inv(6), lens[l]);
+			CU_ASSERT(memcmp(dx, g_src[1], lens[l]) == 0);
+			CU_ASSERT(memcmp(dy, g_src[2], lens[l]) == 0);
+			srcs[1] = g_src[1];
+			srcs[2] = g_src[2];
+		}
+	}
+
+	free(p);
+	free(q);
+	free(dx);
+	free(dy);
+}
+
+static void
+test_gf_kernels(void)
+{
+	check_gf_kernels(&g_gf_kernels_basic);
+	check_gf_kernels(g_gf_kernels);
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("ssse3")) {
+		check_gf_kernels(&g_gf_kernels_ssse3);
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		check_gf_kernels(&g_gf_kernels_avx2);
+	}
+	if (__builtin_cpu_supports("avx512bw")) {
+		check_gf_kernels(&g_gf_kernels_avx512);
+	}
+#elif defined(__aarch64__)
+	check_gf_kernels(&g_gf_kernels_neon);
+#endif
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("gf", gf_ut_setup, gf_ut_cleanup);
+
+	CU_ADD_TEST(suite, test_gf_mul);
+	CU_ADD_TEST(suite, test_gf_mul_buf);
+	CU_ADD_TEST(suite, test_gf_pq_gen);
+	CU_ADD_TEST(suite, test_gf_pq_recover);
+	CU_ADD_TEST(suite, test_gf_kernels);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+
+	CU_cleanup_registry();
+
+	return num_failures;
+}
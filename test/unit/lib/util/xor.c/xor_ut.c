@@ -97,6 +97,72 @@ test_xor_gen(void)
 	free(ref);
 }
 
+static void
+check_xor_kernel(xor_gen_fn fn)
+{
+	uint32_t lens[] = { 1, 31, 64, 255, 4096, 4097, XOR_NT_STORE_THRESHOLD + 64 };
+	uint32_t offsets[] = { 0, 1, 8 };
+	uint32_t counts[] = { 2, 3, SRC_BUF_COUNT };
+	size_t buf_size = XOR_NT_STORE_THRESHOLD + 128;
+	void *bufs[SRC_BUF_COUNT], *sources[SRC_BUF_COUNT];
+	uint8_t *ref, *dest;
+	size_t i, j, l, o, c;
+	int ret;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		ret = posix_memalign(&bufs[i], 64, buf_size);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+		for (j = 0; j < buf_size; j++) {
+			((uint8_t *)bufs[i])[j] = rand();
+		}
+	}
+	ret = posix_memalign((void **)&dest, 64, buf_size);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+	ref = malloc(buf_size);
+	SPDK_CU_ASSERT_FATAL(ref != NULL);
+
+	for (c = 0; c < SPDK_COUNTOF(counts); c++) {
+		for (o = 0; o < SPDK_COUNTOF(offsets); o++) {
+			/* misalign the last source only */
+			for (i = 0; i < counts[c]; i++) {
+				sources[i] = bufs[i];
+			}
+			sources[counts[c] - 1] = (uint8_t *)sources[counts[c] - 1] + offsets[o];
+
+			for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+				xor_gen_unaligned(ref, sources, counts[c], lens[l]);
+				memset(dest, 0xba, buf_size);
+				fn(dest, sources, counts[c], lens[l]);
+				CU_ASSERT(memcmp(ref, dest, lens[l]) == 0);
+				CU_ASSERT(dest[lens[l]] == 0xba);
+			}
+		}
+	}
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		free(bufs[i]);
+	}
+	free(dest);
+	free(ref);
+}
+
+static void
+test_xor_gen_kernels(void)
+{
+	check_xor_kernel(xor_gen_basic);
+	check_xor_kernel(g_xor_gen_fn);
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("avx2")) {
+		check_xor_kernel(xor_gen_avx2);
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		check_xor_kernel(xor_gen_avx512);
+	}
+#elif defined(__aarch64__)
+	check_xor_kernel(xor_gen_neon);
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -108,6 +174,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("xor", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_xor_gen);
+	CU_ADD_TEST(suite, test_xor_gen_kernels);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -75,6 +75,7 @@ function unittest_json() {
 	$valgrind $testdir/lib/json/json_util.c/json_util_ut
 	$valgrind $testdir/lib/json/json_write.c/json_write_ut
 	$valgrind $testdir/lib/jsonrpc/jsonrpc_server.c/jsonrpc_server_ut
+	$valgrind $testdir/lib/jsonrpc/jsonrpc_server_tcp.c/jsonrpc_server_tcp_ut
 }
 
 function unittest_rpc() {
@@ -137,14 +138,21 @@ function unittest_util() {
 	$valgrind $testdir/lib/util/crc64.c/crc64_ut
 	$valgrind $testdir/lib/util/string.c/string_ut
 	$valgrind $testdir/lib/util/dif.c/dif_ut
+	$valgrind $testdir/lib/util/gf.c/gf_ut
 	$valgrind $testdir/lib/util/iov.c/iov_ut
 	$valgrind $testdir/lib/util/math.c/math_ut
 	$valgrind $testdir/lib/util/pipe.c/pipe_ut
 	$valgrind $testdir/lib/util/xor.c/xor_ut
 }
 
+function unittest_trace_parser() {
+	$valgrind $testdir/lib/trace_parser/analysis.cpp/analysis_ut
+	$valgrind $testdir/lib/trace_parser/trace.cpp/trace_ut
+}
+
 function unittest_init() {
 	$valgrind $testdir/lib/init/subsystem.c/subsystem_ut
+	$valgrind $testdir/lib/init/json_config.c/json_config_ut
 }
 
 if [ $SPDK_RUN_VALGRIND -eq 1 ] && [ $SPDK_RUN_ASAN -eq 1 ]; then
@@ -227,6 +235,10 @@ if grep -q '#define SPDK_CONFIG_RAID5F 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_bdev_raid5f" $valgrind $testdir/lib/bdev/raid/raid5f.c/raid5f_ut
 fi
 
+if grep -q '#define SPDK_CONFIG_RAID6 1' $rootdir/include/spdk/config.h; then
+	run_test "unittest_bdev_raid6" $valgrind $testdir/lib/bdev/raid/raid6.c/raid6_ut
+fi
+
 run_test "unittest_blob_blobfs" unittest_blob
 run_test "unittest_event" unittest_event
 if [ $(uname -s) = Linux ]; then
@@ -277,6 +289,8 @@ if [ $(uname -s) = Linux ]; then
 fi
 run_test "unittest_thread" $valgrind $testdir/lib/thread/thread.c/thread_ut
 run_test "unittest_iobuf" $valgrind $testdir/lib/thread/iobuf.c/iobuf_ut
+run_test "unittest_trace" $valgrind $testdir/lib/trace/trace.c/trace_ut
+run_test "unittest_trace_parser" unittest_trace_parser
 run_test "unittest_util" unittest_util
 if grep -q '#define SPDK_CONFIG_VHOST 1' $rootdir/include/spdk/config.h; then
 	run_test "unittest_vhost" $valgrind $testdir/lib/vhost/vhost.c/vhost_ut